@@ -112,6 +112,7 @@ static const char *tests[] = {
                               "selio_reg",
                               "shear1_reg",
                               "shear2_reg",
+                              "simd_reg",
                               "skew_reg",
                               "splitcomp_reg",
                               "subpixel_reg",
@@ -0,0 +1,533 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ * benchmark.c
+ *
+ *    benchmark [nreps [nthreads [simdlevel [fileout]]]]
+ *
+ *        nreps:      number of times each operation is run (default 3)
+ *        nthreads:   default number of threads (default 1)
+ *        simdlevel:  0 (none), 1 (sse2) or 2 (avx2); default 2, which
+ *                    is reduced to what the processor supports
+ *        fileout:    file for the report (default: stdout)
+ *
+ *    Runs a fixed set of images through the core operations
+ *    (morphology, scaling, rotation, binarization, connected
+ *    components, image i/o and color quantization), and writes
+ *    one line for each operation, with tab-separated fields:
+ *
+ *        group      operation category
+ *        name       operation
+ *        mpix       megapixels in the input image
+ *        reps       number of runs
+ *        best       fastest run (wall clock sec)
+ *        mean       mean over the runs (wall clock sec)
+ *        mpix/s     mpix / best
+ *        allocs     pix data allocations in each run
+ *        peak_kb    peak pix data above that held before the run (KB)
+ *        rss_kb     peak resident size of the process so far (KB)
+ *
+ *    Lines starting with '#' are comments; the first of these records
+ *    the leptonica version, nreps, nthreads and simd level.  An
+ *    operation that is not available in this build (for example,
+ *    an i/o codec without its library) is reported with "skipped"
+ *    in place of the measurements.
+ *
+ *    Allocations are counted by installing a pix memory manager with
+ *    setPixMemoryManager(), so they cover the image data of every pix
+ *    but not the smaller structs and arrays.
+ *
+ *    To compare builds or fast paths, run the same nreps with
+ *    different nthreads or simdlevel, and compare the best or mpix/s
+ *    fields of lines with the same group and name.
+ */
+
+#ifndef _WIN32
+#include <sys/time.h>
+#include <sys/resource.h>
+#endif  /* !_WIN32 */
+#include "allheaders.h"
+
+    /* Test images: binary, grayscale and rgb */
+static const char  *files[] = {"arabic.png", "lighttext.jpg",
+                               "juditharismax.jpg"};
+enum { BIN = 0, GRAY = 1, RGB = 2 };
+
+typedef l_int32 (*BENCH_FUNC)(PIX *pixs);
+
+struct BenchOp {
+    const char  *group;
+    const char  *name;
+    l_int32      input;   /* BIN, GRAY or RGB */
+    BENCH_FUNC   func;    /* returns 0 if OK, 1 if skipped */
+};
+typedef struct BenchOp  BENCHOP;
+
+static l_int32 DilateBrick(PIX *pixs);
+static l_int32 OpenBrick(PIX *pixs);
+static l_int32 MorphSequence(PIX *pixs);
+static l_int32 ErodeGray(PIX *pixs);
+static l_int32 ScaleToGray4(PIX *pixs);
+static l_int32 ScaleAreaMap(PIX *pixs);
+static l_int32 ScaleLI(PIX *pixs);
+static l_int32 RotateShear(PIX *pixs);
+static l_int32 RotateAreaMap(PIX *pixs);
+static l_int32 RotateOrth(PIX *pixs);
+static l_int32 RGBToGray(PIX *pixs);
+static l_int32 OtsuBinarize(PIX *pixs);
+static l_int32 SauvolaBinarize(PIX *pixs);
+static l_int32 ConnCompBB(PIX *pixs);
+static l_int32 ConnCompPixa(PIX *pixs);
+static l_int32 WriteReadFormat(PIX *pixs, l_int32 format);
+static l_int32 PngIO(PIX *pixs);
+static l_int32 JpegIO(PIX *pixs);
+static l_int32 TiffG4IO(PIX *pixs);
+static l_int32 OctreeQuant(PIX *pixs);
+static l_int32 MedianCutQuant(PIX *pixs);
+
+static const BENCHOP  ops[] = {
+    {"morph", "dilate_brick_15", BIN, DilateBrick},
+    {"morph", "open_brick_21", BIN, OpenBrick},
+    {"morph", "morph_sequence", BIN, MorphSequence},
+    {"morph", "erode_gray_7", GRAY, ErodeGray},
+    {"scale", "scale_to_gray_4", BIN, ScaleToGray4},
+    {"scale", "scale_areamap_0.37", RGB, ScaleAreaMap},
+    {"scale", "scale_li_2.3", GRAY, ScaleLI},
+    {"rotate", "rotate_shear_2deg", BIN, RotateShear},
+    {"rotate", "rotate_areamap_5deg", RGB, RotateAreaMap},
+    {"rotate", "rotate_orth_90", RGB, RotateOrth},
+    {"binarize", "rgb_to_gray", RGB, RGBToGray},
+    {"binarize", "otsu_adaptive", GRAY, OtsuBinarize},
+    {"binarize", "sauvola", GRAY, SauvolaBinarize},
+    {"conncomp", "conncomp_bb_8", BIN, ConnCompBB},
+    {"conncomp", "conncomp_pixa_4", BIN, ConnCompPixa},
+    {"io", "png_write_read", RGB, PngIO},
+    {"io", "jpeg_write_read", RGB, JpegIO},
+    {"io", "tiff_g4_write_read", BIN, TiffG4IO},
+    {"quant", "octree_quant_128", RGB, OctreeQuant},
+    {"quant", "median_cut_quant", RGB, MedianCutQuant}};
+
+    /* Counting pix memory manager */
+static void *CountingAlloc(size_t size);
+static void CountingFree(void *ptr);
+static l_int64 GetPeakRss(void);
+
+static L_MUTEX  *mutex = NULL;
+static l_int64   nallocs = 0;
+static l_int64   curbytes = 0;
+static l_int64   peakbytes = 0;
+
+    /* Each allocation has a header holding its size, padded to keep
+     * the data aligned */
+#define  HEADER_SIZE   16
+
+
+int main(int    argc,
+         char **argv)
+{
+char        *version, *fileout;
+l_int32      i, j, nops, nreps, nthreads, level, skipped;
+l_int64      startallocs, startbytes, allocs, peak;
+l_float64    t, best, sum, mpix;
+FILE        *fp;
+L_WALLTIMER *timer;
+PIX         *pixs[3];
+static char  mainName[] = "benchmark";
+
+    if (argc > 5)
+        return ERROR_INT(
+            " Syntax: benchmark [nreps [nthreads [simdlevel [fileout]]]]",
+            mainName, 1);
+    nreps = (argc > 1) ? atoi(argv[1]) : 3;
+    nthreads = (argc > 2) ? atoi(argv[2]) : 1;
+    level = (argc > 3) ? atoi(argv[3]) : L_SIMD_AVX2;
+    fileout = (argc > 4) ? argv[4] : NULL;
+    if (nreps < 1 || nthreads < 1)
+        return ERROR_INT("nreps and nthreads must be > 0", mainName, 1);
+
+        /* The memory manager must be installed before any pix is made */
+    mutex = l_mutexCreate();
+    setPixMemoryManager(CountingAlloc, CountingFree);
+    l_setNumThreads(nthreads);
+    l_setSimdLevel(level);
+
+    for (i = 0; i < 3; i++) {
+        if ((pixs[i] = pixRead(files[i])) == NULL)
+            return ERROR_INT("test image not read", mainName, 1);
+    }
+    if (pixGetDepth(pixs[BIN]) != 1 || pixGetDepth(pixs[GRAY]) != 8 ||
+        pixGetDepth(pixs[RGB]) != 32)
+        return ERROR_INT("test images have wrong depth", mainName, 1);
+
+    if (fileout) {
+        if ((fp = fopenWriteStream(fileout, "w")) == NULL)
+            return ERROR_INT("fp not opened", mainName, 1);
+    } else {
+        fp = stdout;
+    }
+    version = getLeptonicaVersion();
+    fprintf(fp, "# %s\tnreps=%d\tnthreads=%d\tsimdlevel=%d\n",
+            version, nreps, nthreads, l_getSimdLevel());
+    lept_free(version);
+    fprintf(fp, "# group\tname\tmpix\treps\tbest\tmean\tmpix/s\t"
+            "allocs\tpeak_kb\trss_kb\n");
+
+    nops = sizeof(ops) / sizeof(BENCHOP);
+    for (i = 0; i < nops; i++) {
+        fprintf(stderr, "%s ... ", ops[i].name);
+        mpix = 1.0e-6 * pixGetWidth(pixs[ops[i].input]) *
+               pixGetHeight(pixs[ops[i].input]);
+        l_mutexLock(mutex);
+        startallocs = nallocs;
+        startbytes = peakbytes = curbytes;
+        l_mutexUnlock(mutex);
+        best = 1.0e20;
+        sum = 0.0;
+        skipped = FALSE;
+        for (j = 0; j < nreps; j++) {
+            timer = startWallTimer();
+            if (ops[i].func(pixs[ops[i].input]))
+                skipped = TRUE;
+            t = stopWallTimer(&timer);
+            if (skipped) break;
+            best = L_MIN(best, t);
+            sum += t;
+        }
+        l_mutexLock(mutex);
+        allocs = (nallocs - startallocs) / nreps;
+        peak = (peakbytes - startbytes) / 1024;
+        l_mutexUnlock(mutex);
+
+        if (skipped) {
+            fprintf(fp, "%s\t%s\t%.3f\tskipped\n", ops[i].group,
+                    ops[i].name, mpix);
+            fprintf(stderr, "skipped\n");
+            continue;
+        }
+        fprintf(fp, "%s\t%s\t%.3f\t%d\t%.5f\t%.5f\t%.2f\t%lld\t%lld\t%lld\n",
+                ops[i].group, ops[i].name, mpix, nreps, best, sum / nreps,
+                (best > 0.0) ? mpix / best : 0.0, (long long)allocs,
+                (long long)peak, (long long)GetPeakRss());
+        fprintf(stderr, "%.5f sec\n", best);
+    }
+
+    if (fileout)
+        fclose(fp);
+    for (i = 0; i < 3; i++)
+        pixDestroy(&pixs[i]);
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------*
+ *                             Operations                              *
+ *---------------------------------------------------------------------*/
+static l_int32
+DilateBrick(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixDilateBrick(NULL, pixs, 15, 15);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+OpenBrick(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixOpenBrick(NULL, pixs, 21, 21);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+MorphSequence(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixMorphSequence(pixs, "c5.1 + o1.5 + d3.3 + e2.2", 0);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+ErodeGray(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixErodeGray(pixs, 7, 7);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+ScaleToGray4(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixScaleToGray4(pixs);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+ScaleAreaMap(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixScaleAreaMap(pixs, 0.37, 0.37);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+ScaleLI(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixScaleLI(pixs, 2.3, 2.3);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+RotateShear(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixRotate(pixs, 0.035, L_ROTATE_SHEAR, L_BRING_IN_WHITE, 0, 0);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+RotateAreaMap(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixRotate(pixs, 0.087, L_ROTATE_AREA_MAP, L_BRING_IN_WHITE, 0, 0);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+RotateOrth(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixRotateOrth(pixs, 1);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+RGBToGray(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixConvertRGBToLuminance(pixs);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+OtsuBinarize(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixOtsuAdaptiveThreshold(pixs, 300, 300, 0, 0, 0.1, NULL, &pixd);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+SauvolaBinarize(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixSauvolaBinarize(pixs, 7, 0.34, 1, NULL, NULL, NULL, &pixd);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+ConnCompBB(PIX  *pixs)
+{
+BOXA  *boxa;
+
+    boxa = pixConnCompBB(pixs, 8);
+    boxaDestroy(&boxa);
+    return 0;
+}
+
+
+static l_int32
+ConnCompPixa(PIX  *pixs)
+{
+BOXA  *boxa;
+PIXA  *pixa;
+
+    boxa = pixConnCompPixa(pixs, &pixa, 4);
+    boxaDestroy(&boxa);
+    pixaDestroy(&pixa);
+    return 0;
+}
+
+
+    /* Encodes to memory and decodes.  Returns 1 if the format is
+     * not available. */
+static l_int32
+WriteReadFormat(PIX      *pixs,
+                l_int32   format)
+{
+l_uint8  *data;
+size_t    size;
+PIX      *pixd;
+
+    if (pixWriteMem(&data, &size, pixs, format))
+        return 1;
+    pixd = pixReadMem(data, size);
+    lept_free(data);
+    if (!pixd)
+        return 1;
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+PngIO(PIX  *pixs)
+{
+    return WriteReadFormat(pixs, IFF_PNG);
+}
+
+
+static l_int32
+JpegIO(PIX  *pixs)
+{
+    return WriteReadFormat(pixs, IFF_JFIF_JPEG);
+}
+
+
+static l_int32
+TiffG4IO(PIX  *pixs)
+{
+    return WriteReadFormat(pixs, IFF_TIFF_G4);
+}
+
+
+static l_int32
+OctreeQuant(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixOctreeColorQuant(pixs, 128, 0);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+static l_int32
+MedianCutQuant(PIX  *pixs)
+{
+PIX  *pixd;
+
+    pixd = pixMedianCutQuant(pixs, 0);
+    pixDestroy(&pixd);
+    return 0;
+}
+
+
+/*---------------------------------------------------------------------*
+ *                    Counting pix memory manager                      *
+ *---------------------------------------------------------------------*/
+static void *
+CountingAlloc(size_t  size)
+{
+l_uint8  *ptr;
+
+    if ((ptr = (l_uint8 *)malloc(size + HEADER_SIZE)) == NULL)
+        return NULL;
+    *(size_t *)ptr = size;
+    l_mutexLock(mutex);
+    nallocs++;
+    curbytes += size;
+    if (curbytes > peakbytes)
+        peakbytes = curbytes;
+    l_mutexUnlock(mutex);
+    return ptr + HEADER_SIZE;
+}
+
+
+static void
+CountingFree(void  *ptr)
+{
+l_uint8  *base;
+
+    if (!ptr) return;
+    base = (l_uint8 *)ptr - HEADER_SIZE;
+    l_mutexLock(mutex);
+    curbytes -= *(size_t *)base;
+    l_mutexUnlock(mutex);
+    free(base);
+}
+
+
+    /* Returns the peak resident set size of the process in KB, or 0
+     * if it is not available */
+static l_int64
+GetPeakRss(void)
+{
+#ifndef _WIN32
+struct rusage  usage;
+
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+#if defined(__APPLE__)
+    return (l_int64)usage.ru_maxrss / 1024;  /* bytes */
+#else
+    return (l_int64)usage.ru_maxrss;  /* KB */
+#endif  /* __APPLE__ */
+#else
+    return 0;
+#endif  /* !_WIN32 */
+}
@@ -34,11 +34,15 @@
  *     separable operation with full resolution intermediate images.
  *     Using 4x reduction on intermediates, this runs at about
  *     3 MPix/sec, with very good quality.
+ *
+ *     The result does not depend on the number of threads used
+ *     for the bands of intermediate images.
  */
 
 #include "allheaders.h"
 
 static void DoTestsOnImage(PIX *pixs, L_REGPARAMS *rp);
+static void TestThreads(PIX *pixs, L_REGPARAMS *rp);
 
 static const l_int32  ncomps = 10;
 
@@ -53,6 +57,7 @@ L_REGPARAMS  *rp;
 
     pixs = pixRead("test24.jpg");
     DoTestsOnImage(pixs, rp);  /* 0 - 7 */
+    TestThreads(pixs, rp);  /* 8 - 9 */
     pixDestroy(&pixs);
 
     return regTestCleanup(rp);
@@ -99,3 +104,25 @@ PIXA  *pixa;
 }
 
 
+static void
+TestThreads(PIX          *pixs,
+            L_REGPARAMS  *rp)
+{
+l_int32  nthreads;
+PIX     *pix1, *pix2, *pix3, *pix4;
+
+    nthreads = l_setNumThreads(1);
+    pix1 = pixBilateral(pixs, 5.0, 20.0, ncomps, 1);
+    pix2 = pixBilateral(pixs, 10.0, 40.0, ncomps, 2);
+    l_setNumThreads(4);
+    pix3 = pixBilateral(pixs, 5.0, 20.0, ncomps, 1);
+    pix4 = pixBilateral(pixs, 10.0, 40.0, ncomps, 2);
+    l_setNumThreads(nthreads);
+    regTestComparePix(rp, pix1, pix3);  /* 8 */
+    regTestComparePix(rp, pix2, pix4);  /* 9 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+    return;
+}
@@ -37,6 +37,8 @@ PIX *PixTest2(PIX *pixs, l_int32 size, l_float32 factor, l_int32 nx,
               l_int32 ny, L_REGPARAMS *rp);
 void PixTest3(PIX *pixs, l_int32 size, l_float32 factor,
               l_int32 nx, l_int32 ny, l_int32 paircount, L_REGPARAMS *rp);
+void PixTest4(PIX *pixs, l_int32 size, l_float32 factor,
+              l_int32 nx, l_int32 ny, L_REGPARAMS *rp);
 
 int main(int    argc,
          char **argv)
@@ -71,6 +73,10 @@ L_REGPARAMS  *rp;
     pixDestroy(&pixt1);
     pixDestroy(&pixt2);
 
+        /* Tiled results are the same with several threads */
+    PixTest4(pixs, 7, 0.34, 6, 5, rp);
+    PixTest4(pixs, 12, 0.20, 9, 9, rp);
+
     pixDestroy(&pixs);
     return regTestCleanup(rp);
 }
@@ -177,3 +183,34 @@ PIX  *pixt1, *pixt2;
     pixDestroy(&pixt2);
     return;
 }
+
+
+void
+PixTest4(PIX          *pixs,
+         l_int32       size,
+         l_float32     factor,
+         l_int32       nx,
+         l_int32       ny,
+         L_REGPARAMS  *rp)
+{
+l_int32  oldnthreads;
+PIX     *pixth1, *pixd1, *pixth2, *pixd2, *pixt1, *pixt2;
+
+    oldnthreads = l_setNumThreads(1);
+    pixSauvolaBinarizeTiled(pixs, size, factor, nx, ny, &pixth1, &pixd1);
+    pixOtsuAdaptiveThreshold(pixs, 40, 50, 2, 2, 0.1, NULL, &pixt1);
+    l_setNumThreads(4);
+    pixSauvolaBinarizeTiled(pixs, size, factor, nx, ny, &pixth2, &pixd2);
+    pixOtsuAdaptiveThreshold(pixs, 40, 50, 2, 2, 0.1, NULL, &pixt2);
+    l_setNumThreads(oldnthreads);
+    regTestComparePix(rp, pixth1, pixth2);
+    regTestComparePix(rp, pixd1, pixd2);
+    regTestComparePix(rp, pixt1, pixt2);
+    pixDestroy(&pixth1);
+    pixDestroy(&pixd1);
+    pixDestroy(&pixth2);
+    pixDestroy(&pixd2);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    return;
+}
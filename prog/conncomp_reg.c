@@ -31,6 +31,10 @@
  *        connected), including regeneration of the original
  *        image from the components.  This is also an implicit
  *        test of rasterop.
+ *
+ *        The c.c. from pixConnComp() are compared with those found
+ *        one at a time with the seedfill functions, and the results
+ *        with several threads are compared with those with one thread.
  */
 
 #include <string.h>
@@ -38,16 +42,21 @@
 
 #define  NTIMES             10
 
+static BOXA *ConnCompBySeedfill(PIX *pixs, PIXA **ppixa,
+                                l_int32 connectivity);
+static l_int32 CompareConnComp(BOXA *boxa1, PIXA *pixa1, BOXA *boxa2,
+                               PIXA *pixa2);
+
 int main(int    argc,
          char **argv)
 {
 l_uint8     *array1, *array2;
-l_int32      n, np, same, diff;
+l_int32      i, j, n, np, x, y, same, equal, diff, conn, count, nthreads;
 size_t       nbytes1, nbytes2;
 FILE        *fp;
 BOXA        *boxa, *boxa2;
-PIX         *pixs, *pixd;
-PIXA        *pixa;
+PIX         *pixs, *pixd, *pixd2, *pixt;
+PIXA        *pixa, *pixa2;
 PIXCMAP     *cmap;
 static char  mainName[] = "conncomp_reg";
 
@@ -125,8 +134,104 @@ static char  mainName[] = "conncomp_reg";
     pixDestroy(&pixd);
     pixaDestroy(&pixa);
 
+        /* Compare with the c.c. found one at a time by seedfill,
+         * using 1 and 4 threads, and check the label image */
+    nthreads = l_getNumThreads();
+    for (i = 0; i < 4; i++) {
+        conn = (i % 2 == 0) ? 4 : 8;
+        l_setNumThreads((i < 2) ? 1 : 4);
+        boxa = ConnCompBySeedfill(pixs, &pixa, conn);
+        boxa2 = pixConnCompLabels(pixs, &pixa2, &pixd, conn);
+        same = CompareConnComp(boxa, pixa, boxa2, pixa2);
+        pixCountConnComp(pixs, conn, &count);
+        if (count != boxaGetCount(boxa)) same = FALSE;
+        pixd2 = pixCreateTemplate(pixd);
+        for (j = 0; j < count; j++) {
+            boxaGetBoxGeometry(boxa, j, &x, &y, NULL, NULL);
+            pixt = pixaGetPix(pixa, j, L_CLONE);
+            pixSetMaskedGeneral(pixd2, pixt, j + 1, x, y);
+            pixDestroy(&pixt);
+        }
+        pixEqual(pixd, pixd2, &equal);
+        if (!equal) same = FALSE;
+        pixDestroy(&pixd2);
+        if (same) fprintf(stderr, "Seedfill and labelled c.c. are the same\n");
+        else fprintf(stderr, "Error: seedfill and labelled c.c. differ!\n");
+        boxaDestroy(&boxa);
+        boxaDestroy(&boxa2);
+        pixaDestroy(&pixa);
+        pixaDestroy(&pixa2);
+        pixDestroy(&pixd);
+    }
+    l_setNumThreads(nthreads);
+
     pixDestroy(&pixs);
     return 0;
 }
 
 
+    /* Finds the c.c. in raster order, erasing each one with seedfill */
+static BOXA *
+ConnCompBySeedfill(PIX      *pixs,
+                   PIXA    **ppixa,
+                   l_int32   connectivity)
+{
+l_int32   x, y, xstart, ystart;
+BOX      *box;
+BOXA     *boxa;
+PIX      *pixt1, *pixt2, *pixt3, *pixt4;
+L_STACK  *stack;
+
+    pixt1 = pixCopy(NULL, pixs);
+    pixt2 = pixCopy(NULL, pixs);
+    stack = lstackCreate(pixGetHeight(pixs));
+    stack->auxstack = lstackCreate(0);
+    boxa = boxaCreate(0);
+    *ppixa = pixaCreate(0);
+    xstart = ystart = 0;
+    while (nextOnPixelInRaster(pixt1, xstart, ystart, &x, &y)) {
+        box = pixSeedfillBB(pixt1, stack, x, y, connectivity);
+        pixt3 = pixClipRectangle(pixt1, box, NULL);
+        pixt4 = pixClipRectangle(pixt2, box, NULL);
+        pixXor(pixt3, pixt3, pixt4);
+        pixRasterop(pixt2, box->x, box->y, box->w, box->h, PIX_SRC ^ PIX_DST,
+                    pixt3, 0, 0);
+        boxaAddBox(boxa, box, L_INSERT);
+        pixaAddPix(*ppixa, pixt3, L_INSERT);
+        pixDestroy(&pixt4);
+        xstart = x;
+        ystart = y;
+    }
+
+    lstackDestroy(&stack, TRUE);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    return boxa;
+}
+
+
+    /* Returns 1 if the boxes and images are the same, in the same order */
+static l_int32
+CompareConnComp(BOXA  *boxa1,
+                PIXA  *pixa1,
+                BOXA  *boxa2,
+                PIXA  *pixa2)
+{
+l_int32  i, n, same;
+PIX     *pix1, *pix2;
+
+    boxaEqual(boxa1, boxa2, 0, NULL, &same);
+    n = pixaGetCount(pixa1);
+    if (!same || n != pixaGetCount(pixa2))
+        return 0;
+    for (i = 0; i < n && same; i++) {
+        pix1 = pixaGetPix(pixa1, i, L_CLONE);
+        pix2 = pixaGetPix(pixa2, i, L_CLONE);
+        pixEqual(pix1, pix2, &same);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+    return same;
+}
+
+
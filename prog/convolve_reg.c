@@ -51,8 +51,10 @@ static const char  *kel3ystr = "  20  -70   40  100   40  -70  20 ";
 int main(int    argc,
          char **argv)
 {
-l_int32       i, j, sizex, sizey, bias;
-FPIX         *fpixv, *fpixrv;
+l_int32       i, j, sizex, sizey, bias, w, h, same;
+l_float32     diff, val, sum;
+BOX          *box;
+FPIX         *fpixv, *fpixrv, *fpix1, *fpix2;
 L_KERNEL     *kel1, *kel2, *kel3x, *kel3y;
 PIX          *pixs, *pixacc, *pixg, *pixt, *pixd;
 PIX          *pixb, *pixm, *pixms, *pixrv, *pix1, *pix2, *pix3, *pix4;
@@ -203,5 +205,80 @@ L_REGPARAMS  *rp;
     fpixDestroy(&fpixv);
     fpixDestroy(&fpixrv);
 
+        /* Test pixGaussianBlur() against convolution with a gaussian
+         * kernel, away from the boundary */
+    pixs = pixRead("test8.jpg");
+    pixGetDimensions(pixs, &w, &h, NULL);
+    box = boxCreate(40, 40, w - 80, h - 80);
+    for (i = 0; i < 2; i++) {
+        sizex = (i == 0) ? 4 : 10;
+        makeGaussianKernelSep(4 * sizex, 4 * sizex, sizex, 1.0,
+                              &kel3x, &kel3y);
+        pix1 = pixConvolveSep(pixs, kel3x, kel3y, 8, 1);
+        pix2 = pixGaussianBlur(pixs, sizex, sizex);
+        pix3 = pixClipRectangle(pix1, box, NULL);
+        pix4 = pixClipRectangle(pix2, box, NULL);
+        pixd = pixAbsDifference(pix3, pix4);
+        pixGetAverageMasked(pixd, NULL, 0, 0, 1, L_MEAN_ABSVAL, &diff);
+        regTestCompareValues(rp, 0.0, diff, 1.5);  /* 18, 19 */
+        kernelDestroy(&kel3x);
+        kernelDestroy(&kel3y);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pix3);
+        pixDestroy(&pix4);
+        pixDestroy(&pixd);
+    }
+    boxDestroy(&box);
+    pixDestroy(&pixs);
+
+        /* A constant image is unchanged, and with large sigma, a point
+         * spreads with no loss */
+    pix1 = pixCreate(300, 5, 8);
+    pixSetAllArbitrary(pix1, 137);
+    pix2 = pixGaussianBlur(pix1, 100.0, 100.0);
+    pixEqual(pix1, pix2, &same);
+    regTestCompareValues(rp, 1, same, 0);  /* 20 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    fpix1 = fpixCreate(2001, 3);
+    fpixSetPixel(fpix1, 1000, 1, 1000.0);
+    fpix2 = fpixGaussianBlur(fpix1, 100.0, 0.0);
+    for (j = 0, sum = 0.0; j < 2001; j++) {
+        fpixGetPixel(fpix2, j, 1, &val);
+        sum += val;
+    }
+    regTestCompareValues(rp, 1000.0, sum, 0.1);  /* 21 */
+    fpixDestroy(&fpix1);
+    fpixDestroy(&fpix2);
+
+        /* Test pixUnsharpMaskingGauss() against unsharp masking with
+         * convolution by a gaussian kernel, away from the boundary */
+    pixs = pixRead("test8.jpg");
+    pixGetDimensions(pixs, &w, &h, NULL);
+    box = boxCreate(40, 40, w - 80, h - 80);
+    makeGaussianKernelSep(16, 16, 4.0, 1.0, &kel3x, &kel3y);
+    fpix1 = pixConvertToFPix(pixs, 1);
+    fpix2 = fpixConvolveSep(fpix1, kel3x, kel3y, 1);
+    fpixLinearCombination(fpix1, fpix1, fpix2, 1.5, -0.5);
+    pix1 = fpixConvertToPix(fpix1, 8, L_CLIP_TO_ZERO, 0);
+    pix2 = pixUnsharpMaskingGauss(pixs, 4.0, 0.5);
+    pix3 = pixClipRectangle(pix1, box, NULL);
+    pix4 = pixClipRectangle(pix2, box, NULL);
+    pixd = pixAbsDifference(pix3, pix4);
+    pixGetAverageMasked(pixd, NULL, 0, 0, 1, L_MEAN_ABSVAL, &diff);
+    regTestCompareValues(rp, 0.0, diff, 0.5);  /* 22 */
+    kernelDestroy(&kel3x);
+    kernelDestroy(&kel3y);
+    fpixDestroy(&fpix1);
+    fpixDestroy(&fpix2);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+    pixDestroy(&pixd);
+    boxDestroy(&box);
+    pixDestroy(&pixs);
+
     return regTestCleanup(rp);
 }
@@ -0,0 +1,172 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  distance2_reg.c
+ *
+ *    Tests the exact Euclidean distance function, against a brute
+ *    force search for the nearest bg pixel, for both boundary
+ *    conditions, output depths and numbers of threads.
+ */
+
+#include <math.h>
+#include "allheaders.h"
+
+static l_int32 CountDistanceDiffs(PIX *pixs, PIX *pixd, l_int32 boundcond);
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       nthreads;
+l_uint32      val;
+l_float32     fval;
+BOX          *box;
+FPIX         *fpix;
+PIX          *pixs, *pix1, *pix2, *pix3, *pix4;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Exact squared distances, compared with a brute force search */
+    pix1 = pixRead("coffeebeans.png");
+    box = boxCreate(60, 80, 90, 70);
+    pixs = pixClipRectangle(pix1, box, NULL);
+    pixDestroy(&pix1);
+    boxDestroy(&box);
+    pix1 = pixEuclideanDistanceSquared(pixs, L_BOUNDARY_BG);
+    regTestCompareValues(rp, 0, CountDistanceDiffs(pixs, pix1,
+                         L_BOUNDARY_BG), 0);  /* 0 */
+    pix2 = pixEuclideanDistanceSquared(pixs, L_BOUNDARY_FG);
+    regTestCompareValues(rp, 0, CountDistanceDiffs(pixs, pix2,
+                         L_BOUNDARY_FG), 0);  /* 1 */
+    pixDestroy(&pix2);
+
+        /* The squared mode is the same at 32 bpp, and the rounded
+         * distance agrees with the float distance */
+    pix2 = pixEuclideanDistance(pixs, 32, 1, L_BOUNDARY_BG);
+    regTestComparePix(rp, pix1, pix2);  /* 2 */
+    pix3 = pixEuclideanDistance(pixs, 16, 0, L_BOUNDARY_BG);
+    fpix = pixEuclideanDistanceFPix(pixs, L_BOUNDARY_BG);
+    pix4 = fpixConvertToPix(fpix, 16, L_CLIP_TO_ZERO, 0);
+    regTestComparePix(rp, pix3, pix4);  /* 3 */
+    pixGetPixel(pix1, 45, 35, &val);
+    fpixGetPixel(fpix, 45, 35, &fval);
+    regTestCompareValues(rp, sqrt((l_float64)val), fval, 0.0001);  /* 4 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+    fpixDestroy(&fpix);
+    pixDestroy(&pixs);
+
+        /* The result does not depend on the number of threads */
+    pixs = pixRead("arabic.png");
+    nthreads = l_getNumThreads();
+    l_setNumThreads(1);
+    pix1 = pixEuclideanDistance(pixs, 32, 1, L_BOUNDARY_BG);
+    pix2 = pixEuclideanDistance(pixs, 32, 1, L_BOUNDARY_FG);
+    l_setNumThreads(4);
+    pix3 = pixEuclideanDistance(pixs, 32, 1, L_BOUNDARY_BG);
+    pix4 = pixEuclideanDistance(pixs, 32, 1, L_BOUNDARY_FG);
+    l_setNumThreads(nthreads);
+    regTestComparePix(rp, pix1, pix3);  /* 5 */
+    regTestComparePix(rp, pix2, pix4);  /* 6 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+
+        /* Distances of the bg from the fg, saturating at 8 bpp */
+    pix1 = pixInvert(NULL, pixs);
+    pix2 = pixEuclideanDistance(pix1, 8, 0, L_BOUNDARY_FG);
+    pix3 = pixEuclideanDistance(pix1, 16, 0, L_BOUNDARY_FG);
+    pix4 = pixConvert16To8(pix3, L_CLIP_TO_255);
+    regTestComparePix(rp, pix2, pix4);  /* 7 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+    pixDestroy(&pixs);
+
+        /* With no bg pixels, the distance is 1 at the image boundary
+         * for L_BOUNDARY_BG, and larger than any distance otherwise */
+    pixs = pixCreate(50, 30, 1);
+    pixSetAll(pixs);
+    pix1 = pixEuclideanDistance(pixs, 16, 0, L_BOUNDARY_BG);
+    pixGetPixel(pix1, 0, 10, &val);
+    regTestCompareValues(rp, 1, val, 0);  /* 8 */
+    pixGetPixel(pix1, 25, 15, &val);
+    regTestCompareValues(rp, 15, val, 0);  /* 9 */
+    pix2 = pixEuclideanDistance(pixs, 16, 0, L_BOUNDARY_FG);
+    pixGetPixel(pix2, 25, 15, &val);
+    regTestCompareValues(rp, 1, val >= 50 + 30, 0);  /* 10 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pixs);
+
+    return regTestCleanup(rp);
+}
+
+
+    /* Returns the number of pixels where the squared distance differs
+     * from that found by searching all bg pixels, including those
+     * just outside the image for L_BOUNDARY_BG */
+static l_int32
+CountDistanceDiffs(PIX     *pixs,
+                   PIX     *pixd,
+                   l_int32  boundcond)
+{
+l_int32   i, j, x, y, w, h, dist, mindist, ndiffs;
+l_uint32  val;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    ndiffs = 0;
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < w; j++) {
+            mindist = 1000000000;
+            if (boundcond == L_BOUNDARY_BG) {
+                mindist = L_MIN(j + 1, w - j);
+                mindist = L_MIN(mindist, L_MIN(i + 1, h - i));
+                mindist *= mindist;
+            }
+            for (y = 0; y < h; y++) {
+                for (x = 0; x < w; x++) {
+                    pixGetPixel(pixs, x, y, &val);
+                    if (val) continue;
+                    dist = (x - j) * (x - j) + (y - i) * (y - i);
+                    mindist = L_MIN(mindist, dist);
+                }
+            }
+            pixGetPixel(pixd, j, i, &val);
+            if (val != mindist)
+                ndiffs++;
+        }
+    }
+    return ndiffs;
+}
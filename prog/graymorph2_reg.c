@@ -29,6 +29,10 @@
  *
  *   Compares graymorph results with special (3x1, 1x3, 3x3) cases
  *   against the general case.  Require exact equality.
+ *
+ *   Also compares graymorph with even Sel sizes, on an image with
+ *   values 0 and 255, against binary morphology with the same bricks,
+ *   and the tophat against opening and closing followed by subtraction.
  */
 
 #include "allheaders.h"
@@ -36,7 +40,7 @@
 int main(int    argc,
          char **argv)
 {
-PIX          *pixs, *pixt1, *pixt2, *pixd;
+PIX          *pixs, *pixt1, *pixt2, *pixt3, *pixd, *pixb, *pixb8;
 PIXA         *pixa;
 L_REGPARAMS  *rp;
 
@@ -173,6 +177,60 @@ L_REGPARAMS  *rp;
     pixDestroy(&pixd);
     pixaDestroy(&pixa);
 
+        /* Even sizes: compare with binary brick morphology */
+    pixb = pixRead("test1.png");
+    pixb8 = pixConvert1To8(NULL, pixb, 0, 255);
+    pixt1 = pixDilateGray(pixb8, 4, 6);
+    pixt3 = pixDilateBrick(NULL, pixb, 4, 6);
+    pixt2 = pixConvert1To8(NULL, pixt3, 0, 255);
+    regTestComparePix(rp, pixt1, pixt2);  /* 12 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+
+    pixt1 = pixErodeGray(pixb8, 2, 5);
+    pixt3 = pixErodeBrick(NULL, pixb, 2, 5);
+    pixt2 = pixConvert1To8(NULL, pixt3, 0, 255);
+    regTestComparePix(rp, pixt1, pixt2);  /* 13 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+
+    pixt1 = pixOpenGray(pixb8, 8, 1);
+    pixt3 = pixOpenBrick(NULL, pixb, 8, 1);
+    pixt2 = pixConvert1To8(NULL, pixt3, 0, 255);
+    regTestComparePix(rp, pixt1, pixt2);  /* 14 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+
+    pixt1 = pixOpenGray(pixb8, 6, 4);
+    pixt3 = pixOpenBrick(NULL, pixb, 6, 4);
+    pixt2 = pixConvert1To8(NULL, pixt3, 0, 255);
+    regTestComparePix(rp, pixt1, pixt2);  /* 15 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+    pixDestroy(&pixb);
+    pixDestroy(&pixb8);
+
+        /* Tophat */
+    pixt1 = pixTophat(pixs, 3, 3, L_TOPHAT_WHITE);
+    pixt3 = pixOpenGray(pixs, 3, 3);
+    pixt2 = pixSubtractGray(NULL, pixs, pixt3);
+    regTestComparePix(rp, pixt1, pixt2);  /* 16 */
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
+
+    pixt1 = pixTophat(pixs, 10, 7, L_TOPHAT_BLACK);
+    pixt2 = pixCloseGray(pixs, 10, 7);
+    pixSubtractGray(pixt2, pixt2, pixs);
+    regTestComparePix(rp, pixt1, pixt2);  /* 17 */
+    pixDisplayWithTitle(pixt1, 1100, 100, "Tophat", rp->display);
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+
     pixDestroy(&pixs);
     return regTestCleanup(rp);
 }
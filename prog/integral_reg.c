@@ -0,0 +1,243 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  integral_reg.c
+ *
+ *    Tests the integral image: sums in rectangles, statistics in
+ *    windows, tiles and quadtrees, and the functions that use it.
+ */
+
+#include "allheaders.h"
+
+static l_int32 CountSumDiffs(L_INTEGRAL *li, PIX *pixs);
+static l_float32 MaxFPixaDiff(FPIXA *fpixa1, FPIXA *fpixa2);
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       w, h, nx, npix, count;
+l_uint32      val;
+l_uint64      sum, sumsq;
+l_float32     mean, var, val1, val2;
+BOX          *box;
+FPIX         *fpixm, *fpixv, *fpixrv;
+FPIXA        *fpixa1, *fpixa2;
+L_INTEGRAL   *li;
+PIX          *pixs, *pixb, *pix1, *pix2, *pix3, *pix4, *pix5;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = pixRead("test8.jpg");
+    pixGetDimensions(pixs, &w, &h, NULL);
+
+        /* Sums in rectangles, including rectangles that are clipped */
+    li = l_integralCreate(pixs, 1);
+    regTestCompareValues(rp, 0, CountSumDiffs(li, pixs), 0);  /* 0 */
+    l_integralGetSums(li, w, 0, 10, 10, &sum, &sumsq, &npix);
+    regTestCompareValues(rp, 0, sum + sumsq + npix, 0);  /* 1 */
+
+        /* Windowed statistics are the same as those from the
+         * windowed functions, on an image with a border */
+    l_integralDestroy(&li);
+    pixb = pixAddMirroredBorder(pixs, 8, 8, 6, 6);
+    li = l_integralCreate(pixb, 1);
+    l_integralWindowedStats(li, 7, 5, 1, &pix1, &pix2, NULL, NULL);
+    pix3 = pixWindowedMean(pixb, 7, 5, 1, 1);
+    pix4 = pixWindowedMeanSquare(pixb, 7, 5, 1);
+    regTestComparePix(rp, pix1, pix3);  /* 2 */
+    regTestComparePix(rp, pix2, pix4);  /* 3 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+
+        /* The same integral image for another window size */
+    l_integralWindowedStats(li, 3, 3, 1, &pix1, NULL, NULL, NULL);
+    pix2 = pixWindowedMean(pixb, 3, 3, 1, 1);
+    regTestComparePix(rp, pix1, pix2);  /* 4 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    l_integralDestroy(&li);
+
+        /* Without a border, the window is clipped to the image */
+    li = l_integralCreate(pixs, 1);
+    l_integralWindowedStats(li, 7, 5, 0, &pix1, NULL, &fpixv, NULL);
+    box = boxCreate(0, 0, 8, 6);  /* window about (0, 0) */
+    l_integralGetStats(li, box, &mean, &var, NULL);
+    pixGetPixel(pix1, 0, 0, &val);
+    regTestCompareValues(rp, (l_int32)mean, val, 0);  /* 5 */
+    fpixGetPixel(fpixv, 0, 0, &val1);
+    regTestCompareValues(rp, var, val1, 0.001);  /* 6 */
+    boxDestroy(&box);
+    box = boxCreate(100 - 7, 120 - 5, 15, 11);  /* window about (100, 120) */
+    l_integralGetStats(li, box, NULL, &var, NULL);
+    fpixGetPixel(fpixv, 100, 120, &val1);
+    regTestCompareValues(rp, var, val1, 0.001);  /* 7 */
+    boxDestroy(&box);
+    regTestCompareValues(rp, w, pixGetWidth(pix1), 0);  /* 8 */
+    pixDestroy(&pix1);
+    fpixDestroy(&fpixv);
+
+        /* Tiles, including partial tiles at the right and bottom */
+    l_integralTiledStats(li, 64, 50, &fpixm, NULL, &fpixrv);
+    fpixGetDimensions(fpixm, &nx, NULL);
+    regTestCompareValues(rp, (w + 63) / 64, nx, 0);  /* 9 */
+    box = boxCreate(64 * (nx - 1), 50, 64, 50);
+    l_integralGetStats(li, box, &val1, NULL, &val2);
+    fpixGetPixel(fpixm, nx - 1, 1, &mean);
+    regTestCompareValues(rp, val1, mean, 0.0);  /* 10 */
+    fpixGetPixel(fpixrv, nx - 1, 1, &var);
+    regTestCompareValues(rp, val2, var, 0.0);  /* 11 */
+    boxDestroy(&box);
+    fpixDestroy(&fpixm);
+    fpixDestroy(&fpixrv);
+    l_integralDestroy(&li);
+
+        /* Quadtree statistics with and without the integral image */
+    pixQuadtreeMean(pixs, 5, NULL, &fpixa1);
+    pix1 = pixBlockconvAccum(pixs);
+    pixQuadtreeMean(pixs, 5, pix1, &fpixa2);
+    regTestCompareValues(rp, 0.0, MaxFPixaDiff(fpixa1, fpixa2), 0.001);  /* 12 */
+    fpixaDestroy(&fpixa1);
+    fpixaDestroy(&fpixa2);
+    pixQuadtreeVariance(pixs, 5, NULL, NULL, NULL, &fpixa1);
+    pixQuadtreeVariance(pixs, 5, pix1, NULL, NULL, &fpixa2);
+    regTestCompareValues(rp, 0.0, MaxFPixaDiff(fpixa1, fpixa2), 0.01);  /* 13 */
+    fpixaDestroy(&fpixa1);
+    fpixaDestroy(&fpixa2);
+    pixDestroy(&pix1);
+
+        /* Sauvola binarization from the integral image is the same
+         * as from the separate mean and mean square */
+    pixDestroy(&pixb);
+    pixb = pixAddMirroredBorder(pixs, 8, 8, 8, 8);
+    pix1 = pixWindowedMean(pixb, 7, 7, 1, 1);
+    pix2 = pixWindowedMeanSquare(pixb, 7, 7, 1);
+    pix3 = pixSauvolaGetThreshold(pix1, pix2, 0.35, &pix4);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixSauvolaBinarize(pixs, 7, 0.35, 1, NULL, &pix1, &pix2, &pix5);
+    regTestComparePix(rp, pix1, pix4);  /* 14 */
+    regTestComparePix(rp, pix2, pix3);  /* 15 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+    pixSauvolaBinarize(pixs, 7, 0.35, 1, NULL, &pix1, NULL, NULL);
+    regTestCompareValues(rp, 1, (pix1 != NULL), 0);  /* 16 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix5);
+
+        /* 1 bpp */
+    pix1 = pixConvertTo1(pixs, 128);
+    li = l_integralCreate(pix1, 0);
+    pixCountPixels(pix1, &count, NULL);
+    l_integralGetSums(li, 0, 0, w, h, &sum, NULL, NULL);
+    regTestCompareValues(rp, count, (l_float32)sum, 0);  /* 17 */
+    regTestCompareValues(rp, 0, CountSumDiffs(li, pix1), 0);  /* 18 */
+    l_integralDestroy(&li);
+    pixDestroy(&pix1);
+
+        /* The sum of squares exceeds 32 bits */
+    pix1 = pixCreate(300, 300, 8);
+    pixSetAll(pix1);
+    li = l_integralCreate(pix1, 1);
+    l_integralGetSums(li, 0, 0, 300, 300, NULL, &sumsq, NULL);
+    regTestCompareValues(rp, 1, sumsq == (l_uint64)255 * 255 * 90000, 0);  /* 19 */
+    l_integralGetStats(li, NULL, &mean, &var, NULL);
+    regTestCompareValues(rp, 255.0, mean, 0.0);  /* 20 */
+    regTestCompareValues(rp, 0.0, var, 0.0);  /* 21 */
+    l_integralDestroy(&li);
+    pixDestroy(&pix1);
+
+    pixDestroy(&pixb);
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+    /* Returns the number of rectangles where the sums from the
+     * integral image differ from the sums of the pixels */
+static l_int32
+CountSumDiffs(L_INTEGRAL  *li,
+              PIX         *pixs)
+{
+l_int32   i, j, k, x, y, bw, bh, w, h, npix, ndiffs;
+l_uint32  val;
+l_uint64  sum, sumsq, tsum, tsumsq;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    ndiffs = 0;
+    for (k = 0; k < 50; k++) {
+        x = (37 * k) % (w + 20) - 10;
+        y = (53 * k) % (h + 20) - 10;
+        bw = 1 + (29 * k) % 70;
+        bh = 1 + (41 * k) % 60;
+        tsum = tsumsq = 0;
+        for (i = L_MAX(0, y); i < L_MIN(h, y + bh); i++) {
+            for (j = L_MAX(0, x); j < L_MIN(w, x + bw); j++) {
+                pixGetPixel(pixs, j, i, &val);
+                tsum += val;
+                tsumsq += val * val;
+            }
+        }
+        l_integralGetSums(li, x, y, bw, bh, &sum,
+                          (pixGetDepth(pixs) == 8) ? &sumsq : NULL, &npix);
+        if (pixGetDepth(pixs) == 1)
+            sumsq = tsumsq;
+        if (sum != tsum || sumsq != tsumsq)
+            ndiffs++;
+    }
+    return ndiffs;
+}
+
+
+    /* Returns the largest difference between corresponding values */
+static l_float32
+MaxFPixaDiff(FPIXA  *fpixa1,
+             FPIXA  *fpixa2)
+{
+l_int32    i, j, k, n, w, h;
+l_float32  val1, val2, maxdiff;
+
+    maxdiff = 0.0;
+    n = fpixaGetCount(fpixa1);
+    for (k = 0; k < n; k++) {
+        fpixaGetFPixDimensions(fpixa1, k, &w, &h);
+        for (i = 0; i < h; i++) {
+            for (j = 0; j < w; j++) {
+                fpixaGetPixel(fpixa1, k, j, i, &val1);
+                fpixaGetPixel(fpixa2, k, j, i, &val2);
+                maxdiff = L_MAX(maxdiff, L_ABS(val1 - val2));
+            }
+        }
+    }
+    return maxdiff;
+}
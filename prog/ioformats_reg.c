@@ -34,7 +34,7 @@
  *
  *    This tests reading and writing of images in different formats
  *    It should work properly on input images of any depth, with
- *    and without colormaps.  There are 7 sections.
+ *    and without colormaps.  There are 8 sections.
  *
  *    Section 1. Test write/read with lossless and lossy compression, with
  *    and without colormaps.  The lossless results are tested for equality.
@@ -51,6 +51,8 @@
  *
  *    Section 7. Test header reading
  *
+ *    Section 8. Test tiff read/write in bands of rows
+ *
  *    This test requires the following external I/O libraries
  *        libjpeg, libtiff, libpng, libz
  *    and optionally tests these:
@@ -88,6 +90,9 @@ static l_int32 test_writemem(PIX *pixs, l_int32 format, char *psfile);
 static PIX *make_24_bpp_pix(PIX *pixs);
 static l_int32 get_header_data(const char *filename, l_int32 true_format);
 static void get_tiff_compression_name(char *buf, l_int32 format);
+static l_int32 test_tiffstream(const char *filename, l_int32 comptype,
+                               l_int32 nrows);
+static PIX *band_to_binary(PIX *pixs, void *data);
 
 LEPT_DLL extern const char *ImageFileFormatExtensions[];
 
@@ -516,6 +521,36 @@ part6:
             "\n  ******* Failure on reading headers *******\n\n");
     if (!success) failure = TRUE;
 
+    /* --------- Part 8: Read and write tiff in bands of rows --------- */
+    success = TRUE;
+    if (test_tiffstream(FILE_1BPP, IFF_TIFF_G4, 37)) success = FALSE;
+    if (test_tiffstream(FILE_8BPP_1, IFF_TIFF_ZIP, 50)) success = FALSE;
+    if (test_tiffstream(FILE_16BPP, IFF_TIFF_LZW, 64)) success = FALSE;
+    if (test_tiffstream(FILE_32BPP, IFF_TIFF_ZIP, 25)) success = FALSE;
+
+        /* Convert to gray and threshold, a band at a time */
+    pix = pixRead(FILE_32BPP);
+    pixWrite("/tmp/regout/junkband32.tif", pix, IFF_TIFF);
+    if (tiffstreamProcess("/tmp/regout/junkband32.tif", 0,
+                          "/tmp/regout/junkband1.tif", IFF_TIFF_G4, 30,
+                          band_to_binary, NULL))
+        success = FALSE;
+    pix1 = band_to_binary(pix, NULL);
+    pix2 = pixRead("/tmp/regout/junkband1.tif");
+    pixEqual(pix1, pix2, &same);
+    if (!same) success = FALSE;
+    pixDestroy(&pix);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+    if (success)
+        fprintf(stderr,
+            "\n  ******* Success on tiff r/w in bands *******\n\n");
+    else
+        fprintf(stderr,
+            "\n  ******* Failure on tiff r/w in bands *******\n\n");
+    if (!success) failure = TRUE;
+
 #if  !HAVE_LIBPNG || !HAVE_LIBJPEG || !HAVE_LIBTIFF
 finish:
 #endif  /* !HAVE_LIBPNG || !HAVE_LIBJPEG || !HAVE_LIBTIFF */
@@ -802,3 +837,51 @@ get_tiff_compression_name(char    *buf,
         fprintf(stderr, "format %d: not tiff\n", format);
     return;
 }
+
+
+    /* Writes the image at @filename to tiff, and copies it a band of
+     * @nrows at a time to another tiff file.  Returns 1 on error. */
+static l_int32
+test_tiffstream(const char  *filename,
+                l_int32      comptype,
+                l_int32      nrows)
+{
+l_int32         h, nextrow, same;
+PIX            *pixs, *pix1, *pix2;
+L_TIFF_STREAM  *tsin, *tsout;
+
+    pixs = pixRead(filename);
+    pixWrite("/tmp/regout/junkbandin.tif", pixs, comptype);
+    tsin = tiffstreamOpenRead("/tmp/regout/junkbandin.tif", 0);
+    tiffstreamGetInfo(tsin, NULL, &h, NULL, NULL);
+    tsout = tiffstreamOpenWrite("/tmp/regout/junkbandout.tif", h, comptype);
+    while ((pix1 = tiffstreamReadRows(tsin, nrows)) != NULL) {
+        tiffstreamWriteRows(tsout, pix1);
+        pixDestroy(&pix1);
+    }
+    tiffstreamGetInfo(tsin, NULL, NULL, NULL, &nextrow);
+    tiffstreamClose(&tsin);
+    tiffstreamClose(&tsout);
+
+    pix2 = pixRead("/tmp/regout/junkbandout.tif");
+    pixEqual(pixs, pix2, &same);
+    if (!same || nextrow != h)
+        fprintf(stderr, "Banded tiff r/w fail for %s\n", filename);
+    pixDestroy(&pixs);
+    pixDestroy(&pix2);
+    return (!same || nextrow != h);
+}
+
+
+    /* Band function for tiffstreamProcess() */
+static PIX *
+band_to_binary(PIX   *pixs,
+               void  *data)
+{
+PIX  *pix1, *pixd;
+
+    pix1 = pixConvertRGBToGray(pixs, 0.0, 0.0, 0.0);
+    pixd = pixThresholdToBinary(pix1, 130);
+    pixDestroy(&pix1);
+    return pixd;
+}
@@ -0,0 +1,176 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  jbclass_reg.c
+ *
+ *    Tests that jbig2 classification of a set of pages gives the
+ *    same classes, template placements and rendered pages when the
+ *    pages are read and the components are matched on several
+ *    threads, as when everything is done on one thread.
+ *    Also tests that the library functions that run in parallel
+ *    inside the page jobs do not start any more threads.
+ */
+
+#include "allheaders.h"
+
+static JBCLASSER *ClassifyPages(SARRAY *safiles, l_int32 method,
+                                l_int32 components, l_int32 nthreads);
+static l_int32 ClasserDiffs(JBCLASSER *classer1, JBCLASSER *classer2);
+
+static const char  *files[] = {"keystone.png", "cootoots.png",
+                               "copernicus.png"};
+
+
+int main(int    argc,
+         char **argv)
+{
+char          buf[256];
+l_int32       i, j, maxrunning;
+JBCLASSER    *classer1, *classer2;
+JBDATA       *data1, *data2;
+PIX          *pix1, *pix2;
+PIXA         *pixa1, *pixa2;
+SARRAY       *safiles;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Make 6 pages, with the last 3 slightly scaled */
+    safiles = sarrayCreate(0);
+    for (i = 0; i < 6; i++) {
+        pix1 = pixRead(files[i % 3]);
+        if (i < 3)
+            pix2 = pixClone(pix1);
+        else
+            pix2 = pixScale(pix1, 0.93, 0.93);
+        snprintf(buf, sizeof(buf), "/tmp/jbclass.%d.png", i);
+        pixWrite(buf, pix2, IFF_PNG);
+        sarrayAddString(safiles, buf, L_COPY);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    for (i = 0; i < 3; i++) {
+        if (i == 0) {
+            classer1 = ClassifyPages(safiles, JB_CORRELATION,
+                                     JB_CONN_COMPS, 1);
+            classer2 = ClassifyPages(safiles, JB_CORRELATION,
+                                     JB_CONN_COMPS, 4);
+        } else if (i == 1) {
+            classer1 = ClassifyPages(safiles, JB_CORRELATION,
+                                     JB_CHARACTERS, 1);
+            classer2 = ClassifyPages(safiles, JB_CORRELATION,
+                                     JB_CHARACTERS, 4);
+        } else {
+            classer1 = ClassifyPages(safiles, JB_RANKHAUS,
+                                     JB_CONN_COMPS, 1);
+            classer2 = ClassifyPages(safiles, JB_RANKHAUS,
+                                     JB_CONN_COMPS, 4);
+        }
+        regTestCompareValues(rp, 0, ClasserDiffs(classer1, classer2), 0);
+
+            /* Render the pages from each */
+        data1 = jbDataSave(classer1);
+        data2 = jbDataSave(classer2);
+        pixa1 = jbDataRender(data1, FALSE);
+        pixa2 = jbDataRender(data2, FALSE);
+        for (j = 0; j < 6; j += 2) {
+            pix1 = pixaGetPix(pixa1, j, L_CLONE);
+            pix2 = pixaGetPix(pixa2, j, L_CLONE);
+            regTestComparePix(rp, pix1, pix2);
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+        }
+        pixaDestroy(&pixa1);
+        pixaDestroy(&pixa2);
+        jbDataDestroy(&data1);
+        jbDataDestroy(&data2);
+        jbClasserDestroy(&classer1);
+        jbClasserDestroy(&classer2);
+    }
+
+        /* The connected components of each page are found inside
+         * a page job, so they must not start helpers of their own */
+    l_parallelResetStats();
+    classer1 = ClassifyPages(safiles, JB_CORRELATION, JB_CONN_COMPS, 4);
+    l_parallelGetStats(NULL, &maxrunning);
+    regTestCompareValues(rp, 1, maxrunning <= 3, 0);  /* 12 */
+    jbClasserDestroy(&classer1);
+
+    l_setNumThreads(1);
+    sarrayDestroy(&safiles);
+    return regTestCleanup(rp);
+}
+
+
+static JBCLASSER *
+ClassifyPages(SARRAY  *safiles,
+              l_int32  method,
+              l_int32  components,
+              l_int32  nthreads)
+{
+JBCLASSER  *classer;
+
+    l_setNumThreads(nthreads);
+    if (method == JB_CORRELATION)
+        classer = jbCorrelationInit(components, 0, 0, 0.8, 0.6);
+    else
+        classer = jbRankHausInit(components, 0, 0, 2, 0.97);
+    jbAddPages(classer, safiles);
+    return classer;
+}
+
+
+    /* Returns the number of differences in the number of classes, and
+     * in the class, page and template location of each component */
+static l_int32
+ClasserDiffs(JBCLASSER  *classer1,
+             JBCLASSER  *classer2)
+{
+l_int32    i, n, ndiffs, val1, val2;
+l_float32  x1, y1, x2, y2;
+
+    if (classer1->nclass != classer2->nclass)
+        return 1;
+    n = numaGetCount(classer1->naclass);
+    if (n != numaGetCount(classer2->naclass))
+        return 1;
+    ndiffs = 0;
+    for (i = 0; i < n; i++) {
+        numaGetIValue(classer1->naclass, i, &val1);
+        numaGetIValue(classer2->naclass, i, &val2);
+        if (val1 != val2) ndiffs++;
+        numaGetIValue(classer1->napage, i, &val1);
+        numaGetIValue(classer2->napage, i, &val2);
+        if (val1 != val2) ndiffs++;
+        ptaGetPt(classer1->ptaul, i, &x1, &y1);
+        ptaGetPt(classer2->ptaul, i, &x2, &y2);
+        if (x1 != x2 || y1 != y2) ndiffs++;
+    }
+    return ndiffs;
+}
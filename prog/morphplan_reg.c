@@ -0,0 +1,187 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  morphplan_reg.c
+ *
+ *    Tests compiled binary morphological sequences, where runs of
+ *    brick operations are done in a single pass, against the same
+ *    operations done one at a time.
+ */
+
+#include <string.h>
+#include "allheaders.h"
+
+static PIX *SequenceByOps(PIX *pixs, const char *sequence);
+
+#define  NSEQUENCES   7
+
+static const char  *sequence[NSEQUENCES] = {
+    "d3.2",
+    "e2.3 + o5.5",
+    "o5.5 + c3.3 + r2 + x2",
+    "c45.1 + c1.37",
+    "b32 + c35.35 + e5.5 + r23 + c3.3 + x4",
+    "c71.71 + d1.1 + e1.1 + o1.1 + c1.1",
+    "d2.2 + e4.4 + c6.2 + o2.6 + d101.1 + e1.3 + c2.8"};
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       i, nthreads;
+L_MORPHPLAN  *plan;
+PIX          *pixs, *pixc, *pix1, *pix2, *pix3;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixs = pixRead("arabic.png");
+        /* Odd size, with ON pixels at the edges */
+    pixc = pixCreate(301, 117, 1);
+    pixRasterop(pixc, 0, 0, 301, 117, PIX_SRC, pixs, 60, 20);
+    pixRasterop(pixc, 280, 0, 21, 117, PIX_NOT(PIX_DST), NULL, 0, 0);
+    pixRasterop(pixc, 0, 100, 301, 17, PIX_NOT(PIX_DST), NULL, 0, 0);
+
+        /* Each sequence, from the same plan on two images (0 - 13) */
+    for (i = 0; i < NSEQUENCES; i++) {
+        plan = l_morphplanCreate(sequence[i]);
+        pix1 = pixMorphSequencePlan(pixs, plan);
+        pix2 = SequenceByOps(pixs, sequence[i]);
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pix1 = pixMorphSequencePlan(pixc, plan);
+        pix2 = SequenceByOps(pixc, sequence[i]);
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        l_morphplanDestroy(&plan);
+    }
+
+        /* The interpreter uses the plan (14) */
+    pix1 = pixMorphSequence(pixc, sequence[6], 0);
+    pix2 = SequenceByOps(pixc, sequence[6]);
+    regTestComparePix(rp, pix1, pix2);  /* 14 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+        /* Bands on parallel threads (15, 16) */
+    nthreads = l_getNumThreads();
+    l_setNumThreads(1);
+    pix1 = pixMorphSequence(pixs, sequence[6], 0);
+    pix3 = pixMorphSequence(pixs, sequence[3], 0);
+    l_setNumThreads(4);
+    pix2 = pixMorphSequence(pixs, sequence[6], 0);
+    regTestComparePix(rp, pix1, pix2);  /* 15 */
+    pixDestroy(&pix2);
+    pix2 = pixMorphSequence(pixs, sequence[3], 0);
+    regTestComparePix(rp, pix3, pix2);  /* 16 */
+    l_setNumThreads(nthreads);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+
+        /* With symmetric b.c., the ops are done one at a time (17) */
+    resetMorphBoundaryCondition(SYMMETRIC_MORPH_BC);
+    pix1 = pixMorphSequence(pixc, sequence[1], 0);
+    pix2 = SequenceByOps(pixc, sequence[1]);
+    regTestComparePix(rp, pix1, pix2);  /* 17 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+
+        /* A new image is made with no ops; invalid sequence (18, 19) */
+    plan = l_morphplanCreate("d1.1");
+    pix1 = pixMorphSequencePlan(pixc, plan);
+    regTestCompareValues(rp, 1, pix1 != pixc, 0);  /* 18 */
+    pixDestroy(&pix1);
+    l_morphplanDestroy(&plan);
+    fprintf(stderr, "\n ----------------- Error messages ------------------\n");
+    plan = l_morphplanCreate("o5.5 + q3");
+    regTestCompareValues(rp, 1, plan == NULL, 0);  /* 19 */
+    fprintf(stderr, " ---------------------------------------------------\n");
+
+    pixDestroy(&pixs);
+    pixDestroy(&pixc);
+    return regTestCleanup(rp);
+}
+
+
+    /* Does each op of the sequence separately, with the brick functions */
+static PIX *
+SequenceByOps(PIX         *pixs,
+              const char  *sequence)
+{
+char     *op;
+l_int32   i, j, n, w, h, fact, border;
+l_int32   level[4];
+PIX      *pixt1, *pixt2;
+SARRAY   *sa;
+
+    sa = sarrayCreate(0);
+    sarraySplitString(sa, sequence, "+");
+    n = sarrayGetCount(sa);
+    border = 0;
+    pixt1 = pixCopy(NULL, pixs);
+    for (i = 0; i < n; i++) {
+        op = stringRemoveChars(sarrayGetString(sa, i, L_NOCOPY), " ");
+        pixt2 = NULL;
+        if (op[0] == 'r') {
+            for (j = 0; j < 4; j++)
+                level[j] = (j < strlen(op) - 1) ? op[j + 1] - '0' : 0;
+            pixt2 = pixReduceRankBinaryCascade(pixt1, level[0], level[1],
+                                               level[2], level[3]);
+        } else if (op[0] == 'x') {
+            sscanf(&op[1], "%d", &fact);
+            pixt2 = pixExpandReplicate(pixt1, fact);
+        } else if (op[0] == 'b') {
+            sscanf(&op[1], "%d", &border);
+            pixt2 = pixAddBorder(pixt1, border, 0);
+        } else {
+            sscanf(&op[1], "%d.%d", &w, &h);
+            if (op[0] == 'd')
+                pixt2 = pixDilateBrick(NULL, pixt1, w, h);
+            else if (op[0] == 'e')
+                pixt2 = pixErodeBrick(NULL, pixt1, w, h);
+            else if (op[0] == 'o')
+                pixt2 = pixOpenBrick(NULL, pixt1, w, h);
+            else
+                pixt2 = pixCloseSafeBrick(NULL, pixt1, w, h);
+        }
+        pixDestroy(&pixt1);
+        pixt1 = pixt2;
+        FREE(op);
+    }
+    if (border > 0) {
+        pixt2 = pixRemoveBorder(pixt1, border);
+        pixDestroy(&pixt1);
+        pixt1 = pixt2;
+    }
+    sarrayDestroy(&sa);
+    return pixt1;
+}
@@ -0,0 +1,308 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  pdfpages_reg.c
+ *
+ *    Tests that multipage pdf made from files, a pixa and a pixacomp
+ *    is the same when the pages are encoded on several threads as
+ *    when they are encoded on one thread.
+ *
+ *    Also tests the pdf writer, which writes each page as it is added,
+ *    both to a stream and to an output function.
+ *
+ *    Then many jpeg pages are encoded at the same time on several
+ *    threads, and every page is decoded and compared with its image.
+ *
+ *    Finally, a pixa that holds the same pix at every index is
+ *    encoded on several threads, which must leave its refcount as
+ *    it was.
+ */
+
+#include <string.h>
+#include "allheaders.h"
+
+static l_int32 SameData(l_uint8 *data1, size_t size1, l_uint8 *data2,
+                        size_t size2);
+static l_int32 CheckXref(l_uint8 *data, size_t size);
+static PIXA *DecodeJpegPages(l_uint8 *data, size_t size);
+static l_int32 FindString(l_uint8 *data, size_t start, size_t end,
+                          const char *str);
+
+static const char  *files[] = {"marge.jpg", "test8.jpg", "weasel8.png",
+                               "dreyfus8.png", "weasel4.11c.png",
+                               "feyn-fract.tif"};
+
+
+int main(int    argc,
+         char **argv)
+{
+char           buf[256];
+l_uint8       *data1, *data2;
+l_int32        i, n;
+size_t         size1, size2;
+FILE          *fp;
+L_BYTEA       *ba;
+L_PDF_WRITER  *lpw;
+PIX           *pix, *pix1, *pix2;
+PIXA          *pixa, *pixa1, *pixa2;
+PIXAC         *pixac;
+SARRAY        *sa;
+L_REGPARAMS   *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    l_pdfSetDateAndVersion(0);
+    sa = sarrayCreate(0);
+    pixa = pixaCreate(0);
+    for (i = 0; i < 12; i++) {
+        if ((pix = pixRead(files[i % 6])) == NULL)
+            continue;
+        snprintf(buf, sizeof(buf), "/tmp/pdfpages.%02d.png", i);
+        pixWrite(buf, pix, IFF_PNG);
+        sarrayAddString(sa, buf, L_COPY);
+        pixaAddPix(pixa, pix, L_INSERT);
+    }
+    pixac = pixacompCreateFromPixa(pixa, IFF_DEFAULT, L_CLONE);
+
+        /* From files */
+    l_setNumThreads(1);
+    saConvertFilesToPdfData(sa, 150, 0.7, 0, 0, "pages", &data1, &size1);
+    l_setNumThreads(4);
+    saConvertFilesToPdfData(sa, 150, 0.7, 0, 0, "pages", &data2, &size2);
+    regTestCompareValues(rp, 1, SameData(data1, size1, data2, size2), 0);
+    regTestCompareValues(rp, sarrayGetCount(sa), CheckXref(data1, size1), 0);
+    FREE(data1);
+    FREE(data2);
+
+        /* From a pixa, with the title taken from nothing */
+    l_setNumThreads(1);
+    pixaConvertToPdfData(pixa, 100, 1.0, 0, 0, NULL, &data1, &size1);
+    l_setNumThreads(4);
+    pixaConvertToPdfData(pixa, 100, 1.0, 0, 0, NULL, &data2, &size2);
+    regTestCompareValues(rp, 1, SameData(data1, size1, data2, size2), 0);
+    regTestCompareValues(rp, sarrayGetCount(sa), CheckXref(data1, size1), 0);
+    FREE(data1);
+    FREE(data2);
+
+        /* From a pixacomp, all with flate encoding */
+    l_setNumThreads(1);
+    pixacompConvertToPdfData(pixac, 0, 0.5, L_FLATE_ENCODE, 0, "pixac",
+                             &data1, &size1);
+    l_setNumThreads(4);
+    pixacompConvertToPdfData(pixac, 0, 0.5, L_FLATE_ENCODE, 0, "pixac",
+                             &data2, &size2);
+    regTestCompareValues(rp, 1, SameData(data1, size1, data2, size2), 0);
+    FREE(data1);
+    FREE(data2);
+
+        /* Page by page to a stream and to memory, and the same
+         * pages made all together */
+    n = pixaGetCount(pixa);
+    fp = lept_fopen("/tmp/pdfpages.pdf", "wb");
+    lpw = l_pdfWriterCreate(fp, NULL, NULL, "pix");
+    for (i = 0; i < n; i++) {
+        pix = pixaGetPix(pixa, i, L_CLONE);
+        l_pdfWriterAddPix(lpw, pix, 0, 0, 0);
+        pixDestroy(&pix);
+    }
+    regTestCompareValues(rp, 0, l_pdfWriterClose(&lpw), 0);
+    lept_fclose(fp);
+    ba = l_byteaCreate(0);
+    lpw = l_pdfWriterCreate(NULL, l_pdfWriteToBytea, ba, "pix");
+    for (i = 0; i < n; i++) {
+        pix = pixaGetPix(pixa, i, L_CLONE);
+        l_pdfWriterAddPix(lpw, pix, 0, 0, 0);
+        pixDestroy(&pix);
+    }
+    regTestCompareValues(rp, 0, l_pdfWriterClose(&lpw), 0);
+    data1 = l_binaryRead("/tmp/pdfpages.pdf", &size1);
+    data2 = l_byteaGetData(ba, &size2);
+    regTestCompareValues(rp, 1, SameData(data1, size1, data2, size2), 0);
+    regTestCompareValues(rp, n, CheckXref(data2, size2), 0);
+    FREE(data1);
+    pixaConvertToPdfData(pixa, 0, 1.0, 0, 0, "pix", &data1, &size1);
+    regTestCompareValues(rp, 1, SameData(data1, size1, data2, size2), 0);
+    FREE(data1);
+    l_byteaDestroy(&ba);
+
+        /* Closing a writer with no pages is an error */
+    lpw = l_pdfWriterCreate(stderr, NULL, NULL, NULL);
+    regTestCompareValues(rp, 1, l_pdfWriterClose(&lpw), 0);
+
+        /* Many jpeg pages of different sizes, encoded on 4 threads.
+         * Each page must decode to the jpeg of its own image. */
+    pix = pixRead("test8.jpg");
+    pixa1 = pixaCreate(0);
+    for (i = 0; i < 24; i++) {
+        pix1 = pixScale(pix, 0.3 + 0.02 * i, 0.3 + 0.02 * i);
+        pixaAddPix(pixa1, pix1, L_INSERT);
+    }
+    pixDestroy(&pix);
+    l_setNumThreads(4);
+    pixaConvertToPdfData(pixa1, 100, 1.0, L_JPEG_ENCODE, 0, "jpeg",
+                         &data1, &size1);
+    pixa2 = DecodeJpegPages(data1, size1);
+    n = pixaGetCount(pixa1);
+    regTestCompareValues(rp, n, pixaGetCount(pixa2), 0);
+    regTestCompareValues(rp, n, CheckXref(data1, size1), 0);
+    for (i = 0; i < n && i < pixaGetCount(pixa2); i++) {
+        pix1 = pixaGetPix(pixa1, i, L_CLONE);
+        pixWriteMemJpeg(&data2, &size2, pix1, 0, 0);
+        pixDestroy(&pix1);
+        pix1 = pixReadMem(data2, size2);
+        pix2 = pixaGetPix(pixa2, i, L_CLONE);
+        regTestComparePix(rp, pix1, pix2);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        FREE(data2);
+    }
+    FREE(data1);
+    pixaDestroy(&pixa1);
+    pixaDestroy(&pixa2);
+
+        /* The same pix at every index of a pixa */
+    pix = pixRead("weasel8.png");
+    pixa1 = pixaCreate(0);
+    for (i = 0; i < 16; i++)
+        pixaAddPix(pixa1, pix, L_CLONE);
+    l_setNumThreads(1);
+    pixaConvertToPdfData(pixa1, 0, 1.0, L_FLATE_ENCODE, 0, "clones",
+                         &data1, &size1);
+    l_setNumThreads(4);
+    pixaConvertToPdfData(pixa1, 0, 1.0, L_FLATE_ENCODE, 0, "clones",
+                         &data2, &size2);
+    regTestCompareValues(rp, 1, SameData(data1, size1, data2, size2), 0);
+    regTestCompareValues(rp, 17, pixGetRefcount(pix), 0);
+    FREE(data1);
+    FREE(data2);
+    pixaDestroy(&pixa1);
+    pixDestroy(&pix);
+
+    l_setNumThreads(1);
+    l_pdfSetDateAndVersion(1);
+    sarrayDestroy(&sa);
+    pixaDestroy(&pixa);
+    pixacompDestroy(&pixac);
+    return regTestCleanup(rp);
+}
+
+
+    /* Returns 1 if the two arrays are identical and not empty */
+static l_int32
+SameData(l_uint8  *data1,
+         size_t    size1,
+         l_uint8  *data2,
+         size_t    size2)
+{
+    if (!data1 || !data2 || size1 == 0 || size1 != size2)
+        return 0;
+    return (memcmp(data1, data2, size1) == 0) ? 1 : 0;
+}
+
+
+    /* Returns the number of pages, or 0 if an object location in the
+     * xref table is not at the start of that object. */
+static l_int32
+CheckXref(l_uint8  *data,
+          size_t    size)
+{
+char    *str;
+char     buf[32];
+l_int32  i, n, start, loc, xrefloc, objno, npages;
+
+    if (!data || size < 50)
+        return 0;
+    str = (char *)data;
+    for (i = size - 10; i > 0; i--) {
+        if (!strncmp(str + i, "startxref\n", 10))
+            break;
+    }
+    if (i == 0 || sscanf(str + i + 10, "%d", &xrefloc) != 1 ||
+        sscanf(str + xrefloc, "xref\n0 %d", &n) != 1 || n < 5)
+        return 0;
+    start = xrefloc + 5 + snprintf(buf, sizeof(buf), "0 %d\n", n);
+    for (i = 1; i < n; i++) {
+        if (sscanf(str + start + 20 * i, "%d", &loc) != 1 ||
+            sscanf(str + loc, "%d 0 obj", &objno) != 1 || objno != i)
+            return 0;
+    }
+    sscanf(str + start + 60, "%d", &loc);  /* the Pages object */
+    if (sscanf(str + loc, "3 0 obj\n<<\n/Type /Pages\n/Kids [%*[^]]]\n"
+               "/Count %d", &npages) != 1)
+        return 0;
+    return npages;
+}
+
+
+    /* Returns the images of the jpeg streams in the pdf, in order */
+static PIXA *
+DecodeJpegPages(l_uint8  *data,
+                size_t    size)
+{
+l_int32  start, len;
+size_t   i;
+PIX     *pix;
+PIXA    *pixa;
+
+    pixa = pixaCreate(0);
+    if (!data)
+        return pixa;
+    for (i = 0; i + 8 < size; i++) {
+        if (memcmp(data + i, "/Length ", 8) != 0 ||
+            sscanf((char *)data + i + 8, "%d", &len) != 1)
+            continue;
+        if ((start = FindString(data, i, size, ">>\nstream\n")) < 0)
+            break;
+        start += 10;
+        if (FindString(data, i, start, "/DCTDecode") < 0 ||
+            start + len > size)
+            continue;
+        if ((pix = pixReadMem(data + start, len)) != NULL)
+            pixaAddPix(pixa, pix, L_INSERT);
+        i = start + len - 1;
+    }
+    return pixa;
+}
+
+
+    /* Returns the location of @str in [start ... end), or -1 */
+static l_int32
+FindString(l_uint8     *data,
+           size_t       start,
+           size_t       end,
+           const char  *str)
+{
+size_t  i, len;
+
+    len = strlen(str);
+    for (i = start; i + len <= end; i++) {
+        if (memcmp(data + i, str, len) == 0)
+            return (l_int32)i;
+    }
+    return -1;
+}
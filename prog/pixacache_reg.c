@@ -0,0 +1,175 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  pixacache_reg.c
+ *
+ *    Tests the lazy pixacomp, which reads each file when it is first
+ *    needed, and the cache of decompressed pix with read-ahead.
+ *    The images are compared with those from a pixacomp that is
+ *    read in full and has no cache.
+ */
+
+#include "allheaders.h"
+
+static l_int32 CountDiffs(PIXAC *pixac1, PIXAC *pixac2, l_int32 start,
+                          l_int32 end, l_int32 step);
+
+static const char  *files[] = {"marge.jpg", "test8.jpg", "weasel8.png",
+                               "dreyfus8.png", "weasel4.11c.png"};
+
+
+int main(int    argc,
+         char **argv)
+{
+char          buf[256];
+l_int32       i, n, same, npix, w1, h1, d1, w2, h2, d2;
+size_t        nbytes, maxbytes;
+PIX          *pix1, *pix2;
+PIXAC        *pixac1, *pixac2;
+SARRAY       *safiles;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Make 15 pages of different sizes, depths and formats */
+    safiles = sarrayCreate(0);
+    for (i = 0; i < 15; i++) {
+        pix1 = pixRead(files[i % 5]);
+        if (i % 3 == 1)
+            pix2 = pixConvertTo1(pix1, 128);
+        else
+            pix2 = pixScale(pix1, 1.0 + 0.1 * (i / 5), 1.0 + 0.1 * (i / 5));
+        snprintf(buf, sizeof(buf), "/tmp/pixacache.%02d.png", i);
+        pixWrite(buf, pix2, IFF_PNG);
+        sarrayAddString(safiles, buf, L_COPY);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+    pixac1 = pixacompCreateFromSA(safiles, IFF_PNG);
+
+        /* Nothing is read until it is needed */
+    pixac2 = pixacompCreateFromSALazy(safiles, IFF_PNG);
+    n = pixacompGetCount(pixac2);
+    regTestCompareValues(rp, 15, n, 0);  /* 0 */
+    regTestCompareValues(rp, 0, (pixac2->pixc[0] != NULL), 0);  /* 1 */
+    pixacompGetPixDimensions(pixac1, 7, &w1, &h1, &d1);
+    pixacompGetPixDimensions(pixac2, 7, &w2, &h2, &d2);
+    regTestCompareValues(rp, 1, w1 == w2 && h1 == h2 && d1 == d2, 0);  /* 2 */
+    regTestCompareValues(rp, 1, (pixac2->pixc[7] != NULL), 0);  /* 3 */
+    regTestCompareValues(rp, 0, (pixac2->pixc[8] != NULL), 0);  /* 4 */
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, 0, n, 1), 0);  /* 5 */
+
+        /* Cache about a third of the pages, and read ahead 3 pages.
+         * Go through all the pages, forward and back. */
+    pixacompDestroy(&pixac2);
+    pixac2 = pixacompCreateFromSALazy(safiles, IFF_PNG);
+    pix1 = pixacompGetPix(pixac1, 0);
+    maxbytes = 5 * 4 * (size_t)pixGetWpl(pix1) * pixGetHeight(pix1);
+    pixDestroy(&pix1);
+    pixacompSetCache(pixac2, maxbytes, 3);
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, 0, n, 1), 0);  /* 6 */
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, n - 1, -1, -1),
+                         0);  /* 7 */
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, 0, n, 2), 0);  /* 8 */
+    pixacompGetCacheInfo(pixac2, &npix, &nbytes);
+    regTestCompareValues(rp, 1, npix > 0 && nbytes <= maxbytes, 0);  /* 9 */
+
+        /* Changing the returned pix does not change the cached one */
+    pix1 = pixacompGetPix(pixac2, 4);
+    pixSetAll(pix1);
+    pix2 = pixacompGetPix(pixac2, 4);
+    pixEqual(pix1, pix2, &same);
+    regTestCompareValues(rp, 0, same, 0);  /* 10 */
+    pixDestroy(&pix2);
+
+        /* Replacing a page drops the cached pix */
+    pixacompReplacePix(pixac2, 4, pix1, IFF_PNG);
+    pix2 = pixacompGetPix(pixac2, 4);
+    regTestComparePix(rp, pix1, pix2);  /* 11 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pix1 = pixacompGetPix(pixac1, 4);
+    pixacompReplacePix(pixac2, 4, pix1, IFF_PNG);
+    pixDestroy(&pix1);
+
+        /* Adding pages extends the cache */
+    for (i = 0; i < 2 * n; i++) {
+        pix1 = pixacompGetPix(pixac1, i % n);
+        pixacompAddPix(pixac1, pix1, IFF_PNG);
+        pixacompAddPix(pixac2, pix1, IFF_PNG);
+        pixDestroy(&pix1);
+    }
+    n = pixacompGetCount(pixac2);
+    regTestCompareValues(rp, 45, n, 0);  /* 12 */
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, n - 1, -1, -1),
+                         0);  /* 13 */
+
+        /* Without read-ahead, and with the cache removed */
+    pixacompSetCache(pixac2, maxbytes, 0);
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, 0, n, 1), 0);  /* 14 */
+    pixacompSetCache(pixac2, 0, 0);
+    pixacompGetCacheInfo(pixac2, &npix, &nbytes);
+    regTestCompareValues(rp, 0, npix + nbytes, 0);  /* 15 */
+    regTestCompareValues(rp, 0, CountDiffs(pixac1, pixac2, 0, n, 3), 0);  /* 16 */
+
+        /* Destroy while reading ahead */
+    pixacompDestroy(&pixac2);
+    pixac2 = pixacompCreateFromSALazy(safiles, IFF_PNG);
+    pixacompSetCache(pixac2, maxbytes, 10);
+    pix1 = pixacompGetPix(pixac2, 0);
+    pixDestroy(&pix1);
+    pixacompDestroy(&pixac2);
+
+    pixacompDestroy(&pixac1);
+    sarrayDestroy(&safiles);
+    return regTestCleanup(rp);
+}
+
+
+    /* Returns the number of pages in the range that differ */
+static l_int32
+CountDiffs(PIXAC   *pixac1,
+           PIXAC   *pixac2,
+           l_int32  start,
+           l_int32  end,
+           l_int32  step)
+{
+l_int32  i, same, ndiffs;
+PIX     *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = start; (step > 0) ? i < end : i > end; i += step) {
+        pix1 = pixacompGetPix(pixac1, i);
+        pix2 = pixacompGetPix(pixac2, i);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+    return ndiffs;
+}
@@ -41,6 +41,11 @@
  *   For the second case, timing shows that the custom allocator does
  *   about as well as (malloc, free), even for thousands of very small pix.
  *   (Turn off logging to get a fair comparison).
+ *
+ *   Finally, we test the pooled allocator for small objects, which
+ *   takes the boxa, pixa and their arrays, and the data of the small
+ *   pix, from the pool.  With logging, the pool statistics, including
+ *   the counts for each thread cache, are written to stderr at the end.
  */
 
 #include <math.h>
@@ -143,6 +148,23 @@ PIXA    *pixa, *pixas;
     }
     pixDestroy(&pixs);
     fprintf(stderr, "Time (standard) = %7.3f sec\n", stopTimer());
+
+
+    /* ----------------- Pooled with many small pix -----------------*/
+    l_poolCreate(20000000, logging);
+    setPixMemoryManager(l_poolAlloc, l_poolFree);
+    pixs = pixRead("feyn.tif");
+
+    startTimer();
+    for (i = 0; i < 5; i++) {
+        boxa = pixConnComp(pixs, &pixa, 8);
+        boxaDestroy(&boxa);
+        pixaDestroy(&pixa);
+    }
+    pixDestroy(&pixs);
+    fprintf(stderr, "Time (pooled) = %7.3f sec\n", stopTimer());
+    setPixMemoryManager(malloc, free);
+    l_poolDestroy();
     return 0;
 }
 
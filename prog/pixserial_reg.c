@@ -28,7 +28,8 @@
  * pixserial_reg.c
  *
  *    Tests the fast (uncompressed) serialization of pix to a string
- *    in memory and the deserialization back to a pix.
+ *    in memory and the deserialization back to a pix.  Also tests
+ *    wrapping a spix file that is mapped into memory as a pix.
  */
 
 #include "allheaders.h"
@@ -99,6 +100,27 @@ L_REGPARAMS  *rp;
         pixDestroy(&pixt2);
     }
 
+            /* Test mapping spix files into memory.  Changes to the
+             * mapped pix must not go to the file, and the mapping must
+             * move with the data when it is transferred to another pix. */
+    for (i = 0; i < nfiles; i++) {
+        pixs = pixRead(filename[i]);
+        snprintf(buf, sizeof(buf), "/tmp/regout/pixm.%d.spix", i);
+        pixWrite(buf, pixs, IFF_SPIX);
+        pixt = pixReadMappedSpix(buf);
+        regTestComparePix(rp, pixs, pixt);  /* 3 * nfiles + 3 * i */
+        pixInvert(pixt, pixt);
+        pixt2 = pixReadMappedSpix(buf);
+        regTestComparePix(rp, pixs, pixt2);  /* 3 * nfiles + 3 * i + 1 */
+        pixd = pixCreate(1, 1, 1);
+        pixTransferAllData(pixd, &pixt, 0, 0);
+        pixInvert(pixd, pixd);
+        regTestComparePix(rp, pixs, pixd);  /* 3 * nfiles + 3 * i + 2 */
+        pixDestroy(&pixs);
+        pixDestroy(&pixt2);
+        pixDestroy(&pixd);
+    }
+
             /* Test read header.  Note that for rgb input, spp = 3,
              * but for 32 bpp spix, we set spp = 4. */
     data = NULL;
@@ -33,12 +33,26 @@
 static l_int32 TestTiling(PIX *pixd, PIX *pixs, l_int32 nx, l_int32 ny,
                           l_int32 w, l_int32 h, l_int32 xoverlap,
                           l_int32 yoverlap);
+static void TestTilingExecute(L_REGPARAMS *rp, PIX *pixs, l_int32 nx,
+                              l_int32 ny, l_int32 xoverlap, l_int32 yoverlap,
+                              l_int32 nthreads);
+static l_int32 PaintTileFunc(PIXTILING *pt, PIX *pixt, l_int32 i, l_int32 j,
+                             void *data);
+static l_int32 DilateTileFunc(PIXTILING *pt, PIX *pixt, l_int32 i, l_int32 j,
+                              void *data);
+static l_int32 FailTileFunc(PIXTILING *pt, PIX *pixt, l_int32 i, l_int32 j,
+                            void *data);
 
 
 int main(int    argc,
          char **argv)
 {
-PIX         *pixs, *pixd;
+PIX          *pixs, *pixd, *pixg, *pixb;
+PIXTILING    *pt;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
 
     pixs = pixRead("test24.jpg");
     pixd = pixCreateTemplateNoInit(pixs);
@@ -52,9 +66,31 @@ PIX         *pixs, *pixd;
     TestTiling(pixd, pixs, 0, 0, 27, 31, 0, 0);
     TestTiling(pixd, pixs, 7, 9, 0, 0, 0, 0);
 
+        /* Operate on tiles from worker threads, and compare with the
+         * same operation on the untiled image.  At 1 bpp, adjacent
+         * tiles share destination words. */
+    pixg = pixConvertTo8(pixs, 0);
+    pixb = pixConvertTo1(pixs, 128);
+    TestTilingExecute(rp, pixs, 7, 9, 35, 35, 1);  /* 0 - 1 */
+    TestTilingExecute(rp, pixs, 7, 9, 35, 35, 4);  /* 2 - 3 */
+    TestTilingExecute(rp, pixg, 7, 9, 35, 35, 1);  /* 4 - 6 */
+    TestTilingExecute(rp, pixg, 7, 9, 35, 35, 4);  /* 7 - 9 */
+    TestTilingExecute(rp, pixb, 13, 11, 5, 3, 1);  /* 10 - 12 */
+    TestTilingExecute(rp, pixb, 13, 11, 5, 3, 4);  /* 13 - 15 */
+    TestTilingExecute(rp, pixb, 27, 2, 1, 1, 8);  /* 16 - 18 */
+
+        /* A failure on any tile is returned */
+    pt = pixTilingCreate(pixg, 5, 4, 0, 0, 0, 0);
+    regTestCompareValues(rp, 1,
+                         pixTilingExecute(pt, FailTileFunc, NULL, 4),
+                         0);  /* 19 */
+    pixTilingDestroy(&pt);
+
     pixDestroy(&pixs);
     pixDestroy(&pixd);
-    return 0;
+    pixDestroy(&pixg);
+    pixDestroy(&pixb);
+    return regTestCleanup(rp);
 }
 
 
@@ -98,3 +134,86 @@ PIXTILING  *pt;
     pixTilingDestroy(&pt);
     return 0;
 }
+
+
+    /* The copy of the tiles must be the same as pixs.  For 1 and 8 bpp,
+     * the dilation of the tiles, with an overlap of at least 1 pixel,
+     * must also be the same as the dilation of pixs. */
+static void
+TestTilingExecute(L_REGPARAMS  *rp,
+                  PIX          *pixs,
+                  l_int32       nx,
+                  l_int32       ny,
+                  l_int32       xoverlap,
+                  l_int32       yoverlap,
+                  l_int32       nthreads)
+{
+l_int32     d;
+PIX        *pixd, *pix1;
+PIXTILING  *pt;
+
+    pixd = pixCreateTemplate(pixs);
+    pt = pixTilingCreate(pixs, nx, ny, 0, 0, xoverlap, yoverlap);
+    regTestCompareValues(rp, 0,
+                         pixTilingExecute(pt, PaintTileFunc, pixd, nthreads),
+                         0);
+    regTestComparePix(rp, pixs, pixd);
+    pixDestroy(&pixd);
+
+    d = pixGetDepth(pixs);
+    if (d == 1 || d == 8) {
+        pixd = pixCreateTemplate(pixs);
+        pixTilingExecute(pt, DilateTileFunc, pixd, nthreads);
+        if (d == 1)
+            pix1 = pixDilateBrick(NULL, pixs, 3, 3);
+        else
+            pix1 = pixDilateGray(pixs, 3, 3);
+        regTestComparePix(rp, pix1, pixd);
+        pixDestroy(&pix1);
+        pixDestroy(&pixd);
+    }
+    pixTilingDestroy(&pt);
+    return;
+}
+
+
+l_int32
+PaintTileFunc(PIXTILING  *pt,
+              PIX        *pixt,
+              l_int32     i,
+              l_int32     j,
+              void       *data)
+{
+    return pixTilingPaintTile((PIX *)data, i, j, pixt, pt);
+}
+
+
+l_int32
+DilateTileFunc(PIXTILING  *pt,
+               PIX        *pixt,
+               l_int32     i,
+               l_int32     j,
+               void       *data)
+{
+l_int32  ret;
+PIX     *pix1;
+
+    if (pixGetDepth(pixt) == 1)
+        pix1 = pixDilateBrick(NULL, pixt, 3, 3);
+    else
+        pix1 = pixDilateGray(pixt, 3, 3);
+    ret = pixTilingPaintTile((PIX *)data, i, j, pix1, pt);
+    pixDestroy(&pix1);
+    return ret;
+}
+
+
+l_int32
+FailTileFunc(PIXTILING  *pt,
+             PIX        *pixt,
+             l_int32     i,
+             l_int32     j,
+             void       *data)
+{
+    return (i == 2 && j == 3) ? 1 : 0;
+}
@@ -28,7 +28,7 @@
  * rank_reg.c
  *
  *   Tests grayscale rank functions:
- *      (1) pixRankFilterGray()
+ *      (1) pixRankFilterGray() and pixRankFilterRGB()
  *      (2) pixScaleGrayMinMax()
  *      (3) pixScaleGrayRankCascade()
  */
@@ -95,6 +95,27 @@ static char   mainName[] = "rank_reg";
     pixDestroy(&pixt1);
     pixDestroy(&pixt2);
     pixDestroy(&pixt3);
+    pixDestroy(&pixt4);
+
+        /* Compare results on strips computed in parallel */
+    pixt1 = pixRankFilterGray(pixs, 15, 24, 0.3);
+    pixt2 = pixRead("marge.jpg");
+    pixt3 = pixRankFilterRGB(pixt2, 10, 7, 0.6);
+    l_setNumThreads(4);
+    pixt4 = pixRankFilterGray(pixs, 15, 24, 0.3);
+    pixEqual(pixt1, pixt4, &same);
+    pixDestroy(&pixt4);
+    pixt4 = pixRankFilterRGB(pixt2, 10, 7, 0.6);
+    if (same)
+        pixEqual(pixt3, pixt4, &same);
+    l_setNumThreads(1);
+    if (same)
+        fprintf(stderr, "Correct: results same with 1 and 4 threads\n");
+    else
+        fprintf(stderr, "Error: results differ with 1 and 4 threads\n");
+    pixDestroy(&pixt1);
+    pixDestroy(&pixt2);
+    pixDestroy(&pixt3);
     pixDestroy(&pixt4);
 
     fprintf(stderr, "\n----------------------------------------\n");
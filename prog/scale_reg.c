@@ -52,6 +52,8 @@ static const l_float32  FACTOR[5] = {2.3, 1.5, 1.1, 0.6, 0.3};
 static void AddScaledImages(PIXA *pixa, const char *fname, l_int32 width);
 static void PixSave32(PIXA *pixa, PIX *pixc);
 static void PixaSaveDisplay(PIXA *pixa, L_REGPARAMS *rp);
+static void TestThreads(L_REGPARAMS *rp);
+static PIX *ThreadsOp(l_int32 index, PIX *pix1, PIX *pix8, PIX *pix32);
 
 
 int main(int    argc,
@@ -239,6 +241,10 @@ L_REGPARAMS  *rp;
     PixaSaveDisplay(pixa, rp);
     pixDestroy(&pixs);
 
+        /* Test that scaling in bands is independent of threads */
+    fprintf(stderr, "\n-------------- Testing threads ------------\n");
+    TestThreads(rp);
+
     return regTestCleanup(rp);
 }
 
@@ -293,3 +299,48 @@ PIX  *pixd;
     pixaDestroy(&pixa);
     return;
 }
+
+static void
+TestThreads(L_REGPARAMS  *rp)
+{
+l_int32  i, oldnthreads;
+PIX     *pix1, *pix8, *pix32, *pixd1, *pixd2;
+
+    pix1 = pixRead("test1.png");
+    pix8 = pixRead(image[5]);
+    pix32 = pixRead(image[8]);
+    for (i = 0; i < 6; i++) {
+        oldnthreads = l_setNumThreads(1);
+        pixd1 = ThreadsOp(i, pix1, pix8, pix32);
+        l_setNumThreads(4);
+        pixd2 = ThreadsOp(i, pix1, pix8, pix32);
+        l_setNumThreads(oldnthreads);
+        regTestComparePix(rp, pixd1, pixd2);
+        pixDestroy(&pixd1);
+        pixDestroy(&pixd2);
+    }
+    pixDestroy(&pix1);
+    pixDestroy(&pix8);
+    pixDestroy(&pix32);
+    return;
+}
+
+static PIX *
+ThreadsOp(l_int32  index,
+          PIX     *pix1,
+          PIX     *pix8,
+          PIX     *pix32)
+{
+    if (index == 0)
+        return pixScaleToGray3(pix1);
+    else if (index == 1)
+        return pixScaleToGray16(pix1);
+    else if (index == 2)
+        return pixScaleAreaMap(pix8, 0.37, 0.29);
+    else if (index == 3)
+        return pixScaleAreaMap(pix32, 0.41, 0.45);
+    else if (index == 4)
+        return pixScaleGrayLI(pix8, 1.75, 2.3);
+    else
+        return pixScaleColorLI(pix32, 1.3, 0.9);
+}
@@ -0,0 +1,202 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  seedfill_reg.c
+ *
+ *    Tests the hybrid binary and grayscale seedfills, by comparing
+ *    them with the iterated raster and anti-raster fills, and by
+ *    filling in strips with different numbers of threads.
+ *    Also tests the regional extrema found from the grayscale fill.
+ */
+
+#include "allheaders.h"
+
+static PIX *SeedfillBinaryIterated(PIX *pixs, PIX *pixm,
+                                   l_int32 connectivity);
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       i, conn, nthreads;
+PIX          *pixg, *pixb, *pixs, *pixm, *pix1, *pix2, *pix3, *pix4;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pixg = pixRead("test8.jpg");
+    pix1 = pixRead("rabi.png");
+    pixb = pixScale(pix1, 2.0, 2.0);
+    pixDestroy(&pix1);
+    nthreads = l_getNumThreads();
+
+        /* Gray fills are the same as the iterated fills */
+    for (i = 0; i < 2; i++) {
+        conn = (i == 0) ? 4 : 8;
+        pix1 = pixCopy(NULL, pixg);
+        pixAddConstantGray(pix1, -40);
+        pix2 = pixCopy(NULL, pix1);
+        pixSeedfillGray(pix1, pixg, conn);
+        pixSeedfillGraySimple(pix2, pixg, conn);
+        regTestComparePix(rp, pix1, pix2);  /* 0, 4 */
+        pixDestroy(&pix2);
+
+            /* ... and don't depend on the number of threads */
+        pix2 = pixCopy(NULL, pixg);
+        pixAddConstantGray(pix2, -40);
+        l_setNumThreads(4);
+        pixSeedfillGray(pix2, pixg, conn);
+        l_setNumThreads(nthreads);
+        regTestComparePix(rp, pix1, pix2);  /* 1, 5 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+
+        pix1 = pixCopy(NULL, pixg);
+        pixAddConstantGray(pix1, 40);
+        pix2 = pixCopy(NULL, pix1);
+        pix3 = pixCopy(NULL, pix1);
+        pixSeedfillGrayInv(pix1, pixg, conn);
+        pixSeedfillGrayInvSimple(pix2, pixg, conn);
+        l_setNumThreads(4);
+        pixSeedfillGrayInv(pix3, pixg, conn);
+        l_setNumThreads(nthreads);
+        regTestComparePix(rp, pix1, pix2);  /* 2, 6 */
+        regTestComparePix(rp, pix1, pix3);  /* 3, 7 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pix3);
+    }
+
+        /* Binary fills are the same as the iterated fills, and
+         * don't depend on the number of threads */
+    pixs = pixMorphSequence(pixb, "e5.5", 0);
+    pixm = pixCopy(NULL, pixb);
+    for (i = 0; i < 2; i++) {
+        conn = (i == 0) ? 4 : 8;
+        pix1 = pixSeedfillBinary(NULL, pixs, pixm, conn);
+        pix2 = SeedfillBinaryIterated(pixs, pixm, conn);
+        l_setNumThreads(4);
+        pix3 = pixSeedfillBinary(NULL, pixs, pixm, conn);
+        pix4 = pixHolesByFilling(pixb, conn);
+        l_setNumThreads(nthreads);
+        regTestComparePix(rp, pix1, pix2);  /* 8, 11 */
+        regTestComparePix(rp, pix1, pix3);  /* 9, 12 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pix3);
+        pix1 = pixHolesByFilling(pixb, conn);
+        regTestComparePix(rp, pix1, pix4);  /* 10, 13 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix4);
+    }
+    pixDestroy(&pixs);
+    pixDestroy(&pixm);
+
+        /* A maze needs many iterations of the raster and anti-raster
+         * fills; the hybrid fill needs none */
+    pix1 = generateBinaryMaze(300, 200, 1, 1, 0.65, 0.25);
+    pixm = pixInvert(NULL, pix1);
+    pixs = pixCreateTemplate(pixm);
+    pixSetPixel(pixs, 1, 1, 1);
+    pix2 = pixSeedfillBinary(NULL, pixs, pixm, 4);
+    pix3 = SeedfillBinaryIterated(pixs, pixm, 4);
+    regTestComparePix(rp, pix2, pix3);  /* 14 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pixs);
+    pixDestroy(&pixm);
+
+        /* Each regional minimum is a local minimum in its 3x3
+         * neighborhood, and the maxima are where the h-dome of
+         * height 1, found with the iterated fill, is not zero */
+    pixLocalExtrema(pixg, 0, 0, &pix1, &pix2);
+    pix3 = pixErodeGray(pixg, 3, 3);
+    pix4 = pixFindEqualValues(pixg, pix3);
+    pixAnd(pix4, pix4, pix1);
+    regTestComparePix(rp, pix1, pix4);  /* 15 */
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+    pix3 = pixCopy(NULL, pixg);
+    pixAddConstantGray(pix3, -1);
+    pixSeedfillGraySimple(pix3, pixg, 8);
+    pix4 = pixSubtractGray(NULL, pixg, pix3);
+    pixDestroy(&pix3);
+    pix3 = pixThresholdToBinary(pix4, 1);
+    pixInvert(pix3, pix3);
+    regTestComparePix(rp, pix2, pix3);  /* 16 */
+    pixCountPixels(pix1, &i, NULL);
+    regTestCompareValues(rp, 1, i > 0, 0);  /* 17 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    pixDestroy(&pix4);
+
+        /* The regional minimum of a single basin is its bottom,
+         * including where it touches the sides of the image */
+    pix1 = pixCreate(200, 200, 8);
+    for (i = 0; i < 200 * 200; i++)
+        pixSetPixel(pix1, i % 200, i / 200,
+                    20 + L_ABS((100 - i / 200) * (100 - i % 200)) / 50);
+    pixLocalExtrema(pix1, 0, 0, &pix2, NULL);
+    pix3 = pixThresholdToBinary(pix1, 21);
+    regTestComparePix(rp, pix2, pix3);  /* 18 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+
+    pixDestroy(&pixg);
+    pixDestroy(&pixb);
+    return regTestCleanup(rp);
+}
+
+
+    /* The binary seedfill iterated until it stops changing,
+     * as it was done before the hybrid fill */
+static PIX *
+SeedfillBinaryIterated(PIX     *pixs,
+                       PIX     *pixm,
+                       l_int32  connectivity)
+{
+l_int32  same;
+PIX     *pixd, *pixt;
+
+    pixd = pixCopy(NULL, pixs);
+    pixt = pixCreateTemplate(pixs);
+    pixSetPadBits(pixm, 0);
+    same = 0;
+    while (!same) {
+        pixCopy(pixt, pixd);
+        seedfillBinaryLow(pixGetData(pixd), pixGetHeight(pixd),
+                          pixGetWpl(pixd), pixGetData(pixm),
+                          pixGetHeight(pixm), pixGetWpl(pixm), connectivity);
+        pixEqual(pixd, pixt, &same);
+    }
+    pixDestroy(&pixt);
+    return pixd;
+}
@@ -0,0 +1,252 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  seldwa_reg.c
+ *
+ *    Tests binary morphology with Sels compiled at runtime for dwa,
+ *    against the rasterop implementation, for Sels of arbitrary
+ *    shape and size, with and without misses, and for both
+ *    boundary conditions.
+ */
+
+#include "allheaders.h"
+
+static PIX *DilateRop(PIX *pixs, SEL *sel);
+static PIX *ErodeRop(PIX *pixs, SEL *sel, l_int32 bc);
+static PIX *HMTRop(PIX *pixs, SEL *sel);
+
+    /* Hit-miss sel for a right-angle corner, origin off-center */
+static const char  *seltext = "ooooooo  "
+                              "ooooooo  "
+                              "ooXxxxx  "
+                              "ooxxxxx  "
+                              "ooxx     "
+                              "ooxx     ";
+
+#define  NSELS   5
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       i, j, nthreads;
+BOX          *box;
+L_DWASEL     *dsel;
+PIX          *pixs, *pix1, *pix2, *pix3;
+SEL          *sel, *sela[NSELS];
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+        /* Odd width, not a multiple of 32 */
+    pix1 = pixRead("arabic.png");
+    box = boxCreate(300, 400, 613, 457);
+    pixs = pixClipRectangle(pix1, box, NULL);
+    pixDestroy(&pix1);
+    boxDestroy(&box);
+
+        /* Bricks, a long line beyond the size of generated dwa,
+         * a sparse sel and a hit-miss sel */
+    sela[0] = selCreateBrick(7, 5, 1, 3, SEL_HIT);
+    sela[1] = selCreateBrick(1, 71, 0, 35, SEL_HIT);
+    sela[2] = selCreateBrick(45, 1, 40, 0, SEL_HIT);
+    sela[3] = selCreate(37, 41, "sparse");
+    selSetOrigin(sela[3], 10, 30);
+    for (i = 0; i < 37; i += 4) {
+        for (j = (i % 3); j < 41; j += 7)
+            selSetElement(sela[3], i, j, SEL_HIT);
+    }
+    sela[4] = selCreateFromString(seltext, 6, 9, "corner");
+
+        /* Each op with the compiled sel, and through the generic
+         * functions that now use it, against rasterop */
+    for (i = 0; i < NSELS; i++) {
+        sel = sela[i];
+        dsel = l_dwaselCreate(sel);
+        pix1 = DilateRop(pixs, sel);
+        pix2 = pixDilateDwasel(NULL, pixs, dsel);
+        pix3 = pixDilate(NULL, pixs, sel);
+        regTestComparePix(rp, pix1, pix2);  /* 0, 6, 12, 18, 24 */
+        regTestComparePix(rp, pix1, pix3);  /* 1, 7, 13, 19, 25 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pix3);
+
+        pix1 = ErodeRop(pixs, sel, ASYMMETRIC_MORPH_BC);
+        pix2 = pixErodeDwasel(NULL, pixs, dsel);
+        pix3 = pixErode(NULL, pixs, sel);
+        regTestComparePix(rp, pix1, pix2);  /* 2, 8, 14, 20, 26 */
+        regTestComparePix(rp, pix1, pix3);  /* 3, 9, 15, 21, 27 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        pixDestroy(&pix3);
+
+        resetMorphBoundaryCondition(SYMMETRIC_MORPH_BC);
+        pix1 = ErodeRop(pixs, sel, SYMMETRIC_MORPH_BC);
+        pix2 = pixErodeDwasel(NULL, pixs, dsel);
+        resetMorphBoundaryCondition(ASYMMETRIC_MORPH_BC);
+        regTestComparePix(rp, pix1, pix2);  /* 4, 10, 16, 22, 28 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+
+        pix1 = HMTRop(pixs, sel);
+        pix2 = pixHMT(NULL, pixs, sel);
+        regTestComparePix(rp, pix1, pix2);  /* 5, 11, 17, 23, 29 */
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+        l_dwaselDestroy(&dsel);
+    }
+
+        /* The hit-miss sel finds the upper left corner of each
+         * rectangle, including one at the image boundary */
+    pix1 = pixCreate(200, 100, 1);
+    pixRasterop(pix1, 20, 10, 30, 40, PIX_SET, NULL, 0, 0);
+    pixRasterop(pix1, 120, 50, 60, 20, PIX_SET, NULL, 0, 0);
+    pixRasterop(pix1, 0, 0, 10, 10, PIX_SET, NULL, 0, 0);
+    pix2 = pixHMT(NULL, pix1, sela[4]);
+    pixCountPixels(pix2, &i, NULL);
+    regTestCompareValues(rp, 3, i, 0);  /* 30 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+
+        /* In-place, and with more threads */
+    pix1 = pixOpen(NULL, pixs, sela[3]);
+    pix2 = pixCopy(NULL, pixs);
+    pixErode(pix2, pix2, sela[3]);
+    pixDilate(pix2, pix2, sela[3]);
+    regTestComparePix(rp, pix1, pix2);  /* 31 */
+    nthreads = l_getNumThreads();
+    l_setNumThreads(4);
+    pix3 = pixOpen(NULL, pixs, sela[3]);
+    l_setNumThreads(nthreads);
+    regTestComparePix(rp, pix1, pix3);  /* 32 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+
+        /* A sel with no hits or misses: the hit-miss transform leaves
+         * pixd as it is, and is empty for a new pixd */
+    sel = selCreate(3, 3, "empty");
+    pix1 = pixHMT(NULL, pixs, sel);
+    pixCountPixels(pix1, &i, NULL);
+    regTestCompareValues(rp, 0, i, 0);  /* 33 */
+    pix2 = pixCopy(NULL, pixs);
+    pixHMT(pix2, pixs, sel);
+    regTestComparePix(rp, pixs, pix2);  /* 34 */
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    selDestroy(&sel);
+
+    for (i = 0; i < NSELS; i++)
+        selDestroy(&sela[i]);
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+    /* The rasterop implementations, with one pass for each element */
+static PIX *
+DilateRop(PIX  *pixs,
+          SEL  *sel)
+{
+l_int32  i, j, w, h, sx, sy, cx, cy;
+PIX     *pixd;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    pixd = pixCreateTemplate(pixs);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT)
+                pixRasterop(pixd, j - cx, i - cy, w, h, PIX_SRC | PIX_DST,
+                            pixs, 0, 0);
+        }
+    }
+    return pixd;
+}
+
+
+static PIX *
+ErodeRop(PIX     *pixs,
+         SEL     *sel,
+         l_int32  bc)
+{
+l_int32  i, j, w, h, sx, sy, cx, cy, xp, yp, xn, yn;
+PIX     *pixd;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    pixd = pixCreateTemplate(pixs);
+    pixSetAll(pixd);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT)
+                pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
+                            pixs, 0, 0);
+        }
+    }
+    if (bc == ASYMMETRIC_MORPH_BC) {
+        selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
+        pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
+        pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
+        pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
+        pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
+    }
+    return pixd;
+}
+
+
+static PIX *
+HMTRop(PIX  *pixs,
+       SEL  *sel)
+{
+l_int32  i, j, w, h, sx, sy, cx, cy, xp, yp, xn, yn;
+PIX     *pixd;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    pixd = pixCreateTemplate(pixs);
+    pixSetAll(pixd);
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT)
+                pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
+                            pixs, 0, 0);
+            else if (sel->data[i][j] == SEL_MISS)
+                pixRasterop(pixd, cx - j, cy - i, w, h,
+                            PIX_NOT(PIX_SRC) & PIX_DST, pixs, 0, 0);
+        }
+    }
+    selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
+    pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
+    pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
+    pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
+    pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
+    return pixd;
+}
@@ -0,0 +1,581 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *   simd_reg.c
+ *
+ *   Tests that the SSE2 and AVX2 versions of inner loops give
+ *   exactly the same results as the portable versions.  Each
+ *   operation is done with the simd level limited to L_SIMD_NONE,
+ *   and then to L_SIMD_SSE2 and L_SIMD_AVX2.  On a processor without
+ *   these instruction sets, or when leptonica is built without
+ *   USE_SIMD, the same code is run each time and the tests pass.
+ *   The recursive gaussian is tested on both 8 and 32 bpp images.
+ *   The correlation scores of 1 bpp images, which use the popcount
+ *   instruction at the AVX2 level, are compared with the ones from
+ *   pixCorrelationScoreSimple().
+ */
+
+#include <math.h>
+#include <string.h>
+#include "allheaders.h"
+
+static l_int32 RasteropDiffs(PIX *pixs, l_int32 level);
+static l_int32 GraymorphDiffs(PIX *pixs, l_int32 level);
+static PIX *GraymorphOp(PIX *pixs, l_int32 index);
+static l_int32 ScaleDiffs(PIX *pixs, l_int32 level);
+static PIX *ScaleOp(PIX *pixs, l_int32 index);
+static l_int32 ColorDiffs(PIX *pixs, l_int32 level);
+static PIX *ColorOp(PIX *pixs, l_int32 index);
+static l_int32 RankDiffs(PIX *pixs, l_int32 level);
+static PIX *RankOp(PIX *pixs, l_int32 index);
+static l_int32 CorrelDiffs(PIX *pixs, l_int32 level);
+static l_int32 GaussDiffs(PIX *pixs, l_int32 level);
+static l_int32 BilateralDiffs(PIX *pixs, l_int32 level);
+static l_int32 DwaselDiffs(PIX *pixs, l_int32 level);
+static l_int32 MorphPlanDiffs(PIX *pixs, l_int32 level);
+
+static const l_int32  ops[] = {PIX_SRC, PIX_NOT(PIX_SRC),
+                               PIX_SRC | PIX_DST, PIX_SRC & PIX_DST,
+                               PIX_SRC ^ PIX_DST, PIX_NOT(PIX_SRC) | PIX_DST,
+                               PIX_NOT(PIX_SRC) & PIX_DST,
+                               PIX_SRC | PIX_NOT(PIX_DST),
+                               PIX_SRC & PIX_NOT(PIX_DST),
+                               PIX_NOT(PIX_SRC | PIX_DST),
+                               PIX_NOT(PIX_SRC & PIX_DST),
+                               PIX_NOT(PIX_SRC ^ PIX_DST)};
+static const l_int32  xvals[] = {0, 3, 32, 45, 61};
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       i, level;
+PIX          *pix1, *pix2, *pix3;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pix1 = pixRead("test1.png");  /* 1 bpp */
+    pix2 = pixRead("test8.jpg");  /* 8 bpp */
+    pix3 = pixRead("marge.jpg");  /* 32 bpp */
+
+        /* Two-image rasterop */
+    for (i = 0; i < 2; i++) {
+        level = (i == 0) ? L_SIMD_SSE2 : L_SIMD_AVX2;
+        regTestCompareValues(rp, 0, RasteropDiffs(pix1, level), 0);
+        regTestCompareValues(rp, 0, RasteropDiffs(pix2, level), 0);
+        regTestCompareValues(rp, 0, RasteropDiffs(pix3, level), 0);
+    }
+
+        /* Grayscale morphology */
+    regTestCompareValues(rp, 0, GraymorphDiffs(pix2, L_SIMD_SSE2), 0);
+    regTestCompareValues(rp, 0, GraymorphDiffs(pix2, L_SIMD_AVX2), 0);
+
+        /* Area map and linear interpolated scaling */
+    for (i = 0; i < 2; i++) {
+        level = (i == 0) ? L_SIMD_SSE2 : L_SIMD_AVX2;
+        regTestCompareValues(rp, 0, ScaleDiffs(pix2, level), 0);
+        regTestCompareValues(rp, 0, ScaleDiffs(pix3, level), 0);
+    }
+
+        /* RGB to gray and colorspace conversion */
+    regTestCompareValues(rp, 0, ColorDiffs(pix3, L_SIMD_SSE2), 0);
+    regTestCompareValues(rp, 0, ColorDiffs(pix3, L_SIMD_AVX2), 0);
+
+        /* Rank filter */
+    for (i = 0; i < 2; i++) {
+        level = (i == 0) ? L_SIMD_SSE2 : L_SIMD_AVX2;
+        regTestCompareValues(rp, 0, RankDiffs(pix2, level), 0);
+        regTestCompareValues(rp, 0, RankDiffs(pix3, level), 0);
+    }
+
+        /* Recursive gaussian */
+    for (i = 0; i < 2; i++) {
+        level = (i == 0) ? L_SIMD_SSE2 : L_SIMD_AVX2;
+        regTestCompareValues(rp, 0, GaussDiffs(pix2, level), 0);
+        regTestCompareValues(rp, 0, GaussDiffs(pix3, level), 0);
+    }
+
+        /* Bilateral filter */
+    regTestCompareValues(rp, 0, BilateralDiffs(pix2, L_SIMD_SSE2), 0);
+    regTestCompareValues(rp, 0, BilateralDiffs(pix2, L_SIMD_AVX2), 0);
+
+        /* Correlation scores of 1 bpp components */
+    regTestCompareValues(rp, 0, CorrelDiffs(pix1, L_SIMD_NONE), 0);
+    regTestCompareValues(rp, 0, CorrelDiffs(pix1, L_SIMD_AVX2), 0);
+
+        /* Binary morphology with sels compiled for dwa */
+    regTestCompareValues(rp, 0, DwaselDiffs(pix1, L_SIMD_SSE2), 0);
+    regTestCompareValues(rp, 0, DwaselDiffs(pix1, L_SIMD_AVX2), 0);
+
+        /* Compiled binary morphological sequences */
+    regTestCompareValues(rp, 0, MorphPlanDiffs(pix1, L_SIMD_SSE2), 0);
+    regTestCompareValues(rp, 0, MorphPlanDiffs(pix1, L_SIMD_AVX2), 0);
+
+    l_setSimdLevel(L_SIMD_AVX2);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    pixDestroy(&pix3);
+    return regTestCleanup(rp);
+}
+
+
+    /* Returns the number of rasterops, over all ops and a set of
+     * alignments, where the result at @level differs from the result
+     * with the portable code.  This includes in-place rasterops
+     * between different raster lines of the same image. */
+static l_int32
+RasteropDiffs(PIX     *pixs,
+              l_int32  level)
+{
+l_int32  i, j, k, w, h, dx, sx, dw, ndiffs, same;
+PIX     *pixt, *pixd1, *pixd2;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    pixt = pixRotate180(NULL, pixs);
+    ndiffs = 0;
+    for (i = 0; i < 12; i++) {
+        for (j = 0; j < 5; j++) {
+            for (k = 0; k < 5; k++) {
+                dx = xvals[j];
+                sx = xvals[k];
+                dw = w - 70 - 3 * j;
+                pixd1 = pixCopy(NULL, pixt);
+                pixd2 = pixCopy(NULL, pixt);
+                l_setSimdLevel(L_SIMD_NONE);
+                pixRasterop(pixd1, dx, 5, dw, h / 2, ops[i], pixs, sx, 11);
+                pixRasterop(pixd1, sx, h / 2 + 7, dw, h / 3, ops[i],
+                            pixd1, dx, 1);
+                l_setSimdLevel(level);
+                pixRasterop(pixd2, dx, 5, dw, h / 2, ops[i], pixs, sx, 11);
+                pixRasterop(pixd2, sx, h / 2 + 7, dw, h / 3, ops[i],
+                            pixd2, dx, 1);
+                pixEqual(pixd1, pixd2, &same);
+                if (!same) ndiffs++;
+                pixDestroy(&pixd1);
+                pixDestroy(&pixd2);
+            }
+        }
+    }
+
+    pixDestroy(&pixt);
+    return ndiffs;
+}
+
+
+    /* Returns the number of grayscale morphological operations, with
+     * odd and even sizes, where the result at @level differs from the
+     * result with the portable code. */
+static l_int32
+GraymorphDiffs(PIX     *pixs,
+               l_int32  level)
+{
+l_int32  i, ndiffs, same;
+PIX     *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = 0; i < 4; i++) {
+        l_setSimdLevel(L_SIMD_NONE);
+        pix1 = GraymorphOp(pixs, i);
+        l_setSimdLevel(level);
+        pix2 = GraymorphOp(pixs, i);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    return ndiffs;
+}
+
+
+static PIX *
+GraymorphOp(PIX     *pixs,
+            l_int32  index)
+{
+    if (index == 0)
+        return pixDilateGray(pixs, 7, 1);
+    else if (index == 1)
+        return pixErodeGray(pixs, 1, 12);
+    else if (index == 2)
+        return pixTophat(pixs, 9, 6, L_TOPHAT_WHITE);
+    else
+        return pixTophat(pixs, 15, 15, L_TOPHAT_BLACK);
+}
+
+
+    /* Returns the number of area map and LI scalings, for a set of
+     * scale factors, where the result at @level differs from the
+     * result with the portable code. */
+static l_int32
+ScaleDiffs(PIX     *pixs,
+           l_int32  level)
+{
+l_int32  i, ndiffs, same;
+PIX     *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = 0; i < 5; i++) {
+        l_setSimdLevel(L_SIMD_NONE);
+        pix1 = ScaleOp(pixs, i);
+        l_setSimdLevel(level);
+        pix2 = ScaleOp(pixs, i);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    return ndiffs;
+}
+
+
+static PIX *
+ScaleOp(PIX     *pixs,
+        l_int32  index)
+{
+    if (index == 0)
+        return pixScaleAreaMap(pixs, 0.37, 0.29);
+    else if (index == 1)
+        return pixScaleAreaMap(pixs, 0.13, 0.61);
+    else if (index == 2)
+        return pixScaleLI(pixs, 1.75, 1.75);
+    else if (index == 3)
+        return pixScaleLI(pixs, 0.85, 2.3);
+    else
+        return pixScaleLI(pixs, 3.1, 1.2);
+}
+
+
+    /* Returns the number of RGB to gray and colorspace conversions
+     * where the result at @level differs from the result with the
+     * portable code.  The XYZ conversion is compared through its
+     * bytes, so that the floats must be identical. */
+static l_int32
+ColorDiffs(PIX     *pixs,
+           l_int32  level)
+{
+l_int32     i, k, w, h, ndiffs, same;
+l_float32  *data1, *data2;
+FPIXA      *fpixa1, *fpixa2;
+PIX        *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = 0; i < 5; i++) {
+        l_setSimdLevel(L_SIMD_NONE);
+        pix1 = ColorOp(pixs, i);
+        l_setSimdLevel(level);
+        pix2 = ColorOp(pixs, i);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    l_setSimdLevel(L_SIMD_NONE);
+    fpixa1 = pixConvertRGBToXYZ(pixs);
+    l_setSimdLevel(level);
+    fpixa2 = pixConvertRGBToXYZ(pixs);
+    fpixaGetFPixDimensions(fpixa1, 0, &w, &h);
+    for (k = 0; k < 3; k++) {
+        data1 = fpixaGetData(fpixa1, k);
+        data2 = fpixaGetData(fpixa2, k);
+        if (memcmp(data1, data2, w * h * sizeof(l_float32)))
+            ndiffs++;
+    }
+    fpixaDestroy(&fpixa1);
+    fpixaDestroy(&fpixa2);
+    return ndiffs;
+}
+
+
+static PIX *
+ColorOp(PIX     *pixs,
+        l_int32  index)
+{
+    if (index == 0)
+        return pixConvertRGBToLuminance(pixs);
+    else if (index == 1)
+        return pixConvertRGBToGray(pixs, 0.7, 0.1, 0.2);
+    else if (index == 2)
+        return pixConvertRGBToGray(pixs, 0.25, 0.5, 0.25);
+    else if (index == 3)
+        return pixConvertRGBToHSV(NULL, pixs);
+    else
+        return pixConvertRGBToYUV(NULL, pixs);
+}
+
+
+    /* Returns the number of rank filterings, for a set of filter
+     * sizes and ranks, where the result at @level differs from the
+     * result with the portable code. */
+static l_int32
+RankDiffs(PIX     *pixs,
+          l_int32  level)
+{
+l_int32  i, ndiffs, same;
+PIX     *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = 0; i < 5; i++) {
+        l_setSimdLevel(L_SIMD_NONE);
+        pix1 = RankOp(pixs, i);
+        l_setSimdLevel(level);
+        pix2 = RankOp(pixs, i);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    return ndiffs;
+}
+
+
+static PIX *
+RankOp(PIX     *pixs,
+       l_int32  index)
+{
+    if (index == 0)
+        return pixMedianFilter(pixs, 3, 3);
+    else if (index == 1)
+        return pixRankFilter(pixs, 8, 5, 0.2);
+    else if (index == 2)
+        return pixRankFilter(pixs, 1, 20, 0.0);
+    else if (index == 3)
+        return pixRankFilter(pixs, 31, 17, 0.9);
+    else
+        return pixRankFilter(pixs, 60, 4, 1.0);
+}
+
+
+    /* Returns the number of pairs of components, in a set of pairs
+     * with different relative placements, where the scores computed
+     * at @level by pixCorrelationScore(), pixCorrelationScoreThresholded()
+     * and pixCorrelationScoreShifts() differ from those found with
+     * pixCorrelationScoreSimple(). */
+static l_int32
+CorrelDiffs(PIX     *pixs,
+            l_int32  level)
+{
+l_int32    i, j, n, k, sx, sy, area1, area2, count, over, ndiffs;
+l_int32    bestx, besty, shiftx, shifty, maxshift;
+l_int32   *tab, *downcount;
+l_float32  delx, dely, score1, score2, maxscore, minscore, thresh;
+PIX       *pix1, *pix2;
+PIXA      *pixa;
+BOXA      *boxa;
+
+    boxa = pixConnComp(pixs, &pixa, 8);
+    n = pixaGetCount(pixa);
+    tab = makePixelSumTab8();
+    l_setSimdLevel(level);
+    ndiffs = 0;
+    for (k = 0; k < 500; k++) {
+        i = (37 * k) % n;
+        j = (101 * k + 7) % n;
+        pix1 = pixaGetPix(pixa, i, L_CLONE);
+        pix2 = pixaGetPix(pixa, j, L_CLONE);
+        pixCountPixels(pix1, &area1, tab);
+        pixCountPixels(pix2, &area2, tab);
+        delx = 0.5 * (k % 13 - 6);
+        dely = 0.5 * (k % 7 - 3) + 0.1 * (k % 2);
+
+            /* One placement */
+        pixCorrelationScore(pix1, pix2, area1, area2, delx, dely,
+                            1000, 1000, tab, &score1);
+        pixCorrelationScoreSimple(pix1, pix2, area1, area2, delx, dely,
+                                  1000, 1000, tab, &score2);
+        if (score1 != score2) ndiffs++;
+        downcount = pixCorrelationMakeDowncount(pix1);
+        thresh = 0.1 * (k % 10);
+        count = (l_int32)(sqrt(score2 * area1 * area2) + 0.5);
+        over = pixCorrelationScoreThresholded(pix1, pix2, area1, area2,
+                                              delx, dely, 1000, 1000, tab,
+                                              downcount, thresh);
+        if (thresh > 0.0 &&
+            over != (count >= (l_int32)ceil(sqrt(thresh * area1 * area2))))
+            ndiffs++;
+
+            /* Best over a range of shifts; some are too large
+             * for the stack arrays */
+        minscore = 0.1 * (k % 4);
+        maxscore = minscore;
+        maxshift = (k % 25 == 0) ? 10 : 2;
+        bestx = besty = 0;
+        for (sy = -maxshift; sy <= maxshift; sy++) {
+            for (sx = -maxshift; sx <= maxshift; sx++) {
+                pixCorrelationScoreSimple(pix1, pix2, area1, area2,
+                                          delx + sx, dely + sy, 5, 5,
+                                          tab, &score2);
+                if (score2 > maxscore) {
+                    maxscore = score2;
+                    bestx = sx;
+                    besty = sy;
+                }
+            }
+        }
+        if (maxscore == minscore) maxscore = 0.0;
+        pixCorrelationScoreShifts(pix1, pix2, area1, area2, delx, dely,
+                                  maxshift, 5, 5, downcount, minscore,
+                                  &score1, &shiftx, &shifty);
+        if (score1 != maxscore ||
+            (maxscore > 0.0 && (shiftx != bestx || shifty != besty)))
+            ndiffs++;
+
+        FREE(downcount);
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    FREE(tab);
+    pixaDestroy(&pixa);
+    boxaDestroy(&boxa);
+    return ndiffs;
+}
+
+
+    /* Returns the number of gaussian blurs, over a set of sigmas,
+     * where the result at @level differs from the portable code */
+static l_int32
+GaussDiffs(PIX     *pixs,
+           l_int32  level)
+{
+l_int32    i, ndiffs, same;
+l_float32  sigx[] = {0.7, 3.0, 25.0, 0.0};
+l_float32  sigy[] = {1.5, 3.0, 60.0, 8.0};
+PIX       *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = 0; i < 4; i++) {
+        l_setSimdLevel(L_SIMD_NONE);
+        pix1 = pixGaussianBlur(pixs, sigx[i], sigy[i]);
+        l_setSimdLevel(level);
+        pix2 = pixGaussianBlur(pixs, sigx[i], sigy[i]);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    return ndiffs;
+}
+
+
+    /* Returns the number of sets of parameters for the bilateral
+     * filter, with different numbers of taps and reductions, where
+     * the result at @level differs from the result with the scalar code */
+static l_int32
+BilateralDiffs(PIX     *pixs,
+               l_int32  level)
+{
+l_int32    i, ndiffs, same;
+l_float32  sstdev[] = {2.0, 5.0, 12.0};
+l_int32    reduction[] = {1, 2, 4};
+PIX       *pix1, *pix2;
+
+    ndiffs = 0;
+    for (i = 0; i < 3; i++) {
+        l_setSimdLevel(L_SIMD_NONE);
+        pix1 = pixBilateral(pixs, sstdev[i], 30.0, 8, reduction[i]);
+        l_setSimdLevel(level);
+        pix2 = pixBilateral(pixs, sstdev[i], 30.0, 8, reduction[i]);
+        pixEqual(pix1, pix2, &same);
+        if (!same) ndiffs++;
+        pixDestroy(&pix1);
+        pixDestroy(&pix2);
+    }
+
+    return ndiffs;
+}
+
+
+    /* Returns the number of operations, with sels of different shapes,
+     * where the result at @level differs from the result with the
+     * scalar code */
+static l_int32
+DwaselDiffs(PIX     *pixs,
+            l_int32  level)
+{
+l_int32  i, k, ndiffs, same;
+PIX     *pix1, *pix2;
+SEL     *sel[3];
+
+    sel[0] = selCreateBrick(5, 7, 2, 3, SEL_HIT);
+    sel[1] = selCreateBrick(1, 43, 0, 40, SEL_HIT);
+    sel[2] = selCreateBrick(3, 3, 1, 1, SEL_MISS);
+    selSetElement(sel[2], 1, 1, SEL_HIT);
+    ndiffs = 0;
+    for (i = 0; i < 3; i++) {
+        for (k = 0; k < 3; k++) {
+            l_setSimdLevel(L_SIMD_NONE);
+            if (k == 0)
+                pix1 = pixDilate(NULL, pixs, sel[i]);
+            else if (k == 1)
+                pix1 = pixErode(NULL, pixs, sel[i]);
+            else
+                pix1 = pixHMT(NULL, pixs, sel[i]);
+            l_setSimdLevel(level);
+            if (k == 0)
+                pix2 = pixDilate(NULL, pixs, sel[i]);
+            else if (k == 1)
+                pix2 = pixErode(NULL, pixs, sel[i]);
+            else
+                pix2 = pixHMT(NULL, pixs, sel[i]);
+            pixEqual(pix1, pix2, &same);
+            if (!same) ndiffs++;
+            pixDestroy(&pix1);
+            pixDestroy(&pix2);
+        }
+    }
+
+    for (i = 0; i < 3; i++)
+        selDestroy(&sel[i]);
+    return ndiffs;
+}
+
+
+static l_int32
+MorphPlanDiffs(PIX     *pixs,
+               l_int32  level)
+{
+l_int32       same;
+L_MORPHPLAN  *plan;
+PIX          *pix1, *pix2;
+
+    plan = l_morphplanCreate("o5.5 + c43.3 + e2.2 + d9.1");
+    l_setSimdLevel(L_SIMD_NONE);
+    pix1 = pixMorphSequencePlan(pixs, plan);
+    l_setSimdLevel(level);
+    pix2 = pixMorphSequencePlan(pixs, plan);
+    pixEqual(pix1, pix2, &same);
+    pixDestroy(&pix1);
+    pixDestroy(&pix2);
+    l_morphplanDestroy(&plan);
+    return (same) ? 0 : 1;
+}
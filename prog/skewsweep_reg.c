@@ -0,0 +1,165 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  skewsweep_reg.c
+ *
+ *    Tests the scores for a sweep of shear angles, which are found
+ *    without making the sheared images, and skew detection with them.
+ */
+
+#include "allheaders.h"
+
+static l_int32 CountScoreDiffs(PIX *pixs, NUMA *natheta, l_int32 pivot);
+
+
+int main(int    argc,
+         char **argv)
+{
+l_int32       i, nthreads, same;
+l_float32     deg2rad, angle, conf;
+BOX          *box;
+NUMA         *natheta, *na1, *na2;
+PIX          *pixs, *pix1;
+L_REGPARAMS  *rp;
+
+    if (regTestSetup(argc, argv, &rp))
+        return 1;
+
+    pix1 = pixRead("tribune-page-4x.png");
+    pixs = pixConvertTo1(pix1, 128);
+    pixDestroy(&pix1);
+    deg2rad = 3.1415926535 / 180.;
+
+        /* Small and large angles, including 0 and angles beyond
+         * +-90 degrees that the shear brings into range */
+    natheta = numaCreate(0);
+    for (i = 0; i < 41; i++)
+        numaAddNumber(natheta, -5.0 + 0.25 * i);
+    numaAddNumber(natheta, 0.01);
+    numaAddNumber(natheta, 17.3);
+    numaAddNumber(natheta, -33.0);
+    numaAddNumber(natheta, 61.0);
+    numaAddNumber(natheta, 120.0);
+    numaAddNumber(natheta, -200.0);
+
+        /* The scores are the same as those from the sheared images */
+    regTestCompareValues(rp, 0,
+            CountScoreDiffs(pixs, natheta, L_SHEAR_ABOUT_CORNER), 0);  /* 0 */
+    regTestCompareValues(rp, 0,
+            CountScoreDiffs(pixs, natheta, L_SHEAR_ABOUT_CENTER), 0);  /* 1 */
+
+        /* The same for a width that is not a multiple of 32, with
+         * a pivot at the center that is not on a word boundary */
+    box = boxCreate(37, 50, 301, 217);
+    pix1 = pixClipRectangle(pixs, box, NULL);
+    regTestCompareValues(rp, 0,
+            CountScoreDiffs(pix1, natheta, L_SHEAR_ABOUT_CORNER), 0);  /* 2 */
+    regTestCompareValues(rp, 0,
+            CountScoreDiffs(pix1, natheta, L_SHEAR_ABOUT_CENTER), 0);  /* 3 */
+    boxDestroy(&box);
+    pixDestroy(&pix1);
+
+        /* The scores don't depend on the number of threads */
+    nthreads = l_setNumThreads(1);
+    na1 = pixFindDifferentialSquareSumSweep(pixs, natheta,
+                                            L_SHEAR_ABOUT_CENTER);
+    l_setNumThreads(4);
+    na2 = pixFindDifferentialSquareSumSweep(pixs, natheta,
+                                            L_SHEAR_ABOUT_CENTER);
+    l_setNumThreads(nthreads);
+    numaSimilar(na1, na2, 0.0, &same);
+    regTestCompareValues(rp, 1, same, 0);  /* 4 */
+    numaDestroy(&na1);
+    numaDestroy(&na2);
+
+        /* Skew of the rotated image, which has no skew to begin with,
+         * found by sweep alone and by sweep and search about both pivots */
+    pix1 = pixRotate(pixs, deg2rad * 2.7, L_ROTATE_SAMPLING,
+                     L_BRING_IN_WHITE, 0, 0);
+    pixFindSkewSweep(pix1, &angle, 2, 5.0, 0.1);
+    regTestCompareValues(rp, -2.7, angle, 0.1);  /* 5 */
+    pixFindSkewSweepAndSearchScorePivot(pix1, &angle, &conf, NULL, 2, 1,
+                                        0.0, 5.0, 1.0, 0.01,
+                                        L_SHEAR_ABOUT_CORNER);
+    regTestCompareValues(rp, -2.7, angle, 0.05);  /* 6 */
+    regTestCompareValues(rp, 1, conf > 2.0, 0);  /* 7 */
+    pixFindSkewSweepAndSearchScorePivot(pix1, &angle, &conf, NULL, 2, 1,
+                                        0.0, 5.0, 1.0, 0.01,
+                                        L_SHEAR_ABOUT_CENTER);
+    regTestCompareValues(rp, -2.7, angle, 0.05);  /* 8 */
+    regTestCompareValues(rp, 1, conf > 2.0, 0);  /* 9 */
+    pixDestroy(&pix1);
+
+        /* Invalid input */
+    pix1 = pixConvertTo8(pixs, 0);
+    na1 = pixFindDifferentialSquareSumSweep(pix1, natheta,
+                                            L_SHEAR_ABOUT_CORNER);
+    regTestCompareValues(rp, 1, (na1 == NULL), 0);  /* 10 */
+    pixDestroy(&pix1);
+
+    numaDestroy(&natheta);
+    pixDestroy(&pixs);
+    return regTestCleanup(rp);
+}
+
+
+    /* Returns the number of angles at which the score differs from
+     * the score of the image sheared with rasterops */
+static l_int32
+CountScoreDiffs(PIX     *pixs,
+                NUMA    *natheta,
+                l_int32  pivot)
+{
+l_int32    i, n, ndiffs;
+l_float32  deg2rad, theta, sum, score;
+NUMA      *nascore;
+PIX       *pixt;
+
+    deg2rad = 3.1415926535 / 180.;
+    nascore = pixFindDifferentialSquareSumSweep(pixs, natheta, pivot);
+    n = numaGetCount(natheta);
+    if (!nascore || numaGetCount(nascore) != n)
+        return n;
+
+    pixt = pixCreateTemplate(pixs);
+    ndiffs = 0;
+    for (i = 0; i < n; i++) {
+        numaGetFValue(natheta, i, &theta);
+        if (pivot == L_SHEAR_ABOUT_CORNER)
+            pixVShearCorner(pixt, pixs, deg2rad * theta, L_BRING_IN_WHITE);
+        else
+            pixVShearCenter(pixt, pixs, deg2rad * theta, L_BRING_IN_WHITE);
+        pixFindDifferentialSquareSum(pixt, &sum);
+        numaGetFValue(nascore, i, &score);
+        if (score != sum)
+            ndiffs++;
+    }
+    pixDestroy(&pixt);
+    numaDestroy(&nascore);
+    return ndiffs;
+}
@@ -66,7 +66,9 @@
  *
  *      Apply inverse background map to image
  *          PIX       *pixApplyInvBackgroundGrayMap()   8 bpp
+ *          static l_int32  applyInvBackgroundGrayRow()
  *          PIX       *pixApplyInvBackgroundRGBMap()    32 bpp
+ *          static l_int32  applyInvBackgroundRGBRow()
  *
  *      Apply variable map
  *          PIX       *pixApplyVariableGrayMap()        8 bpp
@@ -150,6 +152,22 @@ static const l_int32  DEFAULT_Y_SMOOTH_SIZE = 1;
 
 static l_int32 *iaaGetLinearTRC(l_int32 **iaa, l_int32 diff);
 
+    /* Images shared by the row jobs that apply the inverse background
+     * map.  Each job handles one row of tiles, and writes a disjoint
+     * set of raster lines in pixd. */
+struct InvBackgroundApply
+{
+    PIX       *pixs;       /* 8 or 32 bpp input                        */
+    PIX       *pixd;       /* output, same size and depth as pixs      */
+    PIX       *pixm[3];    /* 16 bpp inverse maps; only [0] for gray   */
+    l_int32    sx;         /* tile width                               */
+    l_int32    sy;         /* tile height                              */
+};
+typedef struct InvBackgroundApply  INV_BACKGROUND_APPLY;
+
+static l_int32 applyInvBackgroundGrayRow(void *data, l_int32 i);
+static l_int32 applyInvBackgroundRGBRow(void *data, l_int32 i);
+
 #ifndef  NO_CONSOLE_IO
 #define  DEBUG_GLOBAL    0
 #endif  /* ~NO_CONSOLE_IO */
@@ -1845,6 +1863,10 @@ PIX       *pixsm, *pixd;
  *              sx (tile width in pixels)
  *              sy (tile height in pixels)
  *      Return: pixd (8 bpp), or null on error
+ *
+ *  Notes:
+ *      (1) The rows of tiles are processed in parallel, using the
+ *          default number of threads set by l_setNumThreads().
  */
 PIX *
 pixApplyInvBackgroundGrayMap(PIX     *pixs,
@@ -1852,11 +1874,8 @@ pixApplyInvBackgroundGrayMap(PIX     *pixs,
                              l_int32  sx,
                              l_int32  sy)
 {
-l_int32    w, h, wm, hm, wpls, wpld, i, j, k, m, xoff, yoff;
-l_int32    vals, vald;
-l_uint32   val16;
-l_uint32  *datas, *datad, *lines, *lined, *flines, *flined;
-PIX       *pixd;
+PIX                   *pixd;
+INV_BACKGROUND_APPLY   iba;
 
     PROCNAME("pixApplyInvBackgroundGrayMap");
 
@@ -1869,34 +1888,60 @@ PIX       *pixd;
     if (sx == 0 || sy == 0)
         return (PIX *)ERROR_PTR("invalid sx and/or sy", procName, NULL);
 
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    pixGetDimensions(pixs, &w, &h, NULL);
-    pixGetDimensions(pixm, &wm, &hm, NULL);
-    pixd = pixCreateTemplate(pixs);
-    datad = pixGetData(pixd);
-    wpld = pixGetWpl(pixd);
-    for (i = 0; i < hm; i++) {
-        lines = datas + sy * i * wpls;
-        lined = datad + sy * i * wpld;
-        yoff = sy * i;
-        for (j = 0; j < wm; j++) {
-            pixGetPixel(pixm, j, i, &val16);
-            xoff = sx * j;
-            for (k = 0; k < sy && yoff + k < h; k++) {
-                flines = lines + k * wpls;
-                flined = lined + k * wpld;
-                for (m = 0; m < sx && xoff + m < w; m++) {
-                    vals = GET_DATA_BYTE(flines, xoff + m);
-                    vald = (vals * val16) / 256;
-                    vald = L_MIN(vald, 255);
-                    SET_DATA_BYTE(flined, xoff + m, vald);
-                }
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    iba.pixs = pixs;
+    iba.pixd = pixd;
+    iba.pixm[0] = pixm;
+    iba.sx = sx;
+    iba.sy = sy;
+    l_parallelRun(pixGetHeight(pixm), applyInvBackgroundGrayRow, &iba, 0);
+    return pixd;
+}
+
+
+/*!
+ *  applyInvBackgroundGrayRow()
+ *
+ *      Input:  data (INV_BACKGROUND_APPLY)
+ *              i (row of tiles; row index in the map)
+ *      Return: 0
+ */
+static l_int32
+applyInvBackgroundGrayRow(void    *data,
+                          l_int32  i)
+{
+l_int32                w, h, wm, wpls, wpld, j, k, m, xoff, yoff, sx, sy;
+l_int32                vals, vald;
+l_uint32               val16;
+l_uint32              *lines, *lined, *flines, *flined;
+INV_BACKGROUND_APPLY  *iba;
+
+    iba = (INV_BACKGROUND_APPLY *)data;
+    sx = iba->sx;
+    sy = iba->sy;
+    wpls = pixGetWpl(iba->pixs);
+    wpld = pixGetWpl(iba->pixd);
+    pixGetDimensions(iba->pixs, &w, &h, NULL);
+    wm = pixGetWidth(iba->pixm[0]);
+    lines = pixGetData(iba->pixs) + sy * i * wpls;
+    lined = pixGetData(iba->pixd) + sy * i * wpld;
+    yoff = sy * i;
+    for (j = 0; j < wm; j++) {
+        pixGetPixel(iba->pixm[0], j, i, &val16);
+        xoff = sx * j;
+        for (k = 0; k < sy && yoff + k < h; k++) {
+            flines = lines + k * wpls;
+            flined = lined + k * wpld;
+            for (m = 0; m < sx && xoff + m < w; m++) {
+                vals = GET_DATA_BYTE(flines, xoff + m);
+                vald = (vals * val16) / 256;
+                vald = L_MIN(vald, 255);
+                SET_DATA_BYTE(flined, xoff + m, vald);
             }
         }
     }
-
-    return pixd;
+    return 0;
 }
 
 
@@ -1910,6 +1955,10 @@ PIX       *pixd;
  *              sx (tile width in pixels)
  *              sy (tile height in pixels)
  *      Return: pixd (32 bpp rbg), or null on error
+ *
+ *  Notes:
+ *      (1) The rows of tiles are processed in parallel, using the
+ *          default number of threads set by l_setNumThreads().
  */
 PIX *
 pixApplyInvBackgroundRGBMap(PIX     *pixs,
@@ -1919,12 +1968,8 @@ pixApplyInvBackgroundRGBMap(PIX     *pixs,
                             l_int32  sx,
                             l_int32  sy)
 {
-l_int32    w, h, wm, hm, wpls, wpld, i, j, k, m, xoff, yoff;
-l_int32    rvald, gvald, bvald;
-l_uint32   vals;
-l_uint32   rval16, gval16, bval16;
-l_uint32  *datas, *datad, *lines, *lined, *flines, *flined;
-PIX       *pixd;
+PIX                   *pixd;
+INV_BACKGROUND_APPLY   iba;
 
     PROCNAME("pixApplyInvBackgroundRGBMap");
 
@@ -1940,42 +1985,69 @@ PIX       *pixd;
     if (sx == 0 || sy == 0)
         return (PIX *)ERROR_PTR("invalid sx and/or sy", procName, NULL);
 
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    w = pixGetWidth(pixs);
-    h = pixGetHeight(pixs);
-    wm = pixGetWidth(pixmr);
-    hm = pixGetHeight(pixmr);
-    pixd = pixCreateTemplate(pixs);
-    datad = pixGetData(pixd);
-    wpld = pixGetWpl(pixd);
-    for (i = 0; i < hm; i++) {
-        lines = datas + sy * i * wpls;
-        lined = datad + sy * i * wpld;
-        yoff = sy * i;
-        for (j = 0; j < wm; j++) {
-            pixGetPixel(pixmr, j, i, &rval16);
-            pixGetPixel(pixmg, j, i, &gval16);
-            pixGetPixel(pixmb, j, i, &bval16);
-            xoff = sx * j;
-            for (k = 0; k < sy && yoff + k < h; k++) {
-                flines = lines + k * wpls;
-                flined = lined + k * wpld;
-                for (m = 0; m < sx && xoff + m < w; m++) {
-                    vals = *(flines + xoff + m);
-                    rvald = ((vals >> 24) * rval16) / 256;
-                    rvald = L_MIN(rvald, 255);
-                    gvald = (((vals >> 16) & 0xff) * gval16) / 256;
-                    gvald = L_MIN(gvald, 255);
-                    bvald = (((vals >> 8) & 0xff) * bval16) / 256;
-                    bvald = L_MIN(bvald, 255);
-                    composeRGBPixel(rvald, gvald, bvald, flined + xoff + m);
-                }
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    iba.pixs = pixs;
+    iba.pixd = pixd;
+    iba.pixm[0] = pixmr;
+    iba.pixm[1] = pixmg;
+    iba.pixm[2] = pixmb;
+    iba.sx = sx;
+    iba.sy = sy;
+    l_parallelRun(pixGetHeight(pixmr), applyInvBackgroundRGBRow, &iba, 0);
+    return pixd;
+}
+
+
+/*!
+ *  applyInvBackgroundRGBRow()
+ *
+ *      Input:  data (INV_BACKGROUND_APPLY)
+ *              i (row of tiles; row index in the maps)
+ *      Return: 0
+ */
+static l_int32
+applyInvBackgroundRGBRow(void    *data,
+                         l_int32  i)
+{
+l_int32                w, h, wm, wpls, wpld, j, k, m, xoff, yoff, sx, sy;
+l_int32                rvald, gvald, bvald;
+l_uint32               vals;
+l_uint32               rval16, gval16, bval16;
+l_uint32              *lines, *lined, *flines, *flined;
+INV_BACKGROUND_APPLY  *iba;
+
+    iba = (INV_BACKGROUND_APPLY *)data;
+    sx = iba->sx;
+    sy = iba->sy;
+    wpls = pixGetWpl(iba->pixs);
+    wpld = pixGetWpl(iba->pixd);
+    pixGetDimensions(iba->pixs, &w, &h, NULL);
+    wm = pixGetWidth(iba->pixm[0]);
+    lines = pixGetData(iba->pixs) + sy * i * wpls;
+    lined = pixGetData(iba->pixd) + sy * i * wpld;
+    yoff = sy * i;
+    for (j = 0; j < wm; j++) {
+        pixGetPixel(iba->pixm[0], j, i, &rval16);
+        pixGetPixel(iba->pixm[1], j, i, &gval16);
+        pixGetPixel(iba->pixm[2], j, i, &bval16);
+        xoff = sx * j;
+        for (k = 0; k < sy && yoff + k < h; k++) {
+            flines = lines + k * wpls;
+            flined = lined + k * wpld;
+            for (m = 0; m < sx && xoff + m < w; m++) {
+                vals = *(flines + xoff + m);
+                rvald = ((vals >> 24) * rval16) / 256;
+                rvald = L_MIN(rvald, 255);
+                gvald = (((vals >> 16) & 0xff) * gval16) / 256;
+                gvald = L_MIN(gvald, 255);
+                bvald = (((vals >> 8) & 0xff) * bval16) / 256;
+                bvald = L_MIN(bvald, 255);
+                composeRGBPixel(rvald, gvald, bvald, flined + xoff + m);
             }
         }
     }
-
-    return pixd;
+    return 0;
 }
 
 
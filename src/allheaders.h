@@ -563,6 +563,7 @@ LEPT_DLL extern BOXA * pixConnComp ( PIX *pixs, PIXA **ppixa, l_int32 connectivi
 LEPT_DLL extern BOXA * pixConnCompPixa ( PIX *pixs, PIXA **ppixa, l_int32 connectivity );
 LEPT_DLL extern BOXA * pixConnCompBB ( PIX *pixs, l_int32 connectivity );
 LEPT_DLL extern l_int32 pixCountConnComp ( PIX *pixs, l_int32 connectivity, l_int32 *pcount );
+LEPT_DLL extern BOXA * pixConnCompLabels ( PIX *pixs, PIXA **ppixa, PIX **ppixd, l_int32 connectivity );
 LEPT_DLL extern l_int32 nextOnPixelInRaster ( PIX *pixs, l_int32 xstart, l_int32 ystart, l_int32 *px, l_int32 *py );
 LEPT_DLL extern l_int32 nextOnPixelInRasterLow ( l_uint32 *data, l_int32 w, l_int32 h, l_int32 wpl, l_int32 xstart, l_int32 ystart, l_int32 *px, l_int32 *py );
 LEPT_DLL extern BOX * pixSeedfillBB ( PIX *pixs, L_STACK *stack, l_int32 x, l_int32 y, l_int32 connectivity );
@@ -592,6 +593,8 @@ LEPT_DLL extern PIX * pixConvolveRGB ( PIX *pixs, L_KERNEL *kel );
 LEPT_DLL extern PIX * pixConvolveRGBSep ( PIX *pixs, L_KERNEL *kelx, L_KERNEL *kely );
 LEPT_DLL extern FPIX * fpixConvolve ( FPIX *fpixs, L_KERNEL *kel, l_int32 normflag );
 LEPT_DLL extern FPIX * fpixConvolveSep ( FPIX *fpixs, L_KERNEL *kelx, L_KERNEL *kely, l_int32 normflag );
+LEPT_DLL extern PIX * pixGaussianBlur ( PIX *pixs, l_float32 sigmax, l_float32 sigmay );
+LEPT_DLL extern FPIX * fpixGaussianBlur ( FPIX *fpixs, l_float32 sigmax, l_float32 sigmay );
 LEPT_DLL extern PIX * pixConvolveWithBias ( PIX *pixs, L_KERNEL *kel1, L_KERNEL *kel2, l_int32 force8, l_int32 *pbias );
 LEPT_DLL extern void l_setConvolveSampling ( l_int32 xfact, l_int32 yfact );
 LEPT_DLL extern PIX * pixAddGaussianNoise ( PIX *pixs, l_float32 stdev );
@@ -600,6 +603,8 @@ LEPT_DLL extern l_int32 pixCorrelationScore ( PIX *pix1, PIX *pix2, l_int32 area
 LEPT_DLL extern l_int32 pixCorrelationScoreThresholded ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_float32 delx, l_float32 dely, l_int32 maxdiffw, l_int32 maxdiffh, l_int32 *tab, l_int32 *downcount, l_float32 score_threshold );
 LEPT_DLL extern l_int32 pixCorrelationScoreSimple ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_float32 delx, l_float32 dely, l_int32 maxdiffw, l_int32 maxdiffh, l_int32 *tab, l_float32 *pscore );
 LEPT_DLL extern l_int32 pixCorrelationScoreShifted ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_int32 delx, l_int32 dely, l_int32 *tab, l_float32 *pscore );
+LEPT_DLL extern l_int32 pixCorrelationScoreShifts ( PIX *pix1, PIX *pix2, l_int32 area1, l_int32 area2, l_float32 delx, l_float32 dely, l_int32 maxshift, l_int32 maxdiffw, l_int32 maxdiffh, l_int32 *downcount, l_float32 minscore, l_float32 *pscore, l_int32 *pshiftx, l_int32 *pshifty );
+LEPT_DLL extern l_int32 * pixCorrelationMakeDowncount ( PIX *pix );
 LEPT_DLL extern L_DEWARP * dewarpCreate ( PIX *pixs, l_int32 pageno );
 LEPT_DLL extern L_DEWARP * dewarpCreateRef ( l_int32 pageno, l_int32 refpage );
 LEPT_DLL extern void dewarpDestroy ( L_DEWARP **pdew );
@@ -721,6 +726,7 @@ LEPT_DLL extern PIX * pixUnsharpMaskingFast ( PIX *pixs, l_int32 halfwidth, l_fl
 LEPT_DLL extern PIX * pixUnsharpMaskingGrayFast ( PIX *pixs, l_int32 halfwidth, l_float32 fract, l_int32 direction );
 LEPT_DLL extern PIX * pixUnsharpMaskingGray1D ( PIX *pixs, l_int32 halfwidth, l_float32 fract, l_int32 direction );
 LEPT_DLL extern PIX * pixUnsharpMaskingGray2D ( PIX *pixs, l_int32 halfwidth, l_float32 fract );
+LEPT_DLL extern PIX * pixUnsharpMaskingGauss ( PIX *pixs, l_float32 sigma, l_float32 fract );
 LEPT_DLL extern PIX * pixModifyHue ( PIX *pixd, PIX *pixs, l_float32 fract );
 LEPT_DLL extern PIX * pixModifySaturation ( PIX *pixd, PIX *pixs, l_float32 fract );
 LEPT_DLL extern l_int32 pixMeasureSaturation ( PIX *pixs, l_int32 factor, l_float32 *psat );
@@ -966,6 +972,14 @@ LEPT_DLL extern l_int32 lheapSwapDown ( L_HEAP *lh );
 LEPT_DLL extern l_int32 lheapSort ( L_HEAP *lh );
 LEPT_DLL extern l_int32 lheapSortStrictOrder ( L_HEAP *lh );
 LEPT_DLL extern l_int32 lheapPrint ( FILE *fp, L_HEAP *lh );
+LEPT_DLL extern L_INTEGRAL * l_integralCreate ( PIX *pixs, l_int32 sqflag );
+LEPT_DLL extern void l_integralDestroy ( L_INTEGRAL **pli );
+LEPT_DLL extern l_int32 l_integralGetDimensions ( L_INTEGRAL *li, l_int32 *pw, l_int32 *ph, l_int32 *pd );
+LEPT_DLL extern l_int32 l_integralGetSums ( L_INTEGRAL *li, l_int32 x, l_int32 y, l_int32 w, l_int32 h, l_uint64 *psum, l_uint64 *psumsq, l_int32 *pnpix );
+LEPT_DLL extern l_int32 l_integralGetStats ( L_INTEGRAL *li, BOX *box, l_float32 *pmean, l_float32 *pvar, l_float32 *prvar );
+LEPT_DLL extern l_int32 l_integralWindowedStats ( L_INTEGRAL *li, l_int32 wc, l_int32 hc, l_int32 hasborder, PIX **ppixm, PIX **ppixms, FPIX **pfpixv, FPIX **pfpixrv );
+LEPT_DLL extern l_int32 l_integralTiledStats ( L_INTEGRAL *li, l_int32 sx, l_int32 sy, FPIX **pfpixm, FPIX **pfpixv, FPIX **pfpixrv );
+LEPT_DLL extern l_int32 l_integralQuadtreeStats ( L_INTEGRAL *li, l_int32 nlevels, FPIXA **pfpixam, FPIXA **pfpixav, FPIXA **pfpixarv );
 LEPT_DLL extern JBCLASSER * jbRankHausInit ( l_int32 components, l_int32 maxwidth, l_int32 maxheight, l_int32 size, l_float32 rank );
 LEPT_DLL extern JBCLASSER * jbCorrelationInit ( l_int32 components, l_int32 maxwidth, l_int32 maxheight, l_float32 thresh, l_float32 weightfactor );
 LEPT_DLL extern JBCLASSER * jbCorrelationInitWithoutComponents ( l_int32 components, l_int32 maxwidth, l_int32 maxheight, l_float32 thresh, l_float32 weightfactor );
@@ -1110,6 +1124,9 @@ LEPT_DLL extern PIX * pixOpenCompBrickExtendDwa ( PIX *pixd, PIX *pixs, l_int32
 LEPT_DLL extern PIX * pixCloseCompBrickExtendDwa ( PIX *pixd, PIX *pixs, l_int32 hsize, l_int32 vsize );
 LEPT_DLL extern l_int32 getExtendedCompositeParameters ( l_int32 size, l_int32 *pn, l_int32 *pextra, l_int32 *pactualsize );
 LEPT_DLL extern PIX * pixMorphSequence ( PIX *pixs, const char *sequence, l_int32 dispsep );
+LEPT_DLL extern L_MORPHPLAN * l_morphplanCreate ( const char *sequence );
+LEPT_DLL extern void l_morphplanDestroy ( L_MORPHPLAN **pplan );
+LEPT_DLL extern PIX * pixMorphSequencePlan ( PIX *pixs, L_MORPHPLAN *plan );
 LEPT_DLL extern PIX * pixMorphCompSequence ( PIX *pixs, const char *sequence, l_int32 dispsep );
 LEPT_DLL extern PIX * pixMorphSequenceDwa ( PIX *pixs, const char *sequence, l_int32 dispsep );
 LEPT_DLL extern PIX * pixMorphCompSequenceDwa ( PIX *pixs, const char *sequence, l_int32 dispsep );
@@ -1280,6 +1297,20 @@ LEPT_DLL extern l_int32 pixColorGrayMaskedCmap ( PIX *pixs, PIX *pixm, l_int32 t
 LEPT_DLL extern l_int32 addColorizedGrayToCmap ( PIXCMAP *cmap, l_int32 type, l_int32 rval, l_int32 gval, l_int32 bval, NUMA **pna );
 LEPT_DLL extern l_int32 pixSetSelectMaskedCmap ( PIX *pixs, PIX *pixm, l_int32 x, l_int32 y, l_int32 sindex, l_int32 rval, l_int32 gval, l_int32 bval );
 LEPT_DLL extern l_int32 pixSetMaskedCmap ( PIX *pixs, PIX *pixm, l_int32 x, l_int32 y, l_int32 rval, l_int32 gval, l_int32 bval );
+LEPT_DLL extern l_int32 l_setNumThreads ( l_int32 nthreads );
+LEPT_DLL extern l_int32 l_getNumThreads ( void );
+LEPT_DLL extern l_int32 l_getNumProcessors ( void );
+LEPT_DLL extern l_int32 l_parallelRun ( l_int32 njobs, L_JOB_FUNC func, void *data, l_int32 nthreads );
+LEPT_DLL extern l_int32 l_parallelGetStats ( l_int32 *pnstarted, l_int32 *pmaxrunning );
+LEPT_DLL extern void l_parallelResetStats ( void );
+LEPT_DLL extern L_THREAD * l_threadCreate ( L_JOB_FUNC func, void *data, l_int32 index );
+LEPT_DLL extern l_int32 l_threadJoin ( L_THREAD **pthread );
+LEPT_DLL extern L_MUTEX * l_mutexCreate ( void );
+LEPT_DLL extern void l_mutexDestroy ( L_MUTEX **pmutex );
+LEPT_DLL extern void l_mutexLock ( L_MUTEX *mutex );
+LEPT_DLL extern void l_mutexUnlock ( L_MUTEX *mutex );
+LEPT_DLL extern l_int32 l_setSimdLevel ( l_int32 level );
+LEPT_DLL extern l_int32 l_getSimdLevel ( void );
 LEPT_DLL extern char * parseForProtos ( const char *filein, const char *prestring );
 LEPT_DLL extern BOXA * boxaGetWhiteblocks ( BOXA *boxas, BOX *box, l_int32 sortflag, l_int32 maxboxes, l_float32 maxoverlap, l_int32 maxperim, l_float32 fract, l_int32 maxpops );
 LEPT_DLL extern BOXA * boxaPruneSortedOnOverlap ( BOXA *boxas, l_float32 maxoverlap );
@@ -1312,7 +1343,14 @@ LEPT_DLL extern l_int32 ptraConcatenatePdf ( L_PTRA *pa, const char *fileout );
 LEPT_DLL extern l_int32 concatenatePdfToData ( const char *dirname, const char *substr, l_uint8 **pdata, size_t *pnbytes );
 LEPT_DLL extern l_int32 saConcatenatePdfToData ( SARRAY *sa, l_uint8 **pdata, size_t *pnbytes );
 LEPT_DLL extern l_int32 pixConvertToPdfData ( PIX *pix, l_int32 type, l_int32 quality, l_uint8 **pdata, size_t *pnbytes, l_int32 x, l_int32 y, l_int32 res, const char *title, L_PDF_DATA **plpd, l_int32 position );
+LEPT_DLL extern L_PTRA * l_generatePdfPages ( SARRAY *sa, PIXA *pixa, PIXAC *pixac, l_int32 res, l_float32 scalefactor, l_int32 type, l_int32 quality, const char *title );
 LEPT_DLL extern l_int32 ptraConcatenatePdfToData ( L_PTRA *pa_data, SARRAY *sa, l_uint8 **pdata, size_t *pnbytes );
+LEPT_DLL extern L_PDF_WRITER * l_pdfWriterCreate ( FILE *fp, L_PDF_WRITE_FUNC func, void *handle, const char *title );
+LEPT_DLL extern l_int32 l_pdfWriterAddPix ( L_PDF_WRITER *lpw, PIX *pix, l_int32 type, l_int32 quality, l_int32 res );
+LEPT_DLL extern l_int32 l_pdfWriterAddPdfData ( L_PDF_WRITER *lpw, const l_uint8 *data, size_t nbytes );
+LEPT_DLL extern l_int32 l_pdfWriterAddPages ( L_PDF_WRITER *lpw, SARRAY *sa, PIXA *pixa, PIXAC *pixac, l_int32 res, l_float32 scalefactor, l_int32 type, l_int32 quality );
+LEPT_DLL extern l_int32 l_pdfWriterClose ( L_PDF_WRITER **plpw );
+LEPT_DLL extern l_int32 l_pdfWriteToBytea ( void *handle, const l_uint8 *data, size_t nbytes );
 LEPT_DLL extern l_int32 l_generateCIDataForPdf ( const char *fname, PIX *pix, l_int32 quality, L_COMP_DATA **pcid );
 LEPT_DLL extern L_COMP_DATA * l_generateFlateDataPdf ( const char *fname, PIX *pixs );
 LEPT_DLL extern L_COMP_DATA * l_generateJpegData ( const char *fname, l_int32 ascii85flag );
@@ -1675,6 +1713,13 @@ LEPT_DLL extern void * pmsGetAlloc ( size_t nbytes );
 LEPT_DLL extern l_int32 pmsGetLevelForAlloc ( size_t nbytes, l_int32 *plevel );
 LEPT_DLL extern l_int32 pmsGetLevelForDealloc ( void *data, l_int32 *plevel );
 LEPT_DLL extern void pmsLogInfo (  );
+LEPT_DLL extern l_int32 l_poolCreate ( size_t arenasize, l_int32 stats );
+LEPT_DLL extern void l_poolDestroy ( void );
+LEPT_DLL extern void * l_poolAlloc ( size_t nbytes );
+LEPT_DLL extern void * l_poolCalloc ( size_t nelem, size_t elemsize );
+LEPT_DLL extern void * l_poolReallocNew ( void **pindata, l_int32 oldsize, l_int32 newsize );
+LEPT_DLL extern void l_poolFree ( void *data );
+LEPT_DLL extern void l_poolLogInfo ( void );
 LEPT_DLL extern l_int32 pixAddConstantGray ( PIX *pixs, l_int32 val );
 LEPT_DLL extern l_int32 pixMultConstantGray ( PIX *pixs, l_float32 val );
 LEPT_DLL extern PIX * pixAddGray ( PIX *pixd, PIX *pixs1, PIX *pixs2 );
@@ -1703,6 +1748,8 @@ LEPT_DLL extern PIXAC * pixacompCreateWithInit ( l_int32 n, l_int32 offset, PIX
 LEPT_DLL extern PIXAC * pixacompCreateFromPixa ( PIXA *pixa, l_int32 comptype, l_int32 accesstype );
 LEPT_DLL extern PIXAC * pixacompCreateFromFiles ( const char *dirname, const char *substr, l_int32 comptype );
 LEPT_DLL extern PIXAC * pixacompCreateFromSA ( SARRAY *sa, l_int32 comptype );
+LEPT_DLL extern PIXAC * pixacompCreateFromFilesLazy ( const char *dirname, const char *substr, l_int32 comptype );
+LEPT_DLL extern PIXAC * pixacompCreateFromSALazy ( SARRAY *sa, l_int32 comptype );
 LEPT_DLL extern void pixacompDestroy ( PIXAC **ppixac );
 LEPT_DLL extern l_int32 pixacompAddPix ( PIXAC *pixac, PIX *pix, l_int32 comptype );
 LEPT_DLL extern l_int32 pixacompAddPixcomp ( PIXAC *pixac, PIXC *pixc );
@@ -1719,6 +1766,8 @@ LEPT_DLL extern BOX * pixacompGetBox ( PIXAC *pixac, l_int32 index, l_int32 acce
 LEPT_DLL extern l_int32 pixacompGetBoxGeometry ( PIXAC *pixac, l_int32 index, l_int32 *px, l_int32 *py, l_int32 *pw, l_int32 *ph );
 LEPT_DLL extern l_int32 pixacompGetOffset ( PIXAC *pixac );
 LEPT_DLL extern l_int32 pixacompSetOffset ( PIXAC *pixac, l_int32 offset );
+LEPT_DLL extern l_int32 pixacompSetCache ( PIXAC *pixac, size_t maxbytes, l_int32 nprefetch );
+LEPT_DLL extern l_int32 pixacompGetCacheInfo ( PIXAC *pixac, l_int32 *pnpix, size_t *pnbytes );
 LEPT_DLL extern PIXA * pixaCreateFromPixacomp ( PIXAC *pixac, l_int32 accesstype );
 LEPT_DLL extern PIXAC * pixacompRead ( const char *filename );
 LEPT_DLL extern PIXAC * pixacompReadStream ( FILE *fp );
@@ -1786,6 +1835,7 @@ LEPT_DLL extern l_int32 pixTilingGetSize ( PIXTILING *pt, l_int32 *pw, l_int32 *
 LEPT_DLL extern PIX * pixTilingGetTile ( PIXTILING *pt, l_int32 i, l_int32 j );
 LEPT_DLL extern l_int32 pixTilingNoStripOnPaint ( PIXTILING *pt );
 LEPT_DLL extern l_int32 pixTilingPaintTile ( PIX *pixd, l_int32 i, l_int32 j, PIX *pixs, PIXTILING *pt );
+LEPT_DLL extern l_int32 pixTilingExecute ( PIXTILING *pt, L_TILE_FUNC func, void *data, l_int32 nthreads );
 LEPT_DLL extern PIX * pixReadStreamPng ( FILE *fp );
 LEPT_DLL extern l_int32 readHeaderPng ( const char *filename, l_int32 *pw, l_int32 *ph, l_int32 *pbps, l_int32 *pspp, l_int32 *piscmap );
 LEPT_DLL extern l_int32 freadHeaderPng ( FILE *fp, l_int32 *pw, l_int32 *ph, l_int32 *pbps, l_int32 *pspp, l_int32 *piscmap );
@@ -2210,7 +2260,9 @@ LEPT_DLL extern PIX * pixScaleGrayRank2 ( PIX *pixs, l_int32 rank );
 LEPT_DLL extern l_int32 pixScaleAndTransferAlpha ( PIX *pixd, PIX *pixs, l_float32 scalex, l_float32 scaley );
 LEPT_DLL extern PIX * pixScaleWithAlpha ( PIX *pixs, l_float32 scalex, l_float32 scaley, PIX *pixg, l_float32 fract );
 LEPT_DLL extern void scaleColorLILow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
+LEPT_DLL extern void scaleColorLIBandLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls, l_int32 ystart, l_int32 yend );
 LEPT_DLL extern void scaleGrayLILow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
+LEPT_DLL extern void scaleGrayLIBandLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls, l_int32 ystart, l_int32 yend );
 LEPT_DLL extern void scaleColor2xLILow ( l_uint32 *datad, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
 LEPT_DLL extern void scaleColor2xLILineLow ( l_uint32 *lined, l_int32 wpld, l_uint32 *lines, l_int32 ws, l_int32 wpls, l_int32 lastlineflag );
 LEPT_DLL extern void scaleGray2xLILow ( l_uint32 *datad, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
@@ -2221,7 +2273,9 @@ LEPT_DLL extern l_int32 scaleBySamplingLow ( l_uint32 *datad, l_int32 wd, l_int3
 LEPT_DLL extern l_int32 scaleSmoothLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 d, l_int32 wpls, l_int32 size );
 LEPT_DLL extern void scaleRGBToGray2Low ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_float32 rwt, l_float32 gwt, l_float32 bwt );
 LEPT_DLL extern void scaleColorAreaMapLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
+LEPT_DLL extern void scaleColorAreaMapBandLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls, l_int32 ystart, l_int32 yend );
 LEPT_DLL extern void scaleGrayAreaMapLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
+LEPT_DLL extern void scaleGrayAreaMapBandLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls, l_int32 ystart, l_int32 yend );
 LEPT_DLL extern void scaleAreaMapLow2 ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 d, l_int32 wpls );
 LEPT_DLL extern l_int32 scaleBinaryLow ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 ws, l_int32 hs, l_int32 wpls );
 LEPT_DLL extern void scaleToGray2Low ( l_uint32 *datad, l_int32 wd, l_int32 hd, l_int32 wpld, l_uint32 *datas, l_int32 wpls, l_uint32 *sumtab, l_uint8 *valtab );
@@ -2253,6 +2307,9 @@ LEPT_DLL extern l_int32 pixSeedfillGraySimple ( PIX *pixs, PIX *pixm, l_int32 co
 LEPT_DLL extern l_int32 pixSeedfillGrayInvSimple ( PIX *pixs, PIX *pixm, l_int32 connectivity );
 LEPT_DLL extern PIX * pixSeedfillGrayBasin ( PIX *pixb, PIX *pixm, l_int32 delta, l_int32 connectivity );
 LEPT_DLL extern PIX * pixDistanceFunction ( PIX *pixs, l_int32 connectivity, l_int32 outdepth, l_int32 boundcond );
+LEPT_DLL extern PIX * pixEuclideanDistance ( PIX *pixs, l_int32 outdepth, l_int32 squared, l_int32 boundcond );
+LEPT_DLL extern FPIX * pixEuclideanDistanceFPix ( PIX *pixs, l_int32 boundcond );
+LEPT_DLL extern PIX * pixEuclideanDistanceSquared ( PIX *pixs, l_int32 boundcond );
 LEPT_DLL extern PIX * pixSeedspread ( PIX *pixs, l_int32 connectivity );
 LEPT_DLL extern l_int32 pixLocalExtrema ( PIX *pixs, l_int32 maxmin, l_int32 minmax, PIX **ppixmin, PIX **ppixmax );
 LEPT_DLL extern l_int32 pixSelectedLocalExtrema ( PIX *pixs, l_int32 mindist, PIX **ppixmin, PIX **ppixmax );
@@ -2260,8 +2317,11 @@ LEPT_DLL extern PIX * pixFindEqualValues ( PIX *pixs1, PIX *pixs2 );
 LEPT_DLL extern l_int32 pixSelectMinInConnComp ( PIX *pixs, PIX *pixm, PTA **ppta, NUMA **pnav );
 LEPT_DLL extern PIX * pixRemoveSeededComponents ( PIX *pixd, PIX *pixs, PIX *pixm, l_int32 connectivity, l_int32 bordersize );
 LEPT_DLL extern void seedfillBinaryLow ( l_uint32 *datas, l_int32 hs, l_int32 wpls, l_uint32 *datam, l_int32 hm, l_int32 wplm, l_int32 connectivity );
+LEPT_DLL extern void seedfillBinaryQueueLow ( l_uint32 *datas, l_int32 hs, l_int32 wpls, l_uint32 *datam, l_int32 hm, l_int32 wplm, l_int32 connectivity );
 LEPT_DLL extern void seedfillGrayLow ( l_uint32 *datas, l_int32 w, l_int32 h, l_int32 wpls, l_uint32 *datam, l_int32 wplm, l_int32 connectivity );
 LEPT_DLL extern void seedfillGrayInvLow ( l_uint32 *datas, l_int32 w, l_int32 h, l_int32 wpls, l_uint32 *datam, l_int32 wplm, l_int32 connectivity );
+LEPT_DLL extern void seedfillGrayBoundaryLow ( l_uint32 *datas, l_int32 w, l_int32 h, l_int32 wpls, l_uint32 *datam, l_int32 wplm, l_int32 connectivity, l_int32 *ystart, l_int32 nstrips );
+LEPT_DLL extern void seedfillGrayInvBoundaryLow ( l_uint32 *datas, l_int32 w, l_int32 h, l_int32 wpls, l_uint32 *datam, l_int32 wplm, l_int32 connectivity, l_int32 *ystart, l_int32 nstrips );
 LEPT_DLL extern void seedfillGrayLowSimple ( l_uint32 *datas, l_int32 w, l_int32 h, l_int32 wpls, l_uint32 *datam, l_int32 wplm, l_int32 connectivity );
 LEPT_DLL extern void seedfillGrayInvLowSimple ( l_uint32 *datas, l_int32 w, l_int32 h, l_int32 wpls, l_uint32 *datam, l_int32 wplm, l_int32 connectivity );
 LEPT_DLL extern void distanceFunctionLow ( l_uint32 *datad, l_int32 w, l_int32 h, l_int32 d, l_int32 wpld, l_int32 connectivity );
@@ -2314,6 +2374,11 @@ LEPT_DLL extern SELA * selaAddDwaLinear ( SELA *sela );
 LEPT_DLL extern SELA * selaAddDwaCombs ( SELA *sela );
 LEPT_DLL extern SELA * selaAddCrossJunctions ( SELA *sela, l_float32 hlsize, l_float32 mdist, l_int32 norient, l_int32 debugflag );
 LEPT_DLL extern SELA * selaAddTJunctions ( SELA *sela, l_float32 hlsize, l_float32 mdist, l_int32 norient, l_int32 debugflag );
+LEPT_DLL extern L_DWASEL * l_dwaselCreate ( SEL *sel );
+LEPT_DLL extern void l_dwaselDestroy ( L_DWASEL **pdsel );
+LEPT_DLL extern PIX * pixDilateDwasel ( PIX *pixd, PIX *pixs, L_DWASEL *dsel );
+LEPT_DLL extern PIX * pixErodeDwasel ( PIX *pixd, PIX *pixs, L_DWASEL *dsel );
+LEPT_DLL extern PIX * pixHMTDwasel ( PIX *pixd, PIX *pixs, L_DWASEL *dsel );
 LEPT_DLL extern SEL * pixGenerateSelWithRuns ( PIX *pixs, l_int32 nhlines, l_int32 nvlines, l_int32 distance, l_int32 minlength, l_int32 toppix, l_int32 botpix, l_int32 leftpix, l_int32 rightpix, PIX **ppixe );
 LEPT_DLL extern SEL * pixGenerateSelRandom ( PIX *pixs, l_float32 hitfract, l_float32 missfract, l_int32 distance, l_int32 toppix, l_int32 botpix, l_int32 leftpix, l_int32 rightpix, PIX **ppixe );
 LEPT_DLL extern SEL * pixGenerateSelBoundary ( PIX *pixs, l_int32 hitdist, l_int32 missdist, l_int32 hitskip, l_int32 missskip, l_int32 topflag, l_int32 botflag, l_int32 leftflag, l_int32 rightflag, PIX **ppixe );
@@ -2342,8 +2407,10 @@ LEPT_DLL extern l_int32 pixFindSkewSweepAndSearchScore ( PIX *pixs, l_float32 *p
 LEPT_DLL extern l_int32 pixFindSkewSweepAndSearchScorePivot ( PIX *pixs, l_float32 *pangle, l_float32 *pconf, l_float32 *pendscore, l_int32 redsweep, l_int32 redsearch, l_float32 sweepcenter, l_float32 sweeprange, l_float32 sweepdelta, l_float32 minbsdelta, l_int32 pivot );
 LEPT_DLL extern l_int32 pixFindSkewOrthogonalRange ( PIX *pixs, l_float32 *pangle, l_float32 *pconf, l_int32 redsweep, l_int32 redsearch, l_float32 sweeprange, l_float32 sweepdelta, l_float32 minbsdelta, l_float32 confprior );
 LEPT_DLL extern l_int32 pixFindDifferentialSquareSum ( PIX *pixs, l_float32 *psum );
+LEPT_DLL extern NUMA * pixFindDifferentialSquareSumSweep ( PIX *pixs, NUMA *natheta, l_int32 pivot );
 LEPT_DLL extern l_int32 pixFindNormalizedSquareSum ( PIX *pixs, l_float32 *phratio, l_float32 *pvratio, l_float32 *pfract );
 LEPT_DLL extern PIX * pixReadStreamSpix ( FILE *fp );
+LEPT_DLL extern PIX * pixReadMappedSpix ( const char *filename );
 LEPT_DLL extern l_int32 readHeaderSpix ( const char *filename, l_int32 *pwidth, l_int32 *pheight, l_int32 *pbps, l_int32 *pspp, l_int32 *piscmap );
 LEPT_DLL extern l_int32 freadHeaderSpix ( FILE *fp, l_int32 *pwidth, l_int32 *pheight, l_int32 *pbps, l_int32 *pspp, l_int32 *piscmap );
 LEPT_DLL extern l_int32 sreadHeaderSpix ( const l_uint32 *data, l_int32 *pwidth, l_int32 *pheight, l_int32 *pbps, l_int32 *pspp, l_int32 *piscmap );
@@ -2388,6 +2455,13 @@ LEPT_DLL extern l_int32 pixWriteStreamTiff ( FILE *fp, PIX *pix, l_int32 comptyp
 LEPT_DLL extern PIXA * pixaReadMultipageTiff ( const char *filename );
 LEPT_DLL extern l_int32 writeMultipageTiff ( const char *dirin, const char *substr, const char *fileout );
 LEPT_DLL extern l_int32 writeMultipageTiffSA ( SARRAY *sa, const char *fileout );
+LEPT_DLL extern L_TIFF_STREAM * tiffstreamOpenRead ( const char *filename, l_int32 n );
+LEPT_DLL extern L_TIFF_STREAM * tiffstreamOpenWrite ( const char *filename, l_int32 h, l_int32 comptype );
+LEPT_DLL extern void tiffstreamClose ( L_TIFF_STREAM **pts );
+LEPT_DLL extern l_int32 tiffstreamGetInfo ( L_TIFF_STREAM *ts, l_int32 *pw, l_int32 *ph, l_int32 *pd, l_int32 *pnextrow );
+LEPT_DLL extern PIX * tiffstreamReadRows ( L_TIFF_STREAM *ts, l_int32 nrows );
+LEPT_DLL extern l_int32 tiffstreamWriteRows ( L_TIFF_STREAM *ts, PIX *pix );
+LEPT_DLL extern l_int32 tiffstreamProcess ( const char *filein, l_int32 n, const char *fileout, l_int32 comptype, l_int32 nrows, L_TIFF_BAND_FUNC func, void *data );
 LEPT_DLL extern l_int32 fprintTiffInfo ( FILE *fpout, const char *tiffile );
 LEPT_DLL extern l_int32 tiffGetCount ( FILE *fp, l_int32 *pn );
 LEPT_DLL extern l_int32 getTiffResolution ( FILE *fp, l_int32 *pxres, l_int32 *pyres );
@@ -2428,6 +2502,8 @@ LEPT_DLL extern l_uint8 * l_binaryReadSelectStream ( FILE *fp, size_t start, siz
 LEPT_DLL extern l_int32 l_binaryWrite ( const char *filename, const char *operation, void *data, size_t nbytes );
 LEPT_DLL extern size_t nbytesInFile ( const char *filename );
 LEPT_DLL extern size_t fnbytesInFile ( FILE *fp );
+LEPT_DLL extern l_uint8 * l_binaryMap ( const char *filename, size_t *pnbytes );
+LEPT_DLL extern l_int32 l_binaryUnmap ( void *data, size_t nbytes );
 LEPT_DLL extern l_uint8 * l_binaryCopy ( l_uint8 *datas, size_t size );
 LEPT_DLL extern l_int32 fileCopy ( const char *srcfile, const char *newfile );
 LEPT_DLL extern l_int32 fileConcatenate ( const char *srcfile, const char *destfile );
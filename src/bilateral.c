@@ -35,6 +35,8 @@
  *          static L_BILATERAL  *bilateralCreate()
  *          static void         *bilateralDestroy()
  *          static PIX          *bilateralApply()
+ *          static l_int32       bilateralBandJob()
+ *          static void          bilateralTapsLow()
  *
  *     Slow, exact implementation of grayscale or color bilateral filtering
  *          PIX                 *pixBilateralExact()
@@ -71,15 +73,34 @@
  *  filter can be 256 x 256).
  */
 
+#include <string.h>
 #include <math.h>
 #include "allheaders.h"
 #include "bilateral.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
+
+    /* Min number of reduced lines in each band of PBC */
+static const l_int32  MIN_BAND_LINES = 64;
 
 static L_BILATERAL *bilateralCreate(PIX *pixs, l_float32 spatial_stdev,
                                     l_float32 range_stdev, l_int32 ncomps,
                                     l_int32 reduction);
 static PIX *bilateralApply(L_BILATERAL *bil);
 static void bilateralDestroy(L_BILATERAL **pbil);
+static l_int32 bilateralBandJob(void *data, l_int32 index);
+static void bilateralTapsLow(l_uint8 *dest, l_int32 n, l_float32 **rptr,
+                             l_float32 **vptr, l_float32 *skern,
+                             l_int32 ntaps, l_int32 level);
+#if USE_SIMD
+static l_int32 bilateralTapsSSE2(l_uint8 *dest, l_int32 n, l_float32 **rptr,
+                                 l_float32 **vptr, l_float32 *skern,
+                                 l_int32 ntaps);
+static l_int32 bilateralTapsAVX2(l_uint8 *dest, l_int32 n, l_float32 **rptr,
+                                 l_float32 **vptr, l_float32 *skern,
+                                 l_int32 ntaps);
+#endif  /* USE_SIMD */
 
 
 #ifndef  NO_CONSOLE_IO
@@ -141,6 +162,11 @@ static void bilateralDestroy(L_BILATERAL **pbil);
  *          range_stdev = 60, ncomps = 6, and spatial_dev = {10, 30, 50}.
  *          As spatial_dev gets larger, we get the counter-intuitive
  *          result that the body of the red fish becomes less blurry.
+ *      (8) The intermediate images are made and used in bands, so the
+ *          memory does not grow with ncomps times the image size.
+ *          The bands are processed on the default number of threads
+ *          (see l_setNumThreads()), and the convolutions use SIMD
+ *          when available.  The result does not depend on either.
  */
 PIX *
 pixBilateral(PIX       *pixs,
@@ -261,9 +287,9 @@ L_BILATERAL  *bil;
  *      Return: bil, or null on error
  *
  *  Notes:
- *      (1) This initializes a bilateral filtering operation, generating all
- *          the data required.  It takes most of the time in the bilateral
- *          filtering operation.
+ *      (1) This initializes a bilateral filtering operation, generating
+ *          the tables and the bordered source for the PBC.  The PBC
+ *          themselves are made in bands by bilateralApply().
  *      (2) See bilateral.h for details of the algorithm.
  *      (3) See pixBilateral() for constraints on input parameters, which
  *          are not checked here.
@@ -275,16 +301,13 @@ bilateralCreate(PIX       *pixs,
                 l_int32    ncomps,
                 l_int32    reduction)
 {
-l_int32       w, ws, wd, h, hs, hd, i, j, k, index;
+l_int32       w, h, i, k;
 l_int32       border, minval, maxval, spatial_size;
-l_int32       halfwidth, wpls, wplt, wpld, kval, nval, dval;
-l_float32     sstdev, fval1, fval2, denom, sum, norm, kern;
+l_float32     sstdev, fval1, fval2, denom;
 l_int32      *nc, *kindex;
 l_float32    *kfract, *range, *spatial;
-l_uint32     *datas, *datat, *datad, *lines, *linet, *lined;
 L_BILATERAL  *bil;
-PIX          *pixt, *pixt2, *pixsc, *pixd;
-PIXA         *pixac;
+PIX          *pixt, *pixt2, *pixsc;
 
     PROCNAME("bilateralCreate");
 
@@ -382,63 +405,15 @@ PIXA         *pixac;
 
 
     /* -------------------------------------------------------------------- *
-     *            Generate principal bilateral component images             *
+     *       Sizes of the principal bilateral component images, and of      *
+     *       the bands in which they are made                               *
      * -------------------------------------------------------------------- */
-    pixac = pixaCreate(ncomps);
-    pixGetDimensions(pixsc, &ws, &hs, NULL);
-    datas = pixGetData(pixsc);
-    wpls = pixGetWpl(pixsc);
     pixGetDimensions(pixs, &w, &h, NULL);
-    wd = (w + reduction - 1) / reduction;
-    hd = (h + reduction - 1) / reduction;
-    halfwidth = (l_int32)(2.0 * sstdev);
-    for (index = 0; index < ncomps; index++) {
-        pixt = pixCopy(NULL, pixsc);
-        datat = pixGetData(pixt);
-        wplt = pixGetWpl(pixt);
-        kval = nc[index];
-            /* Separable convolutions: horizontal first */
-        for (i = 0; i < hd; i++) {
-            lines = datas + (border + i) * wpls;
-            linet = datat + (border + i) * wplt;
-            for (j = 0; j < wd; j++) {
-                sum = 0.0;
-                norm = 0.0;
-                for (k = -halfwidth; k <= halfwidth; k++) {
-                    nval = GET_DATA_BYTE(lines, border + j + k);
-                    kern = spatial[L_ABS(k)] * range[L_ABS(kval - nval)];
-                    sum += kern * nval;
-                    norm += kern;
-                }
-                dval = (l_int32)((sum / norm) + 0.5);
-                SET_DATA_BYTE(linet, border + j, dval);
-            }
-        }
-            /* Vertical convolution */
-        pixd = pixCreate(wd, hd, 8);
-        datad = pixGetData(pixd);
-        wpld = pixGetWpl(pixd);
-        for (i = 0; i < hd; i++) {
-            linet = datat + (border + i) * wplt;
-            lined = datad + i * wpld;
-            for (j = 0; j < wd; j++) {
-                sum = 0.0;
-                norm = 0.0;
-                for (k = -halfwidth; k <= halfwidth; k++) {
-                    nval = GET_DATA_BYTE(linet + k * wplt, border + j);
-                    kern = spatial[L_ABS(k)] * range[L_ABS(kval - nval)];
-                    sum += kern * nval;
-                    norm += kern;
-                }
-                dval = (l_int32)((sum / norm) + 0.5);
-                SET_DATA_BYTE(lined, j, dval);
-            }
-        }
-        pixDestroy(&pixt);
-        pixaAddPix(pixac, pixd, L_INSERT);
-    }
-    bil->pixac = pixac;
-    bil->lineset = (l_uint32 ***)pixaGetLinePtrs(pixac, NULL);
+    bil->border = border;
+    bil->halfwidth = (l_int32)(2.0 * sstdev);
+    bil->wd = (w + reduction - 1) / reduction;
+    bil->hd = (h + reduction - 1) / reduction;
+    bil->bandh = L_MAX(MIN_BAND_LINES, 4 * bil->halfwidth);
 
     return bil;
 }
@@ -449,59 +424,330 @@ PIXA         *pixac;
  *
  *      Input:  bil
  *      Return: pixd
+ *
+ *  Notes:
+ *      (1) The PBC are made and applied in bands of bil->bandh
+ *          reduced lines, using the default number of threads.
+ *          See bilateralBandJob().
  */
 static PIX *
 bilateralApply(L_BILATERAL  *bil)
 {
-l_int32      i, j, k, ired, jred, w, h, wpls, wpld, ncomps, reduction;
-l_int32      vals, vald, lowval, hival;
-l_int32     *kindex;
-l_float32    fract;
-l_float32   *kfract;
-l_uint32    *lines, *lined, *datas, *datad;
-l_uint32  ***lineset = NULL;  /* for set of PBC */
-PIX         *pixs, *pixd;
-PIXA        *pixac;
+l_int32  nbands;
+PIX     *pixd;
 
     PROCNAME("bilateralApply");
 
     if (!bil)
         return (PIX *)ERROR_PTR("bil not defined", procName, NULL);
-    pixs = bil->pixs;
-    ncomps = bil->ncomps;
-    kindex = bil->kindex;
-    kfract = bil->kfract;
-    reduction = bil->reduction;
-    pixac = bil->pixac;
-    lineset = bil->lineset;
-    if (pixaGetCount(pixac) != ncomps)
-        return (PIX *)ERROR_PTR("PBC images do not exist", procName, NULL);
 
-    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+    if ((bil->pixd = pixCreateTemplate(bil->pixs)) == NULL)
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    datad = pixGetData(pixd);
-    wpld = pixGetWpl(pixd);
-    pixGetDimensions(pixs, &w, &h, NULL);
-    for (i = 0; i < h; i++) {
+    nbands = (bil->hd + bil->bandh - 1) / bil->bandh;
+    if (l_parallelRun(nbands, bilateralBandJob, bil, 0)) {
+        pixDestroy(&bil->pixd);
+        return (PIX *)ERROR_PTR("PBC not made", procName, NULL);
+    }
+    pixd = bil->pixd;
+    bil->pixd = NULL;
+    return pixd;
+}
+
+
+/*!
+ *  bilateralBandJob()
+ *
+ *      Input:  data (L_BILATERAL)
+ *              index (of the band of reduced lines)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) For reduced lines [y1, y2) of the band, this makes all the
+ *          PBC J(k,x) and uses them to find the output pixels in the
+ *          corresponding full resolution lines.
+ *      (2) The horizontal convolution is done on the lines of the band,
+ *          and on @halfwidth lines above and below, which are needed
+ *          for the vertical convolution.  As for the full image, the
+ *          lines outside [0, hd) are taken from the mirrored border of
+ *          pixsc without horizontal convolution.
+ *      (3) The range and value of each input pixel for the convolution
+ *          are found once, and put in float arrays, so that the
+ *          convolution with each tap is a simple multiply-add on
+ *          consecutive pixels.
+ */
+static l_int32
+bilateralBandJob(void    *data,
+                 l_int32  index)
+{
+l_int32       i, j, k, t, w, h, y, y1, y2, nb, nrows, ntaps, wd, hd, hw;
+l_int32       ws, wpls, wpld, border, reduction, kval, val, lowval, hival;
+l_int32       ired, jred, vald, level;
+l_int32      *kindex;
+l_uint8      *pbc, *tmp, *low, *high;
+l_uint32     *datas, *datad, *lines, *lined;
+l_float32     fract;
+l_float32    *range, *kfract, *skern, *rin, *vin, *rt, *vt;
+l_float32   **rptr, **vptr;
+L_BILATERAL  *bil;
+
+    PROCNAME("bilateralBandJob");
+
+    bil = (L_BILATERAL *)data;
+    wd = bil->wd;
+    hd = bil->hd;
+    hw = bil->halfwidth;
+    border = bil->border;
+    reduction = bil->reduction;
+    y1 = index * bil->bandh;
+    y2 = L_MIN(hd, y1 + bil->bandh);
+    nb = y2 - y1;
+    nrows = nb + 2 * hw;
+    ntaps = 2 * hw + 1;
+    ws = pixGetWidth(bil->pixsc);
+    range = bil->range;
+    level = l_getSimdLevel();
+
+    pbc = (l_uint8 *)CALLOC((size_t)bil->ncomps * nb * wd, sizeof(l_uint8));
+    tmp = (l_uint8 *)CALLOC(wd, sizeof(l_uint8));
+    rin = (l_float32 *)CALLOC(ws, sizeof(l_float32));
+    vin = (l_float32 *)CALLOC(ws, sizeof(l_float32));
+    rt = (l_float32 *)CALLOC((size_t)nrows * wd, sizeof(l_float32));
+    vt = (l_float32 *)CALLOC((size_t)nrows * wd, sizeof(l_float32));
+    skern = (l_float32 *)CALLOC(ntaps, sizeof(l_float32));
+    rptr = (l_float32 **)CALLOC(ntaps, sizeof(l_float32 *));
+    vptr = (l_float32 **)CALLOC(ntaps, sizeof(l_float32 *));
+    if (!pbc || !tmp || !rin || !vin || !rt || !vt || !skern ||
+        !rptr || !vptr) {
+        if (pbc) FREE(pbc);
+        if (tmp) FREE(tmp);
+        if (rin) FREE(rin);
+        if (vin) FREE(vin);
+        if (rt) FREE(rt);
+        if (vt) FREE(vt);
+        if (skern) FREE(skern);
+        if (rptr) FREE(rptr);
+        if (vptr) FREE(vptr);
+        return ERROR_INT("band arrays not made", procName, 1);
+    }
+    for (t = 0; t < ntaps; t++)
+        skern[t] = bil->spatial[L_ABS(t - hw)];
+
+        /* Make the PBC for the lines of the band */
+    datas = pixGetData(bil->pixsc);
+    wpls = pixGetWpl(bil->pixsc);
+    for (k = 0; k < bil->ncomps; k++) {
+        kval = bil->nc[k];
+            /* Horizontal convolution */
+        for (i = 0; i < nrows; i++) {
+            y = y1 - hw + i;
+            lines = datas + (border + y) * wpls;
+            if (y >= 0 && y < hd) {
+                for (j = border - hw; j < border + wd + hw; j++) {
+                    val = GET_DATA_BYTE(lines, j);
+                    rin[j] = range[L_ABS(kval - val)];
+                    vin[j] = (l_float32)val;
+                }
+                for (t = 0; t < ntaps; t++) {
+                    rptr[t] = rin + border + t - hw;
+                    vptr[t] = vin + border + t - hw;
+                }
+                bilateralTapsLow(tmp, wd, rptr, vptr, skern, ntaps, level);
+            } else {
+                for (j = 0; j < wd; j++)
+                    tmp[j] = GET_DATA_BYTE(lines, border + j);
+            }
+            for (j = 0; j < wd; j++) {
+                rt[i * wd + j] = range[L_ABS(kval - tmp[j])];
+                vt[i * wd + j] = (l_float32)tmp[j];
+            }
+        }
+            /* Vertical convolution */
+        for (i = 0; i < nb; i++) {
+            for (t = 0; t < ntaps; t++) {
+                rptr[t] = rt + (i + t) * wd;
+                vptr[t] = vt + (i + t) * wd;
+            }
+            bilateralTapsLow(pbc + ((size_t)k * nb + i) * wd, wd, rptr, vptr,
+                             skern, ntaps, level);
+        }
+    }
+
+        /* Interpolate between the PBC for the full resolution lines */
+    pixGetDimensions(bil->pixs, &w, &h, NULL);
+    datas = pixGetData(bil->pixs);
+    wpls = pixGetWpl(bil->pixs);
+    datad = pixGetData(bil->pixd);
+    wpld = pixGetWpl(bil->pixd);
+    kindex = bil->kindex;
+    kfract = bil->kfract;
+    for (i = y1 * reduction; i < L_MIN(h, y2 * reduction); i++) {
         lines = datas + i * wpls;
         lined = datad + i * wpld;
-        ired = i / reduction;
+        ired = i / reduction - y1;
         for (j = 0; j < w; j++) {
             jred = j / reduction;
-            vals = GET_DATA_BYTE(lines, j);
-            k = kindex[vals];
-            lowval = GET_DATA_BYTE(lineset[k][ired], jred);
-            hival = GET_DATA_BYTE(lineset[k + 1][ired], jred);
-            fract = kfract[vals];
+            val = GET_DATA_BYTE(lines, j);
+            k = kindex[val];
+            low = pbc + ((size_t)k * nb + ired) * wd;
+            high = low + (size_t)nb * wd;
+            lowval = low[jred];
+            hival = high[jred];
+            fract = kfract[val];
             vald = (l_int32)((1.0 - fract) * lowval + fract * hival + 0.5);
             SET_DATA_BYTE(lined, j, vald);
         }
     }
 
-    return pixd;
+    FREE(pbc);
+    FREE(tmp);
+    FREE(rin);
+    FREE(vin);
+    FREE(rt);
+    FREE(vt);
+    FREE(skern);
+    FREE(rptr);
+    FREE(vptr);
+    return 0;
+}
+
+
+/*!
+ *  bilateralTapsLow()
+ *
+ *      Input:  dest (n output bytes)
+ *              n (number of output pixels)
+ *              rptr (for each tap, the range weights of the n pixels)
+ *              vptr (for each tap, the values of the n pixels)
+ *              skern (for each tap, the spatial weight)
+ *              ntaps (number of taps)
+ *              level (simd level)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) For each pixel j, with kern = skern[t] * rptr[t][j], this
+ *          finds the rounded value of
+ *              sum[t]: kern * vptr[t][j]  /  sum[t]: kern
+ *      (2) The SIMD versions do the same float operations in the same
+ *          order for each pixel, so the results are identical.
+ */
+static void
+bilateralTapsLow(l_uint8     *dest,
+                 l_int32      n,
+                 l_float32  **rptr,
+                 l_float32  **vptr,
+                 l_float32   *skern,
+                 l_int32      ntaps,
+                 l_int32      level)
+{
+l_int32    j, t;
+l_float32  sum, norm, kern;
+
+    j = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2)
+        j = bilateralTapsAVX2(dest, n, rptr, vptr, skern, ntaps);
+    else if (level == L_SIMD_SSE2)
+        j = bilateralTapsSSE2(dest, n, rptr, vptr, skern, ntaps);
+#endif  /* USE_SIMD */
+
+    for (; j < n; j++) {
+        sum = 0.0;
+        norm = 0.0;
+        for (t = 0; t < ntaps; t++) {
+            kern = skern[t] * rptr[t][j];
+            sum += kern * vptr[t][j];
+            norm += kern;
+        }
+        dest[j] = (l_int32)((sum / norm) + 0.5);
+    }
+    return;
+}
+
+
+#if USE_SIMD
+/*!
+ *  bilateralTapsSSE2()
+ *
+ *    Input:  dest, n, rptr, vptr, skern, ntaps (as in bilateralTapsLow())
+ *    Return: number of pixels done (a multiple of 4)
+ *
+ *  Notes:
+ *      (1) Adding 0.5 in float rather than double does not change the
+ *          truncated result, because the values are non-negative and
+ *          the sum can only round up to an integer.
+ */
+static l_int32  L_TARGET_SSE2
+bilateralTapsSSE2(l_uint8     *dest,
+                  l_int32      n,
+                  l_float32  **rptr,
+                  l_float32  **vptr,
+                  l_float32   *skern,
+                  l_int32      ntaps)
+{
+l_int32   j, t, word;
+__m128    sum, norm, kern, half;
+__m128i   ival;
+
+    half = _mm_set1_ps(0.5);
+    for (j = 0; j + 4 <= n; j += 4) {
+        sum = _mm_setzero_ps();
+        norm = _mm_setzero_ps();
+        for (t = 0; t < ntaps; t++) {
+            kern = _mm_mul_ps(_mm_set1_ps(skern[t]),
+                              _mm_loadu_ps(rptr[t] + j));
+            sum = _mm_add_ps(sum, _mm_mul_ps(kern, _mm_loadu_ps(vptr[t] + j)));
+            norm = _mm_add_ps(norm, kern);
+        }
+        ival = _mm_cvttps_epi32(_mm_add_ps(_mm_div_ps(sum, norm), half));
+        ival = _mm_packs_epi32(ival, ival);
+        ival = _mm_packus_epi16(ival, ival);
+        word = _mm_cvtsi128_si32(ival);
+        memcpy(dest + j, &word, 4);
+    }
+    return j;
+}
+
+
+/*!
+ *  bilateralTapsAVX2()
+ *
+ *    Input:  dest, n, rptr, vptr, skern, ntaps (as in bilateralTapsLow())
+ *    Return: number of pixels done (a multiple of 8)
+ */
+static l_int32  L_TARGET_AVX2
+bilateralTapsAVX2(l_uint8     *dest,
+                  l_int32      n,
+                  l_float32  **rptr,
+                  l_float32  **vptr,
+                  l_float32   *skern,
+                  l_int32      ntaps)
+{
+l_int32   j, t;
+__m256    sum, norm, kern, half;
+__m256i   ival;
+__m128i   packed;
+
+    half = _mm256_set1_ps(0.5);
+    for (j = 0; j + 8 <= n; j += 8) {
+        sum = _mm256_setzero_ps();
+        norm = _mm256_setzero_ps();
+        for (t = 0; t < ntaps; t++) {
+            kern = _mm256_mul_ps(_mm256_set1_ps(skern[t]),
+                                 _mm256_loadu_ps(rptr[t] + j));
+            sum = _mm256_add_ps(sum,
+                      _mm256_mul_ps(kern, _mm256_loadu_ps(vptr[t] + j)));
+            norm = _mm256_add_ps(norm, kern);
+        }
+        ival = _mm256_cvttps_epi32(_mm256_add_ps(_mm256_div_ps(sum, norm),
+                                                 half));
+        packed = _mm_packs_epi32(_mm256_castsi256_si128(ival),
+                                 _mm256_extracti128_si256(ival, 1));
+        packed = _mm_packus_epi16(packed, packed);
+        _mm_storel_epi64((__m128i *)(dest + j), packed);
+    }
+    return j;
 }
+#endif  /* USE_SIMD */
 
 
 /*!
@@ -513,7 +759,6 @@ PIXA        *pixac;
 static void
 bilateralDestroy(L_BILATERAL  **pbil)
 {
-l_int32       i;
 L_BILATERAL  *bil;
 
     PROCNAME("bilateralDestroy");
@@ -528,15 +773,12 @@ L_BILATERAL  *bil;
 
     pixDestroy(&bil->pixs);
     pixDestroy(&bil->pixsc);
-    pixaDestroy(&bil->pixac);
+    pixDestroy(&bil->pixd);
     FREE(bil->spatial);
     FREE(bil->range);
     FREE(bil->nc);
     FREE(bil->kindex);
     FREE(bil->kfract);
-    for (i = 0; i < bil->ncomps; i++)
-        FREE(bil->lineset[i]);
-    FREE(bil->lineset);
     FREE(bil);
     *pbil = NULL;
     return;
@@ -97,6 +97,14 @@
  *  a mirrored border to avoid boundary cases.  This is then used
  *  to compute 'ncomps' PBCs.
  *
+ *  The PBCs are not stored as full images.  Instead, the image is
+ *  divided into bands of 'bandh' reduced lines, and for each band all
+ *  'ncomps' PBCs are computed for just the lines of that band, used
+ *  for the output pixels, and discarded.  The memory is then bounded
+ *  by the band size, independent of the image height, and the bands
+ *  are computed in parallel.  Each band needs 'halfwidth' lines above
+ *  and below for the vertical part of the separable convolution.
+ *
  *  The 'spatial_stdev' is also downscaled by 'reduction'.  The size
  *  of the 'spatial' array is 4 * (reduced 'spatial_stdev') + 1.
  *  The size of the 'range' array is 256.
@@ -121,8 +129,12 @@ struct L_Bilateral
     l_int32         *nc;             /* set of k values (size ncomps)        */
     l_int32         *kindex;         /* mapping from intensity to lower k    */
     l_float32       *kfract;         /* mapping from intensity to fract k    */
-    struct Pixa     *pixac;          /* intermediate result images (PBC)     */
-    l_uint32      ***lineset;        /* lineptrs for pixac                   */
+    l_int32          border;         /* width of mirrored border on pixsc    */
+    l_int32          halfwidth;      /* half width of spatial kernel         */
+    l_int32          wd;             /* width of the (reduced) PBC           */
+    l_int32          hd;             /* height of the (reduced) PBC          */
+    l_int32          bandh;          /* number of PBC lines in each band     */
+    struct Pix      *pixd;           /* filtered result                      */
 };
 typedef struct L_Bilateral  L_BILATERAL;
 
@@ -38,6 +38,8 @@
  *
  *      Adaptive Otsu-based thresholding
  *          l_int32    pixOtsuAdaptiveThreshold()       8 bpp
+ *          static l_int32  otsuThreshTile()
+ *          static l_int32  otsuApplyTile()
  *
  *      Otsu thresholding on adaptive background normalization
  *          PIX       *pixOtsuThreshOnBackgroundNorm()  8 bpp
@@ -47,6 +49,7 @@
  *
  *      Sauvola local thresholding
  *          l_int32    pixSauvolaBinarizeTiled()
+ *          static l_int32  sauvolaBinarizeTile()
  *          l_int32    pixSauvolaBinarize()
  *          PIX       *pixSauvolaGetThreshold()
  *          PIX       *pixApplyLocalThreshold();
@@ -76,6 +79,24 @@
 #include <math.h>
 #include "allheaders.h"
 
+    /* Parameters and outputs shared by the tile operations */
+struct BinarizeTiling
+{
+    PIX        *pixth;       /* threshold output                        */
+    PIX        *pixd;        /* binarized output                        */
+    l_int32     whsize;      /* Sauvola window half-width               */
+    l_float32   factor;      /* Sauvola factor                          */
+    l_float32   scorefract;  /* Otsu score fraction                     */
+};
+typedef struct BinarizeTiling  BINARIZE_TILING;
+
+static l_int32 otsuThreshTile(PIXTILING *pt, PIX *pixt, l_int32 i,
+                              l_int32 j, void *data);
+static l_int32 otsuApplyTile(PIXTILING *pt, PIX *pixt, l_int32 i,
+                             l_int32 j, void *data);
+static l_int32 sauvolaBinarizeTile(PIXTILING *pt, PIX *pixt, l_int32 i,
+                                   l_int32 j, void *data);
+
 /*------------------------------------------------------------------*
  *                 Adaptive Otsu-based thresholding                 *
  *------------------------------------------------------------------*/
@@ -131,6 +152,8 @@
  *      (8) N.B. This method is NOT recommended for images with weak text
  *          and significant background noise, such as bleedthrough, because
  *          of the problem noted in (3) above for tiling.  Use Sauvola.
+ *      (9) The tiles are processed in parallel, using the default number
+ *          of threads set by l_setNumThreads().
  */
 l_int32
 pixOtsuAdaptiveThreshold(PIX       *pixs,
@@ -142,10 +165,10 @@ pixOtsuAdaptiveThreshold(PIX       *pixs,
                          PIX      **ppixth,
                          PIX      **ppixd)
 {
-l_int32     w, h, nx, ny, i, j, thresh;
-l_uint32    val;
-PIX        *pixt, *pixb, *pixthresh, *pixth, *pixd;
-PIXTILING  *pt;
+l_int32          w, h, nx, ny;
+PIX             *pixthresh, *pixth, *pixd;
+PIXTILING       *pt;
+BINARIZE_TILING  bt;
 
     PROCNAME("pixOtsuAdaptiveThreshold");
 
@@ -166,14 +189,17 @@ PIXTILING  *pt;
     smoothy = L_MIN(smoothy, (ny - 1) / 2);
     pt = pixTilingCreate(pixs, nx, ny, 0, 0, 0, 0);
     pixthresh = pixCreate(nx, ny, 8);
-    for (i = 0; i < ny; i++) {
-        for (j = 0; j < nx; j++) {
-            pixt = pixTilingGetTile(pt, i, j);
-            pixSplitDistributionFgBg(pixt, scorefract, 1, &thresh,
-                                     NULL, NULL, 0);
-            pixSetPixel(pixthresh, j, i, thresh);  /* see note (4) */
-            pixDestroy(&pixt);
-        }
+    if (!pt || !pixthresh) {
+        pixTilingDestroy(&pt);
+        pixDestroy(&pixthresh);
+        return ERROR_INT("pt and pixthresh not both made", procName, 1);
+    }
+    bt.pixth = pixthresh;
+    bt.scorefract = scorefract;
+    if (pixTilingExecute(pt, otsuThreshTile, &bt, 0)) {
+        pixTilingDestroy(&pt);
+        pixDestroy(&pixthresh);
+        return ERROR_INT("tile thresholds not all found", procName, 1);
     }
 
         /* Optionally smooth the threshold array */
@@ -187,15 +213,13 @@ PIXTILING  *pt;
     if (ppixd) {
         pixd = pixCreate(w, h, 1);
         pixCopyResolution(pixd, pixs);
-        for (i = 0; i < ny; i++) {
-            for (j = 0; j < nx; j++) {
-                pixt = pixTilingGetTile(pt, i, j);
-                pixGetPixel(pixth, j, i, &val);
-                pixb = pixThresholdToBinary(pixt, val);
-                pixTilingPaintTile(pixd, i, j, pixb, pt);
-                pixDestroy(&pixt);
-                pixDestroy(&pixb);
-            }
+        bt.pixth = pixth;
+        bt.pixd = pixd;
+        if (pixTilingExecute(pt, otsuApplyTile, &bt, 0)) {
+            pixTilingDestroy(&pt);
+            pixDestroy(&pixth);
+            pixDestroy(&pixd);
+            return ERROR_INT("tiles not all binarized", procName, 1);
         }
         *ppixd = pixd;
     }
@@ -210,6 +234,64 @@ PIXTILING  *pt;
 }
 
 
+/*!
+ *  otsuThreshTile()
+ *
+ *      Input:  pt, pixt (tile), i, j (tile row and column), data
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Sets the Otsu threshold for tile (i, j) at pixel (j, i)
+ *          of the 8 bpp threshold array.  Each tile writes a different
+ *          byte, so no locking is required.
+ */
+static l_int32
+otsuThreshTile(PIXTILING  *pt,
+               PIX        *pixt,
+               l_int32     i,
+               l_int32     j,
+               void       *data)
+{
+l_int32           thresh;
+BINARIZE_TILING  *bt;
+
+    bt = (BINARIZE_TILING *)data;
+    if (pixSplitDistributionFgBg(pixt, bt->scorefract, 1, &thresh,
+                                 NULL, NULL, 0))
+        return 1;
+    pixSetPixel(bt->pixth, j, i, thresh);  /* see note (4) */
+    return 0;
+}
+
+
+/*!
+ *  otsuApplyTile()
+ *
+ *      Input:  pt, pixt (tile), i, j (tile row and column), data
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+otsuApplyTile(PIXTILING  *pt,
+              PIX        *pixt,
+              l_int32     i,
+              l_int32     j,
+              void       *data)
+{
+l_int32           ret;
+l_uint32          val;
+PIX              *pixb;
+BINARIZE_TILING  *bt;
+
+    bt = (BINARIZE_TILING *)data;
+    pixGetPixel(bt->pixth, j, i, &val);
+    if ((pixb = pixThresholdToBinary(pixt, val)) == NULL)
+        return 1;
+    ret = pixTilingPaintTile(bt->pixd, i, j, pixb, pt);
+    pixDestroy(&pixb);
+    return ret;
+}
+
+
 /*------------------------------------------------------------------*
  *      Otsu thresholding on adaptive background normalization      *
  *------------------------------------------------------------------*/
@@ -449,7 +531,9 @@ PIX      *pixn, *pixm, *pixd, *pixt1, *pixt2, *pixt3, *pixt4;
  *              The mean square accumulator array for 16M pixels is 128 MB.
  *              Using tiles reduces the size of these arrays.
  *          (c) Each tile can be processed independently, in parallel,
- *              on a multicore processor.
+ *              on a multicore processor.  The tiles are distributed
+ *              over the default number of threads, which is set by
+ *              l_setNumThreads().
  *      (4) The Sauvola threshold is determined from the formula:
  *              t = m * (1 - k * (1 - s / 128))
  *          See pixSauvolaBinarize() for details.
@@ -463,10 +547,9 @@ pixSauvolaBinarizeTiled(PIX       *pixs,
                         PIX      **ppixth,
                         PIX      **ppixd)
 {
-l_int32     i, j, w, h, xrat, yrat;
-PIX        *pixth, *pixd, *tileth, *tiled, *pixt;
-PIX       **ptileth, **ptiled;
-PIXTILING  *pt;
+l_int32          w, h, xrat, yrat, ret;
+PIXTILING       *pt;
+BINARIZE_TILING  bt;
 
     PROCNAME("pixSauvolaBinarizeTiled");
 
@@ -508,41 +591,62 @@ PIXTILING  *pt;
                                   ppixth, ppixd);
 
         /* We can use pixtiling for painting both outputs, if requested */
+    bt.pixth = bt.pixd = NULL;
+    bt.whsize = whsize;
+    bt.factor = factor;
     if (ppixth) {
-        pixth = pixCreateNoInit(w, h, 8);
-        *ppixth = pixth;
+        bt.pixth = pixCreateNoInit(w, h, 8);
+        *ppixth = bt.pixth;
     }
     if (ppixd) {
-        pixd = pixCreateNoInit(w, h, 1);
-        *ppixd = pixd;
+        bt.pixd = pixCreateNoInit(w, h, 1);
+        *ppixd = bt.pixd;
     }
     pt = pixTilingCreate(pixs, nx, ny, 0, 0, whsize + 1, whsize + 1);
     pixTilingNoStripOnPaint(pt);  /* pixSauvolaBinarize() does the stripping */
-
-    for (i = 0; i < ny; i++) {
-        for (j = 0; j < nx; j++) {
-            pixt = pixTilingGetTile(pt, i, j);
-            ptileth = (ppixth) ? &tileth : NULL;
-            ptiled = (ppixd) ? &tiled : NULL;
-            pixSauvolaBinarize(pixt, whsize, factor, 0, NULL, NULL,
-                               ptileth, ptiled);
-            if (ppixth) {  /* do not strip */
-                pixTilingPaintTile(pixth, i, j, tileth, pt);
-                pixDestroy(&tileth);
-            }
-            if (ppixd) {
-                pixTilingPaintTile(pixd, i, j, tiled, pt);
-                pixDestroy(&tiled);
-            }
-            pixDestroy(&pixt);
-        }
-    }
-
+    ret = pixTilingExecute(pt, sauvolaBinarizeTile, &bt, 0);
     pixTilingDestroy(&pt);
+    if (ret) {
+        if (ppixth) pixDestroy(ppixth);
+        if (ppixd) pixDestroy(ppixd);
+        return ERROR_INT("tiles not all binarized", procName, 1);
+    }
     return 0;
 }
 
 
+/*!
+ *  sauvolaBinarizeTile()
+ *
+ *      Input:  pt, pixt (tile), i, j (tile row and column), data
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+sauvolaBinarizeTile(PIXTILING  *pt,
+                    PIX        *pixt,
+                    l_int32     i,
+                    l_int32     j,
+                    void       *data)
+{
+l_int32           ret;
+PIX              *tileth, *tiled;
+BINARIZE_TILING  *bt;
+
+    bt = (BINARIZE_TILING *)data;
+    tileth = tiled = NULL;
+    ret = pixSauvolaBinarize(pixt, bt->whsize, bt->factor, 0, NULL, NULL,
+                             (bt->pixth) ? &tileth : NULL,
+                             (bt->pixd) ? &tiled : NULL);
+    if (!ret && bt->pixth)  /* do not strip */
+        ret = pixTilingPaintTile(bt->pixth, i, j, tileth, pt);
+    if (!ret && bt->pixd)
+        ret = pixTilingPaintTile(bt->pixd, i, j, tiled, pt);
+    pixDestroy(&tileth);
+    pixDestroy(&tiled);
+    return ret;
+}
+
+
 /*!
  *  pixSauvolaBinarize()
  *
@@ -578,6 +682,8 @@ PIXTILING  *pt;
  *          and the larger the variance, the closer to the median
  *          it should be chosen.  Typical values for k are between
  *          0.2 and 0.5.
+ *      (6) The local mean and mean square are found from a single
+ *          integral image, made in one pass over the data.
  */
 l_int32
 pixSauvolaBinarize(PIX       *pixs,
@@ -589,8 +695,9 @@ pixSauvolaBinarize(PIX       *pixs,
                    PIX      **ppixth,
                    PIX      **ppixd)
 {
-l_int32  w, h;
-PIX     *pixg, *pixsc, *pixm, *pixms, *pixth, *pixd;
+l_int32      w, h, needm, needms, ret;
+L_INTEGRAL  *li;
+PIX         *pixg, *pixsc, *pixm, *pixms, *pixth, *pixd;
 
     PROCNAME("pixSauvolaBinarize");
 
@@ -623,14 +730,23 @@ PIX     *pixg, *pixsc, *pixm, *pixms, *pixth, *pixd;
     if (!pixg || !pixsc)
         return ERROR_INT("pixg and pixsc not made", procName, 1);
 
-        /* All these functions strip off the border pixels. */
-    if (ppixm || ppixth || ppixd)
-        pixm = pixWindowedMean(pixg, whsize, whsize, 1, 1);
-    if (ppixsd || ppixth || ppixd)
-        pixms = pixWindowedMeanSquare(pixg, whsize, whsize, 1);
-    if (ppixth || ppixd)
+        /* The mean and mean square are both found from one integral
+         * image, and the border pixels are stripped off. */
+    pixm = pixms = pixth = pixd = NULL;
+    needm = (ppixm || ppixsd || ppixth || ppixd);
+    needms = (ppixsd || ppixth || ppixd);
+    if ((li = l_integralCreate(pixg, needms)) == NULL) {
+        pixDestroy(&pixg);
+        pixDestroy(&pixsc);
+        return ERROR_INT("li not made", procName, 1);
+    }
+    ret = l_integralWindowedStats(li, whsize, whsize, 1,
+                                  (needm) ? &pixm : NULL,
+                                  (needms) ? &pixms : NULL, NULL, NULL);
+    l_integralDestroy(&li);
+    if (!ret && needms)
         pixth = pixSauvolaGetThreshold(pixm, pixms, factor, ppixsd);
-    if (ppixd) {
+    if (ppixd && pixth) {
         pixd = pixApplyLocalThreshold(pixsc, pixth, 1);
         pixCopyResolution(pixd, pixs);
     }
@@ -650,7 +766,7 @@ PIX     *pixg, *pixsc, *pixm, *pixms, *pixth, *pixd;
         pixDestroy(&pixd);
     pixDestroy(&pixg);
     pixDestroy(&pixsc);
-    return 0;
+    return ret;
 }
 
 
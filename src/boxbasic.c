@@ -177,7 +177,7 @@ BOX  *box;
             return (BOX *)ERROR_PTR("y < 0 and box off +quad", procName, NULL);
     }
 
-    if ((box = (BOX *)CALLOC(1, sizeof(BOX))) == NULL)
+    if ((box = (BOX *)l_poolCalloc(1, sizeof(BOX))) == NULL)
         return (BOX *)ERROR_PTR("box not made", procName, NULL);
     boxSetGeometry(box, x, y, w, h);
     box->refcount = 1;
@@ -275,9 +275,8 @@ BOX  *box;
     if ((box = *pbox) == NULL)
         return;
 
-    boxChangeRefcount(box, -1);
-    if (boxGetRefcount(box) <= 0)
-        FREE(box);
+    if (L_REFCOUNT_ADD(&box->refcount, -1) <= 0)
+        l_poolFree(box);
     *pbox = NULL;
     return;
 }
@@ -406,7 +405,7 @@ boxChangeRefcount(BOX     *box,
     if (!box)
         return ERROR_INT("box not defined", procName, 1);
 
-    box->refcount += delta;
+    L_REFCOUNT_ADD(&box->refcount, delta);
     return 0;
 }
 
@@ -455,13 +454,13 @@ BOXA  *boxa;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((boxa = (BOXA *)CALLOC(1, sizeof(BOXA))) == NULL)
+    if ((boxa = (BOXA *)l_poolCalloc(1, sizeof(BOXA))) == NULL)
         return (BOXA *)ERROR_PTR("boxa not made", procName, NULL);
     boxa->n = 0;
     boxa->nalloc = n;
     boxa->refcount = 1;
 
-    if ((boxa->box = (BOX **)CALLOC(n, sizeof(BOX *))) == NULL)
+    if ((boxa->box = (BOX **)l_poolCalloc(n, sizeof(BOX *))) == NULL)
         return (BOXA *)ERROR_PTR("boxa ptrs not made", procName, NULL);
 
     return boxa;
@@ -493,7 +492,7 @@ BOXA    *boxac;
         return (BOXA *)ERROR_PTR("boxa not defined", procName, NULL);
 
     if (copyflag == L_CLONE) {
-        boxa->refcount++;
+        L_REFCOUNT_ADD(&boxa->refcount, 1);
         return boxa;
     }
 
@@ -540,12 +539,11 @@ BOXA    *boxa;
         return;
 
         /* Decrement the ref count.  If it is 0, destroy the boxa. */
-    boxa->refcount--;
-    if (boxa->refcount <= 0) {
+    if (L_REFCOUNT_ADD(&boxa->refcount, -1) <= 0) {
         for (i = 0; i < boxa->n; i++)
             boxDestroy(&boxa->box[i]);
-        FREE(boxa->box);
-        FREE(boxa);
+        l_poolFree(boxa->box);
+        l_poolFree(boxa);
     }
 
     *pboxa = NULL;
@@ -638,7 +636,7 @@ boxaExtendArrayToSize(BOXA    *boxa,
         return ERROR_INT("boxa not defined", procName, 1);
 
     if (size > boxa->nalloc) {
-        if ((boxa->box = (BOX **)reallocNew((void **)&boxa->box,
+        if ((boxa->box = (BOX **)l_poolReallocNew((void **)&boxa->box,
                                             sizeof(BOX *) * boxa->nalloc,
                                             size * sizeof(BOX *))) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -1142,9 +1140,9 @@ BOXAA  *baa;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((baa = (BOXAA *)CALLOC(1, sizeof(BOXAA))) == NULL)
+    if ((baa = (BOXAA *)l_poolCalloc(1, sizeof(BOXAA))) == NULL)
         return (BOXAA *)ERROR_PTR("baa not made", procName, NULL);
-    if ((baa->boxa = (BOXA **)CALLOC(n, sizeof(BOXA *))) == NULL)
+    if ((baa->boxa = (BOXA **)l_poolCalloc(n, sizeof(BOXA *))) == NULL)
         return (BOXAA *)ERROR_PTR("boxa ptr array not made", procName, NULL);
 
     baa->nalloc = n;
@@ -1216,8 +1214,8 @@ BOXAA   *baa;
 
     for (i = 0; i < baa->n; i++)
         boxaDestroy(&baa->boxa[i]);
-    FREE(baa->boxa);
-    FREE(baa);
+    l_poolFree(baa->boxa);
+    l_poolFree(baa);
     *pbaa = NULL;
 
     return;
@@ -1282,7 +1280,7 @@ boxaaExtendArray(BOXAA  *baa)
     if (!baa)
         return ERROR_INT("baa not defined", procName, 1);
 
-    if ((baa->boxa = (BOXA **)reallocNew((void **)&baa->boxa,
+    if ((baa->boxa = (BOXA **)l_poolReallocNew((void **)&baa->boxa,
                               sizeof(BOXA *) * baa->nalloc,
                               2 * sizeof(BOXA *) * baa->nalloc)) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -1312,7 +1310,7 @@ boxaaExtendArrayToSize(BOXAA   *baa,
         return ERROR_INT("baa not defined", procName, 1);
 
     if (size > baa->nalloc) {
-        if ((baa->boxa = (BOXA **)reallocNew((void **)&baa->boxa,
+        if ((baa->boxa = (BOXA **)l_poolReallocNew((void **)&baa->boxa,
                                              sizeof(BOXA *) * baa->nalloc,
                                              size * sizeof(BOXA *))) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -210,7 +210,7 @@ l_byteaCopy(L_BYTEA  *bas,
         return (L_BYTEA *)ERROR_PTR("bas not defined", procName, NULL);
 
     if (copyflag == L_CLONE) {
-        bas->refcount++;
+        L_REFCOUNT_ADD(&bas->refcount, 1);
         return bas;
     }
 
@@ -246,8 +246,7 @@ L_BYTEA  *ba;
         return;
 
         /* Decrement the ref count.  If it is 0, destroy the lba. */
-    ba->refcount--;
-    if (ba->refcount <= 0) {
+    if (L_REFCOUNT_ADD(&ba->refcount, -1) <= 0) {
         if (ba->data) FREE(ba->data);
         FREE(ba);
     }
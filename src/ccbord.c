@@ -413,8 +413,7 @@ CCBORD  *ccb;
     if ((ccb = *pccb) == NULL)
         return;
 
-    ccb->refcount--;
-    if (ccb->refcount == 0) {
+    if (L_REFCOUNT_ADD(&ccb->refcount, -1) == 0) {
         if (ccb->pix)
             pixDestroy(&ccb->pix);
         if (ccb->boxa)
@@ -537,7 +536,7 @@ CCBORD  *ccb;
         return (CCBORD *)ERROR_PTR("index out of bounds", procName, NULL);
 
     ccb = ccba->ccb[index];
-    ccb->refcount++;
+    L_REFCOUNT_ADD(&ccb->refcount, 1);
     return ccb;
 }
 
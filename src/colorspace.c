@@ -75,11 +75,22 @@
  *           PIX        *fpixaConvertLABToRGB()
  *           l_int32     convertRGBToLAB()
  *           l_int32     convertLABToRGB()
+ *
+ *      SIMD conversion of a line of RGB pixels
+ *           static l_int32  rgbToHSVLineSSE2()
+ *           static l_int32  rgbToHSVLineAVX2()
+ *           static l_int32  rgbToYUVLineSSE2()
+ *           static l_int32  rgbToYUVLineAVX2()
+ *           static l_int32  rgbToXYZLineSSE2()
+ *           static l_int32  rgbToXYZLineAVX2()
  */
 
 #include <string.h>
 #include <math.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
 
 #ifndef  NO_CONSOLE_IO
 #define  DEBUG_HISTO       0
@@ -90,6 +101,20 @@
 static l_float32 lab_forward(l_float32 v);
 static l_float32 lab_reverse(l_float32 v);
 
+#if USE_SIMD
+    /* Line conversions that give the same results as the scalar code */
+static l_int32 rgbToHSVLineSSE2(l_uint32 *line, l_int32 w);
+static l_int32 rgbToHSVLineAVX2(l_uint32 *line, l_int32 w);
+static l_int32 rgbToYUVLineSSE2(l_uint32 *line, l_int32 w);
+static l_int32 rgbToYUVLineAVX2(l_uint32 *line, l_int32 w);
+static l_int32 rgbToXYZLineSSE2(l_uint32 *lines, l_float32 *linex,
+                                l_float32 *liney, l_float32 *linez,
+                                l_int32 w);
+static l_int32 rgbToXYZLineAVX2(l_uint32 *lines, l_float32 *linex,
+                                l_float32 *liney, l_float32 *linez,
+                                l_int32 w);
+#endif  /* USE_SIMD */
+
 
 /*---------------------------------------------------------------------------*
  *                  Colorspace conversion between RGB and HSB                *
@@ -131,6 +156,7 @@ pixConvertRGBToHSV(PIX  *pixd,
                    PIX  *pixs)
 {
 l_int32    w, h, d, wpl, i, j, rval, gval, bval, hval, sval, vval;
+l_int32    level;
 l_uint32  *line, *data;
 PIXCMAP   *cmap;
 
@@ -159,9 +185,17 @@ PIXCMAP   *cmap;
     pixGetDimensions(pixd, &w, &h, NULL);
     wpl = pixGetWpl(pixd);
     data = pixGetData(pixd);
+    level = l_getSimdLevel();
     for (i = 0; i < h; i++) {
         line = data + i * wpl;
-        for (j = 0; j < w; j++) {
+        j = 0;
+#if USE_SIMD
+        if (level == L_SIMD_AVX2)
+            j = rgbToHSVLineAVX2(line, w);
+        else if (level == L_SIMD_SSE2)
+            j = rgbToHSVLineSSE2(line, w);
+#endif  /* USE_SIMD */
+        for (; j < w; j++) {
             extractRGBValues(line[j], &rval, &gval, &bval);
             convertRGBToHSV(rval, gval, bval, &hval, &sval, &vval);
             line[j] = (hval << 24) | (sval << 16) | (vval << 8);
@@ -1423,6 +1457,7 @@ pixConvertRGBToYUV(PIX  *pixd,
                    PIX  *pixs)
 {
 l_int32    w, h, d, wpl, i, j, rval, gval, bval, yval, uval, vval;
+l_int32    level;
 l_uint32  *line, *data;
 PIXCMAP   *cmap;
 
@@ -1451,9 +1486,17 @@ PIXCMAP   *cmap;
     pixGetDimensions(pixd, &w, &h, NULL);
     wpl = pixGetWpl(pixd);
     data = pixGetData(pixd);
+    level = l_getSimdLevel();
     for (i = 0; i < h; i++) {
         line = data + i * wpl;
-        for (j = 0; j < w; j++) {
+        j = 0;
+#if USE_SIMD
+        if (level == L_SIMD_AVX2)
+            j = rgbToYUVLineAVX2(line, w);
+        else if (level == L_SIMD_SSE2)
+            j = rgbToYUVLineSSE2(line, w);
+#endif  /* USE_SIMD */
+        for (; j < w; j++) {
             extractRGBValues(line[j], &rval, &gval, &bval);
             convertRGBToYUV(rval, gval, bval, &yval, &uval, &vval);
             line[j] = (yval << 24) | (uval << 16) | (vval << 8);
@@ -1718,6 +1761,7 @@ FPIXA *
 pixConvertRGBToXYZ(PIX  *pixs)
 {
 l_int32     w, h, wpls, wpld, i, j, rval, gval, bval;
+l_int32     level;
 l_uint32   *lines, *datas;
 l_float32   fxval, fyval, fzval;
 l_float32  *linex, *liney, *linez, *datax, *datay, *dataz;
@@ -1742,12 +1786,20 @@ FPIXA      *fpixa;
     datax = fpixaGetData(fpixa, 0);
     datay = fpixaGetData(fpixa, 1);
     dataz = fpixaGetData(fpixa, 2);
+    level = l_getSimdLevel();
     for (i = 0; i < h; i++) {
         lines = datas + i * wpls;
         linex = datax + i * wpld;
         liney = datay + i * wpld;
         linez = dataz + i * wpld;
-        for (j = 0; j < w; j++) {
+        j = 0;
+#if USE_SIMD
+        if (level == L_SIMD_AVX2)
+            j = rgbToXYZLineAVX2(lines, linex, liney, linez, w);
+        else if (level == L_SIMD_SSE2)
+            j = rgbToXYZLineSSE2(lines, linex, liney, linez, w);
+#endif  /* USE_SIMD */
+        for (; j < w; j++) {
             extractRGBValues(lines[j], &rval, &gval, &bval);
             convertRGBToXYZ(rval, gval, bval, &fxval, &fyval, &fzval);
             *(linex + j) = fxval;
@@ -2352,3 +2404,363 @@ l_float32  fxval, fyval, fzval;
     return 0;
 }
 
+
+#if USE_SIMD
+/*---------------------------------------------------------------------------*
+ *                  SIMD conversion of a line of RGB pixels                  *
+ *---------------------------------------------------------------------------*/
+/*!
+ *  rgbToHSVLineSSE2()
+ *
+ *      Input:  line (32 bpp; converted in place)
+ *              w (number of pixels)
+ *      Return: number of pixels done (a multiple of 4)
+ *
+ *  Notes:
+ *      (1) This gives exactly the same result as convertRGBToHSV().
+ *          In the scalar code, where a float is combined with a
+ *          double constant and the result is stored in a float, the
+ *          rounding to double and then to float gives the same float
+ *          as a single float operation, so all the work here is in
+ *          single precision.
+ *      (2) The saturation is rounded from a float quotient rather than
+ *          a double.  With integer numerator and a denominator less
+ *          than 256, the quotient is either exact or at least 1/510
+ *          from the rounding boundary, so the result is the same.
+ *      (3) The rounding (l_int32)(x + 0.5) for x >= 0 is found by
+ *          truncating, and incrementing if the exact fractional part
+ *          is at least 0.5.
+ */
+static l_int32  L_TARGET_SSE2
+rgbToHSVLineSSE2(l_uint32  *line,
+                 l_int32    w)
+{
+l_int32  j;
+__m128   fdelta, q, hf, sf, frac, half;
+__m128i  mask, pix, r, g, b, max, min, delta, rmax, gmax, bmax, n, off;
+__m128i  hval, sval, gray;
+
+    mask = _mm_set1_epi32(0xff);
+    half = _mm_set1_ps(0.5);
+    for (j = 0; j + 4 <= w; j += 4) {
+        pix = _mm_loadu_si128((const __m128i *)(line + j));
+        r = _mm_and_si128(_mm_srli_epi32(pix, L_RED_SHIFT), mask);
+        g = _mm_and_si128(_mm_srli_epi32(pix, L_GREEN_SHIFT), mask);
+        b = _mm_and_si128(_mm_srli_epi32(pix, L_BLUE_SHIFT), mask);
+            /* The 16-bit ops work because the upper halves are 0 */
+        max = _mm_max_epi16(_mm_max_epi16(r, g), b);
+        min = _mm_min_epi16(_mm_min_epi16(r, g), b);
+        delta = _mm_sub_epi32(max, min);
+        gray = _mm_cmpeq_epi32(delta, _mm_setzero_si128());
+
+            /* Select the sector: r, g or b is the max, in that order */
+        rmax = _mm_cmpeq_epi32(r, max);
+        gmax = _mm_andnot_si128(rmax, _mm_cmpeq_epi32(g, max));
+        bmax = _mm_andnot_si128(_mm_or_si128(rmax, gmax),
+                                _mm_cmpeq_epi32(b, b));
+        n = _mm_or_si128(
+                _mm_and_si128(rmax, _mm_sub_epi32(g, b)),
+                _mm_or_si128(_mm_and_si128(gmax, _mm_sub_epi32(b, r)),
+                             _mm_and_si128(bmax, _mm_sub_epi32(r, g))));
+        off = _mm_or_si128(
+                _mm_and_si128(gmax, _mm_castps_si128(_mm_set1_ps(2.0))),
+                _mm_and_si128(bmax, _mm_castps_si128(_mm_set1_ps(4.0))));
+
+            /* Hue */
+        fdelta = _mm_cvtepi32_ps(delta);
+        q = _mm_div_ps(_mm_cvtepi32_ps(n), fdelta);
+        hf = _mm_mul_ps(_mm_add_ps(q, _mm_castsi128_ps(off)),
+                        _mm_set1_ps(40.0));
+        hf = _mm_add_ps(hf, _mm_and_ps(_mm_cmplt_ps(hf, _mm_setzero_ps()),
+                                       _mm_set1_ps(240.0)));
+        hf = _mm_andnot_ps(_mm_cmpge_ps(hf, _mm_set1_ps(239.5)), hf);
+        hval = _mm_cvttps_epi32(hf);
+        frac = _mm_sub_ps(hf, _mm_cvtepi32_ps(hval));
+        hval = _mm_sub_epi32(hval,
+                             _mm_castps_si128(_mm_cmpge_ps(frac, half)));
+
+            /* Saturation */
+        sf = _mm_div_ps(_mm_mul_ps(_mm_set1_ps(255.0), fdelta),
+                        _mm_cvtepi32_ps(max));
+        sval = _mm_cvttps_epi32(sf);
+        frac = _mm_sub_ps(sf, _mm_cvtepi32_ps(sval));
+        sval = _mm_sub_epi32(sval,
+                             _mm_castps_si128(_mm_cmpge_ps(frac, half)));
+
+        hval = _mm_andnot_si128(gray, hval);
+        sval = _mm_andnot_si128(gray, sval);
+        pix = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(hval, 24),
+                                        _mm_slli_epi32(sval, 16)),
+                           _mm_slli_epi32(max, 8));
+        _mm_storeu_si128((__m128i *)(line + j), pix);
+    }
+    return j;
+}
+
+
+/*!
+ *  rgbToHSVLineAVX2()
+ *
+ *      Input:  line, w (as in rgbToHSVLineSSE2())
+ *      Return: number of pixels done (a multiple of 8)
+ */
+static l_int32  L_TARGET_AVX2
+rgbToHSVLineAVX2(l_uint32  *line,
+                 l_int32    w)
+{
+l_int32  j;
+__m256   fdelta, q, hf, sf, frac, half, off;
+__m256i  mask, pix, r, g, b, max, min, delta, rmax, gmax, n;
+__m256i  hval, sval, gray;
+
+    mask = _mm256_set1_epi32(0xff);
+    half = _mm256_set1_ps(0.5);
+    for (j = 0; j + 8 <= w; j += 8) {
+        pix = _mm256_loadu_si256((const __m256i *)(line + j));
+        r = _mm256_and_si256(_mm256_srli_epi32(pix, L_RED_SHIFT), mask);
+        g = _mm256_and_si256(_mm256_srli_epi32(pix, L_GREEN_SHIFT), mask);
+        b = _mm256_and_si256(_mm256_srli_epi32(pix, L_BLUE_SHIFT), mask);
+        max = _mm256_max_epi32(_mm256_max_epi32(r, g), b);
+        min = _mm256_min_epi32(_mm256_min_epi32(r, g), b);
+        delta = _mm256_sub_epi32(max, min);
+        gray = _mm256_cmpeq_epi32(delta, _mm256_setzero_si256());
+
+        rmax = _mm256_cmpeq_epi32(r, max);
+        gmax = _mm256_andnot_si256(rmax, _mm256_cmpeq_epi32(g, max));
+        n = _mm256_blendv_epi8(_mm256_sub_epi32(r, g),
+                               _mm256_sub_epi32(b, r), gmax);
+        n = _mm256_blendv_epi8(n, _mm256_sub_epi32(g, b), rmax);
+        off = _mm256_blendv_ps(_mm256_set1_ps(4.0), _mm256_set1_ps(2.0),
+                               _mm256_castsi256_ps(gmax));
+        off = _mm256_blendv_ps(off, _mm256_setzero_ps(),
+                               _mm256_castsi256_ps(rmax));
+
+        fdelta = _mm256_cvtepi32_ps(delta);
+        q = _mm256_div_ps(_mm256_cvtepi32_ps(n), fdelta);
+        hf = _mm256_mul_ps(_mm256_add_ps(q, off), _mm256_set1_ps(40.0));
+        hf = _mm256_add_ps(hf, _mm256_and_ps(
+                 _mm256_cmp_ps(hf, _mm256_setzero_ps(), _CMP_LT_OQ),
+                 _mm256_set1_ps(240.0)));
+        hf = _mm256_andnot_ps(
+                 _mm256_cmp_ps(hf, _mm256_set1_ps(239.5), _CMP_GE_OQ), hf);
+        hval = _mm256_cvttps_epi32(hf);
+        frac = _mm256_sub_ps(hf, _mm256_cvtepi32_ps(hval));
+        hval = _mm256_sub_epi32(hval, _mm256_castps_si256(
+                   _mm256_cmp_ps(frac, half, _CMP_GE_OQ)));
+
+        sf = _mm256_div_ps(_mm256_mul_ps(_mm256_set1_ps(255.0), fdelta),
+                           _mm256_cvtepi32_ps(max));
+        sval = _mm256_cvttps_epi32(sf);
+        frac = _mm256_sub_ps(sf, _mm256_cvtepi32_ps(sval));
+        sval = _mm256_sub_epi32(sval, _mm256_castps_si256(
+                   _mm256_cmp_ps(frac, half, _CMP_GE_OQ)));
+
+        hval = _mm256_andnot_si256(gray, hval);
+        sval = _mm256_andnot_si256(gray, sval);
+        pix = _mm256_or_si256(_mm256_or_si256(_mm256_slli_epi32(hval, 24),
+                                              _mm256_slli_epi32(sval, 16)),
+                              _mm256_slli_epi32(max, 8));
+        _mm256_storeu_si256((__m256i *)(line + j), pix);
+    }
+    return j;
+}
+
+
+/*!
+ *  rgbToYUVLineSSE2()
+ *
+ *      Input:  line (32 bpp; converted in place)
+ *              w (number of pixels)
+ *      Return: number of pixels done (a multiple of 2)
+ *
+ *  Notes:
+ *      (1) This gives exactly the same result as convertRGBToYUV(),
+ *          doing the same double precision operations in the same order.
+ */
+static l_int32  L_TARGET_SSE2
+rgbToYUVLineSSE2(l_uint32  *line,
+                 l_int32    w)
+{
+l_int32  j;
+__m128d  r, g, b, norm, half;
+__m128i  mask, pix, yval, uval, vval;
+
+    mask = _mm_set1_epi32(0xff);
+    norm = _mm_set1_pd(1.0 / 256.);
+    half = _mm_set1_pd(0.5);
+    for (j = 0; j + 2 <= w; j += 2) {
+        pix = _mm_loadl_epi64((const __m128i *)(line + j));
+        r = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(pix, L_RED_SHIFT),
+                                          mask));
+        g = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(pix, L_GREEN_SHIFT),
+                                          mask));
+        b = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(pix, L_BLUE_SHIFT),
+                                          mask));
+        yval = _mm_cvttpd_epi32(_mm_add_pd(_mm_add_pd(_mm_set1_pd(16.0),
+                   _mm_mul_pd(norm, _mm_add_pd(_mm_add_pd(
+                       _mm_mul_pd(_mm_set1_pd(65.738), r),
+                       _mm_mul_pd(_mm_set1_pd(129.057), g)),
+                       _mm_mul_pd(_mm_set1_pd(25.064), b)))), half));
+        uval = _mm_cvttpd_epi32(_mm_add_pd(_mm_add_pd(_mm_set1_pd(128.0),
+                   _mm_mul_pd(norm, _mm_add_pd(_mm_sub_pd(
+                       _mm_mul_pd(_mm_set1_pd(-37.945), r),
+                       _mm_mul_pd(_mm_set1_pd(74.494), g)),
+                       _mm_mul_pd(_mm_set1_pd(112.439), b)))), half));
+        vval = _mm_cvttpd_epi32(_mm_add_pd(_mm_add_pd(_mm_set1_pd(128.0),
+                   _mm_mul_pd(norm, _mm_sub_pd(_mm_sub_pd(
+                       _mm_mul_pd(_mm_set1_pd(112.439), r),
+                       _mm_mul_pd(_mm_set1_pd(94.154), g)),
+                       _mm_mul_pd(_mm_set1_pd(18.285), b)))), half));
+        pix = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(yval, 24),
+                                        _mm_slli_epi32(uval, 16)),
+                           _mm_slli_epi32(vval, 8));
+        _mm_storel_epi64((__m128i *)(line + j), pix);
+    }
+    return j;
+}
+
+
+/*!
+ *  rgbToYUVLineAVX2()
+ *
+ *      Input:  line, w (as in rgbToYUVLineSSE2())
+ *      Return: number of pixels done (a multiple of 4)
+ */
+static l_int32  L_TARGET_AVX2
+rgbToYUVLineAVX2(l_uint32  *line,
+                 l_int32    w)
+{
+l_int32  j;
+__m256d  r, g, b, norm, half;
+__m128i  mask, pix, yval, uval, vval;
+
+    mask = _mm_set1_epi32(0xff);
+    norm = _mm256_set1_pd(1.0 / 256.);
+    half = _mm256_set1_pd(0.5);
+    for (j = 0; j + 4 <= w; j += 4) {
+        pix = _mm_loadu_si128((const __m128i *)(line + j));
+        r = _mm256_cvtepi32_pd(_mm_and_si128(
+                _mm_srli_epi32(pix, L_RED_SHIFT), mask));
+        g = _mm256_cvtepi32_pd(_mm_and_si128(
+                _mm_srli_epi32(pix, L_GREEN_SHIFT), mask));
+        b = _mm256_cvtepi32_pd(_mm_and_si128(
+                _mm_srli_epi32(pix, L_BLUE_SHIFT), mask));
+        yval = _mm256_cvttpd_epi32(_mm256_add_pd(
+                   _mm256_add_pd(_mm256_set1_pd(16.0),
+                   _mm256_mul_pd(norm, _mm256_add_pd(_mm256_add_pd(
+                       _mm256_mul_pd(_mm256_set1_pd(65.738), r),
+                       _mm256_mul_pd(_mm256_set1_pd(129.057), g)),
+                       _mm256_mul_pd(_mm256_set1_pd(25.064), b)))), half));
+        uval = _mm256_cvttpd_epi32(_mm256_add_pd(
+                   _mm256_add_pd(_mm256_set1_pd(128.0),
+                   _mm256_mul_pd(norm, _mm256_add_pd(_mm256_sub_pd(
+                       _mm256_mul_pd(_mm256_set1_pd(-37.945), r),
+                       _mm256_mul_pd(_mm256_set1_pd(74.494), g)),
+                       _mm256_mul_pd(_mm256_set1_pd(112.439), b)))), half));
+        vval = _mm256_cvttpd_epi32(_mm256_add_pd(
+                   _mm256_add_pd(_mm256_set1_pd(128.0),
+                   _mm256_mul_pd(norm, _mm256_sub_pd(_mm256_sub_pd(
+                       _mm256_mul_pd(_mm256_set1_pd(112.439), r),
+                       _mm256_mul_pd(_mm256_set1_pd(94.154), g)),
+                       _mm256_mul_pd(_mm256_set1_pd(18.285), b)))), half));
+        pix = _mm_or_si128(_mm_or_si128(_mm_slli_epi32(yval, 24),
+                                        _mm_slli_epi32(uval, 16)),
+                           _mm_slli_epi32(vval, 8));
+        _mm_storeu_si128((__m128i *)(line + j), pix);
+    }
+    return j;
+}
+
+
+/*!
+ *  rgbToXYZLineSSE2()
+ *
+ *      Input:  lines (32 bpp src line)
+ *              linex, liney, linez (dest lines of the 3 fpix)
+ *              w (number of pixels)
+ *      Return: number of pixels done (a multiple of 2)
+ *
+ *  Notes:
+ *      (1) This gives exactly the same result as convertRGBToXYZ(),
+ *          doing the same double precision operations in the same order
+ *          and rounding the result to float.
+ */
+static l_int32  L_TARGET_SSE2
+rgbToXYZLineSSE2(l_uint32   *lines,
+                 l_float32  *linex,
+                 l_float32  *liney,
+                 l_float32  *linez,
+                 l_int32     w)
+{
+l_int32  j;
+__m128d  r, g, b;
+__m128i  mask, pix;
+
+    mask = _mm_set1_epi32(0xff);
+    for (j = 0; j + 2 <= w; j += 2) {
+        pix = _mm_loadl_epi64((const __m128i *)(lines + j));
+        r = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(pix, L_RED_SHIFT),
+                                          mask));
+        g = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(pix, L_GREEN_SHIFT),
+                                          mask));
+        b = _mm_cvtepi32_pd(_mm_and_si128(_mm_srli_epi32(pix, L_BLUE_SHIFT),
+                                          mask));
+        _mm_storel_pi((__m64 *)(linex + j), _mm_cvtpd_ps(_mm_add_pd(
+            _mm_add_pd(_mm_mul_pd(_mm_set1_pd(0.4125), r),
+                       _mm_mul_pd(_mm_set1_pd(0.3576), g)),
+            _mm_mul_pd(_mm_set1_pd(0.1804), b))));
+        _mm_storel_pi((__m64 *)(liney + j), _mm_cvtpd_ps(_mm_add_pd(
+            _mm_add_pd(_mm_mul_pd(_mm_set1_pd(0.2127), r),
+                       _mm_mul_pd(_mm_set1_pd(0.7152), g)),
+            _mm_mul_pd(_mm_set1_pd(0.0722), b))));
+        _mm_storel_pi((__m64 *)(linez + j), _mm_cvtpd_ps(_mm_add_pd(
+            _mm_add_pd(_mm_mul_pd(_mm_set1_pd(0.0193), r),
+                       _mm_mul_pd(_mm_set1_pd(0.1192), g)),
+            _mm_mul_pd(_mm_set1_pd(0.9502), b))));
+    }
+    return j;
+}
+
+
+/*!
+ *  rgbToXYZLineAVX2()
+ *
+ *      Input:  lines, linex, liney, linez, w (as in rgbToXYZLineSSE2())
+ *      Return: number of pixels done (a multiple of 4)
+ */
+static l_int32  L_TARGET_AVX2
+rgbToXYZLineAVX2(l_uint32   *lines,
+                 l_float32  *linex,
+                 l_float32  *liney,
+                 l_float32  *linez,
+                 l_int32     w)
+{
+l_int32  j;
+__m256d  r, g, b;
+__m128i  mask, pix;
+
+    mask = _mm_set1_epi32(0xff);
+    for (j = 0; j + 4 <= w; j += 4) {
+        pix = _mm_loadu_si128((const __m128i *)(lines + j));
+        r = _mm256_cvtepi32_pd(_mm_and_si128(
+                _mm_srli_epi32(pix, L_RED_SHIFT), mask));
+        g = _mm256_cvtepi32_pd(_mm_and_si128(
+                _mm_srli_epi32(pix, L_GREEN_SHIFT), mask));
+        b = _mm256_cvtepi32_pd(_mm_and_si128(
+                _mm_srli_epi32(pix, L_BLUE_SHIFT), mask));
+        _mm_storeu_ps(linex + j, _mm256_cvtpd_ps(_mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(0.4125), r),
+                          _mm256_mul_pd(_mm256_set1_pd(0.3576), g)),
+            _mm256_mul_pd(_mm256_set1_pd(0.1804), b))));
+        _mm_storeu_ps(liney + j, _mm256_cvtpd_ps(_mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(0.2127), r),
+                          _mm256_mul_pd(_mm256_set1_pd(0.7152), g)),
+            _mm256_mul_pd(_mm256_set1_pd(0.0722), b))));
+        _mm_storeu_ps(linez + j, _mm256_cvtpd_ps(_mm256_add_pd(
+            _mm256_add_pd(_mm256_mul_pd(_mm256_set1_pd(0.0193), r),
+                          _mm256_mul_pd(_mm256_set1_pd(0.1192), g)),
+            _mm256_mul_pd(_mm256_set1_pd(0.9502), b))));
+    }
+    return j;
+}
+#endif  /* USE_SIMD */
@@ -27,8 +27,9 @@
 /*
  *  conncomp.c
  *
- *    Connected component counting and extraction, using Heckbert's
- *    stack-based filling algorithm.
+ *    Connected component counting and extraction, using union-find
+ *    on the runs of ON pixels, and Heckbert's stack-based filling
+ *    algorithm for single components.
  *
  *      4- and 8-connected components: counts, bounding boxes and images
  *
@@ -37,6 +38,7 @@
  *           BOXA     *pixConnCompPixa()
  *           BOXA     *pixConnCompBB()
  *           l_int32   pixCountConnComp()
+ *           BOXA     *pixConnCompLabels()
  *
  *      Identify the next c.c. to be erased:
  *           l_int32   nextOnPixelInRaster()
@@ -57,33 +59,41 @@
  *           static void    pushFillseg()
  *           static void    popFillseg()
  *
- *  The basic method in pixConnCompBB() is very simple.  We scan the
- *  image in raster order, looking for the next ON pixel.  When it
- *  is found, we erase it and every pixel of the 4- or 8-connected
- *  component to which it belongs, using Heckbert's seedfill
- *  algorithm.  As pixels are erased, we keep track of the
- *  minimum rectangle that encloses all erased pixels; after
- *  the connected component has been erased, we save its
- *  bounding box in an array of boxes.  When all pixels in the
- *  image have been erased, we have an array that describes every
- *  4- or 8-connected component in terms of its bounding box.
+ *      Static helpers for labelling the runs with union-find:
+ *           static CC_RUNS  *connCompRunsCreate()
+ *           static void      connCompRunsDestroy()
+ *           static l_int32   connCompStripJob()
+ *           static l_int32   connCompStripExtend()
+ *           static void      connCompJoinRows()
+ *           static l_int32   connCompFindRoot()
+ *           static l_int32   connCompLeadingZeros()
+ *           static l_int32   connCompPaintJob()
+ *           static void      connCompSetRun()
  *
- *  pixConnCompPixa() is a slight variation on pixConnCompBB(),
- *  where we additionally save an array of images (in a Pixa)
- *  of each of the 4- or 8-connected components.  This is done trivially
- *  by maintaining two temporary images.  We erase a component from one,
- *  and use the bounding box to extract the pixels within the b.b.
- *  from each of the two images.  An XOR between these subimages
- *  gives the erased component.  Then we erase the component from the
- *  second image using the XOR again, with the extracted component
- *  placed on the second image at the location of the bounding box.
- *  Rasterop does all the work.  At the end, we have an array
- *  of the 4- or 8-connected components, as well as an array of the
- *  bounding boxes that describe where they came from in the original image.
+ *  All the top-level calls use pixConnCompLabels(), which finds every
+ *  c.c. in a single pass over the image.  Each raster line is broken
+ *  into runs of ON pixels, and each run is joined, in a union-find
+ *  forest, to the runs that it touches in the line above.  With
+ *  4-connectivity, two runs touch if they share at least one column;
+ *  with 8-connectivity, they also touch if they are diagonally adjacent.
+ *  After all lines have been joined, each tree in the forest is a c.c.
+ *  The roots are numbered in raster order, each run takes the number
+ *  of its root, and the bounding boxes, component images and label
+ *  image are made from the runs.
  *
- *  If you just want the number of connected components, pixCountConnComp()
- *  is a bit faster than pixConnCompBB(), because it doesn't have to
- *  keep track of the bounding rectangles for each c.c.
+ *  The work is divided into horizontal strips.  The runs in each strip
+ *  are found and joined independently, using l_parallelRun(); then
+ *  the strips are joined at their boundaries.  Because the roots
+ *  are always the first run of their c.c. in raster order, the
+ *  result is the same for any number of threads, and the c.c. are in
+ *  the same order as they would be found by scanning with
+ *  nextOnPixelInRaster() and erasing each with pixSeedfillBB().
+ *
+ *  The seedfill functions are still useful for extracting or erasing
+ *  a single c.c. from a seed pixel.  They use Heckbert's algorithm:
+ *  starting from the seed, the c.c. is erased, one run at a time,
+ *  and the minimum rectangle that encloses all erased pixels is
+ *  the bounding box of the c.c.
  */
 
 #include "allheaders.h"
@@ -115,6 +125,62 @@ static void popFillseg(L_STACK *stack, l_int32 *pxleft, l_int32 *pxright,
                        l_int32 *py, l_int32 *pdy);
 
 
+/*
+ *  The struct CCStrip holds the runs of ON pixels in a horizontal strip
+ *  of the image, in raster order.  The runs in line y of the strip are
+ *  at indices [rowstart[y - y0] ... rowstart[y - y0 + 1] - 1].
+ *  The struct CCRuns holds the strips and the label of every run.
+ */
+struct CCStrip
+{
+    l_int32    y0;        /* first line of the strip                      */
+    l_int32    y1;        /* one past the last line of the strip          */
+    l_int32    nruns;     /* number of runs in the strip                  */
+    l_int32    nalloc;    /* size of the run arrays                       */
+    l_int32    offset;    /* index of the first run over all strips       */
+    l_int32   *xstart;    /* first pixel of each run                      */
+    l_int32   *xend;      /* last pixel of each run                       */
+    l_int32   *parent;    /* union-find forest, local to the strip        */
+    l_int32   *rowstart;  /* index of the first run in each line          */
+};
+typedef struct CCStrip    CC_STRIP;
+
+struct CCRuns
+{
+    l_uint32  *datas;         /* data of the 1 bpp image                  */
+    l_int32    w;             /* width of the image                       */
+    l_int32    h;             /* height of the image                      */
+    l_int32    wpls;          /* wpl of the image                         */
+    l_int32    connectivity;  /* 4 or 8                                   */
+    l_int32    nstrips;       /* number of strips                         */
+    CC_STRIP  *strips;        /* array of strips                          */
+    l_int32    nruns;         /* number of runs over all strips           */
+    l_int32   *label;         /* c.c. of each run, over all strips        */
+    l_int32    ncomp;         /* number of c.c.                           */
+    l_int32   *minx;          /* left side of the b.b. of each c.c.       */
+    l_int32   *miny;          /* top side of the b.b. of each c.c.        */
+    PIX      **pixarray;      /* image of each c.c., painted by strips    */
+    PIX       *pixd;          /* 32 bpp label image, painted by strips    */
+};
+typedef struct CCRuns    CC_RUNS;
+
+    /* Static helpers for labelling the runs with union-find */
+static CC_RUNS *connCompRunsCreate(PIX *pixs, l_int32 connectivity,
+                                   l_int32 nthreads);
+static void connCompRunsDestroy(CC_RUNS **pccr);
+static l_int32 connCompStripJob(void *data, l_int32 index);
+static l_int32 connCompStripExtend(CC_STRIP *strip, l_int32 size);
+static void connCompJoinRows(l_int32 *parent, l_int32 connectivity,
+                             l_int32 *xs1, l_int32 *xe1, l_int32 off1,
+                             l_int32 i1, l_int32 n1,
+                             l_int32 *xs2, l_int32 *xe2, l_int32 off2,
+                             l_int32 i2, l_int32 n2);
+static l_int32 connCompFindRoot(l_int32 *parent, l_int32 index);
+static l_int32 connCompLeadingZeros(l_uint32 word);
+static l_int32 connCompPaintJob(void *data, l_int32 index);
+static void connCompSetRun(l_uint32 *line, l_int32 x1, l_int32 x2);
+
+
 #ifndef  NO_CONSOLE_IO
 #define   DEBUG    0
 #endif  /* ~NO_CONSOLE_IO */
@@ -171,10 +237,8 @@ pixConnComp(PIX     *pixs,
  *      (1) This finds bounding boxes of 4- or 8-connected components
  *          in a binary image, and saves images of each c.c
  *          in a pixa array.
- *      (2) It sets up 2 temporary pix, and for each c.c. that is
- *          located in raster order, it erases the c.c. from one pix,
- *          then uses the b.b. to extract the c.c. from the two pix using
- *          an XOR, and finally erases the c.c. from the second pix.
+ *      (2) The c.c. are found with pixConnCompLabels(), and are in
+ *          the raster order of their first pixel.
  *      (3) A clone of the returned boxa (where all boxes in the array
  *          are clones) is inserted into the pixa.
  *      (4) If the input is valid, this always returns a boxa and a pixa.
@@ -185,14 +249,6 @@ pixConnCompPixa(PIX     *pixs,
                 PIXA   **ppixa,
                 l_int32  connectivity)
 {
-l_int32   h, iszero;
-l_int32   x, y, xstart, ystart;
-PIX      *pixt1, *pixt2, *pixt3, *pixt4;
-PIXA     *pixa;
-BOX      *box;
-BOXA     *boxa;
-L_STACK  *stack, *auxstack;
-
     PROCNAME("pixConnCompPixa");
 
     if (!ppixa)
@@ -203,66 +259,7 @@ L_STACK  *stack, *auxstack;
     if (connectivity != 4 && connectivity != 8)
         return (BOXA *)ERROR_PTR("connectivity not 4 or 8", procName, NULL);
 
-    pixa = pixaCreate(0);
-    *ppixa = pixa;
-    pixZero(pixs, &iszero);
-    if (iszero)
-        return boxaCreate(1);  /* return empty boxa */
-
-    if ((pixt1 = pixCopy(NULL, pixs)) == NULL)
-        return (BOXA *)ERROR_PTR("pixt1 not made", procName, NULL);
-    if ((pixt2 = pixCopy(NULL, pixs)) == NULL)
-        return (BOXA *)ERROR_PTR("pixt2 not made", procName, NULL);
-
-    h = pixGetHeight(pixs);
-    if ((stack = lstackCreate(h)) == NULL)
-        return (BOXA *)ERROR_PTR("stack not made", procName, NULL);
-    if ((auxstack = lstackCreate(0)) == NULL)
-        return (BOXA *)ERROR_PTR("auxstack not made", procName, NULL);
-    stack->auxstack = auxstack;
-    if ((boxa = boxaCreate(0)) == NULL)
-        return (BOXA *)ERROR_PTR("boxa not made", procName, NULL);
-
-    xstart = 0;
-    ystart = 0;
-    while (1)
-    {
-        if (!nextOnPixelInRaster(pixt1, xstart, ystart, &x, &y))
-            break;
-
-        if ((box = pixSeedfillBB(pixt1, stack, x, y, connectivity)) == NULL)
-            return (BOXA *)ERROR_PTR("box not made", procName, NULL);
-        boxaAddBox(boxa, box, L_INSERT);
-
-            /* Save the c.c. and remove from pixt2 as well */
-        pixt3 = pixClipRectangle(pixt1, box, NULL);
-        pixt4 = pixClipRectangle(pixt2, box, NULL);
-        pixXor(pixt3, pixt3, pixt4);
-        pixRasterop(pixt2, box->x, box->y, box->w, box->h, PIX_SRC ^ PIX_DST,
-                    pixt3, 0, 0);
-        pixaAddPix(pixa, pixt3, L_INSERT);
-        pixDestroy(&pixt4);
-
-        xstart = x;
-        ystart = y;
-    }
-
-#if  DEBUG
-    pixCountPixels(pixt1, &iszero, NULL);
-    fprintf(stderr, "Number of remaining pixels = %d\n", iszero);
-    pixWrite("junkremain", pixt1, IFF_PNG);
-#endif  /* DEBUG */
-
-        /* Remove old boxa of pixa and replace with a clone copy */
-    boxaDestroy(&pixa->boxa);
-    pixa->boxa = boxaCopy(boxa, L_CLONE);
-
-        /* Cleanup, freeing the fillsegs on each stack */
-    lstackDestroy(&stack, TRUE);
-    pixDestroy(&pixt1);
-    pixDestroy(&pixt2);
-
-    return boxa;
+    return pixConnCompLabels(pixs, ppixa, NULL, connectivity);
 }
 
 
@@ -276,21 +273,13 @@ L_STACK  *stack, *auxstack;
  * Notes:
  *     (1) Finds bounding boxes of 4- or 8-connected components
  *         in a binary image.
- *     (2) This works on a copy of the input pix.  The c.c. are located
- *         in raster order and erased one at a time.  In the process,
- *         the b.b. is computed and saved.
+ *     (2) The c.c. are found with pixConnCompLabels(), and are in
+ *         the raster order of their first pixel.
  */
 BOXA *
 pixConnCompBB(PIX     *pixs,
               l_int32  connectivity)
 {
-l_int32   h, iszero;
-l_int32   x, y, xstart, ystart;
-PIX      *pixt;
-BOX      *box;
-BOXA     *boxa;
-L_STACK  *stack, *auxstack;
-
     PROCNAME("pixConnCompBB");
 
     if (!pixs || pixGetDepth(pixs) != 1)
@@ -298,48 +287,7 @@ L_STACK  *stack, *auxstack;
     if (connectivity != 4 && connectivity != 8)
         return (BOXA *)ERROR_PTR("connectivity not 4 or 8", procName, NULL);
 
-    pixZero(pixs, &iszero);
-    if (iszero)
-        return boxaCreate(1);  /* return empty boxa */
-
-    if ((pixt = pixCopy(NULL, pixs)) == NULL)
-        return (BOXA *)ERROR_PTR("pixt not made", procName, NULL);
-
-    h = pixGetHeight(pixs);
-    if ((stack = lstackCreate(h)) == NULL)
-        return (BOXA *)ERROR_PTR("stack not made", procName, NULL);
-    if ((auxstack = lstackCreate(0)) == NULL)
-        return (BOXA *)ERROR_PTR("auxstack not made", procName, NULL);
-    stack->auxstack = auxstack;
-    if ((boxa = boxaCreate(0)) == NULL)
-        return (BOXA *)ERROR_PTR("boxa not made", procName, NULL);
-
-    xstart = 0;
-    ystart = 0;
-    while (1)
-    {
-        if (!nextOnPixelInRaster(pixt, xstart, ystart, &x, &y))
-            break;
-
-        if ((box = pixSeedfillBB(pixt, stack, x, y, connectivity)) == NULL)
-            return (BOXA *)ERROR_PTR("box not made", procName, NULL);
-        boxaAddBox(boxa, box, L_INSERT);
-
-        xstart = x;
-        ystart = y;
-    }
-
-#if  DEBUG
-    pixCountPixels(pixt, &iszero, NULL);
-    fprintf(stderr, "Number of remaining pixels = %d\n", iszero);
-    pixWrite("junkremain", pixt1, IFF_PNG);
-#endif  /* DEBUG */
-
-        /* Cleanup, freeing the fillsegs on each stack */
-    lstackDestroy(&stack, TRUE);
-    pixDestroy(&pixt);
-
-    return boxa;
+    return pixConnCompLabels(pixs, NULL, NULL, connectivity);
 }
 
 
@@ -354,18 +302,15 @@ L_STACK  *stack, *auxstack;
  * Notes:
  *     (1) This is the top-level call for getting the number of
  *         4- or 8-connected components in a 1 bpp image.
- *     (2) It works on a copy of the input pix.  The c.c. are located
- *         in raster order and erased one at a time.
+ *     (2) It labels the runs of the image, as in pixConnCompLabels(),
+ *         but does not make the bounding boxes.
  */
 l_int32
 pixCountConnComp(PIX      *pixs,
                  l_int32   connectivity,
                  l_int32  *pcount)
 {
-l_int32   h, iszero;
-l_int32   x, y, xstart, ystart;
-PIX      *pixt;
-L_STACK  *stack, *auxstack;
+CC_RUNS  *ccr;
 
     PROCNAME("pixCountConnComp");
 
@@ -377,38 +322,148 @@ L_STACK  *stack, *auxstack;
     if (connectivity != 4 && connectivity != 8)
         return ERROR_INT("connectivity not 4 or 8", procName, 1);
 
-    pixZero(pixs, &iszero);
-    if (iszero)
-        return 0;
+    if ((ccr = connCompRunsCreate(pixs, connectivity,
+                                  l_getNumThreads())) == NULL)
+        return ERROR_INT("ccr not made", procName, 1);
+    *pcount = ccr->ncomp;
+    connCompRunsDestroy(&ccr);
+    return 0;
+}
+
 
-    if ((pixt = pixCopy(NULL, pixs)) == NULL)
-        return ERROR_INT("pixt not made", procName, 1);
+/*!
+ *  pixConnCompLabels()
+ *
+ *      Input:  pixs (1 bpp)
+ *              &pixa (<optional return> pixa of each c.c.)
+ *              &pixd (<optional return> 32 bpp label image)
+ *              connectivity (4 or 8)
+ *      Return: boxa, or null on error
+ *
+ *  Notes:
+ *      (1) This finds all the 4- or 8-connected components in one
+ *          pass, and returns their bounding boxes, and optionally
+ *          the image of each component and a label image.  In the
+ *          label image, the pixels of component i have the value i + 1,
+ *          and the background is 0.
+ *      (2) The components are in the same order as with the seedfill
+ *          method: the raster order of the first pixel of each c.c.
+ *          The results do not depend on the number of threads.
+ *      (3) The image is divided into horizontal strips.  For each
+ *          strip, in parallel, the runs of ON pixels are found and
+ *          joined with a union-find forest to the touching runs in the
+ *          line above.  The strips are then joined serially at their
+ *          boundaries, and each run is given the label of its c.c.
+ *          The pixa and label image are painted from the runs, again
+ *          in parallel by strips.
+ *      (4) Memory use is about 12 bytes per run.  This is much less
+ *          than the image for text and line art, but for halftones
+ *          and noise it can be several times larger.
+ */
+BOXA *
+pixConnCompLabels(PIX     *pixs,
+                  PIXA   **ppixa,
+                  PIX    **ppixd,
+                  l_int32  connectivity)
+{
+l_int32   i, j, k, y, comp, ncomp, nthreads;
+l_int32   w, h, bx, by, bw, bh;
+l_int32  *minx, *maxx, *miny, *maxy;
+BOX      *box;
+BOXA     *boxa;
+CC_RUNS  *ccr;
+CC_STRIP *strip;
+PIX      *pix;
 
-    h = pixGetDepth(pixs);
-    if ((stack = lstackCreate(h)) == NULL)
-        return ERROR_INT("stack not made", procName, 1);
-    if ((auxstack = lstackCreate(0)) == NULL)
-        return ERROR_INT("auxstack not made", procName, 1);
-    stack->auxstack = auxstack;
+    PROCNAME("pixConnCompLabels");
 
-    xstart = 0;
-    ystart = 0;
-    while (1)
-    {
-        if (!nextOnPixelInRaster(pixt, xstart, ystart, &x, &y))
-            break;
+    if (ppixa) *ppixa = NULL;
+    if (ppixd) *ppixd = NULL;
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (BOXA *)ERROR_PTR("pixs undefined or not 1 bpp", procName, NULL);
+    if (connectivity != 4 && connectivity != 8)
+        return (BOXA *)ERROR_PTR("connectivity not 4 or 8", procName, NULL);
 
-        pixSeedfill(pixt, stack, x, y, connectivity);
-        (*pcount)++;
-        xstart = x;
-        ystart = y;
+    pixGetDimensions(pixs, &w, &h, NULL);
+    nthreads = l_getNumThreads();
+    if ((ccr = connCompRunsCreate(pixs, connectivity, nthreads)) == NULL)
+        return (BOXA *)ERROR_PTR("ccr not made", procName, NULL);
+    ncomp = ccr->ncomp;
+
+        /* Accumulate the bounding boxes over the runs */
+    minx = (l_int32 *)CALLOC(ncomp + 1, sizeof(l_int32));
+    maxx = (l_int32 *)CALLOC(ncomp + 1, sizeof(l_int32));
+    miny = (l_int32 *)CALLOC(ncomp + 1, sizeof(l_int32));
+    maxy = (l_int32 *)CALLOC(ncomp + 1, sizeof(l_int32));
+    if (!minx || !maxx || !miny || !maxy) {
+        if (minx) FREE(minx);
+        if (maxx) FREE(maxx);
+        if (miny) FREE(miny);
+        if (maxy) FREE(maxy);
+        connCompRunsDestroy(&ccr);
+        return (BOXA *)ERROR_PTR("box arrays not made", procName, NULL);
+    }
+    for (i = 0; i < ncomp; i++) {
+        minx[i] = w;
+        miny[i] = h;
+        maxx[i] = maxy[i] = -1;
+    }
+    for (i = 0; i < ccr->nstrips; i++) {
+        strip = &ccr->strips[i];
+        for (y = strip->y0; y < strip->y1; y++) {
+            for (j = strip->rowstart[y - strip->y0];
+                 j < strip->rowstart[y - strip->y0 + 1]; j++) {
+                comp = ccr->label[strip->offset + j];
+                if (strip->xstart[j] < minx[comp]) minx[comp] = strip->xstart[j];
+                if (strip->xend[j] > maxx[comp]) maxx[comp] = strip->xend[j];
+                if (y < miny[comp]) miny[comp] = y;
+                maxy[comp] = y;
+            }
+        }
     }
 
-        /* Cleanup, freeing the fillsegs on each stack */
-    lstackDestroy(&stack, TRUE);
-    pixDestroy(&pixt);
+    boxa = boxaCreate(ncomp);
+    for (k = 0; k < ncomp; k++) {
+        box = boxCreate(minx[k], miny[k], maxx[k] - minx[k] + 1,
+                        maxy[k] - miny[k] + 1);
+        boxaAddBox(boxa, box, L_INSERT);
+    }
+    FREE(maxx);
+    FREE(maxy);
+    ccr->minx = minx;
+    ccr->miny = miny;
+
+        /* Make the component images and label image, and paint
+         * the runs into them */
+    if (ppixa) {
+        ccr->pixarray = (PIX **)CALLOC(ncomp + 1, sizeof(PIX *));
+        for (k = 0; k < ncomp; k++) {
+            boxaGetBoxGeometry(boxa, k, &bx, &by, &bw, &bh);
+            pix = pixCreate(bw, bh, 1);
+            pixCopyResolution(pix, pixs);
+            pixCopyColormap(pix, pixs);
+            ccr->pixarray[k] = pix;
+        }
+    }
+    if (ppixd)
+        ccr->pixd = pixCreate(w, h, 32);
+    if (ppixa || ppixd)
+        l_parallelRun(ccr->nstrips, connCompPaintJob, ccr, nthreads);
+
+    if (ppixa) {
+        *ppixa = pixaCreate(ncomp);
+        for (k = 0; k < ncomp; k++)
+            pixaAddPix(*ppixa, ccr->pixarray[k], L_INSERT);
+        boxaDestroy(&(*ppixa)->boxa);
+        (*ppixa)->boxa = boxaCopy(boxa, L_CLONE);
+    }
+    if (ppixd) {
+        *ppixd = ccr->pixd;
+        ccr->pixd = NULL;
+    }
 
-    return 0;
+    connCompRunsDestroy(&ccr);
+    return boxa;
 }
 
 
@@ -1197,3 +1252,454 @@ L_STACK  *auxstack;
     lstackAdd(auxstack, fseg);
     return;
 }
+
+
+/*-----------------------------------------------------------------------*
+ *        Static helpers for labelling the runs with union-find          *
+ *-----------------------------------------------------------------------*/
+/*!
+ *  connCompRunsCreate()
+ *
+ *      Input:  pixs (1 bpp)
+ *              connectivity (4 or 8)
+ *              nthreads
+ *      Return: ccr, with the runs labelled by c.c., or null on error
+ *
+ *  Notes:
+ *      (1) The runs are indexed in raster order over all strips.  The
+ *          union-find forest keeps the smallest index as the root of
+ *          each set, so every run has a parent with an index no larger
+ *          than its own.  Therefore the labels can be assigned in place
+ *          in one pass in index order, and the labels are in the
+ *          raster order of the first pixel of each c.c.
+ */
+static CC_RUNS *
+connCompRunsCreate(PIX     *pixs,
+                   l_int32  connectivity,
+                   l_int32  nthreads)
+{
+l_int32    i, j, h, nstrips, nruns, ncomp;
+l_int32   *parent;
+CC_RUNS   *ccr;
+CC_STRIP  *strip, *sprev;
+
+    PROCNAME("connCompRunsCreate");
+
+    if ((ccr = (CC_RUNS *)CALLOC(1, sizeof(CC_RUNS))) == NULL)
+        return (CC_RUNS *)ERROR_PTR("ccr not made", procName, NULL);
+    pixGetDimensions(pixs, &ccr->w, &h, NULL);
+    ccr->h = h;
+    ccr->datas = pixGetData(pixs);
+    ccr->wpls = pixGetWpl(pixs);
+    ccr->connectivity = connectivity;
+    nstrips = (nthreads <= 1) ? 1 : L_MIN(h, 4 * nthreads);
+    nstrips = L_MAX(1, nstrips);
+    ccr->nstrips = nstrips;
+    if ((ccr->strips = (CC_STRIP *)CALLOC(nstrips, sizeof(CC_STRIP)))
+        == NULL) {
+        connCompRunsDestroy(&ccr);
+        return (CC_RUNS *)ERROR_PTR("strips not made", procName, NULL);
+    }
+    for (i = 0; i < nstrips; i++) {
+        ccr->strips[i].y0 = (l_int32)((l_float64)i * h / nstrips);
+        ccr->strips[i].y1 = (l_int32)((l_float64)(i + 1) * h / nstrips);
+    }
+
+        /* Find the runs and join them within each strip */
+    if (l_parallelRun(nstrips, connCompStripJob, ccr, nthreads)) {
+        connCompRunsDestroy(&ccr);
+        return (CC_RUNS *)ERROR_PTR("strip runs not made", procName, NULL);
+    }
+
+        /* Make a single forest, and join across the strip boundaries */
+    nruns = 0;
+    for (i = 0; i < nstrips; i++) {
+        ccr->strips[i].offset = nruns;
+        nruns += ccr->strips[i].nruns;
+    }
+    ccr->nruns = nruns;
+    if ((parent = (l_int32 *)CALLOC(nruns + 1, sizeof(l_int32))) == NULL) {
+        connCompRunsDestroy(&ccr);
+        return (CC_RUNS *)ERROR_PTR("parent not made", procName, NULL);
+    }
+    for (i = 0; i < nstrips; i++) {
+        strip = &ccr->strips[i];
+        for (j = 0; j < strip->nruns; j++)
+            parent[strip->offset + j] = strip->parent[j] + strip->offset;
+        FREE(strip->parent);
+        strip->parent = NULL;
+    }
+    for (i = 1; i < nstrips; i++) {
+        sprev = &ccr->strips[i - 1];
+        strip = &ccr->strips[i];
+        if (sprev->y1 == sprev->y0 || strip->y1 == strip->y0)
+            continue;
+        connCompJoinRows(parent, connectivity,
+                         sprev->xstart, sprev->xend, sprev->offset,
+                         sprev->rowstart[sprev->y1 - sprev->y0 - 1],
+                         sprev->rowstart[sprev->y1 - sprev->y0],
+                         strip->xstart, strip->xend, strip->offset,
+                         strip->rowstart[0], strip->rowstart[1]);
+    }
+
+        /* Replace each parent by the label of its c.c. */
+    ncomp = 0;
+    for (i = 0; i < nruns; i++) {
+        if (parent[i] == i)
+            parent[i] = ncomp++;
+        else
+            parent[i] = parent[parent[i]];
+    }
+    ccr->label = parent;
+    ccr->ncomp = ncomp;
+    return ccr;
+}
+
+
+/*!
+ *  connCompRunsDestroy()
+ *
+ *      Input:  &ccr (<will be set to null before returning>)
+ *      Return: void
+ */
+static void
+connCompRunsDestroy(CC_RUNS  **pccr)
+{
+l_int32   i;
+CC_RUNS  *ccr;
+
+    if (!pccr || (ccr = *pccr) == NULL)
+        return;
+    if (ccr->strips) {
+        for (i = 0; i < ccr->nstrips; i++) {
+            if (ccr->strips[i].xstart) FREE(ccr->strips[i].xstart);
+            if (ccr->strips[i].xend) FREE(ccr->strips[i].xend);
+            if (ccr->strips[i].parent) FREE(ccr->strips[i].parent);
+            if (ccr->strips[i].rowstart) FREE(ccr->strips[i].rowstart);
+        }
+        FREE(ccr->strips);
+    }
+    if (ccr->label) FREE(ccr->label);
+    if (ccr->minx) FREE(ccr->minx);
+    if (ccr->miny) FREE(ccr->miny);
+    if (ccr->pixarray) FREE(ccr->pixarray);
+    pixDestroy(&ccr->pixd);
+    FREE(ccr);
+    *pccr = NULL;
+    return;
+}
+
+
+/*!
+ *  connCompStripJob()
+ *
+ *      Input:  data (ccr)
+ *              index (of the strip)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Finds the runs of ON pixels in each line of the strip,
+ *          and joins each run to the touching runs in the previous
+ *          line of the strip.  The forest uses indices local to
+ *          the strip.
+ */
+static l_int32
+connCompStripJob(void    *data,
+                 l_int32  index)
+{
+l_int32    i, j, y, w, wpl, nwords, bitpos, inrun, start, nrows, n, maxruns;
+l_uint32   word, lastmask, v;
+l_uint32  *line;
+CC_RUNS   *ccr;
+CC_STRIP  *strip;
+
+    PROCNAME("connCompStripJob");
+
+    ccr = (CC_RUNS *)data;
+    strip = &ccr->strips[index];
+    w = ccr->w;
+    wpl = ccr->wpls;
+    nwords = (w + 31) / 32;
+    lastmask = (w & 31) ? 0xffffffff << (32 - (w & 31)) : 0xffffffff;
+    nrows = strip->y1 - strip->y0;
+    maxruns = (w + 1) / 2;  /* in one line */
+    strip->nalloc = L_MAX(64, maxruns);
+    strip->xstart = (l_int32 *)CALLOC(strip->nalloc, sizeof(l_int32));
+    strip->xend = (l_int32 *)CALLOC(strip->nalloc, sizeof(l_int32));
+    strip->parent = (l_int32 *)CALLOC(strip->nalloc, sizeof(l_int32));
+    strip->rowstart = (l_int32 *)CALLOC(nrows + 1, sizeof(l_int32));
+    if (!strip->xstart || !strip->xend || !strip->parent || !strip->rowstart)
+        return ERROR_INT("strip arrays not made", procName, 1);
+
+    n = 0;
+    for (y = strip->y0; y < strip->y1; y++) {
+        if (n + maxruns > strip->nalloc) {
+            if (connCompStripExtend(strip, 2 * (n + maxruns)))
+                return ERROR_INT("strip arrays not extended", procName, 1);
+        }
+        strip->rowstart[y - strip->y0] = n;
+        line = ccr->datas + y * wpl;
+        inrun = FALSE;
+        start = 0;
+        for (j = 0; j < nwords; j++) {
+            word = line[j];
+            if (j == nwords - 1)
+                word &= lastmask;
+            if ((!inrun && word == 0) || (inrun && word == 0xffffffff))
+                continue;
+            bitpos = 0;
+            while (bitpos < 32) {
+                if (!inrun) {  /* look for the next ON pixel */
+                    v = word << bitpos;
+                    if (v == 0) break;
+                    bitpos += connCompLeadingZeros(v);
+                    start = 32 * j + bitpos;
+                    inrun = TRUE;
+                } else {  /* look for the next OFF pixel */
+                    v = ~word << bitpos;
+                    if (v == 0) break;
+                    bitpos += connCompLeadingZeros(v);
+                    strip->xstart[n] = start;
+                    strip->xend[n] = 32 * j + bitpos - 1;
+                    strip->parent[n] = n;
+                    n++;
+                    inrun = FALSE;
+                }
+            }
+        }
+        if (inrun) {
+            strip->xstart[n] = start;
+            strip->xend[n] = w - 1;
+            strip->parent[n] = n;
+            n++;
+        }
+
+        if (y > strip->y0) {
+            i = y - strip->y0;
+            connCompJoinRows(strip->parent, ccr->connectivity,
+                             strip->xstart, strip->xend, 0,
+                             strip->rowstart[i - 1], strip->rowstart[i],
+                             strip->xstart, strip->xend, 0,
+                             strip->rowstart[i], n);
+        }
+    }
+    strip->rowstart[nrows] = n;
+    strip->nruns = n;
+    return 0;
+}
+
+
+/*!
+ *  connCompStripExtend()
+ *
+ *      Input:  strip
+ *              size (new size of the run arrays)
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+connCompStripExtend(CC_STRIP  *strip,
+                    l_int32    size)
+{
+l_int32  oldbytes, newbytes;
+
+    PROCNAME("connCompStripExtend");
+
+    oldbytes = strip->nalloc * sizeof(l_int32);
+    newbytes = size * sizeof(l_int32);
+    if ((strip->xstart = (l_int32 *)reallocNew((void **)&strip->xstart,
+                                  oldbytes, newbytes)) == NULL)
+        return ERROR_INT("new xstart not made", procName, 1);
+    if ((strip->xend = (l_int32 *)reallocNew((void **)&strip->xend,
+                                  oldbytes, newbytes)) == NULL)
+        return ERROR_INT("new xend not made", procName, 1);
+    if ((strip->parent = (l_int32 *)reallocNew((void **)&strip->parent,
+                                  oldbytes, newbytes)) == NULL)
+        return ERROR_INT("new parent not made", procName, 1);
+    strip->nalloc = size;
+    return 0;
+}
+
+
+/*!
+ *  connCompJoinRows()
+ *
+ *      Input:  parent (union-find forest)
+ *              connectivity (4 or 8)
+ *              xs1, xe1, off1 (run arrays and index offset for the
+ *                              upper line)
+ *              i1, n1 (first run and one past the last run in upper line)
+ *              xs2, xe2, off2 (run arrays and index offset for the
+ *                              lower line)
+ *              i2, n2 (first run and one past the last run in lower line)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The runs in each line are ordered and disjoint, so a merge
+ *          finds all touching pairs.  With 8-connectivity, runs touch
+ *          if they overlap or are diagonally adjacent.
+ *      (2) Roots are joined so that the smaller index is the root.
+ */
+static void
+connCompJoinRows(l_int32  *parent,
+                 l_int32   connectivity,
+                 l_int32  *xs1,
+                 l_int32  *xe1,
+                 l_int32   off1,
+                 l_int32   i1,
+                 l_int32   n1,
+                 l_int32  *xs2,
+                 l_int32  *xe2,
+                 l_int32   off2,
+                 l_int32   i2,
+                 l_int32   n2)
+{
+l_int32  d, r1, r2;
+
+    d = (connectivity == 8) ? 1 : 0;
+    while (i1 < n1 && i2 < n2) {
+        if (xs1[i1] <= xe2[i2] + d && xs2[i2] <= xe1[i1] + d) {
+            r1 = connCompFindRoot(parent, i1 + off1);
+            r2 = connCompFindRoot(parent, i2 + off2);
+            if (r1 < r2)
+                parent[r2] = r1;
+            else if (r2 < r1)
+                parent[r1] = r2;
+        }
+        if (xe1[i1] < xe2[i2])
+            i1++;
+        else
+            i2++;
+    }
+    return;
+}
+
+
+/*!
+ *  connCompFindRoot()
+ *
+ *      Input:  parent (union-find forest)
+ *              index
+ *      Return: root of the tree containing @index
+ *
+ *  Notes:
+ *      (1) Uses path halving, which keeps every parent index no larger
+ *          than the index of its child.
+ */
+static l_int32
+connCompFindRoot(l_int32  *parent,
+                 l_int32   index)
+{
+    while (parent[index] != index) {
+        parent[index] = parent[parent[index]];
+        index = parent[index];
+    }
+    return index;
+}
+
+
+/*!
+ *  connCompLeadingZeros()
+ *
+ *      Input:  word (nonzero)
+ *      Return: number of 0 bits before the first ON bit, starting at the MSB
+ */
+static l_int32
+connCompLeadingZeros(l_uint32  word)
+{
+l_int32  n;
+
+#if defined(__GNUC__)
+    n = __builtin_clz(word);
+#else
+    n = 0;
+    if ((word & 0xffff0000) == 0) { n += 16; word <<= 16; }
+    if ((word & 0xff000000) == 0) { n += 8; word <<= 8; }
+    if ((word & 0xf0000000) == 0) { n += 4; word <<= 4; }
+    if ((word & 0xc0000000) == 0) { n += 2; word <<= 2; }
+    if ((word & 0x80000000) == 0) { n += 1; }
+#endif  /* __GNUC__ */
+    return n;
+}
+
+
+/*!
+ *  connCompPaintJob()
+ *
+ *      Input:  data (ccr)
+ *              index (of the strip)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Paints the runs of the strip into the c.c. images and the
+ *          label image, whichever are requested.  A line of any image
+ *          is written by only one strip, so the strips can be painted
+ *          concurrently.
+ */
+static l_int32
+connCompPaintJob(void    *data,
+                 l_int32  index)
+{
+l_int32    j, x, y, comp, label, bx, by, wpl, wpld;
+l_uint32  *line, *lined, *datad;
+CC_RUNS   *ccr;
+CC_STRIP  *strip;
+PIX       *pix;
+
+    ccr = (CC_RUNS *)data;
+    strip = &ccr->strips[index];
+    datad = (ccr->pixd) ? pixGetData(ccr->pixd) : NULL;
+    wpld = (ccr->pixd) ? pixGetWpl(ccr->pixd) : 0;
+    for (y = strip->y0; y < strip->y1; y++) {
+        lined = (datad) ? datad + y * wpld : NULL;
+        for (j = strip->rowstart[y - strip->y0];
+             j < strip->rowstart[y - strip->y0 + 1]; j++) {
+            comp = ccr->label[strip->offset + j];
+            if (lined) {
+                label = comp + 1;
+                for (x = strip->xstart[j]; x <= strip->xend[j]; x++)
+                    lined[x] = label;
+            }
+            if (ccr->pixarray) {
+                pix = ccr->pixarray[comp];
+                bx = ccr->minx[comp];
+                by = ccr->miny[comp];
+                wpl = pixGetWpl(pix);
+                line = pixGetData(pix) + (y - by) * wpl;
+                connCompSetRun(line, strip->xstart[j] - bx,
+                               strip->xend[j] - bx);
+            }
+        }
+    }
+    return 0;
+}
+
+
+/*!
+ *  connCompSetRun()
+ *
+ *      Input:  line (of a 1 bpp image)
+ *              x1, x2 (first and last pixel of the run to be set)
+ *      Return: void
+ */
+static void
+connCompSetRun(l_uint32  *line,
+               l_int32    x1,
+               l_int32    x2)
+{
+l_int32   j, j1, j2;
+l_uint32  mask1, mask2;
+
+    j1 = x1 >> 5;
+    j2 = x2 >> 5;
+    mask1 = 0xffffffff >> (x1 & 31);
+    mask2 = 0xffffffff << (31 - (x2 & 31));
+    if (j1 == j2) {
+        line[j1] |= mask1 & mask2;
+        return;
+    }
+    line[j1] |= mask1;
+    for (j = j1 + 1; j < j2; j++)
+        line[j] = 0xffffffff;
+    line[j2] |= mask2;
+    return;
+}
@@ -43,6 +43,7 @@
  *
  *      Tiled grayscale or color block convolution
  *          PIX          *pixBlockconvTiled()
+ *          static l_int32  blockconvTile()
  *          PIX          *pixBlockconvGrayTile()
  *
  *      Convolution for mean, mean square, variance and rms deviation
@@ -71,6 +72,13 @@
  *          FPIX         *fpixConvolve()
  *          FPIX         *fpixConvolveSep()
  *
+ *      Recursive gaussian convolution
+ *          PIX          *pixGaussianBlur()
+ *          FPIX         *fpixGaussianBlur()
+ *          static l_int32  gaussRecursiveInit()
+ *          static l_int32  gaussRecursiveLow()
+ *          static void   gaussLine()
+ *
  *      Convolution with bias (for non-negative output)
  *          PIX          *pixConvolveWithBias()
  *
@@ -82,8 +90,12 @@
  *          l_float32     gaussDistribSampling()
  */
 
+#include <string.h>
 #include <math.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
 
     /* These globals determine the subsampling factors for
      * generic convolution of pix and fpix.  Declare extern to use.
@@ -101,6 +113,48 @@ static void blockconvAccumLow(l_uint32 *datad, l_int32 w, l_int32 h,
 static void blocksumLow(l_uint32 *datad, l_int32 w, l_int32 h, l_int32 wpl,
                         l_uint32 *dataa, l_int32 wpla, l_int32 wc, l_int32 hc);
 
+    /* Destination and kernel for the tiles of pixBlockconvTiled() */
+struct BlockconvTiling
+{
+    PIX       *pixd;
+    l_int32    wc;
+    l_int32    hc;
+};
+typedef struct BlockconvTiling  BLOCKCONV_TILING;
+
+static l_int32 blockconvTile(PIXTILING *pt, PIX *pixt, l_int32 i,
+                             l_int32 j, void *data);
+
+    /* Number of rows filtered together in the horizontal direction
+     * by the recursive gaussian */
+static const l_int32  GAUSS_STRIP = 16;
+
+    /* Coefficients of the recursive gaussian filter */
+struct GaussRecursive
+{
+    l_float64  b;          /* gain on the input value                  */
+    l_float64  a1;         /* feedback from 1 step back                */
+    l_float64  a2;         /* feedback from 2 steps back               */
+    l_float64  a3;         /* feedback from 3 steps back               */
+    l_float64  m[3][3];    /* starting values of the backward filter   */
+};
+typedef struct GaussRecursive  GAUSS_RECURSIVE;
+
+static l_int32 gaussRecursiveInit(GAUSS_RECURSIVE *gr, l_float32 sigma);
+static l_int32 gaussRecursiveLow(l_float64 *data, l_int32 n, l_int32 m,
+                                 l_int32 stride, GAUSS_RECURSIVE *gr);
+static void gaussLine(l_float64 *line, l_float64 *p1, l_float64 *p2,
+                      l_float64 *p3, l_int32 m, l_float64 b, l_float64 a1,
+                      l_float64 a2, l_float64 a3, l_int32 level);
+#if USE_SIMD
+static l_int32 gaussLineSSE2(l_float64 *line, l_float64 *p1, l_float64 *p2,
+                             l_float64 *p3, l_int32 m, l_float64 b,
+                             l_float64 a1, l_float64 a2, l_float64 a3);
+static l_int32 gaussLineAVX2(l_float64 *line, l_float64 *p1, l_float64 *p2,
+                             l_float64 *p3, l_int32 m, l_float64 b,
+                             l_float64 a1, l_float64 a2, l_float64 a3);
+#endif  /* USE_SIMD */
+
 
 /*----------------------------------------------------------------------*
  *             Top-level grayscale or color block convolution           *
@@ -707,7 +761,9 @@ PIX       *pixsb, *pixacc, *pixd;
  *          (b) The accumulator array for 16M pixels is 64 MB; using
  *              tiles reduces the size of this array.
  *          (c) Each tile can be processed independently, in parallel,
- *              on a multicore processor.
+ *              on a multicore processor.  The tiles are distributed
+ *              over the default number of threads, which is set by
+ *              l_setNumThreads().
  */
 PIX *
 pixBlockconvTiled(PIX     *pix,
@@ -716,10 +772,10 @@ pixBlockconvTiled(PIX     *pix,
                   l_int32  nx,
                   l_int32  ny)
 {
-l_int32     i, j, w, h, d, xrat, yrat;
-PIX        *pixs, *pixd, *pixc, *pixt;
-PIX        *pixr, *pixrc, *pixg, *pixgc, *pixb, *pixbc;
-PIXTILING  *pt;
+l_int32           w, h, d, xrat, yrat;
+PIX              *pixs, *pixd;
+PIXTILING        *pt;
+BLOCKCONV_TILING  bt;
 
     PROCNAME("pixBlockconvTiled");
 
@@ -779,41 +835,69 @@ PIXTILING  *pt;
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
     }
     pt = pixTilingCreate(pixs, nx, ny, 0, 0, wc + 2, hc + 2);
-    for (i = 0; i < ny; i++) {
-        for (j = 0; j < nx; j++) {
-            pixt = pixTilingGetTile(pt, i, j);
-
-                /* Convolve over the tile */
-            if (d == 8) {
-                pixc = pixBlockconvGrayTile(pixt, NULL, wc, hc);
-            } else { /* d == 32 */
-                pixr = pixGetRGBComponent(pixt, COLOR_RED);
-                pixrc = pixBlockconvGrayTile(pixr, NULL, wc, hc);
-                pixDestroy(&pixr);
-                pixg = pixGetRGBComponent(pixt, COLOR_GREEN);
-                pixgc = pixBlockconvGrayTile(pixg, NULL, wc, hc);
-                pixDestroy(&pixg);
-                pixb = pixGetRGBComponent(pixt, COLOR_BLUE);
-                pixbc = pixBlockconvGrayTile(pixb, NULL, wc, hc);
-                pixDestroy(&pixb);
-                pixc = pixCreateRGBImage(pixrc, pixgc, pixbc);
-                pixDestroy(&pixrc);
-                pixDestroy(&pixgc);
-                pixDestroy(&pixbc);
-            }
-
-            pixTilingPaintTile(pixd, i, j, pixc, pt);
-            pixDestroy(&pixt);
-            pixDestroy(&pixc);
-        }
-    }
+    bt.pixd = pixd;
+    bt.wc = wc;
+    bt.hc = hc;
+    if (pixTilingExecute(pt, blockconvTile, &bt, 0))
+        pixDestroy(&pixd);
 
     pixDestroy(&pixs);
     pixTilingDestroy(&pt);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("tiles not all convolved", procName, NULL);
     return pixd;
 }
 
 
+/*!
+ *  blockconvTile()
+ *
+ *      Input:  pt, pixt (8 or 32 bpp tile), i, j (tile row and column)
+ *              data (BLOCKCONV_TILING)
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+blockconvTile(PIXTILING  *pt,
+              PIX        *pixt,
+              l_int32     i,
+              l_int32     j,
+              void       *data)
+{
+l_int32            wc, hc, ret;
+PIX               *pixc, *pixr, *pixrc, *pixg, *pixgc, *pixb, *pixbc;
+BLOCKCONV_TILING  *bt;
+
+    bt = (BLOCKCONV_TILING *)data;
+    wc = bt->wc;
+    hc = bt->hc;
+
+        /* Convolve over the tile */
+    if (pixGetDepth(pixt) == 8) {
+        pixc = pixBlockconvGrayTile(pixt, NULL, wc, hc);
+    } else { /* d == 32 */
+        pixr = pixGetRGBComponent(pixt, COLOR_RED);
+        pixrc = pixBlockconvGrayTile(pixr, NULL, wc, hc);
+        pixDestroy(&pixr);
+        pixg = pixGetRGBComponent(pixt, COLOR_GREEN);
+        pixgc = pixBlockconvGrayTile(pixg, NULL, wc, hc);
+        pixDestroy(&pixg);
+        pixb = pixGetRGBComponent(pixt, COLOR_BLUE);
+        pixbc = pixBlockconvGrayTile(pixb, NULL, wc, hc);
+        pixDestroy(&pixb);
+        pixc = pixCreateRGBImage(pixrc, pixgc, pixbc);
+        pixDestroy(&pixrc);
+        pixDestroy(&pixgc);
+        pixDestroy(&pixbc);
+    }
+    if (!pixc)
+        return 1;
+
+    ret = pixTilingPaintTile(bt->pixd, i, j, pixc, pt);
+    pixDestroy(&pixc);
+    return ret;
+}
+
+
 /*!
  *  pixBlockconvGrayTile()
  *
@@ -957,6 +1041,10 @@ PIX       *pixt, *pixd;
  *          allows computation without special treatment of pixels near
  *          the image boundary, and runs in a time that is independent
  *          of the size of the convolution kernel.
+ *      (6) The mean and mean square are both found from a single
+ *          integral image.  To get statistics for several window sizes,
+ *          or without adding a border, make the integral image with
+ *          l_integralCreate() and use l_integralWindowedStats().
  */
 l_int32
 pixWindowedStats(PIX     *pixs,
@@ -968,7 +1056,9 @@ pixWindowedStats(PIX     *pixs,
                  FPIX   **pfpixv,
                  FPIX   **pfpixrv)
 {
-PIX  *pixb, *pixm, *pixms;
+l_int32      needm, needms, ret;
+L_INTEGRAL  *li;
+PIX         *pixb, *pixm, *pixms;
 
     PROCNAME("pixWindowedStats");
 
@@ -989,16 +1079,20 @@ PIX  *pixb, *pixm, *pixms;
     else
         pixb = pixClone(pixs);
 
-    if (!pfpixv && !pfpixrv) {
-        if (ppixm) *ppixm = pixWindowedMean(pixb, wc, hc, 1, 1);
-        if (ppixms) *ppixms = pixWindowedMeanSquare(pixb, wc, hc, 1);
-        pixDestroy(&pixb);
-        return 0;
-    }
+        /* Make one integral image for both the mean and mean square */
+    needm = (ppixm || pfpixv || pfpixrv);
+    needms = (ppixms || pfpixv || pfpixrv);
+    li = l_integralCreate(pixb, needms);
+    pixDestroy(&pixb);
+    if (!li)
+        return ERROR_INT("li not made", procName, 1);
+    pixm = pixms = NULL;
+    ret = l_integralWindowedStats(li, wc, hc, 1, (needm) ? &pixm : NULL,
+                                  (needms) ? &pixms : NULL, NULL, NULL);
+    l_integralDestroy(&li);
+    if (!ret && (pfpixv || pfpixrv))
+        ret = pixWindowedVariance(pixm, pixms, pfpixv, pfpixrv);
 
-    pixm = pixWindowedMean(pixb, wc, hc, 1, 1);
-    pixms = pixWindowedMeanSquare(pixb, wc, hc, 1);
-    pixWindowedVariance(pixm, pixms, pfpixv, pfpixrv);
     if (ppixm)
         *ppixm = pixm;
     else
@@ -1007,8 +1101,7 @@ PIX  *pixb, *pixm, *pixms;
         *ppixms = pixms;
     else
         pixDestroy(&pixms);
-    pixDestroy(&pixb);
-    return 0;
+    return ret;
 }
 
 
@@ -1035,7 +1128,8 @@ PIX  *pixb, *pixm, *pixms;
  *          within the window, rather than a normalized convolution,
  *          use @normflag == 0.
  *      (4) This builds a block accumulator pix, uses it here, and
- *          destroys it.
+ *          destroys it.  To reuse the sums for other windows, use
+ *          l_integralWindowedStats().
  *      (5) The added border, along with the use of an accumulator array,
  *          allows computation without special treatment of pixels near
  *          the image boundary, and runs in a time that is independent
@@ -2260,6 +2354,468 @@ FPIX      *fpixt, *fpixd;
 }
 
 
+/*----------------------------------------------------------------------*
+ *                      Recursive gaussian convolution                   *
+ *----------------------------------------------------------------------*/
+/*!
+ *  pixGaussianBlur()
+ *
+ *      Input:  pixs (8 or 32 bpp; or 2, 4 or 8 bpp with colormap)
+ *              sigmax, sigmay (standard deviation of the gaussian,
+ *                              in pixels, in each direction)
+ *      Return: pixd (8 or 32 bpp), or null on error
+ *
+ *  Notes:
+ *      (1) This approximates convolution with a gaussian using a
+ *          recursive filter, so the time per pixel does not depend
+ *          on sigma.  It is much faster than pixConvolveSep() with a
+ *          kernel from makeGaussianKernelSep() for sigma larger than
+ *          about 2, and is intended for the large sigma used in
+ *          shading correction and unsharp masking.
+ *      (2) The image is taken to be extended by replicating the
+ *          boundary pixels.  See fpixGaussianBlur().
+ *      (3) The colormap is removed.  For 32 bpp, each component is
+ *          blurred separately, and the alpha component, if any,
+ *          is copied.
+ */
+PIX *
+pixGaussianBlur(PIX       *pixs,
+                l_float32  sigmax,
+                l_float32  sigmay)
+{
+l_int32  d, i;
+FPIX    *fpix1, *fpix2;
+PIX     *pixt, *pix1, *pix2, *pixc[3], *pixd;
+
+    PROCNAME("pixGaussianBlur");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    d = pixGetDepth(pixs);
+    if (d != 8 && d != 32 && !pixGetColormap(pixs))
+        return (PIX *)ERROR_PTR("pixs not 8 or 32 bpp or cmapped",
+                                procName, NULL);
+    if (sigmax < 0.0 || sigmay < 0.0)
+        return (PIX *)ERROR_PTR("sigmax and sigmay not >= 0.0",
+                                procName, NULL);
+
+    if ((pixt = pixConvertTo8Or32(pixs, L_CLONE, 0)) == NULL)
+        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+    if (pixGetDepth(pixt) == 8) {
+        fpix1 = pixConvertToFPix(pixt, 1);
+        fpix2 = fpixGaussianBlur(fpix1, sigmax, sigmay);
+        pixd = fpixConvertToPix(fpix2, 8, L_CLIP_TO_ZERO, 0);
+        fpixDestroy(&fpix1);
+        fpixDestroy(&fpix2);
+    } else {
+        for (i = 0; i < 3; i++) {
+            pix1 = pixGetRGBComponent(pixt, COLOR_RED + i);
+            fpix1 = pixConvertToFPix(pix1, 1);
+            fpix2 = fpixGaussianBlur(fpix1, sigmax, sigmay);
+            pixc[i] = fpixConvertToPix(fpix2, 8, L_CLIP_TO_ZERO, 0);
+            pixDestroy(&pix1);
+            fpixDestroy(&fpix1);
+            fpixDestroy(&fpix2);
+        }
+        pixd = pixCreateRGBImage(pixc[0], pixc[1], pixc[2]);
+        for (i = 0; i < 3; i++)
+            pixDestroy(&pixc[i]);
+        if (pixd && pixGetSpp(pixt) == 4) {
+            pix2 = pixGetRGBComponent(pixt, L_ALPHA_CHANNEL);
+            pixSetRGBComponent(pixd, pix2, L_ALPHA_CHANNEL);
+            pixSetSpp(pixd, 4);
+            pixDestroy(&pix2);
+        }
+    }
+
+    pixDestroy(&pixt);
+    if (!pixd)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    pixCopyResolution(pixd, pixs);
+    pixCopyInputFormat(pixd, pixs);
+    return pixd;
+}
+
+
+/*!
+ *  fpixGaussianBlur()
+ *
+ *      Input:  fpixs
+ *              sigmax, sigmay (standard deviation of the gaussian,
+ *                              in pixels, in each direction)
+ *      Return: fpixd, or null on error
+ *
+ *  Notes:
+ *      (1) This uses the third-order recursive filter of Young and
+ *          van Vliet, "Recursive implementation of the Gaussian filter",
+ *          Signal Processing 44 (1995), pp. 139-151.  It is applied
+ *          forward and then backward along each line, first in the
+ *          vertical and then in the horizontal direction.  The cost
+ *          is about 16 multiply-adds per pixel, for any sigma.
+ *      (2) The approximation to the gaussian is best for sigma >= 1.
+ *          There is no smoothing in a direction where sigma < 0.5.
+ *      (3) At the image boundary, the input is taken to be extended
+ *          by replicating the boundary values.  The starting values
+ *          of the backward filter for this extension are found as
+ *          in Triggs and Sdika, "Boundary conditions for Young-van
+ *          Vliet recursive filtering", IEEE Trans. Signal Processing
+ *          54 (2006), pp. 2365-2367.  In particular, a constant image
+ *          is unchanged.
+ *      (4) The image is filtered in strips of GAUSS_STRIP columns
+ *          (vertically) or rows (horizontally), which are copied to
+ *          a buffer so that the values to be updated together are
+ *          adjacent.  The work is in double precision, because the
+ *          filter gain is very small for large sigma.  The operation
+ *          on each line of the strip has SSE2 and AVX2 versions, which
+ *          give exactly the same result as the portable version.
+ */
+FPIX *
+fpixGaussianBlur(FPIX      *fpixs,
+                 l_float32  sigmax,
+                 l_float32  sigmay)
+{
+l_int32           w, h, wpl, i, j, k, ns, ret;
+l_float32        *data, *line;
+l_float64        *buf;
+FPIX             *fpixd;
+GAUSS_RECURSIVE   gr;
+
+    PROCNAME("fpixGaussianBlur");
+
+    if (!fpixs)
+        return (FPIX *)ERROR_PTR("fpixs not defined", procName, NULL);
+    if (sigmax < 0.0 || sigmay < 0.0)
+        return (FPIX *)ERROR_PTR("sigmax and sigmay not >= 0.0",
+                                 procName, NULL);
+
+    if ((fpixd = fpixCopy(NULL, fpixs)) == NULL)
+        return (FPIX *)ERROR_PTR("fpixd not made", procName, NULL);
+    fpixGetDimensions(fpixd, &w, &h);
+    data = fpixGetData(fpixd);
+    wpl = fpixGetWpl(fpixd);
+    if ((buf = (l_float64 *)CALLOC(GAUSS_STRIP * L_MAX(w, h),
+                                   sizeof(l_float64))) == NULL) {
+        fpixDestroy(&fpixd);
+        return (FPIX *)ERROR_PTR("buf not made", procName, NULL);
+    }
+
+        /* Vertical, on strips of GAUSS_STRIP columns */
+    ret = 0;
+    if (sigmay >= 0.5) {
+        ret = gaussRecursiveInit(&gr, sigmay);
+        for (j = 0; j < w && !ret; j += GAUSS_STRIP) {
+            ns = L_MIN(GAUSS_STRIP, w - j);
+            for (i = 0; i < h; i++) {
+                line = data + i * wpl + j;
+                for (k = 0; k < ns; k++)
+                    buf[i * GAUSS_STRIP + k] = line[k];
+            }
+            ret = gaussRecursiveLow(buf, h, ns, GAUSS_STRIP, &gr);
+            for (i = 0; i < h; i++) {
+                line = data + i * wpl + j;
+                for (k = 0; k < ns; k++)
+                    line[k] = (l_float32)buf[i * GAUSS_STRIP + k];
+            }
+        }
+    }
+
+        /* Horizontal, on strips of GAUSS_STRIP rows */
+    if (sigmax >= 0.5 && !ret) {
+        ret = gaussRecursiveInit(&gr, sigmax);
+        for (i = 0; i < h && !ret; i += GAUSS_STRIP) {
+            ns = L_MIN(GAUSS_STRIP, h - i);
+            for (k = 0; k < ns; k++) {
+                line = data + (i + k) * wpl;
+                for (j = 0; j < w; j++)
+                    buf[j * GAUSS_STRIP + k] = line[j];
+            }
+            ret = gaussRecursiveLow(buf, w, ns, GAUSS_STRIP, &gr);
+            for (k = 0; k < ns; k++) {
+                line = data + (i + k) * wpl;
+                for (j = 0; j < w; j++)
+                    line[j] = (l_float32)buf[j * GAUSS_STRIP + k];
+            }
+        }
+    }
+
+    FREE(buf);
+    if (ret) {
+        fpixDestroy(&fpixd);
+        return (FPIX *)ERROR_PTR("blur failed", procName, NULL);
+    }
+    return fpixd;
+}
+
+
+/*!
+ *  gaussRecursiveInit()
+ *
+ *      Input:  gr (filter coefficients, to be filled in)
+ *              sigma (>= 0.5)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The forward filter is
+ *              w[n] = b * x[n] + a1 * w[n-1] + a2 * w[n-2] + a3 * w[n-3]
+ *          and the backward filter, y[n], is the same with the indices
+ *          reversed and w as input.  Because b = 1 - a1 - a2 - a3,
+ *          a constant input gives the same constant output.
+ *      (2) The coefficients are found from the poles of the filter, as
+ *          in the derivation of Young and van Vliet, rather than from
+ *          their rounded polynomials in q.  For large sigma, the poles
+ *          are close to 1 and the rounding in the polynomials makes the
+ *          filter much too wide.  Likewise, b is not found as
+ *          1 - a1 - a2 - a3, which would lose most of its precision.
+ *      (3) The deviations from a constant of the backward output at
+ *          the end of the line, and two values past it, are linear in
+ *          the deviations of the last three forward values.  The matrix
+ *          is found by running both filters on a long zero input from
+ *          each unit starting state.
+ */
+static l_int32
+gaussRecursiveInit(GAUSS_RECURSIVE  *gr,
+                   l_float32         sigma)
+{
+l_int32     i, k, n;
+l_float64   q, m0, m1, m2, m12, scale, a1, a2, a3, b;
+l_float64  *wv, *yv;
+
+    PROCNAME("gaussRecursiveInit");
+
+    if (sigma >= 2.5)
+        q = 0.98711 * sigma - 0.96330;
+    else
+        q = 3.97156 - 4.14554 * sqrt(1.0 - 0.26891 * sigma);
+    m0 = 1.16680;
+    m1 = 1.10783;
+    m2 = 1.40586;
+    m12 = m1 * m1 + m2 * m2;
+    scale = (m0 + q) * (m12 + 2.0 * m1 * q + q * q);
+    a1 = q * (2.0 * m0 * m1 + m12 + (2.0 * m0 + 4.0 * m1) * q + 3.0 * q * q) /
+         scale;
+    a2 = -q * q * (m0 + 2.0 * m1 + 3.0 * q) / scale;
+    a3 = q * q * q / scale;
+    b = m0 * m12 / scale;  /* = 1 - a1 - a2 - a3, without cancellation */
+    gr->b = b;
+    gr->a1 = a1;
+    gr->a2 = a2;
+    gr->a3 = a3;
+
+        /* The response decays by a factor of about e for each q values,
+         * so this is long enough for the matrix to be exact in floats */
+    n = 3 + (l_int32)(40.0 * q) + 40;
+    wv = (l_float64 *)CALLOC(n + 3, sizeof(l_float64));
+    yv = (l_float64 *)CALLOC(n + 3, sizeof(l_float64));
+    if (!wv || !yv) {
+        FREE(wv);
+        FREE(yv);
+        return ERROR_INT("wv and yv not made", procName, 1);
+    }
+    for (k = 0; k < 3; k++) {
+        for (i = 0; i < n + 3; i++)
+            wv[i] = yv[i] = 0.0;
+        wv[2 - k] = 1.0;  /* wv[2], wv[1], wv[0] are w[N-1], w[N-2], w[N-3] */
+        for (i = 3; i < n; i++)
+            wv[i] = a1 * wv[i - 1] + a2 * wv[i - 2] + a3 * wv[i - 3];
+        for (i = n - 1; i >= 2; i--)
+            yv[i] = b * wv[i] + a1 * yv[i + 1] + a2 * yv[i + 2] +
+                    a3 * yv[i + 3];
+        for (i = 0; i < 3; i++)
+            gr->m[i][k] = yv[2 + i];
+    }
+    FREE(wv);
+    FREE(yv);
+    return 0;
+}
+
+
+/*!
+ *  gaussRecursiveLow()
+ *
+ *      Input:  data (lines of filter input, replaced by the output)
+ *              n (number of lines)
+ *              m (number of values in each line)
+ *              stride (in floats, between lines)
+ *              gr (filter coefficients)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This filters across the lines: value j of the output
+ *          depends on value j of every line.  Each line is updated
+ *          from the three before it (going forward) or after it
+ *          (going back), so the work on a line is a vector operation.
+ *      (2) Lines before the first are taken to equal the first line,
+ *          which starts the forward filter in its steady state.  The
+ *          backward filter starts from the values given by the matrix
+ *          in @gr, with the last input line as the steady state.
+ */
+static l_int32
+gaussRecursiveLow(l_float64        *data,
+                  l_int32           n,
+                  l_int32           m,
+                  l_int32           stride,
+                  GAUSS_RECURSIVE  *gr)
+{
+l_int32     i, j, level;
+l_float64   b, a1, a2, a3, u, d1, d2, d3;
+l_float64  *line, *last, *extra1, *extra2, *p1, *p2, *p3;
+
+    PROCNAME("gaussRecursiveLow");
+
+    b = gr->b;
+    a1 = gr->a1;
+    a2 = gr->a2;
+    a3 = gr->a3;
+    level = l_getSimdLevel();
+    if ((last = (l_float64 *)CALLOC(3 * m, sizeof(l_float64))) == NULL)
+        return ERROR_INT("last not made", procName, 1);
+    extra1 = last + m;
+    extra2 = last + 2 * m;
+    memcpy(last, data + (n - 1) * stride, m * sizeof(l_float64));
+
+        /* Forward */
+    for (i = 0; i < n; i++) {
+        line = data + i * stride;
+        p1 = data + L_MAX(0, i - 1) * stride;
+        p2 = data + L_MAX(0, i - 2) * stride;
+        p3 = data + L_MAX(0, i - 3) * stride;
+        gaussLine(line, p1, p2, p3, m, b, a1, a2, a3, level);
+    }
+
+        /* Starting values for the backward filter: the last line
+         * and two lines past it */
+    line = data + (n - 1) * stride;
+    p2 = data + L_MAX(0, n - 2) * stride;
+    p3 = data + L_MAX(0, n - 3) * stride;
+    for (j = 0; j < m; j++) {
+        u = last[j];
+        d1 = line[j] - u;
+        d2 = p2[j] - u;
+        d3 = p3[j] - u;
+        extra1[j] = u + (gr->m[1][0] * d1 + gr->m[1][1] * d2 +
+                         gr->m[1][2] * d3);
+        extra2[j] = u + (gr->m[2][0] * d1 + gr->m[2][1] * d2 +
+                         gr->m[2][2] * d3);
+        last[j] = u + (gr->m[0][0] * d1 + gr->m[0][1] * d2 +
+                       gr->m[0][2] * d3);
+    }
+    memcpy(line, last, m * sizeof(l_float64));
+
+        /* Backward */
+    for (i = n - 2; i >= 0; i--) {
+        line = data + i * stride;
+        p1 = data + (i + 1) * stride;
+        p2 = (i + 2 < n) ? data + (i + 2) * stride : extra1;
+        p3 = (i + 3 < n) ? data + (i + 3) * stride :
+                           ((i + 3 == n) ? extra1 : extra2);
+        gaussLine(line, p1, p2, p3, m, b, a1, a2, a3, level);
+    }
+
+    FREE(last);
+    return 0;
+}
+
+
+/*!
+ *  gaussLine()
+ *
+ *      Input:  line (filter input, replaced by the output)
+ *              p1, p2, p3 (output lines 1, 2 and 3 steps back)
+ *              m (number of values)
+ *              b, a1, a2, a3 (filter coefficients)
+ *              level (simd level)
+ *      Return: void
+ */
+static void
+gaussLine(l_float64  *line,
+          l_float64  *p1,
+          l_float64  *p2,
+          l_float64  *p3,
+          l_int32     m,
+          l_float64   b,
+          l_float64   a1,
+          l_float64   a2,
+          l_float64   a3,
+          l_int32     level)
+{
+l_int32  j;
+
+    j = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2)
+        j = gaussLineAVX2(line, p1, p2, p3, m, b, a1, a2, a3);
+    else if (level == L_SIMD_SSE2)
+        j = gaussLineSSE2(line, p1, p2, p3, m, b, a1, a2, a3);
+#endif  /* USE_SIMD */
+    for (; j < m; j++)
+        line[j] = b * line[j] + a1 * p1[j] + a2 * p2[j] + a3 * p3[j];
+    return;
+}
+
+
+#if USE_SIMD
+    /* These return the number of values done; the rest are left for
+     * the portable code.  The operations are in the same order, and
+     * give the same result. */
+static l_int32  L_TARGET_SSE2
+gaussLineSSE2(l_float64  *line,
+              l_float64  *p1,
+              l_float64  *p2,
+              l_float64  *p3,
+              l_int32     m,
+              l_float64   b,
+              l_float64   a1,
+              l_float64   a2,
+              l_float64   a3)
+{
+l_int32  j;
+__m128d  vb, va1, va2, va3, v;
+
+    vb = _mm_set1_pd(b);
+    va1 = _mm_set1_pd(a1);
+    va2 = _mm_set1_pd(a2);
+    va3 = _mm_set1_pd(a3);
+    for (j = 0; j + 2 <= m; j += 2) {
+        v = _mm_mul_pd(vb, _mm_loadu_pd(line + j));
+        v = _mm_add_pd(v, _mm_mul_pd(va1, _mm_loadu_pd(p1 + j)));
+        v = _mm_add_pd(v, _mm_mul_pd(va2, _mm_loadu_pd(p2 + j)));
+        v = _mm_add_pd(v, _mm_mul_pd(va3, _mm_loadu_pd(p3 + j)));
+        _mm_storeu_pd(line + j, v);
+    }
+    return j;
+}
+
+
+static l_int32  L_TARGET_AVX2
+gaussLineAVX2(l_float64  *line,
+              l_float64  *p1,
+              l_float64  *p2,
+              l_float64  *p3,
+              l_int32     m,
+              l_float64   b,
+              l_float64   a1,
+              l_float64   a2,
+              l_float64   a3)
+{
+l_int32  j;
+__m256d  vb, va1, va2, va3, v;
+
+    vb = _mm256_set1_pd(b);
+    va1 = _mm256_set1_pd(a1);
+    va2 = _mm256_set1_pd(a2);
+    va3 = _mm256_set1_pd(a3);
+    for (j = 0; j + 4 <= m; j += 4) {
+        v = _mm256_mul_pd(vb, _mm256_loadu_pd(line + j));
+        v = _mm256_add_pd(v, _mm256_mul_pd(va1, _mm256_loadu_pd(p1 + j)));
+        v = _mm256_add_pd(v, _mm256_mul_pd(va2, _mm256_loadu_pd(p2 + j)));
+        v = _mm256_add_pd(v, _mm256_mul_pd(va3, _mm256_loadu_pd(p3 + j)));
+        _mm256_storeu_pd(line + j, v);
+    }
+    return j;
+}
+#endif  /* USE_SIMD */
+
+
 /*------------------------------------------------------------------------*
  *              Convolution with bias (for non-negative output)           *
  *------------------------------------------------------------------------*/
@@ -38,6 +38,17 @@
  *         l_int32     pixCorrelationScoreSimple()
  *         l_int32     pixCorrelationScoreShifted()
  *
+ *     2 pix correlator over a range of shifts
+ *         l_int32     pixCorrelationScoreShifts()
+ *         l_int32    *pixCorrelationMakeDowncount()
+ *
+ *     Static helpers for counting the AND of two 1 bpp images
+ *         static l_int32     correlCountShifts()
+ *         static l_int32     correlCount()
+ *         static l_int32     correlCountPOPCNT()
+ *         static l_int32     correlRoundShift()
+ *         static l_float32   correlScore()
+ *
  *     There are other, more application-oriented functions, that
  *     compute the correlation between two binary images, taking into
  *     account small translational shifts, between two binary images.
@@ -51,6 +62,47 @@
 #include <math.h>
 #include "allheaders.h"
 
+    /* Largest shift in each direction for which the arrays of
+     * pixCorrelationScoreShifts() are on the stack */
+#define  MAX_CORREL_SHIFT   8
+#define  MAX_CORREL_SHIFTS  (2 * MAX_CORREL_SHIFT + 1)
+
+    /* For one horizontal placement of pix2 relative to pix1, this gives
+     * the range of words in a row of pix1 that overlap pix2, the masks
+     * for the first and last of these words, and the location in pix2
+     * of the bits that fall under word x of pix1: they start at bit
+     * 'bshift' of word (x + koff). */
+struct CorrelShift
+{
+    l_int32     xlo;        /* first word of pix1 overlapping pix2       */
+    l_int32     xhi;        /* 1 + last word of pix1 overlapping pix2    */
+    l_int32     koff;       /* word offset from pix1 to pix2             */
+    l_int32     bshift;     /* bit offset, in [0 ... 31]                 */
+    l_uint32    lmask;      /* mask for word xlo of pix1                 */
+    l_uint32    rmask;      /* mask for word xhi - 1 of pix1             */
+};
+typedef struct CorrelShift  CORREL_SHIFT;
+
+static l_int32 correlCountShifts(PIX *pix1, PIX *pix2, l_int32 *dx,
+                                 l_int32 nx, l_int32 *dy, l_int32 ny,
+                                 l_int32 *downcount, l_int32 mincount,
+                                 l_int32 acceptcount, CORREL_SHIFT *cs,
+                                 l_int32 *counts);
+static l_int32 correlCount(l_uint32 *data1, l_int32 wpl1, l_uint32 *data2,
+                           l_int32 wpl2, CORREL_SHIFT *cs, l_int32 dy,
+                           l_int32 ylo, l_int32 yhi, l_int32 *downcount,
+                           l_int32 mincount, l_int32 acceptcount);
+static l_int32 correlRoundShift(l_float32 del);
+static l_float32 correlScore(l_int32 count, l_int32 area1, l_int32 area2);
+
+#if USE_SIMD
+static l_int32 correlCountPOPCNT(l_uint32 *data1, l_int32 wpl1,
+                                 l_uint32 *data2, l_int32 wpl2,
+                                 CORREL_SHIFT *cs, l_int32 dy, l_int32 ylo,
+                                 l_int32 yhi, l_int32 *downcount,
+                                 l_int32 mincount, l_int32 acceptcount);
+#endif  /* USE_SIMD */
+
 
 /* -------------------------------------------------------------------- *
  *           Optimized 2 pix correlators (for jbig2 clustering)         *
@@ -66,7 +118,7 @@
  *              dely   (y comp of centroid difference)
  *              maxdiffw (max width difference of pix1 and pix2)
  *              maxdiffh (max height difference of pix1 and pix2)
- *              tab    (sum tab for byte)
+ *              tab    (not used; can be NULL; see note below)
  *              &score (<return> correlation score)
  *      Return: 0 if OK, 1 on error
  *
@@ -115,8 +167,15 @@
  *      pixDestroy(&pixt);
  *  However, here it is done in a streaming fashion, counting as it goes,
  *  and touching memory exactly once, giving a 3-4x speedup over the
- *  simple implementation.  This very fast correlation matcher was
- *  contributed by William Rucklidge.
+ *  simple implementation.  The streaming correlation matcher was
+ *  contributed by William Rucklidge.  The counting is now shared with
+ *  pixCorrelationScoreShifts(), and it uses the hardware popcount
+ *  instruction when the processor has it.
+ *
+ *  The byte sum @tab is no longer needed, because the bits are counted
+ *  without a table.  The arg is kept so that the signature of this
+ *  function, which is used by jbclass and by outside programs, does
+ *  not change.
  */
 l_int32
 pixCorrelationScore(PIX        *pix1,
@@ -130,11 +189,8 @@ pixCorrelationScore(PIX        *pix1,
                     l_int32    *tab,
                     l_float32  *pscore)
 {
-l_int32    wi, hi, wt, ht, delw, delh, idelx, idely, count;
-l_int32    wpl1, wpl2, lorow, hirow, locol, hicol;
-l_int32    x, y, pix1lskip, pix2lskip, rowwords1, rowwords2;
-l_uint32   word1, word2, andw;
-l_uint32  *row1, *row2;
+l_int32       wi, hi, wt, ht, delw, delh, idelx, idely, count;
+CORREL_SHIFT  cs;
 
     PROCNAME("pixCorrelationScore");
 
@@ -145,8 +201,6 @@ l_uint32  *row1, *row2;
         return ERROR_INT("pix1 undefined or not 1 bpp", procName, 1);
     if (!pix2 || pixGetDepth(pix2) != 1)
         return ERROR_INT("pix2 undefined or not 1 bpp", procName, 1);
-    if (!tab)
-        return ERROR_INT("tab not defined", procName, 1);
     if (area1 <= 0 || area2 <= 0)
         return ERROR_INT("areas must be > 0", procName, 1);
 
@@ -161,201 +215,12 @@ l_uint32  *row1, *row2;
         return 0;
 
         /* Round difference to nearest integer */
-    if (delx >= 0)
-        idelx = (l_int32)(delx + 0.5);
-    else
-        idelx = (l_int32)(delx - 0.5);
-    if (dely >= 0)
-        idely = (l_int32)(dely + 0.5);
-    else
-        idely = (l_int32)(dely - 0.5);
-
-    count = 0;
-    wpl1 = pixGetWpl(pix1);
-    wpl2 = pixGetWpl(pix2);
-    rowwords2 = wpl2;
-
-        /* What rows of pix1 need to be considered?  Only those underlying the
-         * shifted pix2. */
-    lorow = L_MAX(idely, 0);
-    hirow = L_MIN(ht + idely, hi);
-
-        /* Get the pointer to the first row of each image that will be
-         * considered. */
-    row1 = pixGetData(pix1) + wpl1 * lorow;
-    row2 = pixGetData(pix2) + wpl2 * (lorow - idely);
-
-        /* Similarly, figure out which columns of pix1 will be considered. */
-    locol = L_MAX(idelx, 0);
-    hicol = L_MIN(wt + idelx, wi);
-
-    if (idelx >= 32) {
-            /* pix2 is shifted far enough to the right that pix1's first
-             * word(s) won't contribute to the count.  Increment its
-             * pointer to point to the first word that will contribute,
-             * and adjust other values accordingly. */
-        pix1lskip = idelx >> 5;  /* # of words to skip on left */
-        row1 += pix1lskip;
-        locol -= pix1lskip << 5;
-        hicol -= pix1lskip << 5;
-        idelx &= 31;
-    } else if (idelx <= -32) {
-            /* pix2 is shifted far enough to the left that its first word(s)
-             * won't contribute to the count.  Increment its pointer
-             * to point to the first word that will contribute,
-             * and adjust other values accordingly. */
-        pix2lskip = -((idelx + 31) >> 5);  /* # of words to skip on left */
-        row2 += pix2lskip;
-        rowwords2 -= pix2lskip;
-        idelx += pix2lskip << 5;
-    }
+    idelx = correlRoundShift(delx);
+    idely = correlRoundShift(dely);
 
-    if ((locol >= hicol) || (lorow >= hirow)) {  /* there is no overlap */
-        count = 0;
-    } else {
-            /* How many words of each row of pix1 need to be considered? */
-        rowwords1 = (hicol + 31) >> 5;
-
-        if (idelx == 0) {
-                /* There's no lateral offset; simple case. */
-            for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                for (x = 0; x < rowwords1; x++) {
-                    andw = row1[x] & row2[x];
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-                }
-            }
-        } else if (idelx > 0) {
-                /* pix2 is shifted to the right.  word 0 of pix1 is touched by
-                 * word 0 of pix2; word 1 of pix1 is touched by word 0 and word
-                 * 1 of pix2, and so on up to the last word of pix1 (word N),
-                 * which is touched by words N-1 and N of pix1... if there is a
-                 * word N.  Handle the two cases (pix2 has N-1 words and pix2
-                 * has at least N words) separately.
-                 *
-                 * Note: we know that pix2 has at least N-1 words (i.e.,
-                 * rowwords2 >= rowwords1 - 1) by the following logic.
-                 * We can pretend that idelx <= 31 because the >= 32 logic
-                 * above adjusted everything appropriately.  Then
-                 * hicol <= wt + idelx <= wt + 31, so
-                 * hicol + 31 <= wt + 62
-                 * rowwords1 = (hicol + 31) >> 5 <= (wt + 62) >> 5
-                 * rowwords2 == (wt + 31) >> 5, so
-                 * rowwords1 <= rowwords2 + 1 */
-            if (rowwords2 < rowwords1) {
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                        /* Do the first iteration so the loop can be
-                         * branch-free. */
-                    word1 = row1[0];
-                    word2 = row2[0] >> idelx;
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-
-                    for (x = 1; x < rowwords2; x++) {
-                        word1 = row1[x];
-                        word2 = (row2[x] >> idelx) |
-                            (row2[x - 1] << (32 - idelx));
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-
-                        /* Now the last iteration - we know that this is safe
-                         * (i.e.  rowwords1 >= 2) because rowwords1 > rowwords2
-                         * > 0 (if it was 0, we'd have taken the "count = 0"
-                         * fast-path out of here). */
-                    word1 = row1[x];
-                    word2 = row2[x - 1] << (32 - idelx);
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-                }
-            } else {
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                        /* Do the first iteration so the loop can be
-                         * branch-free.  This section is the same as above
-                         * except for the different limit on the loop, since
-                         * the last iteration is the same as all the other
-                         * iterations (beyond the first). */
-                    word1 = row1[0];
-                    word2 = row2[0] >> idelx;
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-
-                    for (x = 1; x < rowwords1; x++) {
-                        word1 = row1[x];
-                        word2 = (row2[x] >> idelx) |
-                            (row2[x - 1] << (32 - idelx));
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-                }
-            }
-        } else {
-                /* pix2 is shifted to the left.  word 0 of pix1 is touched by
-                 * word 0 and word 1 of pix2, and so on up to the last word of
-                 * pix1 (word N), which is touched by words N and N+1 of
-                 * pix2... if there is a word N+1.  Handle the two cases (pix2
-                 * has N words and pix2 has at least N+1 words) separately. */
-            if (rowwords1 < rowwords2) {
-                    /* pix2 has at least N+1 words, so every iteration through
-                     * the loop can be the same. */
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                    for (x = 0; x < rowwords1; x++) {
-                        word1 = row1[x];
-                        word2 = row2[x] << -idelx;
-                        word2 |= row2[x + 1] >> (32 + idelx);
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-                }
-            } else {
-                    /* pix2 has only N words, so the last iteration is broken
-                     * out. */
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                    for (x = 0; x < rowwords1 - 1; x++) {
-                        word1 = row1[x];
-                        word2 = row2[x] << -idelx;
-                        word2 |= row2[x + 1] >> (32 + idelx);
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-
-                    word1 = row1[x];
-                    word2 = row2[x] << -idelx;
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-                }
-            }
-        }
-    }
-
-    *pscore = (l_float32)count * (l_float32)count /
-              ((l_float32)area1 * (l_float32)area2);
+    correlCountShifts(pix1, pix2, &idelx, 1, &idely, 1, NULL, 0, 0, &cs,
+                      &count);
+    *pscore = correlScore(count, area1, area2);
 /*    fprintf(stderr, "score = %5.3f, count = %d, area1 = %d, area2 = %d\n",
              *pscore, count, area1, area2); */
     return 0;
@@ -373,8 +238,10 @@ l_uint32  *row1, *row2;
  *              dely   (y comp of centroid difference)
  *              maxdiffw (max width difference of pix1 and pix2)
  *              maxdiffh (max height difference of pix1 and pix2)
- *              tab    (sum tab for byte)
- *              downcount (count of 1 pixels below each row of pix1)
+ *              tab    (not used; can be NULL; see pixCorrelationScore())
+ *              downcount (count of 1 pixels below each row of pix1;
+ *                         can be NULL, but then there is no early
+ *                         rejection)
  *              score_threshold
  *      Return: whether the correlation score is >= score_threshold
  *
@@ -411,7 +278,9 @@ l_uint32  *row1, *row2;
  *  score, not the first template with a score satisfying the matching
  *  constraint.  However, this is not particularly effective.
  *
- *  This very fast correlation matcher was contributed by William Rucklidge.
+ *  The count is accumulated row by row, and stops as soon as the
+ *  result is known.  This very fast correlation matcher was contributed
+ *  by William Rucklidge.
  */
 l_int32
 pixCorrelationScoreThresholded(PIX       *pix1,
@@ -426,13 +295,10 @@ pixCorrelationScoreThresholded(PIX       *pix1,
                                l_int32   *downcount,
                                l_float32  score_threshold)
 {
-l_int32    wi, hi, wt, ht, delw, delh, idelx, idely, count;
-l_int32    wpl1, wpl2, lorow, hirow, locol, hicol, untouchable;
-l_int32    x, y, pix1lskip, pix2lskip, rowwords1, rowwords2;
-l_uint32   word1, word2, andw;
-l_uint32  *row1, *row2;
-l_float32  score;
-l_int32    threshold;
+l_int32       wi, hi, wt, ht, delw, delh, idelx, idely, count;
+l_float32     score;
+l_int32       threshold;
+CORREL_SHIFT  cs;
 
     PROCNAME("pixCorrelationScoreThresholded");
 
@@ -440,8 +306,6 @@ l_int32    threshold;
         return ERROR_INT("pix1 undefined or not 1 bpp", procName, 0);
     if (!pix2 || pixGetDepth(pix2) != 1)
         return ERROR_INT("pix2 undefined or not 1 bpp", procName, 0);
-    if (!tab)
-        return ERROR_INT("tab not defined", procName, 0);
     if (area1 <= 0 || area2 <= 0)
         return ERROR_INT("areas must be > 0", procName, 0);
 
@@ -456,238 +320,23 @@ l_int32    threshold;
         return FALSE;
 
         /* Round difference to nearest integer */
-    if (delx >= 0)
-        idelx = (l_int32)(delx + 0.5);
-    else
-        idelx = (l_int32)(delx - 0.5);
-    if (dely >= 0)
-        idely = (l_int32)(dely + 0.5);
-    else
-        idely = (l_int32)(dely - 0.5);
+    idelx = correlRoundShift(delx);
+    idely = correlRoundShift(dely);
 
         /* Compute the correlation count that is needed so that
          * count * count / (area1 * area2) >= score_threshold */
     threshold = (l_int32)ceil(sqrt(score_threshold * area1 * area2));
 
-    count = 0;
-    wpl1 = pixGetWpl(pix1);
-    wpl2 = pixGetWpl(pix2);
-    rowwords2 = wpl2;
-
-        /* What rows of pix1 need to be considered?  Only those underlying the
-         * shifted pix2. */
-    lorow = L_MAX(idely, 0);
-    hirow = L_MIN(ht + idely, hi);
-
-        /* Get the pointer to the first row of each image that will be
-         * considered. */
-    row1 = pixGetData(pix1) + wpl1 * lorow;
-    row2 = pixGetData(pix2) + wpl2 * (lorow - idely);
-    if (hirow <= hi) {
-            /* Some rows of pix1 will never contribute to count */
-        untouchable = downcount[hirow - 1];
-    }
-
-        /* Similarly, figure out which columns of pix1 will be considered. */
-    locol = L_MAX(idelx, 0);
-    hicol = L_MIN(wt + idelx, wi);
-
-    if (idelx >= 32) {
-            /* pix2 is shifted far enough to the right that pix1's first
-             * word(s) won't contribute to the count.  Increment its
-             * pointer to point to the first word that will contribute,
-             * and adjust other values accordingly. */
-        pix1lskip = idelx >> 5;  /* # of words to skip on left */
-        row1 += pix1lskip;
-        locol -= pix1lskip << 5;
-        hicol -= pix1lskip << 5;
-        idelx &= 31;
-    } else if (idelx <= -32) {
-            /* pix2 is shifted far enough to the left that its first word(s)
-             * won't contribute to the count.  Increment its pointer
-             * to point to the first word that will contribute,
-             * and adjust other values accordingly. */
-        pix2lskip = -((idelx + 31) >> 5);  /* # of words to skip on left */
-        row2 += pix2lskip;
-        rowwords2 -= pix2lskip;
-        idelx += pix2lskip << 5;
-    }
+        /* The count stops as soon as it reaches the threshold, or
+         * when the count plus the maximum count attainable from
+         * further rows is below the threshold. */
+    if (correlCountShifts(pix1, pix2, &idelx, 1, &idely, 1, downcount,
+                          threshold, threshold, &cs, &count))
+        return TRUE;
+    if (count >= threshold)
+        return TRUE;
 
-    if ((locol >= hicol) || (lorow >= hirow)) {  /* there is no overlap */
-        count = 0;
-    } else {
-            /* How many words of each row of pix1 need to be considered? */
-        rowwords1 = (hicol + 31) >> 5;
-
-        if (idelx == 0) {
-                /* There's no lateral offset; simple case. */
-            for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                for (x = 0; x < rowwords1; x++) {
-                    andw = row1[x] & row2[x];
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-                }
-
-                    /* If the count is over the threshold, no need to
-                     * calculate any futher.  Likewise, return early if the
-                     * count plus the maximum count attainable from further
-                     * rows is below the threshold. */
-                if (count >= threshold) return TRUE;
-                if (count + downcount[y] - untouchable < threshold) {
-                    return FALSE;
-                }
-            }
-        } else if (idelx > 0) {
-                /* pix2 is shifted to the right.  word 0 of pix1 is touched by
-                 * word 0 of pix2; word 1 of pix1 is touched by word 0 and word
-                 * 1 of pix2, and so on up to the last word of pix1 (word N),
-                 * which is touched by words N-1 and N of pix1... if there is a
-                 * word N.  Handle the two cases (pix2 has N-1 words and pix2
-                 * has at least N words) separately.
-                 *
-                 * Note: we know that pix2 has at least N-1 words (i.e.,
-                 * rowwords2 >= rowwords1 - 1) by the following logic.
-                 * We can pretend that idelx <= 31 because the >= 32 logic
-                 * above adjusted everything appropriately.  Then
-                 * hicol <= wt + idelx <= wt + 31, so
-                 * hicol + 31 <= wt + 62
-                 * rowwords1 = (hicol + 31) >> 5 <= (wt + 62) >> 5
-                 * rowwords2 == (wt + 31) >> 5, so
-                 * rowwords1 <= rowwords2 + 1 */
-            if (rowwords2 < rowwords1) {
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                        /* Do the first iteration so the loop can be
-                         * branch-free. */
-                    word1 = row1[0];
-                    word2 = row2[0] >> idelx;
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-
-                    for (x = 1; x < rowwords2; x++) {
-                        word1 = row1[x];
-                        word2 = (row2[x] >> idelx) |
-                            (row2[x - 1] << (32 - idelx));
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-
-                        /* Now the last iteration - we know that this is safe
-                         * (i.e.  rowwords1 >= 2) because rowwords1 > rowwords2
-                         * > 0 (if it was 0, we'd have taken the "count = 0"
-                         * fast-path out of here). */
-                    word1 = row1[x];
-                    word2 = row2[x - 1] << (32 - idelx);
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-
-                    if (count >= threshold) return TRUE;
-                    if (count + downcount[y] - untouchable < threshold) {
-                        return FALSE;
-                    }
-                }
-            } else {
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                        /* Do the first iteration so the loop can be
-                         * branch-free.  This section is the same as above
-                         * except for the different limit on the loop, since
-                         * the last iteration is the same as all the other
-                         * iterations (beyond the first). */
-                    word1 = row1[0];
-                    word2 = row2[0] >> idelx;
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-
-                    for (x = 1; x < rowwords1; x++) {
-                        word1 = row1[x];
-                        word2 = (row2[x] >> idelx) |
-                            (row2[x - 1] << (32 - idelx));
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-
-                    if (count >= threshold) return TRUE;
-                    if (count + downcount[y] - untouchable < threshold) {
-                        return FALSE;
-                    }
-                }
-            }
-        } else {
-                /* pix2 is shifted to the left.  word 0 of pix1 is touched by
-                 * word 0 and word 1 of pix2, and so on up to the last word of
-                 * pix1 (word N), which is touched by words N and N+1 of
-                 * pix2... if there is a word N+1.  Handle the two cases (pix2
-                 * has N words and pix2 has at least N+1 words) separately. */
-            if (rowwords1 < rowwords2) {
-                    /* pix2 has at least N+1 words, so every iteration through
-                     * the loop can be the same. */
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                    for (x = 0; x < rowwords1; x++) {
-                        word1 = row1[x];
-                        word2 = row2[x] << -idelx;
-                        word2 |= row2[x + 1] >> (32 + idelx);
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-
-                    if (count >= threshold) return TRUE;
-                    if (count + downcount[y] - untouchable < threshold) {
-                        return FALSE;
-                    }
-                }
-            } else {
-                    /* pix2 has only N words, so the last iteration is broken
-                     * out. */
-                for (y = lorow; y < hirow; y++, row1 += wpl1, row2 += wpl2) {
-                    for (x = 0; x < rowwords1 - 1; x++) {
-                        word1 = row1[x];
-                        word2 = row2[x] << -idelx;
-                        word2 |= row2[x + 1] >> (32 + idelx);
-                        andw = word1 & word2;
-                        count += tab[andw & 0xff] +
-                            tab[(andw >> 8) & 0xff] +
-                            tab[(andw >> 16) & 0xff] +
-                            tab[andw >> 24];
-                    }
-
-                    word1 = row1[x];
-                    word2 = row2[x] << -idelx;
-                    andw = word1 & word2;
-                    count += tab[andw & 0xff] +
-                        tab[(andw >> 8) & 0xff] +
-                        tab[(andw >> 16) & 0xff] +
-                        tab[andw >> 24];
-
-                    if (count >= threshold) return TRUE;
-                    if (count + downcount[y] - untouchable < threshold) {
-                        return FALSE;
-                    }
-                }
-            }
-        }
-    }
-
-    score = (l_float32)count * (l_float32)count /
-             ((l_float32)area1 * (l_float32)area2);
+    score = correlScore(count, area1, area2);
     if (score >= score_threshold) {
         fprintf(stderr, "count %d < threshold %d but score %g >= score_threshold %g\n",
                 count, threshold, score, score_threshold);
@@ -867,3 +516,497 @@ PIX     *pixt;
                ((l_float32)area1 * (l_float32)area2);
     return 0;
 }
+
+
+/* -------------------------------------------------------------------- *
+ *              2 pix correlator over a range of shifts                 *
+ * -------------------------------------------------------------------- */
+/*!
+ *  pixCorrelationScoreShifts()
+ *
+ *      Input:  pix1   (test pix, 1 bpp)
+ *              pix2   (exemplar pix, 1 bpp)
+ *              area1  (number of on pixels in pix1)
+ *              area2  (number of on pixels in pix2)
+ *              delx   (x comp of centroid difference)
+ *              dely   (y comp of centroid difference)
+ *              maxshift (max shift from (delx, dely) in each direction;
+ *                        >= 0)
+ *              maxdiffw (max width difference of pix1 and pix2)
+ *              maxdiffh (max height difference of pix1 and pix2)
+ *              downcount (<optional> count of 1 pixels below each row
+ *                         of pix1; use NULL to have it computed here)
+ *              minscore (only a score larger than this is returned)
+ *              &score (<return> largest correlation score; 0.0 if none
+ *                      is larger than @minscore)
+ *              &shiftx (<optional return> x shift giving that score)
+ *              &shifty (<optional return> y shift giving that score)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This finds the largest correlation score with pix2 placed at
+ *          (delx + shiftx, dely + shifty) relative to pix1, over all
+ *          integer shifts in [-maxshift ... maxshift].  Each score is
+ *          the same as the one given by pixCorrelationScoreSimple() for
+ *          that placement.  Ties go to the first shift in raster order.
+ *      (2) The overlap, word offsets and edge masks are computed once
+ *          for all the shifts.  The count for a shift stops as soon as
+ *          it, plus the number of 1 pixels remaining in the rows of
+ *          pix1 below, cannot give a score larger than @minscore.  When
+ *          a set of templates is searched for the best match, use the
+ *          best score found so far for @minscore, so that most of the
+ *          templates are rejected after a few rows.
+ *      (3) When pix1 is compared with many templates, make @downcount
+ *          once with pixCorrelationMakeDowncount().
+ *      (4) The returned score is 0.0 if the width or height differ by
+ *          more than @maxdiffw or @maxdiffh.
+ *      (5) The work arrays for the (2 * maxshift + 1)^2 shifts are on
+ *          the stack for @maxshift up to MAX_CORREL_SHIFT (8), and are
+ *          allocated for larger shifts.
+ */
+l_int32
+pixCorrelationScoreShifts(PIX        *pix1,
+                          PIX        *pix2,
+                          l_int32     area1,
+                          l_int32     area2,
+                          l_float32   delx,
+                          l_float32   dely,
+                          l_int32     maxshift,
+                          l_int32     maxdiffw,
+                          l_int32     maxdiffh,
+                          l_int32    *downcount,
+                          l_float32   minscore,
+                          l_float32  *pscore,
+                          l_int32    *pshiftx,
+                          l_int32    *pshifty)
+{
+l_int32        i, j, n, wi, hi, wt, ht, mincount, maxcount;
+l_int32        dxbuf[MAX_CORREL_SHIFTS], dybuf[MAX_CORREL_SHIFTS];
+l_int32        countbuf[MAX_CORREL_SHIFTS * MAX_CORREL_SHIFTS];
+l_int32       *dx, *dy, *counts, *dcount;
+l_float32      score, maxscore;
+CORREL_SHIFT   csbuf[MAX_CORREL_SHIFTS];
+CORREL_SHIFT  *cs;
+
+    PROCNAME("pixCorrelationScoreShifts");
+
+    if (pshiftx) *pshiftx = 0;
+    if (pshifty) *pshifty = 0;
+    if (!pscore)
+        return ERROR_INT("&score not defined", procName, 1);
+    *pscore = 0.0;
+    if (!pix1 || pixGetDepth(pix1) != 1)
+        return ERROR_INT("pix1 undefined or not 1 bpp", procName, 1);
+    if (!pix2 || pixGetDepth(pix2) != 1)
+        return ERROR_INT("pix2 undefined or not 1 bpp", procName, 1);
+    if (area1 <= 0 || area2 <= 0)
+        return ERROR_INT("areas must be > 0", procName, 1);
+    if (maxshift < 0)
+        return ERROR_INT("maxshift < 0", procName, 1);
+
+        /* Eliminate based on size difference */
+    pixGetDimensions(pix1, &wi, &hi, NULL);
+    pixGetDimensions(pix2, &wt, &ht, NULL);
+    if (L_ABS(wi - wt) > maxdiffw || L_ABS(hi - ht) > maxdiffh)
+        return 0;
+
+        /* Find the smallest count giving a score above minscore.
+         * The score is a nondecreasing function of the count. */
+    maxcount = L_MIN(area1, area2);
+    mincount = 0;
+    if (minscore >= 0.0) {
+        mincount = (l_int32)sqrt((l_float64)minscore * area1 * area2) - 2;
+        mincount = L_MAX(0, mincount);
+        while (mincount <= maxcount &&
+               correlScore(mincount, area1, area2) <= minscore)
+            mincount++;
+        if (mincount > maxcount)
+            return 0;
+    }
+
+        /* Use the stack arrays unless the range of shifts is too large */
+    n = 2 * maxshift + 1;
+    dx = dxbuf;
+    dy = dybuf;
+    counts = countbuf;
+    cs = csbuf;
+    if (maxshift > MAX_CORREL_SHIFT) {
+        dx = (l_int32 *)CALLOC(n, sizeof(l_int32));
+        dy = (l_int32 *)CALLOC(n, sizeof(l_int32));
+        counts = (l_int32 *)CALLOC((size_t)n * n, sizeof(l_int32));
+        cs = (CORREL_SHIFT *)CALLOC(n, sizeof(CORREL_SHIFT));
+        if (!dx || !dy || !counts || !cs) {
+            FREE(dx);
+            FREE(dy);
+            FREE(counts);
+            FREE(cs);
+            return ERROR_INT("shift arrays not made", procName, 1);
+        }
+    }
+
+        /* Round each shifted difference to nearest integer */
+    for (i = 0; i < n; i++) {
+        dx[i] = correlRoundShift(delx + (i - maxshift));
+        dy[i] = correlRoundShift(dely + (i - maxshift));
+    }
+
+    dcount = downcount;
+    if (!downcount && mincount > 0)
+        dcount = pixCorrelationMakeDowncount(pix1);
+    if (!dcount && mincount > 0) {
+        if (cs != csbuf) {
+            FREE(dx);
+            FREE(dy);
+            FREE(counts);
+            FREE(cs);
+        }
+        return ERROR_INT("dcount not made", procName, 1);
+    }
+    correlCountShifts(pix1, pix2, dx, n, dy, n, dcount, mincount, 0, cs,
+                      counts);
+    if (dcount != downcount)
+        FREE(dcount);
+
+        /* Shifts that were dropped have counts below mincount */
+    maxscore = minscore;
+    for (i = 0; i < n; i++) {
+        for (j = 0; j < n; j++) {
+            if (counts[i * n + j] < mincount)
+                continue;
+            score = correlScore(counts[i * n + j], area1, area2);
+            if (score > maxscore) {
+                maxscore = score;
+                *pscore = score;
+                if (pshiftx) *pshiftx = j - maxshift;
+                if (pshifty) *pshifty = i - maxshift;
+            }
+        }
+    }
+
+    if (cs != csbuf) {
+        FREE(dx);
+        FREE(dy);
+        FREE(counts);
+        FREE(cs);
+    }
+    return 0;
+}
+
+
+/*!
+ *  pixCorrelationMakeDowncount()
+ *
+ *      Input:  pix (1 bpp)
+ *      Return: downcount array, or null on error
+ *
+ *  Notes:
+ *      (1) Element y of the returned array is the number of 1 pixels
+ *          in the rows of @pix below row y.  It is used to stop a
+ *          correlation count early, in pixCorrelationScoreThresholded()
+ *          and pixCorrelationScoreShifts().
+ */
+l_int32 *
+pixCorrelationMakeDowncount(PIX  *pix)
+{
+l_int32   y, h, sum;
+l_int32  *rowcount, *downcount;
+NUMA     *na;
+
+    PROCNAME("pixCorrelationMakeDowncount");
+
+    if (!pix || pixGetDepth(pix) != 1)
+        return (l_int32 *)ERROR_PTR("pix undefined or not 1 bpp",
+                                    procName, NULL);
+
+    h = pixGetHeight(pix);
+    if ((na = pixCountPixelsByRow(pix, NULL)) == NULL)
+        return (l_int32 *)ERROR_PTR("na not made", procName, NULL);
+    rowcount = numaGetIArray(na);
+    numaDestroy(&na);
+    if (!rowcount)
+        return (l_int32 *)ERROR_PTR("rowcount not made", procName, NULL);
+    if ((downcount = (l_int32 *)CALLOC(h, sizeof(l_int32))) == NULL) {
+        FREE(rowcount);
+        return (l_int32 *)ERROR_PTR("downcount not made", procName, NULL);
+    }
+    for (y = h - 1, sum = 0; y >= 0; y--) {
+        downcount[y] = sum;
+        sum += rowcount[y];
+    }
+    FREE(rowcount);
+    return downcount;
+}
+
+
+/* -------------------------------------------------------------------- *
+ *          Static helpers for counting the AND of two 1 bpp images     *
+ * -------------------------------------------------------------------- */
+/*!
+ *  correlCountShifts()
+ *
+ *      Input:  pix1 (1 bpp)
+ *              pix2 (1 bpp)
+ *              dx (array of x placements of pix2 relative to pix1)
+ *              nx (number of x placements)
+ *              dy (array of y placements of pix2 relative to pix1)
+ *              ny (number of y placements)
+ *              downcount (<optional> count of 1 pixels below each row
+ *                         of pix1; null for no early rejection)
+ *              mincount (stop counting a placement when it can not
+ *                        reach this; ignored without @downcount)
+ *              acceptcount (stop when any count reaches this; 0 to
+ *                           count to completion)
+ *              cs (work array of size nx)
+ *              counts (array of size nx * ny; returns the count of the
+ *                      AND for placement (dx[j], dy[i]) at i * nx + j)
+ *      Return: 1 if a count reached @acceptcount; 0 otherwise
+ *
+ *  Notes:
+ *      (1) This counts the pixels that are ON in both pix1 and pix2,
+ *          where pix2 is placed with its UL corner at (dx[j], dy[i])
+ *          in pix1, for all nx * ny placements.  Only pixels within
+ *          both images are counted, so the padding bits at the end of
+ *          each raster line do not matter.
+ *      (2) The column overlap, word offset and edge masks are found
+ *          once for each x placement.  For a placement that was stopped
+ *          because it can not reach @mincount, the partial count is
+ *          returned, and it is also below @mincount.  When this returns
+ *          1, the counts of placements after the accepted one are 0.
+ */
+static l_int32
+correlCountShifts(PIX           *pix1,
+                  PIX           *pix2,
+                  l_int32       *dx,
+                  l_int32        nx,
+                  l_int32       *dy,
+                  l_int32        ny,
+                  l_int32       *downcount,
+                  l_int32        mincount,
+                  l_int32        acceptcount,
+                  CORREL_SHIFT  *cs,
+                  l_int32       *counts)
+{
+l_int32        i, j, k, w1, h1, w2, h2, wpl1, wpl2, lo, hi, ylo, yhi;
+l_uint32      *data1, *data2;
+l_int32      (*countfunc)(l_uint32 *, l_int32, l_uint32 *, l_int32,
+                          CORREL_SHIFT *, l_int32, l_int32, l_int32,
+                          l_int32 *, l_int32, l_int32);
+
+    pixGetDimensions(pix1, &w1, &h1, NULL);
+    pixGetDimensions(pix2, &w2, &h2, NULL);
+    wpl1 = pixGetWpl(pix1);
+    wpl2 = pixGetWpl(pix2);
+    data1 = pixGetData(pix1);
+    data2 = pixGetData(pix2);
+    if (!downcount)
+        mincount = 0;
+
+        /* Every processor with AVX2 also has the popcount instruction */
+    countfunc = correlCount;
+#if USE_SIMD
+    if (l_getSimdLevel() == L_SIMD_AVX2)
+        countfunc = correlCountPOPCNT;
+#endif  /* USE_SIMD */
+
+        /* Columns of overlap for each x placement */
+    for (j = 0; j < nx; j++) {
+        lo = L_MAX(dx[j], 0);
+        hi = L_MIN(dx[j] + w2, w1);
+        if (lo >= hi) {
+            cs[j].xlo = cs[j].xhi = 0;
+            continue;
+        }
+        cs[j].xlo = lo >> 5;
+        cs[j].xhi = (hi + 31) >> 5;
+        cs[j].bshift = ((-dx[j]) % 32 + 32) % 32;
+        cs[j].koff = (-dx[j] - cs[j].bshift) / 32;
+        cs[j].lmask = 0xffffffff >> (lo & 31);
+        cs[j].rmask = (hi & 31) ? ~(0xffffffff >> (hi & 31)) : 0xffffffff;
+    }
+
+    for (i = 0, k = 0; i < ny; i++) {
+        ylo = L_MAX(dy[i], 0);
+        yhi = L_MIN(dy[i] + h2, h1);
+        for (j = 0; j < nx; j++, k++) {
+            if (ylo >= yhi || cs[j].xlo >= cs[j].xhi) {
+                counts[k] = 0;
+                continue;
+            }
+            counts[k] = countfunc(data1, wpl1, data2, wpl2, &cs[j], dy[i],
+                                  ylo, yhi, downcount, mincount, acceptcount);
+            if (acceptcount > 0 && counts[k] >= acceptcount) {
+                for (k++; k < nx * ny; k++)
+                    counts[k] = 0;
+                return 1;
+            }
+        }
+    }
+    return 0;
+}
+
+
+/*!
+ *  correlCount()
+ *
+ *      Input:  data1, wpl1 (pix1 data and words/line)
+ *              data2, wpl2 (pix2 data and words/line)
+ *              cs (columns of pix1 and pix2 for this x placement)
+ *              dy (y placement of pix2 relative to pix1)
+ *              ylo, yhi (range of rows of pix1 overlapping pix2)
+ *              downcount (<optional> count of 1 pixels below each row
+ *                         of pix1)
+ *              mincount (stop when the count can not reach this)
+ *              acceptcount (stop when the count reaches this; 0 to
+ *                           count to completion)
+ *      Return: count of pixels ON in both images, for rows of pix1
+ *              from ylo until the count was stopped
+ *
+ *  Notes:
+ *      (1) Row y of pix1 is ANDed with row (y - dy) of pix2, and
+ *          word x of pix1 with the 32 bits of pix2 starting at bit
+ *          cs->bshift of word (x + cs->koff).  The first and last
+ *          words are masked to the columns where the images overlap.
+ */
+static l_int32
+correlCount(l_uint32      *data1,
+            l_int32        wpl1,
+            l_uint32      *data2,
+            l_int32        wpl2,
+            CORREL_SHIFT  *cs,
+            l_int32        dy,
+            l_int32        ylo,
+            l_int32        yhi,
+            l_int32       *downcount,
+            l_int32        mincount,
+            l_int32        acceptcount)
+{
+l_int32    x, y, k, b, xlo, xhi, koff, count, dlast;
+l_uint32   word;
+l_uint32  *row1, *row2;
+
+    xlo = cs->xlo;
+    xhi = cs->xhi;
+    koff = cs->koff;
+    b = cs->bshift;
+    dlast = (downcount) ? downcount[yhi - 1] : 0;
+    row1 = data1 + ylo * wpl1;
+    row2 = data2 + (ylo - dy) * wpl2;
+    count = 0;
+    for (y = ylo; y < yhi; y++, row1 += wpl1, row2 += wpl2) {
+        for (x = xlo; x < xhi; x++) {
+            k = x + koff;
+            if (b == 0) {
+                word = row2[k];
+            } else {
+                word = (k >= 0) ? row2[k] << b : 0;
+                if (k + 1 < wpl2)
+                    word |= row2[k + 1] >> (32 - b);
+            }
+            word &= row1[x];
+            if (x == xlo) word &= cs->lmask;
+            if (x == xhi - 1) word &= cs->rmask;
+            word = word - ((word >> 1) & 0x55555555);
+            word = (word & 0x33333333) + ((word >> 2) & 0x33333333);
+            word = (word + (word >> 4)) & 0x0f0f0f0f;
+            count += (word * 0x01010101) >> 24;
+        }
+        if (acceptcount > 0 && count >= acceptcount)
+            break;
+        if (mincount > 0 && count + downcount[y] - dlast < mincount)
+            break;
+    }
+    return count;
+}
+
+
+#if USE_SIMD
+/*!
+ *  correlCountPOPCNT()
+ *
+ *      Input:  same as correlCount()
+ *      Return: same as correlCount()
+ *
+ *  Notes:
+ *      (1) Same as correlCount(), using the popcount instruction.
+ */
+static l_int32  L_TARGET_POPCNT
+correlCountPOPCNT(l_uint32      *data1,
+                  l_int32        wpl1,
+                  l_uint32      *data2,
+                  l_int32        wpl2,
+                  CORREL_SHIFT  *cs,
+                  l_int32        dy,
+                  l_int32        ylo,
+                  l_int32        yhi,
+                  l_int32       *downcount,
+                  l_int32        mincount,
+                  l_int32        acceptcount)
+{
+l_int32    x, y, k, b, xlo, xhi, koff, count, dlast;
+l_uint32   word;
+l_uint32  *row1, *row2;
+
+    xlo = cs->xlo;
+    xhi = cs->xhi;
+    koff = cs->koff;
+    b = cs->bshift;
+    dlast = (downcount) ? downcount[yhi - 1] : 0;
+    row1 = data1 + ylo * wpl1;
+    row2 = data2 + (ylo - dy) * wpl2;
+    count = 0;
+    for (y = ylo; y < yhi; y++, row1 += wpl1, row2 += wpl2) {
+        for (x = xlo; x < xhi; x++) {
+            k = x + koff;
+            if (b == 0) {
+                word = row2[k];
+            } else {
+                word = (k >= 0) ? row2[k] << b : 0;
+                if (k + 1 < wpl2)
+                    word |= row2[k + 1] >> (32 - b);
+            }
+            word &= row1[x];
+            if (x == xlo) word &= cs->lmask;
+            if (x == xhi - 1) word &= cs->rmask;
+            count += __builtin_popcount(word);
+        }
+        if (acceptcount > 0 && count >= acceptcount)
+            break;
+        if (mincount > 0 && count + downcount[y] - dlast < mincount)
+            break;
+    }
+    return count;
+}
+#endif  /* USE_SIMD */
+
+
+/*!
+ *  correlRoundShift()
+ *
+ *      Input:  del (centroid difference)
+ *      Return: del rounded to the nearest integer, away from 0 on a tie
+ */
+static l_int32
+correlRoundShift(l_float32  del)
+{
+    if (del >= 0)
+        return (l_int32)(del + 0.5);
+    else
+        return (l_int32)(del - 0.5);
+}
+
+
+/*!
+ *  correlScore()
+ *
+ *      Input:  count (of pixels ON in the AND)
+ *              area1, area2 (number of ON pixels in each image)
+ *      Return: correlation score
+ */
+static l_float32
+correlScore(l_int32  count,
+            l_int32  area1,
+            l_int32  area2)
+{
+    return (l_float32)count * (l_float32)count /
+           ((l_float32)area1 * (l_float32)area2);
+}
@@ -328,8 +328,7 @@ L_DNA  *da;
         return;
 
         /* Decrement the ref count.  If it is 0, destroy the l_dna. */
-    l_dnaChangeRefcount(da, -1);
-    if (l_dnaGetRefcount(da) <= 0) {
+    if (L_REFCOUNT_ADD(&da->refcount, -1) <= 0) {
         if (da->array)
             FREE(da->array);
         FREE(da);
@@ -859,7 +858,7 @@ l_dnaChangeRefcount(L_DNA   *da,
 
     if (!da)
         return ERROR_INT("da not defined", procName, 1);
-    da->refcount += delta;
+    L_REFCOUNT_ADD(&da->refcount, delta);
     return 0;
 }
 
@@ -52,6 +52,7 @@
  *           PIX     *pixUnsharpMaskingGrayFast()
  *           PIX     *pixUnsharpMaskingGray1D()
  *           PIX     *pixUnsharpMaskingGray2D()
+ *           PIX     *pixUnsharpMaskingGauss()
  *
  *      Hue and saturation modification
  *           PIX     *pixModifyHue()
@@ -1395,6 +1396,83 @@ FPIX       *fpix;
 }
 
 
+/*!
+ *  pixUnsharpMaskingGauss()
+ *
+ *      Input:  pixs (all depths except 1 bpp; with or without colormaps)
+ *              sigma (standard deviation of the gaussian smoothing)
+ *              fract (fraction of edge added back into image)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This is unsharp masking with gaussian smoothing instead
+ *          of block smoothing.  The time does not depend on @sigma,
+ *          so it can be used for large-scale sharpening and local
+ *          contrast enhancement, with @sigma of 20 or more.
+ *          See pixGaussianBlur().
+ *      (2) Returns a clone if no sharpening is requested.
+ */
+PIX *
+pixUnsharpMaskingGauss(PIX       *pixs,
+                       l_float32  sigma,
+                       l_float32  fract)
+{
+l_int32  i;
+FPIX    *fpixs, *fpixb;
+PIX     *pixt, *pix1, *pixc[3], *pixd;
+
+    PROCNAME("pixUnsharpMaskingGauss");
+
+    if (!pixs || (pixGetDepth(pixs) == 1))
+        return (PIX *)ERROR_PTR("pixs not defined or 1 bpp", procName, NULL);
+    if (fract <= 0.0 || sigma < 0.5) {
+        L_WARNING("no sharpening requested; clone returned\n", procName);
+        return pixClone(pixs);
+    }
+
+        /* Remove colormap; clone if possible; result is either 8 or 32 bpp */
+    if ((pixt = pixConvertTo8Or32(pixs, L_CLONE, 0)) == NULL)
+        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+
+        /* pixd = pixs + fract * (pixs - smoothed pixs), for each component */
+    for (i = 0; i < 3; i++) {
+        if (pixGetDepth(pixt) == 8)
+            pix1 = pixClone(pixt);
+        else
+            pix1 = pixGetRGBComponent(pixt, COLOR_RED + i);
+        fpixs = pixConvertToFPix(pix1, 1);
+        fpixb = fpixGaussianBlur(fpixs, sigma, sigma);
+        pixDestroy(&pix1);
+        if (!fpixb) {
+            while (--i >= 0)
+                pixDestroy(&pixc[i]);
+            fpixDestroy(&fpixs);
+            pixDestroy(&pixt);
+            return (PIX *)ERROR_PTR("fpixb not made", procName, NULL);
+        }
+        fpixLinearCombination(fpixs, fpixs, fpixb, 1.0 + fract, -fract);
+        pixc[i] = fpixConvertToPix(fpixs, 8, L_CLIP_TO_ZERO, 0);
+        fpixDestroy(&fpixs);
+        fpixDestroy(&fpixb);
+        if (pixGetDepth(pixt) == 8)
+            break;
+    }
+
+    if (pixGetDepth(pixt) == 8) {
+        pixd = pixc[0];
+    } else {
+        pixd = pixCreateRGBImage(pixc[0], pixc[1], pixc[2]);
+        for (i = 0; i < 3; i++)
+            pixDestroy(&pixc[i]);
+        if (pixGetSpp(pixt) == 4)
+            pixScaleAndTransferAlpha(pixd, pixt, 1.0, 1.0);
+    }
+
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
 
 /*-----------------------------------------------------------------------*
  *                    Hue and saturation modification                    *
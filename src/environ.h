@@ -147,6 +147,60 @@ typedef uintptr_t l_uintptr_t;
 #define  USE_PSIO         1
 
 
+/*--------------------------------------------------------------------*
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
+ *                          USER CONFIGURABLE                         *
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
+ *                 Environ variable for thread support                *
+ *--------------------------------------------------------------------*/
+/*
+ *  Some operations can distribute their work over several threads
+ *  (see parallel.c).  This requires posix threads.  Setting this to 0
+ *  causes all such work to be done sequentially in the calling thread.
+ */
+#if !defined(USE_PTHREADS)
+  #if defined(_MSC_VER)
+    #define  USE_PTHREADS   0
+  #else
+    #define  USE_PTHREADS   1
+  #endif
+#endif  /* !USE_PTHREADS */
+
+
+/*--------------------------------------------------------------------*
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
+ *                          USER CONFIGURABLE                         *
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
+ *                  Environ variable for SIMD support                 *
+ *--------------------------------------------------------------------*/
+/*
+ *  Some inner loops have SSE2 and AVX2 versions, which are chosen at
+ *  run time according to what the processor supports (see
+ *  l_getSimdLevel() in parallel.c).  These are compiled with gcc or
+ *  clang for x86 and x86_64.  Setting this to 0 compiles only the
+ *  portable versions.  A function that uses these instructions must
+ *  be declared with L_TARGET_SSE2 or L_TARGET_AVX2.  The popcount
+ *  instruction (L_TARGET_POPCNT) is used at the AVX2 level, because
+ *  every processor with AVX2 also has it.
+ */
+#if !defined(USE_SIMD)
+  #if (defined(__x86_64__) || defined(__i386__)) && \
+      (defined(__clang__) || \
+       (defined(__GNUC__) && \
+        (__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9))))
+    #define  USE_SIMD   1
+  #else
+    #define  USE_SIMD   0
+  #endif
+#endif  /* !USE_SIMD */
+
+#if USE_SIMD
+  #define  L_TARGET_SSE2   __attribute__((target("sse2")))
+  #define  L_TARGET_AVX2   __attribute__((target("avx2")))
+  #define  L_TARGET_POPCNT __attribute__((target("popcnt")))
+#endif  /* USE_SIMD */
+
+
 /*--------------------------------------------------------------------*
  * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
  *                          USER CONFIGURABLE                         *
@@ -230,6 +284,60 @@ typedef unsigned long long      l_uint64;
 #endif
 
 
+/*--------------------------------------------------------------------*
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
+ *                          USER CONFIGURABLE                         *
+ * !!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!*
+ *          Thread-safe reference counting and message control        *
+ *--------------------------------------------------------------------*/
+/*
+ *  By default, the reference counts of PIX, PIXA, BOX, BOXA, NUMA,
+ *  L_DNA, PTA, SARRAY, FPIX, FPIXA, DPIX, L_BYTEA and CCBORD are
+ *  changed with ordinary arithmetic, so clones of the same object
+ *  must not be made or destroyed concurrently in different threads.
+ *
+ *  Define LEPT_THREAD_SAFE to 1 (e.g., -DLEPT_THREAD_SAFE=1 on the
+ *  compiler line, for both the library and the application) to
+ *  build a library where:
+ *     (1) All reference count changes are atomic.  A clone can then
+ *         be handed to another thread and destroyed there, and the
+ *         data is freed exactly once, by whichever thread drops the
+ *         last reference.  This does not make it safe to modify the
+ *         data of a shared object while another thread uses it.
+ *     (2) The run-time message severity threshold, LeptMsgSeverity,
+ *         is a per-thread variable, so setMsgSeverity() in one thread
+ *         does not change the messages printed by the others.
+ *  This requires gcc/clang (or msvc) atomic intrinsics.  With msvc,
+ *  the severity threshold remains shared when leptonica is built or
+ *  used as a DLL, because thread-local data cannot be exported.
+ *
+ *  L_REFCOUNT_ADD(pcount, delta) adds delta to the count and returns
+ *  the new value as an l_int32.
+ */
+#ifndef  LEPT_THREAD_SAFE
+#define  LEPT_THREAD_SAFE   0
+#endif  /* LEPT_THREAD_SAFE */
+
+#if LEPT_THREAD_SAFE && defined(_MSC_VER)
+  #include <intrin.h>
+  #define L_REFCOUNT_ADD(pcount, delta) \
+      ((l_int32)(_InterlockedExchangeAdd((volatile long *)(pcount), \
+                                         (long)(delta)) + (delta)))
+  #if defined(LIBLEPT_EXPORTS) || defined(LIBLEPT_IMPORTS)
+    #define L_THREAD_LOCAL
+  #else
+    #define L_THREAD_LOCAL  __declspec(thread)
+  #endif
+#elif LEPT_THREAD_SAFE && defined(__GNUC__)
+  #define L_REFCOUNT_ADD(pcount, delta) \
+      ((l_int32)__sync_add_and_fetch((pcount), (delta)))
+  #define L_THREAD_LOCAL  __thread
+#else
+  #define L_REFCOUNT_ADD(pcount, delta)  ((l_int32)(*(pcount) += (delta)))
+  #define L_THREAD_LOCAL
+#endif  /* LEPT_THREAD_SAFE */
+
+
 /*--------------------------------------------------------------------*
  *            Environment variables for endian dependence             *
  *--------------------------------------------------------------------*/
@@ -281,6 +389,8 @@ typedef struct L_WallTimer  L_WALLTIMER;
  *  These specify the memory management functions that are used           *
  *  on all heap data except for Pix.  Memory management for Pix           *
  *  also defaults to malloc and free.  See pix1.c for details.            *
+ *  The structs and arrays of Numa, Boxa, Pta, Pixa and Box can instead   *
+ *  be taken from a pool; see l_poolCreate() in pixalloc.c.               *
  *------------------------------------------------------------------------*/
 #define MALLOC(blocksize)           malloc(blocksize)
 #define CALLOC(numelem, elemsize)   calloc(numelem, elemsize)
@@ -374,8 +484,9 @@ enum {
 #endif
 
 
-/*  The run-time message severity threshold is defined in utils.c.  */
-LEPT_DLL extern l_int32  LeptMsgSeverity;
+/*  The run-time message severity threshold is defined in utils.c.
+ *  With LEPT_THREAD_SAFE, each thread has its own threshold.  */
+LEPT_DLL extern L_THREAD_LOCAL l_int32  LeptMsgSeverity;
 
 /*
  *  Usage
@@ -363,8 +363,7 @@ FPIX       *fpix;
         return;
 
         /* Decrement the ref count.  If it is 0, destroy the fpix. */
-    fpixChangeRefcount(fpix, -1);
-    if (fpixGetRefcount(fpix) <= 0) {
+    if (L_REFCOUNT_ADD(&fpix->refcount, -1) <= 0) {
         if ((data = fpixGetData(fpix)) != NULL)
             FREE(data);
         FREE(fpix);
@@ -471,7 +470,7 @@ fpixChangeRefcount(FPIX    *fpix,
     if (!fpix)
         return ERROR_INT("fpix not defined", procName, 1);
 
-    fpix->refcount += delta;
+    L_REFCOUNT_ADD(&fpix->refcount, delta);
     return 0;
 }
 
@@ -719,8 +718,7 @@ FPIXA   *fpixa;
         return;
 
         /* Decrement the refcount.  If it is 0, destroy the pixa. */
-    fpixaChangeRefcount(fpixa, -1);
-    if (fpixa->refcount <= 0) {
+    if (L_REFCOUNT_ADD(&fpixa->refcount, -1) <= 0) {
         for (i = 0; i < fpixa->n; i++)
             fpixDestroy(&fpixa->fpix[i]);
         FREE(fpixa->fpix);
@@ -865,7 +863,7 @@ fpixaChangeRefcount(FPIXA   *fpixa,
     if (!fpixa)
         return ERROR_INT("fpixa not defined", procName, 1);
 
-    fpixa->refcount += delta;
+    L_REFCOUNT_ADD(&fpixa->refcount, delta);
     return 0;
 }
 
@@ -1269,8 +1267,7 @@ DPIX       *dpix;
         return;
 
         /* Decrement the ref count.  If it is 0, destroy the dpix. */
-    dpixChangeRefcount(dpix, -1);
-    if (dpixGetRefcount(dpix) <= 0) {
+    if (L_REFCOUNT_ADD(&dpix->refcount, -1) <= 0) {
         if ((data = dpixGetData(dpix)) != NULL)
             FREE(data);
         FREE(dpix);
@@ -1377,7 +1374,7 @@ dpixChangeRefcount(DPIX    *dpix,
     if (!dpix)
         return ERROR_INT("dpix not defined", procName, 1);
 
-    dpix->refcount += delta;
+    L_REFCOUNT_ADD(&dpix->refcount, delta);
     return 0;
 }
 
@@ -47,15 +47,29 @@
  *      Low-level grayscale morphological operations
  *            static void    dilateGrayLow()
  *            static void    erodeGrayLow()
+ *            static void    morphGrayLow()
+ *            static void    vhgwLow()
+ *            static void    extremumLineLow()
+ *            static l_int32 extremumLineSSE2()
+ *            static l_int32 extremumLineAVX2()
  *
  *
  *      Method: Algorithm by van Herk and Gil and Werman, 1992
  *
- *      Measured speed of the vH/G-W implementation is about 1 output
- *      pixel per 120 PIII clock cycles, for a horizontal or vertical
- *      erosion or dilation.  The computation time doubles for opening
- *      or closing, or for a square SE, as expected, and is independent
- *      of the size of the SE.
+ *      The computation time doubles for opening or closing, or for
+ *      a square SE, as expected, and is independent of the size of
+ *      the SE.  The low-level implementation does each step of the
+ *      algorithm on a full raster line of pixels at a time (see
+ *      morphGrayLow()), so that it can use SSE2 or AVX2 byte max/min
+ *      instructions, 16 or 32 pixels at a time.  For the horizontal
+ *      direction, strips of raster lines are transposed first.
+ *
+ *      The Sel sizes may be even.  As with selCreateBrick(), the
+ *      origin is at size / 2, so for an even size the dilation of
+ *      a pixel at x takes the max over [x - size/2 + 1, x + size/2],
+ *      and the erosion the min over [x - size/2, x + size/2 - 1].
+ *      On an image with only the values 0 and 255, this gives the
+ *      same result as binary morphology with the same brick Sel.
  *
  *      A faster implementation can be made directly for brick Sels
  *      of maximum size 3.  We unroll the computation for sets of 8 bytes.
@@ -117,7 +131,11 @@
  *      leptonica documentation on grayscale morphology.
  */
 
+#include <string.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
 
     /* Special static operations for 3x1, 1x3 and 3x3 structuring elements */
 static PIX *pixErodeGray3h(PIX *pixs);
@@ -128,12 +146,28 @@ static PIX *pixDilateGray3v(PIX *pixs);
     /*  Low-level gray morphological operations */
 static void dilateGrayLow(l_uint32 *datad, l_int32 w, l_int32 h,
                           l_int32 wpld, l_uint32 *datas, l_int32 wpls,
-                          l_int32 size, l_int32 direction, l_uint8 *buffer,
-                          l_uint8 *maxarray);
+                          l_int32 size, l_int32 direction);
 static void erodeGrayLow(l_uint32 *datad, l_int32 w, l_int32 h,
                          l_int32 wpld, l_uint32 *datas, l_int32 wpls,
-                         l_int32 size, l_int32 direction, l_uint8 *buffer,
-                         l_uint8 *minarray);
+                         l_int32 size, l_int32 direction);
+static void morphGrayLow(l_uint32 *datad, l_int32 w, l_int32 h,
+                         l_int32 wpld, l_uint32 *datas, l_int32 wpls,
+                         l_int32 size, l_int32 direction, l_int32 type);
+static void vhgwLow(l_uint8 *bufd, l_int32 strided, l_uint8 *bufs,
+                    l_int32 strides, l_int32 nbytes, l_int32 n,
+                    l_int32 size, l_int32 type, l_uint8 *barray,
+                    l_uint8 *farray, l_int32 level);
+static void extremumLineLow(l_uint8 *lined, l_uint8 *line1, l_uint8 *line2,
+                            l_int32 n, l_int32 type, l_int32 level);
+#if USE_SIMD
+static l_int32 extremumLineSSE2(l_uint8 *lined, l_uint8 *line1,
+                                l_uint8 *line2, l_int32 n, l_int32 type);
+static l_int32 extremumLineAVX2(l_uint8 *lined, l_uint8 *line1,
+                                l_uint8 *line2, l_int32 n, l_int32 type);
+#endif  /* USE_SIMD */
+
+    /* Number of raster lines transposed together for horizontal ops */
+static const l_int32  GRAY_STRIP = 32;
 
 /*-----------------------------------------------------------------*
  *           Top-level grayscale morphological operations          *
@@ -142,22 +176,22 @@ static void erodeGrayLow(l_uint32 *datad, l_int32 w, l_int32 h,
  *  pixErodeGray()
  *
  *      Input:  pixs
- *              hsize  (of Sel; must be odd; origin implicitly in center)
- *              vsize  (ditto)
+ *              hsize  (of Sel; origin at hsize / 2)
+ *              vsize  (of Sel; origin at vsize / 2)
  *      Return: pixd
  *
  *  Notes:
  *      (1) Sel is a brick with all elements being hits
  *      (2) If hsize = vsize = 1, just returns a copy.
+ *      (3) The sizes can be even; see the notes at the top of this file.
  */
 PIX *
 pixErodeGray(PIX     *pixs,
              l_int32  hsize,
              l_int32  vsize)
 {
-l_uint8   *buffer, *minarray;
 l_int32    w, h, wplb, wplt;
-l_int32    leftpix, rightpix, toppix, bottompix, maxsize;
+l_int32    leftpix, rightpix, toppix, bottompix;
 l_uint32  *datab, *datat;
 PIX       *pixb, *pixt, *pixd;
 
@@ -169,14 +203,6 @@ PIX       *pixb, *pixt, *pixd;
         return (PIX *)ERROR_PTR("pixs not 8 bpp", procName, NULL);
     if (hsize < 1 || vsize < 1)
         return (PIX *)ERROR_PTR("hsize or vsize < 1", procName, NULL);
-    if ((hsize & 1) == 0 ) {
-        L_WARNING("horiz sel size must be odd; increasing by 1\n", procName);
-        hsize++;
-    }
-    if ((vsize & 1) == 0 ) {
-        L_WARNING("vert sel size must be odd; increasing by 1\n", procName);
-        vsize++;
-    }
 
     if (hsize == 1 && vsize == 1)
         return pixCopy(NULL, pixs);
@@ -210,25 +236,16 @@ PIX       *pixb, *pixt, *pixd;
     wplb = pixGetWpl(pixb);
     wplt = pixGetWpl(pixt);
 
-    if ((buffer = (l_uint8 *)CALLOC(L_MAX(w, h), sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("buffer not made", procName, NULL);
-    maxsize = L_MAX(hsize, vsize);
-    if ((minarray = (l_uint8 *)CALLOC(2 * maxsize, sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("minarray not made", procName, NULL);
 
     if (vsize == 1) {
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                     buffer, minarray);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
     } else if (hsize == 1) {
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT,
-                     buffer, minarray);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT);
     } else {
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                     buffer, minarray);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_SET);
-        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                     buffer, minarray);
+        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
         pixDestroy(&pixt);
         pixt = pixClone(pixb);
     }
@@ -237,8 +254,6 @@ PIX       *pixb, *pixt, *pixd;
                 leftpix, rightpix, toppix, bottompix)) == NULL)
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
 
-    FREE(buffer);
-    FREE(minarray);
     pixDestroy(&pixb);
     pixDestroy(&pixt);
     return pixd;
@@ -249,22 +264,22 @@ PIX       *pixb, *pixt, *pixd;
  *  pixDilateGray()
  *
  *      Input:  pixs
- *              hsize  (of Sel; must be odd; origin implicitly in center)
- *              vsize  (ditto)
+ *              hsize  (of Sel; origin at hsize / 2)
+ *              vsize  (of Sel; origin at vsize / 2)
  *      Return: pixd
  *
  *  Notes:
  *      (1) Sel is a brick with all elements being hits
  *      (2) If hsize = vsize = 1, just returns a copy.
+ *      (3) The sizes can be even; see the notes at the top of this file.
  */
 PIX *
 pixDilateGray(PIX     *pixs,
               l_int32  hsize,
               l_int32  vsize)
 {
-l_uint8   *buffer, *maxarray;
 l_int32    w, h, wplb, wplt;
-l_int32    leftpix, rightpix, toppix, bottompix, maxsize;
+l_int32    leftpix, rightpix, toppix, bottompix;
 l_uint32  *datab, *datat;
 PIX       *pixb, *pixt, *pixd;
 
@@ -276,14 +291,6 @@ PIX       *pixb, *pixt, *pixd;
         return (PIX *)ERROR_PTR("pixs not 8 bpp", procName, NULL);
     if (hsize < 1 || vsize < 1)
         return (PIX *)ERROR_PTR("hsize or vsize < 1", procName, NULL);
-    if ((hsize & 1) == 0 ) {
-        L_WARNING("horiz sel size must be odd; increasing by 1\n", procName);
-        hsize++;
-    }
-    if ((vsize & 1) == 0 ) {
-        L_WARNING("vert sel size must be odd; increasing by 1\n", procName);
-        vsize++;
-    }
 
     if (hsize == 1 && vsize == 1)
         return pixCopy(NULL, pixs);
@@ -317,25 +324,16 @@ PIX       *pixb, *pixt, *pixd;
     wplb = pixGetWpl(pixb);
     wplt = pixGetWpl(pixt);
 
-    if ((buffer = (l_uint8 *)CALLOC(L_MAX(w, h), sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("buffer not made", procName, NULL);
-    maxsize = L_MAX(hsize, vsize);
-    if ((maxarray = (l_uint8 *)CALLOC(2 * maxsize, sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("buffer not made", procName, NULL);
 
     if (vsize == 1) {
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                      buffer, maxarray);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
     } else if (hsize == 1) {
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT,
-                      buffer, maxarray);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT);
     } else {
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                      buffer, maxarray);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_CLR);
-        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                      buffer, maxarray);
+        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
         pixDestroy(&pixt);
         pixt = pixClone(pixb);
     }
@@ -344,8 +342,6 @@ PIX       *pixb, *pixt, *pixd;
                 leftpix, rightpix, toppix, bottompix)) == NULL)
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
 
-    FREE(buffer);
-    FREE(maxarray);
     pixDestroy(&pixb);
     pixDestroy(&pixt);
     return pixd;
@@ -356,23 +352,22 @@ PIX       *pixb, *pixt, *pixd;
  *  pixOpenGray()
  *
  *      Input:  pixs
- *              hsize  (of Sel; must be odd; origin implicitly in center)
- *              vsize  (ditto)
+ *              hsize  (of Sel; origin at hsize / 2)
+ *              vsize  (of Sel; origin at vsize / 2)
  *      Return: pixd
  *
  *  Notes:
  *      (1) Sel is a brick with all elements being hits
  *      (2) If hsize = vsize = 1, just returns a copy.
+ *      (3) The sizes can be even; see the notes at the top of this file.
  */
 PIX *
 pixOpenGray(PIX     *pixs,
             l_int32  hsize,
             l_int32  vsize)
 {
-l_uint8   *buffer;
-l_uint8   *array;  /* used to find either min or max in interval */
 l_int32    w, h, wplb, wplt;
-l_int32    leftpix, rightpix, toppix, bottompix, maxsize;
+l_int32    leftpix, rightpix, toppix, bottompix;
 l_uint32  *datab, *datat;
 PIX       *pixb, *pixt, *pixd;
 
@@ -384,14 +379,6 @@ PIX       *pixb, *pixt, *pixd;
         return (PIX *)ERROR_PTR("pixs not 8 bpp", procName, NULL);
     if (hsize < 1 || vsize < 1)
         return (PIX *)ERROR_PTR("hsize or vsize < 1", procName, NULL);
-    if ((hsize & 1) == 0 ) {
-        L_WARNING("horiz sel size must be odd; increasing by 1\n", procName);
-        hsize++;
-    }
-    if ((vsize & 1) == 0 ) {
-        L_WARNING("vert sel size must be odd; increasing by 1\n", procName);
-        vsize++;
-    }
 
     if (hsize == 1 && vsize == 1)
         return pixCopy(NULL, pixs);
@@ -425,50 +412,35 @@ PIX       *pixb, *pixt, *pixd;
     wplb = pixGetWpl(pixb);
     wplt = pixGetWpl(pixt);
 
-    if ((buffer = (l_uint8 *)CALLOC(L_MAX(w, h), sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("buffer not made", procName, NULL);
-    maxsize = L_MAX(hsize, vsize);
-    if ((array = (l_uint8 *)CALLOC(2 * maxsize, sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("array not made", procName, NULL);
 
     if (vsize == 1) {
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                     buffer, array);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_CLR);
-        dilateGrayLow(datab, w, h, wplb, datat, wplt, hsize, L_HORIZ,
-                      buffer, array);
+        dilateGrayLow(datab, w, h, wplb, datat, wplt, hsize, L_HORIZ);
     }
     else if (hsize == 1) {
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT,
-                     buffer, array);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_CLR);
-        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                      buffer, array);
+        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
     } else {
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                     buffer, array);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_SET);
-        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                     buffer, array);
+        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
         pixSetOrClearBorder(pixb, leftpix, rightpix, toppix, bottompix,
                             PIX_CLR);
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                      buffer, array);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_CLR);
-        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                      buffer, array);
+        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
     }
 
     if ((pixd = pixRemoveBorderGeneral(pixb,
                 leftpix, rightpix, toppix, bottompix)) == NULL)
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
 
-    FREE(buffer);
-    FREE(array);
     pixDestroy(&pixb);
     pixDestroy(&pixt);
     return pixd;
@@ -479,23 +451,22 @@ PIX       *pixb, *pixt, *pixd;
  *  pixCloseGray()
  *
  *      Input:  pixs
- *              hsize  (of Sel; must be odd; origin implicitly in center)
- *              vsize  (ditto)
+ *              hsize  (of Sel; origin at hsize / 2)
+ *              vsize  (of Sel; origin at vsize / 2)
  *      Return: pixd
  *
  *  Notes:
  *      (1) Sel is a brick with all elements being hits
  *      (2) If hsize = vsize = 1, just returns a copy.
+ *      (3) The sizes can be even; see the notes at the top of this file.
  */
 PIX *
 pixCloseGray(PIX     *pixs,
              l_int32  hsize,
              l_int32  vsize)
 {
-l_uint8   *buffer;
-l_uint8   *array;  /* used to find either min or max in interval */
 l_int32    w, h, wplb, wplt;
-l_int32    leftpix, rightpix, toppix, bottompix, maxsize;
+l_int32    leftpix, rightpix, toppix, bottompix;
 l_uint32  *datab, *datat;
 PIX       *pixb, *pixt, *pixd;
 
@@ -507,14 +478,6 @@ PIX       *pixb, *pixt, *pixd;
         return (PIX *)ERROR_PTR("pixs not 8 bpp", procName, NULL);
     if (hsize < 1 || vsize < 1)
         return (PIX *)ERROR_PTR("hsize or vsize < 1", procName, NULL);
-    if ((hsize & 1) == 0 ) {
-        L_WARNING("horiz sel size must be odd; increasing by 1\n", procName);
-        hsize++;
-    }
-    if ((vsize & 1) == 0 ) {
-        L_WARNING("vert sel size must be odd; increasing by 1\n", procName);
-        vsize++;
-    }
 
     if (hsize == 1 && vsize == 1)
         return pixCopy(NULL, pixs);
@@ -548,49 +511,34 @@ PIX       *pixb, *pixt, *pixd;
     wplb = pixGetWpl(pixb);
     wplt = pixGetWpl(pixt);
 
-    if ((buffer = (l_uint8 *)CALLOC(L_MAX(w, h), sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("buffer not made", procName, NULL);
-    maxsize = L_MAX(hsize, vsize);
-    if ((array = (l_uint8 *)CALLOC(2 * maxsize, sizeof(l_uint8))) == NULL)
-        return (PIX *)ERROR_PTR("array not made", procName, NULL);
 
     if (vsize == 1) {
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                     buffer, array);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_SET);
-        erodeGrayLow(datab, w, h, wplb, datat, wplt, hsize, L_HORIZ,
-                      buffer, array);
+        erodeGrayLow(datab, w, h, wplb, datat, wplt, hsize, L_HORIZ);
     } else if (hsize == 1) {
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT,
-                     buffer, array);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, vsize, L_VERT);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_SET);
-        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                      buffer, array);
+        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
     } else {
-        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                      buffer, array);
+        dilateGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_CLR);
-        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                      buffer, array);
+        dilateGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
         pixSetOrClearBorder(pixb, leftpix, rightpix, toppix, bottompix,
                             PIX_SET);
-        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ,
-                     buffer, array);
+        erodeGrayLow(datat, w, h, wplt, datab, wplb, hsize, L_HORIZ);
         pixSetOrClearBorder(pixt, leftpix, rightpix, toppix, bottompix,
                             PIX_SET);
-        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT,
-                     buffer, array);
+        erodeGrayLow(datab, w, h, wplb, datat, wplt, vsize, L_VERT);
     }
 
     if ((pixd = pixRemoveBorderGeneral(pixb,
                 leftpix, rightpix, toppix, bottompix)) == NULL)
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
 
-    FREE(buffer);
-    FREE(array);
     pixDestroy(&pixb);
     pixDestroy(&pixt);
     return pixd;
@@ -1102,10 +1050,8 @@ PIX  *pixt, *pixb, *pixbd, *pixd;
  *
  *    Input:  datad, w, h, wpld (8 bpp image)
  *            datas, wpls  (8 bpp image, of same dimensions)
- *            size  (full length of SEL; restricted to odd numbers)
+ *            size  (full length of SEL)
  *            direction  (L_HORIZ or L_VERT)
- *            buffer  (holds full line or column of src image pixels)
- *            maxarray  (array of dimension 2*size+1)
  *    Return: void
  *
  *    Notes:
@@ -1128,82 +1074,10 @@ dilateGrayLow(l_uint32  *datad,
               l_uint32  *datas,
               l_int32    wpls,
               l_int32    size,
-              l_int32    direction,
-              l_uint8   *buffer,
-              l_uint8   *maxarray)
+              l_int32    direction)
 {
-l_int32    i, j, k;
-l_int32    hsize, nsteps, startmax, startx, starty;
-l_uint8    maxval;
-l_uint32  *lines, *lined;
-
-    if (direction == L_HORIZ) {
-        hsize = size / 2;
-        nsteps = (w - 2 * hsize) / size;
-        for (i = 0; i < h; i++) {
-            lines = datas + i * wpls;
-            lined = datad + i * wpld;
-
-                /* fill buffer with pixels in byte order */
-            for (j = 0; j < w; j++)
-                buffer[j] = GET_DATA_BYTE(lines, j);
-
-            for (j = 0; j < nsteps; j++) {
-                    /* refill the minarray */
-                startmax = (j + 1) * size - 1;
-                maxarray[size - 1] = buffer[startmax];
-                for (k = 1; k < size; k++) {
-                    maxarray[size - 1 - k] =
-                        L_MAX(maxarray[size - k], buffer[startmax - k]);
-                    maxarray[size - 1 + k] =
-                        L_MAX(maxarray[size + k - 2], buffer[startmax + k]);
-                }
-
-                    /* compute dilation values */
-                startx = hsize + j * size;
-                SET_DATA_BYTE(lined, startx, maxarray[0]);
-                SET_DATA_BYTE(lined, startx + size - 1, maxarray[2 * size - 2]);
-                for (k = 1; k < size - 1; k++) {
-                    maxval = L_MAX(maxarray[k], maxarray[k + size - 1]);
-                    SET_DATA_BYTE(lined, startx + k, maxval);
-                }
-            }
-        }
-    } else {  /* direction == L_VERT */
-        hsize = size / 2;
-        nsteps = (h - 2 * hsize) / size;
-        for (j = 0; j < w; j++) {
-                /* fill buffer with pixels in byte order */
-            for (i = 0; i < h; i++) {
-                lines = datas + i * wpls;
-                buffer[i] = GET_DATA_BYTE(lines, j);
-            }
-
-            for (i = 0; i < nsteps; i++) {
-                    /* refill the minarray */
-                startmax = (i + 1) * size - 1;
-                maxarray[size - 1] = buffer[startmax];
-                for (k = 1; k < size; k++) {
-                    maxarray[size - 1 - k] =
-                        L_MAX(maxarray[size - k], buffer[startmax - k]);
-                    maxarray[size - 1 + k] =
-                        L_MAX(maxarray[size + k - 2], buffer[startmax + k]);
-                }
-
-                    /* compute dilation values */
-                starty = hsize + i * size;
-                lined = datad + starty * wpld;
-                SET_DATA_BYTE(lined, j, maxarray[0]);
-                SET_DATA_BYTE(lined + (size - 1) * wpld, j,
-                        maxarray[2 * size - 2]);
-                for (k = 1; k < size - 1; k++) {
-                    maxval = L_MAX(maxarray[k], maxarray[k + size - 1]);
-                    SET_DATA_BYTE(lined + wpld * k, j, maxval);
-                }
-            }
-        }
-    }
-
+    morphGrayLow(datad, w, h, wpld, datas, wpls, size, direction,
+                 L_MORPH_DILATE);
     return;
 }
 
@@ -1213,17 +1087,55 @@ l_uint32  *lines, *lined;
  *
  *    Input:  datad, w, h, wpld (8 bpp image)
  *            datas, wpls  (8 bpp image, of same dimensions)
- *            size  (full length of SEL; restricted to odd numbers)
+ *            size  (full length of SEL)
  *            direction  (L_HORIZ or L_VERT)
- *            buffer  (holds full line or column of src image pixels)
- *            minarray  (array of dimension 2*size+1)
  *    Return: void
  *
  *    Notes:
- *        (1) See notes in dilateGrayLow()
+ *        (1) See notes in dilateGrayLow(); the src border pixels
+ *            are initialized to 255.
  */
 static void
 erodeGrayLow(l_uint32  *datad,
+             l_int32    w,
+             l_int32    h,
+             l_int32    wpld,
+             l_uint32  *datas,
+             l_int32    wpls,
+             l_int32    size,
+             l_int32    direction)
+{
+    morphGrayLow(datad, w, h, wpld, datas, wpls, size, direction,
+                 L_MORPH_ERODE);
+    return;
+}
+
+
+/*!
+ *  morphGrayLow()
+ *
+ *    Input:  datad, w, h, wpld (8 bpp image)
+ *            datas, wpls  (8 bpp image, of same dimensions)
+ *            size  (full length of SEL)
+ *            direction  (L_HORIZ or L_VERT)
+ *            type  (L_MORPH_DILATE or L_MORPH_ERODE)
+ *    Return: void
+ *
+ *    Notes:
+ *        (1) Vertical: the vHGW recursion runs down the raster lines,
+ *            and every step is a max or min of two full lines, which
+ *            is done on all columns at once.  Because the same op is
+ *            applied to every byte, this works directly on the raster
+ *            data, independent of byte order.
+ *        (2) Horizontal: the image is taken in strips of GRAY_STRIP
+ *            lines.  Each strip is transposed into a buffer where the
+ *            pixels of one column are consecutive, processed as in
+ *            the vertical case, and transposed back.
+ *        (3) Only the dest pixels for which the full Sel lies inside
+ *            the image are written.
+ */
+static void
+morphGrayLow(l_uint32  *datad,
              l_int32    w,
              l_int32    h,
              l_int32    wpld,
@@ -1231,80 +1143,245 @@ erodeGrayLow(l_uint32  *datad,
              l_int32    wpls,
              l_int32    size,
              l_int32    direction,
-             l_uint8   *buffer,
-             l_uint8   *minarray)
+             l_int32    type)
 {
-l_int32    i, j, k;
-l_int32    hsize, nsteps, startmin, startx, starty;
-l_uint8    minval;
+l_int32    i, j, k, nr, off, nsteps, level;
+l_uint8   *bufs, *bufd, *barray, *farray;
 l_uint32  *lines, *lined;
 
-    if (direction == L_HORIZ) {
-        hsize = size / 2;
-        nsteps = (w - 2 * hsize) / size;
-        for (i = 0; i < h; i++) {
-            lines = datas + i * wpls;
-            lined = datad + i * wpld;
-
-                /* fill buffer with pixels in byte order */
-            for (j = 0; j < w; j++)
-                buffer[j] = GET_DATA_BYTE(lines, j);
-
-            for (j = 0; j < nsteps; j++) {
-                    /* refill the minarray */
-                startmin = (j + 1) * size - 1;
-                minarray[size - 1] = buffer[startmin];
-                for (k = 1; k < size; k++) {
-                    minarray[size - 1 - k] =
-                        L_MIN(minarray[size - k], buffer[startmin - k]);
-                    minarray[size - 1 + k] =
-                        L_MIN(minarray[size + k - 2], buffer[startmin + k]);
-                }
-
-                    /* compute erosion values */
-                startx = hsize + j * size;
-                SET_DATA_BYTE(lined, startx, minarray[0]);
-                SET_DATA_BYTE(lined, startx + size - 1, minarray[2 * size - 2]);
-                for (k = 1; k < size - 1; k++) {
-                    minval = L_MIN(minarray[k], minarray[k + size - 1]);
-                    SET_DATA_BYTE(lined, startx + k, minval);
-                }
-            }
+    PROCNAME("morphGrayLow");
+
+    level = l_getSimdLevel();
+    if (direction == L_VERT) {
+        barray = (l_uint8 *)CALLOC(size * 4 * wpls, sizeof(l_uint8));
+        farray = (l_uint8 *)CALLOC(size * 4 * wpls, sizeof(l_uint8));
+        if (!barray || !farray) {
+            L_ERROR("arrays not made\n", procName);
+        } else {
+            vhgwLow((l_uint8 *)datad, 4 * wpld, (l_uint8 *)datas, 4 * wpls,
+                    4 * wpls, h, size, type, barray, farray, level);
         }
-    } else {  /* direction == L_VERT */
-        hsize = size / 2;
-        nsteps = (h - 2 * hsize) / size;
-        for (j = 0; j < w; j++) {
-                /* fill buffer with pixels in byte order */
-            for (i = 0; i < h; i++) {
-                lines = datas + i * wpls;
-                buffer[i] = GET_DATA_BYTE(lines, j);
-            }
+        FREE(barray);
+        FREE(farray);
+        return;
+    }
 
-            for (i = 0; i < nsteps; i++) {
-                    /* refill the minarray */
-                startmin = (i + 1) * size - 1;
-                minarray[size - 1] = buffer[startmin];
-                for (k = 1; k < size; k++) {
-                    minarray[size - 1 - k] =
-                        L_MIN(minarray[size - k], buffer[startmin - k]);
-                    minarray[size - 1 + k] =
-                        L_MIN(minarray[size + k - 2], buffer[startmin + k]);
-                }
-
-                    /* compute erosion values */
-                starty = hsize + i * size;
-                lined = datad + starty * wpld;
-                SET_DATA_BYTE(lined, j, minarray[0]);
-                SET_DATA_BYTE(lined + (size - 1) * wpld, j,
-                        minarray[2 * size - 2]);
-                for (k = 1; k < size - 1; k++) {
-                    minval = L_MIN(minarray[k], minarray[k + size - 1]);
-                    SET_DATA_BYTE(lined + wpld * k, j, minval);
-                }
+        /* L_HORIZ */
+    bufs = (l_uint8 *)CALLOC(GRAY_STRIP * w, sizeof(l_uint8));
+    bufd = (l_uint8 *)CALLOC(GRAY_STRIP * w, sizeof(l_uint8));
+    barray = (l_uint8 *)CALLOC(GRAY_STRIP * size, sizeof(l_uint8));
+    farray = (l_uint8 *)CALLOC(GRAY_STRIP * size, sizeof(l_uint8));
+    if (!bufs || !bufd || !barray || !farray) {
+        L_ERROR("buffers not made\n", procName);
+    } else {
+        off = (type == L_MORPH_DILATE) ? (size - 1) / 2 : size / 2;
+        nsteps = (w + 1) / size - 1;
+        for (i = 0; i < h; i += GRAY_STRIP) {
+            nr = L_MIN(GRAY_STRIP, h - i);
+            for (k = 0; k < nr; k++) {
+                lines = datas + (i + k) * wpls;
+                for (j = 0; j < w; j++)
+                    bufs[j * GRAY_STRIP + k] = GET_DATA_BYTE(lines, j);
+            }
+            vhgwLow(bufd, GRAY_STRIP, bufs, GRAY_STRIP, GRAY_STRIP, w,
+                    size, type, barray, farray, level);
+            for (k = 0; k < nr; k++) {
+                lined = datad + (i + k) * wpld;
+                for (j = off; j < off + nsteps * size; j++)
+                    SET_DATA_BYTE(lined, j, bufd[j * GRAY_STRIP + k]);
             }
         }
     }
 
+    FREE(bufs);
+    FREE(bufd);
+    FREE(barray);
+    FREE(farray);
     return;
 }
+
+
+/*!
+ *  vhgwLow()
+ *
+ *    Input:  bufd, strided (dest lines and byte stride between them)
+ *            bufs, strides (src lines and byte stride between them)
+ *            nbytes (bytes in each line)
+ *            n (number of lines)
+ *            size  (full length of SEL, along the lines)
+ *            type  (L_MORPH_DILATE or L_MORPH_ERODE)
+ *            barray, farray (each holding at least @size lines
+ *                            of @nbytes)
+ *            level (simd level)
+ *    Return: void
+ *
+ *    Notes:
+ *        (1) This is the vHGW algorithm, applied to @nbytes independent
+ *            1-D signals that run across the lines.  The lines are
+ *            taken in blocks of @size.  For block b, starting at line
+ *            s = b * size, barray[k] gets the extremum of lines
+ *            [s + k ... s + size - 1], and farray[k] gets the extremum
+ *            of lines [s + size ... s + size + k].  The Sel window
+ *            starting at line s + k then has the extremum
+ *                barray[k]                       for k = 0
+ *                extremum(barray[k], farray[k - 1])  for 0 < k < size
+ *            and this is put in dest line s + k + off, where @off is
+ *            the distance from the start of the Sel to its origin.
+ *        (2) The origin is at size / 2.  For even sizes the dilation
+ *            window is the reflection of the erosion window, so for
+ *            dilation off = (size - 1) / 2 and for erosion off = size / 2.
+ *            For odd sizes these are equal.
+ *        (3) Dest lines [off ... off + nsteps * size - 1] are written,
+ *            where nsteps = (n + 1) / size - 1 is the number of blocks
+ *            for which every src line read is in [0 ... n - 1].
+ */
+static void
+vhgwLow(l_uint8  *bufd,
+        l_int32   strided,
+        l_uint8  *bufs,
+        l_int32   strides,
+        l_int32   nbytes,
+        l_int32   n,
+        l_int32   size,
+        l_int32   type,
+        l_uint8  *barray,
+        l_uint8  *farray,
+        l_int32   level)
+{
+l_int32   b, k, start, off, nsteps;
+l_uint8  *lines;
+
+    off = (type == L_MORPH_DILATE) ? (size - 1) / 2 : size / 2;
+    nsteps = (n + 1) / size - 1;
+    for (b = 0; b < nsteps; b++) {
+        start = b * size;
+        lines = bufs + start * strides;
+
+            /* Backward extrema over block b */
+        memcpy(barray + (size - 1) * nbytes, lines + (size - 1) * strides,
+               nbytes);
+        for (k = size - 2; k >= 0; k--)
+            extremumLineLow(barray + k * nbytes, barray + (k + 1) * nbytes,
+                            lines + k * strides, nbytes, type, level);
+
+            /* Forward extrema over block b + 1 */
+        if (size > 1) {
+            lines += size * strides;
+            memcpy(farray, lines, nbytes);
+            for (k = 1; k < size - 1; k++)
+                extremumLineLow(farray + k * nbytes, farray + (k - 1) * nbytes,
+                                lines + k * strides, nbytes, type, level);
+        }
+
+            /* Combine */
+        memcpy(bufd + (start + off) * strided, barray, nbytes);
+        for (k = 1; k < size; k++)
+            extremumLineLow(bufd + (start + off + k) * strided,
+                            barray + k * nbytes, farray + (k - 1) * nbytes,
+                            nbytes, type, level);
+    }
+
+    return;
+}
+
+
+/*!
+ *  extremumLineLow()
+ *
+ *    Input:  lined (dest array)
+ *            line1, line2 (src arrays)
+ *            n (number of bytes)
+ *            type  (L_MORPH_DILATE for max; L_MORPH_ERODE for min)
+ *            level (simd level)
+ *    Return: void
+ *
+ *    Notes:
+ *        (1) lined[i] = max or min of line1[i] and line2[i].
+ */
+static void
+extremumLineLow(l_uint8  *lined,
+                l_uint8  *line1,
+                l_uint8  *line2,
+                l_int32   n,
+                l_int32   type,
+                l_int32   level)
+{
+l_int32  i;
+
+    i = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2)
+        i = extremumLineAVX2(lined, line1, line2, n, type);
+    else if (level == L_SIMD_SSE2)
+        i = extremumLineSSE2(lined, line1, line2, n, type);
+#endif  /* USE_SIMD */
+
+    if (type == L_MORPH_DILATE) {
+        for (; i < n; i++)
+            lined[i] = L_MAX(line1[i], line2[i]);
+    } else {
+        for (; i < n; i++)
+            lined[i] = L_MIN(line1[i], line2[i]);
+    }
+    return;
+}
+
+
+#if USE_SIMD
+/*!
+ *  extremumLineSSE2()
+ *
+ *    Input:  lined, line1, line2, n, type (as in extremumLineLow())
+ *    Return: number of bytes done (a multiple of 16)
+ */
+static l_int32  L_TARGET_SSE2
+extremumLineSSE2(l_uint8  *lined,
+                 l_uint8  *line1,
+                 l_uint8  *line2,
+                 l_int32   n,
+                 l_int32   type)
+{
+l_int32  i;
+__m128i  v1, v2;
+
+    for (i = 0; i + 16 <= n; i += 16) {
+        v1 = _mm_loadu_si128((const __m128i *)(line1 + i));
+        v2 = _mm_loadu_si128((const __m128i *)(line2 + i));
+        if (type == L_MORPH_DILATE)
+            _mm_storeu_si128((__m128i *)(lined + i), _mm_max_epu8(v1, v2));
+        else
+            _mm_storeu_si128((__m128i *)(lined + i), _mm_min_epu8(v1, v2));
+    }
+    return i;
+}
+
+
+/*!
+ *  extremumLineAVX2()
+ *
+ *    Input:  lined, line1, line2, n, type (as in extremumLineLow())
+ *    Return: number of bytes done (a multiple of 32)
+ */
+static l_int32  L_TARGET_AVX2
+extremumLineAVX2(l_uint8  *lined,
+                 l_uint8  *line1,
+                 l_uint8  *line2,
+                 l_int32   n,
+                 l_int32   type)
+{
+l_int32  i;
+__m256i  v1, v2;
+
+    for (i = 0; i + 32 <= n; i += 32) {
+        v1 = _mm256_loadu_si256((const __m256i *)(line1 + i));
+        v2 = _mm256_loadu_si256((const __m256i *)(line2 + i));
+        if (type == L_MORPH_DILATE)
+            _mm256_storeu_si256((__m256i *)(lined + i),
+                                _mm256_max_epu8(v1, v2));
+        else
+            _mm256_storeu_si256((__m256i *)(lined + i),
+                                _mm256_min_epu8(v1, v2));
+    }
+    return i;
+}
+#endif  /* USE_SIMD */
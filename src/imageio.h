@@ -202,4 +202,42 @@ struct L_Pdf_Data
 typedef struct L_Pdf_Data  L_PDF_DATA;
 
 
+/* ------------------ Multipage pdf output, page by page ------------------ */
+/*
+ *  This writes a multipage pdf as the pages are added.  Each object is
+ *  written out as soon as it is made; only the locations of the objects
+ *  and the object numbers of the pages are kept until the end.
+ *
+ *  The output goes either to a stream or to a function that is called
+ *  with each block of bytes.  The function returns 0 if OK, 1 on error.
+ */
+typedef l_int32 (*L_PDF_WRITE_FUNC)(void *handle, const l_uint8 *data,
+                                    size_t nbytes);
+
+struct L_Pdf_Writer
+{
+    FILE              *fp;           /* output stream, or null              */
+    L_PDF_WRITE_FUNC   func;         /* output function, if no stream       */
+    void              *handle;       /* handed to the output function       */
+    char              *title;        /* optional title for pdf              */
+    size_t             nbytes;       /* number of bytes written             */
+    l_int32            nextobj;      /* number for the next new object      */
+    l_int32            error;        /* set when the output has failed      */
+    struct L_Dna      *objloc;       /* location of each object written     */
+    struct Numa       *napage;       /* object number of each page          */
+};
+typedef struct L_Pdf_Writer  L_PDF_WRITER;
+
+
+/* --------------------- Tiff read/write in bands ------------------------ */
+/*
+ *  This is opaque; it is defined in tiffio.c.  It holds an open tiff
+ *  image that is read or written a band of rows at a time.
+ */
+typedef struct L_TiffStream  L_TIFF_STREAM;
+
+    /* Function applied to each band by tiffstreamProcess() */
+typedef struct Pix *(*L_TIFF_BAND_FUNC)(struct Pix *pixs, void *data);
+
+
 #endif  /* LEPTONICA_IMAGEIO_H */
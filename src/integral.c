@@ -0,0 +1,682 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  integral.c
+ *
+ *      Create/destroy
+ *          L_INTEGRAL   *l_integralCreate()
+ *          void          l_integralDestroy()
+ *          l_int32       l_integralGetDimensions()
+ *
+ *      Sums and statistics in a rectangle
+ *          l_int32       l_integralGetSums()
+ *          l_int32       l_integralGetStats()
+ *
+ *      Statistics in a window about each pixel
+ *          l_int32       l_integralWindowedStats()
+ *
+ *      Statistics in tiles and in quadtree regions
+ *          l_int32       l_integralTiledStats()
+ *          l_int32       l_integralQuadtreeStats()
+ *
+ *  The integral image (also called the summed area table) holds at
+ *  each location (x, y) the sum of all pixel values, and optionally
+ *  of all squared pixel values, in the rectangle from the origin
+ *  up to, but not including, (x, y).  It is made with one pass over
+ *  the image, after which the sum, mean and variance in any rectangle
+ *  are found from 4 values, independent of the size of the rectangle.
+ *
+ *  The same integral image can then be used for windows of any size,
+ *  for sets of boxes, for tilings and for quadtrees.  For example,
+ *  pixSauvolaBinarize() gets both the local mean and the local mean
+ *  square from a single integral image, and pixQuadtreeMean() and
+ *  pixQuadtreeVariance() use it for all levels of the quadtree.
+ *
+ *  The sums are 64 bit integers, so they are exact for any image
+ *  that fits in memory.  By comparison, the 32 bpp accumulator made
+ *  by pixBlockconvAccum() overflows for an 8 bpp image with more
+ *  than 2^24 pixels.  The cost is 8 bytes/pixel for the sums and
+ *  another 8 bytes/pixel for the sums of squares.  For very large
+ *  images where only local statistics are required, it is better
+ *  to work on tiles; e.g., with pixSauvolaBinarizeTiled().
+ */
+
+#include <math.h>
+#include "allheaders.h"
+
+
+/*----------------------------------------------------------------------*
+ *                           Create/destroy                             *
+ *----------------------------------------------------------------------*/
+/*!
+ *  l_integralCreate()
+ *
+ *      Input:  pixs (1 or 8 bpp; no colormap)
+ *              sqflag (1 to also make the sums of squared values;
+ *                      0 for only the sums of values)
+ *      Return: li, or null on error
+ *
+ *  Notes:
+ *      (1) The sums are stored in an array of size (w + 1) x (h + 1),
+ *          where the first row and the first column are 0.  The value
+ *          at (x, y) is the sum over the pixels (j, i) with j < x
+ *          and i < y.  With this layout, the sum in any rectangle is
+ *          found without special treatment of the first row and column.
+ *      (2) The sums of squares are required for variance and
+ *          rms deviation.  For 1 bpp they are the same as the sums.
+ */
+L_INTEGRAL *
+l_integralCreate(PIX     *pixs,
+                 l_int32  sqflag)
+{
+l_int32      i, j, w, h, d, wpls, wpl, val;
+l_uint32    *datas, *lines;
+l_uint64     rowsum, rowsumsq;
+l_uint64    *line, *linep, *linesq, *linesqp;
+size_t       size;
+L_INTEGRAL  *li;
+
+    PROCNAME("l_integralCreate");
+
+    if (!pixs)
+        return (L_INTEGRAL *)ERROR_PTR("pixs not defined", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, &d);
+    if (d != 1 && d != 8)
+        return (L_INTEGRAL *)ERROR_PTR("pixs not 1 or 8 bpp", procName, NULL);
+    if (pixGetColormap(pixs))
+        return (L_INTEGRAL *)ERROR_PTR("pixs is colormapped", procName, NULL);
+
+    if ((li = (L_INTEGRAL *)CALLOC(1, sizeof(L_INTEGRAL))) == NULL)
+        return (L_INTEGRAL *)ERROR_PTR("li not made", procName, NULL);
+    li->w = w;
+    li->h = h;
+    li->d = d;
+    li->wpl = wpl = w + 1;
+    size = (size_t)wpl * (h + 1);
+    if ((li->sum = (l_uint64 *)CALLOC(size, sizeof(l_uint64))) == NULL) {
+        l_integralDestroy(&li);
+        return (L_INTEGRAL *)ERROR_PTR("sum not made", procName, NULL);
+    }
+    if (sqflag &&
+        (li->sumsq = (l_uint64 *)CALLOC(size, sizeof(l_uint64))) == NULL) {
+        l_integralDestroy(&li);
+        return (L_INTEGRAL *)ERROR_PTR("sumsq not made", procName, NULL);
+    }
+
+        /* Each sum is the sum in the line above plus the sum of
+         * the values to the left on this line. */
+    datas = pixGetData(pixs);
+    wpls = pixGetWpl(pixs);
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        linep = li->sum + (size_t)i * wpl;
+        line = linep + wpl;
+        rowsum = 0;
+        if (!li->sumsq) {
+            for (j = 0; j < w; j++) {
+                if (d == 8)
+                    rowsum += GET_DATA_BYTE(lines, j);
+                else  /* d == 1 */
+                    rowsum += GET_DATA_BIT(lines, j);
+                line[j + 1] = linep[j + 1] + rowsum;
+            }
+        } else {
+            linesqp = li->sumsq + (size_t)i * wpl;
+            linesq = linesqp + wpl;
+            rowsumsq = 0;
+            for (j = 0; j < w; j++) {
+                if (d == 8)
+                    val = GET_DATA_BYTE(lines, j);
+                else  /* d == 1 */
+                    val = GET_DATA_BIT(lines, j);
+                rowsum += val;
+                rowsumsq += val * val;
+                line[j + 1] = linep[j + 1] + rowsum;
+                linesq[j + 1] = linesqp[j + 1] + rowsumsq;
+            }
+        }
+    }
+
+    return li;
+}
+
+
+/*!
+ *  l_integralDestroy()
+ *
+ *      Input:  &li (<will be set to null before returning>)
+ *      Return: void
+ */
+void
+l_integralDestroy(L_INTEGRAL  **pli)
+{
+L_INTEGRAL  *li;
+
+    PROCNAME("l_integralDestroy");
+
+    if (pli == NULL) {
+        L_WARNING("ptr address is null!\n", procName);
+        return;
+    }
+    if ((li = *pli) == NULL)
+        return;
+
+    if (li->sum) FREE(li->sum);
+    if (li->sumsq) FREE(li->sumsq);
+    FREE(li);
+    *pli = NULL;
+    return;
+}
+
+
+/*!
+ *  l_integralGetDimensions()
+ *
+ *      Input:  li
+ *              &w, &h, &d (<optional return> of the source image)
+ *      Return: 0 if OK, 1 on error
+ */
+l_int32
+l_integralGetDimensions(L_INTEGRAL  *li,
+                        l_int32     *pw,
+                        l_int32     *ph,
+                        l_int32     *pd)
+{
+    PROCNAME("l_integralGetDimensions");
+
+    if (pw) *pw = 0;
+    if (ph) *ph = 0;
+    if (pd) *pd = 0;
+    if (!li)
+        return ERROR_INT("li not defined", procName, 1);
+    if (pw) *pw = li->w;
+    if (ph) *ph = li->h;
+    if (pd) *pd = li->d;
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------*
+ *                 Sums and statistics in a rectangle                   *
+ *----------------------------------------------------------------------*/
+/*!
+ *  l_integralGetSums()
+ *
+ *      Input:  li
+ *              x, y, w, h (of the rectangle)
+ *              &sum (<optional return> sum of values in the rectangle)
+ *              &sumsq (<optional return> sum of squared values)
+ *              &npix (<optional return> number of pixels in the rectangle)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The rectangle is clipped to the image.  If nothing is
+ *          left, the sums and @npix are 0; this is not an error.
+ *      (2) @sumsq can only be requested if the squares were
+ *          accumulated in l_integralCreate().
+ */
+l_int32
+l_integralGetSums(L_INTEGRAL  *li,
+                  l_int32      x,
+                  l_int32      y,
+                  l_int32      w,
+                  l_int32      h,
+                  l_uint64    *psum,
+                  l_uint64    *psumsq,
+                  l_int32     *pnpix)
+{
+l_int32    x0, y0, x1, y1, wpl;
+l_uint64  *line0, *line1;
+
+    PROCNAME("l_integralGetSums");
+
+    if (psum) *psum = 0;
+    if (psumsq) *psumsq = 0;
+    if (pnpix) *pnpix = 0;
+    if (!li)
+        return ERROR_INT("li not defined", procName, 1);
+    if (psumsq && !li->sumsq)
+        return ERROR_INT("squares were not accumulated", procName, 1);
+
+    x0 = L_MAX(0, x);
+    y0 = L_MAX(0, y);
+    x1 = L_MIN(li->w, x + w);
+    y1 = L_MIN(li->h, y + h);
+    if (x1 <= x0 || y1 <= y0)
+        return 0;
+
+    wpl = li->wpl;
+    if (psum) {
+        line0 = li->sum + (size_t)y0 * wpl;
+        line1 = li->sum + (size_t)y1 * wpl;
+        *psum = line1[x1] - line1[x0] - line0[x1] + line0[x0];
+    }
+    if (psumsq) {
+        line0 = li->sumsq + (size_t)y0 * wpl;
+        line1 = li->sumsq + (size_t)y1 * wpl;
+        *psumsq = line1[x1] - line1[x0] - line0[x1] + line0[x0];
+    }
+    if (pnpix) *pnpix = (x1 - x0) * (y1 - y0);
+    return 0;
+}
+
+
+/*!
+ *  l_integralGetStats()
+ *
+ *      Input:  li
+ *              box (<optional> region; use null for the entire image)
+ *              &mean (<optional return> mean value in the box)
+ *              &var (<optional return> variance in the box)
+ *              &rvar (<optional return> rms deviation from the mean)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The box is clipped to the image.  It is an error if
+ *          there are no pixels in the clipped box.
+ *      (2) This finds the mean, and the variance and/or its square
+ *          root, in O(1), independent of the size of the box.
+ *          See pixMeanInRectangle() and pixVarianceInRectangle().
+ *      (3) The variance and rms deviation require that the squares
+ *          were accumulated in l_integralCreate().
+ */
+l_int32
+l_integralGetStats(L_INTEGRAL  *li,
+                   BOX         *box,
+                   l_float32   *pmean,
+                   l_float32   *pvar,
+                   l_float32   *prvar)
+{
+l_int32    bx, by, bw, bh, npix;
+l_uint64   sum, sumsq;
+l_float64  mean, var;
+
+    PROCNAME("l_integralGetStats");
+
+    if (pmean) *pmean = 0.0;
+    if (pvar) *pvar = 0.0;
+    if (prvar) *prvar = 0.0;
+    if (!pmean && !pvar && !prvar)
+        return ERROR_INT("no output requested", procName, 1);
+    if (!li)
+        return ERROR_INT("li not defined", procName, 1);
+    if ((pvar || prvar) && !li->sumsq)
+        return ERROR_INT("squares were not accumulated", procName, 1);
+
+    if (box) {
+        boxGetGeometry(box, &bx, &by, &bw, &bh);
+    } else {
+        bx = by = 0;
+        bw = li->w;
+        bh = li->h;
+    }
+    l_integralGetSums(li, bx, by, bw, bh, &sum,
+                      (pvar || prvar) ? &sumsq : NULL, &npix);
+    if (npix == 0)
+        return ERROR_INT("no pixels in box", procName, 1);
+
+    mean = (l_float64)sum / npix;
+    if (pmean) *pmean = (l_float32)mean;
+    if (pvar || prvar) {
+        var = (l_float64)sumsq / npix - mean * mean;
+        if (var < 0.0) var = 0.0;  /* roundoff */
+        if (pvar) *pvar = (l_float32)var;
+        if (prvar) *prvar = (l_float32)sqrt(var);
+    }
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------*
+ *                Statistics in a window about each pixel               *
+ *----------------------------------------------------------------------*/
+/*!
+ *  l_integralWindowedStats()
+ *
+ *      Input:  li (made from an 8 bpp image)
+ *              wc, hc   (half width/height of window; >= 0)
+ *              hasborder (1 if the image has (wc + 1) border pixels
+ *                         on left and right, and (hc + 1) on top and
+ *                         bottom, which are removed from the output;
+ *                         0 to clip the window to the image)
+ *              &pixm (<optional return> 8 bpp mean value in window)
+ *              &pixms (<optional return> 32 bpp mean square value
+ *                      in window)
+ *              &fpixv (<optional return> float variance in window)
+ *              &fpixrv (<optional return> float rms deviation from
+ *                       the mean)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The window is (2 * wc + 1) x (2 * hc + 1), centered on
+ *          each pixel.  Any number of window sizes can be used with
+ *          the same integral image.
+ *      (2) With @hasborder = 1, the output is the same as that from
+ *          pixWindowedMean() and pixWindowedMeanSquare() on the image
+ *          that li was made from, and the size of the output is
+ *          reduced by the border.  With @hasborder = 0, the output is
+ *          the size of the image, and near the boundary the statistics
+ *          are taken over the part of the window within the image.
+ *      (3) The mean and mean square are truncated to integers in
+ *          pixm and pixms.  The variance and rms deviation are found
+ *          from the exact sums.
+ *      (4) The mean square, variance and rms deviation require that
+ *          the squares were accumulated in l_integralCreate().
+ */
+l_int32
+l_integralWindowedStats(L_INTEGRAL  *li,
+                        l_int32      wc,
+                        l_int32      hc,
+                        l_int32      hasborder,
+                        PIX        **ppixm,
+                        PIX        **ppixms,
+                        FPIX       **pfpixv,
+                        FPIX       **pfpixrv)
+{
+l_int32     i, j, w, h, wd, hd, wpl, wplm, wplms, wplv, wplrv;
+l_int32     x0, x1, y0, y1, npix, wincr, hincr;
+l_uint32   *datam, *datams, *linem, *linems;
+l_uint64    sum, sumsq;
+l_uint64   *line0, *line1, *linesq0, *linesq1;
+l_float32   normf;
+l_float32  *datav, *datarv, *linev, *linerv;
+l_float64   norm, mean, var;
+FPIX       *fpixv, *fpixrv;
+PIX        *pixm, *pixms;
+
+    PROCNAME("l_integralWindowedStats");
+
+    if (!ppixm && !ppixms && !pfpixv && !pfpixrv)
+        return ERROR_INT("no output requested", procName, 1);
+    if (ppixm) *ppixm = NULL;
+    if (ppixms) *ppixms = NULL;
+    if (pfpixv) *pfpixv = NULL;
+    if (pfpixrv) *pfpixrv = NULL;
+    if (!li || li->d != 8)
+        return ERROR_INT("li not defined or not from 8 bpp", procName, 1);
+    if ((ppixms || pfpixv || pfpixrv) && !li->sumsq)
+        return ERROR_INT("squares were not accumulated", procName, 1);
+    if (wc < 0 || hc < 0)
+        return ERROR_INT("wc and hc not >= 0", procName, 1);
+
+    w = li->w;
+    h = li->h;
+    if (hasborder) {
+        wd = w - 2 * (wc + 1);
+        hd = h - 2 * (hc + 1);
+    } else {
+        wd = w;
+        hd = h;
+    }
+    if (wd < 1 || hd < 1)
+        return ERROR_INT("w or h too small for window", procName, 1);
+
+    pixm = pixms = NULL;
+    fpixv = fpixrv = NULL;
+    datam = datams = NULL;
+    datav = datarv = NULL;
+    linem = linems = NULL;
+    linev = linerv = NULL;
+    linesq0 = linesq1 = NULL;
+    wplm = wplms = wplv = wplrv = 0;
+    if (ppixm) {
+        pixm = pixCreate(wd, hd, 8);
+        datam = pixGetData(pixm);
+        wplm = pixGetWpl(pixm);
+        *ppixm = pixm;
+    }
+    if (ppixms) {
+        pixms = pixCreate(wd, hd, 32);
+        datams = pixGetData(pixms);
+        wplms = pixGetWpl(pixms);
+        *ppixms = pixms;
+    }
+    if (pfpixv) {
+        fpixv = fpixCreate(wd, hd);
+        datav = fpixGetData(fpixv);
+        wplv = fpixGetWpl(fpixv);
+        *pfpixv = fpixv;
+    }
+    if (pfpixrv) {
+        fpixrv = fpixCreate(wd, hd);
+        datarv = fpixGetData(fpixrv);
+        wplrv = fpixGetWpl(fpixrv);
+        *pfpixrv = fpixrv;
+    }
+
+        /* Use the same arithmetic as pixWindowedMean() and
+         * pixWindowedMeanSquare() for the truncated values */
+    wpl = li->wpl;
+    wincr = 2 * wc + 1;
+    hincr = 2 * hc + 1;
+    norm = 1.0 / (wincr * hincr);
+    normf = norm;
+    for (i = 0; i < hd; i++) {
+        if (hasborder) {
+            y0 = i + 1;
+            y1 = y0 + hincr;
+        } else {
+            y0 = L_MAX(0, i - hc);
+            y1 = L_MIN(h, i + hc + 1);
+        }
+        line0 = li->sum + (size_t)y0 * wpl;
+        line1 = li->sum + (size_t)y1 * wpl;
+        if (li->sumsq) {
+            linesq0 = li->sumsq + (size_t)y0 * wpl;
+            linesq1 = li->sumsq + (size_t)y1 * wpl;
+        }
+        if (pixm) linem = datam + i * wplm;
+        if (pixms) linems = datams + i * wplms;
+        if (fpixv) linev = datav + i * wplv;
+        if (fpixrv) linerv = datarv + i * wplrv;
+        for (j = 0; j < wd; j++) {
+            if (hasborder) {
+                x0 = j + 1;
+                x1 = x0 + wincr;
+            } else {
+                x0 = L_MAX(0, j - wc);
+                x1 = L_MIN(w, j + wc + 1);
+                npix = (x1 - x0) * (y1 - y0);
+                norm = 1.0 / npix;
+                normf = norm;
+            }
+            sum = line1[x1] - line1[x0] - line0[x1] + line0[x0];
+            if (pixm)
+                SET_DATA_BYTE(linem, j, (l_uint8)(normf * (l_float32)sum));
+            if (!linesq0)
+                continue;
+            sumsq = linesq1[x1] - linesq1[x0] - linesq0[x1] + linesq0[x0];
+            if (pixms)
+                linems[j] = (l_uint32)(norm * (l_float64)sumsq);
+            if (fpixv || fpixrv) {
+                mean = norm * (l_float64)sum;
+                var = norm * (l_float64)sumsq - mean * mean;
+                if (var < 0.0) var = 0.0;  /* roundoff */
+                if (fpixv) linev[j] = (l_float32)var;
+                if (fpixrv) linerv[j] = (l_float32)sqrt(var);
+            }
+        }
+    }
+
+    return 0;
+}
+
+
+/*----------------------------------------------------------------------*
+ *              Statistics in tiles and in quadtree regions             *
+ *----------------------------------------------------------------------*/
+/*!
+ *  l_integralTiledStats()
+ *
+ *      Input:  li
+ *              sx, sy (tile size; each >= 1)
+ *              &fpixm (<optional return> mean value in each tile)
+ *              &fpixv (<optional return> variance in each tile)
+ *              &fpixrv (<optional return> rms deviation from the mean
+ *                       in each tile)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The output fpix have one value for each tile, and are of
+ *          size ((w + sx - 1) / sx) x ((h + sy - 1) / sy).  Unlike
+ *          pixGetAverageTiled(), the partial tiles at the right and
+ *          bottom are included; their statistics are taken over the
+ *          pixels within the image.
+ *      (2) The variance and rms deviation require that the squares
+ *          were accumulated in l_integralCreate().
+ */
+l_int32
+l_integralTiledStats(L_INTEGRAL  *li,
+                     l_int32      sx,
+                     l_int32      sy,
+                     FPIX       **pfpixm,
+                     FPIX       **pfpixv,
+                     FPIX       **pfpixrv)
+{
+l_int32    i, j, nx, ny, npix;
+l_uint64   sum, sumsq;
+l_float64  mean, var;
+
+    PROCNAME("l_integralTiledStats");
+
+    if (!pfpixm && !pfpixv && !pfpixrv)
+        return ERROR_INT("no output requested", procName, 1);
+    if (pfpixm) *pfpixm = NULL;
+    if (pfpixv) *pfpixv = NULL;
+    if (pfpixrv) *pfpixrv = NULL;
+    if (!li)
+        return ERROR_INT("li not defined", procName, 1);
+    if ((pfpixv || pfpixrv) && !li->sumsq)
+        return ERROR_INT("squares were not accumulated", procName, 1);
+    if (sx < 1 || sy < 1)
+        return ERROR_INT("sx and sy not >= 1", procName, 1);
+
+    sumsq = 0;
+    nx = (li->w + sx - 1) / sx;
+    ny = (li->h + sy - 1) / sy;
+    if (pfpixm) *pfpixm = fpixCreate(nx, ny);
+    if (pfpixv) *pfpixv = fpixCreate(nx, ny);
+    if (pfpixrv) *pfpixrv = fpixCreate(nx, ny);
+    for (i = 0; i < ny; i++) {
+        for (j = 0; j < nx; j++) {
+            l_integralGetSums(li, j * sx, i * sy, sx, sy, &sum,
+                              (li->sumsq) ? &sumsq : NULL, &npix);
+            mean = (l_float64)sum / npix;
+            if (pfpixm) fpixSetPixel(*pfpixm, j, i, (l_float32)mean);
+            if (!pfpixv && !pfpixrv)
+                continue;
+            var = (l_float64)sumsq / npix - mean * mean;
+            if (var < 0.0) var = 0.0;  /* roundoff */
+            if (pfpixv) fpixSetPixel(*pfpixv, j, i, (l_float32)var);
+            if (pfpixrv) fpixSetPixel(*pfpixrv, j, i, (l_float32)sqrt(var));
+        }
+    }
+
+    return 0;
+}
+
+
+/*!
+ *  l_integralQuadtreeStats()
+ *
+ *      Input:  li
+ *              nlevels (in quadtree; max allowed depends on image size)
+ *              &fpixam (<optional return> mean values in quadtree)
+ *              &fpixav (<optional return> variance values in quadtree)
+ *              &fpixarv (<optional return> root variance values in
+ *                        quadtree)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Each returned fpixa has @nlevels of fpix, holding the
+ *          values at the respective levels.  Level 0 has a single
+ *          value; level 1 has 4 values; level 2 has 16; etc.
+ *          See pixQuadtreeMean() and pixQuadtreeVariance().
+ *      (2) All levels, and the mean and variance, are found from
+ *          the one integral image.
+ */
+l_int32
+l_integralQuadtreeStats(L_INTEGRAL  *li,
+                        l_int32      nlevels,
+                        FPIXA      **pfpixam,
+                        FPIXA      **pfpixav,
+                        FPIXA      **pfpixarv)
+{
+l_int32    i, j, n, size;
+l_float32  mean, var, rvar;
+BOX       *box;
+BOXA      *boxa;
+BOXAA     *baa;
+FPIX      *fpixm, *fpixv, *fpixrv;
+
+    PROCNAME("l_integralQuadtreeStats");
+
+    if (!pfpixam && !pfpixav && !pfpixarv)
+        return ERROR_INT("no output requested", procName, 1);
+    if (pfpixam) *pfpixam = NULL;
+    if (pfpixav) *pfpixav = NULL;
+    if (pfpixarv) *pfpixarv = NULL;
+    if (!li)
+        return ERROR_INT("li not defined", procName, 1);
+    if ((pfpixav || pfpixarv) && !li->sumsq)
+        return ERROR_INT("squares were not accumulated", procName, 1);
+    if (nlevels > quadtreeMaxLevels(li->w, li->h))
+        return ERROR_INT("nlevels too large for image", procName, 1);
+
+    if ((baa = boxaaQuadtreeRegions(li->w, li->h, nlevels)) == NULL)
+        return ERROR_INT("baa not made", procName, 1);
+
+    if (pfpixam) *pfpixam = fpixaCreate(nlevels);
+    if (pfpixav) *pfpixav = fpixaCreate(nlevels);
+    if (pfpixarv) *pfpixarv = fpixaCreate(nlevels);
+    fpixm = fpixv = fpixrv = NULL;
+    for (i = 0; i < nlevels; i++) {
+        boxa = boxaaGetBoxa(baa, i, L_CLONE);
+        size = 1 << i;
+        n = boxaGetCount(boxa);  /* n == size * size */
+        if (pfpixam) fpixm = fpixCreate(size, size);
+        if (pfpixav) fpixv = fpixCreate(size, size);
+        if (pfpixarv) fpixrv = fpixCreate(size, size);
+        for (j = 0; j < n; j++) {
+            box = boxaGetBox(boxa, j, L_CLONE);
+            l_integralGetStats(li, box, &mean,
+                               (pfpixav || pfpixarv) ? &var : NULL,
+                               (pfpixav || pfpixarv) ? &rvar : NULL);
+            if (pfpixam) fpixSetPixel(fpixm, j % size, j / size, mean);
+            if (pfpixav) fpixSetPixel(fpixv, j % size, j / size, var);
+            if (pfpixarv) fpixSetPixel(fpixrv, j % size, j / size, rvar);
+            boxDestroy(&box);
+        }
+        if (pfpixam) fpixaAddFPix(*pfpixam, fpixm, L_INSERT);
+        if (pfpixav) fpixaAddFPix(*pfpixav, fpixv, L_INSERT);
+        if (pfpixarv) fpixaAddFPix(*pfpixarv, fpixrv, L_INSERT);
+        boxaDestroy(&boxa);
+    }
+
+    boxaaDestroy(&baa);
+    return 0;
+}
@@ -88,6 +88,14 @@
  *         static void       findSimilarSizedTemplatesDestroy()
  *         static l_int32    finalPositioningForAlignment()
  *
+ *     Static helpers for parallel classification
+ *
+ *         static l_int32    jbPageJob()
+ *         static l_int32    jbCorrelPrepareJob()
+ *         static l_int32    jbCorrelMatchJob()
+ *         static l_int32    jbCorrelationMatch()
+ *         static void       jbCorrelDataFree()
+ *
  *     Note: this is NOT an implementation of the JPEG jbig2
  *     proposed standard encoder, the specifications for which
  *     can be found at http://www.jpeg.org/jbigpt2.html.
@@ -168,6 +176,13 @@
  *     As mentioned above, if visual substitution errors must be
  *     avoided, you should use the correlation method.
  *
+ *     Classification can use several threads (see l_setNumThreads()).
+ *     jbAddPages() reads the pages and finds their components in
+ *     parallel, and jbClassifyCorrelation() matches the components of
+ *     each page against the templates in parallel.  The classes are
+ *     always assigned in the order of the components, so the result
+ *     is the same for any number of threads.
+ *
  *     We provide executables that show how to do the encoding:
  *         prog/jbrankhaus.c
  *         prog/jbcorrelation.c
@@ -242,11 +257,54 @@ struct JbFindTemplatesState
     l_int32          w;          /* desired width                         */
     l_int32          h;          /* desired height                        */
     l_int32          i;          /* index into two_by_two step array      */
-    NUMA            *numa;       /* current number array                  */
+    NUMA            *numa;       /* current number array (not owned)      */
     l_int32          n;          /* current element of numa               */
+    l_int32          mintempl;   /* smallest template index to return     */
 };
 typedef struct JbFindTemplatesState JBFINDCTX;
 
+    /* For jbClassifyCorrelation(): number of components that are
+     * matched in parallel against the same set of templates */
+static const l_int32  JB_MATCH_BATCH = 500;
+
+    /* For jbAddPages(): a batch of pages that are read and
+     * decomposed into components in parallel */
+struct JbPageBatch
+{
+    JBCLASSER       *classer;    /* classer                               */
+    SARRAY          *safiles;    /* page image file names                 */
+    l_int32          first;      /* index of first file in the batch      */
+    l_int32          npages;     /* number of pages in the batch          */
+    PIX            **pix;        /* page images; null if not used         */
+    BOXA           **boxa;       /* b.b. of components of each page       */
+    PIXA           **pixa;       /* components of each page               */
+};
+typedef struct JbPageBatch JBPAGEBATCH;
+
+    /* For jbClassifyCorrelation(): the components of a page, with
+     * the data used to match them in parallel */
+struct JbCorrelData
+{
+    JBCLASSER       *classer;    /* classer                               */
+    PIXA            *pixas;      /* unbordered components                 */
+    l_int32          n;          /* number of components                  */
+    PIX            **pixb;       /* bordered components                   */
+    l_int32         *pixcts;     /* number of fg pixels in each component */
+    l_int32        **pixrowcts;  /* fg pixels below each row; see below   */
+    l_float32       *xcen;       /* centroids of bordered components      */
+    l_float32       *ycen;
+    l_int32         *match;      /* first matching template (< nsnap)     */
+                                 /* for each component, or -1             */
+    l_int32         *matchstep;  /* step in the walk of that match        */
+    l_int32         *sumtab;     /* table for counting fg pixels          */
+    l_int32         *centtab;    /* table for centroids                   */
+    l_int32          first;      /* first component of the current batch  */
+    l_int32          last;       /* last component (+ 1) of the batch     */
+    l_int32          nsnap;      /* number of templates at batch start    */
+    l_int32          njobs;      /* number of parallel jobs               */
+};
+typedef struct JbCorrelData JBCORRELDATA;
+
     /* Static initialization function */
 static JBCLASSER * jbCorrelationInitInternal(l_int32 components,
                        l_int32 maxwidth, l_int32 maxheight, l_float32 thresh,
@@ -259,6 +317,12 @@ static void findSimilarSizedTemplatesDestroy(JBFINDCTX **pcontext);
 static l_int32 finalPositioningForAlignment(PIX *pixs, l_int32 x, l_int32 y,
                              l_int32 idelx, l_int32 idely, PIX *pixt,
                              l_int32 *sumtab, l_int32 *pdx, l_int32 *pdy);
+static l_int32 jbPageJob(void *data, l_int32 index);
+static l_int32 jbCorrelPrepareJob(void *data, l_int32 index);
+static l_int32 jbCorrelMatchJob(void *data, l_int32 index);
+static l_int32 jbCorrelationMatch(JBCORRELDATA *cd, l_int32 i,
+                                  l_int32 iclass);
+static void jbCorrelDataFree(JBCORRELDATA *cd);
 
 #ifndef NO_CONSOLE_IO
 #define  DEBUG_PLOT_CC             0
@@ -431,14 +495,18 @@ JBCLASSER  *classer;
  *  Note:
  *      (1) jbclasser makes a copy of the array of file names.
  *      (2) The caller is still responsible for destroying the input array.
+ *      (3) With more than one thread (see l_setNumThreads()), the pages
+ *          are read and their components are found in parallel, in
+ *          batches of two pages per thread.  The pages are then
+ *          classified in order, so the result does not depend on the
+ *          number of threads.
  */
 l_int32
 jbAddPages(JBCLASSER  *classer,
            SARRAY     *safiles)
 {
-l_int32  i, nfiles;
-char    *fname;
-PIX     *pix;
+l_int32       i, nfiles, nthreads, nbatch;
+JBPAGEBATCH   pb;
 
     PROCNAME("jbAddPages");
 
@@ -449,20 +517,38 @@ PIX     *pix;
 
     classer->safiles = sarrayCopy(safiles);
     nfiles = sarrayGetCount(safiles);
-    for (i = 0; i < nfiles; i++) {
-        fname = sarrayGetString(safiles, i, 0);
-        if ((pix = pixRead(fname)) == NULL) {
-            L_WARNING("image file %d not read\n", procName, i);
-            continue;
-        }
-        if (pixGetDepth(pix) != 1) {
-            L_WARNING("image file %d not 1 bpp\n", procName, i);
-            continue;
+    nthreads = l_getNumThreads();
+    nbatch = (nthreads == 1) ? 1 : 2 * nthreads;
+    pb.classer = classer;
+    pb.safiles = safiles;
+    pb.pix = (PIX **)CALLOC(nbatch, sizeof(PIX *));
+    pb.boxa = (BOXA **)CALLOC(nbatch, sizeof(BOXA *));
+    pb.pixa = (PIXA **)CALLOC(nbatch, sizeof(PIXA *));
+    if (!pb.pix || !pb.boxa || !pb.pixa) {
+        FREE(pb.pix);
+        FREE(pb.boxa);
+        FREE(pb.pixa);
+        return ERROR_INT("batch arrays not made", procName, 1);
+    }
+
+    for (pb.first = 0; pb.first < nfiles; pb.first += nbatch) {
+        pb.npages = L_MIN(nbatch, nfiles - pb.first);
+        l_parallelRun(pb.npages, jbPageJob, &pb, nthreads);
+        for (i = 0; i < pb.npages; i++) {
+            if (!pb.pix[i])
+                continue;
+            classer->w = pixGetWidth(pb.pix[i]);
+            classer->h = pixGetHeight(pb.pix[i]);
+            jbAddPageComponents(classer, pb.pix[i], pb.boxa[i], pb.pixa[i]);
+            pixDestroy(&pb.pix[i]);
+            boxaDestroy(&pb.boxa[i]);
+            pixaDestroy(&pb.pixa[i]);
         }
-        jbAddPage(classer, pix);
-        pixDestroy(&pix);
     }
 
+    FREE(pb.pix);
+    FREE(pb.boxa);
+    FREE(pb.pixa);
     return 0;
 }
 
@@ -1013,32 +1099,34 @@ PIX     *pixt;
  *              boxa (of new components for classification)
  *              pixas (of new components for classification)
  *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      (1) Each component is put in the first class, in the order
+ *          given by findSimilarSizedTemplatesNext(), whose template
+ *          it matches; if none, it starts a new class.
+ *      (2) The components are matched in batches.  The components of
+ *          a batch are first matched in parallel against the templates
+ *          that exist at the start of the batch, which are only read.
+ *          The classes are then assigned in component order.  For this,
+ *          a component is also matched against the templates that
+ *          were made from earlier components of the batch, but only
+ *          those that come before its first match in the walk order.
+ *          The result is the same as when the components are matched
+ *          one at a time, for any number of threads.
  */
 l_int32
 jbClassifyCorrelation(JBCLASSER  *classer,
                       BOXA       *boxa,
                       PIXA       *pixas)
 {
-l_int32     n, nt, i, iclass, wt, ht, found, area, area1, area2, npages,
-            overthreshold;
-l_int32    *sumtab, *centtab;
-l_uint32   *row, word;
-l_float32   x1, y1, x2, y2, xsum, ysum;
-l_float32   thresh, weight, threshold;
-BOX        *box;
-NUMA       *naclass, *napage;
-NUMA       *nafgt;   /* fg area of all templates */
-NUMA       *naarea;   /* w * h area of all templates */
-JBFINDCTX  *findcontext;
-NUMAHASH   *nahash;
-PIX        *pix, *pix1, *pix2;
-PIXA       *pixa, *pixa1, *pixat;
-PIXAA      *pixaa;
-PTA        *pta, *ptac, *ptact;
-l_int32    *pixcts;  /* pixel counts of each pixa */
-l_int32   **pixrowcts;  /* row-by-row pixel counts of each pixa */
-l_int32     x, y, rowcount, downcount, wpl;
-l_uint8     byte;
+l_int32        n, nt, i, iclass, templ, stepmax, wt, ht, area,
+               nthreads, ret;
+BOX           *box;
+JBFINDCTX     *findcontext;
+PIX           *pix;
+PIXA          *pixa;
+PTA           *pta;
+JBCORRELDATA   cd;
 
     PROCNAME("jbClassifyCorrelation");
 
@@ -1049,81 +1137,43 @@ l_uint8     byte;
     if (!pixas)
         return ERROR_INT("pixas not found", procName, 1);
 
-    npages = classer->npages;
-
-        /* Generate the bordered pixa, which contains all the the
-         * input components.  This will not be saved.   */
+        /* Set up the arrays for each component.  The bordered components
+         * will not be saved, except for those that become templates. */
     n = pixaGetCount(pixas);
-    pixa1 = pixaCreate(n);
-    for (i = 0; i < n; i++) {
-        pix = pixaGetPix(pixas, i, L_CLONE);
-        pix1 = pixAddBorderGeneral(pix, JB_ADDED_PIXELS, JB_ADDED_PIXELS,
-                    JB_ADDED_PIXELS, JB_ADDED_PIXELS, 0);
-        pixaAddPix(pixa1, pix1, L_INSERT);
-        pixDestroy(&pix);
+    memset(&cd, 0, sizeof(JBCORRELDATA));
+    cd.classer = classer;
+    cd.pixas = pixas;
+    cd.n = n;
+    cd.pixb = (PIX **)CALLOC(n, sizeof(PIX *));
+    cd.pixcts = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    cd.pixrowcts = (l_int32 **)CALLOC(n, sizeof(l_int32 *));
+    cd.xcen = (l_float32 *)CALLOC(n, sizeof(l_float32));
+    cd.ycen = (l_float32 *)CALLOC(n, sizeof(l_float32));
+    cd.match = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    cd.matchstep = (l_int32 *)CALLOC(n, sizeof(l_int32));
+    cd.sumtab = makePixelSumTab8();
+    cd.centtab = makePixelCentroidTab8();
+    if (!cd.pixb || !cd.pixcts || !cd.pixrowcts || !cd.xcen || !cd.ycen ||
+        !cd.match || !cd.matchstep || !cd.sumtab || !cd.centtab) {
+        jbCorrelDataFree(&cd);
+        return ERROR_INT("calloc fail in component arrays", procName, 1);
     }
 
-        /* Use these to save the class and page of each component. */
-    naclass = classer->naclass;
-    napage = classer->napage;
-
-        /* Get the number of fg pixels in each component.  */
-    nafgt = classer->nafgt;    /* holds fg areas of the templates */
-    sumtab = makePixelSumTab8();
-
-    pixcts = (l_int32 *)CALLOC(n, sizeof(*pixcts));
-    pixrowcts = (l_int32 **)CALLOC(n, sizeof(*pixrowcts));
-    centtab = makePixelCentroidTab8();
-    if (!pixcts || !pixrowcts || !centtab)
-        return ERROR_INT("calloc fail in pix*cts or centtab", procName, 1);
-
-        /* Count the "1" pixels in each row of the pix in pixa1; this
-         * allows pixCorrelationScoreThresholded to abort early if a match
-         * is impossible.  This loop merges three calculations: the total
-         * number of "1" pixels, the number of "1" pixels in each row, and
-         * the centroid.  The centroids are relative to the UL corner of
-         * each (bordered) pix.  The pixrowcts[i][y] are the total number
-         * of fg pixels in pixa[i] below row y. */
-    pta = ptaCreate(n);
-    for (i = 0; i < n; i++) {
-        pix = pixaGetPix(pixa1, i, L_CLONE);
-        pixrowcts[i] = (l_int32 *)CALLOC(pixGetHeight(pix),
-                                         sizeof(**pixrowcts));
-        xsum = 0;
-        ysum = 0;
-        wpl = pixGetWpl(pix);
-        row = pixGetData(pix) + (pixGetHeight(pix) - 1) * wpl;
-        downcount = 0;
-        for (y = pixGetHeight(pix) - 1; y >= 0; y--, row -= wpl) {
-            pixrowcts[i][y] = downcount;
-            rowcount = 0;
-            for (x = 0; x < wpl; x++) {
-                word = row[x];
-                byte = word & 0xff;
-                rowcount += sumtab[byte];
-                xsum += centtab[byte] + (x * 32 + 24) * sumtab[byte];
-                byte = (word >> 8) & 0xff;
-                rowcount += sumtab[byte];
-                xsum += centtab[byte] + (x * 32 + 16) * sumtab[byte];
-                byte = (word >> 16) & 0xff;
-                rowcount += sumtab[byte];
-                xsum += centtab[byte] + (x * 32 + 8) * sumtab[byte];
-                byte = (word >> 24) & 0xff;
-                rowcount += sumtab[byte];
-                xsum += centtab[byte] + x * 32 * sumtab[byte];
-            }
-            downcount += rowcount;
-            ysum += rowcount * y;
-        }
-        pixcts[i] = downcount;
-        ptaAddPt(pta,
-                 xsum / (l_float32)downcount, ysum / (l_float32)downcount);
-        pixDestroy(&pix);
+        /* Generate the bordered components, with their fg pixel counts,
+         * row counts and centroids, in parallel. */
+    nthreads = l_getNumThreads();
+    cd.njobs = (nthreads == 1) ? 1 : L_MIN(n, 4 * nthreads);
+    cd.first = 0;
+    cd.last = n;
+    if (l_parallelRun(cd.njobs, jbCorrelPrepareJob, &cd, nthreads)) {
+        jbCorrelDataFree(&cd);
+        return ERROR_INT("components not prepared", procName, 1);
     }
-
-    ptac = classer->ptac;  /* holds centroids of components up to this page */
-    ptaJoin(ptac, pta, 0, -1);  /* save centroids of all components */
-    ptact = classer->ptact;  /* holds centroids of templates */
+    pta = ptaCreate(n);
+    for (i = 0; i < n; i++)
+        ptaAddPt(pta, cd.xcen[i], cd.ycen[i]);
+    ptaJoin(classer->ptac, pta, 0, -1);  /* save centroids of all comps */
+    ptaDestroy(&pta);
 
     /* Store the unbordered pix in a pixaa, in a hierarchical
      * set of arrays.  There is one pixa for each class,
@@ -1135,139 +1185,90 @@ l_uint8     byte;
      * a grayscale) template, rather than simply using the first
      * one in the set; (2) we can investigate the failures
      * of the classifier.  This pixaa grows as we process
-     * successive pages. */
-    pixaa = classer->pixaa;
-
-        /* Array to store class exemplars */
-    pixat = classer->pixat;
-
-        /* Fill up the pixaa tree with the template exemplars as
-         * the first pix in each pixa.  As we add each pix,
-         * we also add the associated box to the pixa.
-         * We also keep track of the centroid of each pix,
-         * and use the difference between centroids (of the
-         * pix with the exemplar we are checking it with)
-         * to align the two when checking that the correlation
-         * score exceeds a threshold.  The correlation score
-         * is given by the square of the area of the AND
-         * between aligned instance and template, divided by
-         * the product of areas of each image.  For identical
-         * template and instance, the score is 1.0.
-         * If the threshold is too small, non-equivalent instances
-         * will be placed in the same class; if too large, there will
-         * be an unnecessary division of classes representing the
-         * same character.  The weightfactor adds in some of the
-         * difference (1.0 - thresh), depending on the heaviness
-         * of the template (measured as the fraction of fg pixels). */
-    thresh = classer->thresh;
-    weight = classer->weightfactor;
-    naarea = classer->naarea;
-    nahash = classer->nahash;
-    for (i = 0; i < n; i++) {
-        pix1 = pixaGetPix(pixa1, i, L_CLONE);
-        area1 = pixcts[i];
-        ptaGetPt(pta, i, &x1, &y1);  /* centroid for this instance */
-        nt = pixaGetCount(pixat);
-        found = FALSE;
-        findcontext = findSimilarSizedTemplatesInit(classer, pix1);
-        while ( (iclass = findSimilarSizedTemplatesNext(findcontext)) > -1) {
-                /* Get the template */
-            pix2 = pixaGetPix(pixat, iclass, L_CLONE);
-            numaGetIValue(nafgt, iclass, &area2);
-            ptaGetPt(ptact, iclass, &x2, &y2);  /* template centroid */
-
-                /* Find threshold for this template */
-            if (weight > 0.0) {
-                numaGetIValue(naarea, iclass, &area);
-                threshold = thresh + (1. - thresh) * weight * area2 / area;
-            } else {
-                threshold = thresh;
-            }
-
-                /* Find score for this template */
-            overthreshold = pixCorrelationScoreThresholded(pix1, pix2,
-                                         area1, area2, x1 - x2, y1 - y2,
-                                         MAX_DIFF_WIDTH, MAX_DIFF_HEIGHT,
-                                         sumtab, pixrowcts[i], threshold);
-#if DEBUG_CORRELATION_SCORE
-            {
-                l_float32 score, testscore;
-                l_int32 count, testcount;
-                pixCorrelationScore(pix1, pix2, area1, area2, x1 - x2, y1 - y2,
-                                    MAX_DIFF_WIDTH, MAX_DIFF_HEIGHT,
-                                    sumtab, &score);
-
-                pixCorrelationScoreSimple(pix1, pix2, area1, area2,
-                                          x1 - x2, y1 - y2, MAX_DIFF_WIDTH,
-                                          MAX_DIFF_HEIGHT, sumtab, &testscore);
-                count = (l_int32)rint(sqrt(score * area1 * area2));
-                testcount = (l_int32)rint(sqrt(testscore * area1 * area2));
-                if ((score >= threshold) != (testscore >= threshold)) {
-                    fprintf(stderr, "Correlation score mismatch: %d(%g,%d) vs %d(%g,%d) (%g)\n",
-                            count, score, score >= threshold,
-                            testcount, testscore, testscore >= threshold,
-                            score - testscore);
-                }
+     * successive pages.
+     *
+     * Fill up the pixaa tree with the template exemplars as
+     * the first pix in each pixa.  As we add each pix,
+     * we also add the associated box to the pixa.
+     * We also keep track of the centroid of each pix,
+     * and use the difference between centroids (of the
+     * pix with the exemplar we are checking it with)
+     * to align the two when checking that the correlation
+     * score exceeds a threshold.  See jbCorrelationMatch(). */
+    ret = 0;
+    for (cd.first = 0; cd.first < n; cd.first = cd.last) {
+        cd.last = L_MIN(n, cd.first + JB_MATCH_BATCH);
+        cd.nsnap = pixaGetCount(classer->pixat);
+        cd.njobs = (nthreads == 1) ? 1 :
+                   L_MIN(cd.last - cd.first, 4 * nthreads);
+        if (l_parallelRun(cd.njobs, jbCorrelMatchJob, &cd, nthreads)) {
+            ret = 1;
+            break;
+        }
 
-                if ((score >= threshold) != overthreshold) {
-                    fprintf(stderr, "Mismatch between correlation/threshold comparison: %g(%g,%d) >= %g(%g) vs %s\n",
-                            score, score*area1*area2, count, threshold, threshold*area1*area2, (overthreshold ? "true" : "false"));
+        for (i = cd.first; i < cd.last; i++) {
+                /* Check templates made from earlier components of
+                 * this batch, that come before the first match */
+            iclass = -1;
+            nt = pixaGetCount(classer->pixat);
+            if (nt > cd.nsnap) {
+                stepmax = (cd.match[i] >= 0) ? cd.matchstep[i] : 25;
+                findcontext = findSimilarSizedTemplatesInit(classer,
+                                                            cd.pixb[i]);
+                findcontext->mintempl = cd.nsnap;
+                while ((templ = findSimilarSizedTemplatesNext(findcontext))
+                       > -1 && findcontext->i < stepmax) {
+                    if (jbCorrelationMatch(&cd, i, templ)) {
+                        iclass = templ;
+                        break;
+                    }
                 }
+                findSimilarSizedTemplatesDestroy(&findcontext);
             }
-#endif  /* DEBUG_CORRELATION_SCORE */
-            pixDestroy(&pix2);
+            if (iclass < 0)
+                iclass = cd.match[i];
 
-            if (overthreshold) {  /* greedy match */
-                found = TRUE;
-                numaAddNumber(naclass, iclass);
-                numaAddNumber(napage, npages);
+            if (iclass >= 0) {  /* greedy match */
+                numaAddNumber(classer->naclass, iclass);
+                numaAddNumber(classer->napage, classer->npages);
                 if (classer->keep_pixaa) {
                         /* We are keeping a record of all components */
-                    pixa = pixaaGetPixa(pixaa, iclass, L_CLONE);
+                    pixa = pixaaGetPixa(classer->pixaa, iclass, L_CLONE);
                     pix = pixaGetPix(pixas, i, L_CLONE);
                     pixaAddPix(pixa, pix, L_INSERT);
                     box = boxaGetBox(boxa, i, L_CLONE);
                     pixaAddBox(pixa, box, L_INSERT);
                     pixaDestroy(&pixa);
                 }
-                break;
+                pixDestroy(&cd.pixb[i]);
+            } else {  /* new class */
+                numaAddNumber(classer->naclass, nt);
+                numaAddNumber(classer->napage, classer->npages);
+                pixa = pixaCreate(0);
+                pix = pixaGetPix(pixas, i, L_CLONE);  /* unbordered */
+                pixaAddPix(pixa, pix, L_INSERT);
+                wt = pixGetWidth(pix);
+                ht = pixGetHeight(pix);
+                numaHashAdd(classer->nahash, ht * wt, nt);
+                box = boxaGetBox(boxa, i, L_CLONE);
+                pixaAddBox(pixa, box, L_INSERT);
+                pixaaAddPixa(classer->pixaa, pixa, L_INSERT);
+                ptaAddPt(classer->ptact, cd.xcen[i], cd.ycen[i]);
+                numaAddNumber(classer->nafgt, cd.pixcts[i]);
+                area = (pixGetWidth(cd.pixb[i]) - 2 * JB_ADDED_PIXELS) *
+                       (pixGetHeight(cd.pixb[i]) - 2 * JB_ADDED_PIXELS);
+                    /* bordered template */
+                pixaAddPix(classer->pixat, cd.pixb[i], L_INSERT);
+                cd.pixb[i] = NULL;
+                numaAddNumber(classer->naarea, area);
             }
         }
-        findSimilarSizedTemplatesDestroy(&findcontext);
-        if (found == FALSE) {  /* new class */
-            numaAddNumber(naclass, nt);
-            numaAddNumber(napage, npages);
-            pixa = pixaCreate(0);
-            pix = pixaGetPix(pixas, i, L_CLONE);  /* unbordered instance */
-            pixaAddPix(pixa, pix, L_INSERT);
-            wt = pixGetWidth(pix);
-            ht = pixGetHeight(pix);
-            numaHashAdd(nahash, ht * wt, nt);
-            box = boxaGetBox(boxa, i, L_CLONE);
-            pixaAddBox(pixa, box, L_INSERT);
-            pixaaAddPixa(pixaa, pixa, L_INSERT);  /* unbordered instance */
-            ptaAddPt(ptact, x1, y1);
-            numaAddNumber(nafgt, area1);
-            pixaAddPix(pixat, pix1, L_INSERT);   /* bordered template */
-            area = (pixGetWidth(pix1) - 2 * JB_ADDED_PIXELS) *
-                   (pixGetHeight(pix1) - 2 * JB_ADDED_PIXELS);
-            numaAddNumber(naarea, area);
-        } else {  /* don't save it */
-            pixDestroy(&pix1);
-        }
     }
-    classer->nclass = pixaGetCount(pixat);
+    classer->nclass = pixaGetCount(classer->pixat);
 
-    FREE(pixcts);
-    FREE(centtab);
-    for (i = 0; i < n; i++) {
-        FREE(pixrowcts[i]);
-    }
-    FREE(pixrowcts);
-
-    FREE(sumtab);
-    ptaDestroy(&pta);
-    pixaDestroy(&pixa1);
+    jbCorrelDataFree(&cd);
+    if (ret)
+        return ERROR_INT("components not matched", procName, 1);
     return 0;
 }
 
@@ -2341,7 +2342,6 @@ JBFINDCTX  *state;
     if ((state = *pstate) == NULL)
         return;
 
-    numaDestroy(&state->numa);
     FREE(state);
     *pstate = NULL;
     return;
@@ -2363,12 +2363,20 @@ JBFINDCTX  *state;
  *  We don't want to have to collect the whole list of templates first because
  *  (we hope) to find it quickly.  So we keep the context for this walk in an
  *  explictit state structure and this function acts like a generator.
+ *  When a template is returned, state->i is the step at which it was found.
+ *  Templates with index less than state->mintempl are not returned.
+ *
+ *  The templates are visited in order of the step, and for each step in
+ *  order of the template index.  The walk only reads the hash table and
+ *  the templates, without cloning them, so it can be run concurrently
+ *  from several threads as long as no templates are being added.
  */
 static l_int32
 findSimilarSizedTemplatesNext(JBFINDCTX  *state)
 {
-l_int32  desiredh, desiredw, size, templ;
-PIX     *pixt;
+l_int32    desiredh, desiredw, size, templ, lo, hi, mid;
+NUMAHASH  *nahash;
+PIX       *pixt;
 
     while(1) {  /* Continue the walk over step 'i' */
         if (state->i >= 25) {  /* all done */
@@ -2384,32 +2392,46 @@ PIX     *pixt;
 
         if (!state->numa) {
                 /* We have yet to start walking the array for the step 'i' */
-            state->numa = numaHashGetNuma(state->classer->nahash,
-                                          desiredh * desiredw);
+            nahash = state->classer->nahash;
+            state->numa =
+                nahash->numa[(desiredh * desiredw) % nahash->nbuckets];
             if (!state->numa) {  /* nothing there */
                 state->i++;
                 continue;
             }
 
-            state->n = 0;  /* OK, we got a numa. */
+                /* OK, we got a numa.  The template indices are in
+                 * increasing order, so we can skip those that are
+                 * too small. */
+            state->n = 0;
+            if (state->mintempl > 0) {
+                lo = 0;
+                hi = numaGetCount(state->numa);
+                while (lo < hi) {
+                    mid = (lo + hi) / 2;
+                    if ((l_int32)(state->numa->array[mid] + 0.5) <
+                        state->mintempl)
+                        lo = mid + 1;
+                    else
+                        hi = mid;
+                }
+                state->n = lo;
+            }
         }
 
             /* Continue working on this numa */
         size = numaGetCount(state->numa);
         for ( ; state->n < size; ) {
             templ = (l_int32)(state->numa->array[state->n++] + 0.5);
-            pixt = pixaGetPix(state->classer->pixat, templ, L_CLONE);
+            pixt = state->classer->pixat->pix[templ];
             if (pixGetWidth(pixt) - 2 * JB_ADDED_PIXELS == desiredw &&
-                pixGetHeight(pixt) - 2 * JB_ADDED_PIXELS == desiredh) {
-                pixDestroy(&pixt);
+                pixGetHeight(pixt) - 2 * JB_ADDED_PIXELS == desiredh)
                 return templ;
-            }
-            pixDestroy(&pixt);
         }
 
             /* Exhausted the numa; take another step and try again */
         state->i++;
-        numaDestroy(&state->numa);
+        state->numa = NULL;
         continue;
     }
 }
@@ -2488,3 +2510,307 @@ BOX     *box;
     *pdy = miny;
     return 0;
 }
+
+
+/*----------------------------------------------------------------------*
+ *               Static helpers for parallel classification             *
+ *----------------------------------------------------------------------*/
+/*!
+ *  jbPageJob()
+ *
+ *      Input:  data (JBPAGEBATCH)
+ *              index (of the page in the batch)
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      (1) Reads the page image and finds its components.  A page that
+ *          can't be used is skipped.
+ */
+static l_int32
+jbPageJob(void    *data,
+          l_int32  index)
+{
+l_int32       ifile;
+char         *fname;
+JBCLASSER    *classer;
+JBPAGEBATCH  *pb;
+PIX          *pix;
+
+    PROCNAME("jbPageJob");
+
+    pb = (JBPAGEBATCH *)data;
+    classer = pb->classer;
+    ifile = pb->first + index;
+    fname = sarrayGetString(pb->safiles, ifile, 0);
+    if ((pix = pixRead(fname)) == NULL) {
+        L_WARNING("image file %d not read\n", procName, ifile);
+        return 0;
+    }
+    if (pixGetDepth(pix) != 1) {
+        L_WARNING("image file %d not 1 bpp\n", procName, ifile);
+        pixDestroy(&pix);
+        return 0;
+    }
+    if (jbGetComponents(pix, classer->components, classer->maxwidth,
+                        classer->maxheight, &pb->boxa[index],
+                        &pb->pixa[index])) {
+        pixDestroy(&pix);
+        return ERROR_INT("components not made", procName, 1);
+    }
+    pb->pix[index] = pix;
+    return 0;
+}
+
+
+/*!
+ *  jbCorrelPrepareJob()
+ *
+ *      Input:  data (JBCORRELDATA)
+ *              index (of the job)
+ *      Return: 0 if OK; 1 on error
+ *
+ *  Notes:
+ *      (1) For a range of components, make the bordered component and
+ *          count the "1" pixels in each row; this allows
+ *          pixCorrelationScoreThresholded() to abort early if a match
+ *          is impossible.  This loop merges three calculations: the
+ *          total number of "1" pixels, the number of "1" pixels in each
+ *          row, and the centroid.  The centroids are relative to the
+ *          UL corner of each (bordered) pix.  The pixrowcts[i][y] are
+ *          the total number of fg pixels in pixb[i] below row y.
+ */
+static l_int32
+jbCorrelPrepareJob(void    *data,
+                   l_int32  index)
+{
+l_int32        i, i1, i2, x, y, h, wpl, rowcount, downcount;
+l_int32       *sumtab, *centtab;
+l_uint8        byte;
+l_uint32      *row, word;
+l_float32      xsum, ysum;
+JBCORRELDATA  *cd;
+PIX           *pix;
+
+    PROCNAME("jbCorrelPrepareJob");
+
+    cd = (JBCORRELDATA *)data;
+    i1 = (l_int32)(((l_float64)index * cd->n) / cd->njobs);
+    i2 = (l_int32)(((l_float64)(index + 1) * cd->n) / cd->njobs);
+    sumtab = cd->sumtab;
+    centtab = cd->centtab;
+    for (i = i1; i < i2; i++) {
+        pix = pixAddBorderGeneral(cd->pixas->pix[i], JB_ADDED_PIXELS,
+                                  JB_ADDED_PIXELS, JB_ADDED_PIXELS,
+                                  JB_ADDED_PIXELS, 0);
+        if (!pix)
+            return ERROR_INT("bordered pix not made", procName, 1);
+        cd->pixb[i] = pix;
+        h = pixGetHeight(pix);
+        if ((cd->pixrowcts[i] = (l_int32 *)CALLOC(h, sizeof(l_int32)))
+            == NULL)
+            return ERROR_INT("pixrowcts not made", procName, 1);
+        xsum = 0;
+        ysum = 0;
+        wpl = pixGetWpl(pix);
+        row = pixGetData(pix) + (h - 1) * wpl;
+        downcount = 0;
+        for (y = h - 1; y >= 0; y--, row -= wpl) {
+            cd->pixrowcts[i][y] = downcount;
+            rowcount = 0;
+            for (x = 0; x < wpl; x++) {
+                word = row[x];
+                byte = word & 0xff;
+                rowcount += sumtab[byte];
+                xsum += centtab[byte] + (x * 32 + 24) * sumtab[byte];
+                byte = (word >> 8) & 0xff;
+                rowcount += sumtab[byte];
+                xsum += centtab[byte] + (x * 32 + 16) * sumtab[byte];
+                byte = (word >> 16) & 0xff;
+                rowcount += sumtab[byte];
+                xsum += centtab[byte] + (x * 32 + 8) * sumtab[byte];
+                byte = (word >> 24) & 0xff;
+                rowcount += sumtab[byte];
+                xsum += centtab[byte] + x * 32 * sumtab[byte];
+            }
+            downcount += rowcount;
+            ysum += rowcount * y;
+        }
+        cd->pixcts[i] = downcount;
+        cd->xcen[i] = xsum / (l_float32)downcount;
+        cd->ycen[i] = ysum / (l_float32)downcount;
+    }
+    return 0;
+}
+
+
+/*!
+ *  jbCorrelMatchJob()
+ *
+ *      Input:  data (JBCORRELDATA)
+ *              index (of the job)
+ *      Return: 0
+ *
+ *  Notes:
+ *      (1) For a range of components in the current batch, find the
+ *          first template, among the cd->nsnap templates that existed
+ *          at the start of the batch, that the component matches.
+ *          Nothing is written to the classer.
+ */
+static l_int32
+jbCorrelMatchJob(void    *data,
+                 l_int32  index)
+{
+l_int32        i, i1, i2, nb, templ;
+JBCORRELDATA  *cd;
+JBFINDCTX     *findcontext;
+
+    cd = (JBCORRELDATA *)data;
+    nb = cd->last - cd->first;
+    i1 = cd->first + (l_int32)(((l_float64)index * nb) / cd->njobs);
+    i2 = cd->first + (l_int32)(((l_float64)(index + 1) * nb) / cd->njobs);
+    for (i = i1; i < i2; i++) {
+        cd->match[i] = -1;
+        cd->matchstep[i] = 25;
+        if (cd->nsnap == 0)
+            continue;
+        findcontext = findSimilarSizedTemplatesInit(cd->classer, cd->pixb[i]);
+        while ((templ = findSimilarSizedTemplatesNext(findcontext)) > -1) {
+            if (templ >= cd->nsnap)
+                continue;
+            if (jbCorrelationMatch(cd, i, templ)) {
+                cd->match[i] = templ;
+                cd->matchstep[i] = findcontext->i;
+                break;
+            }
+        }
+        findSimilarSizedTemplatesDestroy(&findcontext);
+    }
+    return 0;
+}
+
+
+/*!
+ *  jbCorrelationMatch()
+ *
+ *      Input:  cd (JBCORRELDATA)
+ *              i (index of component)
+ *              iclass (index of template)
+ *      Return: 1 if the component matches the template; 0 otherwise
+ *
+ *  Notes:
+ *      (1) The centroids of component and template are aligned, and the
+ *          correlation score is the square of the area of the AND
+ *          between aligned instance and template, divided by the
+ *          product of areas of each image.  For identical template and
+ *          instance, the score is 1.0.  If the threshold is too small,
+ *          non-equivalent instances will be placed in the same class;
+ *          if too large, there will be an unnecessary division of
+ *          classes representing the same character.  The weightfactor
+ *          adds in some of the difference (1.0 - thresh), depending on
+ *          the heaviness of the template (measured as the fraction of
+ *          fg pixels).
+ *      (2) This only reads the template data, so it can be called
+ *          from several threads.
+ */
+static l_int32
+jbCorrelationMatch(JBCORRELDATA  *cd,
+                   l_int32        i,
+                   l_int32        iclass)
+{
+l_int32     area, area1, area2;
+l_float32   x1, y1, x2, y2, thresh, weight, threshold;
+JBCLASSER  *classer;
+PIX        *pix1, *pix2;
+
+    classer = cd->classer;
+    pix1 = cd->pixb[i];
+    pix2 = classer->pixat->pix[iclass];
+    area1 = cd->pixcts[i];
+    x1 = cd->xcen[i];
+    y1 = cd->ycen[i];
+    numaGetIValue(classer->nafgt, iclass, &area2);
+    ptaGetPt(classer->ptact, iclass, &x2, &y2);  /* template centroid */
+
+        /* Find threshold for this template */
+    thresh = classer->thresh;
+    weight = classer->weightfactor;
+    if (weight > 0.0) {
+        numaGetIValue(classer->naarea, iclass, &area);
+        threshold = thresh + (1. - thresh) * weight * area2 / area;
+    } else {
+        threshold = thresh;
+    }
+
+#if DEBUG_CORRELATION_SCORE
+    {
+        l_float32 score, testscore;
+        l_int32 count, testcount, overthreshold;
+        overthreshold = pixCorrelationScoreThresholded(pix1, pix2,
+                                     area1, area2, x1 - x2, y1 - y2,
+                                     MAX_DIFF_WIDTH, MAX_DIFF_HEIGHT,
+                                     cd->sumtab, cd->pixrowcts[i], threshold);
+        pixCorrelationScore(pix1, pix2, area1, area2, x1 - x2, y1 - y2,
+                            MAX_DIFF_WIDTH, MAX_DIFF_HEIGHT,
+                            cd->sumtab, &score);
+        pixCorrelationScoreSimple(pix1, pix2, area1, area2,
+                                  x1 - x2, y1 - y2, MAX_DIFF_WIDTH,
+                                  MAX_DIFF_HEIGHT, cd->sumtab, &testscore);
+        count = (l_int32)rint(sqrt(score * area1 * area2));
+        testcount = (l_int32)rint(sqrt(testscore * area1 * area2));
+        if ((score >= threshold) != (testscore >= threshold)) {
+            fprintf(stderr, "Correlation score mismatch: %d(%g,%d) vs %d(%g,%d) (%g)\n",
+                    count, score, score >= threshold,
+                    testcount, testscore, testscore >= threshold,
+                    score - testscore);
+        }
+
+        if ((score >= threshold) != overthreshold) {
+            fprintf(stderr, "Mismatch between correlation/threshold comparison: %g(%g,%d) >= %g(%g) vs %s\n",
+                    score, score*area1*area2, count, threshold, threshold*area1*area2, (overthreshold ? "true" : "false"));
+        }
+    }
+#endif  /* DEBUG_CORRELATION_SCORE */
+
+        /* Find score for this template */
+    return pixCorrelationScoreThresholded(pix1, pix2, area1, area2,
+                                          x1 - x2, y1 - y2,
+                                          MAX_DIFF_WIDTH, MAX_DIFF_HEIGHT,
+                                          cd->sumtab, cd->pixrowcts[i],
+                                          threshold);
+}
+
+
+/*!
+ *  jbCorrelDataFree()
+ *
+ *      Input:  cd (JBCORRELDATA)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Frees the arrays in cd, and any bordered components that
+ *          have not been made into templates.
+ */
+static void
+jbCorrelDataFree(JBCORRELDATA  *cd)
+{
+l_int32  i;
+
+    if (cd->pixb) {
+        for (i = 0; i < cd->n; i++)
+            pixDestroy(&cd->pixb[i]);
+    }
+    if (cd->pixrowcts) {
+        for (i = 0; i < cd->n; i++)
+            FREE(cd->pixrowcts[i]);
+    }
+    FREE(cd->pixb);
+    FREE(cd->pixcts);
+    FREE(cd->pixrowcts);
+    FREE(cd->xcen);
+    FREE(cd->ycen);
+    FREE(cd->match);
+    FREE(cd->matchstep);
+    FREE(cd->sumtab);
+    FREE(cd->centtab);
+    return;
+}
@@ -27,7 +27,7 @@
 /*
  *  morph.c
  *
- *     Generic binary morphological ops implemented with rasterop
+ *     Generic binary morphological ops
  *         PIX     *pixDilate()
  *         PIX     *pixErode()
  *         PIX     *pixHMT()
@@ -57,8 +57,7 @@
  *         void     resetMorphBoundaryCondition()
  *         l_int32  getMorphBorderPixelColor()
  *
- *     Static helpers for arg processing
- *         static PIX     *processMorphArgs1()
+ *     Static helper for arg processing
  *         static PIX     *processMorphArgs2()
  *
  *  You are provided with many simple ways to do binary morphology.
@@ -120,9 +119,13 @@
  *      You always get the result as a new Pix.  See morphseq.c for details.
  *
  *  If you are using Sels that are not bricks, you have two choices:
- *      (a) simplest: use the basic rasterop implementations (pixDilate(), ...)
- *      (b) fastest: generate the destination word accumumlation (dwa)
- *          code for your Sels and compile it with the library.
+ *      (a) simplest: use the generic implementations (pixDilate(), ...).
+ *          These compile the Sel at runtime into a list of shifts
+ *          for destination word accumulation (dwa); see seldwa.c.
+ *          To reuse a compiled Sel, use l_dwaselCreate() and
+ *          pixDilateDwasel(), etc.
+ *      (b) fastest: generate the dwa code for your Sels and compile
+ *          it with the library.
  *
  *      For an example, see flipdetect.c, which gives implementations
  *      using hit-miss Sels with both the rasterop and dwa versions.
@@ -172,13 +175,12 @@ LEPT_DLL l_int32  MORPH_BC = ASYMMETRIC_MORPH_BC;
     /* We accept this cost in extra rasterops for decomposing exactly. */
 static const l_int32  ACCEPTABLE_COST = 5;
 
-    /* Static helpers for arg processing */
-static PIX * processMorphArgs1(PIX *pixd, PIX *pixs, SEL *sel, PIX **ppixt);
+    /* Static helper for arg processing */
 static PIX * processMorphArgs2(PIX *pixd, PIX *pixs, SEL *sel);
 
 
 /*-----------------------------------------------------------------*
- *    Generic binary morphological ops implemented with rasterop   *
+ *                Generic binary morphological ops                 *
  *-----------------------------------------------------------------*/
 /*!
  *  pixDilate()
@@ -200,34 +202,26 @@ static PIX * processMorphArgs2(PIX *pixd, PIX *pixs, SEL *sel);
  *          (b) pixDilate(pixs, pixs, ...);
  *          (c) pixDilate(pixd, pixs, ...);
  *      (4) The size of the result is determined by pixs.
+ *      (5) The Sel is compiled for dwa at runtime; see seldwa.c.
  */
 PIX *
 pixDilate(PIX  *pixd,
           PIX  *pixs,
           SEL  *sel)
 {
-l_int32  i, j, w, h, sx, sy, cx, cy, seldata;
-PIX     *pixt;
+L_DWASEL  *dsel;
 
     PROCNAME("pixDilate");
 
-    if ((pixd = processMorphArgs1(pixd, pixs, sel, &pixt)) == NULL)
-        return (PIX *)ERROR_PTR("processMorphArgs1 failed", procName, pixd);
-
-    pixGetDimensions(pixs, &w, &h, NULL);
-    selGetParameters(sel, &sy, &sx, &cy, &cx);
-    pixClearAll(pixd);
-    for (i = 0; i < sy; i++) {
-        for (j = 0; j < sx; j++) {
-            seldata = sel->data[i][j];
-            if (seldata == 1) {   /* src | dst */
-                pixRasterop(pixd, j - cx, i - cy, w, h, PIX_SRC | PIX_DST,
-                            pixt, 0, 0);
-            }
-        }
-    }
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, pixd);
+    if ((dsel = l_dwaselCreate(sel)) == NULL)
+        return (PIX *)ERROR_PTR("dsel not made", procName, pixd);
 
-    pixDestroy(&pixt);
+    pixd = pixDilateDwasel(pixd, pixs, dsel);
+    l_dwaselDestroy(&dsel);
     return pixd;
 }
 
@@ -252,53 +246,26 @@ PIX     *pixt;
  *          (b) pixErode(pixs, pixs, ...);
  *          (c) pixErode(pixd, pixs, ...);
  *      (4) The size of the result is determined by pixs.
+ *      (5) The Sel is compiled for dwa at runtime; see seldwa.c.
  */
 PIX *
 pixErode(PIX  *pixd,
          PIX  *pixs,
          SEL  *sel)
 {
-l_int32  i, j, w, h, sx, sy, cx, cy, seldata;
-l_int32  xp, yp, xn, yn;
-PIX     *pixt;
+L_DWASEL  *dsel;
 
     PROCNAME("pixErode");
 
-    if ((pixd = processMorphArgs1(pixd, pixs, sel, &pixt)) == NULL)
-        return (PIX *)ERROR_PTR("processMorphArgs1 failed", procName, pixd);
-
-    pixGetDimensions(pixs, &w, &h, NULL);
-    selGetParameters(sel, &sy, &sx, &cy, &cx);
-    pixSetAll(pixd);
-    for (i = 0; i < sy; i++) {
-        for (j = 0; j < sx; j++) {
-            seldata = sel->data[i][j];
-            if (seldata == 1) {   /* src & dst */
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
-                                pixt, 0, 0);
-            }
-        }
-    }
-
-        /* Clear near edges.  We do this for the asymmetric boundary
-         * condition convention that implements erosion assuming all
-         * pixels surrounding the image are OFF.  If you use a
-         * use a symmetric b.c. convention, where the erosion is
-         * implemented assuming pixels surrounding the image
-         * are ON, these operations are omitted.  */
-    if (MORPH_BC == ASYMMETRIC_MORPH_BC) {
-        selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
-        if (xp > 0)
-            pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
-        if (xn > 0)
-            pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
-        if (yp > 0)
-            pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
-        if (yn > 0)
-            pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
-    }
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, pixd);
+    if ((dsel = l_dwaselCreate(sel)) == NULL)
+        return (PIX *)ERROR_PTR("dsel not made", procName, pixd);
 
-    pixDestroy(&pixt);
+    pixd = pixErodeDwasel(pixd, pixs, dsel);
+    l_dwaselDestroy(&dsel);
     return pixd;
 }
 
@@ -325,64 +292,26 @@ PIX     *pixt;
  *          (b) pixHMT(pixs, pixs, ...);
  *          (c) pixHMT(pixd, pixs, ...);
  *      (4) The size of the result is determined by pixs.
+ *      (5) The Sel is compiled for dwa at runtime; see seldwa.c.
  */
 PIX *
 pixHMT(PIX  *pixd,
        PIX  *pixs,
        SEL  *sel)
 {
-l_int32  i, j, w, h, sx, sy, cx, cy, firstrasterop, seldata;
-l_int32  xp, yp, xn, yn;
-PIX     *pixt;
+L_DWASEL  *dsel;
 
     PROCNAME("pixHMT");
 
-    if ((pixd = processMorphArgs1(pixd, pixs, sel, &pixt)) == NULL)
-        return (PIX *)ERROR_PTR("processMorphArgs1 failed", procName, pixd);
-
-    pixGetDimensions(pixs, &w, &h, NULL);
-    selGetParameters(sel, &sy, &sx, &cy, &cx);
-    firstrasterop = TRUE;
-    for (i = 0; i < sy; i++) {
-        for (j = 0; j < sx; j++) {
-            seldata = sel->data[i][j];
-            if (seldata == 1) {  /* hit */
-                if (firstrasterop == TRUE) {  /* src only */
-                    pixClearAll(pixd);
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC,
-                                pixt, 0, 0);
-                    firstrasterop = FALSE;
-                } else {   /* src & dst */
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_SRC & PIX_DST,
-                                pixt, 0, 0);
-                }
-            } else if (seldata == 2) {  /* miss */
-                if (firstrasterop == TRUE) {  /* ~src only */
-                    pixSetAll(pixd);
-                    pixRasterop(pixd, cx - j, cy - i, w, h, PIX_NOT(PIX_SRC),
-                             pixt, 0, 0);
-                    firstrasterop = FALSE;
-                } else {  /* ~src & dst */
-                    pixRasterop(pixd, cx - j, cy - i, w, h,
-                                PIX_NOT(PIX_SRC) & PIX_DST,
-                                pixt, 0, 0);
-                }
-            }
-        }
-    }
-
-        /* Clear near edges */
-    selFindMaxTranslations(sel, &xp, &yp, &xn, &yn);
-    if (xp > 0)
-        pixRasterop(pixd, 0, 0, xp, h, PIX_CLR, NULL, 0, 0);
-    if (xn > 0)
-        pixRasterop(pixd, w - xn, 0, xn, h, PIX_CLR, NULL, 0, 0);
-    if (yp > 0)
-        pixRasterop(pixd, 0, 0, w, yp, PIX_CLR, NULL, 0, 0);
-    if (yn > 0)
-        pixRasterop(pixd, 0, h - yn, w, yn, PIX_CLR, NULL, 0, 0);
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (!sel)
+        return (PIX *)ERROR_PTR("sel not defined", procName, pixd);
+    if ((dsel = l_dwaselCreate(sel)) == NULL)
+        return (PIX *)ERROR_PTR("dsel not made", procName, pixd);
 
-    pixDestroy(&pixt);
+    pixd = pixHMTDwasel(pixd, pixs, dsel);
+    l_dwaselDestroy(&dsel);
     return pixd;
 }
 
@@ -1687,64 +1616,8 @@ getMorphBorderPixelColor(l_int32  type,
 
 
 /*-----------------------------------------------------------------*
- *               Static helpers for arg processing                 *
+ *                Static helper for arg processing                 *
  *-----------------------------------------------------------------*/
-/*!
- *  processMorphArgs1()
- *
- *      Input:  pixd (<optional>; this can be null, equal to pixs,
- *                    or different from pixs)
- *              pixs (1 bpp)
- *              sel
- *              &pixt (<returned>)
- *      Return: pixd, or null on error.
- *
- *  Notes:
- *      (1) This is used for generic erosion, dilation and HMT.
- */
-static PIX *
-processMorphArgs1(PIX   *pixd,
-                  PIX   *pixs,
-                  SEL   *sel,
-                  PIX  **ppixt)
-{
-l_int32  sx, sy;
-
-    PROCNAME("processMorphArgs1");
-
-    if (!ppixt)
-        return (PIX *)ERROR_PTR("&pixt not defined", procName, pixd);
-    *ppixt = NULL;
-    if (!pixs)
-        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
-    if (!sel)
-        return (PIX *)ERROR_PTR("sel not defined", procName, pixd);
-    if (pixGetDepth(pixs) != 1)
-        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, pixd);
-
-    selGetParameters(sel, &sx, &sy, NULL, NULL);
-    if (sx == 0 || sy == 0)
-        return (PIX *)ERROR_PTR("sel of size 0", procName, pixd);
-
-        /* We require pixd to exist and to be the same size as pixs.
-         * Further, pixt must be a copy (or clone) of pixs.  */
-    if (!pixd) {
-        if ((pixd = pixCreateTemplate(pixs)) == NULL)
-            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
-        *ppixt = pixClone(pixs);
-    } else {
-        pixResizeImageData(pixd, pixs);
-        if (pixd == pixs) {  /* in-place; must make a copy of pixs */
-            if ((*ppixt = pixCopy(NULL, pixs)) == NULL)
-                return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
-        } else {
-            *ppixt = pixClone(pixs);
-        }
-    }
-    return pixd;
-}
-
-
 /*!
  *  processMorphArgs2()
  *
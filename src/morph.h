@@ -34,6 +34,8 @@
  *      struct Sel
  *      struct Sela
  *      struct Kernel
+ *      struct L_DwaSel
+ *      struct L_MorphPlan
  *
  *  Contains definitions for:
  *      morphological b.c. flags
@@ -92,6 +94,47 @@ struct L_Kernel
 typedef struct L_Kernel  L_KERNEL;
 
 
+/*-------------------------------------------------------------------------*
+ *               Sel compiled for dwa morphology at runtime                *
+ *-------------------------------------------------------------------------*/
+struct L_DwaSel
+{
+    l_int32       nhits;       /* number of hits                           */
+    l_int32       nmisses;     /* number of misses                         */
+    l_int32      *dx;          /* x shift of each hit, then of each miss,  */
+                               /*   from the origin: j - cx                */
+    l_int32      *dy;          /* y shift of each hit and miss: i - cy     */
+    l_int32       xmax;        /* max absolute value of the x shifts       */
+    l_int32       ymax;        /* max absolute value of the y shifts       */
+};
+typedef struct L_DwaSel  L_DWASEL;
+
+
+/*-------------------------------------------------------------------------*
+ *          Binary morphological sequence compiled for execution           *
+ *-------------------------------------------------------------------------*/
+struct L_MorphPlan
+{
+    SARRAY       *sa;          /* operations, without white space          */
+    l_int32       nunits;      /* number of units of operations            */
+    l_int32      *opstart;     /* index of the first op of each unit       */
+    l_int32      *nunitops;    /* number of ops in each unit               */
+    l_int32      *fused;       /* 1 if the ops of the unit are done in a   */
+                               /*   single pass; 0 if done one at a time   */
+    l_int32      *stepstart;   /* index of the first line step of each     */
+                               /*   fused unit                             */
+    l_int32      *nunitsteps;  /* number of line steps of each fused unit  */
+    l_int32       nsteps;      /* number of line steps in all units        */
+    l_int32      *dir;         /* L_HORIZ or L_VERT, for each line step    */
+    l_int32      *type;        /* L_MORPH_DILATE or L_MORPH_ERODE          */
+    l_int32      *lo;          /* first and last offsets from each pixel   */
+    l_int32      *hi;          /*   of the pixels that are combined        */
+    l_int32      *clip;        /* 1 if pixels outside the image are        */
+                               /*   cleared after the step                 */
+};
+typedef struct L_MorphPlan  L_MORPHPLAN;
+
+
 /*-------------------------------------------------------------------------*
  *                 Morphological boundary condition flags                  *
  *
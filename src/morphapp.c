@@ -1009,19 +1009,23 @@ SEL       *sel_2a;
  *  pixTophat()
  *
  *      Input:  pixs
- *              hsize (of Sel; must be odd; origin implicitly in center)
- *              vsize (ditto)
+ *              hsize (of Sel; origin at hsize / 2)
+ *              vsize (of Sel; origin at vsize / 2)
  *              type   (L_TOPHAT_WHITE: image - opening
  *                      L_TOPHAT_BLACK: closing - image)
  *      Return: pixd, or null on error
  *
  *  Notes:
- *      (1) Sel is a brick with all elements being hits
+ *      (1) Sel is a brick with all elements being hits.  The sizes
+ *          can be even; see graymorph.c.
  *      (2) If hsize = vsize = 1, returns an image with all 0 data.
  *      (3) The L_TOPHAT_WHITE flag emphasizes small bright regions,
  *          whereas the L_TOPHAT_BLACK flag emphasizes small dark regions.
  *          The L_TOPHAT_WHITE tophat can be accomplished by doing a
  *          L_TOPHAT_BLACK tophat on the inverse, or v.v.
+ *      (4) When each size is 1 or 3, the opening or closing is done
+ *          with the direct 3x3 functions, which are faster than vHGW
+ *          and give the same result.
  */
 PIX *
 pixTophat(PIX     *pixs,
@@ -1029,7 +1033,8 @@ pixTophat(PIX     *pixs,
           l_int32  vsize,
           l_int32  type)
 {
-PIX  *pixt, *pixd;
+l_int32  small;
+PIX     *pixt, *pixd;
 
     PROCNAME("pixTophat");
 
@@ -1039,14 +1044,6 @@ PIX  *pixt, *pixd;
         return (PIX *)ERROR_PTR("pixs not 8 bpp", procName, NULL);
     if (hsize < 1 || vsize < 1)
         return (PIX *)ERROR_PTR("hsize or vsize < 1", procName, NULL);
-    if ((hsize & 1) == 0 ) {
-        L_WARNING("horiz sel size must be odd; increasing by 1\n", procName);
-        hsize++;
-    }
-    if ((vsize & 1) == 0 ) {
-        L_WARNING("vert sel size must be odd; increasing by 1\n", procName);
-        vsize++;
-    }
     if (type != L_TOPHAT_WHITE && type != L_TOPHAT_BLACK)
         return (PIX *)ERROR_PTR("type must be L_TOPHAT_BLACK or L_TOPHAT_WHITE",
                                 procName, NULL);
@@ -1054,16 +1051,25 @@ PIX  *pixt, *pixd;
     if (hsize == 1 && vsize == 1)
         return pixCreateTemplate(pixs);
 
+    small = (hsize == 1 || hsize == 3) && (vsize == 1 || vsize == 3);
     switch (type)
     {
     case L_TOPHAT_WHITE:
-        if ((pixt = pixOpenGray(pixs, hsize, vsize)) == NULL)
+        if (small)
+            pixt = pixOpenGray3(pixs, hsize, vsize);
+        else
+            pixt = pixOpenGray(pixs, hsize, vsize);
+        if (!pixt)
             return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
         pixd = pixSubtractGray(NULL, pixs, pixt);
         pixDestroy(&pixt);
         break;
     case L_TOPHAT_BLACK:
-        if ((pixd = pixCloseGray(pixs, hsize, vsize)) == NULL)
+        if (small)
+            pixd = pixCloseGray3(pixs, hsize, vsize);
+        else
+            pixd = pixCloseGray(pixs, hsize, vsize);
+        if (!pixd)
             return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
         pixSubtractGray(pixd, pixd, pixs);
         break;
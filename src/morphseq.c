@@ -30,6 +30,20 @@
  *      Run a sequence of binary rasterop morphological operations
  *            PIX     *pixMorphSequence()
  *
+ *      Compiled sequence of binary rasterop morphological operations
+ *            L_MORPHPLAN  *l_morphplanCreate()
+ *            void          l_morphplanDestroy()
+ *            PIX          *pixMorphSequencePlan()
+ *            static l_int32     morphSequenceOp()
+ *            static void        morphplanAddStep()
+ *            static PIX        *pixMorphPlanUnit()
+ *            static l_int32     morphplanBandJob()
+ *            static void        morphplanMakeLines()
+ *            static l_uint32   *morphplanGetLine()
+ *            static void        morphplanShiftLine()
+ *            static void        morphplanShiftLineSSE2()
+ *            static void        morphplanShiftLineAVX2()
+ *
  *      Run a sequence of binary composite rasterop morphological operations
  *            PIX     *pixMorphCompSequence()
  *
@@ -47,10 +61,94 @@
  *
  *      Run a sequence of color morphological operations
  *            PIX     *pixColorMorphSequence()
+ *
+ *  The interpreter makes a new image for each operation of a sequence,
+ *  and the brick operations themselves make an intermediate image
+ *  between the horizontal and vertical Sels.  A sequence can instead
+ *  be compiled with l_morphplanCreate() into a plan, where each run of
+ *  brick operations is a list of horizontal and vertical line steps.
+ *  pixMorphSequencePlan() makes the result of all the steps a line at
+ *  a time, with only the few lines of each intermediate result that
+ *  are still needed kept in ring buffers that stay in the cache.
+ *  pixMorphSequence() uses a plan when there is no debug output.
  */
 
 #include <string.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
+
+    /* Min number of lines in each band done by a compiled sequence */
+static const l_int32  MIN_BAND_LINES = 32;
+
+    /* Ways of combining a shifted line into a line */
+enum {
+    LINE_SET = 1,      /* d = s       */
+    LINE_OR = 2,       /* d = d | s   */
+    LINE_AND = 3       /* d = d & s   */
+};
+
+    /* Bands of lines of the result of a unit of fused brick operations,
+     * each done on a separate thread */
+struct MorphPlanBands
+{
+    l_uint32  *datas;         /* data of the source                       */
+    l_int32    wpls;          /* wpl of the source                        */
+    l_uint32  *datad;         /* data of the result                       */
+    l_int32    wpld;          /* wpl of the result                        */
+    l_int32    w;             /* width of the image                       */
+    l_int32    h;             /* height of the image                      */
+    l_int32    nwords;        /* words in each line of the image          */
+    l_uint32   rmask;         /* mask for the last word of a line         */
+    l_int32    nsteps;        /* number of line steps                     */
+    l_int32   *dir;           /* direction of each line step              */
+    l_int32   *type;          /* L_MORPH_DILATE or L_MORPH_ERODE          */
+    l_int32   *lo;            /* first offset combined by each step       */
+    l_int32   *hi;            /* last offset combined by each step        */
+    l_int32   *clip;          /* 1 to clear pixels outside the image      */
+    l_int32   *nzstart;       /* first line of each stage that can be ON  */
+    l_int32   *nzend;         /* end of the lines that can be ON          */
+    l_int32    padw;          /* pad words on the left and right          */
+    l_int32    wplb;          /* words in a buffered line, with the pad   */
+    l_int32    guard;         /* 0 words on each side of a buffered line  */
+    l_int32    nbands;        /* number of bands of lines                 */
+    l_int32    level;         /* simd level: L_SIMD_NONE, ...             */
+};
+typedef struct MorphPlanBands  MORPHPLAN_BANDS;
+
+    /* Ring buffers for the lines of each stage in a band */
+struct MorphPlanLines
+{
+    l_int32    *start;        /* first line of each stage that is made    */
+    l_int32    *end;          /* end of the lines that are made           */
+    l_int32    *next;         /* next line of each stage to be made       */
+    l_int32    *size;         /* number of lines in each ring buffer      */
+    l_uint32  **buffer;       /* ring buffer for each stage               */
+    l_int32     linesize;     /* words in a buffered line, with guards    */
+    l_uint32   *zero;         /* a line of OFF pixels                     */
+    l_uint32   *scratch;      /* a line for the horizontal steps          */
+};
+typedef struct MorphPlanLines  MORPHPLAN_LINES;
+
+static l_int32 morphSequenceOp(PIX **ppix, const char *op, l_int32 *pborder);
+static void morphplanAddStep(L_MORPHPLAN *plan, l_int32 dir, l_int32 type,
+                             l_int32 size);
+static PIX *pixMorphPlanUnit(PIX *pixs, L_MORPHPLAN *plan, l_int32 unit);
+static l_int32 morphplanBandJob(void *data, l_int32 index);
+static void morphplanMakeLines(MORPHPLAN_BANDS *mb, MORPHPLAN_LINES *ml,
+                               l_int32 k, l_int32 y);
+static l_uint32 *morphplanGetLine(MORPHPLAN_LINES *ml, l_int32 k, l_int32 y);
+static void morphplanShiftLine(l_uint32 *lined, l_uint32 *lines,
+                               l_int32 nwords, l_int32 shift, l_int32 op,
+                               l_int32 level);
+#if USE_SIMD
+static void morphplanShiftLineSSE2(l_uint32 *lined, l_uint32 *lines,
+                                   l_int32 nw, l_int32 shift, l_int32 op);
+static void morphplanShiftLineAVX2(l_uint32 *lined, l_uint32 *lines,
+                                   l_int32 nw, l_int32 shift, l_int32 op);
+#endif  /* USE_SIMD */
+
 
 /*-------------------------------------------------------------------------*
  *         Run a sequence of binary rasterop morphological operations      *
@@ -124,19 +222,24 @@
  *              - The border is removed at the end, so if a border is
  *                added at the beginning, the result must be at the
  *                same resolution as the input!
+ *      (13) Without debug output, the sequence is compiled and run with
+ *           pixMorphSequencePlan(), which does each run of brick
+ *           operations in a single pass over the image.  The result
+ *           is the same.  To run a sequence on many images, compile
+ *           it once with l_morphplanCreate().
  */
 PIX *
 pixMorphSequence(PIX         *pixs,
                  const char  *sequence,
                  l_int32      dispsep)
 {
-char    *rawop, *op, *fname;
-char     buf[256];
-l_int32  nops, i, j, nred, fact, w, h, x, y, border, pdfout;
-l_int32  level[4];
-PIX     *pixt1, *pixt2;
-PIXA    *pixa;
-SARRAY  *sa;
+char         *rawop, *op, *fname;
+char          buf[256];
+l_int32       nops, i, x, y, border, pdfout;
+L_MORPHPLAN  *plan;
+PIX          *pixt1, *pixt2;
+PIXA         *pixa;
+SARRAY       *sa;
 
     PROCNAME("pixMorphSequence");
 
@@ -145,6 +248,15 @@ SARRAY  *sa;
     if (!sequence)
         return (PIX *)ERROR_PTR("sequence not defined", procName, NULL);
 
+        /* Without debug output, compile and run the sequence */
+    if (dispsep == 0) {
+        if ((plan = l_morphplanCreate(sequence)) == NULL)
+            return NULL;  /* error was reported by l_morphplanCreate() */
+        pixt1 = pixMorphSequencePlan(pixs, plan);
+        l_morphplanDestroy(&plan);
+        return pixt1;
+    }
+
         /* Split sequence into individual operations */
     sa = sarrayCreate(0);
     sarraySplitString(sa, sequence, "+");
@@ -166,62 +278,11 @@ SARRAY  *sa;
     }
     border = 0;
     pixt1 = pixCopy(NULL, pixs);
-    pixt2 = NULL;
     x = y = 0;
     for (i = 0; i < nops; i++) {
         rawop = sarrayGetString(sa, i, 0);
         op = stringRemoveChars(rawop, " \n\t");
-        switch (op[0])
-        {
-        case 'd':
-        case 'D':
-            sscanf(&op[1], "%d.%d", &w, &h);
-            pixt2 = pixDilateBrick(NULL, pixt1, w, h);
-            pixSwapAndDestroy(&pixt1, &pixt2);
-            break;
-        case 'e':
-        case 'E':
-            sscanf(&op[1], "%d.%d", &w, &h);
-            pixt2 = pixErodeBrick(NULL, pixt1, w, h);
-            pixSwapAndDestroy(&pixt1, &pixt2);
-            break;
-        case 'o':
-        case 'O':
-            sscanf(&op[1], "%d.%d", &w, &h);
-            pixOpenBrick(pixt1, pixt1, w, h);
-            break;
-        case 'c':
-        case 'C':
-            sscanf(&op[1], "%d.%d", &w, &h);
-            pixCloseSafeBrick(pixt1, pixt1, w, h);
-            break;
-        case 'r':
-        case 'R':
-            nred = strlen(op) - 1;
-            for (j = 0; j < nred; j++)
-                level[j] = op[j + 1] - '0';
-            for (j = nred; j < 4; j++)
-                level[j] = 0;
-            pixt2 = pixReduceRankBinaryCascade(pixt1, level[0], level[1],
-                                               level[2], level[3]);
-            pixSwapAndDestroy(&pixt1, &pixt2);
-            break;
-        case 'x':
-        case 'X':
-            sscanf(&op[1], "%d", &fact);
-            pixt2 = pixExpandReplicate(pixt1, fact);
-            pixSwapAndDestroy(&pixt1, &pixt2);
-            break;
-        case 'b':
-        case 'B':
-            sscanf(&op[1], "%d", &border);
-            pixt2 = pixAddBorder(pixt1, border, 0);
-            pixSwapAndDestroy(&pixt1, &pixt2);
-            break;
-        default:
-            /* All invalid ops are caught in the first pass */
-            break;
-        }
+        morphSequenceOp(&pixt1, op, &border);
         FREE(op);
 
             /* Debug output */
@@ -248,6 +309,832 @@ SARRAY  *sa;
 }
 
 
+/*-------------------------------------------------------------------------*
+ *      Compiled sequence of binary rasterop morphological operations      *
+ *-------------------------------------------------------------------------*/
+/*!
+ *  l_morphplanCreate()
+ *
+ *      Input:  sequence (string specifying sequence; see pixMorphSequence())
+ *      Return: plan, or null on error
+ *
+ *  Notes:
+ *      (1) The sequence is parsed and verified once, and divided into
+ *          units.  Each run of consecutive brick operations (d, e, o, c)
+ *          is a unit that is done in a single pass over the image;
+ *          each other operation (r, x, b) is a unit by itself.
+ *      (2) Each brick operation is decomposed into horizontal and
+ *          vertical line steps, in the same order as the separable
+ *          operations in pixDilateBrick(), pixErodeBrick(),
+ *          pixOpenBrick() and pixCloseSafeBrick().  A step for a
+ *          Sel of size 1 is omitted.
+ *      (3) Pixels outside the image are cleared after the last step
+ *          of each operation.  Within a closing they are kept, which
+ *          gives the same result as the safe closing.
+ *      (4) The plan can be used with pixMorphSequencePlan() on any
+ *          number of images.
+ */
+L_MORPHPLAN *
+l_morphplanCreate(const char  *sequence)
+{
+char         *rawop, *op;
+l_int32       nops, i, u, w, h, nsteps;
+L_MORPHPLAN  *plan;
+SARRAY       *sa;
+
+    PROCNAME("l_morphplanCreate");
+
+    if (!sequence)
+        return (L_MORPHPLAN *)ERROR_PTR("sequence not defined", procName, NULL);
+
+    sa = sarrayCreate(0);
+    sarraySplitString(sa, sequence, "+");
+    if (!morphSequenceVerify(sa)) {
+        sarrayDestroy(&sa);
+        return (L_MORPHPLAN *)ERROR_PTR("sequence not valid", procName, NULL);
+    }
+    nops = sarrayGetCount(sa);
+
+    if ((plan = (L_MORPHPLAN *)CALLOC(1, sizeof(L_MORPHPLAN))) == NULL) {
+        sarrayDestroy(&sa);
+        return (L_MORPHPLAN *)ERROR_PTR("plan not made", procName, NULL);
+    }
+    plan->sa = sarrayCreate(nops);
+    for (i = 0; i < nops; i++) {
+        rawop = sarrayGetString(sa, i, L_NOCOPY);
+        op = stringRemoveChars(rawop, " \n\t");
+        sarrayAddString(plan->sa, op, L_INSERT);
+    }
+    sarrayDestroy(&sa);
+
+        /* There are at most 4 line steps for each op */
+    plan->opstart = (l_int32 *)CALLOC(nops + 1, sizeof(l_int32));
+    plan->nunitops = (l_int32 *)CALLOC(nops + 1, sizeof(l_int32));
+    plan->fused = (l_int32 *)CALLOC(nops + 1, sizeof(l_int32));
+    plan->stepstart = (l_int32 *)CALLOC(nops + 1, sizeof(l_int32));
+    plan->nunitsteps = (l_int32 *)CALLOC(nops + 1, sizeof(l_int32));
+    plan->dir = (l_int32 *)CALLOC(4 * nops + 1, sizeof(l_int32));
+    plan->type = (l_int32 *)CALLOC(4 * nops + 1, sizeof(l_int32));
+    plan->lo = (l_int32 *)CALLOC(4 * nops + 1, sizeof(l_int32));
+    plan->hi = (l_int32 *)CALLOC(4 * nops + 1, sizeof(l_int32));
+    plan->clip = (l_int32 *)CALLOC(4 * nops + 1, sizeof(l_int32));
+    if (!plan->opstart || !plan->nunitops || !plan->fused ||
+        !plan->stepstart || !plan->nunitsteps || !plan->dir ||
+        !plan->type || !plan->lo || !plan->hi || !plan->clip) {
+        l_morphplanDestroy(&plan);
+        return (L_MORPHPLAN *)ERROR_PTR("plan arrays not made",
+                                        procName, NULL);
+    }
+
+    for (i = 0; i < nops; i++) {
+        op = sarrayGetString(plan->sa, i, L_NOCOPY);
+        if (!strchr("dDeEoOcC", op[0])) {  /* unit by itself */
+            u = plan->nunits++;
+            plan->opstart[u] = i;
+            plan->nunitops[u] = 1;
+            continue;
+        }
+
+        if (plan->nunits == 0 || !plan->fused[plan->nunits - 1]) {
+            u = plan->nunits++;
+            plan->opstart[u] = i;
+            plan->fused[u] = 1;
+            plan->stepstart[u] = plan->nsteps;
+        }
+        u = plan->nunits - 1;
+        plan->nunitops[u]++;
+        nsteps = plan->nsteps;
+        sscanf(&op[1], "%d.%d", &w, &h);
+        switch (op[0])
+        {
+        case 'd':
+        case 'D':
+            morphplanAddStep(plan, L_HORIZ, L_MORPH_DILATE, w);
+            morphplanAddStep(plan, L_VERT, L_MORPH_DILATE, h);
+            break;
+        case 'e':
+        case 'E':
+            morphplanAddStep(plan, L_HORIZ, L_MORPH_ERODE, w);
+            morphplanAddStep(plan, L_VERT, L_MORPH_ERODE, h);
+            break;
+        case 'o':
+        case 'O':
+            morphplanAddStep(plan, L_HORIZ, L_MORPH_ERODE, w);
+            morphplanAddStep(plan, L_VERT, L_MORPH_ERODE, h);
+            morphplanAddStep(plan, L_HORIZ, L_MORPH_DILATE, w);
+            morphplanAddStep(plan, L_VERT, L_MORPH_DILATE, h);
+            break;
+        default:  /* 'c' or 'C' */
+            morphplanAddStep(plan, L_HORIZ, L_MORPH_DILATE, w);
+            morphplanAddStep(plan, L_VERT, L_MORPH_DILATE, h);
+            morphplanAddStep(plan, L_HORIZ, L_MORPH_ERODE, w);
+            morphplanAddStep(plan, L_VERT, L_MORPH_ERODE, h);
+            break;
+        }
+        if (plan->nsteps > nsteps)
+            plan->clip[plan->nsteps - 1] = 1;
+        plan->nunitsteps[u] = plan->nsteps - plan->stepstart[u];
+    }
+
+    return plan;
+}
+
+
+/*!
+ *  l_morphplanDestroy()
+ *
+ *      Input:  &plan (<to be nulled>)
+ *      Return: void
+ */
+void
+l_morphplanDestroy(L_MORPHPLAN  **pplan)
+{
+L_MORPHPLAN  *plan;
+
+    PROCNAME("l_morphplanDestroy");
+
+    if (pplan == NULL) {
+        L_WARNING("ptr address is null!\n", procName);
+        return;
+    }
+    if ((plan = *pplan) == NULL)
+        return;
+
+    sarrayDestroy(&plan->sa);
+    FREE(plan->opstart);
+    FREE(plan->nunitops);
+    FREE(plan->fused);
+    FREE(plan->stepstart);
+    FREE(plan->nunitsteps);
+    FREE(plan->dir);
+    FREE(plan->type);
+    FREE(plan->lo);
+    FREE(plan->hi);
+    FREE(plan->clip);
+    FREE(plan);
+    *pplan = NULL;
+    return;
+}
+
+
+/*!
+ *  pixMorphSequencePlan()
+ *
+ *      Input:  pixs (1 bpp)
+ *              plan (compiled sequence)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This gives the same result as pixMorphSequence() with the
+ *          sequence that the plan was made from.
+ *      (2) Each unit of brick operations is done in a single pass
+ *          over the image, without intermediate images; see
+ *          pixMorphPlanUnit().  Bands of lines are done on parallel
+ *          threads (see l_setNumThreads()).
+ *      (3) With symmetric b.c. (see resetMorphBoundaryCondition()),
+ *          the operations are done one at a time.
+ */
+PIX *
+pixMorphSequencePlan(PIX          *pixs,
+                     L_MORPHPLAN  *plan)
+{
+char    *op;
+l_int32  i, u, border, fuse;
+PIX     *pixt1, *pixt2;
+
+    PROCNAME("pixMorphSequencePlan");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, NULL);
+    if (!plan)
+        return (PIX *)ERROR_PTR("plan not defined", procName, NULL);
+    if (pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, NULL);
+
+    fuse = (getMorphBorderPixelColor(L_MORPH_ERODE, 1) == 0);
+    border = 0;
+    pixt1 = pixClone(pixs);
+    for (u = 0; u < plan->nunits; u++) {
+        if (plan->fused[u] && fuse) {
+            if ((pixt2 = pixMorphPlanUnit(pixt1, plan, u)) == NULL) {
+                pixDestroy(&pixt1);
+                return (PIX *)ERROR_PTR("pixt2 not made", procName, NULL);
+            }
+            pixSwapAndDestroy(&pixt1, &pixt2);
+            continue;
+        }
+        for (i = 0; i < plan->nunitops[u]; i++) {
+            op = sarrayGetString(plan->sa, plan->opstart[u] + i, L_NOCOPY);
+            if (morphSequenceOp(&pixt1, op, &border)) {
+                pixDestroy(&pixt1);
+                return (PIX *)ERROR_PTR("op failed", procName, NULL);
+            }
+        }
+    }
+    if (border > 0) {
+        pixt2 = pixRemoveBorder(pixt1, border);
+        pixSwapAndDestroy(&pixt1, &pixt2);
+    }
+
+    if (pixt1 == pixs) {  /* no ops; a new image is always produced */
+        pixDestroy(&pixt1);
+        pixt1 = pixCopy(NULL, pixs);
+    }
+    return pixt1;
+}
+
+
+/*!
+ *  morphSequenceOp()
+ *
+ *      Input:  &pix (image to be operated on; replaced by the result)
+ *              op (a single operation of a sequence, without white space)
+ *              &border (<return> size of border added by a 'b' op)
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+morphSequenceOp(PIX        **ppix,
+                const char  *op,
+                l_int32     *pborder)
+{
+l_int32  j, nred, fact, w, h;
+l_int32  level[4];
+PIX     *pixt;
+
+    PROCNAME("morphSequenceOp");
+
+    pixt = NULL;
+    switch (op[0])
+    {
+    case 'd':
+    case 'D':
+        sscanf(&op[1], "%d.%d", &w, &h);
+        pixt = pixDilateBrick(NULL, *ppix, w, h);
+        break;
+    case 'e':
+    case 'E':
+        sscanf(&op[1], "%d.%d", &w, &h);
+        pixt = pixErodeBrick(NULL, *ppix, w, h);
+        break;
+    case 'o':
+    case 'O':
+        sscanf(&op[1], "%d.%d", &w, &h);
+        pixt = pixOpenBrick(NULL, *ppix, w, h);
+        break;
+    case 'c':
+    case 'C':
+        sscanf(&op[1], "%d.%d", &w, &h);
+        pixt = pixCloseSafeBrick(NULL, *ppix, w, h);
+        break;
+    case 'r':
+    case 'R':
+        nred = strlen(op) - 1;
+        for (j = 0; j < nred; j++)
+            level[j] = op[j + 1] - '0';
+        for (j = nred; j < 4; j++)
+            level[j] = 0;
+        pixt = pixReduceRankBinaryCascade(*ppix, level[0], level[1],
+                                          level[2], level[3]);
+        break;
+    case 'x':
+    case 'X':
+        sscanf(&op[1], "%d", &fact);
+        pixt = pixExpandReplicate(*ppix, fact);
+        break;
+    case 'b':
+    case 'B':
+        sscanf(&op[1], "%d", pborder);
+        pixt = pixAddBorder(*ppix, *pborder, 0);
+        break;
+    default:
+        /* All invalid ops are caught in the first pass */
+        break;
+    }
+
+    if (!pixt)
+        return ERROR_INT("pixt not made", procName, 1);
+    pixSwapAndDestroy(ppix, &pixt);
+    return 0;
+}
+
+
+/*!
+ *  morphplanAddStep()
+ *
+ *      Input:  plan
+ *              dir (L_HORIZ, L_VERT)
+ *              type (L_MORPH_DILATE, L_MORPH_ERODE)
+ *              size (of the brick Sel in the direction)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The origin of the Sel is at size / 2, as for the brick
+ *          operations.  The result at a pixel is the OR (dilation)
+ *          or AND (erosion) of the pixels at offsets [lo ... hi] from it.
+ */
+static void
+morphplanAddStep(L_MORPHPLAN  *plan,
+                 l_int32       dir,
+                 l_int32       type,
+                 l_int32       size)
+{
+l_int32  n;
+
+    if (size <= 1)
+        return;
+    n = plan->nsteps++;
+    plan->dir[n] = dir;
+    plan->type[n] = type;
+    if (type == L_MORPH_DILATE) {
+        plan->lo[n] = size / 2 - (size - 1);
+        plan->hi[n] = size / 2;
+    } else {
+        plan->lo[n] = -(size / 2);
+        plan->hi[n] = size - 1 - size / 2;
+    }
+    plan->clip[n] = 0;
+    return;
+}
+
+
+/*!
+ *  pixMorphPlanUnit()
+ *
+ *      Input:  pixs (1 bpp)
+ *              plan
+ *              unit (index of a unit of fused brick operations)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) The result of the first k line steps is called stage k;
+ *          stage 0 is the source.  The lines of each stage are made
+ *          in order, each from the few lines of the previous stage
+ *          that it depends on, which are kept in a small ring buffer.
+ *          Only the lines of the last stage are written to the result.
+ *      (2) Each buffered line has a whole number of pad words on the
+ *          left and right of the image, which hold the pixels of a
+ *          closing that are outside the image, and the pixels beyond
+ *          that are OFF.  The pad is as wide as the largest extent
+ *          of the horizontal dilations since the last clipping, and
+ *          on the left, of the runs that are combined for them; see
+ *          morphplanMakeLines().
+ *          Likewise, the lines of each stage that can have ON pixels
+ *          are found here, and other lines are never made.
+ *      (3) Horizontal steps take a number of passes over the line
+ *          that is logarithmic in the size of the Sel, by combining
+ *          runs of pixels of doubling length.  Vertical steps combine
+ *          the lines at each offset.
+ */
+static PIX *
+pixMorphPlanUnit(PIX          *pixs,
+                 L_MORPHPLAN  *plan,
+                 l_int32       unit)
+{
+l_int32           j, w, h, s, e, exl, exr, padx, maxsize, nthreads, ret;
+MORPHPLAN_BANDS   mb;
+PIX              *pixd;
+
+    PROCNAME("pixMorphPlanUnit");
+
+    if (plan->nunitsteps[unit] == 0)
+        return pixCopy(NULL, pixs);
+    if ((pixd = pixCreateTemplate(pixs)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    mb.datas = pixGetData(pixs);
+    mb.wpls = pixGetWpl(pixs);
+    mb.datad = pixGetData(pixd);
+    mb.wpld = pixGetWpl(pixd);
+    mb.w = w;
+    mb.h = h;
+    mb.nwords = (w + 31) / 32;
+    mb.rmask = (w & 31) ? 0xffffffff << (32 - (w & 31)) : 0xffffffff;
+    mb.nsteps = plan->nunitsteps[unit];
+    mb.dir = plan->dir + plan->stepstart[unit];
+    mb.type = plan->type + plan->stepstart[unit];
+    mb.lo = plan->lo + plan->stepstart[unit];
+    mb.hi = plan->hi + plan->stepstart[unit];
+    mb.clip = plan->clip + plan->stepstart[unit];
+    mb.nzstart = (l_int32 *)CALLOC(mb.nsteps + 1, sizeof(l_int32));
+    mb.nzend = (l_int32 *)CALLOC(mb.nsteps + 1, sizeof(l_int32));
+    if (!mb.nzstart || !mb.nzend) {
+        FREE(mb.nzstart);
+        FREE(mb.nzend);
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("line ranges not made", procName, NULL);
+    }
+
+        /* Lines of each stage that can have ON pixels, and the pad
+         * for the ON pixels outside the image */
+    mb.nzstart[0] = 0;
+    mb.nzend[0] = h;
+    exl = exr = padx = 0;
+    maxsize = 1;
+    for (j = 0; j < mb.nsteps; j++) {
+        s = mb.nzstart[j];
+        e = mb.nzend[j];
+        if (mb.dir[j] == L_HORIZ) {
+            maxsize = L_MAX(maxsize, mb.hi[j] - mb.lo[j] + 1);
+            if (mb.type[j] == L_MORPH_DILATE) {
+                    /* The runs that are combined start to the left */
+                padx = L_MAX(padx, exl + mb.hi[j] - mb.lo[j]);
+                exl += mb.hi[j];
+                exr -= mb.lo[j];
+                padx = L_MAX(padx, exr);
+            }
+        } else if (mb.type[j] == L_MORPH_DILATE) {
+            s -= mb.hi[j];
+            e -= mb.lo[j];
+        }
+        if (mb.clip[j]) {
+            s = L_MAX(s, 0);
+            e = L_MIN(e, h);
+            exl = exr = 0;
+        }
+        mb.nzstart[j + 1] = s;
+        mb.nzend[j + 1] = e;
+    }
+    mb.padw = (padx + 31) / 32;
+    mb.wplb = mb.nwords + 2 * mb.padw;
+    mb.guard = 2 + maxsize / 32;
+    mb.level = l_getSimdLevel();
+
+    nthreads = l_getNumThreads();
+    mb.nbands = (nthreads == 1) ? 1 :
+                L_MAX(1, L_MIN(nthreads, h / MIN_BAND_LINES));
+    ret = l_parallelRun(mb.nbands, morphplanBandJob, &mb, nthreads);
+
+    FREE(mb.nzstart);
+    FREE(mb.nzend);
+    if (ret) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("fused ops failed", procName, NULL);
+    }
+    return pixd;
+}
+
+
+/*!
+ *  morphplanBandJob()
+ *
+ *      Input:  data (MORPHPLAN_BANDS)
+ *              index (of the band of lines)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Going back from the last stage, this finds the lines of
+ *          each stage that are needed for the band.  Bands on either
+ *          side of this one make some of the same lines, in the
+ *          overlap of the Sels.
+ */
+static l_int32
+morphplanBandJob(void    *data,
+                 l_int32  index)
+{
+l_int32           k, n, y, y1, y2, s, e, nlines;
+l_uint32         *buf, *lines;
+MORPHPLAN_BANDS  *mb;
+MORPHPLAN_LINES   ml;
+
+    PROCNAME("morphplanBandJob");
+
+    mb = (MORPHPLAN_BANDS *)data;
+    y1 = (l_int32)(((l_float64)index * mb->h) / mb->nbands);
+    y2 = (l_int32)(((l_float64)(index + 1) * mb->h) / mb->nbands);
+    if (y1 >= y2)
+        return 0;
+
+    n = mb->nsteps;
+    ml.start = (l_int32 *)CALLOC(n + 1, sizeof(l_int32));
+    ml.end = (l_int32 *)CALLOC(n + 1, sizeof(l_int32));
+    ml.next = (l_int32 *)CALLOC(n + 1, sizeof(l_int32));
+    ml.size = (l_int32 *)CALLOC(n + 1, sizeof(l_int32));
+    ml.buffer = (l_uint32 **)CALLOC(n + 1, sizeof(l_uint32 *));
+    buf = NULL;
+    if (!ml.start || !ml.end || !ml.next || !ml.size || !ml.buffer)
+        goto cleanup;
+
+    s = y1;
+    e = y2;
+    nlines = 2;  /* for the line of OFF pixels and the scratch line */
+    for (k = n; k >= 0; k--) {
+        ml.start[k] = L_MAX(s, mb->nzstart[k]);
+        ml.end[k] = L_MAX(ml.start[k], L_MIN(e, mb->nzend[k]));
+        ml.next[k] = ml.start[k];
+        if (k == n || mb->dir[k] == L_HORIZ)
+            ml.size[k] = 1;
+        else
+            ml.size[k] = mb->hi[k] - mb->lo[k] + 1;
+        nlines += ml.size[k];
+        s = ml.start[k];
+        e = ml.end[k];
+        if (k > 0 && mb->dir[k - 1] == L_VERT && s < e) {
+            s += mb->lo[k - 1];
+            e += mb->hi[k - 1];
+        }
+    }
+
+        /* The guard words on each side of the lines stay 0 */
+    ml.linesize = mb->wplb + 2 * mb->guard;
+    if ((buf = (l_uint32 *)CALLOC(nlines * ml.linesize, 4)) == NULL)
+        goto cleanup;
+    lines = buf + mb->guard;
+    for (k = 0; k <= n; k++) {
+        ml.buffer[k] = lines;
+        lines += ml.size[k] * ml.linesize;
+    }
+    ml.zero = lines;
+    ml.scratch = lines + ml.linesize;
+
+    for (y = y1; y < y2; y++) {
+        morphplanMakeLines(mb, &ml, n, y);
+        lines = morphplanGetLine(&ml, n, y);
+        memcpy(mb->datad + y * mb->wpld, lines + mb->padw, 4 * mb->nwords);
+    }
+
+cleanup:
+    FREE(ml.start);
+    FREE(ml.end);
+    FREE(ml.next);
+    FREE(ml.size);
+    FREE(ml.buffer);
+    if (!buf)
+        return ERROR_INT("line buffers not made", procName, 1);
+    FREE(buf);
+    return 0;
+}
+
+
+/*!
+ *  morphplanMakeLines()
+ *
+ *      Input:  mb (MORPHPLAN_BANDS)
+ *              ml (line buffers of the band)
+ *              k (stage)
+ *              y (make the lines of the stage up to this one)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This first makes the lines of the previous stage that
+ *          are needed, so it recurses once for each line step.
+ *      (2) A horizontal step combines the runs of n pixels that start
+ *          at each pixel, and then shifts the result by lo.  For
+ *          dilation, the runs that reach the ON pixels can start up
+ *          to n - 1 pixels to the left of them, so these must be
+ *          within the pad.
+ */
+static void
+morphplanMakeLines(MORPHPLAN_BANDS  *mb,
+                   MORPHPLAN_LINES  *ml,
+                   l_int32           k,
+                   l_int32           y)
+{
+l_int32    i, j, t, n, span, op, wplb;
+l_uint32  *lined, *lines;
+
+    wplb = mb->wplb;
+    while (ml->next[k] <= y && ml->next[k] < ml->end[k]) {
+        i = ml->next[k]++;
+        lined = morphplanGetLine(ml, k, i);
+        if (k == 0) {  /* source line */
+            memset(lined, 0, 4 * wplb);
+            memcpy(lined + mb->padw, mb->datas + i * mb->wpls,
+                   4 * mb->nwords);
+            lined[mb->padw + mb->nwords - 1] &= mb->rmask;
+            continue;
+        }
+
+        j = k - 1;  /* the line step that makes this stage */
+        op = (mb->type[j] == L_MORPH_DILATE) ? LINE_OR : LINE_AND;
+        if (mb->dir[j] == L_HORIZ) {
+            morphplanMakeLines(mb, ml, j, i);
+            lines = morphplanGetLine(ml, j, i);
+            n = mb->hi[j] - mb->lo[j] + 1;
+            memcpy(ml->scratch, lines, 4 * wplb);
+            for (span = 1; 2 * span <= n; span *= 2)
+                morphplanShiftLine(ml->scratch, ml->scratch, wplb, span, op,
+                                   mb->level);
+            if (span < n)
+                morphplanShiftLine(ml->scratch, ml->scratch, wplb,
+                                   n - span, op, mb->level);
+            morphplanShiftLine(lined, ml->scratch, wplb, mb->lo[j], LINE_SET,
+                               mb->level);
+        } else {
+            morphplanMakeLines(mb, ml, j, i + mb->hi[j]);
+            if (op == LINE_AND && (i + mb->lo[j] < ml->start[j] ||
+                                   i + mb->hi[j] >= ml->end[j])) {
+                memset(lined, 0, 4 * wplb);
+            } else {
+                n = 0;
+                for (t = mb->lo[j]; t <= mb->hi[j]; t++) {
+                    lines = morphplanGetLine(ml, j, i + t);
+                    if (lines == ml->zero)  /* only for dilation */
+                        continue;
+                    morphplanShiftLine(lined, lines, wplb, 0,
+                                       (n++ == 0) ? LINE_SET : op, mb->level);
+                }
+                if (n == 0)
+                    memset(lined, 0, 4 * wplb);
+            }
+        }
+
+        if (mb->clip[j]) {  /* clear the pixels outside the image */
+            memset(lined, 0, 4 * mb->padw);
+            memset(lined + mb->padw + mb->nwords, 0, 4 * mb->padw);
+            lined[mb->padw + mb->nwords - 1] &= mb->rmask;
+        }
+    }
+    return;
+}
+
+
+/*!
+ *  morphplanGetLine()
+ *
+ *      Input:  ml (line buffers of the band)
+ *              k (stage)
+ *              y (line)
+ *      Return: the line, or the line of OFF pixels if it is not made
+ */
+static l_uint32 *
+morphplanGetLine(MORPHPLAN_LINES  *ml,
+                 l_int32           k,
+                 l_int32           y)
+{
+    if (y < ml->start[k] || y >= ml->end[k])
+        return ml->zero;
+    return ml->buffer[k] + ((y - ml->start[k]) % ml->size[k]) * ml->linesize;
+}
+
+
+/*!
+ *  morphplanShiftLine()
+ *
+ *      Input:  lined (dest line)
+ *              lines (src line; can be the same as lined if shift > 0)
+ *              nwords (in each line)
+ *              shift (pixels; the src pixel at x + shift is combined
+ *                     into the dest pixel at x)
+ *              op (LINE_SET, LINE_OR, LINE_AND)
+ *              level (simd level: L_SIMD_NONE, ...)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The words read outside the src line are guard words,
+ *          which are 0.
+ *      (2) With the same line for src and dest and a positive
+ *          shift, each word is read before it is written, also by
+ *          the simd versions.
+ */
+static void
+morphplanShiftLine(l_uint32  *lined,
+                   l_uint32  *lines,
+                   l_int32    nwords,
+                   l_int32    shift,
+                   l_int32    op,
+                   l_int32    level)
+{
+l_int32    i, ws, bs, istart;
+l_uint32  *ls;
+
+    ws = (shift >= 0) ? shift / 32 : -((31 - shift) / 32);
+    bs = shift - 32 * ws;  /* in [0 ... 31] */
+    ls = lines + ws;
+
+    istart = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2 && nwords >= 8) {
+        istart = nwords & ~7;
+        morphplanShiftLineAVX2(lined, ls, istart, bs, op);
+    } else if (level >= L_SIMD_SSE2 && nwords >= 4) {
+        istart = nwords & ~3;
+        morphplanShiftLineSSE2(lined, ls, istart, bs, op);
+    }
+#endif  /* USE_SIMD */
+
+    if (bs == 0) {
+        if (op == LINE_SET) {
+            for (i = istart; i < nwords; i++)
+                lined[i] = ls[i];
+        } else if (op == LINE_OR) {
+            for (i = istart; i < nwords; i++)
+                lined[i] |= ls[i];
+        } else {
+            for (i = istart; i < nwords; i++)
+                lined[i] &= ls[i];
+        }
+    } else {
+        if (op == LINE_SET) {
+            for (i = istart; i < nwords; i++)
+                lined[i] = (ls[i] << bs) | (ls[i + 1] >> (32 - bs));
+        } else if (op == LINE_OR) {
+            for (i = istart; i < nwords; i++)
+                lined[i] |= (ls[i] << bs) | (ls[i + 1] >> (32 - bs));
+        } else {
+            for (i = istart; i < nwords; i++)
+                lined[i] &= (ls[i] << bs) | (ls[i + 1] >> (32 - bs));
+        }
+    }
+    return;
+}
+
+
+#if USE_SIMD
+    /* As in seldwa.c, each dest word i is made from the src bits
+     * starting @shift bits into src word i.  The loop macros apply
+     * EXPR, a function of the src vector s and dest vector d. */
+#define  SSE2_LOAD(p)    _mm_loadu_si128((const __m128i *)(p))
+#define  SSE2_SRC(p) \
+    ((shift == 0) ? SSE2_LOAD(p) : \
+     _mm_or_si128(_mm_sll_epi32(SSE2_LOAD(p), lsh), \
+                  _mm_srl_epi32(SSE2_LOAD((p) + 1), rsh)))
+#define  SSE2_LINE(EXPR) \
+    for (i = 0; i < nw; i += 4) { \
+        s = SSE2_SRC(lines + i); \
+        d = SSE2_LOAD(lined + i); \
+        _mm_storeu_si128((__m128i *)(lined + i), (EXPR)); \
+    }
+
+#define  AVX2_LOAD(p)    _mm256_loadu_si256((const __m256i *)(p))
+#define  AVX2_SRC(p) \
+    ((shift == 0) ? AVX2_LOAD(p) : \
+     _mm256_or_si256(_mm256_sll_epi32(AVX2_LOAD(p), lsh), \
+                     _mm256_srl_epi32(AVX2_LOAD((p) + 1), rsh)))
+#define  AVX2_LINE(EXPR) \
+    for (i = 0; i < nw; i += 8) { \
+        s = AVX2_SRC(lines + i); \
+        d = AVX2_LOAD(lined + i); \
+        _mm256_storeu_si256((__m256i *)(lined + i), (EXPR)); \
+    }
+
+
+/*!
+ *  morphplanShiftLineSSE2()
+ *
+ *      Input:  lined (dest line)
+ *              lines (src line, at the word offset of the shift)
+ *              nw (number of words to do; multiple of 4)
+ *              shift (further left shift of the src, in bits)
+ *              op (LINE_SET, LINE_OR, LINE_AND)
+ *      Return: void
+ */
+static void  L_TARGET_SSE2
+morphplanShiftLineSSE2(l_uint32  *lined,
+                       l_uint32  *lines,
+                       l_int32    nw,
+                       l_int32    shift,
+                       l_int32    op)
+{
+l_int32  i;
+__m128i  lsh, rsh, s, d;
+
+    lsh = _mm_cvtsi32_si128(shift);
+    rsh = _mm_cvtsi32_si128(32 - shift);
+    if (op == LINE_SET)
+        SSE2_LINE(s)
+    else if (op == LINE_OR)
+        SSE2_LINE(_mm_or_si128(s, d))
+    else
+        SSE2_LINE(_mm_and_si128(s, d))
+    return;
+}
+
+
+/*!
+ *  morphplanShiftLineAVX2()
+ *
+ *      Input:  lined (dest line)
+ *              lines (src line, at the word offset of the shift)
+ *              nw (number of words to do; multiple of 8)
+ *              shift (further left shift of the src, in bits)
+ *              op (LINE_SET, LINE_OR, LINE_AND)
+ *      Return: void
+ */
+static void  L_TARGET_AVX2
+morphplanShiftLineAVX2(l_uint32  *lined,
+                       l_uint32  *lines,
+                       l_int32    nw,
+                       l_int32    shift,
+                       l_int32    op)
+{
+l_int32  i;
+__m128i  lsh, rsh;
+__m256i  s, d;
+
+    lsh = _mm_cvtsi32_si128(shift);
+    rsh = _mm_cvtsi32_si128(32 - shift);
+    if (op == LINE_SET)
+        AVX2_LINE(s)
+    else if (op == LINE_OR)
+        AVX2_LINE(_mm256_or_si256(s, d))
+    else
+        AVX2_LINE(_mm256_and_si256(s, d))
+    return;
+}
+#endif  /* USE_SIMD */
+
+
 /*-------------------------------------------------------------------------*
  *   Run a sequence of binary composite rasterop morphological operations  *
  *-------------------------------------------------------------------------*/
@@ -203,9 +203,9 @@ NUMA  *na;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((na = (NUMA *)CALLOC(1, sizeof(NUMA))) == NULL)
+    if ((na = (NUMA *)l_poolCalloc(1, sizeof(NUMA))) == NULL)
         return (NUMA *)ERROR_PTR("na not made", procName, NULL);
-    if ((na->array = (l_float32 *)CALLOC(n, sizeof(l_float32))) == NULL)
+    if ((na->array = (l_float32 *)l_poolCalloc(n, sizeof(l_float32))) == NULL)
         return (NUMA *)ERROR_PTR("number array not made", procName, NULL);
 
     na->nalloc = n;
@@ -285,7 +285,7 @@ NUMA    *na;
 
     na = numaCreate(size);
     if (copyflag == L_INSERT) {
-        if (na->array) FREE(na->array);
+        if (na->array) l_poolFree(na->array);
         na->array = farray;
         na->n = size;
     } else {  /* just copy the contents */
@@ -323,11 +323,10 @@ NUMA  *na;
         return;
 
         /* Decrement the ref count.  If it is 0, destroy the numa. */
-    numaChangeRefcount(na, -1);
-    if (numaGetRefcount(na) <= 0) {
+    if (L_REFCOUNT_ADD(&na->refcount, -1) <= 0) {
         if (na->array)
-            FREE(na->array);
-        FREE(na);
+            l_poolFree(na->array);
+        l_poolFree(na);
     }
 
     *pna = NULL;
@@ -452,7 +451,7 @@ numaExtendArray(NUMA  *na)
     if (!na)
         return ERROR_INT("na not defined", procName, 1);
 
-    if ((na->array = (l_float32 *)reallocNew((void **)&na->array,
+    if ((na->array = (l_float32 *)l_poolReallocNew((void **)&na->array,
                                 sizeof(l_float32) * na->nalloc,
                                 2 * sizeof(l_float32) * na->nalloc)) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -606,7 +605,7 @@ numaSetCount(NUMA    *na,
     if (!na)
         return ERROR_INT("na not defined", procName, 1);
     if (newcount > na->nalloc) {
-        if ((na->array = (l_float32 *)reallocNew((void **)&na->array,
+        if ((na->array = (l_float32 *)l_poolReallocNew((void **)&na->array,
                          sizeof(l_float32) * na->nalloc,
                          sizeof(l_float32) * newcount)) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -854,7 +853,7 @@ numaChangeRefcount(NUMA    *na,
 
     if (!na)
         return ERROR_INT("na not defined", procName, 1);
-    na->refcount += delta;
+    L_REFCOUNT_ADD(&na->refcount, delta);
     return 0;
 }
 
@@ -1165,9 +1164,9 @@ NUMAA  *naa;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((naa = (NUMAA *)CALLOC(1, sizeof(NUMAA))) == NULL)
+    if ((naa = (NUMAA *)l_poolCalloc(1, sizeof(NUMAA))) == NULL)
         return (NUMAA *)ERROR_PTR("naa not made", procName, NULL);
-    if ((naa->numa = (NUMA **)CALLOC(n, sizeof(NUMA *))) == NULL)
+    if ((naa->numa = (NUMA **)l_poolCalloc(n, sizeof(NUMA *))) == NULL)
         return (NUMAA *)ERROR_PTR("numa ptr array not made", procName, NULL);
 
     naa->nalloc = n;
@@ -1271,8 +1270,8 @@ NUMAA   *naa;
 
     for (i = 0; i < naa->n; i++)
         numaDestroy(&naa->numa[i]);
-    FREE(naa->numa);
-    FREE(naa);
+    l_poolFree(naa->numa);
+    l_poolFree(naa);
     *pnaa = NULL;
 
     return;
@@ -1340,7 +1339,7 @@ numaaExtendArray(NUMAA  *naa)
     if (!naa)
         return ERROR_INT("naa not defined", procName, 1);
 
-    if ((naa->numa = (NUMA **)reallocNew((void **)&naa->numa,
+    if ((naa->numa = (NUMA **)l_poolReallocNew((void **)&naa->numa,
                               sizeof(NUMA *) * naa->nalloc,
                               2 * sizeof(NUMA *) * naa->nalloc)) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -0,0 +1,750 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ - 
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+/*
+ *  parallel.c
+ *
+ *      Number of worker threads
+ *          l_int32         l_setNumThreads()
+ *          l_int32         l_getNumThreads()
+ *          l_int32         l_getNumProcessors()
+ *
+ *      Running independent jobs on worker threads
+ *          l_int32         l_parallelRun()
+ *          static l_int32  parallelInJob()
+ *          static void     parallelKeyCreate()
+ *          static void    *parallelWorker()
+ *
+ *      Helper thread statistics
+ *          l_int32         l_parallelGetStats()
+ *          void            l_parallelResetStats()
+ *
+ *      Running a job in the background
+ *          L_THREAD       *l_threadCreate()
+ *          l_int32         l_threadJoin()
+ *          static void    *threadWorker()
+ *
+ *      Locking
+ *          L_MUTEX        *l_mutexCreate()
+ *          void            l_mutexDestroy()
+ *          void            l_mutexLock()
+ *          void            l_mutexUnlock()
+ *
+ *      Processor SIMD support
+ *          l_int32         l_setSimdLevel()
+ *          l_int32         l_getSimdLevel()
+ *
+ *    The work model is fork/join.  l_parallelRun() starts (nthreads - 1)
+ *    helper threads; together with the calling thread they pull job
+ *    indices from a shared counter until all jobs have been taken, and
+ *    the function returns after every job has completed.  No threads
+ *    persist between calls, so there is nothing to initialize or
+ *    clean up, and there is no shared state between concurrent calls
+ *    from different application threads.
+ *
+ *    Jobs often call library functions that themselves use
+ *    l_parallelRun().  Such a nested call runs all its jobs in the
+ *    thread of the job that made it, so only the outermost call
+ *    starts helper threads, and the number of threads never exceeds
+ *    the @nthreads of that call.  l_parallelGetStats() tells how many
+ *    helper threads have been started and how many ran at once.
+ *
+ *    The default number of threads is 1, so nothing is done in
+ *    parallel unless the application asks for it.  Use
+ *    l_setNumThreads() to change the default that is used by all
+ *    functions that take an @nthreads argument of 0.
+ *
+ *    Job granularity is left to the caller.  Jobs should be large
+ *    (a tile or a band of raster lines), because the counter is
+ *    protected by a lock and each thread start costs some tens of
+ *    microseconds.
+ *
+ *    Thread support requires posix threads, and is enabled with
+ *    USE_PTHREADS in environ.h.  Without it, all of these functions
+ *    still work, but every job is run sequentially in the calling thread.
+ *
+ *    l_threadCreate() is for the one case that does not fit fork/join:
+ *    a single job, such as reading ahead, that runs while the caller
+ *    goes on with other work and is collected later with l_threadJoin().
+ *    Without thread support it returns null, and the caller is expected
+ *    to do without the background work.
+ *
+ *    The simd level tells inner loops that have SSE2 or AVX2 versions
+ *    which one to use.  These are compiled with USE_SIMD in environ.h.
+ */
+
+#include "allheaders.h"
+
+#if USE_PTHREADS
+#include <pthread.h>
+#include <unistd.h>
+#endif  /* USE_PTHREADS */
+
+static const l_int32  MAX_THREADS = 256;
+
+    /* Default number of threads, used when nthreads == 0 is requested */
+static l_int32  var_NUM_THREADS = 1;
+
+    /* Limit on the simd level, and the level supported by the processor
+     * (-1 until it has been queried) */
+static l_int32  var_SIMD_LEVEL = L_SIMD_AVX2;
+#if USE_SIMD
+static l_int32  var_SIMD_CPU = -1;
+#endif  /* USE_SIMD */
+
+struct L_Mutex
+{
+#if USE_PTHREADS
+    pthread_mutex_t   mutex;
+#else
+    l_int32           unused;
+#endif  /* USE_PTHREADS */
+};
+
+    /* Shared state for one call to l_parallelRun() */
+struct ParallelJobs
+{
+    L_JOB_FUNC        func;      /* job function                          */
+    void             *data;      /* data handed to each job               */
+    l_int32           njobs;     /* total number of jobs                  */
+    l_int32           next;      /* index of next job to be handed out    */
+    l_int32           nerrors;   /* number of jobs that returned an error */
+    L_MUTEX          *lock;      /* protects next and nerrors             */
+};
+typedef struct ParallelJobs  PARALLEL_JOBS;
+
+    /* A single job running in the background */
+struct L_Thread
+{
+    L_JOB_FUNC        func;      /* job function                          */
+    void             *data;      /* data handed to the job                */
+    l_int32           index;     /* index handed to the job               */
+    l_int32           ret;       /* value returned by the job             */
+#if USE_PTHREADS
+    pthread_t         thread;
+#endif  /* USE_PTHREADS */
+};
+
+#if USE_PTHREADS
+    /* Set in each thread while it is running jobs of l_parallelRun() */
+static pthread_key_t    ParallelKey;
+static pthread_once_t   ParallelKeyOnce = PTHREAD_ONCE_INIT;
+static l_int32          ParallelKeyMade = 0;
+
+    /* Helper thread statistics, protected by StatsLock */
+static pthread_mutex_t  StatsLock = PTHREAD_MUTEX_INITIALIZER;
+static l_int32          var_NSTARTED = 0;
+static l_int32          var_NRUNNING = 0;
+static l_int32          var_MAXRUNNING = 0;
+#endif  /* USE_PTHREADS */
+
+static l_int32 parallelInJob(void);
+#if USE_PTHREADS
+static void parallelKeyCreate(void);
+static void *parallelWorker(void *arg);
+static void *threadWorker(void *arg);
+#endif  /* USE_PTHREADS */
+
+
+/*------------------------------------------------------------------*
+ *                    Number of worker threads                      *
+ *------------------------------------------------------------------*/
+/*!
+ *  l_setNumThreads()
+ *
+ *      Input:  nthreads (default number of threads to use; 0 for the
+ *                        number of online processors)
+ *      Return: previous default number of threads
+ *
+ *  Notes:
+ *      (1) This sets the number of threads that are used by functions
+ *          that are called with @nthreads == 0.  The initial default
+ *          is 1: all work is done in the calling thread.
+ *      (2) The value is clipped to [1 ... 256].  It is silently
+ *          set to 1 when leptonica is built without thread support.
+ */
+l_int32
+l_setNumThreads(l_int32  nthreads)
+{
+l_int32  oldval;
+
+    oldval = var_NUM_THREADS;
+    if (nthreads <= 0)
+        nthreads = l_getNumProcessors();
+    nthreads = L_MIN(nthreads, MAX_THREADS);
+#if !USE_PTHREADS
+    nthreads = 1;
+#endif  /* !USE_PTHREADS */
+    var_NUM_THREADS = nthreads;
+    return oldval;
+}
+
+
+/*!
+ *  l_getNumThreads()
+ *
+ *      Input:  (none)
+ *      Return: default number of threads
+ */
+l_int32
+l_getNumThreads(void)
+{
+    return var_NUM_THREADS;
+}
+
+
+/*!
+ *  l_getNumProcessors()
+ *
+ *      Input:  (none)
+ *      Return: number of online processors; 1 if not known
+ */
+l_int32
+l_getNumProcessors(void)
+{
+l_int32  n;
+
+    n = 1;
+#if USE_PTHREADS && defined(_SC_NPROCESSORS_ONLN)
+    n = (l_int32)sysconf(_SC_NPROCESSORS_ONLN);
+#endif  /* USE_PTHREADS */
+    return L_MAX(1, n);
+}
+
+
+/*------------------------------------------------------------------*
+ *             Running independent jobs on worker threads           *
+ *------------------------------------------------------------------*/
+/*!
+ *  l_parallelRun()
+ *
+ *      Input:  njobs (number of jobs)
+ *              func (job function, called once for each job index)
+ *              data (<optional> passed to each call of func)
+ *              nthreads (max number of threads to use, including the
+ *                        calling thread; 0 for the default)
+ *      Return: 0 if OK, 1 on error or if any job returned an error
+ *
+ *  Notes:
+ *      (1) Calls func(data, index) for each index in [0 ... njobs - 1],
+ *          and returns when all the jobs are done.
+ *      (2) Jobs may run concurrently and in any order.  Each job must
+ *          only write to memory that no other job reads or writes,
+ *          or else protect the access with an L_MUTEX.
+ *      (3) The number of threads actually used is at most @njobs.
+ *          If a helper thread cannot be started, its share of the jobs
+ *          is taken by the threads that are running.
+ *      (4) A failing job does not stop the others from running.
+ *      (5) When called from within a job of another l_parallelRun(),
+ *          all the jobs are run sequentially in the calling thread.
+ *          Library functions that run in parallel can therefore be
+ *          used freely inside jobs, without multiplying the number
+ *          of threads.
+ */
+l_int32
+l_parallelRun(l_int32     njobs,
+              L_JOB_FUNC  func,
+              void       *data,
+              l_int32     nthreads)
+{
+l_int32         i;
+PARALLEL_JOBS   jobs;
+#if USE_PTHREADS
+l_int32         nstarted;
+pthread_t      *threads;
+#endif  /* USE_PTHREADS */
+
+    PROCNAME("l_parallelRun");
+
+    if (!func)
+        return ERROR_INT("func not defined", procName, 1);
+    if (njobs <= 0)
+        return 0;
+    if (nthreads <= 0)
+        nthreads = var_NUM_THREADS;
+    nthreads = L_MIN(nthreads, njobs);
+    nthreads = L_MIN(nthreads, MAX_THREADS);
+
+        /* Sequential case, also used for calls from within a job */
+    if (nthreads <= 1 || !USE_PTHREADS || parallelInJob()) {
+        jobs.nerrors = 0;
+        for (i = 0; i < njobs; i++) {
+            if (func(data, i))
+                jobs.nerrors++;
+        }
+        return (jobs.nerrors > 0) ? 1 : 0;
+    }
+
+#if USE_PTHREADS
+    jobs.func = func;
+    jobs.data = data;
+    jobs.njobs = njobs;
+    jobs.next = 0;
+    jobs.nerrors = 0;
+    if ((jobs.lock = l_mutexCreate()) == NULL)
+        return ERROR_INT("lock not made", procName, 1);
+    if ((threads = (pthread_t *)CALLOC(nthreads, sizeof(pthread_t)))
+        == NULL) {
+        l_mutexDestroy(&jobs.lock);
+        return ERROR_INT("threads not made", procName, 1);
+    }
+
+        /* Start the helpers, and then do our share in this thread */
+    nstarted = 0;
+    for (i = 0; i < nthreads - 1; i++) {
+        if (pthread_create(&threads[nstarted], NULL, parallelWorker,
+                           &jobs) != 0) {
+            L_WARNING("only %d helper threads started\n", procName,
+                      nstarted);
+            break;
+        }
+        nstarted++;
+    }
+    pthread_mutex_lock(&StatsLock);
+    var_NSTARTED += nstarted;
+    var_NRUNNING += nstarted;
+    var_MAXRUNNING = L_MAX(var_MAXRUNNING, var_NRUNNING);
+    pthread_mutex_unlock(&StatsLock);
+    parallelWorker(&jobs);
+    for (i = 0; i < nstarted; i++)
+        pthread_join(threads[i], NULL);
+    pthread_mutex_lock(&StatsLock);
+    var_NRUNNING -= nstarted;
+    pthread_mutex_unlock(&StatsLock);
+
+    FREE(threads);
+    l_mutexDestroy(&jobs.lock);
+#endif  /* USE_PTHREADS */
+    return (jobs.nerrors > 0) ? 1 : 0;
+}
+
+
+/*!
+ *  parallelInJob()
+ *
+ *      Input:  (none)
+ *      Return: 1 if the calling thread is running a job of
+ *              l_parallelRun(); 0 otherwise
+ *
+ *  Notes:
+ *      (1) The flag is a posix thread-specific value rather than
+ *          an L_THREAD_LOCAL variable, because L_THREAD_LOCAL is only
+ *          per-thread when leptonica is built with LEPT_THREAD_SAFE.
+ */
+static l_int32
+parallelInJob(void)
+{
+#if USE_PTHREADS
+    pthread_once(&ParallelKeyOnce, parallelKeyCreate);
+    if (ParallelKeyMade && pthread_getspecific(ParallelKey) != NULL)
+        return 1;
+#endif  /* USE_PTHREADS */
+    return 0;
+}
+
+
+#if USE_PTHREADS
+/*!
+ *  parallelKeyCreate()
+ *
+ *      Input:  (none)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Called once, through pthread_once().  If the key cannot be
+ *          made, nested calls of l_parallelRun() start helper threads.
+ */
+static void
+parallelKeyCreate(void)
+{
+    if (pthread_key_create(&ParallelKey, NULL) == 0)
+        ParallelKeyMade = 1;
+    return;
+}
+
+
+/*!
+ *  parallelWorker()
+ *
+ *      Input:  arg (the shared PARALLEL_JOBS)
+ *      Return: null
+ *
+ *  Notes:
+ *      (1) Takes the next job index until they are all gone.
+ *      (2) The thread is marked as running jobs while it does so.
+ *          The previous mark is restored at the end, because the
+ *          calling thread of l_parallelRun() runs this as well.
+ */
+static void *
+parallelWorker(void  *arg)
+{
+l_int32         index, ret;
+void           *oldval;
+PARALLEL_JOBS  *jobs;
+
+    jobs = (PARALLEL_JOBS *)arg;
+    oldval = NULL;
+    if (ParallelKeyMade) {
+        oldval = pthread_getspecific(ParallelKey);
+        pthread_setspecific(ParallelKey, jobs);
+    }
+    while (1) {
+        l_mutexLock(jobs->lock);
+        index = jobs->next++;
+        l_mutexUnlock(jobs->lock);
+        if (index >= jobs->njobs)
+            break;
+        ret = jobs->func(jobs->data, index);
+        if (ret) {
+            l_mutexLock(jobs->lock);
+            jobs->nerrors++;
+            l_mutexUnlock(jobs->lock);
+        }
+    }
+    if (ParallelKeyMade)
+        pthread_setspecific(ParallelKey, oldval);
+    return NULL;
+}
+#endif  /* USE_PTHREADS */
+
+
+/*------------------------------------------------------------------*
+ *                    Helper thread statistics                      *
+ *------------------------------------------------------------------*/
+/*!
+ *  l_parallelGetStats()
+ *
+ *      Input:  &nstarted (<optional return> number of helper threads
+ *                         started by l_parallelRun())
+ *              &maxrunning (<optional return> largest number of helper
+ *                           threads that were running at one time)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The counts are for all calls since the program started, or
+ *          since the last call to l_parallelResetStats().  They are
+ *          0 when leptonica is built without thread support.
+ */
+l_int32
+l_parallelGetStats(l_int32  *pnstarted,
+                   l_int32  *pmaxrunning)
+{
+    PROCNAME("l_parallelGetStats");
+
+    if (!pnstarted && !pmaxrunning)
+        return ERROR_INT("no output requested", procName, 1);
+    if (pnstarted) *pnstarted = 0;
+    if (pmaxrunning) *pmaxrunning = 0;
+
+#if USE_PTHREADS
+    pthread_mutex_lock(&StatsLock);
+    if (pnstarted) *pnstarted = var_NSTARTED;
+    if (pmaxrunning) *pmaxrunning = var_MAXRUNNING;
+    pthread_mutex_unlock(&StatsLock);
+#endif  /* USE_PTHREADS */
+    return 0;
+}
+
+
+/*!
+ *  l_parallelResetStats()
+ *
+ *      Input:  (none)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Sets the number of helper threads started to 0, and the
+ *          largest number running to the number that are running now.
+ */
+void
+l_parallelResetStats(void)
+{
+#if USE_PTHREADS
+    pthread_mutex_lock(&StatsLock);
+    var_NSTARTED = 0;
+    var_MAXRUNNING = var_NRUNNING;
+    pthread_mutex_unlock(&StatsLock);
+#endif  /* USE_PTHREADS */
+    return;
+}
+
+
+/*------------------------------------------------------------------*
+ *                  Running a job in the background                 *
+ *------------------------------------------------------------------*/
+/*!
+ *  l_threadCreate()
+ *
+ *      Input:  func (job function)
+ *              data (handed to the job)
+ *              index (handed to the job)
+ *      Return: thread, or null if it cannot be started
+ *
+ *  Notes:
+ *      (1) Starts a thread that calls func(data, index), and returns
+ *          immediately.  The caller must collect the thread with
+ *          l_threadJoin(), and must not touch anything the job
+ *          writes until then, except under an L_MUTEX.
+ *      (2) This is independent of the default number of threads.
+ *          It returns null without an error message when leptonica is
+ *          built without thread support, so that background work
+ *          can simply be skipped.
+ */
+L_THREAD *
+l_threadCreate(L_JOB_FUNC  func,
+               void       *data,
+               l_int32     index)
+{
+#if USE_PTHREADS
+L_THREAD  *thread;
+#endif  /* USE_PTHREADS */
+
+    PROCNAME("l_threadCreate");
+
+    if (!func)
+        return (L_THREAD *)ERROR_PTR("func not defined", procName, NULL);
+
+#if USE_PTHREADS
+    if ((thread = (L_THREAD *)CALLOC(1, sizeof(L_THREAD))) == NULL)
+        return (L_THREAD *)ERROR_PTR("thread not made", procName, NULL);
+    thread->func = func;
+    thread->data = data;
+    thread->index = index;
+    if (pthread_create(&thread->thread, NULL, threadWorker, thread) != 0) {
+        FREE(thread);
+        return (L_THREAD *)ERROR_PTR("thread not started", procName, NULL);
+    }
+    return thread;
+#else
+    return NULL;
+#endif  /* USE_PTHREADS */
+}
+
+
+/*!
+ *  l_threadJoin()
+ *
+ *      Input:  &thread (<will be set to null before returning>)
+ *      Return: value returned by the job; 0 if there is no thread
+ *
+ *  Notes:
+ *      (1) Waits for the job to finish, and frees the thread.
+ */
+l_int32
+l_threadJoin(L_THREAD  **pthread)
+{
+l_int32    ret;
+L_THREAD  *thread;
+
+    PROCNAME("l_threadJoin");
+
+    if (pthread == NULL)
+        return ERROR_INT("ptr address is null", procName, 1);
+    if ((thread = *pthread) == NULL)
+        return 0;
+
+#if USE_PTHREADS
+    pthread_join(thread->thread, NULL);
+#endif  /* USE_PTHREADS */
+    ret = thread->ret;
+    FREE(thread);
+    *pthread = NULL;
+    return ret;
+}
+
+
+#if USE_PTHREADS
+/*!
+ *  threadWorker()
+ *
+ *      Input:  arg (the L_THREAD)
+ *      Return: null
+ */
+static void *
+threadWorker(void  *arg)
+{
+L_THREAD  *thread;
+
+    thread = (L_THREAD *)arg;
+    thread->ret = thread->func(thread->data, thread->index);
+    return NULL;
+}
+#endif  /* USE_PTHREADS */
+
+
+/*------------------------------------------------------------------*
+ *                              Locking                             *
+ *------------------------------------------------------------------*/
+/*!
+ *  l_mutexCreate()
+ *
+ *      Input:  (none)
+ *      Return: mutex, or null on error
+ */
+L_MUTEX *
+l_mutexCreate(void)
+{
+L_MUTEX  *mutex;
+
+    PROCNAME("l_mutexCreate");
+
+    if ((mutex = (L_MUTEX *)CALLOC(1, sizeof(L_MUTEX))) == NULL)
+        return (L_MUTEX *)ERROR_PTR("mutex not made", procName, NULL);
+#if USE_PTHREADS
+    if (pthread_mutex_init(&mutex->mutex, NULL) != 0) {
+        FREE(mutex);
+        return (L_MUTEX *)ERROR_PTR("mutex not initialized", procName, NULL);
+    }
+#endif  /* USE_PTHREADS */
+    return mutex;
+}
+
+
+/*!
+ *  l_mutexDestroy()
+ *
+ *      Input:  &mutex (<will be set to null before returning>)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The mutex must not be locked.
+ */
+void
+l_mutexDestroy(L_MUTEX  **pmutex)
+{
+L_MUTEX  *mutex;
+
+    PROCNAME("l_mutexDestroy");
+
+    if (pmutex == NULL) {
+        L_WARNING("ptr address is null!\n", procName);
+        return;
+    }
+    if ((mutex = *pmutex) == NULL)
+        return;
+
+#if USE_PTHREADS
+    pthread_mutex_destroy(&mutex->mutex);
+#endif  /* USE_PTHREADS */
+    FREE(mutex);
+    *pmutex = NULL;
+    return;
+}
+
+
+/*!
+ *  l_mutexLock()
+ *
+ *      Input:  mutex
+ *      Return: void
+ */
+void
+l_mutexLock(L_MUTEX  *mutex)
+{
+    if (!mutex) return;
+#if USE_PTHREADS
+    pthread_mutex_lock(&mutex->mutex);
+#endif  /* USE_PTHREADS */
+    return;
+}
+
+
+/*!
+ *  l_mutexUnlock()
+ *
+ *      Input:  mutex
+ *      Return: void
+ */
+void
+l_mutexUnlock(L_MUTEX  *mutex)
+{
+    if (!mutex) return;
+#if USE_PTHREADS
+    pthread_mutex_unlock(&mutex->mutex);
+#endif  /* USE_PTHREADS */
+    return;
+}
+
+
+/*------------------------------------------------------------------*
+ *                     Processor SIMD support                       *
+ *------------------------------------------------------------------*/
+/*!
+ *  l_setSimdLevel()
+ *
+ *      Input:  level (L_SIMD_NONE, L_SIMD_SSE2 or L_SIMD_AVX2)
+ *      Return: previous limit on the simd level
+ *
+ *  Notes:
+ *      (1) This sets the highest instruction set that may be used by
+ *          inner loops that have simd versions.  The default is
+ *          L_SIMD_AVX2; the level actually used is never higher
+ *          than what the processor supports.
+ *      (2) Use L_SIMD_NONE to force the portable code, e.g., for
+ *          comparing results or timing.  All versions of a function
+ *          give identical results.
+ */
+l_int32
+l_setSimdLevel(l_int32  level)
+{
+l_int32  oldval;
+
+    oldval = var_SIMD_LEVEL;
+    var_SIMD_LEVEL = L_MAX(L_SIMD_NONE, L_MIN(level, L_SIMD_AVX2));
+    return oldval;
+}
+
+
+/*!
+ *  l_getSimdLevel()
+ *
+ *      Input:  (none)
+ *      Return: simd level to be used (L_SIMD_NONE, L_SIMD_SSE2 or
+ *              L_SIMD_AVX2)
+ *
+ *  Notes:
+ *      (1) This is the smaller of the limit set by l_setSimdLevel()
+ *          and the level supported by the processor.  It is always
+ *          L_SIMD_NONE when leptonica is built without USE_SIMD.
+ */
+l_int32
+l_getSimdLevel(void)
+{
+#if USE_SIMD
+    if (var_SIMD_CPU < 0) {  /* first call: query the processor */
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2"))
+            var_SIMD_CPU = L_SIMD_AVX2;
+        else if (__builtin_cpu_supports("sse2"))
+            var_SIMD_CPU = L_SIMD_SSE2;
+        else
+            var_SIMD_CPU = L_SIMD_NONE;
+    }
+    return L_MIN(var_SIMD_LEVEL, var_SIMD_CPU);
+#else
+    return L_SIMD_NONE;
+#endif  /* USE_SIMD */
+}
@@ -0,0 +1,70 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ - 
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+#ifndef  LEPTONICA_PARALLEL_H
+#define  LEPTONICA_PARALLEL_H
+
+/*
+ *  parallel.h
+ *
+ *      Support for distributing independent jobs over worker threads.
+ *
+ *      A job function is called once for each index in [0 ... njobs - 1].
+ *      The jobs are handed out dynamically to the workers, so they must
+ *      not depend on being run in any particular order or on any
+ *      particular thread.  The function returns 0 if the job succeeded
+ *      and 1 on error.
+ *
+ *      The same function type is used for a single job that runs in
+ *      the background on its own thread (an L_Thread).
+ *
+ *      The L_Thread and L_Mutex are opaque; they wrap the native
+ *      thread and lock of the thread library.  When leptonica is built
+ *      without thread support (USE_PTHREADS == 0), all jobs are run in
+ *      the calling thread, no background thread can be started, and
+ *      the lock operations are no-ops.
+ *
+ *      For further implementation details, see parallel.c.
+ */
+
+typedef l_int32 (*L_JOB_FUNC)(void *data, l_int32 index);
+
+typedef struct L_Thread  L_THREAD;
+typedef struct L_Mutex   L_MUTEX;
+
+
+/*
+ *      SIMD instruction sets that can be used for inner loops.
+ *      These are ordered: each level includes the ones below it.
+ */
+enum {
+    L_SIMD_NONE = 0,     /* portable C only             */
+    L_SIMD_SSE2 = 1,     /* 128-bit integer operations  */
+    L_SIMD_AVX2 = 2      /* 256-bit integer operations  */
+};
+
+
+#endif  /* LEPTONICA_PARALLEL_H */
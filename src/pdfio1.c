@@ -228,6 +228,11 @@ static const l_int32  DEFAULT_INPUT_RES = 300;
  *          all images to be compressed with that type.  Use 0 to have
  *          the type determined for each image based on depth and whether
  *          or not it has a colormap.
+ *      (5) The files are read and encoded on parallel threads, if
+ *          enabled with l_setNumThreads(), and the pages are written
+ *          to the output in batches as they are made, so that memory
+ *          use does not grow with the number of pages.
+ *          See l_pdfWriterAddPages().
  */
 l_int32
 convertFilesToPdf(const char  *dirname,
@@ -284,26 +289,29 @@ saConvertFilesToPdf(SARRAY      *sa,
                     const char  *title,
                     const char  *fileout)
 {
-l_uint8  *data;
-l_int32   ret;
-size_t    nbytes;
+l_int32        ret;
+FILE          *fp;
+L_PDF_WRITER  *lpw;
 
     PROCNAME("saConvertFilesToPdf");
 
     if (!sa)
         return ERROR_INT("sa not defined", procName, 1);
+    if (!fileout)
+        return ERROR_INT("fileout not defined", procName, 1);
 
-    ret = saConvertFilesToPdfData(sa, res, scalefactor, type, quality,
-                                  title, &data, &nbytes);
-    if (ret) {
-        if (data) FREE(data);
-        return ERROR_INT("pdf data not made", procName, 1);
+    if ((fp = fopenWriteStream(fileout, "wb")) == NULL)
+        return ERROR_INT("stream not opened", procName, 1);
+    if ((lpw = l_pdfWriterCreate(fp, NULL, NULL, title)) == NULL) {
+        fclose(fp);
+        return ERROR_INT("lpw not made", procName, 1);
     }
-
-    ret = l_binaryWrite(fileout, "w", data, nbytes);
-    FREE(data);
+    ret = l_pdfWriterAddPages(lpw, sa, NULL, NULL, res, scalefactor, type,
+                              quality);
+    ret |= l_pdfWriterClose(&lpw);
+    fclose(fp);
     if (ret)
-        L_ERROR("pdf data not written to file\n", procName);
+        L_ERROR("pdf not written to file\n", procName);
     return ret;
 }
 
@@ -336,14 +344,9 @@ saConvertFilesToPdfData(SARRAY      *sa,
                         l_uint8    **pdata,
                         size_t      *pnbytes)
 {
-char        *fname;
-const char  *pdftitle;
-l_uint8     *imdata;
-l_int32      i, n, ret, pagetype, npages, scaledres;
-size_t       imbytes;
-L_BYTEA     *ba;
-PIX         *pixs, *pix;
-L_PTRA      *pa_data;
+l_int32        ret;
+L_BYTEA       *ba;
+L_PDF_WRITER  *lpw;
 
     PROCNAME("saConvertFilesToPdfData");
 
@@ -355,68 +358,19 @@ L_PTRA      *pa_data;
     *pnbytes = 0;
     if (!sa)
         return ERROR_INT("sa not defined", procName, 1);
-    if (scalefactor <= 0.0) scalefactor = 1.0;
-    if (type < 0 || type > L_FLATE_ENCODE) {
-        L_WARNING("invalid compression type; using per-page default\n",
-                  procName);
-        type = 0;
-    }
-
-        /* Generate all the encoded pdf strings */
-    n = sarrayGetCount(sa);
-    pa_data = ptraCreate(n);
-    pdftitle = NULL;
-    for (i = 0; i < n; i++) {
-        if (i && (i % 10 == 0)) fprintf(stderr, ".. %d ", i);
-        fname = sarrayGetString(sa, i, L_NOCOPY);
-        if ((pixs = pixRead(fname)) == NULL) {
-            L_ERROR("image not readable from file %s\n", procName, fname);
-            continue;
-        }
-        if (!pdftitle)
-            pdftitle = (title) ? title : fname;
-        if (scalefactor != 1.0)
-            pix = pixScale(pixs, scalefactor, scalefactor);
-        else
-            pix = pixClone(pixs);
-        scaledres = (l_int32)(res * scalefactor);
-        if (type != 0) {
-            pagetype = type;
-        } else if (selectDefaultPdfEncoding(pix, &pagetype) != 0) {
-            L_ERROR("encoding type selection failed for file %s\n",
-                    procName, fname);
-            continue;
-        }
-        ret = pixConvertToPdfData(pix, pagetype, quality, &imdata, &imbytes,
-                                  0, 0, scaledres, pdftitle, NULL, 0);
-        pixDestroy(&pix);
-        pixDestroy(&pixs);
-        if (ret) {
-            L_ERROR("pdf encoding failed for %s\n", procName, fname);
-            continue;
-        }
-        ba = l_byteaInitFromMem(imdata, imbytes);
-        if (imdata) FREE(imdata);
-        ptraAdd(pa_data, ba);
-    }
-    ptraGetActualCount(pa_data, &npages);
-    if (npages == 0) {
-        L_ERROR("no pdf files made\n", procName);
-        ptraDestroy(&pa_data, FALSE, FALSE);
-        return 1;
-    }
-
-        /* Concatenate them */
-    fprintf(stderr, "\nconcatenating ... ");
-    ret = ptraConcatenatePdfToData(pa_data, NULL, pdata, pnbytes);
-    fprintf(stderr, "done\n");
 
-    ptraGetActualCount(pa_data, &npages);  /* recalculate in case it changes */
-    for (i = 0; i < npages; i++) {
-        ba = (L_BYTEA *)ptraRemove(pa_data, i, L_NO_COMPACTION);
+    ba = l_byteaCreate(0);
+    if ((lpw = l_pdfWriterCreate(NULL, l_pdfWriteToBytea, ba,
+                                 title)) == NULL) {
         l_byteaDestroy(&ba);
+        return ERROR_INT("lpw not made", procName, 1);
     }
-    ptraDestroy(&pa_data, FALSE, FALSE);
+    ret = l_pdfWriterAddPages(lpw, sa, NULL, NULL, res, scalefactor, type,
+                              quality);
+    ret |= l_pdfWriterClose(&lpw);
+    if (ret == 0)
+        *pdata = l_byteaCopyData(ba, pnbytes);
+    l_byteaDestroy(&ba);
     return ret;
 }
 
@@ -727,6 +681,8 @@ L_COMP_DATA  *cid;
  *          all images to be compressed with that type.  Use 0 to have
  *          the type determined for each image based on depth and whether
  *          or not it has a colormap.
+ *      (4) Pages are encoded on parallel threads and written in batches,
+ *          as in convertFilesToPdf().
  */
 l_int32
 pixaConvertToPdf(PIXA        *pixa,
@@ -737,26 +693,29 @@ pixaConvertToPdf(PIXA        *pixa,
                  const char  *title,
                  const char  *fileout)
 {
-l_uint8  *data;
-l_int32   ret;
-size_t    nbytes;
+l_int32        ret;
+FILE          *fp;
+L_PDF_WRITER  *lpw;
 
     PROCNAME("pixaConvertToPdf");
 
     if (!pixa)
         return ERROR_INT("pixa not defined", procName, 1);
+    if (!fileout)
+        return ERROR_INT("fileout not defined", procName, 1);
 
-    ret = pixaConvertToPdfData(pixa, res, scalefactor, type, quality,
-                               title, &data, &nbytes);
-    if (ret) {
-        FREE(data);
-        return ERROR_INT("conversion to pdf failed", procName, 1);
+    if ((fp = fopenWriteStream(fileout, "wb")) == NULL)
+        return ERROR_INT("stream not opened", procName, 1);
+    if ((lpw = l_pdfWriterCreate(fp, NULL, NULL, title)) == NULL) {
+        fclose(fp);
+        return ERROR_INT("lpw not made", procName, 1);
     }
-
-    ret = l_binaryWrite(fileout, "w", data, nbytes);
-    FREE(data);
+    ret = l_pdfWriterAddPages(lpw, NULL, pixa, NULL, res, scalefactor, type,
+                              quality);
+    ret |= l_pdfWriterClose(&lpw);
+    fclose(fp);
     if (ret)
-        L_ERROR("pdf data not written to file\n", procName);
+        L_ERROR("pdf not written to file\n", procName);
     return ret;
 }
 
@@ -788,12 +747,9 @@ pixaConvertToPdfData(PIXA        *pixa,
                      l_uint8    **pdata,
                      size_t      *pnbytes)
 {
-l_uint8  *imdata;
-l_int32   i, n, ret, scaledres, pagetype;
-size_t    imbytes;
-L_BYTEA  *ba;
-PIX      *pixs, *pix;
-L_PTRA   *pa_data;
+l_int32        ret;
+L_BYTEA       *ba;
+L_PDF_WRITER  *lpw;
 
     PROCNAME("pixaConvertToPdfData");
 
@@ -805,62 +761,19 @@ L_PTRA   *pa_data;
     *pnbytes = 0;
     if (!pixa)
         return ERROR_INT("pixa not defined", procName, 1);
-    if (scalefactor <= 0.0) scalefactor = 1.0;
-    if (type < 0 || type > L_FLATE_ENCODE) {
-        L_WARNING("invalid compression type; using per-page default\n",
-                  procName);
-        type = 0;
-    }
 
-        /* Generate all the encoded pdf strings */
-    n = pixaGetCount(pixa);
-    pa_data = ptraCreate(n);
-    for (i = 0; i < n; i++) {
-        if ((pixs = pixaGetPix(pixa, i, L_CLONE)) == NULL) {
-            L_ERROR("pix[%d] not retrieved\n", procName, i);
-            continue;
-        }
-        if (scalefactor != 1.0)
-            pix = pixScale(pixs, scalefactor, scalefactor);
-        else
-            pix = pixClone(pixs);
-        pixDestroy(&pixs);
-        scaledres = (l_int32)(res * scalefactor);
-        if (type != 0) {
-            pagetype = type;
-        } else if (selectDefaultPdfEncoding(pix, &pagetype) != 0) {
-            L_ERROR("encoding type selection failed for pix[%d]\n",
-                        procName, i);
-            pixDestroy(&pix);
-            continue;
-        }
-        ret = pixConvertToPdfData(pix, pagetype, quality, &imdata, &imbytes,
-                                  0, 0, scaledres, title, NULL, 0);
-        pixDestroy(&pix);
-        if (ret) {
-            L_ERROR("pdf encoding failed for pix[%d]\n", procName, i);
-            continue;
-        }
-        ba = l_byteaInitFromMem(imdata, imbytes);
-        if (imdata) FREE(imdata);
-        ptraAdd(pa_data, ba);
-    }
-    ptraGetActualCount(pa_data, &n);
-    if (n == 0) {
-        L_ERROR("no pdf files made\n", procName);
-        ptraDestroy(&pa_data, FALSE, FALSE);
-        return 1;
-    }
-
-        /* Concatenate them */
-    ret = ptraConcatenatePdfToData(pa_data, NULL, pdata, pnbytes);
-
-    ptraGetActualCount(pa_data, &n);  /* recalculate in case it changes */
-    for (i = 0; i < n; i++) {
-        ba = (L_BYTEA *)ptraRemove(pa_data, i, L_NO_COMPACTION);
+    ba = l_byteaCreate(0);
+    if ((lpw = l_pdfWriterCreate(NULL, l_pdfWriteToBytea, ba,
+                                 title)) == NULL) {
         l_byteaDestroy(&ba);
+        return ERROR_INT("lpw not made", procName, 1);
     }
-    ptraDestroy(&pa_data, FALSE, FALSE);
+    ret = l_pdfWriterAddPages(lpw, NULL, pixa, NULL, res, scalefactor, type,
+                              quality);
+    ret |= l_pdfWriterClose(&lpw);
+    if (ret == 0)
+        *pdata = l_byteaCopyData(ba, pnbytes);
+    l_byteaDestroy(&ba);
     return ret;
 }
 
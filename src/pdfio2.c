@@ -32,9 +32,23 @@
  *     Intermediate function for single page, multi-image conversion
  *          l_int32              pixConvertToPdfData()
  *
- *     Intermediate function for generating multipage pdf output
+ *     Intermediate functions for generating multipage pdf output
+ *          L_PTRA              *l_generatePdfPages()
+ *          static PDF_PAGE_JOBS  *pdfPageJobsCreate()
+ *          static void          pdfPageJobsDestroy()
+ *          static void          pdfPageJobsRun()
+ *          static l_int32       pdfPageJob()
  *          l_int32              ptraConcatenatePdfToData()
  *
+ *     Multipage pdf output, page by page
+ *          L_PDF_WRITER        *l_pdfWriterCreate()
+ *          l_int32              l_pdfWriterAddPix()
+ *          l_int32              l_pdfWriterAddPdfData()
+ *          l_int32              l_pdfWriterAddPages()
+ *          l_int32              l_pdfWriterClose()
+ *          static l_int32       pdfWriterOutput()
+ *          l_int32              l_pdfWriteToBytea()
+ *
  *     Low-level CID-based operations
  *
  *       Without transcoding
@@ -50,6 +64,7 @@
  *          static L_COMP_DATA  *pixGenerateFlateData()
  *          static L_COMP_DATA  *pixGenerateJpegData()
  *          static L_COMP_DATA  *pixGenerateG4Data()
+ *          static char         *pdfGenTempFilename()
  *          L_COMP_DATA         *l_generateG4Data()
  *
  *       Other
@@ -94,12 +109,47 @@
     /* Typical scan resolution in ppi (pixels/inch) */
 static const l_int32  DEFAULT_INPUT_RES = 300;
 
+    /* Minimum number of pages encoded at a time for streamed output */
+static const l_int32  MIN_PDF_BATCH = 8;
+
+    /* Shared data for encoding a batch of pages on parallel threads */
+struct PdfPageJobs
+{
+    SARRAY       *sa;           /* image files, or null                  */
+    PIXA         *pixa;         /* images, or null                       */
+    PIXAC        *pixac;        /* compressed images, or null            */
+    l_int32       n;            /* number of images                      */
+    l_int32       res;          /* input resolution of all images        */
+    l_float32     scalefactor;  /* scaling applied to each image         */
+    l_int32       type;         /* encoding type, or 0 for default       */
+    l_int32       quality;      /* used for jpeg only                    */
+    const char   *title;        /* pdf title, or null                    */
+    l_int32       first;        /* index of the first image in the batch */
+    l_int32       nalloc;       /* size of the batch arrays              */
+    PIX         **pixs;         /* images from the pixa in the batch     */
+    PIXC        **pixcs;        /* compressed images in the batch        */
+    L_BYTEA     **bas;          /* single-page pdf for each batch image  */
+};
+typedef struct PdfPageJobs  PDF_PAGE_JOBS;
+
     /* Static helpers */
 static L_COMP_DATA  *l_generateJp2kData(const char *fname);
 static L_COMP_DATA  *pixGenerateFlateData(PIX *pixs, l_int32 ascii85flag);
 static L_COMP_DATA  *pixGenerateJpegData(PIX *pixs, l_int32 ascii85flag,
                                          l_int32 quality);
 static L_COMP_DATA  *pixGenerateG4Data(PIX *pixs, l_int32 ascii85flag);
+static char         *pdfGenTempFilename(const char *tail, void *key);
+static PDF_PAGE_JOBS *pdfPageJobsCreate(SARRAY *sa, PIXA *pixa,
+                                        PIXAC *pixac, l_int32 res,
+                                        l_float32 scalefactor, l_int32 type,
+                                        l_int32 quality, const char *title,
+                                        l_int32 nalloc);
+static void          pdfPageJobsDestroy(PDF_PAGE_JOBS **pjobs);
+static void          pdfPageJobsRun(PDF_PAGE_JOBS *jobs, l_int32 first,
+                                    l_int32 nb);
+static l_int32       pdfPageJob(void *data, l_int32 index);
+static l_int32       pdfWriterOutput(L_PDF_WRITER *lpw, const void *data,
+                                     size_t nbytes);
 
 static l_int32       l_generatePdf(l_uint8 **pdata, size_t *pnbytes,
                                    L_PDF_DATA  *lpd);
@@ -257,8 +307,325 @@ L_PDF_DATA   *lpd = NULL;
 
 
 /*---------------------------------------------------------------------*
- *      Intermediate function for generating multipage pdf output      *
+ *      Intermediate functions for generating multipage pdf output     *
  *---------------------------------------------------------------------*/
+/*!
+ *  l_generatePdfPages()
+ *
+ *      Input:  sa (<optional> pathnames of image files)
+ *              pixa (<optional> images)
+ *              pixac (<optional> compressed images)
+ *              res (input resolution of all images; 0 to use the
+ *                   resolution of each image)
+ *              scalefactor (scaling factor applied to each image; > 0.0)
+ *              type (encoding type (L_JPEG_ENCODE, L_G4_ENCODE,
+ *                    L_FLATE_ENCODE, or 0 for default)
+ *              quality (used for JPEG only; 0 for default (75))
+ *              title (<optional> pdf title; if null and images are
+ *                     read from file, each file name is used)
+ *      Return: ptra of L_BYTEA, each a single-page pdf, or null on error
+ *
+ *  Notes:
+ *      (1) Exactly one of @sa, @pixa and @pixac is used as the source
+ *          of images.  Each image is scaled, encoded and wrapped as
+ *          a single-page pdf, ready for ptraConcatenatePdfToData().
+ *      (2) The pages are made on parallel threads; use l_setNumThreads()
+ *          to set the number.  They are returned in input order, and
+ *          the result is the same for any number of threads.
+ *      (3) Images that cannot be read or encoded are reported and
+ *          left out.  In a pixacomp, placeholder images with a width
+ *          of 1 are also left out.
+ *      (4) All the pages are held in memory.  To write the pages as
+ *          they are made, use l_pdfWriterAddPages().
+ */
+L_PTRA *
+l_generatePdfPages(SARRAY      *sa,
+                   PIXA        *pixa,
+                   PIXAC       *pixac,
+                   l_int32      res,
+                   l_float32    scalefactor,
+                   l_int32      type,
+                   l_int32      quality,
+                   const char  *title)
+{
+l_int32         i, n;
+L_PTRA         *pa_data;
+PDF_PAGE_JOBS  *jobs;
+
+    PROCNAME("l_generatePdfPages");
+
+    if ((jobs = pdfPageJobsCreate(sa, pixa, pixac, res, scalefactor, type,
+                                  quality, title, 0)) == NULL)
+        return (L_PTRA *)ERROR_PTR("jobs not made", procName, NULL);
+    n = jobs->n;
+    if ((pa_data = ptraCreate(n)) == NULL) {
+        pdfPageJobsDestroy(&jobs);
+        return (L_PTRA *)ERROR_PTR("pa_data not made", procName, NULL);
+    }
+
+    pdfPageJobsRun(jobs, 0, n);
+    for (i = 0; i < n; i++) {
+        if (jobs->bas[i]) {
+            ptraAdd(pa_data, jobs->bas[i]);
+            jobs->bas[i] = NULL;
+        }
+    }
+    pdfPageJobsDestroy(&jobs);
+    return pa_data;
+}
+
+
+/*!
+ *  pdfPageJobsCreate()
+ *
+ *      Input:  sa, pixa, pixac (exactly one is the source of images)
+ *              res, scalefactor, type, quality, title
+ *                  (see l_generatePdfPages())
+ *              nalloc (largest number of images in a batch; 0 for all)
+ *      Return: jobs, or null on error
+ */
+static PDF_PAGE_JOBS *
+pdfPageJobsCreate(SARRAY      *sa,
+                  PIXA        *pixa,
+                  PIXAC       *pixac,
+                  l_int32      res,
+                  l_float32    scalefactor,
+                  l_int32      type,
+                  l_int32      quality,
+                  const char  *title,
+                  l_int32      nalloc)
+{
+PDF_PAGE_JOBS  *jobs;
+
+    PROCNAME("pdfPageJobsCreate");
+
+    if (!sa && !pixa && !pixac)
+        return (PDF_PAGE_JOBS *)ERROR_PTR("no image source", procName, NULL);
+    if ((sa && pixa) || (sa && pixac) || (pixa && pixac))
+        return (PDF_PAGE_JOBS *)ERROR_PTR("more than one image source",
+                                          procName, NULL);
+    if (scalefactor <= 0.0) scalefactor = 1.0;
+    if (type < 0 || type > L_FLATE_ENCODE) {
+        L_WARNING("invalid compression type; using per-page default\n",
+                  procName);
+        type = 0;
+    }
+
+    if ((jobs = (PDF_PAGE_JOBS *)CALLOC(1, sizeof(PDF_PAGE_JOBS))) == NULL)
+        return (PDF_PAGE_JOBS *)ERROR_PTR("jobs not made", procName, NULL);
+    jobs->sa = sa;
+    jobs->pixa = pixa;
+    jobs->pixac = pixac;
+    if (sa)
+        jobs->n = sarrayGetCount(sa);
+    else if (pixa)
+        jobs->n = pixaGetCount(pixa);
+    else
+        jobs->n = pixacompGetCount(pixac);
+    jobs->res = res;
+    jobs->scalefactor = scalefactor;
+    jobs->type = type;
+    jobs->quality = quality;
+    jobs->title = title;
+    if (nalloc <= 0 || nalloc > jobs->n)
+        nalloc = jobs->n;
+    jobs->nalloc = L_MAX(1, nalloc);
+    jobs->pixs = (PIX **)CALLOC(jobs->nalloc, sizeof(PIX *));
+    jobs->pixcs = (PIXC **)CALLOC(jobs->nalloc, sizeof(PIXC *));
+    jobs->bas = (L_BYTEA **)CALLOC(jobs->nalloc, sizeof(L_BYTEA *));
+    if (!jobs->pixs || !jobs->pixcs || !jobs->bas) {
+        pdfPageJobsDestroy(&jobs);
+        return (PDF_PAGE_JOBS *)ERROR_PTR("arrays not made", procName, NULL);
+    }
+    return jobs;
+}
+
+
+/*!
+ *  pdfPageJobsDestroy()
+ *
+ *      Input:  &jobs (<will be set to null before returning>)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Any pages remaining in the batch are destroyed.
+ */
+static void
+pdfPageJobsDestroy(PDF_PAGE_JOBS  **pjobs)
+{
+l_int32         i;
+PDF_PAGE_JOBS  *jobs;
+
+    if ((jobs = *pjobs) == NULL)
+        return;
+    if (jobs->bas) {
+        for (i = 0; i < jobs->nalloc; i++)
+            l_byteaDestroy(&jobs->bas[i]);
+        FREE(jobs->bas);
+    }
+    if (jobs->pixs) {
+        for (i = 0; i < jobs->nalloc; i++)
+            pixDestroy(&jobs->pixs[i]);
+        FREE(jobs->pixs);
+    }
+    if (jobs->pixcs) FREE(jobs->pixcs);
+    FREE(jobs);
+    *pjobs = NULL;
+    return;
+}
+
+
+/*!
+ *  pdfPageJobsRun()
+ *
+ *      Input:  jobs
+ *              first (index of the first image in the batch)
+ *              nb (number of images in the batch; <= nalloc)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Makes the single-page pdf for each image in the batch, in
+ *          jobs->bas[0 ... nb - 1].  The output of the previous batch
+ *          must have been taken.
+ *      (2) The pixcomps of a pixacomp are found here, because a lazy
+ *          or cached pixacomp must only be used by the calling thread.
+ *      (3) The pix of a pixa are also taken here, and destroyed after
+ *          the batch is done.  The encoders clone and destroy their
+ *          input, and without LEPT_THREAD_SAFE the refcount changes
+ *          are not atomic.  So when the batch is done on more than
+ *          one thread, a pix that is in the batch more than once
+ *          (e.g., added to the pixa with L_CLONE) is copied for each
+ *          repeat, and each pix is then used by a single job.
+ */
+static void
+pdfPageJobsRun(PDF_PAGE_JOBS  *jobs,
+               l_int32         first,
+               l_int32         nb)
+{
+l_int32  i, j, offset, shared, accesstype;
+PIX    **pixa_pix;
+
+    jobs->first = first;
+    if (jobs->pixa) {
+        shared = (!LEPT_THREAD_SAFE && nb > 1 && l_getNumThreads() > 1);
+        pixa_pix = jobs->pixa->pix + first;
+        for (i = 0; i < nb; i++) {
+            accesstype = L_CLONE;
+            for (j = 0; shared && j < i; j++) {
+                if (pixa_pix[j] == pixa_pix[i]) {
+                    accesstype = L_COPY;
+                    break;
+                }
+            }
+            jobs->pixs[i] = pixaGetPix(jobs->pixa, first + i, accesstype);
+        }
+    }
+    if (jobs->pixac) {
+        offset = pixacompGetOffset(jobs->pixac);
+        for (i = 0; i < nb; i++)
+            jobs->pixcs[i] = pixacompGetPixcomp(jobs->pixac,
+                                                offset + first + i);
+    }
+    l_parallelRun(nb, pdfPageJob, jobs, 0);
+    if (jobs->pixa) {
+        for (i = 0; i < nb; i++)
+            pixDestroy(&jobs->pixs[i]);
+    }
+    return;
+}
+
+
+/*!
+ *  pdfPageJob()
+ *
+ *      Input:  data (the PDF_PAGE_JOBS)
+ *              index (of the image within the batch)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Makes the single-page pdf for one image.  The input images
+ *          are only read, and each job writes only its own output.
+ *          An image from a pixa is not shared with any other job in
+ *          the batch (see pdfPageJobsRun()), so the refcount changes
+ *          made by the encoders stay within this thread.
+ */
+static l_int32
+pdfPageJob(void    *data,
+           l_int32  index)
+{
+char           *fname;
+const char     *title;
+l_uint8        *imdata;
+l_int32         i, ret, pagetype, scaledres;
+size_t          imbytes;
+PIX            *pixs, *pix;
+PDF_PAGE_JOBS  *jobs;
+
+    PROCNAME("pdfPageJob");
+
+    jobs = (PDF_PAGE_JOBS *)data;
+    i = jobs->first + index;  /* index of the image */
+    title = jobs->title;
+    pixs = NULL;  /* owned here */
+    if (jobs->sa) {
+        fname = sarrayGetString(jobs->sa, i, L_NOCOPY);
+        if ((pixs = pixRead(fname)) == NULL) {
+            L_ERROR("image not readable from file %s\n", procName, fname);
+            return 1;
+        }
+        pix = pixs;
+        if (!title) title = fname;
+    } else if (jobs->pixa) {
+        if ((pix = jobs->pixs[index]) == NULL) {  /* owned by the batch */
+            L_ERROR("pix[%d] not retrieved\n", procName, i);
+            return 1;
+        }
+    } else {
+        if (!jobs->pixcs[index] ||
+            (pixs = pixCreateFromPixcomp(jobs->pixcs[index])) == NULL) {
+            L_ERROR("pix[%d] not retrieved\n", procName, i);
+            return 1;
+        }
+        if (pixGetWidth(pixs) == 1) {  /* used sometimes as placeholders */
+            L_INFO("placeholder image[%d] has w = 1\n", procName, i);
+            pixDestroy(&pixs);
+            return 0;
+        }
+        pix = pixs;
+    }
+
+        /* Use a scaled copy if required.  Otherwise, @pix is either
+         * owned here as @pixs, or it belongs to the batch. */
+    if (jobs->scalefactor != 1.0) {
+        pix = pixScale(pix, jobs->scalefactor, jobs->scalefactor);
+        pixDestroy(&pixs);
+        if ((pixs = pix) == NULL) {
+            L_ERROR("scaling failed for image %d\n", procName, i);
+            return 1;
+        }
+    }
+    scaledres = (l_int32)(jobs->res * jobs->scalefactor);
+    if (jobs->type != 0) {
+        pagetype = jobs->type;
+    } else if (selectDefaultPdfEncoding(pix, &pagetype) != 0) {
+        L_ERROR("encoding type selection failed for image %d\n",
+                procName, i);
+        pixDestroy(&pixs);
+        return 1;
+    }
+    ret = pixConvertToPdfData(pix, pagetype, jobs->quality, &imdata,
+                              &imbytes, 0, 0, scaledres, title, NULL, 0);
+    pixDestroy(&pixs);
+    if (ret) {
+        L_ERROR("pdf encoding failed for image %d\n", procName, i);
+        return 1;
+    }
+    jobs->bas[index] = l_byteaInitFromMem(imdata, imbytes);
+    FREE(imdata);
+    return 0;
+}
+
+
 /*!
  *  ptraConcatenatePdfToData()
  *
@@ -439,6 +806,373 @@ NUMAA    *naa_objs;  /* object mapping numbers to new values */
 }
 
 
+/*---------------------------------------------------------------------*
+ *                 Multipage pdf output, page by page                  *
+ *---------------------------------------------------------------------*/
+/*!
+ *  l_pdfWriterCreate()
+ *
+ *      Input:  fp (<optional> stream opened for writing "wb")
+ *              func (<optional> output function, used if @fp is null)
+ *              handle (<optional> passed to @func with each block of bytes)
+ *              title (<optional> pdf title)
+ *      Return: lpw, or null on error
+ *
+ *  Notes:
+ *      (1) Exactly one of @fp and @func must be given.  The writer
+ *          never closes @fp.
+ *      (2) Pages are added with l_pdfWriterAddPix(), l_pdfWriterAddPdfData()
+ *          or l_pdfWriterAddPages(), and the output is finished with
+ *          l_pdfWriterClose().  The objects of each page are written
+ *          as soon as the page is added; only their locations and the
+ *          Page object numbers are kept, so the memory used does not
+ *          grow with the page data.
+ *      (3) The Pages object (#3) refers to every page, so it is written
+ *          after the last page, followed by the trailer.
+ */
+L_PDF_WRITER *
+l_pdfWriterCreate(FILE              *fp,
+                  L_PDF_WRITE_FUNC   func,
+                  void              *handle,
+                  const char        *title)
+{
+L_PDF_WRITER  *lpw;
+
+    PROCNAME("l_pdfWriterCreate");
+
+    if (!fp && !func)
+        return (L_PDF_WRITER *)ERROR_PTR("neither fp nor func defined",
+                                         procName, NULL);
+    if (fp && func)
+        return (L_PDF_WRITER *)ERROR_PTR("both fp and func defined",
+                                         procName, NULL);
+
+    if ((lpw = (L_PDF_WRITER *)CALLOC(1, sizeof(L_PDF_WRITER))) == NULL)
+        return (L_PDF_WRITER *)ERROR_PTR("lpw not made", procName, NULL);
+    lpw->fp = fp;
+    lpw->func = func;
+    lpw->handle = handle;
+    if (title) lpw->title = stringNew(title);
+    lpw->nextobj = 4;  /* objects 1, 2 and 3 are from the first page */
+    lpw->objloc = l_dnaCreate(0);
+    lpw->napage = numaCreate(0);
+    return lpw;
+}
+
+
+/*!
+ *  l_pdfWriterAddPix()
+ *
+ *      Input:  lpw
+ *              pix
+ *              type (L_JPEG_ENCODE, L_G4_ENCODE, L_FLATE_ENCODE,
+ *                    or 0 for default)
+ *              quality (used for JPEG only; 0 for default (75))
+ *              res (input resolution; 0 to use the resolution of @pix)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The image is encoded as a full page, and the page is written.
+ */
+l_int32
+l_pdfWriterAddPix(L_PDF_WRITER  *lpw,
+                  PIX           *pix,
+                  l_int32        type,
+                  l_int32        quality,
+                  l_int32        res)
+{
+l_uint8  *data;
+l_int32   ret;
+size_t    nbytes;
+
+    PROCNAME("l_pdfWriterAddPix");
+
+    if (!lpw)
+        return ERROR_INT("lpw not defined", procName, 1);
+    if (!pix)
+        return ERROR_INT("pix not defined", procName, 1);
+
+    if (type == 0 && selectDefaultPdfEncoding(pix, &type) != 0)
+        return ERROR_INT("encoding type not selected", procName, 1);
+    if (pixConvertToPdfData(pix, type, quality, &data, &nbytes, 0, 0,
+                            res, lpw->title, NULL, 0))
+        return ERROR_INT("pdf data not made", procName, 1);
+    ret = l_pdfWriterAddPdfData(lpw, data, nbytes);
+    FREE(data);
+    return ret;
+}
+
+
+/*!
+ *  l_pdfWriterAddPdfData()
+ *
+ *      Input:  lpw
+ *              data (single-page pdf, made by leptonica)
+ *              nbytes (size of @data)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The requirements on @data are those of ptraConcatenatePdfToData().
+ *          From the first page, the ID and the Catalog and Info objects
+ *          are written.  From every page, the objects from the Page
+ *          object (#4) on are renumbered and written.
+ */
+l_int32
+l_pdfWriterAddPdfData(L_PDF_WRITER   *lpw,
+                      const l_uint8  *data,
+                      size_t          nbytes)
+{
+l_uint8  *datat;
+l_int32   j, nobj;
+l_int32  *locs;
+size_t    size;
+L_BYTEA  *bas, *bat1, *bat2;
+L_DNA    *da_locs;
+NUMA     *na_objs;
+
+    PROCNAME("l_pdfWriterAddPdfData");
+
+    if (!lpw)
+        return ERROR_INT("lpw not defined", procName, 1);
+    if (!data || nbytes == 0)
+        return ERROR_INT("no data", procName, 1);
+
+    bas = l_byteaInitFromMem((l_uint8 *)data, nbytes);
+    if (parseTrailerPdf(bas, &da_locs) != 0) {
+        l_byteaDestroy(&bas);
+        return ERROR_INT("can't parse pdf data", procName, 1);
+    }
+    nobj = l_dnaGetCount(da_locs) - 1;  /* da_locs[nobj] is the xref loc */
+    if (nobj < 5) {
+        l_byteaDestroy(&bas);
+        l_dnaDestroy(&da_locs);
+        return ERROR_INT("page object not found", procName, 1);
+    }
+    locs = l_dnaGetIArray(da_locs);
+
+        /* From the first page, write the ID, Catalog and Info, and save
+         * a place in the object locations for the Pages object */
+    if (numaGetCount(lpw->napage) == 0) {
+        for (j = 0; j < 3; j++) {
+            l_dnaAddNumber(lpw->objloc, lpw->nbytes);
+            pdfWriterOutput(lpw, data + locs[j], locs[j + 1] - locs[j]);
+        }
+        l_dnaAddNumber(lpw->objloc, 0);
+    }
+
+        /* Map the object numbers; this is the identity on the first
+         * page.  The Page object is the first one that is added. */
+    numaAddNumber(lpw->napage, lpw->nextobj);
+    na_objs = numaMakeConstant(0.0, nobj);
+    numaReplaceNumber(na_objs, 3, 3);  /* refers to parent of all */
+    for (j = 4; j < nobj; j++)
+        numaReplaceNumber(na_objs, j, lpw->nextobj++);
+
+    for (j = 4; j < nobj; j++) {
+        l_dnaAddNumber(lpw->objloc, lpw->nbytes);
+        bat1 = l_byteaInitFromMem((l_uint8 *)data + locs[j],
+                                  locs[j + 1] - locs[j]);
+        bat2 = substituteObjectNumbers(bat1, na_objs);
+        datat = l_byteaGetData(bat2, &size);
+        pdfWriterOutput(lpw, datat, size);
+        l_byteaDestroy(&bat1);
+        l_byteaDestroy(&bat2);
+    }
+
+    FREE(locs);
+    numaDestroy(&na_objs);
+    l_dnaDestroy(&da_locs);
+    l_byteaDestroy(&bas);
+    return lpw->error;
+}
+
+
+/*!
+ *  l_pdfWriterAddPages()
+ *
+ *      Input:  lpw
+ *              sa (<optional> pathnames of image files)
+ *              pixa (<optional> images)
+ *              pixac (<optional> compressed images)
+ *              res (input resolution of all images; 0 to use the
+ *                   resolution of each image)
+ *              scalefactor (scaling factor applied to each image; > 0.0)
+ *              type (encoding type (L_JPEG_ENCODE, L_G4_ENCODE,
+ *                    L_FLATE_ENCODE, or 0 for default)
+ *              quality (used for JPEG only; 0 for default (75))
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Exactly one of @sa, @pixa and @pixac is used as the source
+ *          of images, as in l_generatePdfPages().  If the writer has
+ *          no title and the images are read from file, the first
+ *          file name is used as the title.
+ *      (2) The pages are encoded in batches, each on parallel threads,
+ *          and each batch is written in order before the next is made.
+ *          Only one batch of encoded pages is held in memory.  The
+ *          output is the same for any number of threads.
+ *      (3) Images that cannot be read or encoded are reported and
+ *          left out.  It is an error if no page is written.
+ */
+l_int32
+l_pdfWriterAddPages(L_PDF_WRITER  *lpw,
+                    SARRAY        *sa,
+                    PIXA          *pixa,
+                    PIXAC         *pixac,
+                    l_int32        res,
+                    l_float32      scalefactor,
+                    l_int32        type,
+                    l_int32        quality)
+{
+l_uint8        *data;
+l_int32         i, n, nb, first, nbatch, npages;
+size_t          size;
+PDF_PAGE_JOBS  *jobs;
+
+    PROCNAME("l_pdfWriterAddPages");
+
+    if (!lpw)
+        return ERROR_INT("lpw not defined", procName, 1);
+
+    nbatch = L_MAX(MIN_PDF_BATCH, 2 * l_getNumThreads());
+    if ((jobs = pdfPageJobsCreate(sa, pixa, pixac, res, scalefactor, type,
+                                  quality, lpw->title, nbatch)) == NULL)
+        return ERROR_INT("jobs not made", procName, 1);
+
+    n = jobs->n;
+    npages = 0;
+    for (first = 0; first < n && !lpw->error; first += nb) {
+        nb = L_MIN(jobs->nalloc, n - first);
+        pdfPageJobsRun(jobs, first, nb);
+        for (i = 0; i < nb; i++) {
+            if (!jobs->bas[i])
+                continue;
+            data = l_byteaGetData(jobs->bas[i], &size);
+            if (l_pdfWriterAddPdfData(lpw, data, size) == 0)
+                npages++;
+            l_byteaDestroy(&jobs->bas[i]);
+        }
+    }
+
+    pdfPageJobsDestroy(&jobs);
+    if (lpw->error)
+        return ERROR_INT("output failed", procName, 1);
+    if (npages == 0)
+        return ERROR_INT("no pages written", procName, 1);
+    return 0;
+}
+
+
+/*!
+ *  l_pdfWriterClose()
+ *
+ *      Input:  &lpw (<will be set to null before returning>)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Writes the Pages object and the trailer, and destroys the
+ *          writer.  The stream, if any, is not closed.
+ *      (2) It is an error if no page was added, or if any output failed.
+ */
+l_int32
+l_pdfWriterClose(L_PDF_WRITER  **plpw)
+{
+char          *str_pages, *str_trailer;
+l_int32        ret;
+L_PDF_WRITER  *lpw;
+
+    PROCNAME("l_pdfWriterClose");
+
+    if (!plpw)
+        return ERROR_INT("&lpw not defined", procName, 1);
+    if ((lpw = *plpw) == NULL)
+        return ERROR_INT("lpw not defined", procName, 1);
+
+    ret = 0;
+    if (numaGetCount(lpw->napage) == 0) {
+        L_ERROR("no pages written\n", procName);
+        ret = 1;
+    } else {
+        l_dnaSetValue(lpw->objloc, 3, lpw->nbytes);
+        str_pages = generatePagesObjStringPdf(lpw->napage);
+        pdfWriterOutput(lpw, str_pages, strlen(str_pages));
+        pdfWriterOutput(lpw, "endobj\n", 7);
+        l_dnaAddNumber(lpw->objloc, lpw->nbytes);  /* xref location */
+        str_trailer = makeTrailerStringPdf(lpw->objloc);
+        pdfWriterOutput(lpw, str_trailer, strlen(str_trailer));
+        FREE(str_pages);
+        FREE(str_trailer);
+        if (lpw->error) {
+            L_ERROR("output failed\n", procName);
+            ret = 1;
+        }
+    }
+
+    if (lpw->title) FREE(lpw->title);
+    l_dnaDestroy(&lpw->objloc);
+    numaDestroy(&lpw->napage);
+    FREE(lpw);
+    *plpw = NULL;
+    return ret;
+}
+
+
+/*!
+ *  pdfWriterOutput()
+ *
+ *      Input:  lpw
+ *              data (bytes to write)
+ *              nbytes (number of bytes)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) After an output error, nothing more is written.
+ */
+static l_int32
+pdfWriterOutput(L_PDF_WRITER  *lpw,
+                const void    *data,
+                size_t         nbytes)
+{
+    if (lpw->error || nbytes == 0)
+        return lpw->error;
+    if (lpw->fp) {
+        if (fwrite(data, 1, nbytes, lpw->fp) != nbytes)
+            lpw->error = 1;
+    } else {
+        if (lpw->func(lpw->handle, (const l_uint8 *)data, nbytes) != 0)
+            lpw->error = 1;
+    }
+    if (!lpw->error)
+        lpw->nbytes += nbytes;
+    return lpw->error;
+}
+
+
+/*!
+ *  l_pdfWriteToBytea()
+ *
+ *      Input:  handle (an L_BYTEA)
+ *              data (bytes to append)
+ *              nbytes (number of bytes)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This is an output function for l_pdfWriterCreate() that
+ *          collects the pdf in memory, with the bytea as the handle.
+ */
+l_int32
+l_pdfWriteToBytea(void           *handle,
+                  const l_uint8  *data,
+                  size_t          nbytes)
+{
+    PROCNAME("l_pdfWriteToBytea");
+
+    if (!handle)
+        return ERROR_INT("handle not defined", procName, 1);
+    return l_byteaAppendData((L_BYTEA *)handle, (l_uint8 *)data, nbytes);
+}
+
+
 /*---------------------------------------------------------------------*
  *                     Low-level CID-based operations                  *
  *---------------------------------------------------------------------*/
@@ -1159,8 +1893,10 @@ pixGenerateJpegData(PIX     *pixs,
                     l_int32  ascii85flag,
                     l_int32  quality)
 {
-l_int32       d;
-char         *fname;
+l_uint8      *datacomp;  /* entire jpeg compressed file */
+char         *data85 = NULL;  /* ascii85 encoded jpeg compressed file */
+l_int32       d, w, h, spp, xres, yres, nbytes85;
+size_t        nbytescomp;
 L_COMP_DATA  *cid;
 
     PROCNAME("pixGenerateJpegData");
@@ -1173,14 +1909,55 @@ L_COMP_DATA  *cid;
     if (d != 8 && d != 32)
         return (L_COMP_DATA *)ERROR_PTR("pixs not 8 or 32 bpp", procName, NULL);
 
-        /* Compress to a temp jpeg file */
-    lept_mkdir("lept");
-    fname = genTempFilename("/tmp/lept", "temp.jpg", 1, 1);
-    pixWriteJpeg(fname, pixs, quality, 0);
+        /* Compress in memory.  This is called from several threads
+         * at once when the pages of a pdf are made in parallel, so
+         * no temp file is used. */
+    if (pixWriteMemJpeg(&datacomp, &nbytescomp, pixs, quality, 0))
+        return (L_COMP_DATA *)ERROR_PTR("jpeg data not made", procName, NULL);
+    if (readHeaderMemJpeg(datacomp, nbytescomp, &w, &h, &spp, NULL, NULL)) {
+        FREE(datacomp);
+        return (L_COMP_DATA *)ERROR_PTR("jpeg header not read",
+                                        procName, NULL);
+    }
+
+        /* The resolution is only written when both are defined;
+         * this gives the value that l_generateJpegData() reads back */
+    xres = pixGetXRes(pixs);
+    yres = pixGetYRes(pixs);
+    if (xres == 0 || yres == 0)
+        xres = 0;
+
+        /* Optionally, encode the compressed data */
+    if (ascii85flag == 1) {
+        data85 = encodeAscii85(datacomp, nbytescomp, &nbytes85);
+        FREE(datacomp);
+        if (!data85)
+            return (L_COMP_DATA *)ERROR_PTR("data85 not made", procName, NULL);
+        else
+            data85[nbytes85 - 1] = '\0';  /* remove the newline */
+    }
 
-    cid = l_generateJpegData(fname, ascii85flag);
-    lept_rmfile(fname);
-    lept_free(fname);
+    cid = (L_COMP_DATA *)CALLOC(1, sizeof(L_COMP_DATA));
+    if (!cid) {
+        if (ascii85flag == 0)
+            FREE(datacomp);
+        else
+            FREE(data85);
+        return (L_COMP_DATA *)ERROR_PTR("cid not made", procName, NULL);
+    }
+    if (ascii85flag == 0) {
+        cid->datacomp = datacomp;
+    } else {  /* ascii85 */
+        cid->data85 = data85;
+        cid->nbytes85 = nbytes85;
+    }
+    cid->type = L_JPEG_ENCODE;
+    cid->nbytescomp = nbytescomp;
+    cid->w = w;
+    cid->h = h;
+    cid->bps = 8;
+    cid->spp = spp;
+    cid->res = xres;
     return cid;
 }
 
@@ -1196,6 +1973,10 @@ L_COMP_DATA  *cid;
  *      (1) Set ascii85flag:
  *           - 0 for binary data (not permitted in PostScript)
  *           - 1 for ascii85 (5 for 4) encoded binary data
+ *      (2) The g4 data and its metadata are extracted from a temp tiff
+ *          file.  This is called from several threads at once when the
+ *          pages of a pdf are made in parallel, so the file name is
+ *          made with pdfGenTempFilename().
  */
 static L_COMP_DATA *
 pixGenerateG4Data(PIX     *pixs,
@@ -1213,7 +1994,8 @@ L_COMP_DATA  *cid;
 
         /* Compress to a temp tiff g4 file */
     lept_mkdir("lept");
-    tname = genTempFilename("/tmp/lept", "temp.tif", 1, 1);
+    if ((tname = pdfGenTempFilename("temp.tif", &tname)) == NULL)
+        return (L_COMP_DATA *)ERROR_PTR("tname not made", procName, NULL);
     pixWrite(tname, pixs, IFF_TIFF_G4);
 
     cid = l_generateG4Data(tname, ascii85flag);
@@ -1223,6 +2005,41 @@ L_COMP_DATA  *cid;
 }
 
 
+/*!
+ *  pdfGenTempFilename()
+ *
+ *      Input:  tail (tailname, including extension)
+ *              key (address of a local variable of the caller)
+ *      Return: temp filename in /tmp/lept, or null on error
+ *
+ *  Notes:
+ *      (1) The name made by genTempFilename() with the time and pid is
+ *          the same for two threads of a process that call it in the
+ *          same microsecond.  Here the name also has @key.  The stacks
+ *          of threads do not overlap, so @key is different for calls
+ *          that run at the same time in different threads.
+ *      (2) The caller must remove the file before it returns.  Then a
+ *          later call that has the same @key can not find the file
+ *          still in use.
+ */
+static char *
+pdfGenTempFilename(const char  *tail,
+                   void        *key)
+{
+char  buf[64];
+
+    PROCNAME("pdfGenTempFilename");
+
+    if (!tail)
+        return (char *)ERROR_PTR("tail not defined", procName, NULL);
+    if (strlen(tail) > 32)
+        return (char *)ERROR_PTR("tail too long", procName, NULL);
+
+    snprintf(buf, sizeof(buf), "%p_%s", key, tail);
+    return genTempFilename("/tmp/lept", buf, 1, 1);
+}
+
+
 /*!
  *  l_generateG4Data()
  *
@@ -49,6 +49,17 @@ l_int32 pixConvertToPdfData(PIX *pix, l_int32 type, l_int32 quality,
 
 /* ----------------------------------------------------------------------*/
 
+L_PTRA * l_generatePdfPages(SARRAY *sa, PIXA *pixa, PIXAC *pixac,
+                            l_int32 res, l_float32 scalefactor,
+                            l_int32 type, l_int32 quality,
+                            const char *title)
+{
+    return (L_PTRA *)ERROR_PTR("function not present",
+                               "l_generatePdfPages", NULL);
+}
+
+/* ----------------------------------------------------------------------*/
+
 l_int32 ptraConcatenatePdfToData(L_PTRA *pa_data, SARRAY *sa,
                                  l_uint8 **pdata, size_t *pnbytes)
 {
@@ -57,6 +68,54 @@ l_int32 ptraConcatenatePdfToData(L_PTRA *pa_data, SARRAY *sa,
 
 /* ----------------------------------------------------------------------*/
 
+L_PDF_WRITER * l_pdfWriterCreate(FILE *fp, L_PDF_WRITE_FUNC func,
+                                 void *handle, const char *title)
+{
+    return (L_PDF_WRITER *)ERROR_PTR("function not present",
+                                     "l_pdfWriterCreate", NULL);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 l_pdfWriterAddPix(L_PDF_WRITER *lpw, PIX *pix, l_int32 type,
+                          l_int32 quality, l_int32 res)
+{
+    return ERROR_INT("function not present", "l_pdfWriterAddPix", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 l_pdfWriterAddPdfData(L_PDF_WRITER *lpw, const l_uint8 *data,
+                              size_t nbytes)
+{
+    return ERROR_INT("function not present", "l_pdfWriterAddPdfData", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 l_pdfWriterAddPages(L_PDF_WRITER *lpw, SARRAY *sa, PIXA *pixa,
+                            PIXAC *pixac, l_int32 res, l_float32 scalefactor,
+                            l_int32 type, l_int32 quality)
+{
+    return ERROR_INT("function not present", "l_pdfWriterAddPages", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 l_pdfWriterClose(L_PDF_WRITER **plpw)
+{
+    return ERROR_INT("function not present", "l_pdfWriterClose", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 l_pdfWriteToBytea(void *handle, const l_uint8 *data, size_t nbytes)
+{
+    return ERROR_INT("function not present", "l_pdfWriteToBytea", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
 l_int32 l_generateCIDataForPdf(const char *fname, PIX *pix, l_int32 quality,
                                L_COMP_DATA **pcid)
 {
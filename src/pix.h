@@ -135,6 +135,9 @@ struct Pix
     char                *text;        /* text string associated with pix   */
     struct PixColormap  *colormap;    /* colormap (may be null)            */
     l_uint32            *data;        /* the image data                    */
+    void                *mapdata;     /* file mapping that holds the data; */
+                                      /* null if data is on the heap       */
+    size_t               mapsize;     /* size of the file mapping          */
 };
 typedef struct Pix PIX;
 
@@ -514,9 +517,16 @@ struct PixTiling
     l_int32              xoverlap;    /* overlap on left and right         */
     l_int32              yoverlap;    /* overlap on top and bottom         */
     l_int32              strip;       /* strip for paint; default is TRUE  */
+    struct L_Mutex      *lock;        /* serializes painting from threads  */
 };
 typedef struct PixTiling PIXTILING;
 
+    /* Operation applied to each tile by pixTilingExecute().  The
+     * tile is (i, j) = (row, column); the function paints its
+     * result(s) with pixTilingPaintTile(), and returns 0 if OK. */
+typedef l_int32 (*L_TILE_FUNC)(PIXTILING *pt, PIX *pixt, l_int32 i,
+                               l_int32 j, void *data);
+
 
 /*-------------------------------------------------------------------------*
  *                       FPix: pix with float array                        *
@@ -568,6 +578,23 @@ struct DPix
 typedef struct DPix DPIX;
 
 
+/*-------------------------------------------------------------------------*
+ *                  Integral image: sums over rectangles                   *
+ *-------------------------------------------------------------------------*/
+struct L_Integral
+{
+    l_int32              w;           /* width of source image             */
+    l_int32              h;           /* height of source image            */
+    l_int32              d;           /* depth of source image: 1 or 8 bpp */
+    l_int32              wpl;         /* sums per line: w + 1              */
+    l_uint64            *sum;         /* (w + 1) x (h + 1) sums of values; */
+                                      /* the first row and column are 0    */
+    l_uint64            *sumsq;       /* sums of squared values; can be    */
+                                      /* null                              */
+};
+typedef struct L_Integral L_INTEGRAL;
+
+
 /*-------------------------------------------------------------------------*
  *                        PixComp: compressed pix                          *
  *-------------------------------------------------------------------------*/
@@ -602,6 +629,9 @@ struct PixaComp
     l_int32              offset;      /* indexing offset into ptr array    */
     struct PixComp     **pixc;        /* the array of ptrs to PixComp      */
     struct Boxa         *boxa;        /* array of boxes                    */
+    struct Sarray       *safiles;     /* files for PixComp not yet read    */
+    l_int32              comptype;    /* compression for files not yet read */
+    struct PixacCache   *cache;       /* decompressed pix; see pixcomp.c   */
 };
 typedef struct PixaComp PIXAC;
 
@@ -130,6 +130,8 @@
  *  In pixalloc.c, we provide an example custom allocator and deallocator.
  *  To use it, you must call pmsCreate() before any pix have been allocated
  *  and pmsDestroy() at the end after all pix have been destroyed.
+ *  The pooled allocator for small objects in pixalloc.c can also be
+ *  used for pix data, with setPixMemoryManager(l_poolAlloc, l_poolFree).
  *
  *
  *  Direct manipulation of the pix data field
@@ -184,6 +186,13 @@
  *  on the pix data field, look carefully at the behavior of the image
  *  data accessors and keep in mind that when you invoke pixDestroy(),
  *  the pix considers itself the owner of all its heap data.
+ *
+ *  The image data can also be in a file mapping, rather than on the
+ *  heap; see pixReadMappedSpix().  The mapping is then held in the
+ *  mapdata field, and pixFreeData() and pixDestroy() release it with
+ *  l_binaryUnmap() instead of freeing the data.  pixTransferAllData()
+ *  moves the mapping along with the data, and pixExtractData() always
+ *  returns a heap copy of mapped data.
  */
 
 #include <string.h>
@@ -539,15 +548,12 @@ PIX  *pix;
 static void
 pixFree(PIX  *pix)
 {
-l_uint32  *data;
-char      *text;
+char  *text;
 
     if (!pix) return;
 
-    pixChangeRefcount(pix, -1);
-    if (pixGetRefcount(pix) <= 0) {
-        if ((data = pixGetData(pix)) != NULL)
-            pix_free(data);
+    if (L_REFCOUNT_ADD(&pix->refcount, -1) <= 0) {
+        pixFreeData(pix);
         if ((text = pixGetText(pix)) != NULL)
             FREE(text);
         pixDestroyColormap(pix);
@@ -812,7 +818,10 @@ PIX     *pixs;
     if (pixGetRefcount(pixs) == 1) {  /* transfer the data, cmap, text */
         pixFreeData(pixd);  /* dealloc any existing data */
         pixSetData(pixd, pixGetData(pixs));  /* transfer new data from pixs */
+        pixd->mapdata = pixs->mapdata;  /* and the file mapping, if any */
+        pixd->mapsize = pixs->mapsize;
         pixs->data = NULL;  /* pixs no longer owns data */
+        pixs->mapdata = NULL;
         pixSetColormap(pixd, pixGetColormap(pixs));  /* frees old; sets new */
         pixs->colormap = NULL;  /* pixs no longer owns colormap */
         if (copytext) {
@@ -1176,7 +1185,7 @@ pixChangeRefcount(PIX     *pix,
     if (!pix)
         return ERROR_INT("pix not defined", procName, 1);
 
-    pix->refcount += delta;
+    L_REFCOUNT_ADD(&pix->refcount, delta);
     return 0;
 }
 
@@ -1565,6 +1574,8 @@ pixSetData(PIX       *pix,
  *          pix->data ptr is set to NULL.
  *      (3) If refcount > 1, this simply returns a copy of the data,
  *          using the pix allocator, and leaving the input pix unchanged.
+ *      (4) Data in a file mapping is also copied, so that the returned
+ *          data can always be freed with the pix allocator.
  */
 l_uint32 *
 pixExtractData(PIX  *pixs)
@@ -1578,10 +1589,10 @@ l_uint32  *data, *datas;
         return (l_uint32 *)ERROR_PTR("pixs not defined", procName, NULL);
 
     count = pixGetRefcount(pixs);
-    if (count == 1) {  /* extract */
+    if (count == 1 && !pixs->mapdata) {  /* extract */
         data = pixGetData(pixs);
         pixSetData(pixs, NULL);
-    } else {  /* refcount > 1; copy */
+    } else {  /* refcount > 1 or mapped; copy */
         bytes = 4 * pixGetWpl(pixs) * pixGetHeight(pixs);
         datas = pixGetData(pixs);
         if ((data = (l_uint32 *)pix_malloc(bytes)) == NULL)
@@ -1601,6 +1612,7 @@ l_uint32  *data, *datas;
  *          It should be used before pixSetData() in the situation where
  *          you want to free any existing data before doing
  *          a subsequent assignment with pixSetData().
+ *      (2) If the data is in a file mapping, the mapping is released.
  */
 l_int32
 pixFreeData(PIX  *pix)
@@ -1612,7 +1624,12 @@ l_uint32  *data;
     if (!pix)
         return ERROR_INT("pix not defined", procName, 1);
 
-    if ((data = pixGetData(pix)) != NULL) {
+    if (pix->mapdata) {
+        l_binaryUnmap(pix->mapdata, pix->mapsize);
+        pix->mapdata = NULL;
+        pix->mapsize = 0;
+        pix->data = NULL;
+    } else if ((data = pixGetData(pix)) != NULL) {
         pix_free(data);
         pix->data = NULL;
     }
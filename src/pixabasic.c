@@ -144,13 +144,13 @@ PIXA  *pixa;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((pixa = (PIXA *)CALLOC(1, sizeof(PIXA))) == NULL)
+    if ((pixa = (PIXA *)l_poolCalloc(1, sizeof(PIXA))) == NULL)
         return (PIXA *)ERROR_PTR("pixa not made", procName, NULL);
     pixa->n = 0;
     pixa->nalloc = n;
     pixa->refcount = 1;
 
-    if ((pixa->pix = (PIX **)CALLOC(n, sizeof(PIX *))) == NULL)
+    if ((pixa->pix = (PIX **)l_poolCalloc(n, sizeof(PIX *))) == NULL)
         return (PIXA *)ERROR_PTR("pix ptrs not made", procName, NULL);
     if ((pixa->boxa = boxaCreate(n)) == NULL)
         return (PIXA *)ERROR_PTR("boxa not made", procName, NULL);
@@ -378,13 +378,12 @@ PIXA    *pixa;
         return;
 
         /* Decrement the refcount.  If it is 0, destroy the pixa. */
-    pixaChangeRefcount(pixa, -1);
-    if (pixa->refcount <= 0) {
+    if (L_REFCOUNT_ADD(&pixa->refcount, -1) <= 0) {
         for (i = 0; i < pixa->n; i++)
             pixDestroy(&pixa->pix[i]);
-        FREE(pixa->pix);
+        l_poolFree(pixa->pix);
         boxaDestroy(&pixa->boxa);
-        FREE(pixa);
+        l_poolFree(pixa);
     }
 
     *ppixa = NULL;
@@ -559,7 +558,7 @@ pixaExtendArrayToSize(PIXA    *pixa,
         return ERROR_INT("pixa not defined", procName, 1);
 
     if (size > pixa->nalloc) {
-        if ((pixa->pix = (PIX **)reallocNew((void **)&pixa->pix,
+        if ((pixa->pix = (PIX **)l_poolReallocNew((void **)&pixa->pix,
                                  sizeof(PIX *) * pixa->nalloc,
                                  size * sizeof(PIX *))) == NULL)
             return ERROR_INT("new ptr array not returned", procName, 1);
@@ -605,7 +604,7 @@ pixaChangeRefcount(PIXA    *pixa,
     if (!pixa)
         return ERROR_INT("pixa not defined", procName, 1);
 
-    pixa->refcount += delta;
+    L_REFCOUNT_ADD(&pixa->refcount, delta);
     return 0;
 }
 
@@ -1478,12 +1477,12 @@ PIXAA  *paa;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((paa = (PIXAA *)CALLOC(1, sizeof(PIXAA))) == NULL)
+    if ((paa = (PIXAA *)l_poolCalloc(1, sizeof(PIXAA))) == NULL)
         return (PIXAA *)ERROR_PTR("paa not made", procName, NULL);
     paa->n = 0;
     paa->nalloc = n;
 
-    if ((paa->pixa = (PIXA **)CALLOC(n, sizeof(PIXA *))) == NULL) {
+    if ((paa->pixa = (PIXA **)l_poolCalloc(n, sizeof(PIXA *))) == NULL) {
         pixaaDestroy(&paa);
         return (PIXAA *)ERROR_PTR("pixa ptrs not made", procName, NULL);
     }
@@ -1591,10 +1590,10 @@ PIXAA   *paa;
 
     for (i = 0; i < paa->n; i++)
         pixaDestroy(&paa->pixa[i]);
-    FREE(paa->pixa);
+    l_poolFree(paa->pixa);
     boxaDestroy(&paa->boxa);
 
-    FREE(paa);
+    l_poolFree(paa);
     *ppaa = NULL;
 
     return;
@@ -1666,7 +1665,7 @@ pixaaExtendArray(PIXAA  *paa)
     if (!paa)
         return ERROR_INT("paa not defined", procName, 1);
 
-    if ((paa->pixa = (PIXA **)reallocNew((void **)&paa->pixa,
+    if ((paa->pixa = (PIXA **)l_poolReallocNew((void **)&paa->pixa,
                              sizeof(PIXA *) * paa->nalloc,
                              2 * sizeof(PIXA *) * paa->nalloc)) == NULL)
         return ERROR_INT("new ptr array not returned", procName, 1);
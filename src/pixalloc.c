@@ -37,8 +37,25 @@
  *          l_int32       pmsGetLevelForAlloc()
  *          l_int32       pmsGetLevelForDealloc()
  *          void          pmsLogInfo()
+ *
+ *      Pooled memory for small objects
+ *
+ *          l_int32       l_poolCreate()
+ *          void          l_poolDestroy()
+ *          void         *l_poolAlloc()
+ *          void         *l_poolCalloc()
+ *          void         *l_poolReallocNew()
+ *          void          l_poolFree()
+ *          void          l_poolLogInfo()
+ *          static void  *poolGetBlock()
+ *          static L_POOL_CACHE  *poolGetCache()
+ *          static void   poolCacheDestroy()
+ *          static l_int32  poolGetLevel()
+ *          static l_int32  poolRefill()
+ *          static void   poolDrain()
  */
 
+#include <string.h>
 #include "allheaders.h"
 
 /*-------------------------------------------------------------------------*
@@ -526,3 +543,717 @@ L_PIX_MEM_STORE  *pms;
 
     return;
 }
+
+
+/*-------------------------------------------------------------------------*
+ *                    Pooled memory for small objects                      *
+ *                                                                         *
+ *  This is a thread-aware pool for the many small blocks of memory        *
+ *  that are allocated and freed over the lifetime of a program: the      *
+ *  structs and pointer arrays of Numa, Boxa, Pta and Pixa (and their     *
+ *  arrays), Box structs, and temporary buffers.  It is enabled with      *
+ *        l_poolCreate()                                                   *
+ *  before any of these are allocated, and disabled with                   *
+ *        l_poolDestroy()                                                  *
+ *  at the end, after all of them have been destroyed.  Until it is       *
+ *  enabled, l_poolAlloc(), l_poolCalloc(), l_poolReallocNew() and        *
+ *  l_poolFree() simply call the standard allocator.                       *
+ *-------------------------------------------------------------------------*/
+/*
+ *  The pool takes its memory from a single arena, which is allocated
+ *  when the pool is created.  The arena is divided into slabs of
+ *  64 KB.  When a slab is first needed, it is assigned to one of the
+ *  block sizes, which are powers of 2 from 16 bytes to 32 KB, and
+ *  it is split into blocks of that size.  The slabs are never
+ *  returned to the system, and a slab is never reassigned to a
+ *  different size, so memory freed to the pool is always reused for
+ *  the next request of the same size.  This keeps the heap from being
+ *  fragmented by millions of small malloc/free cycles.  Because the
+ *  arena is not touched until slabs are assigned, its pages become
+ *  resident only as they are used.
+ *
+ *  As in the pix memory store above, a block is identified as coming
+ *  from the pool by its address, and the block size is found from the
+ *  slab that contains it.  Requests that are larger than 32 KB, or
+ *  that arrive when all slabs have been assigned and there is no free
+ *  block of the right size, are allocated with the standard allocator,
+ *  and l_poolFree() frees them with it.  For the same reason, memory
+ *  that was allocated before the pool was created can be safely freed
+ *  with l_poolFree().
+ *
+ *  Each thread has a cache with a short free list for each block size.
+ *  Most allocations and frees only touch the cache of the calling
+ *  thread, and take no lock.  When a cache list is empty, it is
+ *  refilled with a batch of blocks from the shared free lists, and
+ *  when it is too long, a batch is returned to them.  The cache of
+ *  a thread is returned to the shared lists when the thread exits.
+ *  Without thread support (USE_PTHREADS == 0), there is a single cache.
+ *
+ *  If statistics are requested, every allocation and free also updates
+ *  counters for its block size under the lock.  These are printed by
+ *  l_poolLogInfo(), in the same format as pmsLogInfo().  Collecting
+ *  statistics serializes the threads, so it should only be used to
+ *  size the arena.  Each thread cache also counts its own allocations,
+ *  frees, refills and drains, which shows how much of the traffic was
+ *  handled without the lock.  When a thread exits, its counts are
+ *  added to those of the exited threads.
+ */
+
+#if USE_PTHREADS
+#include <pthread.h>
+#endif  /* USE_PTHREADS */
+
+#define  POOL_NLEVELS      12   /* block sizes 16 bytes ... 32 KB       */
+#define  POOL_MIN_SHIFT     4   /* log2 of the smallest block size      */
+#define  POOL_SLAB_SHIFT   16   /* log2 of the slab size                */
+static const size_t   POOL_CACHE_BYTES = 65536;  /* cached per level   */
+static const l_int32  POOL_MIN_CACHED = 4;   /* min blocks cached per level */
+
+    /* Free lists of one thread */
+struct L_PoolCache
+{
+    void                *head[POOL_NLEVELS];   /* free lists          */
+    l_int32              count[POOL_NLEVELS];  /* length of each list */
+    struct L_PoolCache  *next;                 /* list of all caches  */
+    struct L_PoolCache  *prev;
+    l_int32              id;      /* number of the cache, in order made */
+    size_t               nalloc;  /* stats: # of blocks taken           */
+    size_t               nfree;   /* stats: # of blocks returned        */
+    size_t               nrefill; /* stats: # of refills from shared    */
+    size_t               ndrain;  /* stats: # of drains to shared       */
+};
+typedef struct L_PoolCache  L_POOL_CACHE;
+
+struct L_MemoryPool
+{
+    l_uint8        *baseptr;    /* arena                                 */
+    l_uint8        *maxptr;     /* just beyond the arena                 */
+    l_int32         nslabs;     /* number of slabs in the arena          */
+    l_int32         nused;      /* number of slabs assigned to a level   */
+    l_uint8        *slablevel;  /* block size level of each slab         */
+    void           *head[POOL_NLEVELS];    /* shared free lists          */
+    l_int32         count[POOL_NLEVELS];   /* length of each list        */
+    l_int32         maxcached[POOL_NLEVELS];  /* max length of cache list */
+    L_MUTEX        *mutex;      /* protects everything shared            */
+    L_POOL_CACHE   *caches;     /* list of all thread caches             */
+#if USE_PTHREADS
+    pthread_key_t   key;        /* cache of each thread                  */
+#endif  /* USE_PTHREADS */
+    l_int32         stats;      /* 1 to collect statistics               */
+    size_t          memused[POOL_NLEVELS];   /* stats: total # of blocks  */
+    size_t          meminuse[POOL_NLEVELS];  /* stats: # in use           */
+    size_t          memmax[POOL_NLEVELS];    /* stats: max # in use       */
+    size_t          memempty[POOL_NLEVELS];  /* stats: # alloc'd because  */
+                                             /* the arena was full        */
+    size_t          memlarge;   /* stats: # too large for the pool       */
+    l_int32         ncaches;    /* number of thread caches made          */
+    l_int32         nexited;    /* stats: # of caches of exited threads  */
+    size_t          oldcounts[4];  /* stats: alloc, free, refill and    */
+                                   /* drain counts of exited threads    */
+};
+typedef struct L_MemoryPool  L_MEMORY_POOL;
+
+static L_MEMORY_POOL  *MemPool = NULL;
+
+static void *poolGetBlock(L_MEMORY_POOL *pool, size_t nbytes);
+static L_POOL_CACHE *poolGetCache(L_MEMORY_POOL *pool);
+static void poolCacheDestroy(void *data);
+static l_int32 poolGetLevel(size_t nbytes);
+static l_int32 poolRefill(L_MEMORY_POOL *pool, L_POOL_CACHE *cache,
+                          l_int32 level);
+static void poolDrain(L_MEMORY_POOL *pool, L_POOL_CACHE *cache,
+                      l_int32 level, l_int32 n);
+
+
+/*!
+ *  l_poolCreate()
+ *
+ *      Input:  arenasize (max number of bytes for the pool)
+ *              stats (1 to collect statistics; 0 otherwise)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The arena is rounded up to a multiple of 64 KB.  Choose
+ *          it large enough for the peak number of small blocks that
+ *          the program has in use; requests that do not fit are
+ *          handled by the standard allocator.
+ *      (2) Important: call this before any Numa, Boxa, Pta or Pixa
+ *          has been made, and before any other thread uses leptonica.
+ *      (3) To also take the image data of small pix from the pool, use
+ *          setPixMemoryManager(l_poolAlloc, l_poolFree) after this call.
+ */
+l_int32
+l_poolCreate(size_t   arenasize,
+             l_int32  stats)
+{
+l_int32         i, nslabs;
+size_t          maxcached;
+L_MEMORY_POOL  *pool;
+
+    PROCNAME("l_poolCreate");
+
+    if (MemPool)
+        return ERROR_INT("pool already exists", procName, 1);
+    nslabs = (arenasize + (1 << POOL_SLAB_SHIFT) - 1) >> POOL_SLAB_SHIFT;
+    if (nslabs < 1)
+        return ERROR_INT("arenasize not > 0", procName, 1);
+
+    if ((pool = (L_MEMORY_POOL *)CALLOC(1, sizeof(L_MEMORY_POOL))) == NULL)
+        return ERROR_INT("pool not made", procName, 1);
+    pool->nslabs = nslabs;
+    pool->baseptr = (l_uint8 *)MALLOC((size_t)nslabs << POOL_SLAB_SHIFT);
+    pool->slablevel = (l_uint8 *)CALLOC(nslabs, sizeof(l_uint8));
+    if (!pool->baseptr || !pool->slablevel) {
+        FREE(pool->baseptr);
+        FREE(pool->slablevel);
+        FREE(pool);
+        return ERROR_INT("arena not made", procName, 1);
+    }
+    pool->maxptr = pool->baseptr + ((size_t)nslabs << POOL_SLAB_SHIFT);
+    for (i = 0; i < POOL_NLEVELS; i++) {
+        maxcached = POOL_CACHE_BYTES >> (i + POOL_MIN_SHIFT);
+        pool->maxcached[i] = L_MAX(POOL_MIN_CACHED, (l_int32)maxcached);
+    }
+    pool->mutex = l_mutexCreate();
+    pool->stats = stats;
+#if USE_PTHREADS
+    if (pthread_key_create(&pool->key, poolCacheDestroy) != 0) {
+        l_mutexDestroy(&pool->mutex);
+        FREE(pool->baseptr);
+        FREE(pool->slablevel);
+        FREE(pool);
+        return ERROR_INT("thread key not made", procName, 1);
+    }
+#endif  /* USE_PTHREADS */
+
+    MemPool = pool;
+    return 0;
+}
+
+
+/*!
+ *  l_poolDestroy()
+ *
+ *      Input:  (none)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Important: call this at the end of the program, after the
+ *          last object that uses the pool has been destroyed, and when
+ *          no other thread is using leptonica.
+ *      (2) If statistics were collected, they are written to stderr.
+ */
+void
+l_poolDestroy(void)
+{
+L_MEMORY_POOL  *pool;
+L_POOL_CACHE   *cache, *next;
+
+    if ((pool = MemPool) == NULL)
+        return;
+
+    if (pool->stats)
+        l_poolLogInfo();
+    MemPool = NULL;
+#if USE_PTHREADS
+    pthread_key_delete(pool->key);
+#endif  /* USE_PTHREADS */
+    for (cache = pool->caches; cache; cache = next) {
+        next = cache->next;
+        FREE(cache);
+    }
+    l_mutexDestroy(&pool->mutex);
+    FREE(pool->baseptr);
+    FREE(pool->slablevel);
+    FREE(pool);
+    return;
+}
+
+
+/*!
+ *  l_poolAlloc()
+ *
+ *      Input:  nbytes
+ *      Return: data (not initialized), or null on error
+ *
+ *  Notes:
+ *      (1) This has the same signature as malloc, so it can be used
+ *          as a pix allocator with setPixMemoryManager().
+ */
+void *
+l_poolAlloc(size_t  nbytes)
+{
+void           *data;
+L_MEMORY_POOL  *pool;
+
+    if ((pool = MemPool) == NULL)
+        return MALLOC(nbytes);
+    if ((data = poolGetBlock(pool, nbytes)) == NULL)
+        data = MALLOC(nbytes);
+    return data;
+}
+
+
+/*!
+ *  l_poolCalloc()
+ *
+ *      Input:  nelem (number of elements)
+ *              elemsize (size of each element)
+ *      Return: data (initialized to 0), or null on error
+ */
+void *
+l_poolCalloc(size_t  nelem,
+             size_t  elemsize)
+{
+size_t          nbytes;
+void           *data;
+L_MEMORY_POOL  *pool;
+
+    if ((pool = MemPool) == NULL)
+        return CALLOC(nelem, elemsize);
+    nbytes = nelem * elemsize;
+    if (elemsize != 0 && nbytes / elemsize != nelem)  /* overflow */
+        return NULL;
+    if ((data = poolGetBlock(pool, nbytes)) == NULL)
+        return CALLOC(nelem, elemsize);
+    memset(data, 0, nbytes);
+    return data;
+}
+
+
+/*!
+ *  l_poolReallocNew()
+ *
+ *      Input:  &indata (<optional>; nulls indata)
+ *              oldsize (size of input data to be copied, in bytes)
+ *              newsize (size of data to be reallocated in bytes)
+ *      Return: ptr to new data, or null on error
+ *
+ *  Notes:
+ *      (1) This is the same as reallocNew(), except that the input
+ *          is freed with l_poolFree() and the new memory is taken
+ *          from the pool.  If the new size is in the same pool block
+ *          size as the input data, the input block is reused.
+ */
+void *
+l_poolReallocNew(void   **pindata,
+                 l_int32  oldsize,
+                 l_int32  newsize)
+{
+l_int32         level;
+l_uint8        *indata;
+void           *newdata;
+L_MEMORY_POOL  *pool;
+
+    PROCNAME("l_poolReallocNew");
+
+    if (!pindata)
+        return ERROR_PTR("input data not defined", procName, NULL);
+    indata = (l_uint8 *)(*pindata);
+
+    if (newsize <= 0) {   /* nonstandard usage */
+        if (indata) {
+            l_poolFree(indata);
+            *pindata = NULL;
+        }
+        return NULL;
+    }
+
+        /* Reuse the block if it is from the pool and large enough */
+    pool = MemPool;
+    if (pool && indata && indata >= pool->baseptr && indata < pool->maxptr) {
+        level = pool->slablevel[(indata - pool->baseptr) >> POOL_SLAB_SHIFT];
+        if (newsize <= (1 << (level + POOL_MIN_SHIFT))) {
+            if (newsize > oldsize)
+                memset(indata + oldsize, 0, newsize - oldsize);
+            *pindata = NULL;
+            return indata;
+        }
+    }
+
+    if ((newdata = l_poolCalloc(1, newsize)) == NULL)
+        return ERROR_PTR("newdata not made", procName, NULL);
+    if (indata) {
+        memcpy(newdata, indata, L_MIN(oldsize, newsize));
+        l_poolFree(indata);
+        *pindata = NULL;
+    }
+    return newdata;
+}
+
+
+/*!
+ *  l_poolFree()
+ *
+ *      Input:  data (<optional>; to be returned to the pool or freed)
+ *      Return: void
+ */
+void
+l_poolFree(void  *data)
+{
+l_int32         level;
+l_uint8        *ptr;
+L_MEMORY_POOL  *pool;
+L_POOL_CACHE   *cache;
+
+    if (!data)
+        return;
+    ptr = (l_uint8 *)data;
+    pool = MemPool;
+    if (!pool || ptr < pool->baseptr || ptr >= pool->maxptr) {
+        FREE(data);
+        return;
+    }
+
+    level = pool->slablevel[(ptr - pool->baseptr) >> POOL_SLAB_SHIFT];
+    if (pool->stats) {
+        l_mutexLock(pool->mutex);
+        pool->meminuse[level]--;
+        l_mutexUnlock(pool->mutex);
+    }
+    if ((cache = poolGetCache(pool)) == NULL) {  /* no cache; use shared */
+        l_mutexLock(pool->mutex);
+        *(void **)data = pool->head[level];
+        pool->head[level] = data;
+        pool->count[level]++;
+        l_mutexUnlock(pool->mutex);
+        return;
+    }
+    *(void **)data = cache->head[level];
+    cache->head[level] = data;
+    if (pool->stats)
+        cache->nfree++;
+    if (++cache->count[level] > pool->maxcached[level]) {
+        l_mutexLock(pool->mutex);
+        poolDrain(pool, cache, level, pool->maxcached[level] / 2);
+        l_mutexUnlock(pool->mutex);
+        if (pool->stats)
+            cache->ndrain++;
+    }
+    return;
+}
+
+
+/*!
+ *  l_poolLogInfo()
+ *
+ *      Input:  (none)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This writes the statistics of the pool to stderr.  They
+ *          are only available if requested in l_poolCreate().
+ *      (2) The counts of each thread cache are updated by its thread
+ *          without the lock, so those of threads that are still
+ *          running may be slightly out of date.
+ */
+void
+l_poolLogInfo(void)
+{
+l_int32         i;
+L_MEMORY_POOL  *pool;
+L_POOL_CACHE   *cache;
+
+    PROCNAME("l_poolLogInfo");
+
+    if ((pool = MemPool) == NULL)
+        return;
+    if (!pool->stats) {
+        L_INFO("statistics not collected\n", procName);
+        return;
+    }
+
+    l_mutexLock(pool->mutex);
+    fprintf(stderr, "Slabs of %d bytes assigned: %d of %d\n",
+            1 << POOL_SLAB_SHIFT, pool->nused, pool->nslabs);
+    fprintf(stderr, "Total number of blocks used at each level\n");
+    for (i = 0; i < POOL_NLEVELS; i++)
+         fprintf(stderr, " Level %d (%d bytes): %lu\n", i,
+                 1 << (i + POOL_MIN_SHIFT), (unsigned long)pool->memused[i]);
+    fprintf(stderr, "Max number of blocks in use at any time in each level\n");
+    for (i = 0; i < POOL_NLEVELS; i++)
+         fprintf(stderr, " Level %d (%d bytes): %lu\n", i,
+                 1 << (i + POOL_MIN_SHIFT), (unsigned long)pool->memmax[i]);
+    fprintf(stderr, "Number of blocks in use now in each level\n");
+    for (i = 0; i < POOL_NLEVELS; i++)
+         fprintf(stderr, " Level %d (%d bytes): %lu\n", i,
+                 1 << (i + POOL_MIN_SHIFT), (unsigned long)pool->meminuse[i]);
+    fprintf(stderr, "Number of blocks alloc'd because the arena was full\n");
+    for (i = 0; i < POOL_NLEVELS; i++)
+         fprintf(stderr, " Level %d (%d bytes): %lu\n", i,
+                 1 << (i + POOL_MIN_SHIFT), (unsigned long)pool->memempty[i]);
+    fprintf(stderr, "Number of allocs too large for the pool: %lu\n",
+            (unsigned long)pool->memlarge);
+    fprintf(stderr, "Blocks taken and returned by each thread cache\n");
+    for (cache = pool->caches; cache; cache = cache->next)
+        fprintf(stderr, " Thread %d: alloc %lu, free %lu, refill %lu, "
+                "drain %lu\n", cache->id, (unsigned long)cache->nalloc,
+                (unsigned long)cache->nfree, (unsigned long)cache->nrefill,
+                (unsigned long)cache->ndrain);
+    fprintf(stderr, " %d exited threads: alloc %lu, free %lu, refill %lu, "
+            "drain %lu\n", pool->nexited, (unsigned long)pool->oldcounts[0],
+            (unsigned long)pool->oldcounts[1],
+            (unsigned long)pool->oldcounts[2],
+            (unsigned long)pool->oldcounts[3]);
+    l_mutexUnlock(pool->mutex);
+    return;
+}
+
+
+/*!
+ *  poolGetBlock()
+ *
+ *      Input:  pool
+ *              nbytes
+ *      Return: data (not initialized), or null if the request must
+ *              be handled by the standard allocator
+ */
+static void *
+poolGetBlock(L_MEMORY_POOL  *pool,
+             size_t          nbytes)
+{
+l_int32        level, found;
+void          *data;
+L_POOL_CACHE  *cache;
+
+    if ((level = poolGetLevel(nbytes)) < 0) {
+        if (pool->stats) {
+            l_mutexLock(pool->mutex);
+            pool->memlarge++;
+            l_mutexUnlock(pool->mutex);
+        }
+        return NULL;
+    }
+
+    data = NULL;
+    if ((cache = poolGetCache(pool)) == NULL) {  /* no cache; use shared */
+        l_mutexLock(pool->mutex);
+        if (pool->head[level] || poolRefill(pool, NULL, level) == 0) {
+            data = pool->head[level];
+            pool->head[level] = *(void **)data;
+            pool->count[level]--;
+        }
+        l_mutexUnlock(pool->mutex);
+    } else {
+        found = (cache->head[level] != NULL);
+        if (!found) {
+            l_mutexLock(pool->mutex);
+            found = (poolRefill(pool, cache, level) == 0);
+            l_mutexUnlock(pool->mutex);
+            if (found && pool->stats)
+                cache->nrefill++;
+        }
+        if (found) {
+            data = cache->head[level];
+            cache->head[level] = *(void **)data;
+            cache->count[level]--;
+            if (pool->stats)
+                cache->nalloc++;
+        }
+    }
+
+    if (pool->stats) {
+        l_mutexLock(pool->mutex);
+        if (data) {
+            pool->memused[level]++;
+            pool->meminuse[level]++;
+            if (pool->meminuse[level] > pool->memmax[level])
+                pool->memmax[level] = pool->meminuse[level];
+        } else {
+            pool->memempty[level]++;
+        }
+        l_mutexUnlock(pool->mutex);
+    }
+    return data;
+}
+
+
+/*!
+ *  poolGetCache()
+ *
+ *      Input:  pool
+ *      Return: cache of the calling thread, or null if it can't be made
+ *
+ *  Notes:
+ *      (1) The cache is made on the first call from each thread.
+ */
+static L_POOL_CACHE *
+poolGetCache(L_MEMORY_POOL  *pool)
+{
+L_POOL_CACHE  *cache;
+
+#if USE_PTHREADS
+    if ((cache = (L_POOL_CACHE *)pthread_getspecific(pool->key)) != NULL)
+        return cache;
+    if ((cache = (L_POOL_CACHE *)CALLOC(1, sizeof(L_POOL_CACHE))) == NULL)
+        return NULL;
+    if (pthread_setspecific(pool->key, cache) != 0) {
+        FREE(cache);
+        return NULL;
+    }
+#else
+    if ((cache = pool->caches) != NULL)
+        return cache;
+    if ((cache = (L_POOL_CACHE *)CALLOC(1, sizeof(L_POOL_CACHE))) == NULL)
+        return NULL;
+#endif  /* USE_PTHREADS */
+
+    l_mutexLock(pool->mutex);
+    cache->id = pool->ncaches++;
+    cache->next = pool->caches;
+    if (pool->caches)
+        pool->caches->prev = cache;
+    pool->caches = cache;
+    l_mutexUnlock(pool->mutex);
+    return cache;
+}
+
+
+/*!
+ *  poolCacheDestroy()
+ *
+ *      Input:  data (cache of a thread that is exiting)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) All the blocks in the cache are returned to the shared lists.
+ *      (2) If statistics are collected, the counts of the cache are
+ *          added to those of the exited threads.
+ */
+static void
+poolCacheDestroy(void  *data)
+{
+l_int32         i;
+L_MEMORY_POOL  *pool;
+L_POOL_CACHE   *cache;
+
+    cache = (L_POOL_CACHE *)data;
+    if ((pool = MemPool) == NULL || !cache)
+        return;
+
+    l_mutexLock(pool->mutex);
+    for (i = 0; i < POOL_NLEVELS; i++)
+        poolDrain(pool, cache, i, cache->count[i]);
+    if (pool->stats) {
+        pool->nexited++;
+        pool->oldcounts[0] += cache->nalloc;
+        pool->oldcounts[1] += cache->nfree;
+        pool->oldcounts[2] += cache->nrefill;
+        pool->oldcounts[3] += cache->ndrain;
+    }
+    if (cache->prev)
+        cache->prev->next = cache->next;
+    else
+        pool->caches = cache->next;
+    if (cache->next)
+        cache->next->prev = cache->prev;
+    l_mutexUnlock(pool->mutex);
+    FREE(cache);
+    return;
+}
+
+
+/*!
+ *  poolGetLevel()
+ *
+ *      Input:  nbytes
+ *      Return: level of the smallest block size that holds nbytes,
+ *              or -1 if it is too large for the pool
+ */
+static l_int32
+poolGetLevel(size_t  nbytes)
+{
+l_int32  level;
+
+    for (level = 0; level < POOL_NLEVELS; level++) {
+        if (nbytes <= ((size_t)1 << (level + POOL_MIN_SHIFT)))
+            return level;
+    }
+    return -1;
+}
+
+
+/*!
+ *  poolRefill()
+ *
+ *      Input:  pool (the lock is held by the caller)
+ *              cache (<optional>; null to only refill the shared list)
+ *              level
+ *      Return: 0 if there are free blocks at the level, 1 if the
+ *              arena is full
+ *
+ *  Notes:
+ *      (1) If the shared list is empty, the next unused slab is
+ *          split into blocks at this level.
+ *      (2) If @cache is defined, up to half the max number of cached
+ *          blocks are moved from the shared list to the cache.
+ */
+static l_int32
+poolRefill(L_MEMORY_POOL  *pool,
+           L_POOL_CACHE   *cache,
+           l_int32         level)
+{
+l_int32   i, size, nblocks, n;
+l_uint8  *slab;
+void     *block;
+
+    if (!pool->head[level]) {
+        if (pool->nused == pool->nslabs)
+            return 1;
+        slab = pool->baseptr + ((size_t)pool->nused << POOL_SLAB_SHIFT);
+        pool->slablevel[pool->nused++] = level;
+        size = 1 << (level + POOL_MIN_SHIFT);
+        nblocks = 1 << (POOL_SLAB_SHIFT - level - POOL_MIN_SHIFT);
+        for (i = nblocks - 1; i >= 0; i--) {  /* lowest address first */
+            block = slab + i * size;
+            *(void **)block = pool->head[level];
+            pool->head[level] = block;
+        }
+        pool->count[level] += nblocks;
+    }
+    if (!cache)
+        return 0;
+
+    n = L_MIN(pool->count[level], pool->maxcached[level] / 2);
+    n = L_MAX(n, 1);
+    for (i = 0; i < n && pool->head[level]; i++) {
+        block = pool->head[level];
+        pool->head[level] = *(void **)block;
+        *(void **)block = cache->head[level];
+        cache->head[level] = block;
+    }
+    pool->count[level] -= i;
+    cache->count[level] += i;
+    return 0;
+}
+
+
+/*!
+ *  poolDrain()
+ *
+ *      Input:  pool (the lock is held by the caller)
+ *              cache
+ *              level
+ *              n (number of blocks to move from the cache to the
+ *                 shared list)
+ *      Return: void
+ */
+static void
+poolDrain(L_MEMORY_POOL  *pool,
+          L_POOL_CACHE   *cache,
+          l_int32         level,
+          l_int32         n)
+{
+l_int32  i;
+void    *block;
+
+    for (i = 0; i < n && cache->head[level]; i++) {
+        block = cache->head[level];
+        cache->head[level] = *(void **)block;
+        *(void **)block = pool->head[level];
+        pool->head[level] = block;
+    }
+    cache->count[level] -= i;
+    pool->count[level] += i;
+    return;
+}
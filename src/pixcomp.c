@@ -46,6 +46,8 @@
  *           PIXAC    *pixacompCreateFromPixa()
  *           PIXAC    *pixacompCreateFromFiles()
  *           PIXAC    *pixacompCreateFromSA()
+ *           PIXAC    *pixacompCreateFromFilesLazy()
+ *           PIXAC    *pixacompCreateFromSALazy()
  *           void      pixacompDestroy()
  *
  *      Pixacomp addition/replacement
@@ -67,6 +69,21 @@
  *           l_int32   pixacompGetBoxGeometry()
  *           l_int32   pixacompGetOffset()
  *           l_int32   pixacompSetOffset()
+ *           static PIXC  *pixacompLoadPixcomp()
+ *
+ *      Pixacomp cache of decompressed pix
+ *           l_int32   pixacompSetCache()
+ *           l_int32   pixacompGetCacheInfo()
+ *           static PIXAC_CACHE  *pixacCacheCreate()
+ *           static void          pixacCacheDestroy()
+ *           static l_int32       pixacCacheExtend()
+ *           static PIX          *pixacCacheFetch()
+ *           static void          pixacCacheInsert()
+ *           static void          pixacCacheRemove()
+ *           static void          pixacompStartPrefetch()
+ *           static void          pixacompWaitPrefetch()
+ *           static void          pixacompStopPrefetch()
+ *           static l_int32       pixacompPrefetchJob()
  *
  *      Pixacomp conversion to Pixa
  *           PIXA     *pixaCreateFromPixacomp()
@@ -130,6 +147,20 @@
  *   This would allocate an array of 50 pixcomps, but if you asked for
  *   the pix at index 10, using pixacompGetPix(pixac, 10), it would
  *   apply the offset internally, returning the pix at index 0 in the array.
+ *
+ *   For a large set of image files, such as the pages of a book, there
+ *   are two ways to avoid reading and decompressing more than is needed:
+ *     (1) A pixacomp made with pixacompCreateFromFilesLazy() or
+ *         pixacompCreateFromSALazy() holds only the file names at first.
+ *         Each file is read into a pixcomp the first time it is needed.
+ *     (2) pixacompSetCache() keeps the most recently used decompressed
+ *         pix, up to a memory budget, so that pixacompGetPix() does
+ *         not decompress the same image again.  It can also read ahead
+ *         the images that follow the one requested, on a background
+ *         thread, so that they are ready when a viewer or pdf writer
+ *         gets to them.
+ *   Either can be used alone.  The pixacomp is still to be used by
+ *   one thread at a time; the read-ahead thread is managed internally.
  */
 
 #include <string.h>
@@ -141,8 +172,41 @@ static const l_int32  INITIAL_PTR_ARRAYSIZE = 20;   /* n'import quoi */
 extern l_int32 NumImageFileFormatExtensions;
 extern const char *ImageFileFormatExtensions[];
 
-    /* Static function */
+    /* Decompressed pix of a pixacomp, in order of last use */
+struct PixacCache
+{
+    l_int32       nalloc;     /* size of each array; same as the pixac    */
+    PIX         **pix;        /* decompressed pix for each array index    */
+    l_int32      *newer;      /* index of the next more recently used pix */
+    l_int32      *older;      /* index of the next less recently used pix */
+    l_int32       newest;     /* most recently used index, or -1          */
+    l_int32       oldest;     /* least recently used index, or -1         */
+    l_int32       npix;       /* number of pix held                       */
+    size_t        nbytes;     /* bytes of raster data held                */
+    size_t        maxbytes;   /* limit on nbytes                          */
+    l_int32       nprefetch;  /* number of following pix to read ahead    */
+    L_MUTEX      *lock;       /* protects all of the above, and pfend     */
+    L_THREAD     *thread;     /* read-ahead thread, or null               */
+    l_int32       pfstart;    /* first array index to be read ahead       */
+    l_int32       pfend;      /* one past the last index to be read ahead */
+    l_int32       pfdone;     /* set when the read-ahead thread is done   */
+};
+typedef struct PixacCache  PIXAC_CACHE;
+
+    /* Static functions */
 static l_int32 pixacompExtendArray(PIXAC *pixac);
+static PIXC *pixacompLoadPixcomp(PIXAC *pixac, l_int32 aindex);
+static PIXAC_CACHE *pixacCacheCreate(l_int32 nalloc, size_t maxbytes,
+                                     l_int32 nprefetch);
+static void pixacCacheDestroy(PIXAC_CACHE **pcache);
+static l_int32 pixacCacheExtend(PIXAC_CACHE *cache, l_int32 nalloc);
+static PIX *pixacCacheFetch(PIXAC_CACHE *cache, l_int32 aindex);
+static void pixacCacheInsert(PIXAC_CACHE *cache, l_int32 aindex, PIX *pix);
+static void pixacCacheRemove(PIXAC_CACHE *cache, l_int32 aindex);
+static void pixacompStartPrefetch(PIXAC *pixac, l_int32 aindex);
+static void pixacompWaitPrefetch(PIXAC *pixac, l_int32 aindex);
+static void pixacompStopPrefetch(PIXAC *pixac);
+static l_int32 pixacompPrefetchJob(void *data, l_int32 index);
 
 
 /*---------------------------------------------------------------------*
@@ -734,6 +798,85 @@ PIXAC   *pixac;
 }
 
 
+/*!
+ *  pixacompCreateFromFilesLazy()
+ *
+ *      Input:  dirname
+ *              substr (<optional> substring filter on filenames; can be null)
+ *              comptype (IFF_DEFAULT, IFF_TIFF_G4, IFF_PNG, IFF_JFIF_JPEG)
+ *      Return: pixac, or null on error
+ *
+ *  Notes:
+ *      (1) This is the lazy version of pixacompCreateFromFiles().
+ *          No file is read until its pixcomp is needed.
+ *          See pixacompCreateFromSALazy().
+ */
+PIXAC *
+pixacompCreateFromFilesLazy(const char  *dirname,
+                            const char  *substr,
+                            l_int32      comptype)
+{
+PIXAC    *pixac;
+SARRAY   *sa;
+
+    PROCNAME("pixacompCreateFromFilesLazy");
+
+    if (!dirname)
+        return (PIXAC *)ERROR_PTR("dirname not defined", procName, NULL);
+    if (comptype != IFF_DEFAULT && comptype != IFF_TIFF_G4 &&
+        comptype != IFF_PNG && comptype != IFF_JFIF_JPEG)
+        return (PIXAC *)ERROR_PTR("invalid comptype", procName, NULL);
+
+    if ((sa = getSortedPathnamesInDirectory(dirname, substr, 0, 0)) == NULL)
+        return (PIXAC *)ERROR_PTR("sa not made", procName, NULL);
+    pixac = pixacompCreateFromSALazy(sa, comptype);
+    sarrayDestroy(&sa);
+    return pixac;
+}
+
+
+/*!
+ *  pixacompCreateFromSALazy()
+ *
+ *      Input:  sarray (full pathnames for all files)
+ *              comptype (IFF_DEFAULT, IFF_TIFF_G4, IFF_PNG, IFF_JFIF_JPEG)
+ *      Return: pixac, or null on error
+ *
+ *  Notes:
+ *      (1) This makes a pixacomp with one entry for each file name,
+ *          but reads no files.  The file for an entry is read, with
+ *          pixcompCreateFromFile(), the first time the entry is
+ *          needed; it is then kept like any other pixcomp.
+ *      (2) Unlike pixacompCreateFromSA(), a file that cannot be read
+ *          is not skipped, because that is not known in advance.
+ *          Instead, access to that entry fails.
+ *      (3) Entries that have been replaced are never read from file.
+ */
+PIXAC *
+pixacompCreateFromSALazy(SARRAY  *sa,
+                         l_int32  comptype)
+{
+l_int32  n;
+PIXAC   *pixac;
+
+    PROCNAME("pixacompCreateFromSALazy");
+
+    if (!sa)
+        return (PIXAC *)ERROR_PTR("sarray not defined", procName, NULL);
+    if (comptype != IFF_DEFAULT && comptype != IFF_TIFF_G4 &&
+        comptype != IFF_PNG && comptype != IFF_JFIF_JPEG)
+        return (PIXAC *)ERROR_PTR("invalid comptype", procName, NULL);
+
+    n = sarrayGetCount(sa);
+    if ((pixac = pixacompCreate(n)) == NULL)
+        return (PIXAC *)ERROR_PTR("pixac not made", procName, NULL);
+    pixac->safiles = sarrayCopy(sa);
+    pixac->comptype = comptype;
+    pixac->n = n;
+    return pixac;
+}
+
+
 /*!
  *  pixacompDestroy()
  *
@@ -759,10 +902,13 @@ PIXAC   *pixac;
     if ((pixac = *ppixac) == NULL)
         return;
 
+    pixacompStopPrefetch(pixac);
+    pixacCacheDestroy(&pixac->cache);
     for (i = 0; i < pixac->n; i++)
         pixcompDestroy(&pixac->pixc[i]);
     FREE(pixac->pixc);
     boxaDestroy(&pixac->boxa);
+    sarrayDestroy(&pixac->safiles);
     FREE(pixac);
 
     *ppixac = NULL;
@@ -834,8 +980,10 @@ l_int32  n;
         return ERROR_INT("pixc not defined", procName, 1);
 
     n = pixac->n;
-    if (n >= pixac->nalloc)
+    if (n >= pixac->nalloc) {
+        pixacompStopPrefetch(pixac);  /* the ptr array is reallocated */
         pixacompExtendArray(pixac);
+    }
     pixac->pixc[n] = pixc;
     pixac->n++;
 
@@ -854,6 +1002,8 @@ l_int32  n;
  *          necessary in case we are NOT adding boxes simultaneously
  *          with adding pixc.  We always want the sizes of the
  *          pixac and boxa ptr arrays to be equal.
+ *      (2) The cache, if any, is indexed the same way, and is
+ *          extended as well.
  */
 static l_int32
 pixacompExtendArray(PIXAC  *pixac)
@@ -869,6 +1019,8 @@ pixacompExtendArray(PIXAC  *pixac)
         return ERROR_INT("new ptr array not returned", procName, 1);
     pixac->nalloc = 2 * pixac->nalloc;
     boxaExtendArray(pixac->boxa);
+    if (pixac->cache)
+        return pixacCacheExtend(pixac->cache, pixac->nalloc);
     return 0;
 }
 
@@ -937,7 +1089,6 @@ pixacompReplacePixcomp(PIXAC   *pixac,
                        PIXC    *pixc)
 {
 l_int32  n, aindex;
-PIXC    *pixct;
 
     PROCNAME("pixacompReplacePixcomp");
 
@@ -950,9 +1101,11 @@ PIXC    *pixct;
     if (!pixc)
         return ERROR_INT("pixc not defined", procName, 1);
 
-    pixct = pixacompGetPixcomp(pixac, index);  /* use @index */
-    pixcompDestroy(&pixct);
-    pixac->pixc[aindex] = pixc;  /* replace; use array index */
+    pixacompStopPrefetch(pixac);
+    if (pixac->cache)
+        pixacCacheRemove(pixac->cache, aindex);
+    pixcompDestroy(&pixac->pixc[aindex]);  /* use array index */
+    pixac->pixc[aindex] = pixc;
 
     return 0;
 }
@@ -1018,6 +1171,8 @@ pixacompGetCount(PIXAC  *pixac)
  *          to get the actual index into the ptr array.
  *      (2) Important: this is just a ptr to the pixc owned by the pixac.
  *          Do not destroy unless you are replacing the pixc.
+ *      (3) For a lazy pixacomp, this reads the pixc from file if
+ *          that has not yet been done.
  */
 PIXC *
 pixacompGetPixcomp(PIXAC   *pixac,
@@ -1033,7 +1188,8 @@ l_int32  aindex;
     if (aindex < 0 || aindex >= pixac->n)
         return (PIXC *)ERROR_PTR("array index not valid", procName, NULL);
 
-    return pixac->pixc[aindex];
+    pixacompWaitPrefetch(pixac, aindex);
+    return pixacompLoadPixcomp(pixac, aindex);
 }
 
 
@@ -1047,12 +1203,16 @@ l_int32  aindex;
  *  Notes:
  *      (1) The @index includes the offset, which must be subtracted
  *          to get the actual index into the ptr array.
+ *      (2) The returned pix belongs to the caller in all cases.
+ *          If there is a cache (see pixacompSetCache()), it is a copy
+ *          of the cached pix, and the next ones are read ahead.
  */
 PIX *
 pixacompGetPix(PIXAC   *pixac,
                l_int32  index)
 {
 l_int32  aindex;
+PIX     *pix, *pixt;
 PIXC    *pixc;
 
     PROCNAME("pixacompGetPix");
@@ -1063,8 +1223,27 @@ PIXC    *pixc;
     if (aindex < 0 || aindex >= pixac->n)
         return (PIX *)ERROR_PTR("array index not valid", procName, NULL);
 
-    pixc = pixacompGetPixcomp(pixac, index);
-    return pixCreateFromPixcomp(pixc);
+    if (!pixac->cache) {
+        if ((pixc = pixacompLoadPixcomp(pixac, aindex)) == NULL)
+            return (PIX *)ERROR_PTR("pixc not found", procName, NULL);
+        return pixCreateFromPixcomp(pixc);
+    }
+
+        /* If it is not cached, it may be on the way */
+    if ((pix = pixacCacheFetch(pixac->cache, aindex)) == NULL) {
+        pixacompWaitPrefetch(pixac, aindex);
+        pix = pixacCacheFetch(pixac->cache, aindex);
+    }
+    if (!pix) {
+        if ((pixc = pixacompLoadPixcomp(pixac, aindex)) == NULL)
+            return (PIX *)ERROR_PTR("pixc not found", procName, NULL);
+        if ((pixt = pixCreateFromPixcomp(pixc)) == NULL)
+            return (PIX *)ERROR_PTR("pix not made", procName, NULL);
+        pix = pixCopy(NULL, pixt);
+        pixacCacheInsert(pixac->cache, aindex, pixt);
+    }
+    pixacompStartPrefetch(pixac, aindex + 1);
+    return pix;
 }
 
 
@@ -1098,7 +1277,8 @@ PIXC    *pixc;
     if (aindex < 0 || aindex >= pixac->n)
         return ERROR_INT("array index not valid", procName, 1);
 
-    if ((pixc = pixac->pixc[aindex]) == NULL)
+    pixacompWaitPrefetch(pixac, aindex);
+    if ((pixc = pixacompLoadPixcomp(pixac, aindex)) == NULL)
         return ERROR_INT("pixc not found!", procName, 1);
     pixcompGetDimensions(pixc, pw, ph, pd);
     return 0;
@@ -1286,6 +1466,514 @@ pixacompSetOffset(PIXAC   *pixac,
 }
 
 
+/*!
+ *  pixacompLoadPixcomp()
+ *
+ *      Input:  pixac
+ *              aindex (index into the ptr array)
+ *      Return: pixc, or null on error
+ *
+ *  Notes:
+ *      (1) Returns the pixc at @aindex, first reading it from file
+ *          if the pixacomp is lazy and that has not yet been done.
+ *      (2) This is also called by the read-ahead thread, for indices
+ *          that the calling thread does not touch until the read-ahead
+ *          thread is joined.
+ */
+static PIXC *
+pixacompLoadPixcomp(PIXAC   *pixac,
+                    l_int32  aindex)
+{
+char  *fname;
+PIXC  *pixc;
+
+    PROCNAME("pixacompLoadPixcomp");
+
+    if ((pixc = pixac->pixc[aindex]) != NULL)
+        return pixc;
+    if (!pixac->safiles || aindex >= sarrayGetCount(pixac->safiles))
+        return (PIXC *)ERROR_PTR("pixc not found", procName, NULL);
+
+    fname = sarrayGetString(pixac->safiles, aindex, L_NOCOPY);
+    if ((pixc = pixcompCreateFromFile(fname, pixac->comptype)) == NULL) {
+        L_ERROR("pixc not read from file: %s\n", procName, fname);
+        return NULL;
+    }
+    pixac->pixc[aindex] = pixc;
+    return pixc;
+}
+
+
+/*---------------------------------------------------------------------*
+ *                 Pixacomp cache of decompressed pix                  *
+ *---------------------------------------------------------------------*/
+/*!
+ *  pixacompSetCache()
+ *
+ *      Input:  pixac
+ *              maxbytes (memory budget for cached raster data;
+ *                        0 to remove the cache)
+ *              nprefetch (number of following images to read ahead
+ *                         on a background thread; 0 for none)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) With a cache, pixacompGetPix() keeps each pix that it
+ *          decompresses, and returns a copy.  When the raster data
+ *          held would exceed @maxbytes, the least recently used pix
+ *          are dropped.  A pix that by itself exceeds @maxbytes is
+ *          never cached.
+ *      (2) After each call to pixacompGetPix() for index i, the
+ *          images at i + 1 ... i + @nprefetch that are not already
+ *          cached are read (for a lazy pixacomp) and decompressed on
+ *          a background thread.  If a later request is for an image
+ *          that is still being worked on, it waits for that image.
+ *          Choose @maxbytes to hold at least @nprefetch + 1 images,
+ *          or the images read ahead will push out each other.
+ *      (3) Read-ahead needs thread support; without it, @nprefetch
+ *          is ignored.
+ *      (4) Any existing cache is dropped first.
+ */
+l_int32
+pixacompSetCache(PIXAC   *pixac,
+                 size_t   maxbytes,
+                 l_int32  nprefetch)
+{
+    PROCNAME("pixacompSetCache");
+
+    if (!pixac)
+        return ERROR_INT("pixac not defined", procName, 1);
+    if (nprefetch < 0)
+        return ERROR_INT("nprefetch < 0", procName, 1);
+
+    pixacompStopPrefetch(pixac);
+    pixacCacheDestroy(&pixac->cache);
+    if (maxbytes == 0)
+        return 0;
+    if ((pixac->cache = pixacCacheCreate(pixac->nalloc, maxbytes,
+                                         nprefetch)) == NULL)
+        return ERROR_INT("cache not made", procName, 1);
+    return 0;
+}
+
+
+/*!
+ *  pixacompGetCacheInfo()
+ *
+ *      Input:  pixac
+ *              &npix (<optional return> number of pix in the cache)
+ *              &nbytes (<optional return> bytes of raster data held)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Both are returned as 0 if there is no cache.  While the
+ *          read-ahead thread is running, they are only a snapshot.
+ */
+l_int32
+pixacompGetCacheInfo(PIXAC    *pixac,
+                     l_int32  *pnpix,
+                     size_t   *pnbytes)
+{
+PIXAC_CACHE  *cache;
+
+    PROCNAME("pixacompGetCacheInfo");
+
+    if (pnpix) *pnpix = 0;
+    if (pnbytes) *pnbytes = 0;
+    if (!pixac)
+        return ERROR_INT("pixac not defined", procName, 1);
+
+    if ((cache = pixac->cache) == NULL)
+        return 0;
+    l_mutexLock(cache->lock);
+    if (pnpix) *pnpix = cache->npix;
+    if (pnbytes) *pnbytes = cache->nbytes;
+    l_mutexUnlock(cache->lock);
+    return 0;
+}
+
+
+/*!
+ *  pixacCacheCreate()
+ *
+ *      Input:  nalloc (size of the pixacomp ptr array)
+ *              maxbytes (memory budget)
+ *              nprefetch (number of images to read ahead)
+ *      Return: cache, or null on error
+ */
+static PIXAC_CACHE *
+pixacCacheCreate(l_int32  nalloc,
+                 size_t   maxbytes,
+                 l_int32  nprefetch)
+{
+PIXAC_CACHE  *cache;
+
+    PROCNAME("pixacCacheCreate");
+
+    if ((cache = (PIXAC_CACHE *)CALLOC(1, sizeof(PIXAC_CACHE))) == NULL)
+        return (PIXAC_CACHE *)ERROR_PTR("cache not made", procName, NULL);
+    cache->nalloc = nalloc;
+    cache->pix = (PIX **)CALLOC(nalloc, sizeof(PIX *));
+    cache->newer = (l_int32 *)CALLOC(nalloc, sizeof(l_int32));
+    cache->older = (l_int32 *)CALLOC(nalloc, sizeof(l_int32));
+    cache->lock = l_mutexCreate();
+    if (!cache->pix || !cache->newer || !cache->older || !cache->lock) {
+        pixacCacheDestroy(&cache);
+        return (PIXAC_CACHE *)ERROR_PTR("cache arrays not made",
+                                        procName, NULL);
+    }
+    cache->newest = cache->oldest = -1;
+    cache->maxbytes = maxbytes;
+    cache->nprefetch = nprefetch;
+    return cache;
+}
+
+
+/*!
+ *  pixacCacheDestroy()
+ *
+ *      Input:  &cache (<will be set to null before returning>)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The read-ahead thread must have been joined.
+ */
+static void
+pixacCacheDestroy(PIXAC_CACHE  **pcache)
+{
+l_int32       i;
+PIXAC_CACHE  *cache;
+
+    if ((cache = *pcache) == NULL)
+        return;
+
+    if (cache->pix) {
+        for (i = 0; i < cache->nalloc; i++)
+            pixDestroy(&cache->pix[i]);
+        FREE(cache->pix);
+    }
+    if (cache->newer) FREE(cache->newer);
+    if (cache->older) FREE(cache->older);
+    l_mutexDestroy(&cache->lock);
+    FREE(cache);
+    *pcache = NULL;
+    return;
+}
+
+
+/*!
+ *  pixacCacheExtend()
+ *
+ *      Input:  cache
+ *              nalloc (new size of the pixacomp ptr array)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The read-ahead thread must have been joined.
+ */
+static l_int32
+pixacCacheExtend(PIXAC_CACHE  *cache,
+                 l_int32       nalloc)
+{
+    PROCNAME("pixacCacheExtend");
+
+    if ((cache->pix = (PIX **)reallocNew((void **)&cache->pix,
+                            sizeof(PIX *) * cache->nalloc,
+                            sizeof(PIX *) * nalloc)) == NULL ||
+        (cache->newer = (l_int32 *)reallocNew((void **)&cache->newer,
+                            sizeof(l_int32) * cache->nalloc,
+                            sizeof(l_int32) * nalloc)) == NULL ||
+        (cache->older = (l_int32 *)reallocNew((void **)&cache->older,
+                            sizeof(l_int32) * cache->nalloc,
+                            sizeof(l_int32) * nalloc)) == NULL)
+        return ERROR_INT("cache arrays not extended", procName, 1);
+    cache->nalloc = nalloc;
+    return 0;
+}
+
+
+/*!
+ *  pixacCacheFetch()
+ *
+ *      Input:  cache
+ *              aindex (index into the ptr array)
+ *      Return: copy of the cached pix, or null if it is not cached
+ *
+ *  Notes:
+ *      (1) A pix that is found becomes the most recently used.
+ */
+static PIX *
+pixacCacheFetch(PIXAC_CACHE  *cache,
+                l_int32       aindex)
+{
+l_int32  newer, older;
+PIX     *pix;
+
+    pix = NULL;
+    l_mutexLock(cache->lock);
+    if (cache->pix[aindex]) {
+        if (cache->newest != aindex) {  /* unlink, and put at the front */
+            newer = cache->newer[aindex];
+            older = cache->older[aindex];
+            cache->older[newer] = older;
+            if (older >= 0)
+                cache->newer[older] = newer;
+            else
+                cache->oldest = newer;
+            cache->newer[aindex] = -1;
+            cache->older[aindex] = cache->newest;
+            cache->newer[cache->newest] = aindex;
+            cache->newest = aindex;
+        }
+        pix = pixCopy(NULL, cache->pix[aindex]);
+    }
+    l_mutexUnlock(cache->lock);
+    return pix;
+}
+
+
+/*!
+ *  pixacCacheInsert()
+ *
+ *      Input:  cache
+ *              aindex (index into the ptr array)
+ *              pix (decompressed; ownership is taken)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The pix becomes the most recently used, and the least
+ *          recently used pix are dropped to stay within the budget.
+ *      (2) If a pix is already cached at @aindex, it is kept and
+ *          the input pix is destroyed.
+ */
+static void
+pixacCacheInsert(PIXAC_CACHE  *cache,
+                 l_int32       aindex,
+                 PIX          *pix)
+{
+size_t  size;
+
+    size = 4 * (size_t)pixGetWpl(pix) * pixGetHeight(pix);
+    if (size > cache->maxbytes) {
+        pixDestroy(&pix);
+        return;
+    }
+
+    l_mutexLock(cache->lock);
+    if (cache->pix[aindex]) {
+        l_mutexUnlock(cache->lock);
+        pixDestroy(&pix);
+        return;
+    }
+    while (cache->nbytes + size > cache->maxbytes)
+        pixacCacheRemove(cache, cache->oldest);
+    cache->pix[aindex] = pix;
+    cache->newer[aindex] = -1;
+    cache->older[aindex] = cache->newest;
+    if (cache->newest >= 0)
+        cache->newer[cache->newest] = aindex;
+    else
+        cache->oldest = aindex;
+    cache->newest = aindex;
+    cache->npix++;
+    cache->nbytes += size;
+    l_mutexUnlock(cache->lock);
+    return;
+}
+
+
+/*!
+ *  pixacCacheRemove()
+ *
+ *      Input:  cache
+ *              aindex (index into the ptr array)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Drops the pix at @aindex, if there is one.  This does not
+ *          lock; the caller either holds the lock or has joined the
+ *          read-ahead thread.
+ */
+static void
+pixacCacheRemove(PIXAC_CACHE  *cache,
+                 l_int32       aindex)
+{
+l_int32  newer, older;
+PIX     *pix;
+
+    if ((pix = cache->pix[aindex]) == NULL)
+        return;
+
+    newer = cache->newer[aindex];
+    older = cache->older[aindex];
+    if (newer >= 0)
+        cache->older[newer] = older;
+    else
+        cache->newest = older;
+    if (older >= 0)
+        cache->newer[older] = newer;
+    else
+        cache->oldest = newer;
+    cache->npix--;
+    cache->nbytes -= 4 * (size_t)pixGetWpl(pix) * pixGetHeight(pix);
+    pixDestroy(&cache->pix[aindex]);
+    return;
+}
+
+
+/*!
+ *  pixacompStartPrefetch()
+ *
+ *      Input:  pixac
+ *              aindex (first index into the ptr array to read ahead)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Starts the read-ahead thread on the images at
+ *          @aindex ... @aindex + nprefetch - 1 that are not cached.
+ *      (2) Nothing is done while an earlier read-ahead is still busy,
+ *          or if the thread cannot be started.
+ */
+static void
+pixacompStartPrefetch(PIXAC   *pixac,
+                      l_int32  aindex)
+{
+l_int32       i, start, end, busy, missing;
+PIXAC_CACHE  *cache;
+
+    if ((cache = pixac->cache) == NULL || cache->nprefetch == 0)
+        return;
+    start = aindex;
+    end = L_MIN(pixac->n, aindex + cache->nprefetch);
+    if (start >= end)
+        return;
+
+    l_mutexLock(cache->lock);
+    busy = (cache->thread && !cache->pfdone);
+    for (i = start, missing = 0; i < end && !missing; i++)
+        missing = (cache->pix[i] == NULL);
+    l_mutexUnlock(cache->lock);
+    if (busy || !missing)
+        return;
+
+    l_threadJoin(&cache->thread);  /* finished; just clean up */
+    cache->pfstart = start;
+    cache->pfend = end;
+    cache->pfdone = FALSE;
+    cache->thread = l_threadCreate(pixacompPrefetchJob, pixac, 0);
+    return;
+}
+
+
+/*!
+ *  pixacompWaitPrefetch()
+ *
+ *      Input:  pixac
+ *              aindex (index into the ptr array that is needed)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) If @aindex is in the range being read ahead, this shortens
+ *          the range to end at @aindex and waits for the thread to
+ *          finish.  Then the pixc at @aindex can be used, and the pix
+ *          is cached unless it could not be made.
+ */
+static void
+pixacompWaitPrefetch(PIXAC   *pixac,
+                     l_int32  aindex)
+{
+l_int32       inrange;
+PIXAC_CACHE  *cache;
+
+    if ((cache = pixac->cache) == NULL || !cache->thread)
+        return;
+
+    l_mutexLock(cache->lock);
+    inrange = (aindex >= cache->pfstart && aindex < cache->pfend);
+    if (inrange)
+        cache->pfend = aindex + 1;
+    l_mutexUnlock(cache->lock);
+    if (inrange)
+        l_threadJoin(&cache->thread);
+    return;
+}
+
+
+/*!
+ *  pixacompStopPrefetch()
+ *
+ *      Input:  pixac
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Asks the read-ahead thread to stop after the image it is
+ *          working on, and waits for it.  This must be done before
+ *          anything is changed that the thread might be using.
+ */
+static void
+pixacompStopPrefetch(PIXAC  *pixac)
+{
+PIXAC_CACHE  *cache;
+
+    if ((cache = pixac->cache) == NULL || !cache->thread)
+        return;
+
+    l_mutexLock(cache->lock);
+    cache->pfend = 0;
+    l_mutexUnlock(cache->lock);
+    l_threadJoin(&cache->thread);
+    return;
+}
+
+
+/*!
+ *  pixacompPrefetchJob()
+ *
+ *      Input:  data (the pixac)
+ *              index (unused)
+ *      Return: 0
+ *
+ *  Notes:
+ *      (1) This runs on the read-ahead thread.  It goes through the
+ *          range in order, so that the image needed first is ready
+ *          first, and checks the end of the range before each image,
+ *          because the calling thread can shorten it.
+ *      (2) Images that cannot be read are left for pixacompGetPix()
+ *          to report.
+ */
+static l_int32
+pixacompPrefetchJob(void    *data,
+                    l_int32  index)
+{
+l_int32       i, cached;
+PIX          *pix;
+PIXC         *pixc;
+PIXAC        *pixac;
+PIXAC_CACHE  *cache;
+
+    pixac = (PIXAC *)data;
+    cache = pixac->cache;
+    for (i = cache->pfstart; ; i++) {
+        l_mutexLock(cache->lock);
+        if (i >= cache->pfend) {
+            cache->pfdone = TRUE;
+            l_mutexUnlock(cache->lock);
+            break;
+        }
+        cached = (cache->pix[i] != NULL);
+        l_mutexUnlock(cache->lock);
+        if (cached)
+            continue;
+
+        if ((pixc = pixacompLoadPixcomp(pixac, i)) == NULL)
+            continue;
+        if ((pix = pixCreateFromPixcomp(pixc)) != NULL)
+            pixacCacheInsert(cache, i, pix);
+    }
+    return 0;
+}
+
+
 /*---------------------------------------------------------------------*
  *                      Pixacomp conversion to Pixa                    *
  *---------------------------------------------------------------------*/
@@ -1549,6 +2237,9 @@ PIXC    *pixc;
  *          all images to be compressed with that type.  Use 0 to have
  *          the type determined for each image based on depth and whether
  *          or not it has a colormap.
+ *      (5) Pages are encoded on parallel threads and written in batches,
+ *          as in convertFilesToPdf().
+ *          The cache of the pixacomp, if any, is not used.
  */
 l_int32
 pixacompConvertToPdf(PIXAC       *pixac,
@@ -1559,26 +2250,29 @@ pixacompConvertToPdf(PIXAC       *pixac,
                      const char  *title,
                      const char  *fileout)
 {
-l_uint8  *data;
-l_int32   ret;
-size_t    nbytes;
+l_int32        ret;
+FILE          *fp;
+L_PDF_WRITER  *lpw;
 
     PROCNAME("pixacompConvertToPdf");
 
     if (!pixac)
         return ERROR_INT("pixac not defined", procName, 1);
+    if (!fileout)
+        return ERROR_INT("fileout not defined", procName, 1);
 
-    ret = pixacompConvertToPdfData(pixac, res, scalefactor, type, quality,
-                                   title, &data, &nbytes);
-    if (ret) {
-        FREE(data);
-        return ERROR_INT("conversion to pdf failed", procName, 1);
+    if ((fp = fopenWriteStream(fileout, "wb")) == NULL)
+        return ERROR_INT("stream not opened", procName, 1);
+    if ((lpw = l_pdfWriterCreate(fp, NULL, NULL, title)) == NULL) {
+        fclose(fp);
+        return ERROR_INT("lpw not made", procName, 1);
     }
-
-    ret = l_binaryWrite(fileout, "w", data, nbytes);
-    FREE(data);
+    ret = l_pdfWriterAddPages(lpw, NULL, NULL, pixac, res, scalefactor, type,
+                              quality);
+    ret |= l_pdfWriterClose(&lpw);
+    fclose(fp);
     if (ret)
-        L_ERROR("pdf data not written to file\n", procName);
+        L_ERROR("pdf not written to file\n", procName);
     return ret;
 }
 
@@ -1610,12 +2304,9 @@ pixacompConvertToPdfData(PIXAC       *pixac,
                          l_uint8    **pdata,
                          size_t      *pnbytes)
 {
-l_uint8  *imdata;
-l_int32   i, n, ret, scaledres, pagetype;
-size_t    imbytes;
-L_BYTEA  *ba;
-PIX      *pixs, *pix;
-L_PTRA   *pa_data;
+l_int32        ret;
+L_BYTEA       *ba;
+L_PDF_WRITER  *lpw;
 
     PROCNAME("pixacompConvertToPdfData");
 
@@ -1627,68 +2318,19 @@ L_PTRA   *pa_data;
     *pnbytes = 0;
     if (!pixac)
         return ERROR_INT("pixac not defined", procName, 1);
-    if (scalefactor <= 0.0) scalefactor = 1.0;
-    if (type < 0 || type > L_FLATE_ENCODE) {
-        L_WARNING("invalid compression type; using per-page default\n",
-                  procName);
-        type = 0;
-    }
 
-        /* Generate all the encoded pdf strings */
-    n = pixacompGetCount(pixac);
-    pa_data = ptraCreate(n);
-    for (i = 0; i < n; i++) {
-        if ((pixs =
-             pixacompGetPix(pixac, pixacompGetOffset(pixac) + i)) == NULL) {
-            L_ERROR("pix[%d] not retrieved\n", procName, i);
-            continue;
-        }
-        if (pixGetWidth(pixs) == 1) {  /* used sometimes as placeholders */
-            L_INFO("placeholder image[%d] has w = 1\n", procName, i);
-            pixDestroy(&pixs);
-            continue;
-        }
-        if (scalefactor != 1.0)
-            pix = pixScale(pixs, scalefactor, scalefactor);
-        else
-            pix = pixClone(pixs);
-        pixDestroy(&pixs);
-        scaledres = (l_int32)(res * scalefactor);
-        if (type != 0) {
-            pagetype = type;
-        } else if (selectDefaultPdfEncoding(pix, &pagetype) != 0) {
-            L_ERROR("encoding type selection failed for pix[%d]\n",
-                    procName, i);
-            pixDestroy(&pix);
-            continue;
-        }
-        ret = pixConvertToPdfData(pix, pagetype, quality, &imdata, &imbytes,
-                                  0, 0, scaledres, title, NULL, 0);
-        pixDestroy(&pix);
-        if (ret) {
-            L_ERROR("pdf encoding failed for pix[%d]\n", procName, i);
-            continue;
-        }
-        ba = l_byteaInitFromMem(imdata, imbytes);
-        if (imdata) FREE(imdata);
-        ptraAdd(pa_data, ba);
-    }
-    ptraGetActualCount(pa_data, &n);
-    if (n == 0) {
-        L_ERROR("no pdf files made\n", procName);
-        ptraDestroy(&pa_data, FALSE, FALSE);
-        return 1;
-    }
-
-        /* Concatenate them */
-    ret = ptraConcatenatePdfToData(pa_data, NULL, pdata, pnbytes);
-
-    ptraGetActualCount(pa_data, &n);  /* recalculate in case it changes */
-    for (i = 0; i < n; i++) {
-        ba = (L_BYTEA *)ptraRemove(pa_data, i, L_NO_COMPACTION);
+    ba = l_byteaCreate(0);
+    if ((lpw = l_pdfWriterCreate(NULL, l_pdfWriteToBytea, ba,
+                                 title)) == NULL) {
         l_byteaDestroy(&ba);
+        return ERROR_INT("lpw not made", procName, 1);
     }
-    ptraDestroy(&pa_data, FALSE, FALSE);
+    ret = l_pdfWriterAddPages(lpw, NULL, NULL, pixac, res, scalefactor, type,
+                              quality);
+    ret |= l_pdfWriterClose(&lpw);
+    if (ret == 0)
+        *pdata = l_byteaCopyData(ba, pnbytes);
+    l_byteaDestroy(&ba);
     return ret;
 }
 
@@ -47,6 +47,8 @@
  *           PIX        *pixConvertRGBToGrayFast()
  *           PIX        *pixConvertRGBToGrayMinMax()
  *           PIX        *pixConvertRGBToGraySatBoost()
+ *           static l_int32  rgbToGrayLineSSE2()
+ *           static l_int32  rgbToGrayLineAVX2()
  *
  *      Conversion from grayscale to colormap
  *           PIX        *pixConvertGrayToColormap()  -- 2, 4, 8 bpp
@@ -135,6 +137,16 @@
 #include <string.h>
 #include <math.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
+
+#if USE_SIMD
+static l_int32 rgbToGrayLineSSE2(l_uint32 *lined, l_uint32 *lines, l_int32 w,
+                                 l_float32 rwt, l_float32 gwt, l_float32 bwt);
+static l_int32 rgbToGrayLineAVX2(l_uint32 *lined, l_uint32 *lines, l_int32 w,
+                                 l_float32 rwt, l_float32 gwt, l_float32 bwt);
+#endif  /* USE_SIMD */
 
 #ifndef  NO_CONSOLE_IO
 #define DEBUG_CONVERT_TO_COLORMAP  0
@@ -707,7 +719,7 @@ pixConvertRGBToGray(PIX       *pixs,
                     l_float32  gwt,
                     l_float32  bwt)
 {
-l_int32    i, j, w, h, wpls, wpld, val;
+l_int32    i, j, w, h, wpls, wpld, val, level;
 l_uint32   word;
 l_uint32  *datas, *lines, *datad, *lined;
 l_float32  sum;
@@ -746,10 +758,18 @@ PIX       *pixd;
     datad = pixGetData(pixd);
     wpld = pixGetWpl(pixd);
 
+    level = l_getSimdLevel();
     for (i = 0; i < h; i++) {
         lines = datas + i * wpls;
         lined = datad + i * wpld;
-        for (j = 0; j < w; j++) {
+        j = 0;
+#if USE_SIMD
+        if (level == L_SIMD_AVX2)
+            j = rgbToGrayLineAVX2(lined, lines, w, rwt, gwt, bwt);
+        else if (level == L_SIMD_SSE2)
+            j = rgbToGrayLineSSE2(lined, lines, w, rwt, gwt, bwt);
+#endif  /* USE_SIMD */
+        for (; j < w; j++) {
             word = *(lines + j);
             val = (l_int32)(rwt * ((word >> L_RED_SHIFT) & 0xff) +
                             gwt * ((word >> L_GREEN_SHIFT) & 0xff) +
@@ -762,6 +782,124 @@ PIX       *pixd;
 }
 
 
+#if USE_SIMD
+/*!
+ *  rgbToGrayLineSSE2()
+ *
+ *      Input:  lined (8 bpp dest line)
+ *              lines (32 bpp src line)
+ *              w (number of pixels)
+ *              rwt, gwt, bwt (weights)
+ *      Return: number of pixels done (a multiple of 8)
+ *
+ *  Notes:
+ *      (1) The weighted sum is made in single precision, with the
+ *          products added in the same order as in the scalar code.
+ *          The scalar code rounds by adding 0.5 in double precision,
+ *          which is exact for these values.  Here the same result is
+ *          found by truncating and then incrementing if the fractional
+ *          part, which is computed exactly, is at least 0.5.
+ *      (2) The gray bytes are written 4 to a word, with the first pixel
+ *          in the MSB, as in SET_DATA_BYTE() on a little-endian machine.
+ */
+static l_int32  L_TARGET_SSE2
+rgbToGrayLineSSE2(l_uint32  *lined,
+                  l_uint32  *lines,
+                  l_int32    w,
+                  l_float32  rwt,
+                  l_float32  gwt,
+                  l_float32  bwt)
+{
+l_int32  j, k;
+__m128   rw, gw, bw, half, sum, frac;
+__m128i  mask, pix, val, vals[2];
+
+    rw = _mm_set1_ps(rwt);
+    gw = _mm_set1_ps(gwt);
+    bw = _mm_set1_ps(bwt);
+    half = _mm_set1_ps(0.5);
+    mask = _mm_set1_epi32(0xff);
+    for (j = 0; j + 8 <= w; j += 8) {
+        for (k = 0; k < 2; k++) {
+            pix = _mm_loadu_si128((const __m128i *)(lines + j + 4 * k));
+            sum = _mm_add_ps(
+                _mm_add_ps(
+                    _mm_mul_ps(rw, _mm_cvtepi32_ps(
+                        _mm_and_si128(_mm_srli_epi32(pix, L_RED_SHIFT), mask))),
+                    _mm_mul_ps(gw, _mm_cvtepi32_ps(
+                        _mm_and_si128(_mm_srli_epi32(pix, L_GREEN_SHIFT),
+                                      mask)))),
+                _mm_mul_ps(bw, _mm_cvtepi32_ps(
+                    _mm_and_si128(_mm_srli_epi32(pix, L_BLUE_SHIFT), mask))));
+            val = _mm_cvttps_epi32(sum);
+            frac = _mm_sub_ps(sum, _mm_cvtepi32_ps(val));
+            val = _mm_sub_epi32(val, _mm_castps_si128(_mm_cmpge_ps(frac, half)));
+            vals[k] = _mm_and_si128(val, mask);
+        }
+        val = _mm_packs_epi32(vals[0], vals[1]);
+        val = _mm_shufflelo_epi16(val, 0x1b);  /* reverse each 4 */
+        val = _mm_shufflehi_epi16(val, 0x1b);
+        _mm_storel_epi64((__m128i *)(lined + j / 4), _mm_packus_epi16(val, val));
+    }
+    return j;
+}
+
+
+/*!
+ *  rgbToGrayLineAVX2()
+ *
+ *      Input:  lined, lines, w, rwt, gwt, bwt (as in rgbToGrayLineSSE2())
+ *      Return: number of pixels done (a multiple of 8)
+ */
+static l_int32  L_TARGET_AVX2
+rgbToGrayLineAVX2(l_uint32  *lined,
+                  l_uint32  *lines,
+                  l_int32    w,
+                  l_float32  rwt,
+                  l_float32  gwt,
+                  l_float32  bwt)
+{
+l_int32  j;
+__m256   rw, gw, bw, half, sum, frac;
+__m256i  mask, pix, val, order, gather;
+
+    rw = _mm256_set1_ps(rwt);
+    gw = _mm256_set1_ps(gwt);
+    bw = _mm256_set1_ps(bwt);
+    half = _mm256_set1_ps(0.5);
+    mask = _mm256_set1_epi32(0xff);
+        /* In each 128-bit lane, put the low bytes of the 4 values into
+         * the first word, with the first value in the MSB; then bring
+         * the first words of the two lanes together. */
+    order = _mm256_setr_epi8(12, 8, 4, 0, -1, -1, -1, -1,
+                             -1, -1, -1, -1, -1, -1, -1, -1,
+                             12, 8, 4, 0, -1, -1, -1, -1,
+                             -1, -1, -1, -1, -1, -1, -1, -1);
+    gather = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+    for (j = 0; j + 8 <= w; j += 8) {
+        pix = _mm256_loadu_si256((const __m256i *)(lines + j));
+        sum = _mm256_add_ps(
+            _mm256_add_ps(
+                _mm256_mul_ps(rw, _mm256_cvtepi32_ps(_mm256_and_si256(
+                    _mm256_srli_epi32(pix, L_RED_SHIFT), mask))),
+                _mm256_mul_ps(gw, _mm256_cvtepi32_ps(_mm256_and_si256(
+                    _mm256_srli_epi32(pix, L_GREEN_SHIFT), mask)))),
+            _mm256_mul_ps(bw, _mm256_cvtepi32_ps(_mm256_and_si256(
+                _mm256_srli_epi32(pix, L_BLUE_SHIFT), mask))));
+        val = _mm256_cvttps_epi32(sum);
+        frac = _mm256_sub_ps(sum, _mm256_cvtepi32_ps(val));
+        val = _mm256_sub_epi32(val, _mm256_castps_si256(
+                  _mm256_cmp_ps(frac, half, _CMP_GE_OQ)));
+        val = _mm256_shuffle_epi8(val, order);
+        val = _mm256_permutevar8x32_epi32(val, gather);
+        _mm_storel_epi64((__m128i *)(lined + j / 4),
+                         _mm256_castsi256_si128(val));
+    }
+    return j;
+}
+#endif  /* USE_SIMD */
+
+
 /*!
  *  pixConvertRGBToGrayFast()
  *
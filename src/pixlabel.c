@@ -104,10 +104,10 @@ pixConnCompTransform(PIX     *pixs,
                      l_int32  connect,
                      l_int32  depth)
 {
-l_int32  i, n, index, w, h, xb, yb, wb, hb;
-BOXA    *boxa;
-PIX     *pix1, *pix2, *pixd;
-PIXA    *pixa;
+l_int32    i, j, n, w, h, wpll, wpld, label;
+l_uint32  *datal, *datad, *linel, *lined;
+BOXA      *boxa;
+PIX       *pixl, *pixd;
 
     PROCNAME("pixConnCompTransform");
 
@@ -118,8 +118,9 @@ PIXA    *pixa;
     if (depth != 0 && depth != 8 && depth != 16)
         return (PIX *)ERROR_PTR("depth must be 0, 8 or 16", procName, NULL);
 
-    boxa = pixConnComp(pixs, &pixa, connect);
-    n = pixaGetCount(pixa);
+    if ((boxa = pixConnCompLabels(pixs, NULL, &pixl, connect)) == NULL)
+        return (PIX *)ERROR_PTR("labels not made", procName, NULL);
+    n = boxaGetCount(boxa);
     boxaDestroy(&boxa);
     pixGetDimensions(pixs, &w, &h, NULL);
     if (depth == 0) {
@@ -127,27 +128,29 @@ PIXA    *pixa;
     }
     pixd = pixCreate(w, h, depth);
     if (n == 0) {  /* no fg */
-        pixaDestroy(&pixa);
+        pixDestroy(&pixl);
         return pixd;
     }
 
-       /* Label each component and blit it in */
-    for (i = 0; i < n; i++) {
-        pixaGetBoxGeometry(pixa, i, &xb, &yb, &wb, &hb);
-        pix1 = pixaGetPix(pixa, i, L_CLONE);
-        if (depth == 8) {
-            index = 1 + (i % 254);
-            pix2 = pixConvert1To8(NULL, pix1, 0, index);
-        } else {  /* depth == 16 */
-            index = 1 + (i % 0xfffe);
-            pix2 = pixConvert1To16(NULL, pix1, 0, index);
+       /* Reduce each label, which is 1 + the index of the component */
+    datal = pixGetData(pixl);
+    wpll = pixGetWpl(pixl);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < h; i++) {
+        linel = datal + i * wpll;
+        lined = datad + i * wpld;
+        for (j = 0; j < w; j++) {
+            if ((label = linel[j]) == 0)
+                continue;
+            if (depth == 8)
+                SET_DATA_BYTE(lined, j, 1 + ((label - 1) % 254));
+            else  /* depth == 16 */
+                SET_DATA_TWO_BYTES(lined, j, 1 + ((label - 1) % 0xfffe));
         }
-        pixRasterop(pixd, xb, yb, wb, hb, PIX_PAINT, pix2, 0, 0);
-        pixDestroy(&pix1);
-        pixDestroy(&pix2);
     }
 
-    pixaDestroy(&pixa);
+    pixDestroy(&pixl);
     return pixd;
 }
 
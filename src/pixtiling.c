@@ -36,6 +36,9 @@
  *        l_int32          pixTilingNoStripOnPaint()
  *        l_int32          pixTilingPaintTile()
  *
+ *        l_int32          pixTilingExecute()
+ *        static l_int32   pixTilingJob()
+ *
  *
  *   This provides a simple way to split an image into tiles
  *   and to perform operations independently on each tile.
@@ -82,10 +85,40 @@
  *      for pixels that are near the image boundary.
  *    - The tiles are labeled by (i, j) = (row, column),
  *      and in this example there is one row and nx columns.
+ *
+ *   The same loop can be run on a set of worker threads with
+ *   pixTilingExecute().  You supply the per-tile operation as an
+ *   L_TILE_FUNC, which gets each tile from pixTilingGetTile() and
+ *   paints its result(s) back with pixTilingPaintTile():
+ *
+ *     static l_int32 SomeTileFunc(PIXTILING *pt, PIX *pixt,
+ *                                 l_int32 i, l_int32 j, void *data) {
+ *         PIX *pixd = (PIX *)data;
+ *         SomeInPlaceOperation(pixt, 30, 0, ...);
+ *         return pixTilingPaintTile(pixd, i, j, pixt, pt);
+ *     }
+ *     ...
+ *     pixTilingExecute(pt, SomeTileFunc, pixd, nthreads);
+ *
+ *   Painting is serialized with a lock in the pixtiling, so tiles
+ *   that share 32-bit words in the destination (as happens with
+ *   1 bpp output) are painted without races.  The tile operation
+ *   itself must not change any data it shares with other tiles.
  */
 
 #include "allheaders.h"
 
+    /* Shared data for the jobs run by pixTilingExecute() */
+struct TilingJobs
+{
+    PIXTILING    *pt;
+    L_TILE_FUNC   func;
+    void         *data;
+};
+typedef struct TilingJobs  TILING_JOBS;
+
+static l_int32 pixTilingJob(void *data, l_int32 index);
+
 
 /*!
  *  pixTilingCreate()
@@ -160,6 +193,7 @@ PIXTILING  *pt;
     pt->w = w;
     pt->h = h;
     pt->strip = TRUE;
+    pt->lock = l_mutexCreate();
     return pt;
 }
 
@@ -186,6 +220,7 @@ PIXTILING  *pt;
         return;
 
     pixDestroy(&pt->pix);
+    l_mutexDestroy(&pt->lock);
     FREE(pt);
     *ppt = NULL;
     return;
@@ -375,6 +410,10 @@ pixTilingNoStripOnPaint(PIXTILING  *pt)
  *              pixs (source: tile to be painted from)
  *              pt (pixtiling struct)
  *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This can be called concurrently for different tiles; the
+ *          rasterop into pixd is protected by the pixtiling lock.
  */
 l_int32
 pixTilingPaintTile(PIX        *pixd,
@@ -400,12 +439,87 @@ l_int32  w, h;
 
         /* Strip added border pixels off if requested */
     pixGetDimensions(pixs, &w, &h, NULL);
+    l_mutexLock(pt->lock);
     if (pt->strip == TRUE)
         pixRasterop(pixd, j * pt->w, i * pt->h,
                     w - 2 * pt->xoverlap, h - 2 * pt->yoverlap, PIX_SRC,
                     pixs, pt->xoverlap, pt->yoverlap);
     else
         pixRasterop(pixd, j * pt->w, i * pt->h, w, h, PIX_SRC, pixs, 0, 0);
+    l_mutexUnlock(pt->lock);
 
     return 0;
 }
+
+
+/*!
+ *  pixTilingExecute()
+ *
+ *      Input:  pt (pixtiling)
+ *              func (operation to be applied to each tile)
+ *              data (<optional> passed to func, typically holding the
+ *                    destination pix and the operation parameters)
+ *              nthreads (number of threads; 0 for the default given
+ *                        by l_getNumThreads())
+ *      Return: 0 if OK, 1 on error or if the operation failed on any tile
+ *
+ *  Notes:
+ *      (1) For each tile (i, j), this gets the tile with its overlap
+ *          pixels, calls func(pt, tile, i, j, data), and destroys the
+ *          tile.  func is responsible for painting its result(s) into
+ *          the destination with pixTilingPaintTile().
+ *      (2) The tiles are distributed over @nthreads threads, and
+ *          are processed in arbitrary order.  func must not write
+ *          anything that is shared between tiles, except through
+ *          pixTilingPaintTile().
+ *      (3) With @nthreads == 1 this is equivalent to the serial loop
+ *          over tiles shown at the top of this file.
+ */
+l_int32
+pixTilingExecute(PIXTILING   *pt,
+                 L_TILE_FUNC  func,
+                 void        *data,
+                 l_int32      nthreads)
+{
+TILING_JOBS  jobs;
+
+    PROCNAME("pixTilingExecute");
+
+    if (!pt)
+        return ERROR_INT("pt not defined", procName, 1);
+    if (!func)
+        return ERROR_INT("func not defined", procName, 1);
+
+    jobs.pt = pt;
+    jobs.func = func;
+    jobs.data = data;
+    return l_parallelRun(pt->nx * pt->ny, pixTilingJob, &jobs, nthreads);
+}
+
+
+/*!
+ *  pixTilingJob()
+ *
+ *      Input:  data (the shared TILING_JOBS)
+ *              index (tile index, in raster order)
+ *      Return: 0 if OK, 1 on error
+ */
+static l_int32
+pixTilingJob(void    *data,
+             l_int32  index)
+{
+l_int32       i, j, ret;
+PIX          *pixt;
+TILING_JOBS  *jobs;
+
+    PROCNAME("pixTilingJob");
+
+    jobs = (TILING_JOBS *)data;
+    i = index / jobs->pt->nx;
+    j = index % jobs->pt->nx;
+    if ((pixt = pixTilingGetTile(jobs->pt, i, j)) == NULL)
+        return ERROR_INT("tile not made", procName, 1);
+    ret = jobs->func(jobs->pt, pixt, i, j, jobs->data);
+    pixDestroy(&pixt);
+    return ret;
+}
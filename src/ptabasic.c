@@ -115,15 +115,15 @@ PTA  *pta;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((pta = (PTA *)CALLOC(1, sizeof(PTA))) == NULL)
+    if ((pta = (PTA *)l_poolCalloc(1, sizeof(PTA))) == NULL)
         return (PTA *)ERROR_PTR("pta not made", procName, NULL);
     pta->n = 0;
     pta->nalloc = n;
     ptaChangeRefcount(pta, 1);  /* sets to 1 */
 
-    if ((pta->x = (l_float32 *)CALLOC(n, sizeof(l_float32))) == NULL)
+    if ((pta->x = (l_float32 *)l_poolCalloc(n, sizeof(l_float32))) == NULL)
         return (PTA *)ERROR_PTR("x array not made", procName, NULL);
-    if ((pta->y = (l_float32 *)CALLOC(n, sizeof(l_float32))) == NULL)
+    if ((pta->y = (l_float32 *)l_poolCalloc(n, sizeof(l_float32))) == NULL)
         return (PTA *)ERROR_PTR("y array not made", procName, NULL);
 
     return pta;
@@ -193,11 +193,10 @@ PTA  *pta;
     if ((pta = *ppta) == NULL)
         return;
 
-    ptaChangeRefcount(pta, -1);
-    if (ptaGetRefcount(pta) <= 0) {
-        FREE(pta->x);
-        FREE(pta->y);
-        FREE(pta);
+    if (L_REFCOUNT_ADD(&pta->refcount, -1) <= 0) {
+        l_poolFree(pta->x);
+        l_poolFree(pta->y);
+        l_poolFree(pta);
     }
 
     *ppta = NULL;
@@ -362,11 +361,11 @@ ptaExtendArrays(PTA  *pta)
     if (!pta)
         return ERROR_INT("pta not defined", procName, 1);
 
-    if ((pta->x = (l_float32 *)reallocNew((void **)&pta->x,
+    if ((pta->x = (l_float32 *)l_poolReallocNew((void **)&pta->x,
                                sizeof(l_float32) * pta->nalloc,
                                2 * sizeof(l_float32) * pta->nalloc)) == NULL)
         return ERROR_INT("new x array not returned", procName, 1);
-    if ((pta->y = (l_float32 *)reallocNew((void **)&pta->y,
+    if ((pta->y = (l_float32 *)l_poolReallocNew((void **)&pta->y,
                                sizeof(l_float32) * pta->nalloc,
                                2 * sizeof(l_float32) * pta->nalloc)) == NULL)
         return ERROR_INT("new y array not returned", procName, 1);
@@ -474,7 +473,7 @@ ptaChangeRefcount(PTA     *pta,
 
     if (!pta)
         return ERROR_INT("pta not defined", procName, 1);
-    pta->refcount += delta;
+    L_REFCOUNT_ADD(&pta->refcount, delta);
     return 0;
 }
 
@@ -808,12 +807,12 @@ PTAA  *ptaa;
     if (n <= 0)
         n = INITIAL_PTR_ARRAYSIZE;
 
-    if ((ptaa = (PTAA *)CALLOC(1, sizeof(PTAA))) == NULL)
+    if ((ptaa = (PTAA *)l_poolCalloc(1, sizeof(PTAA))) == NULL)
         return (PTAA *)ERROR_PTR("ptaa not made", procName, NULL);
     ptaa->n = 0;
     ptaa->nalloc = n;
 
-    if ((ptaa->pta = (PTA **)CALLOC(n, sizeof(PTA *))) == NULL)
+    if ((ptaa->pta = (PTA **)l_poolCalloc(n, sizeof(PTA *))) == NULL)
         return (PTAA *)ERROR_PTR("pta ptrs not made", procName, NULL);
 
     return ptaa;
@@ -844,9 +843,9 @@ PTAA    *ptaa;
 
     for (i = 0; i < ptaa->n; i++)
         ptaDestroy(&ptaa->pta[i]);
-    FREE(ptaa->pta);
+    l_poolFree(ptaa->pta);
 
-    FREE(ptaa);
+    l_poolFree(ptaa);
     *pptaa = NULL;
     return;
 }
@@ -914,7 +913,7 @@ ptaaExtendArray(PTAA  *ptaa)
     if (!ptaa)
         return ERROR_INT("ptaa not defined", procName, 1);
 
-    if ((ptaa->pta = (PTA **)reallocNew((void **)&ptaa->pta,
+    if ((ptaa->pta = (PTA **)l_poolReallocNew((void **)&ptaa->pta,
                              sizeof(PTA *) * ptaa->nalloc,
                              2 * sizeof(PTA *) * ptaa->nalloc)) == NULL)
         return ERROR_INT("new ptr array not returned", procName, 1);
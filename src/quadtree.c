@@ -83,6 +83,9 @@
  *      (1) The returned fpixa has @nlevels of fpix, each containing
  *          the mean values at its level.  Level 0 has a
  *          single value; level 1 has 4 values; level 2 has 16; etc.
+ *      (2) If @pix_ma is null, the values at all levels are found from
+ *          an integral image with 64 bit sums; see
+ *          l_integralQuadtreeStats().
  */
 l_int32
 pixQuadtreeMean(PIX     *pixs,
@@ -90,13 +93,14 @@ pixQuadtreeMean(PIX     *pixs,
                 PIX     *pix_ma,
                 FPIXA  **pfpixa)
 {
-l_int32    i, j, w, h, size, n;
-l_float32  val;
-BOX       *box;
-BOXA      *boxa;
-BOXAA     *baa;
-FPIX      *fpix;
-PIX       *pix_mac;
+l_int32      i, j, w, h, size, n, ret;
+l_float32    val;
+BOX         *box;
+BOXA        *boxa;
+BOXAA       *baa;
+FPIX        *fpix;
+L_INTEGRAL  *li;
+PIX         *pix_mac;
 
     PROCNAME("pixQuadtreeMean");
 
@@ -109,13 +113,16 @@ PIX       *pix_mac;
     if (nlevels > quadtreeMaxLevels(w, h))
         return ERROR_INT("nlevels too large for image", procName, 1);
 
-    if (!pix_ma)
-        pix_mac = pixBlockconvAccum(pixs);
-    else
-        pix_mac = pixClone(pix_ma);
-    if (!pix_mac)
-        return ERROR_INT("pix_mac not made", procName, 1);
+    if (!pix_ma) {
+        if ((li = l_integralCreate(pixs, 0)) == NULL)
+            return ERROR_INT("li not made", procName, 1);
+        ret = l_integralQuadtreeStats(li, nlevels, pfpixa, NULL, NULL);
+        l_integralDestroy(&li);
+        return ret;
+    }
 
+    if ((pix_mac = pixClone(pix_ma)) == NULL)
+        return ERROR_INT("pix_mac not made", procName, 1);
     if ((baa = boxaaQuadtreeRegions(w, h, nlevels)) == NULL) {
         pixDestroy(&pix_mac);
         return ERROR_INT("baa not made", procName, 1);
@@ -158,6 +165,9 @@ PIX       *pix_mac;
  *      (1) The returned fpixav and fpixarv have @nlevels of fpix,
  *          each containing at the respective levels the variance
  *          and root variance values.
+ *      (2) If both @pix_ma and @dpix_msa are null, the values at all
+ *          levels are found from a single integral image with 64 bit
+ *          sums; see l_integralQuadtreeStats().
  */
 l_int32
 pixQuadtreeVariance(PIX     *pixs,
@@ -167,14 +177,15 @@ pixQuadtreeVariance(PIX     *pixs,
                     FPIXA  **pfpixa_v,
                     FPIXA  **pfpixa_rv)
 {
-l_int32    i, j, w, h, size, n;
-l_float32  var, rvar;
-BOX       *box;
-BOXA      *boxa;
-BOXAA     *baa;
-FPIX      *fpixv, *fpixrv;
-PIX       *pix_mac;  /* copy of mean accumulator */
-DPIX      *dpix_msac;  /* msa clone */
+l_int32      i, j, w, h, size, n, ret;
+l_float32    var, rvar;
+BOX         *box;
+BOXA        *boxa;
+BOXAA       *baa;
+FPIX        *fpixv, *fpixrv;
+L_INTEGRAL  *li;
+PIX         *pix_mac;  /* copy of mean accumulator */
+DPIX        *dpix_msac;  /* msa clone */
 
     PROCNAME("pixQuadtreeVariance");
 
@@ -188,6 +199,14 @@ DPIX      *dpix_msac;  /* msa clone */
     if (nlevels > quadtreeMaxLevels(w, h))
         return ERROR_INT("nlevels too large for image", procName, 1);
 
+    if (!pix_ma && !dpix_msa) {
+        if ((li = l_integralCreate(pixs, 1)) == NULL)
+            return ERROR_INT("li not made", procName, 1);
+        ret = l_integralQuadtreeStats(li, nlevels, NULL, pfpixa_v, pfpixa_rv);
+        l_integralDestroy(&li);
+        return ret;
+    }
+
     if (!pix_ma)
         pix_mac = pixBlockconvAccum(pixs);
     else
@@ -1087,6 +1087,7 @@ recogIdentifyPix(L_RECOG  *recog,
 char      *text;
 l_int32    i, j, n, bestindex, bestsample, area1, area2;
 l_int32    shiftx, shifty, bestdelx, bestdely, bestwidth, maxyshift;
+l_int32   *downcount;
 l_float32  x1, y1, x2, y2, delx, dely, score, maxscore;
 NUMA      *numa;
 PIX       *pix0, *pix1, *pix2;
@@ -1111,10 +1112,12 @@ PTA       *pta;
         return ERROR_INT("no fg pixels in pix0", procName, 1);
 
         /* Do correlation at all positions within +-maxyshift of
-         * the nominal centroid alignment. */
+         * the nominal centroid alignment.  Each template is only
+         * scored until it can no longer beat the best score so far. */
     pix1 = recogScaleCharacter(recog, pix0);
     pixCountPixels(pix1, &area1, recog->sumtab);
     pixCentroid(pix1, recog->centtab, recog->sumtab, &x1, &y1);
+    downcount = pixCorrelationMakeDowncount(pix1);
     bestindex = bestsample = bestdelx = bestdely = bestwidth = 0;
     maxscore = 0.0;
     maxyshift = recog->maxyshift;
@@ -1126,18 +1129,14 @@ PTA       *pta;
             ptaGetPt(recog->pta, i, &x2, &y2);
             delx = x1 - x2;
             dely = y1 - y2;
-            for (shifty = -maxyshift; shifty <= maxyshift; shifty++) {
-                for (shiftx = -maxyshift; shiftx <= maxyshift; shiftx++) {
-                    pixCorrelationScoreSimple(pix1, pix2, area1, area2,
-                                              delx + shiftx, dely + shifty,
-                                              5, 5, recog->sumtab, &score);
-                    if (score > maxscore) {
-                        bestindex = i;
-                        bestdelx = delx + shiftx;
-                        bestdely = dely + shifty;
-                        maxscore = score;
-                    }
-                }
+            pixCorrelationScoreShifts(pix1, pix2, area1, area2, delx, dely,
+                                      maxyshift, 5, 5, downcount, maxscore,
+                                      &score, &shiftx, &shifty);
+            if (score > maxscore) {
+                bestindex = i;
+                bestdelx = delx + shiftx;
+                bestdely = dely + shifty;
+                maxscore = score;
             }
             pixDestroy(&pix2);
         }
@@ -1157,20 +1156,17 @@ PTA       *pta;
                 ptaGetPt(pta, j, &x2, &y2);
                 delx = x1 - x2;
                 dely = y1 - y2;
-                for (shifty = -maxyshift; shifty <= maxyshift; shifty++) {
-                    for (shiftx = -maxyshift; shiftx <= maxyshift; shiftx++) {
-                        pixCorrelationScoreSimple(pix1, pix2, area1, area2,
-                                                  delx + shiftx, dely + shifty,
-                                                  5, 5, recog->sumtab, &score);
-                        if (score > maxscore) {
-                            bestindex = i;
-                            bestsample = j;
-                            bestdelx = delx + shiftx;
-                            bestdely = dely + shifty;
-                            maxscore = score;
-                            bestwidth = pixGetWidth(pix2);
-                        }
-                    }
+                pixCorrelationScoreShifts(pix1, pix2, area1, area2,
+                                          delx, dely, maxyshift, 5, 5,
+                                          downcount, maxscore, &score,
+                                          &shiftx, &shifty);
+                if (score > maxscore) {
+                    bestindex = i;
+                    bestsample = j;
+                    bestdelx = delx + shiftx;
+                    bestdely = dely + shifty;
+                    maxscore = score;
+                    bestwidth = pixGetWidth(pix2);
                 }
                 pixDestroy(&pix2);
             }
@@ -1204,6 +1200,7 @@ PTA       *pta;
         pixDestroy(&pix2);
     }
 
+    FREE(downcount);
     pixDestroy(&pix0);
     pixDestroy(&pix1);
     return 0;
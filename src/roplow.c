@@ -37,11 +37,28 @@
  *           static void     rasteropWordAlignedLow()
  *           static void     rasteropVAlignedLow()
  *           static void     rasteropGeneralLow()
+ *           static void     rasteropDispatchLow()
  *
+ *      Low level src and dest, with simd instructions
+ *           static l_int32  rasteropSimdLow()
+ *           static void     rasteropRowsSSE2()
+ *           static void     rasteropRowsAVX2()
+ *
+ *      When the processor supports it (see l_getSimdLevel()), the
+ *      src and dest rasterop is split at dest word boundaries.  The
+ *      middle part, where all dest words are full, is done 128 or 256
+ *      bits at a time, and the narrow partial-word parts at each end
+ *      are done by the ordinary 32-bit code.  The results are
+ *      identical.  The split is not made when src and dest are the
+ *      same image and their rectangles share raster lines, because
+ *      the order in which words are read and written then matters.
  */
 
 #include <string.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
 
 #define COMBINE_PARTIAL(d, s, m)     ( ((d) & ~(m)) | ((s) & (m)) )
 
@@ -71,6 +88,26 @@ static void rasteropGeneralLow(l_uint32 *datad, l_int32 dwpl, l_int32 dx,
                                l_int32 op, l_uint32 *datas, l_int32 swpl,
                                l_int32 sx, l_int32 sy);
 
+static void rasteropDispatchLow(l_uint32 *datad, l_int32 dwpl, l_int32 dx,
+                                l_int32 dy, l_int32 dw, l_int32 dh,
+                                l_int32 op, l_uint32 *datas, l_int32 swpl,
+                                l_int32 sx, l_int32 sy);
+
+#if USE_SIMD
+static l_int32 rasteropSimdLow(l_uint32 *datad, l_int32 dwpl, l_int32 dx,
+                               l_int32 dy, l_int32 dw, l_int32 dh,
+                               l_int32 op, l_uint32 *datas, l_int32 swpl,
+                               l_int32 sx, l_int32 sy);
+
+static void rasteropRowsSSE2(l_uint32 *pdfword, l_int32 dwpl, l_int32 nw,
+                             l_int32 dh, l_int32 op, l_uint32 *psfword,
+                             l_int32 swpl, l_int32 shift);
+
+static void rasteropRowsAVX2(l_uint32 *pdfword, l_int32 dwpl, l_int32 nw,
+                             l_int32 dh, l_int32 op, l_uint32 *psfword,
+                             l_int32 swpl, l_int32 shift);
+#endif  /* USE_SIMD */
+
 
 static const l_uint32 lmask32[] = {0x0,
     0x80000000, 0xc0000000, 0xe0000000, 0xf0000000,
@@ -552,8 +589,41 @@ l_int32  dhangw, shangw, dhangh, shangh;
         return;
 
    /* -------------------------------------------------------*
-    *       dispatch to aligned or non-aligned blitters
+    *       dispatch to simd, aligned or non-aligned blitters
     * -------------------------------------------------------*/
+#if USE_SIMD
+    if (rasteropSimdLow(datad, dwpl, dx, dy, dw, dh, op,
+                        datas, swpl, sx, sy))
+        return;
+#endif  /* USE_SIMD */
+    rasteropDispatchLow(datad, dwpl, dx, dy, dw, dh, op,
+                        datas, swpl, sx, sy);
+    return;
+}
+
+
+/*!
+ *  rasteropDispatchLow()
+ *
+ *      Input:  datad, dwpl, dx, dy, dw, dh, op, datas, swpl, sx, sy
+ *              (as in rasteropWordAlignedLow(), for a clipped rect)
+ *      Return: void
+ *
+ *  Dispatches to the 32-bit blitter for the alignment of src and dest.
+ */
+static void
+rasteropDispatchLow(l_uint32  *datad,
+                    l_int32    dwpl,
+                    l_int32    dx,
+                    l_int32    dy,
+                    l_int32    dw,
+                    l_int32    dh,
+                    l_int32    op,
+                    l_uint32  *datas,
+                    l_int32    swpl,
+                    l_int32    sx,
+                    l_int32    sy)
+{
     if (((dx & 31) == 0) && ((sx & 31) == 0))
         rasteropWordAlignedLow(datad, dwpl, dx, dy, dw, dh, op,
                                datas, swpl, sx, sy);
@@ -859,6 +929,8 @@ l_int32    i, j;
     if ((dx & 31) == 0) {  /* if not */
         dfwpartb = 0;
         dfwbits = 0;
+        dfwmask = 0;
+        pdfwpart = psfwpart = NULL;
     } else {  /* if so */
         dfwpartb = 1;
         dfwbits = 32 - (dx & 31);
@@ -876,6 +948,7 @@ l_int32    i, j;
     }
 
         /* is there a full dest word? */
+    pdfwfull = psfwfull = NULL;
     if (dfwpart2b == 1) {  /* not */
         dfwfullb = 0;
         dnfullw = 0;
@@ -899,6 +972,8 @@ l_int32    i, j;
     dlwbits = (dx + dw) & 31;
     if (dfwpart2b == 1 || dlwbits == 0) {  /* if not */
         dlwpartb = 0;
+        dlwmask = 0;
+        pdlwpart = pslwpart = NULL;
     } else {
         dlwpartb = 1;
         dlwmask = lmask32[dlwbits];
@@ -1427,6 +1502,10 @@ l_int32    i, j;
     if ((dx & 31) == 0) {  /* if not */
         dfwpartb = 0;
         dfwbits = 0;
+        dfwmask = 0;
+        pdfwpart = psfwpart = NULL;
+        sfwshiftdir = SHIFT_LEFT;
+        sfwaddb = 0;
     } else {  /* if so */
         dfwpartb = 1;
         dfwbits = 32 - (dx & 31);
@@ -1442,6 +1521,7 @@ l_int32    i, j;
                 sfwaddb = 1;   /* and rshift in next src word by srightshift */
         } else {
             sfwshiftdir = SHIFT_RIGHT;  /* and shift by srightshift */
+            sfwaddb = 0;
         }
     }
 
@@ -1454,6 +1534,7 @@ l_int32    i, j;
     }
 
         /* is there a full dest word? */
+    pdfwfull = psfwfull = NULL;
     if (dfwpart2b == 1) {  /* not */
         dfwfullb = 0;
         dnfullw = 0;
@@ -1472,6 +1553,9 @@ l_int32    i, j;
     dlwbits = (dx + dw) & 31;
     if (dfwpart2b == 1 || dlwbits == 0) {  /* if not */
         dlwpartb = 0;
+        dlwmask = 0;
+        pdlwpart = pslwpart = NULL;
+        slwaddb = 0;
     } else {
         dlwpartb = 1;
         dlwmask = lmask32[dlwbits];
@@ -2116,3 +2200,284 @@ l_int32    i, j;
 
     return;
 }
+
+
+#if USE_SIMD
+/*--------------------------------------------------------------------*
+ *          Static low-level rasterop with simd instructions          *
+ *--------------------------------------------------------------------*/
+/*!
+ *  rasteropSimdLow()
+ *
+ *      Input:  datad, dwpl, dx, dy, dw, dh, op, datas, swpl, sx, sy
+ *              (as in rasteropWordAlignedLow(), for a clipped rect)
+ *      Return: 1 if the rasterop has been done; 0 if it must be
+ *              done by rasteropDispatchLow()
+ *
+ *  Notes:
+ *      (1) The dest rect is split into three parts: the bits before
+ *          the first dest word boundary, a middle part made of a
+ *          multiple of 4 (SSE2) or 8 (AVX2) full dest words, and the
+ *          remaining bits on the right.  The middle is done with
+ *          vector instructions, for any src alignment; the two ends
+ *          use the 32-bit blitters.
+ *      (2) Nothing is done if the rect is too narrow to hold at least
+ *          one vector of full dest words, or if src and dest are the
+ *          same image and the rects have raster lines in common.
+ */
+static l_int32
+rasteropSimdLow(l_uint32  *datad,
+                l_int32    dwpl,
+                l_int32    dx,
+                l_int32    dy,
+                l_int32    dw,
+                l_int32    dh,
+                l_int32    op,
+                l_uint32  *datas,
+                l_int32    swpl,
+                l_int32    sx,
+                l_int32    sy)
+{
+l_int32  level, nvw, dxa, sxa, dwl, dwr, nw;
+
+    if ((level = l_getSimdLevel()) == L_SIMD_NONE)
+        return 0;
+    switch (op)
+    {
+    case PIX_SRC:
+    case PIX_NOT(PIX_SRC):
+    case (PIX_SRC | PIX_DST):
+    case (PIX_SRC & PIX_DST):
+    case (PIX_SRC ^ PIX_DST):
+    case (PIX_NOT(PIX_SRC) | PIX_DST):
+    case (PIX_NOT(PIX_SRC) & PIX_DST):
+    case (PIX_SRC | PIX_NOT(PIX_DST)):
+    case (PIX_SRC & PIX_NOT(PIX_DST)):
+    case (PIX_NOT(PIX_SRC | PIX_DST)):
+    case (PIX_NOT(PIX_SRC & PIX_DST)):
+    case (PIX_NOT(PIX_SRC ^ PIX_DST)):
+        break;
+    default:
+        return 0;
+    }
+    if (datas == datad && dy < sy + dh && sy < dy + dh)
+        return 0;
+
+        /* Find the middle part, in full dest words */
+    nvw = (level == L_SIMD_AVX2) ? 8 : 4;  /* words in a vector */
+    dxa = (dx + 31) & ~31;  /* first dest word boundary */
+    dwl = dxa - dx;  /* width of the left part */
+    if (dw - dwl < 32 * nvw)
+        return 0;
+    nw = nvw * (((dw - dwl) >> 5) / nvw);
+    sxa = sx + dwl;
+    dwr = dw - dwl - 32 * nw;  /* width of the right part */
+
+    if (level == L_SIMD_AVX2)
+        rasteropRowsAVX2(datad + dwpl * dy + (dxa >> 5), dwpl, nw, dh, op,
+                         datas + swpl * sy + (sxa >> 5), swpl, sxa & 31);
+    else
+        rasteropRowsSSE2(datad + dwpl * dy + (dxa >> 5), dwpl, nw, dh, op,
+                         datas + swpl * sy + (sxa >> 5), swpl, sxa & 31);
+
+    if (dwl > 0)
+        rasteropDispatchLow(datad, dwpl, dx, dy, dwl, dh, op,
+                            datas, swpl, sx, sy);
+    if (dwr > 0)
+        rasteropDispatchLow(datad, dwpl, dxa + 32 * nw, dy, dwr, dh, op,
+                            datas, swpl, sxa + 32 * nw, sy);
+    return 1;
+}
+
+
+    /* Each dest word j is made from the src bits starting @shift bits
+     * into src word j.  When @shift > 0, these bits come from two
+     * adjacent src words.  The loop macros apply EXPR, a function
+     * of the src vector s and dest vector d, to every row.  */
+#define  SSE2_LOAD(p)    _mm_loadu_si128((const __m128i *)(p))
+#define  SSE2_SRC(p) \
+    ((shift == 0) ? SSE2_LOAD(p) : \
+     _mm_or_si128(_mm_sll_epi32(SSE2_LOAD(p), lsh), \
+                  _mm_srl_epi32(SSE2_LOAD((p) + 1), rsh)))
+#define  SSE2_ROWS(EXPR) \
+    for (i = 0; i < dh; i++) { \
+        lines = psfword + i * swpl; \
+        lined = pdfword + i * dwpl; \
+        for (j = 0; j < nw; j += 4) { \
+            s = SSE2_SRC(lines + j); \
+            d = SSE2_LOAD(lined + j); \
+            _mm_storeu_si128((__m128i *)(lined + j), (EXPR)); \
+        } \
+    }
+
+#define  AVX2_LOAD(p)    _mm256_loadu_si256((const __m256i *)(p))
+#define  AVX2_SRC(p) \
+    ((shift == 0) ? AVX2_LOAD(p) : \
+     _mm256_or_si256(_mm256_sll_epi32(AVX2_LOAD(p), lsh), \
+                     _mm256_srl_epi32(AVX2_LOAD((p) + 1), rsh)))
+#define  AVX2_ROWS(EXPR) \
+    for (i = 0; i < dh; i++) { \
+        lines = psfword + i * swpl; \
+        lined = pdfword + i * dwpl; \
+        for (j = 0; j < nw; j += 8) { \
+            s = AVX2_SRC(lines + j); \
+            d = AVX2_LOAD(lined + j); \
+            _mm256_storeu_si256((__m256i *)(lined + j), (EXPR)); \
+        } \
+    }
+
+
+/*!
+ *  rasteropRowsSSE2()
+ *
+ *      Input:  pdfword (ptr to first dest word; word aligned)
+ *              dwpl (wpl of dest)
+ *              nw (number of full dest words in each row; multiple of 4)
+ *              dh (number of rows)
+ *              op (op code)
+ *              psfword (ptr to src word holding the first src bit)
+ *              swpl (wpl of src)
+ *              shift (position of the first src bit in that word)
+ *      Return: void
+ */
+static void  L_TARGET_SSE2
+rasteropRowsSSE2(l_uint32  *pdfword,
+                 l_int32    dwpl,
+                 l_int32    nw,
+                 l_int32    dh,
+                 l_int32    op,
+                 l_uint32  *psfword,
+                 l_int32    swpl,
+                 l_int32    shift)
+{
+l_int32    i, j;
+l_uint32  *lines, *lined;
+__m128i    s, d, ones, lsh, rsh;
+
+    ones = _mm_set1_epi32(-1);
+    lsh = _mm_cvtsi32_si128(shift);
+    rsh = _mm_cvtsi32_si128(32 - shift);
+
+    switch (op)
+    {
+    case PIX_SRC:
+        SSE2_ROWS(s);
+        break;
+    case PIX_NOT(PIX_SRC):
+        SSE2_ROWS(_mm_xor_si128(s, ones));
+        break;
+    case (PIX_SRC | PIX_DST):
+        SSE2_ROWS(_mm_or_si128(s, d));
+        break;
+    case (PIX_SRC & PIX_DST):
+        SSE2_ROWS(_mm_and_si128(s, d));
+        break;
+    case (PIX_SRC ^ PIX_DST):
+        SSE2_ROWS(_mm_xor_si128(s, d));
+        break;
+    case (PIX_NOT(PIX_SRC) | PIX_DST):
+        SSE2_ROWS(_mm_or_si128(_mm_xor_si128(s, ones), d));
+        break;
+    case (PIX_NOT(PIX_SRC) & PIX_DST):
+        SSE2_ROWS(_mm_andnot_si128(s, d));
+        break;
+    case (PIX_SRC | PIX_NOT(PIX_DST)):
+        SSE2_ROWS(_mm_or_si128(s, _mm_xor_si128(d, ones)));
+        break;
+    case (PIX_SRC & PIX_NOT(PIX_DST)):
+        SSE2_ROWS(_mm_andnot_si128(d, s));
+        break;
+    case (PIX_NOT(PIX_SRC | PIX_DST)):
+        SSE2_ROWS(_mm_xor_si128(_mm_or_si128(s, d), ones));
+        break;
+    case (PIX_NOT(PIX_SRC & PIX_DST)):
+        SSE2_ROWS(_mm_xor_si128(_mm_and_si128(s, d), ones));
+        break;
+    case (PIX_NOT(PIX_SRC ^ PIX_DST)):
+        SSE2_ROWS(_mm_xor_si128(_mm_xor_si128(s, d), ones));
+        break;
+    default:
+        break;
+    }
+
+    return;
+}
+
+
+/*!
+ *  rasteropRowsAVX2()
+ *
+ *      Input:  pdfword (ptr to first dest word; word aligned)
+ *              dwpl (wpl of dest)
+ *              nw (number of full dest words in each row; multiple of 8)
+ *              dh (number of rows)
+ *              op (op code)
+ *              psfword (ptr to src word holding the first src bit)
+ *              swpl (wpl of src)
+ *              shift (position of the first src bit in that word)
+ *      Return: void
+ */
+static void  L_TARGET_AVX2
+rasteropRowsAVX2(l_uint32  *pdfword,
+                 l_int32    dwpl,
+                 l_int32    nw,
+                 l_int32    dh,
+                 l_int32    op,
+                 l_uint32  *psfword,
+                 l_int32    swpl,
+                 l_int32    shift)
+{
+l_int32    i, j;
+l_uint32  *lines, *lined;
+__m128i    lsh, rsh;
+__m256i    s, d, ones;
+
+    ones = _mm256_set1_epi32(-1);
+    lsh = _mm_cvtsi32_si128(shift);
+    rsh = _mm_cvtsi32_si128(32 - shift);
+
+    switch (op)
+    {
+    case PIX_SRC:
+        AVX2_ROWS(s);
+        break;
+    case PIX_NOT(PIX_SRC):
+        AVX2_ROWS(_mm256_xor_si256(s, ones));
+        break;
+    case (PIX_SRC | PIX_DST):
+        AVX2_ROWS(_mm256_or_si256(s, d));
+        break;
+    case (PIX_SRC & PIX_DST):
+        AVX2_ROWS(_mm256_and_si256(s, d));
+        break;
+    case (PIX_SRC ^ PIX_DST):
+        AVX2_ROWS(_mm256_xor_si256(s, d));
+        break;
+    case (PIX_NOT(PIX_SRC) | PIX_DST):
+        AVX2_ROWS(_mm256_or_si256(_mm256_xor_si256(s, ones), d));
+        break;
+    case (PIX_NOT(PIX_SRC) & PIX_DST):
+        AVX2_ROWS(_mm256_andnot_si256(s, d));
+        break;
+    case (PIX_SRC | PIX_NOT(PIX_DST)):
+        AVX2_ROWS(_mm256_or_si256(s, _mm256_xor_si256(d, ones)));
+        break;
+    case (PIX_SRC & PIX_NOT(PIX_DST)):
+        AVX2_ROWS(_mm256_andnot_si256(d, s));
+        break;
+    case (PIX_NOT(PIX_SRC | PIX_DST)):
+        AVX2_ROWS(_mm256_xor_si256(_mm256_or_si256(s, d), ones));
+        break;
+    case (PIX_NOT(PIX_SRC & PIX_DST)):
+        AVX2_ROWS(_mm256_xor_si256(_mm256_and_si256(s, d), ones));
+        break;
+    case (PIX_NOT(PIX_SRC ^ PIX_DST)):
+        AVX2_ROWS(_mm256_xor_si256(_mm256_xor_si256(s, d), ones));
+        break;
+    default:
+        break;
+    }
+
+    return;
+}
+#endif  /* USE_SIMD */
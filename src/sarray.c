@@ -349,8 +349,7 @@ SARRAY  *sa;
     if ((sa = *psa) == NULL)
         return;
 
-    sarrayChangeRefcount(sa, -1);
-    if (sarrayGetRefcount(sa) <= 0) {
+    if (L_REFCOUNT_ADD(&sa->refcount, -1) <= 0) {
         if (sa->array) {
             for (i = 0; i < sa->n; i++) {
                 if (sa->array[i])
@@ -716,7 +715,7 @@ sarrayChangeRefcount(SARRAY  *sa,
 
     if (!sa)
         return ERROR_INT("sa not defined", procName, UNDEF);
-    sa->refcount += delta;
+    L_REFCOUNT_ADD(&sa->refcount, delta);
     return 0;
 }
 
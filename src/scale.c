@@ -105,8 +105,20 @@
  *         RGB scaling including alpha (blend) component
  *               PIX      *pixScaleWithAlpha()   ***
  *
+ *         Static helpers for scaling bands of raster lines in parallel
+ *               static void      scaleInBands()
+ *               static l_int32   scaleBandJob()
+ *
  *  *** Note: these functions make an implicit assumption about RGB
  *            component ordering.
+ *
+ *  The general LI scalers, the area map scalers and the integer
+ *  scale-to-gray functions split the dest image into bands of raster
+ *  lines, which are computed in parallel when the default number of
+ *  threads has been set larger than 1 with l_setNumThreads().  The
+ *  inner loops of the general LI and area map scalers on 8 and 32 bpp
+ *  use SSE2 or AVX2, as limited by l_setSimdLevel().  The results are
+ *  the same for every choice of threads and simd level.
  */
 
 #include <string.h>
@@ -114,6 +126,45 @@
 
 extern l_float32  AlphaMaskBorderVals[2];
 
+    /* Low-level function applied to each band by scaleBandJob() */
+enum {
+    SCALE_GRAY_LI = 1,
+    SCALE_COLOR_LI = 2,
+    SCALE_GRAY_AREA_MAP = 3,
+    SCALE_COLOR_AREA_MAP = 4,
+    SCALE_TO_GRAY_2 = 5,
+    SCALE_TO_GRAY_3 = 6,
+    SCALE_TO_GRAY_4 = 7,
+    SCALE_TO_GRAY_6 = 8,
+    SCALE_TO_GRAY_8 = 9,
+    SCALE_TO_GRAY_16 = 10
+};
+
+    /* Arguments of a low-level scaling function, for running it
+     * on bands of dest raster lines */
+struct ScaleBands
+{
+    l_int32     type;      /* SCALE_* low-level function               */
+    l_uint32   *datad;     /* dest image data                          */
+    l_int32     wd;        /* dest width                               */
+    l_int32     hd;        /* dest height                              */
+    l_int32     wpld;      /* dest words/line                          */
+    l_uint32   *datas;     /* src image data                           */
+    l_int32     ws;        /* src width                                */
+    l_int32     hs;        /* src height                               */
+    l_int32     wpls;      /* src words/line                           */
+    void       *tab1;      /* first lookup table for scale-to-gray     */
+    void       *tab2;      /* second lookup table for scale-to-gray    */
+    l_int32     nbands;    /* number of bands of dest lines            */
+};
+typedef struct ScaleBands  SCALE_BANDS;
+
+static void scaleInBands(l_int32 type, l_uint32 *datad, l_int32 wd,
+                         l_int32 hd, l_int32 wpld, l_uint32 *datas,
+                         l_int32 ws, l_int32 hs, l_int32 wpls,
+                         void *tab1, void *tab2);
+static l_int32 scaleBandJob(void *data, l_int32 index);
+
 
 /*------------------------------------------------------------------*
  *                    Top level scaling dispatcher                  *
@@ -468,7 +519,8 @@ PIX       *pixd;
     pixScaleResolution(pixd, scalex, scaley);
     datad = pixGetData(pixd);
     wpld = pixGetWpl(pixd);
-    scaleColorLILow(datad, wd, hd, wpld, datas, ws, hs, wpls);
+    scaleInBands(SCALE_COLOR_LI, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 NULL, NULL);
     if (pixGetSpp(pixs) == 4)
         pixScaleAndTransferAlpha(pixd, pixs, scalex, scaley);
     return pixd;
@@ -687,7 +739,8 @@ PIX       *pixd;
     pixScaleResolution(pixd, scalex, scaley);
     datad = pixGetData(pixd);
     wpld = pixGetWpl(pixd);
-    scaleGrayLILow(datad, wd, hd, wpld, datas, ws, hs, wpls);
+    scaleInBands(SCALE_GRAY_LI, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 NULL, NULL);
     return pixd;
 }
 
@@ -1376,9 +1429,11 @@ PIX       *pixs, *pixd, *pixt1, *pixt2, *pixt3;
     datad = pixGetData(pixd);
     wpld = pixGetWpl(pixd);
     if (d == 8) {
-        scaleGrayAreaMapLow(datad, wd, hd, wpld, datas, ws, hs, wpls);
+        scaleInBands(SCALE_GRAY_AREA_MAP, datad, wd, hd, wpld,
+                     datas, ws, hs, wpls, NULL, NULL);
     } else {  /* RGB, d == 32 */
-        scaleColorAreaMapLow(datad, wd, hd, wpld, datas, ws, hs, wpls);
+        scaleInBands(SCALE_COLOR_AREA_MAP, datad, wd, hd, wpld,
+                     datas, ws, hs, wpls, NULL, NULL);
         if (pixGetSpp(pixs) == 4)
             pixScaleAndTransferAlpha(pixd, pixs, scalex, scaley);
     }
@@ -1795,7 +1850,8 @@ PIX       *pixd;
     if ((valtab = makeValTabSG2()) == NULL)
         return (PIX *)ERROR_PTR("valtab not made", procName, NULL);
 
-    scaleToGray2Low(datad, wd, hd, wpld, datas, wpls, sumtab, valtab);
+    scaleInBands(SCALE_TO_GRAY_2, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 sumtab, valtab);
 
     FREE(sumtab);
     FREE(valtab);
@@ -1853,7 +1909,8 @@ PIX       *pixd;
     if ((valtab = makeValTabSG3()) == NULL)
         return (PIX *)ERROR_PTR("valtab not made", procName, NULL);
 
-    scaleToGray3Low(datad, wd, hd, wpld, datas, wpls, sumtab, valtab);
+    scaleInBands(SCALE_TO_GRAY_3, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 sumtab, valtab);
 
     FREE(sumtab);
     FREE(valtab);
@@ -1908,7 +1965,8 @@ PIX       *pixd;
     if ((valtab = makeValTabSG4()) == NULL)
         return (PIX *)ERROR_PTR("valtab not made", procName, NULL);
 
-    scaleToGray4Low(datad, wd, hd, wpld, datas, wpls, sumtab, valtab);
+    scaleInBands(SCALE_TO_GRAY_4, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 sumtab, valtab);
 
     FREE(sumtab);
     FREE(valtab);
@@ -1963,7 +2021,8 @@ PIX       *pixd;
     if ((valtab = makeValTabSG6()) == NULL)
         return (PIX *)ERROR_PTR("valtab not made", procName, NULL);
 
-    scaleToGray6Low(datad, wd, hd, wpld, datas, wpls, tab8, valtab);
+    scaleInBands(SCALE_TO_GRAY_6, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 tab8, valtab);
 
     FREE(tab8);
     FREE(valtab);
@@ -2015,7 +2074,8 @@ PIX       *pixd;
     if ((valtab = makeValTabSG8()) == NULL)
         return (PIX *)ERROR_PTR("valtab not made", procName, NULL);
 
-    scaleToGray8Low(datad, wd, hd, wpld, datas, wpls, tab8, valtab);
+    scaleInBands(SCALE_TO_GRAY_8, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 tab8, valtab);
 
     FREE(tab8);
     FREE(valtab);
@@ -2064,7 +2124,8 @@ PIX       *pixd;
     if ((tab8 = makePixelSumTab8()) == NULL)
         return (PIX *)ERROR_PTR("tab8 not made", procName, NULL);
 
-    scaleToGray16Low(datad, wd, hd, wpld, datas, wpls, tab8);
+    scaleInBands(SCALE_TO_GRAY_16, datad, wd, hd, wpld, datas, ws, hs, wpls,
+                 tab8, NULL);
 
     FREE(tab8);
     return pixd;
@@ -3243,3 +3304,137 @@ PIX     *pixd, *pix32, *pixg2, *pixgs;
     return pixd;
 }
 
+
+/*---------------------------------------------------------------------*
+ *        Static helpers for scaling bands of raster lines in parallel *
+ *---------------------------------------------------------------------*/
+/*!
+ *  scaleInBands()
+ *
+ *      Input:  type (SCALE_* low-level function to use)
+ *              datad, wd, hd, wpld (dest image)
+ *              datas, ws, hs, wpls (src image)
+ *              tab1, tab2 (lookup tables for scale-to-gray; else NULL)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The dest lines are split into bands that are computed
+ *          independently, using the default number of threads.
+ *          There are a few bands per thread to even out the load.
+ *      (2) Every dest pixel is computed exactly as it would be by
+ *          a single call to the low-level function.
+ */
+static void
+scaleInBands(l_int32    type,
+             l_uint32  *datad,
+             l_int32    wd,
+             l_int32    hd,
+             l_int32    wpld,
+             l_uint32  *datas,
+             l_int32    ws,
+             l_int32    hs,
+             l_int32    wpls,
+             void      *tab1,
+             void      *tab2)
+{
+l_int32      nthreads;
+SCALE_BANDS  sb;
+
+    sb.type = type;
+    sb.datad = datad;
+    sb.wd = wd;
+    sb.hd = hd;
+    sb.wpld = wpld;
+    sb.datas = datas;
+    sb.ws = ws;
+    sb.hs = hs;
+    sb.wpls = wpls;
+    sb.tab1 = tab1;
+    sb.tab2 = tab2;
+    nthreads = l_getNumThreads();
+    sb.nbands = (nthreads == 1) ? 1 : L_MIN(hd, 4 * nthreads);
+    l_parallelRun(sb.nbands, scaleBandJob, &sb, nthreads);
+    return;
+}
+
+
+/*!
+ *  scaleBandJob()
+ *
+ *      Input:  data (SCALE_BANDS)
+ *              index (of the band of dest lines)
+ *      Return: 0
+ */
+static l_int32
+scaleBandJob(void    *data,
+             l_int32  index)
+{
+l_int32       y1, y2, wpld, wpls, nlines;
+l_uint32     *datad, *datas;
+SCALE_BANDS  *sb;
+
+    sb = (SCALE_BANDS *)data;
+    y1 = (l_int32)(((l_float64)index * sb->hd) / sb->nbands);
+    y2 = (l_int32)(((l_float64)(index + 1) * sb->hd) / sb->nbands);
+    wpld = sb->wpld;
+    wpls = sb->wpls;
+
+        /* The general scalers compute lines [y1, y2) directly.
+         * For integer reduction, the data pointers are moved to
+         * the first line of the band. */
+    nlines = y2 - y1;
+    datad = sb->datad + y1 * wpld;
+    switch (sb->type)
+    {
+    case SCALE_GRAY_LI:
+        scaleGrayLIBandLow(sb->datad, sb->wd, sb->hd, wpld,
+                           sb->datas, sb->ws, sb->hs, wpls, y1, y2);
+        break;
+    case SCALE_COLOR_LI:
+        scaleColorLIBandLow(sb->datad, sb->wd, sb->hd, wpld,
+                            sb->datas, sb->ws, sb->hs, wpls, y1, y2);
+        break;
+    case SCALE_GRAY_AREA_MAP:
+        scaleGrayAreaMapBandLow(sb->datad, sb->wd, sb->hd, wpld,
+                                sb->datas, sb->ws, sb->hs, wpls, y1, y2);
+        break;
+    case SCALE_COLOR_AREA_MAP:
+        scaleColorAreaMapBandLow(sb->datad, sb->wd, sb->hd, wpld,
+                                 sb->datas, sb->ws, sb->hs, wpls, y1, y2);
+        break;
+    case SCALE_TO_GRAY_2:
+        datas = sb->datas + 2 * y1 * wpls;
+        scaleToGray2Low(datad, sb->wd, nlines, wpld, datas, wpls,
+                        (l_uint32 *)sb->tab1, (l_uint8 *)sb->tab2);
+        break;
+    case SCALE_TO_GRAY_3:
+        datas = sb->datas + 3 * y1 * wpls;
+        scaleToGray3Low(datad, sb->wd, nlines, wpld, datas, wpls,
+                        (l_uint32 *)sb->tab1, (l_uint8 *)sb->tab2);
+        break;
+    case SCALE_TO_GRAY_4:
+        datas = sb->datas + 4 * y1 * wpls;
+        scaleToGray4Low(datad, sb->wd, nlines, wpld, datas, wpls,
+                        (l_uint32 *)sb->tab1, (l_uint8 *)sb->tab2);
+        break;
+    case SCALE_TO_GRAY_6:
+        datas = sb->datas + 6 * y1 * wpls;
+        scaleToGray6Low(datad, sb->wd, nlines, wpld, datas, wpls,
+                        (l_int32 *)sb->tab1, (l_uint8 *)sb->tab2);
+        break;
+    case SCALE_TO_GRAY_8:
+        datas = sb->datas + 8 * y1 * wpls;
+        scaleToGray8Low(datad, sb->wd, nlines, wpld, datas, wpls,
+                        (l_int32 *)sb->tab1, (l_uint8 *)sb->tab2);
+        break;
+    case SCALE_TO_GRAY_16:
+        datas = sb->datas + 16 * y1 * wpls;
+        scaleToGray16Low(datad, sb->wd, nlines, wpld, datas, wpls,
+                         (l_int32 *)sb->tab1);
+        break;
+    default:
+        break;
+    }
+
+    return 0;
+}
@@ -30,9 +30,11 @@
  *
  *         Color (interpolated) scaling: general case
  *                  void       scaleColorLILow()
+ *                  void       scaleColorLIBandLow()
  *
  *         Grayscale (interpolated) scaling: general case
  *                  void       scaleGrayLILow()
+ *                  void       scaleGrayLIBandLow()
  *
  *         Color (interpolated) scaling: 2x upscaling
  *                  void       scaleColor2xLILow()
@@ -55,7 +57,9 @@
  *
  *         Color and grayscale downsampling with (antialias) area mapping
  *                  l_int32    scaleColorAreaMapLow()
+ *                  l_int32    scaleColorAreaMapBandLow()
  *                  l_int32    scaleGrayAreaMapLow()
+ *                  l_int32    scaleGrayAreaMapBandLow()
  *                  l_int32    scaleAreaMapLow2()
  *
  *         Binary scaling by closest pixel sampling
@@ -90,16 +94,53 @@
  *         Grayscale mipmap
  *                  l_int32    scaleMipmapLow()
  *
+ *         Line operations for separable LI and area map
+ *                  static void       interpLinesLow()
+ *                  static void       accumLineLow()
+ *                  static l_int32    interpLinesSSE2()
+ *                  static l_int32    interpLinesAVX2()
+ *                  static l_int32    accumLineSSE2()
+ *                  static l_int32    accumLineAVX2()
+ *
  */
 
 #include <string.h>
 #include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
 
 #ifndef  NO_CONSOLE_IO
 #define  DEBUG_OVERFLOW   0
 #define  DEBUG_UNROLLING  0
 #endif  /* ~NO_CONSOLE_IO */
 
+    /* Index into an array of per-byte values that are stored in the
+     * memory order of the bytes of a raster line */
+#ifdef  L_BIG_ENDIAN
+#define  BYTE_INDEX(n)   (n)
+#else  /* L_LITTLE_ENDIAN */
+#define  BYTE_INDEX(n)   ((n) ^ 3)
+#endif  /* L_BIG_ENDIAN */
+
+static void interpLinesLow(l_uint16 *sums, l_uint32 *line1, l_uint32 *line2,
+                           l_int32 nbytes, l_int32 wt1, l_int32 wt2,
+                           l_int32 level);
+static void accumLineLow(l_uint32 *sums, l_uint32 *line, l_int32 nbytes,
+                         l_int32 wt, l_int32 level);
+#if USE_SIMD
+static l_int32 interpLinesSSE2(l_uint16 *sums, l_uint8 *bytes1,
+                               l_uint8 *bytes2, l_int32 nbytes,
+                               l_int32 wt1, l_int32 wt2);
+static l_int32 interpLinesAVX2(l_uint16 *sums, l_uint8 *bytes1,
+                               l_uint8 *bytes2, l_int32 nbytes,
+                               l_int32 wt1, l_int32 wt2);
+static l_int32 accumLineSSE2(l_uint32 *sums, l_uint8 *bytes, l_int32 nbytes,
+                             l_int32 wt);
+static l_int32 accumLineAVX2(l_uint32 *sums, l_uint8 *bytes, l_int32 nbytes,
+                             l_int32 wt);
+#endif  /* USE_SIMD */
+
 
 /*------------------------------------------------------------------*
  *            General linear interpolated color scaling             *
@@ -107,33 +148,68 @@
 /*!
  *  scaleColorLILow()
  *
+ *      Input:  usual image variables
+ *
+ *  This computes all dest lines; see scaleColorLIBandLow().
+ */
+void
+scaleColorLILow(l_uint32  *datad,
+                l_int32    wd,
+                l_int32    hd,
+                l_int32    wpld,
+                l_uint32  *datas,
+                l_int32    ws,
+                l_int32    hs,
+                l_int32    wpls)
+{
+    scaleColorLIBandLow(datad, wd, hd, wpld, datas, ws, hs, wpls, 0, hd);
+}
+
+
+/*!
+ *  scaleColorLIBandLow()
+ *
+ *      Input:  usual image variables
+ *              ystart, yend (range of dest lines to be computed:
+ *                            ystart <= i < yend)
+ *
  *  We choose to divide each pixel into 16 x 16 sub-pixels.
  *  Linear interpolation is equivalent to finding the
  *  fractional area (i.e., number of sub-pixels divided
  *  by 256) associated with each of the four nearest src pixels,
  *  and weighting each pixel value by this fractional area.
  *
- *  P3 speed is about 7 x 10^6 dst pixels/sec/GHz
+ *  The weights are separable, so for each dest line we first
+ *  interpolate each component between the two src lines, and then
+ *  interpolate each dest pixel between two adjacent column sums.
+ *  The integer result is identical to summing the four weighted
+ *  src pixels directly.  The first step is done with SIMD
+ *  instructions when available.  Computing a range of dest lines
+ *  lets the caller split the image into bands.
  */
 void
-scaleColorLILow(l_uint32  *datad,
-               l_int32    wd,
-               l_int32    hd,
-               l_int32    wpld,
-               l_uint32  *datas,
-               l_int32    ws,
-               l_int32    hs,
-               l_int32    wpls)
+scaleColorLIBandLow(l_uint32  *datad,
+                    l_int32    wd,
+                    l_int32    hd,
+                    l_int32    wpld,
+                    l_uint32  *datas,
+                    l_int32    ws,
+                    l_int32    hs,
+                    l_int32    wpls,
+                    l_int32    ystart,
+                    l_int32    yend)
 {
-l_int32    i, j, wm2, hm2;
+l_int32    i, j, wm2, hm2, nbytes, level;
 l_int32    xpm, ypm;  /* location in src image, to 1/16 of a pixel */
 l_int32    xp, yp, xf, yf;  /* src pixel and pixel fraction coordinates */
-l_int32    v00r, v01r, v10r, v11r, v00g, v01g, v10g, v11g;
-l_int32    v00b, v01b, v10b, v11b, area00, area01, area10, area11;
-l_uint32   pixels1, pixels2, pixels3, pixels4, pixel;
+l_int32    rval, gval, bval;
+l_int32   *xptab, *xftab;
+l_uint16  *sums, *psum0, *psum1;
 l_uint32  *lines, *lined;
 l_float32  scx, scy;
 
+    PROCNAME("scaleColorLIBandLow");
+
         /* (scx, scy) are scaling factors that are applied to the
          * dest coords to get the corresponding src coords.
          * We need them because we iterate over dest pixels
@@ -143,66 +219,54 @@ l_float32  scx, scy;
     wm2 = ws - 2;
     hm2 = hs - 2;
 
+        /* The src column for each dest column is the same on every line */
+    nbytes = 4 * wpls;
+    xptab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xftab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    sums = (l_uint16 *)CALLOC(nbytes, sizeof(l_uint16));
+    if (!xptab || !xftab || !sums) {
+        L_ERROR("calloc fail for tables\n", procName);
+        goto cleanup;
+    }
+    for (j = 0; j < wd; j++) {
+        xpm = (l_int32)(scx * (l_float32)j);
+        xptab[j] = xpm >> 4;
+        xftab[j] = xpm & 0x0f;
+    }
+
         /* Iterate over the destination pixels */
-    for (i = 0; i < hd; i++) {
+    level = l_getSimdLevel();
+    for (i = ystart; i < yend; i++) {
         ypm = (l_int32)(scy * (l_float32)i);
         yp = ypm >> 4;
         yf = ypm & 0x0f;
         lined = datad + i * wpld;
         lines = datas + yp * wpls;
+        if (yp > hm2)  /* pixels near bottom */
+            interpLinesLow(sums, lines, lines, nbytes, 16, 0, level);
+        else
+            interpLinesLow(sums, lines, lines + wpls, nbytes, 16 - yf, yf,
+                           level);
         for (j = 0; j < wd; j++) {
-            xpm = (l_int32)(scx * (l_float32)j);
-            xp = xpm >> 4;
-            xf = xpm & 0x0f;
-
-                /* Do bilinear interpolation.  This is a simple
-                 * generalization of the calculation in scaleGrayLILow().
-                 * Without this, we could simply subsample:
-                 *     *(lined + j) = *(lines + xp);
-                 * which is faster but gives lousy results!  */
-            pixels1 = *(lines + xp);
-
-            if (xp > wm2 || yp > hm2) {
-                if (yp > hm2 && xp <= wm2) {  /* pixels near bottom */
-                    pixels2 = *(lines + xp + 1);
-                    pixels3 = pixels1;
-                    pixels4 = pixels2;
-                } else if (xp > wm2 && yp <= hm2) {  /* pixels near rt side */
-                    pixels2 = pixels1;
-                    pixels3 = *(lines + wpls + xp);
-                    pixels4 = pixels3;
-                } else {  /* pixels at LR corner */
-                    pixels4 = pixels3 = pixels2 = pixels1;
-                }
-            } else {
-                pixels2 = *(lines + xp + 1);
-                pixels3 = *(lines + wpls + xp);
-                pixels4 = *(lines + wpls + xp + 1);
-            }
-
-            area00 = (16 - xf) * (16 - yf);
-            area10 = xf * (16 - yf);
-            area01 = (16 - xf) * yf;
-            area11 = xf * yf;
-            v00r = area00 * ((pixels1 >> L_RED_SHIFT) & 0xff);
-            v00g = area00 * ((pixels1 >> L_GREEN_SHIFT) & 0xff);
-            v00b = area00 * ((pixels1 >> L_BLUE_SHIFT) & 0xff);
-            v10r = area10 * ((pixels2 >> L_RED_SHIFT) & 0xff);
-            v10g = area10 * ((pixels2 >> L_GREEN_SHIFT) & 0xff);
-            v10b = area10 * ((pixels2 >> L_BLUE_SHIFT) & 0xff);
-            v01r = area01 * ((pixels3 >> L_RED_SHIFT) & 0xff);
-            v01g = area01 * ((pixels3 >> L_GREEN_SHIFT) & 0xff);
-            v01b = area01 * ((pixels3 >> L_BLUE_SHIFT) & 0xff);
-            v11r = area11 * ((pixels4 >> L_RED_SHIFT) & 0xff);
-            v11g = area11 * ((pixels4 >> L_GREEN_SHIFT) & 0xff);
-            v11b = area11 * ((pixels4 >> L_BLUE_SHIFT) & 0xff);
-            pixel = (((v00r + v10r + v01r + v11r + 128) << 16) & 0xff000000) |
-                    (((v00g + v10g + v01g + v11g + 128) << 8) & 0x00ff0000) |
-                    ((v00b + v10b + v01b + v11b + 128) & 0x0000ff00);
-            *(lined + j) = pixel;
+            xp = xptab[j];
+            xf = xftab[j];
+            psum0 = sums + 4 * xp;
+            psum1 = (xp > wm2) ? psum0 : psum0 + 4;  /* pixels near rt side */
+            rval = ((16 - xf) * psum0[BYTE_INDEX(COLOR_RED)] +
+                    xf * psum1[BYTE_INDEX(COLOR_RED)] + 128) >> 8;
+            gval = ((16 - xf) * psum0[BYTE_INDEX(COLOR_GREEN)] +
+                    xf * psum1[BYTE_INDEX(COLOR_GREEN)] + 128) >> 8;
+            bval = ((16 - xf) * psum0[BYTE_INDEX(COLOR_BLUE)] +
+                    xf * psum1[BYTE_INDEX(COLOR_BLUE)] + 128) >> 8;
+            *(lined + j) = (rval << L_RED_SHIFT) | (gval << L_GREEN_SHIFT) |
+                           (bval << L_BLUE_SHIFT);
         }
     }
 
+cleanup:
+    FREE(xptab);
+    FREE(xftab);
+    FREE(sums);
     return;
 }
 
@@ -213,11 +277,9 @@ l_float32  scx, scy;
 /*!
  *  scaleGrayLILow()
  *
- *  We choose to divide each pixel into 16 x 16 sub-pixels.
- *  Linear interpolation is equivalent to finding the
- *  fractional area (i.e., number of sub-pixels divided
- *  by 256) associated with each of the four nearest src pixels,
- *  and weighting each pixel value by this fractional area.
+ *      Input:  usual image variables
+ *
+ *  This computes all dest lines; see scaleGrayLIBandLow().
  */
 void
 scaleGrayLILow(l_uint32  *datad,
@@ -229,14 +291,48 @@ scaleGrayLILow(l_uint32  *datad,
                l_int32    hs,
                l_int32    wpls)
 {
-l_int32    i, j, wm2, hm2;
+    scaleGrayLIBandLow(datad, wd, hd, wpld, datas, ws, hs, wpls, 0, hd);
+}
+
+
+/*!
+ *  scaleGrayLIBandLow()
+ *
+ *      Input:  usual image variables
+ *              ystart, yend (range of dest lines to be computed:
+ *                            ystart <= i < yend)
+ *
+ *  We choose to divide each pixel into 16 x 16 sub-pixels.
+ *  Linear interpolation is equivalent to finding the
+ *  fractional area (i.e., number of sub-pixels divided
+ *  by 256) associated with each of the four nearest src pixels,
+ *  and weighting each pixel value by this fractional area.
+ *  As in scaleColorLILow(), this is done separably, first
+ *  between src lines and then between src columns.
+ */
+void
+scaleGrayLIBandLow(l_uint32  *datad,
+                   l_int32    wd,
+                   l_int32    hd,
+                   l_int32    wpld,
+                   l_uint32  *datas,
+                   l_int32    ws,
+                   l_int32    hs,
+                   l_int32    wpls,
+                   l_int32    ystart,
+                   l_int32    yend)
+{
+l_int32    i, j, wm2, hm2, nbytes, level;
 l_int32    xpm, ypm;  /* location in src image, to 1/16 of a pixel */
 l_int32    xp, yp, xf, yf;  /* src pixel and pixel fraction coordinates */
-l_int32    v00, v01, v10, v11, v00_val, v01_val, v10_val, v11_val;
-l_uint8    val;
+l_int32    v0, v1;
+l_int32   *xptab, *xftab;
+l_uint16  *sums;
 l_uint32  *lines, *lined;
 l_float32  scx, scy;
 
+    PROCNAME("scaleGrayLIBandLow");
+
         /* (scx, scy) are scaling factors that are applied to the
          * dest coords to get the corresponding src coords.
          * We need them because we iterate over dest pixels
@@ -246,51 +342,50 @@ l_float32  scx, scy;
     wm2 = ws - 2;
     hm2 = hs - 2;
 
-        /* Iterate over the destination pixels */
-    for (i = 0; i < hd; i++) {
+        /* The src column for each dest column is the same on every line */
+    nbytes = 4 * wpls;
+    xptab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xftab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    sums = (l_uint16 *)CALLOC(nbytes, sizeof(l_uint16));
+    if (!xptab || !xftab || !sums) {
+        L_ERROR("calloc fail for tables\n", procName);
+        goto cleanup;
+    }
+    for (j = 0; j < wd; j++) {
+        xpm = (l_int32)(scx * (l_float32)j);
+        xptab[j] = xpm >> 4;
+        xftab[j] = xpm & 0x0f;
+    }
+
+        /* Iterate over the destination pixels.  Without interpolation,
+         * we could simply subsample:
+         *   SET_DATA_BYTE(lined, j, GET_DATA_BYTE(lines, xp));
+         * which is faster but gives lousy results!  */
+    level = l_getSimdLevel();
+    for (i = ystart; i < yend; i++) {
         ypm = (l_int32)(scy * (l_float32)i);
         yp = ypm >> 4;
         yf = ypm & 0x0f;
         lined = datad + i * wpld;
         lines = datas + yp * wpls;
+        if (yp > hm2)  /* pixels near bottom */
+            interpLinesLow(sums, lines, lines, nbytes, 16, 0, level);
+        else
+            interpLinesLow(sums, lines, lines + wpls, nbytes, 16 - yf, yf,
+                           level);
         for (j = 0; j < wd; j++) {
-            xpm = (l_int32)(scx * (l_float32)j);
-            xp = xpm >> 4;
-            xf = xpm & 0x0f;
-
-                /* Do bilinear interpolation.  Without this, we could
-                 * simply subsample:
-                 *   SET_DATA_BYTE(lined, j, GET_DATA_BYTE(lines, xp));
-                 * which is faster but gives lousy results!  */
-            v00_val = GET_DATA_BYTE(lines, xp);
-            if (xp > wm2 || yp > hm2) {
-                if (yp > hm2 && xp <= wm2) {  /* pixels near bottom */
-                    v01_val = v00_val;
-                    v10_val = GET_DATA_BYTE(lines, xp + 1);
-                    v11_val = v10_val;
-                } else if (xp > wm2 && yp <= hm2) {  /* pixels near rt side */
-                    v01_val = GET_DATA_BYTE(lines + wpls, xp);
-                    v10_val = v00_val;
-                    v11_val = v01_val;
-                } else {  /* pixels at LR corner */
-                    v10_val = v01_val = v11_val = v00_val;
-                }
-            } else {
-                v10_val = GET_DATA_BYTE(lines, xp + 1);
-                v01_val = GET_DATA_BYTE(lines + wpls, xp);
-                v11_val = GET_DATA_BYTE(lines + wpls, xp + 1);
-            }
-
-            v00 = (16 - xf) * (16 - yf) * v00_val;
-            v10 = xf * (16 - yf) * v10_val;
-            v01 = (16 - xf) * yf * v01_val;
-            v11 = xf * yf * v11_val;
-
-            val = (l_uint8)((v00 + v01 + v10 + v11 + 128) / 256);
-            SET_DATA_BYTE(lined, j, val);
+            xp = xptab[j];
+            xf = xftab[j];
+            v0 = sums[BYTE_INDEX(xp)];
+            v1 = (xp > wm2) ? v0 : sums[BYTE_INDEX(xp + 1)];  /* near rt */
+            SET_DATA_BYTE(lined, j, ((16 - xf) * v0 + xf * v1 + 128) >> 8);
         }
     }
 
+cleanup:
+    FREE(xptab);
+    FREE(xftab);
+    FREE(sums);
     return;
 }
 
@@ -1246,6 +1341,31 @@ l_uint32   pixel;
 /*!
  *  scaleColorAreaMapLow()
  *
+ *      Input:  usual image variables
+ *
+ *  This computes all dest lines; see scaleColorAreaMapBandLow().
+ */
+void
+scaleColorAreaMapLow(l_uint32  *datad,
+                     l_int32    wd,
+                     l_int32    hd,
+                     l_int32    wpld,
+                     l_uint32  *datas,
+                     l_int32    ws,
+                     l_int32    hs,
+                     l_int32    wpls)
+{
+    scaleColorAreaMapBandLow(datad, wd, hd, wpld, datas, ws, hs, wpls, 0, hd);
+}
+
+
+/*!
+ *  scaleColorAreaMapBandLow()
+ *
+ *      Input:  usual image variables
+ *              ystart, yend (range of dest lines to be computed:
+ *                            ystart <= i < yend)
+ *
  *  This should only be used for downscaling.
  *  We choose to divide each pixel into 16 x 16 sub-pixels.
  *  This is much slower than scaleSmoothLow(), but it gives a
@@ -1254,35 +1374,41 @@ l_uint32   pixel;
  *  and are weighted by the number of sub-pixels covered by
  *  the dest pixel.  This is about 2x slower than scaleSmoothLow(),
  *  but the results are significantly better on small text.
+ *
+ *  The number of sub-pixels covered is the product of the number
+ *  covered in each direction, so the sum is separable.  For each
+ *  line of dest pixels, the src lines are first accumulated into
+ *  a weighted sum for each component of every src pixel (with SIMD
+ *  instructions when available), and these column sums are then
+ *  weighted and added for each dest pixel.
  */
 void
-scaleColorAreaMapLow(l_uint32  *datad,
-                    l_int32    wd,
-                    l_int32    hd,
-                    l_int32    wpld,
-                    l_uint32  *datas,
-                    l_int32    ws,
-                    l_int32    hs,
-                    l_int32    wpls)
+scaleColorAreaMapBandLow(l_uint32  *datad,
+                         l_int32    wd,
+                         l_int32    hd,
+                         l_int32    wpld,
+                         l_uint32  *datas,
+                         l_int32    ws,
+                         l_int32    hs,
+                         l_int32    wpls,
+                         l_int32    ystart,
+                         l_int32    yend)
 {
-l_int32    i, j, k, m, wm2, hm2;
-l_int32    area00, area10, area01, area11, areal, arear, areat, areab;
+l_int32    i, j, k, m, wm2, hm2, nbytes, level;
 l_int32    xu, yu;  /* UL corner in src image, to 1/16 of a pixel */
 l_int32    xl, yl;  /* LR corner in src image, to 1/16 of a pixel */
 l_int32    xup, yup, xuf, yuf;  /* UL src pixel: integer and fraction */
 l_int32    xlp, ylp, xlf, ylf;  /* LR src pixel: integer and fraction */
-l_int32    delx, dely, area;
-l_int32    v00r, v00g, v00b;  /* contrib. from UL src pixel */
-l_int32    v01r, v01g, v01b;  /* contrib. from LL src pixel */
-l_int32    v10r, v10g, v10b;  /* contrib from UR src pixel */
-l_int32    v11r, v11g, v11b;  /* contrib from LR src pixel */
-l_int32    vinr, ving, vinb;  /* contrib from all full interior src pixels */
-l_int32    vmidr, vmidg, vmidb;  /* contrib from side parts */
+l_int32    dely, area, areay;
 l_int32    rval, gval, bval;
-l_uint32   pixel00, pixel10, pixel01, pixel11, pixel;
+l_int32   *xuptab, *xuftab, *xlptab, *xlftab;
+l_uint32   sumr, sumg, sumb;
+l_uint32  *sums, *psum;
 l_uint32  *lines, *lined;
 l_float32  scx, scy;
 
+    PROCNAME("scaleColorAreaMapBandLow");
+
         /* (scx, scy) are scaling factors that are applied to the
          * dest coords to get the corresponding src coords.
          * We need them because we iterate over dest pixels
@@ -1292,8 +1418,30 @@ l_float32  scx, scy;
     wm2 = ws - 2;
     hm2 = hs - 2;
 
+        /* The src columns for each dest column are the same on
+         * every line */
+    nbytes = 4 * wpls;
+    xuptab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xuftab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xlptab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xlftab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    sums = (l_uint32 *)CALLOC(nbytes, sizeof(l_uint32));
+    if (!xuptab || !xuftab || !xlptab || !xlftab || !sums) {
+        L_ERROR("calloc fail for tables\n", procName);
+        goto cleanup;
+    }
+    for (j = 0; j < wd; j++) {
+        xu = (l_int32)(scx * j);
+        xl = (l_int32)(scx * (j + 1.0));
+        xuptab[j] = xu >> 4;
+        xuftab[j] = xu & 0x0f;
+        xlptab[j] = xl >> 4;
+        xlftab[j] = xl & 0x0f;
+    }
+
         /* Iterate over the destination pixels */
-    for (i = 0; i < hd; i++) {
+    level = l_getSimdLevel();
+    for (i = ystart; i < yend; i++) {
         yu = (l_int32)(scy * i);
         yl = (l_int32)(scy * (i + 1.0));
         yup = yu >> 4;
@@ -1303,17 +1451,32 @@ l_float32  scx, scy;
         dely = ylp - yup;
         lined = datad + i * wpld;
         lines = datas + yup * wpls;
+
+            /* If near the bottom edge, just use src pixel values */
+        if (ylp > hm2) {
+            for (j = 0; j < wd; j++)
+                *(lined + j) = *(lines + xuptab[j]);
+            continue;
+        }
+
+            /* Sum the src lines, weighted by the number of
+             * sub-pixel rows covered by the dest line */
+        memset(sums, 0, nbytes * sizeof(l_uint32));
+        accumLineLow(sums, lines, nbytes, 16 - yuf, level);
+        for (k = 1; k < dely; k++)
+            accumLineLow(sums, lines + k * wpls, nbytes, 16, level);
+        if (ylf > 0)
+            accumLineLow(sums, lines + dely * wpls, nbytes, ylf, level);
+        areay = (16 - yuf) + 16 * (dely - 1) + ylf;
+
         for (j = 0; j < wd; j++) {
-            xu = (l_int32)(scx * j);
-            xl = (l_int32)(scx * (j + 1.0));
-            xup = xu >> 4;
-            xuf = xu & 0x0f;
-            xlp = xl >> 4;
-            xlf = xl & 0x0f;
-            delx = xlp - xup;
+            xup = xuptab[j];
+            xuf = xuftab[j];
+            xlp = xlptab[j];
+            xlf = xlftab[j];
 
                 /* If near the edge, just use a src pixel value */
-            if (xlp > wm2 || ylp > hm2) {
+            if (xlp > wm2) {
                 *(lined + j) = *(lines + xup);
                 continue;
             }
@@ -1321,73 +1484,28 @@ l_float32  scx, scy;
                 /* Area summed over, in subpixels.  This varies
                  * due to the quantization, so we can't simply take
                  * the area to be a constant: area = scx * scy. */
-            area = ((16 - xuf) + 16 * (delx - 1) + xlf) *
-                   ((16 - yuf) + 16 * (dely - 1) + ylf);
-
-                /* Do area map summation */
-            pixel00 = *(lines + xup);
-            pixel10 = *(lines + xlp);
-            pixel01 = *(lines + dely * wpls +  xup);
-            pixel11 = *(lines + dely * wpls +  xlp);
-            area00 = (16 - xuf) * (16 - yuf);
-            area10 = xlf * (16 - yuf);
-            area01 = (16 - xuf) * ylf;
-            area11 = xlf * ylf;
-            v00r = area00 * ((pixel00 >> L_RED_SHIFT) & 0xff);
-            v00g = area00 * ((pixel00 >> L_GREEN_SHIFT) & 0xff);
-            v00b = area00 * ((pixel00 >> L_BLUE_SHIFT) & 0xff);
-            v10r = area10 * ((pixel10 >> L_RED_SHIFT) & 0xff);
-            v10g = area10 * ((pixel10 >> L_GREEN_SHIFT) & 0xff);
-            v10b = area10 * ((pixel10 >> L_BLUE_SHIFT) & 0xff);
-            v01r = area01 * ((pixel01 >> L_RED_SHIFT) & 0xff);
-            v01g = area01 * ((pixel01 >> L_GREEN_SHIFT) & 0xff);
-            v01b = area01 * ((pixel01 >> L_BLUE_SHIFT) & 0xff);
-            v11r = area11 * ((pixel11 >> L_RED_SHIFT) & 0xff);
-            v11g = area11 * ((pixel11 >> L_GREEN_SHIFT) & 0xff);
-            v11b = area11 * ((pixel11 >> L_BLUE_SHIFT) & 0xff);
-            vinr = ving = vinb = 0;
-            for (k = 1; k < dely; k++) {  /* for full src pixels */
-                for (m = 1; m < delx; m++) {
-                    pixel = *(lines + k * wpls + xup + m);
-                    vinr += 256 * ((pixel >> L_RED_SHIFT) & 0xff);
-                    ving += 256 * ((pixel >> L_GREEN_SHIFT) & 0xff);
-                    vinb += 256 * ((pixel >> L_BLUE_SHIFT) & 0xff);
-                }
-            }
-            vmidr = vmidg = vmidb = 0;
-            areal = (16 - xuf) * 16;
-            arear = xlf * 16;
-            areat = 16 * (16 - yuf);
-            areab = 16 * ylf;
-            for (k = 1; k < dely; k++) {  /* for left side */
-                pixel = *(lines + k * wpls + xup);
-                vmidr += areal * ((pixel >> L_RED_SHIFT) & 0xff);
-                vmidg += areal * ((pixel >> L_GREEN_SHIFT) & 0xff);
-                vmidb += areal * ((pixel >> L_BLUE_SHIFT) & 0xff);
-            }
-            for (k = 1; k < dely; k++) {  /* for right side */
-                pixel = *(lines + k * wpls + xlp);
-                vmidr += arear * ((pixel >> L_RED_SHIFT) & 0xff);
-                vmidg += arear * ((pixel >> L_GREEN_SHIFT) & 0xff);
-                vmidb += arear * ((pixel >> L_BLUE_SHIFT) & 0xff);
-            }
-            for (m = 1; m < delx; m++) {  /* for top side */
-                pixel = *(lines + xup + m);
-                vmidr += areat * ((pixel >> L_RED_SHIFT) & 0xff);
-                vmidg += areat * ((pixel >> L_GREEN_SHIFT) & 0xff);
-                vmidb += areat * ((pixel >> L_BLUE_SHIFT) & 0xff);
-            }
-            for (m = 1; m < delx; m++) {  /* for bottom side */
-                pixel = *(lines + dely * wpls + xup + m);
-                vmidr += areab * ((pixel >> L_RED_SHIFT) & 0xff);
-                vmidg += areab * ((pixel >> L_GREEN_SHIFT) & 0xff);
-                vmidb += areab * ((pixel >> L_BLUE_SHIFT) & 0xff);
+            area = ((16 - xuf) + 16 * (xlp - xup - 1) + xlf) * areay;
+
+                /* Do area map summation over the column sums */
+            psum = sums + 4 * xup;
+            sumr = (16 - xuf) * psum[BYTE_INDEX(COLOR_RED)];
+            sumg = (16 - xuf) * psum[BYTE_INDEX(COLOR_GREEN)];
+            sumb = (16 - xuf) * psum[BYTE_INDEX(COLOR_BLUE)];
+            for (m = xup + 1; m < xlp; m++) {  /* for full src columns */
+                psum = sums + 4 * m;
+                sumr += 16 * psum[BYTE_INDEX(COLOR_RED)];
+                sumg += 16 * psum[BYTE_INDEX(COLOR_GREEN)];
+                sumb += 16 * psum[BYTE_INDEX(COLOR_BLUE)];
             }
+            psum = sums + 4 * xlp;
+            sumr += xlf * psum[BYTE_INDEX(COLOR_RED)];
+            sumg += xlf * psum[BYTE_INDEX(COLOR_GREEN)];
+            sumb += xlf * psum[BYTE_INDEX(COLOR_BLUE)];
 
                 /* Sum all the contributions */
-            rval = (v00r + v01r + v10r + v11r + vinr + vmidr + 128) / area;
-            gval = (v00g + v01g + v10g + v11g + ving + vmidg + 128) / area;
-            bval = (v00b + v01b + v10b + v11b + vinb + vmidb + 128) / area;
+            rval = (sumr + 128) / area;
+            gval = (sumg + 128) / area;
+            bval = (sumb + 128) / area;
 #if  DEBUG_OVERFLOW
             if (rval > 255) fprintf(stderr, "rval ovfl: %d\n", rval);
             if (gval > 255) fprintf(stderr, "gval ovfl: %d\n", gval);
@@ -1397,6 +1515,12 @@ l_float32  scx, scy;
         }
     }
 
+cleanup:
+    FREE(xuptab);
+    FREE(xuftab);
+    FREE(xlptab);
+    FREE(xlftab);
+    FREE(sums);
     return;
 }
 
@@ -1404,13 +1528,9 @@ l_float32  scx, scy;
 /*!
  *  scaleGrayAreaMapLow()
  *
- *  This should only be used for downscaling.
- *  We choose to divide each pixel into 16 x 16 sub-pixels.
- *  This is about 2x slower than scaleSmoothLow(), but the results
- *  are significantly better on small text, esp. for downscaling
- *  factors between 1.5 and 5.  All src pixels are subdivided
- *  into 256 sub-pixels, and are weighted by the number of
- *  sub-pixels covered by the dest pixel.
+ *      Input:  usual image variables
+ *
+ *  This computes all dest lines; see scaleGrayAreaMapBandLow().
  */
 void
 scaleGrayAreaMapLow(l_uint32  *datad,
@@ -1422,22 +1542,53 @@ scaleGrayAreaMapLow(l_uint32  *datad,
                     l_int32    hs,
                     l_int32    wpls)
 {
-l_int32    i, j, k, m, wm2, hm2;
+    scaleGrayAreaMapBandLow(datad, wd, hd, wpld, datas, ws, hs, wpls, 0, hd);
+}
+
+
+/*!
+ *  scaleGrayAreaMapBandLow()
+ *
+ *      Input:  usual image variables
+ *              ystart, yend (range of dest lines to be computed:
+ *                            ystart <= i < yend)
+ *
+ *  This should only be used for downscaling.
+ *  We choose to divide each pixel into 16 x 16 sub-pixels.
+ *  This is about 2x slower than scaleSmoothLow(), but the results
+ *  are significantly better on small text, esp. for downscaling
+ *  factors between 1.5 and 5.  All src pixels are subdivided
+ *  into 256 sub-pixels, and are weighted by the number of
+ *  sub-pixels covered by the dest pixel.  The summation is
+ *  done separably, as in scaleColorAreaMapLow().
+ */
+void
+scaleGrayAreaMapBandLow(l_uint32  *datad,
+                        l_int32    wd,
+                        l_int32    hd,
+                        l_int32    wpld,
+                        l_uint32  *datas,
+                        l_int32    ws,
+                        l_int32    hs,
+                        l_int32    wpls,
+                        l_int32    ystart,
+                        l_int32    yend)
+{
+l_int32    i, j, k, m, wm2, hm2, nbytes, level;
 l_int32    xu, yu;  /* UL corner in src image, to 1/16 of a pixel */
 l_int32    xl, yl;  /* LR corner in src image, to 1/16 of a pixel */
 l_int32    xup, yup, xuf, yuf;  /* UL src pixel: integer and fraction */
 l_int32    xlp, ylp, xlf, ylf;  /* LR src pixel: integer and fraction */
-l_int32    delx, dely, area;
-l_int32    v00;  /* contrib. from UL src pixel */
-l_int32    v01;  /* contrib. from LL src pixel */
-l_int32    v10;  /* contrib from UR src pixel */
-l_int32    v11;  /* contrib from LR src pixel */
-l_int32    vin;  /* contrib from all full interior src pixels */
-l_int32    vmid;  /* contrib from side parts that are full in 1 direction */
+l_int32    dely, area, areay;
 l_int32    val;
+l_int32   *xuptab, *xuftab, *xlptab, *xlftab;
+l_uint32   sum;
+l_uint32  *sums;
 l_uint32  *lines, *lined;
 l_float32  scx, scy;
 
+    PROCNAME("scaleGrayAreaMapBandLow");
+
         /* (scx, scy) are scaling factors that are applied to the
          * dest coords to get the corresponding src coords.
          * We need them because we iterate over dest pixels
@@ -1447,8 +1598,30 @@ l_float32  scx, scy;
     wm2 = ws - 2;
     hm2 = hs - 2;
 
+        /* The src columns for each dest column are the same on
+         * every line */
+    nbytes = 4 * wpls;
+    xuptab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xuftab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xlptab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    xlftab = (l_int32 *)CALLOC(wd, sizeof(l_int32));
+    sums = (l_uint32 *)CALLOC(nbytes, sizeof(l_uint32));
+    if (!xuptab || !xuftab || !xlptab || !xlftab || !sums) {
+        L_ERROR("calloc fail for tables\n", procName);
+        goto cleanup;
+    }
+    for (j = 0; j < wd; j++) {
+        xu = (l_int32)(scx * j);
+        xl = (l_int32)(scx * (j + 1.0));
+        xuptab[j] = xu >> 4;
+        xuftab[j] = xu & 0x0f;
+        xlptab[j] = xl >> 4;
+        xlftab[j] = xl & 0x0f;
+    }
+
         /* Iterate over the destination pixels */
-    for (i = 0; i < hd; i++) {
+    level = l_getSimdLevel();
+    for (i = ystart; i < yend; i++) {
         yu = (l_int32)(scy * i);
         yl = (l_int32)(scy * (i + 1.0));
         yup = yu >> 4;
@@ -1458,17 +1631,32 @@ l_float32  scx, scy;
         dely = ylp - yup;
         lined = datad + i * wpld;
         lines = datas + yup * wpls;
+
+            /* If near the bottom edge, just use src pixel values */
+        if (ylp > hm2) {
+            for (j = 0; j < wd; j++)
+                SET_DATA_BYTE(lined, j, GET_DATA_BYTE(lines, xuptab[j]));
+            continue;
+        }
+
+            /* Sum the src lines, weighted by the number of
+             * sub-pixel rows covered by the dest line */
+        memset(sums, 0, nbytes * sizeof(l_uint32));
+        accumLineLow(sums, lines, nbytes, 16 - yuf, level);
+        for (k = 1; k < dely; k++)
+            accumLineLow(sums, lines + k * wpls, nbytes, 16, level);
+        if (ylf > 0)
+            accumLineLow(sums, lines + dely * wpls, nbytes, ylf, level);
+        areay = (16 - yuf) + 16 * (dely - 1) + ylf;
+
         for (j = 0; j < wd; j++) {
-            xu = (l_int32)(scx * j);
-            xl = (l_int32)(scx * (j + 1.0));
-            xup = xu >> 4;
-            xuf = xu & 0x0f;
-            xlp = xl >> 4;
-            xlf = xl & 0x0f;
-            delx = xlp - xup;
+            xup = xuptab[j];
+            xuf = xuftab[j];
+            xlp = xlptab[j];
+            xlf = xlftab[j];
 
                 /* If near the edge, just use a src pixel value */
-            if (xlp > wm2 || ylp > hm2) {
+            if (xlp > wm2) {
                 SET_DATA_BYTE(lined, j, GET_DATA_BYTE(lines, xup));
                 continue;
             }
@@ -1476,28 +1664,14 @@ l_float32  scx, scy;
                 /* Area summed over, in subpixels.  This varies
                  * due to the quantization, so we can't simply take
                  * the area to be a constant: area = scx * scy. */
-            area = ((16 - xuf) + 16 * (delx - 1) + xlf) *
-                   ((16 - yuf) + 16 * (dely - 1) + ylf);
-
-                /* Do area map summation */
-            v00 = (16 - xuf) * (16 - yuf) * GET_DATA_BYTE(lines, xup);
-            v10 = xlf * (16 - yuf) * GET_DATA_BYTE(lines, xlp);
-            v01 = (16 - xuf) * ylf * GET_DATA_BYTE(lines + dely * wpls, xup);
-            v11 = xlf * ylf * GET_DATA_BYTE(lines + dely * wpls, xlp);
-            for (vin = 0, k = 1; k < dely; k++) {  /* for full src pixels */
-                 for (m = 1; m < delx; m++) {
-                     vin += 256 * GET_DATA_BYTE(lines + k * wpls, xup + m);
-                 }
-            }
-            for (vmid = 0, k = 1; k < dely; k++)  /* for left side */
-                vmid += (16 - xuf) * 16 * GET_DATA_BYTE(lines + k * wpls, xup);
-            for (k = 1; k < dely; k++)  /* for right side */
-                vmid += xlf * 16 * GET_DATA_BYTE(lines + k * wpls, xlp);
-            for (m = 1; m < delx; m++)  /* for top side */
-                vmid += 16 * (16 - yuf) * GET_DATA_BYTE(lines, xup + m);
-            for (m = 1; m < delx; m++)  /* for bottom side */
-                vmid += 16 * ylf * GET_DATA_BYTE(lines + dely * wpls, xup + m);
-            val = (v00 + v01 + v10 + v11 + vin + vmid + 128) / area;
+            area = ((16 - xuf) + 16 * (xlp - xup - 1) + xlf) * areay;
+
+                /* Do area map summation over the column sums */
+            sum = (16 - xuf) * sums[BYTE_INDEX(xup)] +
+                  xlf * sums[BYTE_INDEX(xlp)];
+            for (m = xup + 1; m < xlp; m++)  /* for full src columns */
+                sum += 16 * sums[BYTE_INDEX(m)];
+            val = (sum + 128) / area;
 #if  DEBUG_OVERFLOW
             if (val > 255) fprintf(stderr, "val overflow: %d\n", val);
 #endif  /* DEBUG_OVERFLOW */
@@ -1505,6 +1679,12 @@ l_float32  scx, scy;
         }
     }
 
+cleanup:
+    FREE(xuptab);
+    FREE(xuftab);
+    FREE(xlptab);
+    FREE(xlftab);
+    FREE(sums);
     return;
 }
 
@@ -2447,3 +2627,225 @@ l_float32  ratio, w1, w2;
     FREE(scol);
     return 0;
 }
+
+
+/*------------------------------------------------------------------*
+ *            Line operations for separable LI and area map         *
+ *------------------------------------------------------------------*/
+/*!
+ *  interpLinesLow()
+ *
+ *      Input:  sums (<return> weighted sum of the bytes in each line)
+ *              line1, line2 (src lines)
+ *              nbytes (number of bytes in each line; a multiple of 4)
+ *              wt1, wt2 (weights; each in [0 ... 16])
+ *              level (simd level)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This computes sums[k] = wt1 * line1[k] + wt2 * line2[k]
+ *          for the bytes of the two lines, in memory order.  The
+ *          sum for the pixel at byte n of the line is found at
+ *          sums[BYTE_INDEX(n)].
+ */
+static void
+interpLinesLow(l_uint16  *sums,
+               l_uint32  *line1,
+               l_uint32  *line2,
+               l_int32    nbytes,
+               l_int32    wt1,
+               l_int32    wt2,
+               l_int32    level)
+{
+l_int32   k;
+l_uint8  *bytes1, *bytes2;
+
+    bytes1 = (l_uint8 *)line1;
+    bytes2 = (l_uint8 *)line2;
+    k = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2)
+        k = interpLinesAVX2(sums, bytes1, bytes2, nbytes, wt1, wt2);
+    else if (level == L_SIMD_SSE2)
+        k = interpLinesSSE2(sums, bytes1, bytes2, nbytes, wt1, wt2);
+#endif  /* USE_SIMD */
+
+    for (; k < nbytes; k++)
+        sums[k] = wt1 * bytes1[k] + wt2 * bytes2[k];
+    return;
+}
+
+
+/*!
+ *  accumLineLow()
+ *
+ *      Input:  sums (weighted sum of the bytes in each line; accumulated)
+ *              line (src line)
+ *              nbytes (number of bytes in the line; a multiple of 4)
+ *              wt (weight; in [0 ... 16])
+ *              level (simd level)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This computes sums[k] += wt * line[k] for the bytes of
+ *          the line, in memory order.
+ */
+static void
+accumLineLow(l_uint32  *sums,
+             l_uint32  *line,
+             l_int32    nbytes,
+             l_int32    wt,
+             l_int32    level)
+{
+l_int32   k;
+l_uint8  *bytes;
+
+    bytes = (l_uint8 *)line;
+    k = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2)
+        k = accumLineAVX2(sums, bytes, nbytes, wt);
+    else if (level == L_SIMD_SSE2)
+        k = accumLineSSE2(sums, bytes, nbytes, wt);
+#endif  /* USE_SIMD */
+
+    for (; k < nbytes; k++)
+        sums[k] += wt * bytes[k];
+    return;
+}
+
+
+#if USE_SIMD
+/*!
+ *  interpLinesSSE2()
+ *
+ *    Input:  sums, bytes1, bytes2, nbytes, wt1, wt2 (as in interpLinesLow())
+ *    Return: number of bytes done (a multiple of 16)
+ */
+static l_int32  L_TARGET_SSE2
+interpLinesSSE2(l_uint16  *sums,
+                l_uint8   *bytes1,
+                l_uint8   *bytes2,
+                l_int32    nbytes,
+                l_int32    wt1,
+                l_int32    wt2)
+{
+l_int32  k;
+__m128i  zero, w1, w2, v1, v2, lo, hi;
+
+    zero = _mm_setzero_si128();
+    w1 = _mm_set1_epi16(wt1);
+    w2 = _mm_set1_epi16(wt2);
+    for (k = 0; k + 16 <= nbytes; k += 16) {
+        v1 = _mm_loadu_si128((const __m128i *)(bytes1 + k));
+        v2 = _mm_loadu_si128((const __m128i *)(bytes2 + k));
+        lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(v1, zero), w1),
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(v2, zero), w2));
+        hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(v1, zero), w1),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(v2, zero), w2));
+        _mm_storeu_si128((__m128i *)(sums + k), lo);
+        _mm_storeu_si128((__m128i *)(sums + k + 8), hi);
+    }
+    return k;
+}
+
+
+/*!
+ *  interpLinesAVX2()
+ *
+ *    Input:  sums, bytes1, bytes2, nbytes, wt1, wt2 (as in interpLinesLow())
+ *    Return: number of bytes done (a multiple of 16)
+ */
+static l_int32  L_TARGET_AVX2
+interpLinesAVX2(l_uint16  *sums,
+                l_uint8   *bytes1,
+                l_uint8   *bytes2,
+                l_int32    nbytes,
+                l_int32    wt1,
+                l_int32    wt2)
+{
+l_int32  k;
+__m256i  w1, w2, v1, v2;
+
+    w1 = _mm256_set1_epi16(wt1);
+    w2 = _mm256_set1_epi16(wt2);
+    for (k = 0; k + 16 <= nbytes; k += 16) {
+        v1 = _mm256_cvtepu8_epi16(
+                 _mm_loadu_si128((const __m128i *)(bytes1 + k)));
+        v2 = _mm256_cvtepu8_epi16(
+                 _mm_loadu_si128((const __m128i *)(bytes2 + k)));
+        _mm256_storeu_si256((__m256i *)(sums + k),
+                            _mm256_add_epi16(_mm256_mullo_epi16(v1, w1),
+                                             _mm256_mullo_epi16(v2, w2)));
+    }
+    return k;
+}
+
+
+/*!
+ *  accumLineSSE2()
+ *
+ *    Input:  sums, bytes, nbytes, wt (as in accumLineLow())
+ *    Return: number of bytes done (a multiple of 16)
+ */
+static l_int32  L_TARGET_SSE2
+accumLineSSE2(l_uint32  *sums,
+              l_uint8   *bytes,
+              l_int32    nbytes,
+              l_int32    wt)
+{
+l_int32   k;
+__m128i   zero, w, v, lo, hi;
+__m128i  *psum;
+
+    zero = _mm_setzero_si128();
+    w = _mm_set1_epi16(wt);
+    for (k = 0; k + 16 <= nbytes; k += 16) {
+        v = _mm_loadu_si128((const __m128i *)(bytes + k));
+        lo = _mm_mullo_epi16(_mm_unpacklo_epi8(v, zero), w);
+        hi = _mm_mullo_epi16(_mm_unpackhi_epi8(v, zero), w);
+        psum = (__m128i *)(sums + k);
+        _mm_storeu_si128(psum, _mm_add_epi32(_mm_loadu_si128(psum),
+                                             _mm_unpacklo_epi16(lo, zero)));
+        _mm_storeu_si128(psum + 1, _mm_add_epi32(_mm_loadu_si128(psum + 1),
+                                                 _mm_unpackhi_epi16(lo, zero)));
+        _mm_storeu_si128(psum + 2, _mm_add_epi32(_mm_loadu_si128(psum + 2),
+                                                 _mm_unpacklo_epi16(hi, zero)));
+        _mm_storeu_si128(psum + 3, _mm_add_epi32(_mm_loadu_si128(psum + 3),
+                                                 _mm_unpackhi_epi16(hi, zero)));
+    }
+    return k;
+}
+
+
+/*!
+ *  accumLineAVX2()
+ *
+ *    Input:  sums, bytes, nbytes, wt (as in accumLineLow())
+ *    Return: number of bytes done (a multiple of 16)
+ */
+static l_int32  L_TARGET_AVX2
+accumLineAVX2(l_uint32  *sums,
+              l_uint8   *bytes,
+              l_int32    nbytes,
+              l_int32    wt)
+{
+l_int32   k;
+__m256i   w, v;
+__m256i  *psum;
+
+    w = _mm256_set1_epi16(wt);
+    for (k = 0; k + 16 <= nbytes; k += 16) {
+        v = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(bytes + k)));
+        v = _mm256_mullo_epi16(v, w);
+        psum = (__m256i *)(sums + k);
+        _mm256_storeu_si256(psum,
+            _mm256_add_epi32(_mm256_loadu_si256(psum),
+                _mm256_cvtepu16_epi32(_mm256_castsi256_si128(v))));
+        _mm256_storeu_si256(psum + 1,
+            _mm256_add_epi32(_mm256_loadu_si256(psum + 1),
+                _mm256_cvtepu16_epi32(_mm256_extracti128_si256(v, 1))));
+    }
+    return k;
+}
+#endif  /* USE_SIMD */
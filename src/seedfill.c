@@ -30,6 +30,8 @@
  *      Binary seedfill (source: Luc Vincent)
  *               PIX      *pixSeedfillBinary()
  *               PIX      *pixSeedfillBinaryRestricted()
+ *        static l_int32   seedfillInStrips()
+ *        static l_int32   seedfillStripJob()
  *
  *      Applications of binary seedfill to find and fill holes,
  *      remove c.c. touching the border and fill bg from border:
@@ -56,12 +58,19 @@
  *      Distance function (source: Luc Vincent)
  *               PIX      *pixDistanceFunction()
  *
+ *      Exact Euclidean distance function (source: Meijster et al.)
+ *               PIX      *pixEuclideanDistance()
+ *               FPIX     *pixEuclideanDistanceFPix()
+ *               PIX      *pixEuclideanDistanceSquared()
+ *        static l_int32   edtColumnJob()
+ *        static l_int32   edtRowJob()
+ *
  *      Seed spread (based on distance function)
  *               PIX      *pixSeedspread()
  *
  *      Local extrema:
  *               l_int32   pixLocalExtrema()
- *        static l_int32   pixQualifyLocalMinima()
+ *        static PIX      *pixLocalMaxima()
  *               l_int32   pixSelectedLocalExtrema()
  *               PIX      *pixFindEqualValues()
  *
@@ -154,6 +163,7 @@
  *              setting the out-of-bound pixels in m to OFF.)
  */
 
+#include <math.h>
 #include "allheaders.h"
 
 #ifndef  NO_CONSOLE_IO
@@ -163,8 +173,57 @@
   /* Two-way (UL --> LR, LR --> UL) sweep iterations; typically need only 4 */
 static const l_int32  MAX_ITERS = 40;
 
-    /* Static function */
-static l_int32 pixQualifyLocalMinima(PIX *pixs, PIX *pixm, l_int32 maxval);
+    /* Min number of lines in each strip for the first scans of a fill */
+static const l_int32  MIN_STRIP_LINES = 32;
+
+    /* Type of fill done in strips */
+enum {
+    SEEDFILL_BINARY = 1,
+    SEEDFILL_GRAY = 2,
+    SEEDFILL_GRAY_INV = 3
+};
+
+    /* Strips of the seed that are filled independently, on separate
+     * threads, before the fill is completed over the entire image */
+struct SeedfillStrips
+{
+    l_uint32  *datas;         /* data of the seed; filled in place        */
+    l_int32    w;             /* width of the seed (not used for binary)  */
+    l_int32    wpls;          /* wpl of the seed                          */
+    l_uint32  *datam;         /* data of the filling mask                 */
+    l_int32    wplm;          /* wpl of the filling mask                  */
+    l_int32    connectivity;  /* 4 or 8                                   */
+    l_int32    type;          /* SEEDFILL_BINARY, SEEDFILL_GRAY, ...      */
+    l_int32   *ystart;        /* first line of each strip; nstrips + 1    */
+};
+typedef struct SeedfillStrips  SEEDFILL_STRIPS;
+
+    /* Min number of columns or lines in each band of a pass of
+     * the Euclidean distance function */
+static const l_int32  MIN_EDT_BAND = 32;
+
+    /* Bands of columns, and then of lines, that are done on separate
+     * threads in the two passes of the Euclidean distance function */
+struct EdtBands
+{
+    l_uint32  *datas;         /* data of the 1 bpp source                 */
+    l_int32    wpls;          /* wpl of the source                        */
+    l_int32    w;             /* width of the image                       */
+    l_int32    h;             /* height of the image                      */
+    l_uint32  *datad;         /* 32 bpp distance data; wpl = w            */
+    l_int32    boundcond;     /* L_BOUNDARY_BG or L_BOUNDARY_FG           */
+    l_int32    nbands;        /* number of bands in the current pass      */
+};
+typedef struct EdtBands  EDT_BANDS;
+
+    /* Static functions */
+static l_int32 seedfillInStrips(l_uint32 *datas, l_int32 w, l_int32 h,
+                                l_int32 wpls, l_uint32 *datam, l_int32 wplm,
+                                l_int32 connectivity, l_int32 type);
+static l_int32 seedfillStripJob(void *data, l_int32 index);
+static l_int32 edtColumnJob(void *data, l_int32 index);
+static l_int32 edtRowJob(void *data, l_int32 index);
+static PIX *pixLocalMaxima(PIX *pixs, l_int32 minval);
 
 
 /*-----------------------------------------------------------------------*
@@ -196,8 +255,14 @@ static l_int32 pixQualifyLocalMinima(PIX *pixs, PIX *pixm, l_int32 maxval);
  *      (5) The input seed and mask images can be different sizes, but
  *          in typical use the difference, if any, would be only
  *          a few pixels in each direction.  If the sizes differ,
- *          the clipping is handled by the low-level function
- *          seedfillBinaryLow().
+ *          the clipping is handled by the low-level functions
+ *          seedfillBinaryLow() and seedfillBinaryQueueLow().
+ *      (6) This uses Vincent's hybrid method.  One cycle of raster and
+ *          anti-raster scans does most of the filling, and the fill is
+ *          completed from a FIFO queue of the words that can still
+ *          change.  The scans are done in horizontal strips on the
+ *          default number of threads (see l_setNumThreads()).
+ *          The result does not depend on the number of threads.
  */
 PIX *
 pixSeedfillBinary(PIX     *pixd,
@@ -205,10 +270,8 @@ pixSeedfillBinary(PIX     *pixd,
                   PIX     *pixm,
                   l_int32  connectivity)
 {
-l_int32    i, boolval;
 l_int32    hd, hm, wpld, wplm;
 l_uint32  *datad, *datam;
-PIX       *pixt;
 
     PROCNAME("pixSeedfillBinary");
 
@@ -223,12 +286,8 @@ PIX       *pixt;
     if ((pixd = pixCopy(pixd, pixs)) == NULL)
         return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
 
-        /* pixt is used to test for completion */
-    if ((pixt = pixCreateTemplate(pixs)) == NULL)
-        return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
-
     hd = pixGetHeight(pixd);
-    hm = pixGetHeight(pixm);  /* included so seedfillBinaryLow() can clip */
+    hm = pixGetHeight(pixm);  /* included so the fill can clip */
     datad = pixGetData(pixd);
     datam = pixGetData(pixm);
     wpld = pixGetWpl(pixd);
@@ -236,19 +295,9 @@ PIX       *pixt;
 
     pixSetPadBits(pixm, 0);
 
-    for (i = 0; i < MAX_ITERS; i++) {
-        pixCopy(pixt, pixd);
-        seedfillBinaryLow(datad, hd, wpld, datam, hm, wplm, connectivity);
-        pixEqual(pixd, pixt, &boolval);
-        if (boolval == 1) {
-#if DEBUG_PRINT_ITERS
-            fprintf(stderr, "Binary seed fill converged: %d iters\n", i + 1);
-#endif  /* DEBUG_PRINT_ITERS */
-            break;
-        }
-    }
-
-    pixDestroy(&pixt);
+    if (seedfillInStrips(datad, 0, L_MIN(hd, hm), wpld, datam, wplm,
+                         connectivity, SEEDFILL_BINARY))
+        L_ERROR("fill not completed\n", procName);
     return pixd;
 }
 
@@ -329,6 +378,116 @@ PIX     *pixr, *pixt;
 }
 
 
+/*!
+ *  seedfillInStrips()
+ *
+ *      Input:  datas (seed data; filled in place)
+ *              w (width of seed and mask; not used for binary)
+ *              h (number of lines to fill)
+ *              wpls
+ *              datam (filling mask data)
+ *              wplm
+ *              connectivity  (4 or 8)
+ *              type (SEEDFILL_BINARY, SEEDFILL_GRAY or SEEDFILL_GRAY_INV)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The image is divided into horizontal strips, one for each
+ *          thread, and the seed in each strip is filled as if the strip
+ *          were the entire image.  The fill is then completed over the
+ *          entire image from a FIFO queue: for binary, of all words that
+ *          can still change; for gray, of the pixels next to the strip
+ *          boundaries that can fill across them.
+ *      (2) The filled seed is unique, so the result is the same for
+ *          any number of strips.  With a single thread, there is one
+ *          strip, and only the binary fill needs the final step.
+ */
+static l_int32
+seedfillInStrips(l_uint32  *datas,
+                 l_int32    w,
+                 l_int32    h,
+                 l_int32    wpls,
+                 l_uint32  *datam,
+                 l_int32    wplm,
+                 l_int32    connectivity,
+                 l_int32    type)
+{
+l_int32          i, nthreads, nstrips, ret;
+SEEDFILL_STRIPS  ss;
+
+    PROCNAME("seedfillInStrips");
+
+    nthreads = l_getNumThreads();
+    nstrips = (nthreads == 1) ? 1 :
+              L_MAX(1, L_MIN(nthreads, h / MIN_STRIP_LINES));
+    if ((ss.ystart = (l_int32 *)CALLOC(nstrips + 1, sizeof(l_int32)))
+        == NULL)
+        return ERROR_INT("ystart not made", procName, 1);
+    for (i = 0; i <= nstrips; i++)
+        ss.ystart[i] = (l_int32)(((l_float64)i * h) / nstrips);
+    ss.datas = datas;
+    ss.w = w;
+    ss.wpls = wpls;
+    ss.datam = datam;
+    ss.wplm = wplm;
+    ss.connectivity = connectivity;
+    ss.type = type;
+
+    ret = l_parallelRun(nstrips, seedfillStripJob, &ss, nthreads);
+    if (!ret) {
+        if (type == SEEDFILL_BINARY)
+            seedfillBinaryQueueLow(datas, h, wpls, datam, h, wplm,
+                                   connectivity);
+        else if (type == SEEDFILL_GRAY && nstrips > 1)
+            seedfillGrayBoundaryLow(datas, w, h, wpls, datam, wplm,
+                                    connectivity, ss.ystart, nstrips);
+        else if (type == SEEDFILL_GRAY_INV && nstrips > 1)
+            seedfillGrayInvBoundaryLow(datas, w, h, wpls, datam, wplm,
+                                       connectivity, ss.ystart, nstrips);
+    }
+
+    FREE(ss.ystart);
+    return ret;
+}
+
+
+/*!
+ *  seedfillStripJob()
+ *
+ *      Input:  data (SEEDFILL_STRIPS)
+ *              index (of the strip)
+ *      Return: 0 always
+ *
+ *  Notes:
+ *      (1) This fills the seed within one strip, using the data
+ *          starting at the first line of the strip.
+ */
+static l_int32
+seedfillStripJob(void    *data,
+                 l_int32  index)
+{
+l_int32           y1, nlines;
+l_uint32         *lines, *linem;
+SEEDFILL_STRIPS  *ss;
+
+    ss = (SEEDFILL_STRIPS *)data;
+    y1 = ss->ystart[index];
+    nlines = ss->ystart[index + 1] - y1;
+    lines = ss->datas + y1 * ss->wpls;
+    linem = ss->datam + y1 * ss->wplm;
+    if (ss->type == SEEDFILL_BINARY)
+        seedfillBinaryLow(lines, nlines, ss->wpls, linem, nlines, ss->wplm,
+                          ss->connectivity);
+    else if (ss->type == SEEDFILL_GRAY)
+        seedfillGrayLow(lines, ss->w, nlines, ss->wpls, linem, ss->wplm,
+                        ss->connectivity);
+    else  /* SEEDFILL_GRAY_INV */
+        seedfillGrayInvLow(lines, ss->w, nlines, ss->wpls, linem, ss->wplm,
+                           ss->connectivity);
+    return 0;
+}
+
+
 /*!
  *  pixHolesByFilling()
  *
@@ -652,6 +811,9 @@ PIXA      *pixa;
  *            L. Vincent, Morphological grayscale reconstruction in image
  *            analysis: applications and efficient algorithms, IEEE Transactions
  *            on  Image Processing, vol. 2, no. 2, pp. 176-201, 1993.
+ *      (5) The raster and anti-raster scans are done in horizontal strips
+ *          on the default number of threads, and the fill is completed
+ *          across the strip boundaries; see seedfillInStrips().
  */
 l_int32
 pixSeedfillGray(PIX     *pixs,
@@ -679,9 +841,8 @@ l_uint32  *datas, *datam;
     wpls = pixGetWpl(pixs);
     wplm = pixGetWpl(pixm);
     pixGetDimensions(pixs, &w, &h, NULL);
-    seedfillGrayLow(datas, w, h, wpls, datam, wplm, connectivity);
-
-    return 0;
+    return seedfillInStrips(datas, w, h, wpls, datam, wplm, connectivity,
+                            SEEDFILL_GRAY);
 }
 
 
@@ -709,6 +870,8 @@ l_uint32  *datas, *datam;
  *          where the seed pixel values are generated from the mask,
  *          and where the implementation uses pixSeedfillGray() by
  *          inverting both the seed and mask.
+ *      (4) As with pixSeedfillGray(), the filling is done in strips on
+ *          the default number of threads.
  */
 l_int32
 pixSeedfillGrayInv(PIX     *pixs,
@@ -736,9 +899,8 @@ l_uint32  *datas, *datam;
     wpls = pixGetWpl(pixs);
     wplm = pixGetWpl(pixm);
     pixGetDimensions(pixs, &w, &h, NULL);
-    seedfillGrayInvLow(datas, w, h, wpls, datam, wplm, connectivity);
-
-    return 0;
+    return seedfillInStrips(datas, w, h, wpls, datam, wplm, connectivity,
+                            SEEDFILL_GRAY_INV);
 }
 
 /*-----------------------------------------------------------------------*
@@ -1052,6 +1214,391 @@ PIX       *pixd;
 }
 
 
+/*-----------------------------------------------------------------------*
+ *                   Exact Euclidean distance function                   *
+ *-----------------------------------------------------------------------*/
+/*!
+ *  pixEuclideanDistance()
+ *
+ *      Input:  pixs  (1 bpp source)
+ *              outdepth (8, 16 or 32 bits for pixd)
+ *              squared (1 for the squared distance; 0 for the distance
+ *                       rounded to the nearest integer)
+ *              boundcond (L_BOUNDARY_BG, L_BOUNDARY_FG)
+ *      Return: pixd, or null on error
+ *
+ *  Notes:
+ *      (1) This computes the exact Euclidean distance of each fg pixel
+ *          from the nearest bg pixel.  As with pixDistanceFunction(),
+ *          all bg pixels have a distance of 0, and the distance of each
+ *          pixel from the nearest fg pixel is found by inverting the
+ *          input image first.
+ *      (2) With L_BOUNDARY_BG, the pixels just outside the image are
+ *          taken to be bg, so that the fg pixels on the image boundary
+ *          have a distance of 1.  With L_BOUNDARY_FG, the distance is
+ *          to the nearest bg pixel within the image.  If there are no
+ *          bg pixels at all, the distance is undefined; each pixel is
+ *          then given a value larger than any actual distance.
+ *      (3) With @squared == 1, the squared distance is exact, but it
+ *          saturates at the max value of the output depth; for
+ *          an image of any size, use @outdepth = 32.  The distance
+ *          itself fits in 16 bpp for images up to 65535 pixels on a side.
+ *          Values that do not fit in @outdepth are clipped to the max.
+ *      (4) See pixEuclideanDistanceSquared() for the method.
+ */
+PIX *
+pixEuclideanDistance(PIX     *pixs,
+                     l_int32  outdepth,
+                     l_int32  squared,
+                     l_int32  boundcond)
+{
+l_int32    i, j, w, h, wpld, wpls;
+l_uint32   val, maxval;
+l_uint32  *datad, *datas, *lined, *lines;
+PIX       *pixt, *pixd;
+
+    PROCNAME("pixEuclideanDistance");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("!pixs or pixs not 1 bpp", procName, NULL);
+    if (outdepth != 8 && outdepth != 16 && outdepth != 32)
+        return (PIX *)ERROR_PTR("outdepth not 8, 16 or 32 bpp",
+                                procName, NULL);
+    if (boundcond != L_BOUNDARY_BG && boundcond != L_BOUNDARY_FG)
+        return (PIX *)ERROR_PTR("invalid boundcond", procName, NULL);
+
+    if ((pixt = pixEuclideanDistanceSquared(pixs, boundcond)) == NULL)
+        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+    if (outdepth == 32 && squared)
+        return pixt;
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if ((pixd = pixCreate(w, h, outdepth)) == NULL) {
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    }
+    pixCopyResolution(pixd, pixs);
+    maxval = (outdepth == 8) ? 0xff : ((outdepth == 16) ? 0xffff :
+             0xffffffff);
+    datas = pixGetData(pixt);
+    wpls = pixGetWpl(pixt);
+    datad = pixGetData(pixd);
+    wpld = pixGetWpl(pixd);
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        lined = datad + i * wpld;
+        for (j = 0; j < w; j++) {
+            val = lines[j];
+            if (!squared)
+                val = (l_uint32)(sqrt((l_float64)val) + 0.5);
+            val = L_MIN(val, maxval);
+            if (outdepth == 8)
+                SET_DATA_BYTE(lined, j, val);
+            else if (outdepth == 16)
+                SET_DATA_TWO_BYTES(lined, j, val);
+            else  /* 32 */
+                lined[j] = val;
+        }
+    }
+
+    pixDestroy(&pixt);
+    return pixd;
+}
+
+
+/*!
+ *  pixEuclideanDistanceFPix()
+ *
+ *      Input:  pixs  (1 bpp source)
+ *              boundcond (L_BOUNDARY_BG, L_BOUNDARY_FG)
+ *      Return: fpixd (Euclidean distance), or null on error
+ *
+ *  Notes:
+ *      (1) This gives the exact Euclidean distance of each fg pixel
+ *          from the nearest bg pixel, without rounding.
+ *          See pixEuclideanDistance() for details.
+ */
+FPIX *
+pixEuclideanDistanceFPix(PIX     *pixs,
+                         l_int32  boundcond)
+{
+l_int32     i, j, w, h, wpls, wpld;
+l_uint32   *datas, *lines;
+l_float32  *datad, *lined;
+FPIX       *fpixd;
+PIX        *pixt;
+
+    PROCNAME("pixEuclideanDistanceFPix");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (FPIX *)ERROR_PTR("!pixs or pixs not 1 bpp", procName, NULL);
+    if (boundcond != L_BOUNDARY_BG && boundcond != L_BOUNDARY_FG)
+        return (FPIX *)ERROR_PTR("invalid boundcond", procName, NULL);
+
+    if ((pixt = pixEuclideanDistanceSquared(pixs, boundcond)) == NULL)
+        return (FPIX *)ERROR_PTR("pixt not made", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if ((fpixd = fpixCreate(w, h)) == NULL) {
+        pixDestroy(&pixt);
+        return (FPIX *)ERROR_PTR("fpixd not made", procName, NULL);
+    }
+    datas = pixGetData(pixt);
+    wpls = pixGetWpl(pixt);
+    datad = fpixGetData(fpixd);
+    wpld = fpixGetWpl(fpixd);
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        lined = datad + i * wpld;
+        for (j = 0; j < w; j++)
+            lined[j] = (l_float32)sqrt((l_float64)lines[j]);
+    }
+
+    pixDestroy(&pixt);
+    return fpixd;
+}
+
+
+/*!
+ *  pixEuclideanDistanceSquared()
+ *
+ *      Input:  pixs  (1 bpp source)
+ *              boundcond (L_BOUNDARY_BG, L_BOUNDARY_FG)
+ *      Return: pixd (32 bpp squared distance), or null on error
+ *
+ *  Notes:
+ *      (1) This is the separable algorithm of Meijster, Roerdink and
+ *          Hesselink (also Felzenszwalb and Huttenlocher), which is
+ *          exact and takes time linear in the number of pixels.
+ *          In the first pass, each column is swept down and then up to
+ *          find the distance g to the nearest bg pixel in that column.
+ *          In the second pass, for each row, the squared distance at x
+ *          is the minimum over all columns i of (x - i)^2 + g(i)^2;
+ *          the minimum is found from the lower envelope of these
+ *          parabolas, which is built in one sweep along the row.
+ *      (2) The columns in the first pass, and the rows in the second,
+ *          are independent.  Each pass is split into bands that are
+ *          done in parallel; the result does not depend on the number
+ *          of threads.
+ *      (3) Values that would exceed 32 bits, which occur only
+ *          for huge images, are clipped to 0xffffffff.
+ */
+PIX *
+pixEuclideanDistanceSquared(PIX     *pixs,
+                            l_int32  boundcond)
+{
+l_int32    w, h, nthreads, ret;
+EDT_BANDS  eb;
+PIX       *pixd;
+
+    PROCNAME("pixEuclideanDistanceSquared");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("!pixs or pixs not 1 bpp", procName, NULL);
+    if (boundcond != L_BOUNDARY_BG && boundcond != L_BOUNDARY_FG)
+        return (PIX *)ERROR_PTR("invalid boundcond", procName, NULL);
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    if ((pixd = pixCreate(w, h, 32)) == NULL)
+        return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+    pixCopyResolution(pixd, pixs);
+    eb.datas = pixGetData(pixs);
+    eb.wpls = pixGetWpl(pixs);
+    eb.w = w;
+    eb.h = h;
+    eb.datad = pixGetData(pixd);  /* wpl == w for 32 bpp */
+    eb.boundcond = boundcond;
+
+        /* Distances in each column, then squared distances in each row */
+    nthreads = l_getNumThreads();
+    eb.nbands = (nthreads == 1) ? 1 :
+                L_MAX(1, L_MIN(nthreads, w / MIN_EDT_BAND));
+    ret = l_parallelRun(eb.nbands, edtColumnJob, &eb, nthreads);
+    if (!ret) {
+        eb.nbands = (nthreads == 1) ? 1 :
+                    L_MAX(1, L_MIN(nthreads, h / MIN_EDT_BAND));
+        ret = l_parallelRun(eb.nbands, edtRowJob, &eb, nthreads);
+    }
+    if (ret) {
+        pixDestroy(&pixd);
+        return (PIX *)ERROR_PTR("distance not made", procName, NULL);
+    }
+
+    return pixd;
+}
+
+
+/*!
+ *  edtColumnJob()
+ *
+ *      Input:  data (EDT_BANDS)
+ *              index (of the band of columns)
+ *      Return: 0 always
+ *
+ *  Notes:
+ *      (1) For each column in the band, this finds the distance
+ *          to the nearest bg pixel in the column.  The lines are
+ *          traversed in the outer loop, for locality in memory.
+ *      (2) Where there is no bg pixel in the column, the distance is
+ *          set to w + h, which is larger than any distance in the image.
+ */
+static l_int32
+edtColumnJob(void    *data,
+             l_int32  index)
+{
+l_int32     i, j, x1, x2, w, h, wpls;
+l_uint32    inf, init, val;
+l_uint32   *datas, *lines, *lined, *linep;
+EDT_BANDS  *eb;
+
+    eb = (EDT_BANDS *)data;
+    linep = NULL;
+    w = eb->w;
+    h = eb->h;
+    datas = eb->datas;
+    wpls = eb->wpls;
+    x1 = (l_int32)(((l_float64)index * w) / eb->nbands);
+    x2 = (l_int32)(((l_float64)(index + 1) * w) / eb->nbands);
+    inf = w + h;
+    init = (eb->boundcond == L_BOUNDARY_BG) ? 1 : inf;
+
+        /* Down, from the top boundary and the bg pixels above */
+    for (i = 0; i < h; i++) {
+        lines = datas + i * wpls;
+        lined = eb->datad + i * w;
+        if (i > 0)
+            linep = lined - w;
+        for (j = x1; j < x2; j++) {
+            if (!GET_DATA_BIT(lines, j)) {
+                lined[j] = 0;
+            } else {
+                val = (i == 0) ? init : linep[j] + 1;
+                lined[j] = L_MIN(val, inf);
+            }
+        }
+    }
+
+        /* Up, from the bottom boundary and the bg pixels below */
+    for (i = h - 1; i >= 0; i--) {
+        lined = eb->datad + i * w;
+        if (i < h - 1)
+            linep = lined + w;
+        for (j = x1; j < x2; j++) {
+            val = (i == h - 1) ? init : linep[j] + 1;
+            if (val < lined[j])
+                lined[j] = val;
+        }
+    }
+
+    return 0;
+}
+
+
+/*!
+ *  edtRowJob()
+ *
+ *      Input:  data (EDT_BANDS)
+ *              index (of the band of rows)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) For each row in the band, this replaces the column distances
+ *          g(i) by the squared distance min_i ((x - i)^2 + g(i)^2).
+ *      (2) Each column i is a site with the parabola (x - i)^2 + g(i)^2.
+ *          The sites that are lowest somewhere in [0, w) are kept on
+ *          a stack @s, with @t holding the first x where each one is
+ *          lowest.  With L_BOUNDARY_BG, there are also sites with
+ *          g = 0 at x = -1 and x = w, for the bg outside the image.
+ *      (3) Site i is stored at index i - @xs in @s and @gsq.
+ */
+static l_int32
+edtRowJob(void    *data,
+          l_int32  index)
+{
+l_int32     i, k, q, x, y, y1, y2, w, xs, xe;
+l_int32    *s, *t;
+l_uint32   *lined;
+l_int64     num, den, dist;
+l_int64    *gsq;
+EDT_BANDS  *eb;
+
+    PROCNAME("edtRowJob");
+
+    eb = (EDT_BANDS *)data;
+    w = eb->w;
+    y1 = (l_int32)(((l_float64)index * eb->h) / eb->nbands);
+    y2 = (l_int32)(((l_float64)(index + 1) * eb->h) / eb->nbands);
+    xs = (eb->boundcond == L_BOUNDARY_BG) ? -1 : 0;  /* first site */
+    xe = (eb->boundcond == L_BOUNDARY_BG) ? w : w - 1;  /* last site */
+    s = (l_int32 *)CALLOC(w + 2, sizeof(l_int32));
+    t = (l_int32 *)CALLOC(w + 2, sizeof(l_int32));
+    gsq = (l_int64 *)CALLOC(w + 2, sizeof(l_int64));
+    if (!s || !t || !gsq) {
+        FREE(s);
+        FREE(t);
+        FREE(gsq);
+        return ERROR_INT("arrays not made", procName, 1);
+    }
+
+    for (y = y1; y < y2; y++) {
+        lined = eb->datad + y * w;
+        for (i = 0; i < w; i++)
+            gsq[i - xs] = (l_int64)lined[i] * lined[i];
+        if (xs < 0) {  /* bg sites outside the image */
+            gsq[0] = 0;
+            gsq[w + 1] = 0;
+        }
+
+            /* Build the lower envelope of the parabolas.  The site
+             * at the top of the stack is removed if the new site is
+             * lower where the top site starts to be lowest.  Otherwise,
+             * the new site is pushed if it becomes lowest within the
+             * row, at x = 1 + floor(sep), where sep is the
+             * intersection of the two parabolas. */
+        q = 0;
+        s[0] = xs;
+        t[0] = 0;
+        for (i = xs + 1; i <= xe; i++) {
+            while (q >= 0 &&
+                   (l_int64)(t[q] - s[q]) * (t[q] - s[q]) + gsq[s[q] - xs] >
+                   (l_int64)(t[q] - i) * (t[q] - i) + gsq[i - xs])
+                q--;
+            if (q < 0) {
+                q = 0;
+                s[0] = i;
+                t[0] = 0;
+                continue;
+            }
+            k = s[q];
+            num = (l_int64)i * i - (l_int64)k * k + gsq[i - xs] - gsq[k - xs];
+            den = 2 * (i - k);
+            if (num >= 0)
+                dist = num / den;
+            else
+                dist = -((-num + den - 1) / den);  /* floor */
+            if (dist + 1 < w) {
+                q++;
+                s[q] = i;
+                t[q] = (l_int32)dist + 1;
+            }
+        }
+
+            /* Evaluate the envelope, from the right */
+        for (x = w - 1; x >= 0; x--) {
+            k = s[q];
+            dist = (l_int64)(x - k) * (x - k) + gsq[k - xs];
+            lined[x] = (dist > 0xffffffff) ? 0xffffffff : (l_uint32)dist;
+            if (x == t[q])
+                q--;
+        }
+    }
+
+    FREE(s);
+    FREE(t);
+    FREE(gsq);
+    return 0;
+}
+
+
 /*-----------------------------------------------------------------------*
  *                Seed spread (based on distance function)               *
  *-----------------------------------------------------------------------*/
@@ -1165,19 +1712,18 @@ PIX       *pixm, *pixt, *pixg, *pixd;
  *          maximum.  For the local minima, @maxmin is the upper
  *          bound for the value of pixs.  Likewise, for the local maxima,
  *          @minmax is the lower bound for the value of pixs.
- *      (2) The minima are found by starting with the erosion-and-equality
- *          approach of pixSelectedLocalExtrema().  This is followed
- *          by a qualification step, where each c.c. in the resulting
- *          minimum mask is extracted, the pixels bordering it are
- *          located, and they are queried.  If all of those pixels
- *          are larger than the value of that minimum, it is a true
- *          minimum and its c.c. is saved; otherwise the c.c. is
- *          rejected.  Note that if a bordering pixel has the
- *          same value as the minimum, it must then have a
- *          neighbor that is smaller, so the component is not a
- *          true minimum.
- *      (3) The maxima are found by inverting the image and looking
- *          for the minima there.
+ *      (2) These are the regional extrema: 8-connected sets of pixels
+ *          with the same value, where all pixels bordering the set
+ *          are larger (for a minimum) or smaller (for a maximum).
+ *      (3) The maxima are found with a grayscale reconstruction, as the
+ *          pixels where pixHDome() with a height of 1 is not zero:
+ *          a pixel is not in a maximum if there is a path to a larger
+ *          pixel that doesn't go below it, and then the fill from the
+ *          image reduced by 1 restores its value.  The minima are the
+ *          maxima of the inverted image.  This uses the hybrid gray
+ *          seedfill, and replaces a qualification of each c.c. of the
+ *          erosion-and-equality mask, which was slower and also accepted
+ *          any c.c. touching the top or left side of the image.
  *      (4) The generated masks can be used as markers for
  *          further operations.
  */
@@ -1188,7 +1734,7 @@ pixLocalExtrema(PIX     *pixs,
                 PIX    **ppixmin,
                 PIX    **ppixmax)
 {
-PIX  *pixmin, *pixmax, *pixt1, *pixt2;
+PIX  *pixt;
 
     PROCNAME("pixLocalExtrema");
 
@@ -1200,122 +1746,46 @@ PIX  *pixmin, *pixmax, *pixt1, *pixt2;
     if (minmax <= 0) minmax = 1;
 
     if (ppixmin) {
-        pixt1 = pixErodeGray(pixs, 3, 3);
-        pixmin = pixFindEqualValues(pixs, pixt1);
-        pixDestroy(&pixt1);
-        pixQualifyLocalMinima(pixs, pixmin, maxmin);
-        *ppixmin = pixmin;
+        pixt = pixInvert(NULL, pixs);
+        *ppixmin = pixLocalMaxima(pixt, 255 - maxmin);
+        pixDestroy(&pixt);
     }
 
-    if (ppixmax) {
-        pixt1 = pixInvert(NULL, pixs);
-        pixt2 = pixErodeGray(pixt1, 3, 3);
-        pixmax = pixFindEqualValues(pixt1, pixt2);
-        pixDestroy(&pixt2);
-        pixQualifyLocalMinima(pixt1, pixmax, 255 - minmax);
-        *ppixmax = pixmax;
-        pixDestroy(&pixt1);
-    }
+    if (ppixmax)
+        *ppixmax = pixLocalMaxima(pixs, minmax);
 
     return 0;
 }
 
 
 /*!
- *  pixQualifyLocalMinima()
+ *  pixLocalMaxima()
  *
- *      Input:  pixs  (8 bpp image from which pixm has been extracted)
- *              pixm  (1 bpp mask of values equal to min in 3x3 neighborhood)
- *              maxval (max allowed for the min in a 3x3 neighborhood;
- *                      use 0 for default which is to have no upper bound)
- *      Return: 0 if OK, 1 on error
+ *      Input:  pixs  (8 bpp)
+ *              minval (min allowed value for a maximum; >= 1)
+ *      Return: pixd (1 bpp mask of the regional maxima), or null on error
  *
  *  Notes:
- *      (1) This function acts in-place to remove all c.c. in pixm
- *          that are not true local minima in pixs.  As seen in
- *          pixLocalExtrema(), the input pixm are found by selecting those
- *          pixels of pixs whose values do not change with a 3x3
- *          grayscale erosion.  Here, we require that for each c.c.
- *          in pixm, all pixels in pixs that correspond to the exterior
- *          boundary pixels of the c.c. have values that are greater
- *          than the value within the c.c.
- *      (2) The maximum allowed value for each local minimum can be
- *          bounded with @maxval.  Use 0 for default, which is to have
- *          no upper bound (equivalent to maxval == 254).
+ *      (1) See pixLocalExtrema().  The mask is the fg of the h-dome
+ *          of height 1, for pixels with values at least @minval.
  */
-static l_int32
-pixQualifyLocalMinima(PIX     *pixs,
-                      PIX     *pixm,
-                      l_int32  maxval)
+static PIX *
+pixLocalMaxima(PIX     *pixs,
+               l_int32  minval)
 {
-l_int32    n, i, j, k, x, y, w, h, xc, yc, wc, hc, xon, yon;
-l_int32    vals, wpls, wplc, ismin;
-l_uint32   val;
-l_uint32  *datas, *datac, *lines, *linec;
-BOXA      *boxa;
-PIX       *pixt1, *pixt2, *pixc;
-PIXA      *pixa;
+PIX  *pixt, *pixd;
 
-    PROCNAME("pixQualifyLocalMinima");
-
-    if (!pixs || pixGetDepth(pixs) != 8)
-        return ERROR_INT("pixs not defined or not 8 bpp", procName, 1);
-    if (!pixm || pixGetDepth(pixm) != 1)
-        return ERROR_INT("pixm not defined or not 1 bpp", procName, 1);
-    if (maxval <= 0) maxval = 254;
-
-    pixGetDimensions(pixs, &w, &h, NULL);
-    datas = pixGetData(pixs);
-    wpls = pixGetWpl(pixs);
-    boxa = pixConnComp(pixm, &pixa, 8);
-    n = pixaGetCount(pixa);
-    for (k = 0; k < n; k++) {
-        boxaGetBoxGeometry(boxa, k, &xc, &yc, &wc, &hc);
-        pixt1 = pixaGetPix(pixa, k, L_COPY);
-        pixt2 = pixAddBorder(pixt1, 1, 0);
-        pixc = pixDilateBrick(NULL, pixt2, 3, 3);
-        pixXor(pixc, pixc, pixt2);  /* exterior boundary pixels */
-        datac = pixGetData(pixc);
-        wplc = pixGetWpl(pixc);
-        nextOnPixelInRaster(pixt1, 0, 0, &xon, &yon);
-        pixGetPixel(pixs, xc + xon, yc + yon, &val);
-        if (val > maxval) {  /* too large; erase */
-            pixRasterop(pixm, xc, yc, wc, hc, PIX_XOR, pixt1, 0, 0);
-            pixDestroy(&pixt1);
-            pixDestroy(&pixt2);
-            pixDestroy(&pixc);
-            continue;
-        }
-        ismin = TRUE;
-
-            /* Check all values in pixs that correspond to the exterior
-             * boundary pixels of the c.c. in pixm.  Verify that the
-             * value in the c.c. is always less. */
-        for (i = 0, y = yc - 1; i < hc + 2 && y >= 0 && y < h; i++, y++) {
-            lines = datas + y * wpls;
-            linec = datac + i * wplc;
-            for (j = 0, x = xc - 1; j < wc + 2 && x >= 0 && x < w; j++, x++) {
-                if (GET_DATA_BIT(linec, j)) {
-                    vals = GET_DATA_BYTE(lines, x);
-                    if (vals <= val) {  /* not a minimum! */
-                        ismin = FALSE;
-                        break;
-                    }
-                }
-            }
-            if (!ismin)
-                break;
-        }
-        if (!ismin)  /* erase it */
-            pixRasterop(pixm, xc, yc, wc, hc, PIX_XOR, pixt1, 0, 0);
-        pixDestroy(&pixt1);
-        pixDestroy(&pixt2);
-        pixDestroy(&pixc);
-    }
+    PROCNAME("pixLocalMaxima");
 
-    boxaDestroy(&boxa);
-    pixaDestroy(&pixa);
-    return 0;
+    if ((pixt = pixHDome(pixs, 1, 8)) == NULL)
+        return (PIX *)ERROR_PTR("pixt not made", procName, NULL);
+    pixd = pixThresholdToBinary(pixt, 1);  /* fg where not a maximum */
+    pixDestroy(&pixt);
+    pixt = pixThresholdToBinary(pixs, minval);  /* fg where too small */
+    pixOr(pixd, pixd, pixt);
+    pixInvert(pixd, pixd);
+    pixDestroy(&pixt);
+    return pixd;
 }
 
 
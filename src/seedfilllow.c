@@ -30,8 +30,11 @@
  *      Seedfill:
  *      Gray seedfill (source: Luc Vincent:fast-hybrid-grayscale-reconstruction)
  *               void   seedfillBinaryLow()
+ *               void   seedfillBinaryQueueLow()
  *               void   seedfillGrayLow()
  *               void   seedfillGrayInvLow()
+ *               void   seedfillGrayBoundaryLow()
+ *               void   seedfillGrayInvBoundaryLow()
  *               void   seedfillGrayLowSimple()
  *               void   seedfillGrayInvLowSimple()
  *
@@ -53,6 +56,39 @@ struct L_Pixel
 };
 typedef struct L_Pixel  L_PIXEL;
 
+    /* FIFO of pixel (or word) locations, in a ring buffer */
+struct L_PixelFifo
+{
+    L_PIXEL   *array;      /* ring buffer of locations                   */
+    l_int32    nalloc;     /* size of the ring buffer                    */
+    l_int32    head;       /* index of the first location in the fifo    */
+    l_int32    n;          /* number of locations in the fifo            */
+};
+typedef struct L_PixelFifo  L_PIXELFIFO;
+
+static L_PIXELFIFO *pixelFifoCreate(l_int32 nalloc);
+static void pixelFifoDestroy(L_PIXELFIFO **pfifo);
+static l_int32 pixelFifoAdd(L_PIXELFIFO *fifo, l_int32 i, l_int32 j);
+static l_int32 pixelFifoRemove(L_PIXELFIFO *fifo, l_int32 *pi, l_int32 *pj);
+static l_uint32 seedfillBinaryWord(l_uint32 *datas, l_int32 h, l_int32 wpl,
+                                   l_int32 wpls, l_uint32 *datam,
+                                   l_int32 wplm, l_int32 connectivity,
+                                   l_int32 i, l_int32 j);
+static void seedfillGrayPropagateLow(l_uint32 *datas, l_int32 w, l_int32 h,
+                                     l_int32 wpls, l_uint32 *datam,
+                                     l_int32 wplm, l_int32 connectivity,
+                                     L_PIXELFIFO *fifo);
+static void seedfillGrayInvPropagateLow(l_uint32 *datas, l_int32 w,
+                                        l_int32 h, l_int32 wpls,
+                                        l_uint32 *datam, l_int32 wplm,
+                                        l_int32 connectivity,
+                                        L_PIXELFIFO *fifo);
+static void seedfillGrayQueueBoundaries(l_uint32 *datas, l_int32 w,
+                                        l_int32 wpls, l_uint32 *datam,
+                                        l_int32 wplm, l_int32 connectivity,
+                                        l_int32 *ystart, l_int32 nstrips,
+                                        l_int32 inv, L_PIXELFIFO *fifo);
+
 
 /*-----------------------------------------------------------------------*
  *                 Vincent's Iterative Binary Seedfill                   *
@@ -257,6 +293,154 @@ l_uint32  *lines, *linem;
 
 
 
+/*!
+ *  seedfillBinaryQueueLow()
+ *
+ *  Notes:
+ *      (1) This completes an in-place binary fill, after one cycle of
+ *          raster and anti-raster scans with seedfillBinaryLow() has
+ *          done most of the filling.  It is the binary version of the
+ *          hybrid method used in seedfillGrayLow().
+ *      (2) The queue holds 32-bit words rather than pixels.  Every word
+ *          that can still be filled from its neighbors is filled, in
+ *          the same way as in seedfillBinaryLow(), and when a word
+ *          changes, the neighboring words are put in the FIFO queue.
+ *          The fill is complete when the queue is empty, so unlike
+ *          iterating seedfillBinaryLow(), there is no test image and
+ *          no limit on the number of iterations.
+ *      (3) As in seedfillBinaryLow(), the mask is a filling mask with
+ *          its RHS pad bits set to 0, and the sizes are clipped to the
+ *          smaller of the seed and mask.
+ */
+void
+seedfillBinaryQueueLow(l_uint32  *datas,
+                       l_int32    hs,
+                       l_int32    wpls,
+                       l_uint32  *datam,
+                       l_int32    hm,
+                       l_int32    wplm,
+                       l_int32    connectivity)
+{
+l_int32       i, j, h, wpl, ii, jj;
+l_uint32      word;
+L_PIXELFIFO  *fifo;
+
+    PROCNAME("seedfillBinaryQueueLow");
+
+    if (connectivity != 4 && connectivity != 8) {
+        L_ERROR("connectivity must be 4 or 8\n", procName);
+        return;
+    }
+
+    h = L_MIN(hs, hm);
+    wpl = L_MIN(wpls, wplm);
+    if ((fifo = pixelFifoCreate(2 * (wpl + h))) == NULL) {
+        L_ERROR("fifo not made\n", procName);
+        return;
+    }
+
+        /* Fill every word that can still be filled from its neighbors,
+         * and queue the neighbors of the words that change */
+    for (i = 0; i < h; i++) {
+        for (j = 0; j < wpl; j++) {
+            word = seedfillBinaryWord(datas, h, wpl, wpls, datam, wplm,
+                                      connectivity, i, j);
+            if (word == *(datas + i * wpls + j))
+                continue;
+            *(datas + i * wpls + j) = word;
+            for (ii = L_MAX(0, i - 1); ii <= L_MIN(h - 1, i + 1); ii++) {
+                for (jj = L_MAX(0, j - 1); jj <= L_MIN(wpl - 1, j + 1); jj++) {
+                    if (connectivity == 4 && ii != i && jj != j)
+                        continue;
+                    if (ii != i || jj != j)
+                        pixelFifoAdd(fifo, ii, jj);
+                }
+            }
+        }
+    }
+
+        /* Propagation step: fill the queued words until none changes */
+    while (fifo->n > 0) {
+        pixelFifoRemove(fifo, &i, &j);
+        word = seedfillBinaryWord(datas, h, wpl, wpls, datam, wplm,
+                                  connectivity, i, j);
+        if (word == *(datas + i * wpls + j))
+            continue;
+        *(datas + i * wpls + j) = word;
+        for (ii = L_MAX(0, i - 1); ii <= L_MIN(h - 1, i + 1); ii++) {
+            for (jj = L_MAX(0, j - 1); jj <= L_MIN(wpl - 1, j + 1); jj++) {
+                if (connectivity == 4 && ii != i && jj != j)
+                    continue;
+                if (ii != i || jj != j)
+                    pixelFifoAdd(fifo, ii, jj);
+            }
+        }
+    }
+
+    pixelFifoDestroy(&fifo);
+    return;
+}
+
+
+/*!
+ *  seedfillBinaryWord()
+ *
+ *      Input:  datas, h, wpl, wpls, datam, wplm, connectivity
+ *              i, j (line and word in the line)
+ *      Return: the word at (i, j), filled from its neighbors and
+ *              clipped to the mask
+ */
+static l_uint32
+seedfillBinaryWord(l_uint32  *datas,
+                   l_int32    h,
+                   l_int32    wpl,
+                   l_int32    wpls,
+                   l_uint32  *datam,
+                   l_int32    wplm,
+                   l_int32    connectivity,
+                   l_int32    i,
+                   l_int32    j)
+{
+l_int32    k;
+l_uint32   word, wordprev, mask, wordnb;
+l_uint32  *lines, *linen;
+
+    lines = datas + i * wpls;
+    mask = *(datam + i * wplm + j);
+    word = *(lines + j);
+    if (j > 0)
+        word |= *(lines + j - 1) << 31;
+    if (j < wpl - 1)
+        word |= *(lines + j + 1) >> 31;
+    for (k = -1; k <= 1; k += 2) {  /* lines above and below */
+        if (i + k < 0 || i + k >= h)
+            continue;
+        linen = lines + k * wpls;
+        wordnb = *(linen + j);
+        word |= wordnb;
+        if (connectivity == 8) {
+            word |= (wordnb << 1) | (wordnb >> 1);
+            if (j > 0)
+                word |= *(linen + j - 1) << 31;
+            if (j < wpl - 1)
+                word |= *(linen + j + 1) >> 31;
+        }
+    }
+    word &= mask;
+
+        /* Fill horizontally within the word */
+    if (!word || !(~word))
+        return word;
+    while (1) {
+        wordprev = word;
+        word = (word | (word >> 1) | (word << 1)) & mask;
+        if ((word ^ wordprev) == 0)
+            return word;
+    }
+}
+
+
+
 /*-----------------------------------------------------------------------*
  *                 Vincent's Hybrid Grayscale Seedfill                *
  *-----------------------------------------------------------------------*/
@@ -314,12 +498,11 @@ seedfillGrayLow(l_uint32  *datas,
                 l_int32    wplm,
                 l_int32    connectivity)
 {
-l_uint8    val1, val2, val3, val4, val5, val6, val7, val8;
-l_uint8    val, maxval, maskval, boolval;
-l_int32    i, j, imax, jmax, queue_size;
-l_uint32  *lines, *linem;
-L_PIXEL *pixel;
-L_QUEUE  *lq_pixel;
+l_uint8        val2, val3, val4, val5, val6, val7, val8;
+l_uint8        val, maxval, maskval, boolval;
+l_int32        i, j, imax, jmax;
+l_uint32      *lines, *linem;
+L_PIXELFIFO   *fifo;
 
     PROCNAME("seedfillGrayLow");
 
@@ -333,9 +516,12 @@ L_QUEUE  *lq_pixel;
 
         /* In the worst case, most of the pixels could be pushed
          * onto the FIFO queue during anti-raster scan.  However this
-         * will rarely happen, and we initialize the queue ptr size to
-         * the image perimeter. */
-    lq_pixel = lqueueCreate(2 * (w + h));
+         * will rarely happen, and we initialize the queue size to
+         * the image perimeter.  It is enlarged as required. */
+    if ((fifo = pixelFifoCreate(2 * (w + h))) == NULL) {
+        L_ERROR("fifo not made\n", procName);
+        return;
+    }
 
     switch (connectivity)
     {
@@ -408,85 +594,12 @@ L_QUEUE  *lq_pixel;
                         }
                     }
                     if (boolval) {
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j);
                     }
                 }
             }
         }
 
-            /* Propagation step:
-             *        while fifo_empty = false
-             *          p <- fifo_first()
-             *          for every pixel (q) belong to neighbors of (p)
-             *            if J(q) < J(p) and I(q) != J(q)
-             *              J(q) <- min(J(p), I(q));
-             *              fifo_add(q);
-             *            end
-             *          end
-             *        end */
-        queue_size = lqueueGetCount(lq_pixel);
-        while (queue_size) {
-            pixel = (L_PIXEL *)lqueueRemove(lq_pixel);
-            i = pixel->x;
-            j = pixel->y;
-            FREE(pixel);
-            lines = datas + i * wpls;
-            linem = datam + i * wplm;
-
-            if ((val = GET_DATA_BYTE(lines, j)) > 0) {
-                if (i > 0) {
-                    val2 = GET_DATA_BYTE(lines - wpls, j);
-                    maskval = GET_DATA_BYTE(linem - wplm, j);
-                    if (val > val2 && val2 != maskval) {
-                        SET_DATA_BYTE(lines - wpls, j, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i - 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-
-                }
-                if (j > 0) {
-                    val4 = GET_DATA_BYTE(lines, j - 1);
-                    maskval = GET_DATA_BYTE(linem, j - 1);
-                    if (val > val4 && val4 != maskval) {
-                        SET_DATA_BYTE(lines, j - 1, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j - 1;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-                }
-                if (i < imax) {
-                    val7 = GET_DATA_BYTE(lines + wpls, j);
-                    maskval = GET_DATA_BYTE(linem + wplm, j);
-                    if (val > val7 && val7 != maskval) {
-                        SET_DATA_BYTE(lines + wpls, j, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i + 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-                }
-                if (j < jmax) {
-                    val5 = GET_DATA_BYTE(lines, j + 1);
-                    maskval = GET_DATA_BYTE(linem, j + 1);
-                    if (val > val5 && val5 != maskval) {
-                        SET_DATA_BYTE(lines, j + 1, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j + 1;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-                }
-            }
-
-            queue_size = lqueueGetCount(lq_pixel);
-        }
-
         break;
 
     case 8:
@@ -588,15 +701,58 @@ L_QUEUE  *lq_pixel;
                         }
                     }
                     if (boolval) {
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j);
                     }
                 }
             }
         }
 
+        break;
+
+    default:
+        L_ERROR("shouldn't get here!\n", procName);
+        break;
+    }
+
+    seedfillGrayPropagateLow(datas, w, h, wpls, datam, wplm, connectivity,
+                             fifo);
+    pixelFifoDestroy(&fifo);
+    return;
+}
+
+
+/*!
+ *  seedfillGrayPropagateLow()
+ *
+ *  Notes:
+ *      (1) This is the propagation step of seedfillGrayLow().  Starting from
+ *          the pixels in @fifo, it is a breadth-first fill to completion.
+ *          It is also used to complete the fill across the boundaries
+ *          of strips that were filled separately.
+ */
+static void
+seedfillGrayPropagateLow(l_uint32     *datas,
+                         l_int32       w,
+                         l_int32       h,
+                         l_int32       wpls,
+                         l_uint32     *datam,
+                         l_int32       wplm,
+                         l_int32       connectivity,
+                         L_PIXELFIFO  *fifo)
+{
+l_uint8    val1, val2, val3, val4, val5, val6, val7, val8;
+l_uint8    val, maskval;
+l_int32    i, j, imax, jmax, queue_size;
+l_uint32  *lines, *linem;
+
+    PROCNAME("seedfillGrayPropagateLow");
+
+    imax = h - 1;
+    jmax = w - 1;
+
+    switch (connectivity)
+    {
+    case 4:
             /* Propagation step:
              *        while fifo_empty = false
              *          p <- fifo_first()
@@ -607,12 +763,67 @@ L_QUEUE  *lq_pixel;
              *            end
              *          end
              *        end */
-        queue_size = lqueueGetCount(lq_pixel);
+        queue_size = fifo->n;
         while (queue_size) {
-            pixel = (L_PIXEL *)lqueueRemove(lq_pixel);
-            i = pixel->x;
-            j = pixel->y;
-            FREE(pixel);
+            pixelFifoRemove(fifo, &i, &j);
+            lines = datas + i * wpls;
+            linem = datam + i * wplm;
+
+            if ((val = GET_DATA_BYTE(lines, j)) > 0) {
+                if (i > 0) {
+                    val2 = GET_DATA_BYTE(lines - wpls, j);
+                    maskval = GET_DATA_BYTE(linem - wplm, j);
+                    if (val > val2 && val2 != maskval) {
+                        SET_DATA_BYTE(lines - wpls, j, L_MIN(val, maskval));
+                        pixelFifoAdd(fifo, i - 1, j);
+                    }
+
+                }
+                if (j > 0) {
+                    val4 = GET_DATA_BYTE(lines, j - 1);
+                    maskval = GET_DATA_BYTE(linem, j - 1);
+                    if (val > val4 && val4 != maskval) {
+                        SET_DATA_BYTE(lines, j - 1, L_MIN(val, maskval));
+                        pixelFifoAdd(fifo, i, j - 1);
+                    }
+                }
+                if (i < imax) {
+                    val7 = GET_DATA_BYTE(lines + wpls, j);
+                    maskval = GET_DATA_BYTE(linem + wplm, j);
+                    if (val > val7 && val7 != maskval) {
+                        SET_DATA_BYTE(lines + wpls, j, L_MIN(val, maskval));
+                        pixelFifoAdd(fifo, i + 1, j);
+                    }
+                }
+                if (j < jmax) {
+                    val5 = GET_DATA_BYTE(lines, j + 1);
+                    maskval = GET_DATA_BYTE(linem, j + 1);
+                    if (val > val5 && val5 != maskval) {
+                        SET_DATA_BYTE(lines, j + 1, L_MIN(val, maskval));
+                        pixelFifoAdd(fifo, i, j + 1);
+                    }
+                }
+            }
+
+            queue_size = fifo->n;
+        }
+
+        break;
+
+    case 8:
+            /* Propagation step:
+             *        while fifo_empty = false
+             *          p <- fifo_first()
+             *          for every pixel (q) belong to neighbors of (p)
+             *            if J(q) < J(p) and I(q) != J(q)
+             *              J(q) <- min(J(p), I(q));
+             *              fifo_add(q);
+             *            end
+             *          end
+             *        end */
+        queue_size = fifo->n;
+        while (queue_size) {
+            pixelFifoRemove(fifo, &i, &j);
             lines = datas + i * wpls;
             linem = datam + i * wplm;
 
@@ -623,10 +834,7 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem - wplm, j - 1);
                         if (val > val1 && val1 != maskval) {
                             SET_DATA_BYTE(lines - wpls, j - 1, L_MIN(val, maskval));
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i - 1;
-                            pixel->y = j - 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i - 1, j - 1);
                         }
                     }
                     if (j < jmax) {
@@ -634,20 +842,14 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem - wplm, j + 1);
                         if (val > val3 && val3 != maskval) {
                             SET_DATA_BYTE(lines - wpls, j + 1, L_MIN(val, maskval));
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i - 1;
-                            pixel->y = j + 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i - 1, j + 1);
                         }
                     }
                     val2 = GET_DATA_BYTE(lines - wpls, j);
                     maskval = GET_DATA_BYTE(linem - wplm, j);
                     if (val > val2 && val2 != maskval) {
                         SET_DATA_BYTE(lines - wpls, j, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i - 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i - 1, j);
                     }
 
                 }
@@ -656,10 +858,7 @@ L_QUEUE  *lq_pixel;
                     maskval = GET_DATA_BYTE(linem, j - 1);
                     if (val > val4 && val4 != maskval) {
                         SET_DATA_BYTE(lines, j - 1, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j - 1;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j - 1);
                     }
                 }
                 if (i < imax) {
@@ -668,10 +867,7 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem + wplm, j - 1);
                         if (val > val6 && val6 != maskval) {
                             SET_DATA_BYTE(lines + wpls, j - 1, L_MIN(val, maskval));
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i + 1;
-                            pixel->y = j - 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i + 1, j - 1);
                         }
                     }
                     if (j < jmax) {
@@ -679,20 +875,14 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem + wplm, j + 1);
                         if (val > val8 && val8 != maskval) {
                             SET_DATA_BYTE(lines + wpls, j + 1, L_MIN(val, maskval));
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i + 1;
-                            pixel->y = j + 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i + 1, j + 1);
                         }
                     }
                     val7 = GET_DATA_BYTE(lines + wpls, j);
                     maskval = GET_DATA_BYTE(linem + wplm, j);
                     if (val > val7 && val7 != maskval) {
                         SET_DATA_BYTE(lines + wpls, j, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i + 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i + 1, j);
                     }
                 }
                 if (j < jmax) {
@@ -700,24 +890,20 @@ L_QUEUE  *lq_pixel;
                     maskval = GET_DATA_BYTE(linem, j + 1);
                     if (val > val5 && val5 != maskval) {
                         SET_DATA_BYTE(lines, j + 1, L_MIN(val, maskval));
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j + 1;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j + 1);
                     }
                 }
             }
 
-            queue_size = lqueueGetCount(lq_pixel);
+            queue_size = fifo->n;
         }
         break;
 
     default:
-        L_ERROR("shouldn't get here!\n", procName);
+        L_ERROR("connectivity must be 4 or 8\n", procName);
         break;
     }
 
-    lqueueDestroy(&lq_pixel, TRUE);
     return;
 }
 
@@ -764,12 +950,11 @@ seedfillGrayInvLow(l_uint32  *datas,
                    l_int32    wplm,
                    l_int32    connectivity)
 {
-l_uint8    val1, val2, val3, val4, val5, val6, val7, val8;
-l_uint8    val, maxval, maskval, boolval;
-l_int32    i, j, imax, jmax, queue_size;
-l_uint32  *lines, *linem;
-L_PIXEL *pixel;
-L_QUEUE  *lq_pixel;
+l_uint8        val1, val2, val3, val4, val5, val6, val7, val8;
+l_uint8        val, maxval, maskval, boolval;
+l_int32        i, j, imax, jmax;
+l_uint32      *lines, *linem;
+L_PIXELFIFO   *fifo;
 
     PROCNAME("seedfillGrayInvLow");
 
@@ -783,9 +968,12 @@ L_QUEUE  *lq_pixel;
 
         /* In the worst case, most of the pixels could be pushed
          * onto the FIFO queue during anti-raster scan.  However this
-         * will rarely happen, and we initialize the queue ptr size to
-         * the image perimeter. */
-    lq_pixel = lqueueCreate(2 * (w + h));
+         * will rarely happen, and we initialize the queue size to
+         * the image perimeter.  It is enlarged as required. */
+    if ((fifo = pixelFifoCreate(2 * (w + h))) == NULL) {
+        L_ERROR("fifo not made\n", procName);
+        return;
+    }
 
     switch (connectivity)
     {
@@ -865,83 +1053,10 @@ L_QUEUE  *lq_pixel;
                         }
                     }
                     if (boolval) {
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-                }
-            }
-        }
-
-            /* Propagation step:
-             *        while fifo_empty = false
-             *          p <- fifo_first()
-             *          for every pixel (q) belong to neighbors of (p)
-             *            if J(q) < J(p) and J(p) > I(q)
-             *              J(q) <- min(J(p), I(q));
-             *              fifo_add(q);
-             *            end
-             *          end
-             *        end */
-        queue_size = lqueueGetCount(lq_pixel);
-        while (queue_size) {
-            pixel = (L_PIXEL *)lqueueRemove(lq_pixel);
-            i = pixel->x;
-            j = pixel->y;
-            FREE(pixel);
-            lines = datas + i * wpls;
-            linem = datam + i * wplm;
-
-            if ((val = GET_DATA_BYTE(lines, j)) > 0) {
-                if (i > 0) {
-                    val2 = GET_DATA_BYTE(lines - wpls, j);
-                    maskval = GET_DATA_BYTE(linem - wplm, j);
-                    if (val > val2 && val > maskval) {
-                        SET_DATA_BYTE(lines - wpls, j, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i - 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-
-                }
-                if (j > 0) {
-                    val4 = GET_DATA_BYTE(lines, j - 1);
-                    maskval = GET_DATA_BYTE(linem, j - 1);
-                    if (val > val4 && val > maskval) {
-                        SET_DATA_BYTE(lines, j - 1, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j - 1;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-                }
-                if (i < imax) {
-                    val7 = GET_DATA_BYTE(lines + wpls, j);
-                    maskval = GET_DATA_BYTE(linem + wplm, j);
-                    if (val > val7 && val > maskval) {
-                        SET_DATA_BYTE(lines + wpls, j, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i + 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
-                    }
-                }
-                if (j < jmax) {
-                    val5 = GET_DATA_BYTE(lines, j + 1);
-                    maskval = GET_DATA_BYTE(linem, j + 1);
-                    if (val > val5 && val > maskval) {
-                        SET_DATA_BYTE(lines, j + 1, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j + 1;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j);
                     }
                 }
             }
-
-            queue_size = lqueueGetCount(lq_pixel);
         }
 
         break;
@@ -1052,15 +1167,116 @@ L_QUEUE  *lq_pixel;
                         }
                     }
                     if (boolval) {
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j);
+                    }
+                }
+            }
+        }
+
+        break;
+
+    default:
+        L_ERROR("shouldn't get here!\n", procName);
+        break;
+    }
+
+    seedfillGrayInvPropagateLow(datas, w, h, wpls, datam, wplm,
+                                connectivity, fifo);
+    pixelFifoDestroy(&fifo);
+    return;
+}
+
+
+/*!
+ *  seedfillGrayInvPropagateLow()
+ *
+ *  Notes:
+ *      (1) This is the propagation step of seedfillGrayInvLow().  Starting from
+ *          the pixels in @fifo, it is a breadth-first fill to completion.
+ *          It is also used to complete the fill across the boundaries
+ *          of strips that were filled separately.
+ */
+static void
+seedfillGrayInvPropagateLow(l_uint32     *datas,
+                            l_int32       w,
+                            l_int32       h,
+                            l_int32       wpls,
+                            l_uint32     *datam,
+                            l_int32       wplm,
+                            l_int32       connectivity,
+                            L_PIXELFIFO  *fifo)
+{
+l_uint8    val1, val2, val3, val4, val5, val6, val7, val8;
+l_uint8    val, maskval;
+l_int32    i, j, imax, jmax, queue_size;
+l_uint32  *lines, *linem;
+
+    PROCNAME("seedfillGrayInvPropagateLow");
+
+    imax = h - 1;
+    jmax = w - 1;
+
+    switch (connectivity)
+    {
+    case 4:
+            /* Propagation step:
+             *        while fifo_empty = false
+             *          p <- fifo_first()
+             *          for every pixel (q) belong to neighbors of (p)
+             *            if J(q) < J(p) and J(p) > I(q)
+             *              J(q) <- min(J(p), I(q));
+             *              fifo_add(q);
+             *            end
+             *          end
+             *        end */
+        queue_size = fifo->n;
+        while (queue_size) {
+            pixelFifoRemove(fifo, &i, &j);
+            lines = datas + i * wpls;
+            linem = datam + i * wplm;
+
+            if ((val = GET_DATA_BYTE(lines, j)) > 0) {
+                if (i > 0) {
+                    val2 = GET_DATA_BYTE(lines - wpls, j);
+                    maskval = GET_DATA_BYTE(linem - wplm, j);
+                    if (val > val2 && val > maskval) {
+                        SET_DATA_BYTE(lines - wpls, j, val);
+                        pixelFifoAdd(fifo, i - 1, j);
+                    }
+
+                }
+                if (j > 0) {
+                    val4 = GET_DATA_BYTE(lines, j - 1);
+                    maskval = GET_DATA_BYTE(linem, j - 1);
+                    if (val > val4 && val > maskval) {
+                        SET_DATA_BYTE(lines, j - 1, val);
+                        pixelFifoAdd(fifo, i, j - 1);
+                    }
+                }
+                if (i < imax) {
+                    val7 = GET_DATA_BYTE(lines + wpls, j);
+                    maskval = GET_DATA_BYTE(linem + wplm, j);
+                    if (val > val7 && val > maskval) {
+                        SET_DATA_BYTE(lines + wpls, j, val);
+                        pixelFifoAdd(fifo, i + 1, j);
+                    }
+                }
+                if (j < jmax) {
+                    val5 = GET_DATA_BYTE(lines, j + 1);
+                    maskval = GET_DATA_BYTE(linem, j + 1);
+                    if (val > val5 && val > maskval) {
+                        SET_DATA_BYTE(lines, j + 1, val);
+                        pixelFifoAdd(fifo, i, j + 1);
                     }
                 }
             }
+
+            queue_size = fifo->n;
         }
 
+        break;
+
+    case 8:
             /* Propagation step:
              *        while fifo_empty = false
              *          p <- fifo_first()
@@ -1071,12 +1287,9 @@ L_QUEUE  *lq_pixel;
              *            end
              *          end
              *        end */
-        queue_size = lqueueGetCount(lq_pixel);
+        queue_size = fifo->n;
         while (queue_size) {
-            pixel = (L_PIXEL *)lqueueRemove(lq_pixel);
-            i = pixel->x;
-            j = pixel->y;
-            FREE(pixel);
+            pixelFifoRemove(fifo, &i, &j);
             lines = datas + i * wpls;
             linem = datam + i * wplm;
 
@@ -1087,10 +1300,7 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem - wplm, j - 1);
                         if (val > val1 && val > maskval) {
                             SET_DATA_BYTE(lines - wpls, j - 1, val);
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i - 1;
-                            pixel->y = j - 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i - 1, j - 1);
                         }
                     }
                     if (j < jmax) {
@@ -1098,20 +1308,14 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem - wplm, j + 1);
                         if (val > val3 && val > maskval) {
                             SET_DATA_BYTE(lines - wpls, j + 1, val);
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i - 1;
-                            pixel->y = j + 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i - 1, j + 1);
                         }
                     }
                     val2 = GET_DATA_BYTE(lines - wpls, j);
                     maskval = GET_DATA_BYTE(linem - wplm, j);
                     if (val > val2 && val > maskval) {
                         SET_DATA_BYTE(lines - wpls, j, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i - 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i - 1, j);
                     }
 
                 }
@@ -1120,10 +1324,7 @@ L_QUEUE  *lq_pixel;
                     maskval = GET_DATA_BYTE(linem, j - 1);
                     if (val > val4 && val > maskval) {
                         SET_DATA_BYTE(lines, j - 1, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j - 1;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j - 1);
                     }
                 }
                 if (i < imax) {
@@ -1132,10 +1333,7 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem + wplm, j - 1);
                         if (val > val6 && val > maskval) {
                             SET_DATA_BYTE(lines + wpls, j - 1, val);
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i + 1;
-                            pixel->y = j - 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i + 1, j - 1);
                         }
                     }
                     if (j < jmax) {
@@ -1143,20 +1341,14 @@ L_QUEUE  *lq_pixel;
                         maskval = GET_DATA_BYTE(linem + wplm, j + 1);
                         if (val > val8 && val > maskval) {
                             SET_DATA_BYTE(lines + wpls, j + 1, val);
-                            pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                            pixel->x = i + 1;
-                            pixel->y = j + 1;
-                            lqueueAdd(lq_pixel, pixel);
+                            pixelFifoAdd(fifo, i + 1, j + 1);
                         }
                     }
                     val7 = GET_DATA_BYTE(lines + wpls, j);
                     maskval = GET_DATA_BYTE(linem + wplm, j);
                     if (val > val7 && val > maskval) {
                         SET_DATA_BYTE(lines + wpls, j, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i + 1;
-                        pixel->y = j;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i + 1, j);
                     }
                 }
                 if (j < jmax) {
@@ -1164,27 +1356,165 @@ L_QUEUE  *lq_pixel;
                     maskval = GET_DATA_BYTE(linem, j + 1);
                     if (val > val5 && val > maskval) {
                         SET_DATA_BYTE(lines, j + 1, val);
-                        pixel = (L_PIXEL *)CALLOC(1, sizeof(L_PIXEL));
-                        pixel->x = i;
-                        pixel->y = j + 1;
-                        lqueueAdd(lq_pixel, pixel);
+                        pixelFifoAdd(fifo, i, j + 1);
                     }
                 }
             }
 
-            queue_size = lqueueGetCount(lq_pixel);
+            queue_size = fifo->n;
         }
         break;
 
     default:
-        L_ERROR("shouldn't get here!\n", procName);
+        L_ERROR("connectivity must be 4 or 8\n", procName);
         break;
     }
 
-    lqueueDestroy(&lq_pixel, TRUE);
     return;
 }
 
+/*!
+ *  seedfillGrayBoundaryLow()
+ *
+ *  Notes:
+ *      (1) This completes a gray seedfill where the seed has been
+ *          filled separately in horizontal strips, with
+ *          seedfillGrayLow() on each strip.  The first line of strip k
+ *          is ystart[k], for 0 <= k < nstrips.
+ *      (2) After the separate fills, the only pixels whose values can
+ *          still be propagated are on the lines next to a boundary
+ *          between strips.  Those that can be propagated across the
+ *          boundary are put in the FIFO queue, and the propagation step
+ *          of the hybrid method is used to complete the fill.  Because
+ *          the filled seed is unique, the result is the same as the fill
+ *          of the entire image with seedfillGrayLow().
+ */
+void
+seedfillGrayBoundaryLow(l_uint32  *datas,
+                        l_int32    w,
+                        l_int32    h,
+                        l_int32    wpls,
+                        l_uint32  *datam,
+                        l_int32    wplm,
+                        l_int32    connectivity,
+                        l_int32   *ystart,
+                        l_int32    nstrips)
+{
+L_PIXELFIFO  *fifo;
+
+    PROCNAME("seedfillGrayBoundaryLow");
+
+    if (connectivity != 4 && connectivity != 8) {
+        L_ERROR("connectivity must be 4 or 8\n", procName);
+        return;
+    }
+    if ((fifo = pixelFifoCreate(2 * w * nstrips)) == NULL) {
+        L_ERROR("fifo not made\n", procName);
+        return;
+    }
+
+    seedfillGrayQueueBoundaries(datas, w, wpls, datam, wplm, connectivity,
+                                ystart, nstrips, FALSE, fifo);
+    seedfillGrayPropagateLow(datas, w, h, wpls, datam, wplm, connectivity,
+                             fifo);
+    pixelFifoDestroy(&fifo);
+    return;
+}
+
+
+/*!
+ *  seedfillGrayInvBoundaryLow()
+ *
+ *  Notes:
+ *      (1) This is the version of seedfillGrayBoundaryLow() for the
+ *          inverse fill, where each strip has been filled with
+ *          seedfillGrayInvLow().
+ */
+void
+seedfillGrayInvBoundaryLow(l_uint32  *datas,
+                           l_int32    w,
+                           l_int32    h,
+                           l_int32    wpls,
+                           l_uint32  *datam,
+                           l_int32    wplm,
+                           l_int32    connectivity,
+                           l_int32   *ystart,
+                           l_int32    nstrips)
+{
+L_PIXELFIFO  *fifo;
+
+    PROCNAME("seedfillGrayInvBoundaryLow");
+
+    if (connectivity != 4 && connectivity != 8) {
+        L_ERROR("connectivity must be 4 or 8\n", procName);
+        return;
+    }
+    if ((fifo = pixelFifoCreate(2 * w * nstrips)) == NULL) {
+        L_ERROR("fifo not made\n", procName);
+        return;
+    }
+
+    seedfillGrayQueueBoundaries(datas, w, wpls, datam, wplm, connectivity,
+                                ystart, nstrips, TRUE, fifo);
+    seedfillGrayInvPropagateLow(datas, w, h, wpls, datam, wplm,
+                                connectivity, fifo);
+    pixelFifoDestroy(&fifo);
+    return;
+}
+
+
+/*!
+ *  seedfillGrayQueueBoundaries()
+ *
+ *  Notes:
+ *      (1) For each boundary between strips, this puts in @fifo every
+ *          pixel p on the lines on each side of the boundary that can
+ *          fill a neighbor q on the other side.  This is the test in
+ *          the propagation step: J(p) > J(q) and either I(q) != J(q)
+ *          for the standard fill, or J(p) > I(q) for the inverse fill.
+ */
+static void
+seedfillGrayQueueBoundaries(l_uint32     *datas,
+                            l_int32       w,
+                            l_int32       wpls,
+                            l_uint32     *datam,
+                            l_int32       wplm,
+                            l_int32       connectivity,
+                            l_int32      *ystart,
+                            l_int32       nstrips,
+                            l_int32       inv,
+                            L_PIXELFIFO  *fifo)
+{
+l_int32    i, j, k, m, jq, y, val, valq, maskq;
+l_uint32  *lines, *linesq, *linemq;
+
+    for (k = 1; k < nstrips; k++) {
+        y = ystart[k];
+        for (m = 0; m < 2; m++) {  /* p above, then below the boundary */
+            i = (m == 0) ? y - 1 : y;
+            lines = datas + i * wpls;
+            linesq = (m == 0) ? lines + wpls : lines - wpls;
+            linemq = datam + ((m == 0) ? y : y - 1) * wplm;
+            for (j = 0; j < w; j++) {
+                val = GET_DATA_BYTE(lines, j);
+                for (jq = j - 1; jq <= j + 1; jq++) {
+                    if (jq < 0 || jq >= w) continue;
+                    if (connectivity == 4 && jq != j) continue;
+                    valq = GET_DATA_BYTE(linesq, jq);
+                    maskq = GET_DATA_BYTE(linemq, jq);
+                    if (val > valq &&
+                        ((!inv && valq != maskq) || (inv && val > maskq))) {
+                        pixelFifoAdd(fifo, i, j);
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return;
+}
+
+
 /*-----------------------------------------------------------------------*
  *                 Vincent's Iterative Grayscale Seedfill                *
  *-----------------------------------------------------------------------*/
@@ -1825,3 +2155,114 @@ l_uint32  *linet, *lined;
 
     return;
 }
+
+
+/*-----------------------------------------------------------------------*
+ *                  Static helpers for the FIFO queue                    *
+ *-----------------------------------------------------------------------*/
+/*!
+ *  pixelFifoCreate()
+ *
+ *      Input:  nalloc (initial size of the ring buffer)
+ *      Return: fifo, or null on error
+ */
+static L_PIXELFIFO *
+pixelFifoCreate(l_int32  nalloc)
+{
+L_PIXELFIFO  *fifo;
+
+    PROCNAME("pixelFifoCreate");
+
+    if ((fifo = (L_PIXELFIFO *)CALLOC(1, sizeof(L_PIXELFIFO))) == NULL)
+        return (L_PIXELFIFO *)ERROR_PTR("fifo not made", procName, NULL);
+    fifo->nalloc = L_MAX(64, nalloc);
+    if ((fifo->array = (L_PIXEL *)CALLOC(fifo->nalloc, sizeof(L_PIXEL)))
+        == NULL) {
+        FREE(fifo);
+        return (L_PIXELFIFO *)ERROR_PTR("array not made", procName, NULL);
+    }
+    return fifo;
+}
+
+
+/*!
+ *  pixelFifoDestroy()
+ *
+ *      Input:  &fifo (<to be nulled>)
+ *      Return: void
+ */
+static void
+pixelFifoDestroy(L_PIXELFIFO  **pfifo)
+{
+L_PIXELFIFO  *fifo;
+
+    if (!pfifo || (fifo = *pfifo) == NULL)
+        return;
+    FREE(fifo->array);
+    FREE(fifo);
+    *pfifo = NULL;
+    return;
+}
+
+
+/*!
+ *  pixelFifoAdd()
+ *
+ *      Input:  fifo
+ *              i, j (line and column of the location)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) When the ring buffer is full, it is doubled in size, with
+ *          the locations copied in order to the start of the new buffer.
+ */
+static l_int32
+pixelFifoAdd(L_PIXELFIFO  *fifo,
+             l_int32       i,
+             l_int32       j)
+{
+l_int32   k, index;
+L_PIXEL  *array;
+
+    PROCNAME("pixelFifoAdd");
+
+    if (fifo->n == fifo->nalloc) {
+        if ((array = (L_PIXEL *)CALLOC(2 * fifo->nalloc, sizeof(L_PIXEL)))
+            == NULL)
+            return ERROR_INT("array not enlarged", procName, 1);
+        for (k = 0; k < fifo->n; k++)
+            array[k] = fifo->array[(fifo->head + k) % fifo->nalloc];
+        FREE(fifo->array);
+        fifo->array = array;
+        fifo->nalloc *= 2;
+        fifo->head = 0;
+    }
+
+    index = (fifo->head + fifo->n) % fifo->nalloc;
+    fifo->array[index].x = j;
+    fifo->array[index].y = i;
+    fifo->n++;
+    return 0;
+}
+
+
+/*!
+ *  pixelFifoRemove()
+ *
+ *      Input:  fifo
+ *              &i, &j (<return> line and column of the first location)
+ *      Return: 0 if OK, 1 if the fifo is empty
+ */
+static l_int32
+pixelFifoRemove(L_PIXELFIFO  *fifo,
+                l_int32      *pi,
+                l_int32      *pj)
+{
+    if (fifo->n == 0)
+        return 1;
+    *pi = fifo->array[fifo->head].y;
+    *pj = fifo->array[fifo->head].x;
+    fifo->head = (fifo->head + 1) % fifo->nalloc;
+    fifo->n--;
+    return 0;
+}
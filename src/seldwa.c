@@ -0,0 +1,799 @@
+/*====================================================================*
+ -  Copyright (C) 2001 Leptonica.  All rights reserved.
+ -
+ -  Redistribution and use in source and binary forms, with or without
+ -  modification, are permitted provided that the following conditions
+ -  are met:
+ -  1. Redistributions of source code must retain the above copyright
+ -     notice, this list of conditions and the following disclaimer.
+ -  2. Redistributions in binary form must reproduce the above
+ -     copyright notice, this list of conditions and the following
+ -     disclaimer in the documentation and/or other materials
+ -     provided with the distribution.
+ -
+ -  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ -  ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ -  LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ -  A PARTICULAR PURPOSE ARE DISCLAIMED.  IN NO EVENT SHALL ANY
+ -  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ -  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ -  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ -  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY
+ -  OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ -  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ -  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *====================================================================*/
+
+
+/*
+ *  seldwa.c
+ *
+ *      Create/destroy
+ *          L_DWASEL   *l_dwaselCreate()
+ *          void        l_dwaselDestroy()
+ *
+ *      Binary morphology with a compiled Sel
+ *          PIX        *pixDilateDwasel()
+ *          PIX        *pixErodeDwasel()
+ *          PIX        *pixHMTDwasel()
+ *          static PIX      *pixMorphDwasel()
+ *          static l_int32   dwaselBandJob()
+ *          static void      dwaselCopyLines()
+ *          static void      dwaselAccumulateLines()
+ *          static void      dwaselLinesSSE2()
+ *          static void      dwaselLinesAVX2()
+ *
+ *  Destination word accumulation (dwa) computes each word of the
+ *  result from the shifted source words for all the hits and misses
+ *  of the Sel, in a single pass over the image, whereas the rasterop
+ *  implementation makes a pass over the entire image for each element
+ *  of the Sel.  The dwa code in fmorphgenlow.*.c and fhmtgenlow.*.c
+ *  is generated for a fixed set of Sels, with each shift written into
+ *  the expression for the destination word.  To use it for other
+ *  Sels, the code must be generated and compiled into the library.
+ *
+ *  Here, the Sel is instead compiled at runtime into a list of
+ *  shifts of the source.  The result is made in strips of a few
+ *  lines that stay in the cache; for each strip, the shifted source
+ *  lines are combined in turn into it.  The loop over a line is specialized
+ *  for each way of combining, and for shifts that are a multiple
+ *  of 32 bits.  When the processor supports it (see l_getSimdLevel()),
+ *  the line is done 128 or 256 bits at a time, with the last few
+ *  words done 32 bits at a time.  Any Sel can be used, of any size,
+ *  and bands of lines are done on parallel threads.
+ *
+ *  Compiling a Sel takes time proportional to its size, which is
+ *  negligible compared to an operation on an image, so pixDilate(),
+ *  pixErode() and pixHMT() compile their Sel on each call.  When the
+ *  same Sels are used repeatedly, such as hit-miss templates that are
+ *  matched on many pages, each one can be compiled once with
+ *  l_dwaselCreate() and kept.
+ *
+ *  The boundary conditions are the same as for the rasterop
+ *  implementations in morph.c: pixels outside the image are OFF,
+ *  except for erosion with symmetric b.c., where they are ON.
+ */
+
+#include <string.h>
+#include "allheaders.h"
+#if USE_SIMD
+#include <immintrin.h>
+#endif  /* USE_SIMD */
+
+    /* Min number of lines in each band of the result */
+static const l_int32  MIN_BAND_LINES = 32;
+
+    /* Max number of words in each strip of the result in a band */
+static const l_int32  STRIP_WORDS = 4096;
+
+    /* Ways of combining a shifted source line into the result line */
+enum {
+    DWA_SET = 1,       /* d = s       */
+    DWA_SET_NOT = 2,   /* d = ~s      */
+    DWA_OR = 3,        /* d = d | s   */
+    DWA_AND = 4,       /* d = d & s   */
+    DWA_AND_NOT = 5    /* d = d & ~s  */
+};
+
+    /* Bands of lines of the result, each done on a separate thread */
+struct DwaselBands
+{
+    l_uint32  *datad;         /* data of the result                       */
+    l_int32    wpld;          /* wpl of the result                        */
+    l_uint32  *datas;         /* data of the source                       */
+    l_int32    wpls;          /* wpl of the source                        */
+    l_int32    w;             /* width of the image                       */
+    l_int32    h;             /* height of the image                      */
+    l_int32    nwords;        /* words in each line of the image          */
+    l_uint32   bordval;       /* word for pixels outside the image        */
+    l_int32    bxw;           /* border words on the left and right       */
+    l_int32    by;            /* border lines on the top and bottom       */
+    l_int32    wplb;          /* wpl of the source lines with border      */
+    l_int32    nops;          /* number of shifted source lines combined  */
+    l_int32   *offset;        /* word offset of each shifted line         */
+    l_int32   *shift;         /* further left shift, in [0 ... 31] bits   */
+    l_int32   *type;          /* DWA_SET, DWA_OR, ...                     */
+    l_int32    nbands;        /* number of bands of lines                 */
+    l_int32    level;         /* simd level: L_SIMD_NONE, ...             */
+};
+typedef struct DwaselBands  DWASEL_BANDS;
+
+static PIX *pixMorphDwasel(PIX *pixd, PIX *pixs, L_DWASEL *dsel,
+                           l_int32 operation);
+static l_int32 dwaselBandJob(void *data, l_int32 index);
+static void dwaselCopyLines(DWASEL_BANDS *db, l_uint32 *datab, l_int32 y,
+                            l_int32 nlines);
+static void dwaselAccumulateLines(l_uint32 *datad, l_int32 wpld,
+                                  l_uint32 *datas, l_int32 wpls,
+                                  l_int32 nlines, l_int32 nwords,
+                                  l_int32 shift, l_int32 type,
+                                  l_int32 level);
+#if USE_SIMD
+static void dwaselLinesSSE2(l_uint32 *datad, l_int32 wpld, l_uint32 *datas,
+                            l_int32 wpls, l_int32 nlines, l_int32 nw,
+                            l_int32 shift, l_int32 type);
+static void dwaselLinesAVX2(l_uint32 *datad, l_int32 wpld, l_uint32 *datas,
+                            l_int32 wpls, l_int32 nlines, l_int32 nw,
+                            l_int32 shift, l_int32 type);
+#endif  /* USE_SIMD */
+
+
+/*----------------------------------------------------------------------*
+ *                           Create/destroy                             *
+ *----------------------------------------------------------------------*/
+/*!
+ *  l_dwaselCreate()
+ *
+ *      Input:  sel
+ *      Return: dsel, or null on error
+ *
+ *  Notes:
+ *      (1) This lists the shifts of the hits, followed by those
+ *          of the misses, in raster order.  The Sel is not needed
+ *          after the dsel is made.
+ */
+L_DWASEL *
+l_dwaselCreate(SEL  *sel)
+{
+l_int32    i, j, k, sx, sy, cx, cy, nhits, nmisses;
+L_DWASEL  *dsel;
+
+    PROCNAME("l_dwaselCreate");
+
+    if (!sel)
+        return (L_DWASEL *)ERROR_PTR("sel not defined", procName, NULL);
+    selGetParameters(sel, &sy, &sx, &cy, &cx);
+    if (sx == 0 || sy == 0)
+        return (L_DWASEL *)ERROR_PTR("sel of size 0", procName, NULL);
+
+    nhits = nmisses = 0;
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT)
+                nhits++;
+            else if (sel->data[i][j] == SEL_MISS)
+                nmisses++;
+        }
+    }
+
+    if ((dsel = (L_DWASEL *)CALLOC(1, sizeof(L_DWASEL))) == NULL)
+        return (L_DWASEL *)ERROR_PTR("dsel not made", procName, NULL);
+    dsel->nhits = nhits;
+    dsel->nmisses = nmisses;
+    dsel->dx = (l_int32 *)CALLOC(L_MAX(1, nhits + nmisses), sizeof(l_int32));
+    dsel->dy = (l_int32 *)CALLOC(L_MAX(1, nhits + nmisses), sizeof(l_int32));
+    if (!dsel->dx || !dsel->dy) {
+        l_dwaselDestroy(&dsel);
+        return (L_DWASEL *)ERROR_PTR("shift arrays not made", procName, NULL);
+    }
+
+        /* The hits, then the misses */
+    for (i = 0, k = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_HIT) {
+                dsel->dx[k] = j - cx;
+                dsel->dy[k++] = i - cy;
+            }
+        }
+    }
+    for (i = 0; i < sy; i++) {
+        for (j = 0; j < sx; j++) {
+            if (sel->data[i][j] == SEL_MISS) {
+                dsel->dx[k] = j - cx;
+                dsel->dy[k++] = i - cy;
+            }
+        }
+    }
+    for (k = 0; k < nhits + nmisses; k++) {
+        dsel->xmax = L_MAX(dsel->xmax, L_ABS(dsel->dx[k]));
+        dsel->ymax = L_MAX(dsel->ymax, L_ABS(dsel->dy[k]));
+    }
+
+    return dsel;
+}
+
+
+/*!
+ *  l_dwaselDestroy()
+ *
+ *      Input:  &dsel (<to be nulled>)
+ *      Return: void
+ */
+void
+l_dwaselDestroy(L_DWASEL  **pdsel)
+{
+L_DWASEL  *dsel;
+
+    PROCNAME("l_dwaselDestroy");
+
+    if (pdsel == NULL) {
+        L_WARNING("ptr address is NULL\n", procName);
+        return;
+    }
+    if ((dsel = *pdsel) == NULL)
+        return;
+
+    FREE(dsel->dx);
+    FREE(dsel->dy);
+    FREE(dsel);
+    *pdsel = NULL;
+    return;
+}
+
+
+/*----------------------------------------------------------------------*
+ *                  Binary morphology with a compiled Sel               *
+ *----------------------------------------------------------------------*/
+/*!
+ *  pixDilateDwasel()
+ *
+ *      Input:  pixd  (<optional>; this can be null, equal to pixs,
+ *                     or different from pixs)
+ *              pixs (1 bpp)
+ *              dsel (compiled sel)
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) This dilates src using the hits in the compiled Sel.
+ *          The result is the same as with pixDilate().
+ *      (2) The size of the result is determined by pixs.
+ */
+PIX *
+pixDilateDwasel(PIX       *pixd,
+                PIX       *pixs,
+                L_DWASEL  *dsel)
+{
+    return pixMorphDwasel(pixd, pixs, dsel, L_MORPH_DILATE);
+}
+
+
+/*!
+ *  pixErodeDwasel()
+ *
+ *      Input:  pixd  (<optional>; this can be null, equal to pixs,
+ *                     or different from pixs)
+ *              pixs (1 bpp)
+ *              dsel (compiled sel)
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) This erodes src using the hits in the compiled Sel.
+ *          The result is the same as with pixErode(), including
+ *          the boundary condition set by resetMorphBoundaryCondition().
+ *      (2) The size of the result is determined by pixs.
+ */
+PIX *
+pixErodeDwasel(PIX       *pixd,
+               PIX       *pixs,
+               L_DWASEL  *dsel)
+{
+    return pixMorphDwasel(pixd, pixs, dsel, L_MORPH_ERODE);
+}
+
+
+/*!
+ *  pixHMTDwasel()
+ *
+ *      Input:  pixd  (<optional>; this can be null, equal to pixs,
+ *                     or different from pixs)
+ *              pixs (1 bpp)
+ *              dsel (compiled sel)
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) This is the hit-miss transform with the hits and misses in
+ *          the compiled Sel.  The result is the same as with pixHMT().
+ *      (2) The size of the result is determined by pixs.
+ */
+PIX *
+pixHMTDwasel(PIX       *pixd,
+             PIX       *pixs,
+             L_DWASEL  *dsel)
+{
+    return pixMorphDwasel(pixd, pixs, dsel, L_MORPH_HMT);
+}
+
+
+/*!
+ *  pixMorphDwasel()
+ *
+ *      Input:  pixd  (<optional>; this can be null, equal to pixs,
+ *                     or different from pixs)
+ *              pixs (1 bpp)
+ *              dsel (compiled sel)
+ *              operation (L_MORPH_DILATE, L_MORPH_ERODE, L_MORPH_HMT)
+ *      Return: pixd
+ *
+ *  Notes:
+ *      (1) Dilation reflects the shifts of the hits.  Erosion and
+ *          the hit-miss transform use them as they are.
+ *      (2) The shifts are read from source lines with a border
+ *          that is large enough for the largest shift, and a whole
+ *          number of words wide on the left and right, so that the
+ *          shifted words are at the same locations in every line.
+ *          Rather than adding the border to the entire image, the
+ *          lines for each strip of the result are copied into a
+ *          small buffer with the border; see dwaselBandJob().
+ *      (3) With no elements, dilation gives an empty image and
+ *          erosion gives a full image.  The hit-miss transform leaves
+ *          pixd as it is, which is empty if it is made here; this is
+ *          what pixHMT() has always done with such a Sel.
+ */
+static PIX *
+pixMorphDwasel(PIX       *pixd,
+               PIX       *pixs,
+               L_DWASEL  *dsel,
+               l_int32    operation)
+{
+l_int32        i, w, h, nops, sdx, sdy, bx, nthreads, ret;
+DWASEL_BANDS   db;
+PIX           *pixt;
+
+    PROCNAME("pixMorphDwasel");
+
+    if (!pixs)
+        return (PIX *)ERROR_PTR("pixs not defined", procName, pixd);
+    if (!dsel)
+        return (PIX *)ERROR_PTR("dsel not defined", procName, pixd);
+    if (pixGetDepth(pixs) != 1)
+        return (PIX *)ERROR_PTR("pixs not 1 bpp", procName, pixd);
+
+    if (!pixd) {
+        if ((pixd = pixCreateTemplate(pixs)) == NULL)
+            return (PIX *)ERROR_PTR("pixd not made", procName, NULL);
+        pixt = pixClone(pixs);
+    } else {
+        pixResizeImageData(pixd, pixs);
+        if (pixd == pixs) {  /* in-place; must make a copy of pixs */
+            if ((pixt = pixCopy(NULL, pixs)) == NULL)
+                return (PIX *)ERROR_PTR("pixt not made", procName, pixd);
+        } else {
+            pixt = pixClone(pixs);
+        }
+    }
+
+    nops = dsel->nhits;
+    if (operation == L_MORPH_HMT)
+        nops += dsel->nmisses;
+    if (nops == 0) {
+        if (operation == L_MORPH_DILATE)
+            pixClearAll(pixd);
+        else if (operation == L_MORPH_ERODE)
+            pixSetAll(pixd);
+        pixDestroy(&pixt);
+        return pixd;
+    }
+
+    pixGetDimensions(pixs, &w, &h, NULL);
+    db.datad = pixGetData(pixd);
+    db.wpld = pixGetWpl(pixd);
+    db.datas = pixGetData(pixt);
+    db.wpls = pixGetWpl(pixt);
+    db.w = w;
+    db.h = h;
+    db.nwords = (w + 31) / 32;
+    db.bordval = 0;
+    if (operation == L_MORPH_ERODE &&
+        getMorphBorderPixelColor(L_MORPH_ERODE, 1) == 1)
+        db.bordval = 0xffffffff;
+    db.bxw = 1 + dsel->xmax / 32;
+    db.by = dsel->ymax;
+    db.wplb = db.nwords + 2 * db.bxw;
+    db.nops = nops;
+    db.level = l_getSimdLevel();
+
+        /* Location of each shifted line relative to the source line
+         * in the buffer, and how it is combined into the result */
+    db.offset = (l_int32 *)CALLOC(nops, sizeof(l_int32));
+    db.shift = (l_int32 *)CALLOC(nops, sizeof(l_int32));
+    db.type = (l_int32 *)CALLOC(nops, sizeof(l_int32));
+    if (!db.offset || !db.shift || !db.type) {
+        FREE(db.offset);
+        FREE(db.shift);
+        FREE(db.type);
+        pixDestroy(&pixt);
+        return (PIX *)ERROR_PTR("op arrays not made", procName, pixd);
+    }
+    bx = 32 * db.bxw;
+    for (i = 0; i < nops; i++) {
+        sdx = (operation == L_MORPH_DILATE) ? -dsel->dx[i] : dsel->dx[i];
+        sdy = (operation == L_MORPH_DILATE) ? -dsel->dy[i] : dsel->dy[i];
+        db.offset[i] = sdy * db.wplb + (bx + sdx) / 32 - db.bxw;
+        db.shift[i] = (bx + sdx) % 32;
+        if (i >= dsel->nhits)  /* miss */
+            db.type[i] = (i == 0) ? DWA_SET_NOT : DWA_AND_NOT;
+        else if (operation == L_MORPH_DILATE)
+            db.type[i] = (i == 0) ? DWA_SET : DWA_OR;
+        else
+            db.type[i] = (i == 0) ? DWA_SET : DWA_AND;
+    }
+
+    nthreads = l_getNumThreads();
+    db.nbands = (nthreads == 1) ? 1 :
+                L_MAX(1, L_MIN(nthreads, h / MIN_BAND_LINES));
+    ret = l_parallelRun(db.nbands, dwaselBandJob, &db, nthreads);
+    pixSetPadBits(pixd, 0);
+
+    FREE(db.offset);
+    FREE(db.shift);
+    FREE(db.type);
+    pixDestroy(&pixt);
+    if (ret)
+        L_ERROR("dwa morphology failed\n", procName);
+    return pixd;
+}
+
+
+/*!
+ *  dwaselBandJob()
+ *
+ *      Input:  data (DWASEL_BANDS)
+ *              index (of the band of lines)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The band is done in strips of lines.  The source lines for
+ *          a strip, including those above and below it that are read
+ *          for the vertical shifts, are copied with their border into
+ *          a buffer.  Each shifted source is then combined into all
+ *          the lines of the strip at once.
+ *      (2) The strip is made at least as tall as the border, to
+ *          limit the extra source lines that are copied.
+ */
+static l_int32
+dwaselBandJob(void    *data,
+              l_int32  index)
+{
+l_int32        i, k, y1, y2, nlines, n;
+l_uint32      *datab, *lined, *lineb;
+DWASEL_BANDS  *db;
+
+    PROCNAME("dwaselBandJob");
+
+    db = (DWASEL_BANDS *)data;
+    y1 = (l_int32)(((l_float64)index * db->h) / db->nbands);
+    y2 = (l_int32)(((l_float64)(index + 1) * db->h) / db->nbands);
+    nlines = L_MAX(STRIP_WORDS / db->nwords, 2 * db->by);
+    nlines = L_MAX(1, L_MIN(nlines, y2 - y1));
+    datab = (l_uint32 *)MALLOC(sizeof(l_uint32) * db->wplb *
+                               (nlines + 2 * db->by));
+    if (!datab)
+        return ERROR_INT("datab not made", procName, 1);
+    for (k = 0; k < db->wplb * (nlines + 2 * db->by); k++)
+        datab[k] = db->bordval;
+
+    for (i = y1; i < y2; i += nlines) {
+        n = L_MIN(nlines, y2 - i);
+        dwaselCopyLines(db, datab, i - db->by, n + 2 * db->by);
+        lined = db->datad + i * db->wpld;
+        lineb = datab + db->by * db->wplb + db->bxw;
+        for (k = 0; k < db->nops; k++)
+            dwaselAccumulateLines(lined, db->wpld, lineb + db->offset[k],
+                                  db->wplb, n, db->nwords, db->shift[k],
+                                  db->type[k], db->level);
+    }
+
+    FREE(datab);
+    return 0;
+}
+
+
+/*!
+ *  dwaselCopyLines()
+ *
+ *      Input:  db (DWASEL_BANDS)
+ *              datab (buffer for the lines with border)
+ *              y (source line copied to the first buffer line;
+ *                 can be < 0)
+ *              nlines (number of lines to copy)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) The border words on the left and right of the buffer are
+ *          set once, when it is made.  Here, the image words of each
+ *          line are set, from the source if the line is in the image
+ *          and to the border value otherwise.  The pixels to the right
+ *          of the image, in the last word, are also set to the border
+ *          value.
+ */
+static void
+dwaselCopyLines(DWASEL_BANDS  *db,
+                l_uint32      *datab,
+                l_int32        y,
+                l_int32        nlines)
+{
+l_int32    i, j, nwords, rbits;
+l_uint32   mask;
+l_uint32  *lines, *lineb;
+
+    nwords = db->nwords;
+    rbits = db->w & 31;
+    mask = (rbits == 0) ? 0xffffffff : (0xffffffff << (32 - rbits));
+    for (i = 0; i < nlines; i++, y++) {
+        lineb = datab + i * db->wplb + db->bxw;
+        if (y < 0 || y >= db->h) {
+            for (j = 0; j < nwords; j++)
+                lineb[j] = db->bordval;
+        } else {
+            lines = db->datas + y * db->wpls;
+            memcpy(lineb, lines, 4 * nwords);
+            lineb[nwords - 1] = (lineb[nwords - 1] & mask) |
+                                (db->bordval & ~mask);
+        }
+    }
+    return;
+}
+
+
+/*!
+ *  dwaselAccumulateLines()
+ *
+ *      Input:  datad (first line of the result)
+ *              wpld
+ *              datas (first shifted source line, at the word offset)
+ *              wpls
+ *              nlines (number of lines)
+ *              nwords (in each result line)
+ *              shift (further left shift of the source, in bits)
+ *              type (DWA_SET, DWA_SET_NOT, DWA_OR, DWA_AND, DWA_AND_NOT)
+ *              level (simd level)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) For a nonzero shift, each source word is made from two
+ *          adjacent words, so the word after the last one is read.
+ *      (2) With simd, the largest multiple of 4 or 8 words is done
+ *          with vector instructions, and the rest here.
+ */
+static void
+dwaselAccumulateLines(l_uint32  *datad,
+                      l_int32    wpld,
+                      l_uint32  *datas,
+                      l_int32    wpls,
+                      l_int32    nlines,
+                      l_int32    nwords,
+                      l_int32    shift,
+                      l_int32    type,
+                      l_int32    level)
+{
+l_int32    i, j, jstart, rshift;
+l_uint32  *lined, *lines;
+
+    jstart = 0;
+#if USE_SIMD
+    if (level == L_SIMD_AVX2 && nwords >= 8) {
+        jstart = nwords & ~7;
+        dwaselLinesAVX2(datad, wpld, datas, wpls, nlines, jstart,
+                        shift, type);
+    } else if (level >= L_SIMD_SSE2 && nwords >= 4) {
+        jstart = nwords & ~3;
+        dwaselLinesSSE2(datad, wpld, datas, wpls, nlines, jstart,
+                        shift, type);
+    }
+#endif  /* USE_SIMD */
+    if (jstart == nwords)
+        return;
+
+    rshift = 32 - shift;
+    for (i = 0; i < nlines; i++) {
+        lined = datad + i * wpld;
+        lines = datas + i * wpls;
+        if (shift == 0) {
+            switch (type)
+            {
+            case DWA_SET:
+                for (j = jstart; j < nwords; j++)
+                    lined[j] = lines[j];
+                break;
+            case DWA_SET_NOT:
+                for (j = jstart; j < nwords; j++)
+                    lined[j] = ~lines[j];
+                break;
+            case DWA_OR:
+                for (j = jstart; j < nwords; j++)
+                    lined[j] |= lines[j];
+                break;
+            case DWA_AND:
+                for (j = jstart; j < nwords; j++)
+                    lined[j] &= lines[j];
+                break;
+            default:  /* DWA_AND_NOT */
+                for (j = jstart; j < nwords; j++)
+                    lined[j] &= ~lines[j];
+                break;
+            }
+            continue;
+        }
+
+        switch (type)
+        {
+        case DWA_SET:
+            for (j = jstart; j < nwords; j++)
+                lined[j] = (lines[j] << shift) | (lines[j + 1] >> rshift);
+            break;
+        case DWA_SET_NOT:
+            for (j = jstart; j < nwords; j++)
+                lined[j] = ~((lines[j] << shift) | (lines[j + 1] >> rshift));
+            break;
+        case DWA_OR:
+            for (j = jstart; j < nwords; j++)
+                lined[j] |= (lines[j] << shift) | (lines[j + 1] >> rshift);
+            break;
+        case DWA_AND:
+            for (j = jstart; j < nwords; j++)
+                lined[j] &= (lines[j] << shift) | (lines[j + 1] >> rshift);
+            break;
+        default:  /* DWA_AND_NOT */
+            for (j = jstart; j < nwords; j++)
+                lined[j] &= ~((lines[j] << shift) | (lines[j + 1] >> rshift));
+            break;
+        }
+    }
+    return;
+}
+
+
+#if USE_SIMD
+    /* Each result word j is made from the source bits starting @shift
+     * bits into source word j, as in the simd rasterop in roplow.c.
+     * The loop macros apply EXPR, a function of the source vector s
+     * and result vector d, along each line.  */
+#define  SSE2_LOAD(p)    _mm_loadu_si128((const __m128i *)(p))
+#define  SSE2_SRC(p) \
+    ((shift == 0) ? SSE2_LOAD(p) : \
+     _mm_or_si128(_mm_sll_epi32(SSE2_LOAD(p), lsh), \
+                  _mm_srl_epi32(SSE2_LOAD((p) + 1), rsh)))
+#define  SSE2_LINES(EXPR) \
+    for (i = 0; i < nlines; i++) { \
+        lines = datas + i * wpls; \
+        lined = datad + i * wpld; \
+        for (j = 0; j < nw; j += 4) { \
+            s = SSE2_SRC(lines + j); \
+            d = SSE2_LOAD(lined + j); \
+            _mm_storeu_si128((__m128i *)(lined + j), (EXPR)); \
+        } \
+    }
+
+#define  AVX2_LOAD(p)    _mm256_loadu_si256((const __m256i *)(p))
+#define  AVX2_SRC(p) \
+    ((shift == 0) ? AVX2_LOAD(p) : \
+     _mm256_or_si256(_mm256_sll_epi32(AVX2_LOAD(p), lsh), \
+                     _mm256_srl_epi32(AVX2_LOAD((p) + 1), rsh)))
+#define  AVX2_LINES(EXPR) \
+    for (i = 0; i < nlines; i++) { \
+        lines = datas + i * wpls; \
+        lined = datad + i * wpld; \
+        for (j = 0; j < nw; j += 8) { \
+            s = AVX2_SRC(lines + j); \
+            d = AVX2_LOAD(lined + j); \
+            _mm256_storeu_si256((__m256i *)(lined + j), (EXPR)); \
+        } \
+    }
+
+
+/*!
+ *  dwaselLinesSSE2()
+ *
+ *      Input:  datad (first line of the result)
+ *              wpld
+ *              datas (first shifted source line, at the word offset)
+ *              wpls
+ *              nlines (number of lines)
+ *              nw (number of words to do in each line; multiple of 4)
+ *              shift (further left shift of the source, in bits)
+ *              type (DWA_SET, DWA_SET_NOT, DWA_OR, DWA_AND, DWA_AND_NOT)
+ *      Return: void
+ */
+static void  L_TARGET_SSE2
+dwaselLinesSSE2(l_uint32  *datad,
+                l_int32    wpld,
+                l_uint32  *datas,
+                l_int32    wpls,
+                l_int32    nlines,
+                l_int32    nw,
+                l_int32    shift,
+                l_int32    type)
+{
+l_int32    i, j;
+l_uint32  *lines, *lined;
+__m128i    s, d, ones, lsh, rsh;
+
+    ones = _mm_set1_epi32(-1);
+    lsh = _mm_cvtsi32_si128(shift);
+    rsh = _mm_cvtsi32_si128(32 - shift);
+
+    switch (type)
+    {
+    case DWA_SET:
+        SSE2_LINES(s);
+        break;
+    case DWA_SET_NOT:
+        SSE2_LINES(_mm_xor_si128(s, ones));
+        break;
+    case DWA_OR:
+        SSE2_LINES(_mm_or_si128(s, d));
+        break;
+    case DWA_AND:
+        SSE2_LINES(_mm_and_si128(s, d));
+        break;
+    default:  /* DWA_AND_NOT */
+        SSE2_LINES(_mm_andnot_si128(s, d));
+        break;
+    }
+    return;
+}
+
+
+/*!
+ *  dwaselLinesAVX2()
+ *
+ *      Input:  datad (first line of the result)
+ *              wpld
+ *              datas (first shifted source line, at the word offset)
+ *              wpls
+ *              nlines (number of lines)
+ *              nw (number of words to do in each line; multiple of 8)
+ *              shift (further left shift of the source, in bits)
+ *              type (DWA_SET, DWA_SET_NOT, DWA_OR, DWA_AND, DWA_AND_NOT)
+ *      Return: void
+ */
+static void  L_TARGET_AVX2
+dwaselLinesAVX2(l_uint32  *datad,
+                l_int32    wpld,
+                l_uint32  *datas,
+                l_int32    wpls,
+                l_int32    nlines,
+                l_int32    nw,
+                l_int32    shift,
+                l_int32    type)
+{
+l_int32    i, j;
+l_uint32  *lines, *lined;
+__m128i    lsh, rsh;
+__m256i    s, d, ones;
+
+    ones = _mm256_set1_epi32(-1);
+    lsh = _mm_cvtsi32_si128(shift);
+    rsh = _mm_cvtsi32_si128(32 - shift);
+
+    switch (type)
+    {
+    case DWA_SET:
+        AVX2_LINES(s);
+        break;
+    case DWA_SET_NOT:
+        AVX2_LINES(_mm256_xor_si256(s, ones));
+        break;
+    case DWA_OR:
+        AVX2_LINES(_mm256_or_si256(s, d));
+        break;
+    case DWA_AND:
+        AVX2_LINES(_mm256_and_si256(s, d));
+        break;
+    default:  /* DWA_AND_NOT */
+        AVX2_LINES(_mm256_andnot_si256(s, d));
+        break;
+    }
+    return;
+}
+#endif  /* USE_SIMD */
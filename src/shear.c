@@ -54,7 +54,8 @@
 #include <math.h>
 #include "allheaders.h"
 
-    /* Shear angle must not get too close to -pi/2 or pi/2 */
+    /* Shear angle must not get too close to -pi/2 or pi/2.
+     * This must match MIN_DIFF_FROM_HALF_PI in skew.c. */
 static const l_float32   MIN_DIFF_FROM_HALF_PI = 0.04;
 
 static l_float32 normalizeAngleForShear(l_float32 radang, l_float32 mindif);
@@ -794,6 +795,8 @@ PIX       *pix, *pixd;
 /*-------------------------------------------------------------------------*
  *                           Angle normalization                           *
  *-------------------------------------------------------------------------*/
+    /* skewShearRowSums() in skew.c has a copy of this, without the
+     * warnings; any change here must also be made there. */
 static l_float32
 normalizeAngleForShear(l_float32  radang,
                        l_float32  mindif)
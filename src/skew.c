@@ -46,6 +46,7 @@
  *
  *      Differential square sum function for scoring
  *          l_int32    pixFindDifferentialSquareSum()
+ *          NUMA      *pixFindDifferentialSquareSumSweep()
  *
  *      Measures of variance of row sums
  *          l_int32    pixFindNormalizedSquareSum()
@@ -92,6 +93,7 @@
  *      handwritten text that may be mixed with printed text.
  */
 
+#include <string.h>
 #include <math.h>
 #include "allheaders.h"
 
@@ -135,6 +137,42 @@ static const l_int32  DEFAULT_BINARY_THRESHOLD = 130;
 #define  DEBUG_PLOT_SCORES      0  /* requires the gnuplot executable */
 #endif  /* ~NO_CONSOLE_IO */
 
+    /* The angles are shifted away from +-pi/2 as in pixVShear().
+     * This must match MIN_DIFF_FROM_HALF_PI in shear.c. */
+static const l_float32  MIN_DIFF_FROM_HALF_PI = 0.04;
+
+    /* Pixel counts of a 1 bpp image, from which the row sums of the
+     * image vertically sheared by any angle are found, and the shear
+     * angles scored by the jobs of skewScoresCompute() */
+struct SkewScores
+{
+    l_uint32   *data;         /* data of the 1 bpp image                  */
+    l_int32     wpl;          /* wpl of the image                         */
+    l_int32     w;            /* width of the image                       */
+    l_int32     h;            /* height of the image                      */
+    l_int32     wplc;         /* entries of cum for each row: nbytes + 1  */
+    l_int32    *cum;          /* ON pixels in each row before each byte   */
+    l_int32    *tab8;         /* ON pixels in each byte                   */
+    l_int32     xloc;         /* column at the shear pivot                */
+    l_float32  *radang;       /* shear angle for each job, in radians     */
+    l_float32  *score;        /* differential square sum from each job    */
+};
+typedef struct SkewScores  SKEW_SCORES;
+
+static l_float32 findDifferentialSquareSum(l_float32 *rowsum, l_int32 w,
+                                           l_int32 h);
+static SKEW_SCORES *skewScoresCreate(PIX *pixs, l_int32 pivot);
+static void skewScoresDestroy(SKEW_SCORES **pss);
+static l_int32 skewScoresCompute(SKEW_SCORES *ss, l_int32 nangles,
+                                 l_float32 *radang, l_float32 *score);
+static l_int32 skewScoreJob(void *data, l_int32 index);
+static void skewShearRowSums(SKEW_SCORES *ss, l_float32 radang,
+                             l_int32 *strip, l_int32 *rowcount);
+static void skewAddStrip(SKEW_SCORES *ss, l_int32 *strip, l_int32 *pnstrips,
+                         l_int32 x0, l_int32 x1, l_int32 shift);
+static l_int32 skewCountToColumn(l_int32 *cum, l_uint32 *line, l_int32 *tab8,
+                                 l_int32 x);
+
 
 
 /*-----------------------------------------------------------------------*
@@ -353,6 +391,8 @@ pixFindSkew(PIX        *pixs,
  *  Notes:
  *      (1) This examines the 'score' for skew angles with equal intervals.
  *      (2) Caller must check the return value for validity of the result.
+ *      (3) The angles are scored on parallel threads, without making
+ *          the sheared images; see pixFindDifferentialSquareSumSweep().
  */
 l_int32
 pixFindSkewSweep(PIX        *pixs,
@@ -361,11 +401,13 @@ pixFindSkewSweep(PIX        *pixs,
                  l_float32   sweeprange,
                  l_float32   sweepdelta)
 {
-l_int32    ret, bzero, i, nangles;
-l_float32  deg2rad, theta;
-l_float32  sum, maxscore, maxangle;
-NUMA      *natheta, *nascore;
-PIX       *pix, *pixt;
+l_int32       ret, bzero, i, nangles;
+l_float32     deg2rad, theta;
+l_float32     maxscore, maxangle;
+l_float32    *radang, *score;
+NUMA         *natheta, *nascore;
+PIX          *pix;
+SKEW_SCORES  *ss;
 
     PROCNAME("pixFindSkewSweep");
 
@@ -401,33 +443,35 @@ PIX       *pix, *pixt;
     nangles = (l_int32)((2. * sweeprange) / sweepdelta + 1);
     natheta = numaCreate(nangles);
     nascore = numaCreate(nangles);
-    pixt = pixCreateTemplate(pix);
+    radang = (l_float32 *)CALLOC(nangles, sizeof(l_float32));
+    score = (l_float32 *)CALLOC(nangles, sizeof(l_float32));
+    ss = skewScoresCreate(pix, L_SHEAR_ABOUT_CORNER);
 
-    if (!pix || !pixt) {
-        ret = ERROR_INT("pix and pixt not both made", procName, 1);
+    if (!pix || !ss) {
+        ret = ERROR_INT("pix and ss not both made", procName, 1);
         goto cleanup;
     }
-    if (!natheta || !nascore) {
-        ret = ERROR_INT("natheta and nascore not both made", procName, 1);
+    if (!natheta || !nascore || !radang || !score) {
+        ret = ERROR_INT("angle and score arrays not made", procName, 1);
         goto cleanup;
     }
 
+        /* Score the shear of pix about the UL corner at each angle */
     for (i = 0; i < nangles; i++) {
         theta = -sweeprange + i * sweepdelta;   /* degrees */
-
-            /* Shear pix about the UL corner and put the result in pixt */
-        pixVShearCorner(pixt, pix, deg2rad * theta, L_BRING_IN_WHITE);
-
-            /* Get score */
-        pixFindDifferentialSquareSum(pixt, &sum);
-
+        radang[i] = deg2rad * theta;
+        numaAddNumber(natheta, theta);
+    }
+    if (skewScoresCompute(ss, nangles, radang, score)) {
+        ret = ERROR_INT("scores not made", procName, 1);
+        goto cleanup;
+    }
+    for (i = 0; i < nangles; i++) {
 #if  DEBUG_PRINT_SCORES
-        L_INFO("sum(%7.2f) = %7.0f\n", procName, theta, sum);
+        L_INFO("sum(%7.2f) = %7.0f\n", procName, -sweeprange + i * sweepdelta,
+               score[i]);
 #endif  /* DEBUG_PRINT_SCORES */
-
-            /* Save the result in the output arrays */
-        numaAddNumber(nascore, sum);
-        numaAddNumber(natheta, theta);
+        numaAddNumber(nascore, score[i]);
     }
 
         /* Find the location of the maximum (i.e., the skew angle)
@@ -463,7 +507,9 @@ PIX       *pix, *pixt;
 
 cleanup:
     pixDestroy(&pix);
-    pixDestroy(&pixt);
+    skewScoresDestroy(&ss);
+    FREE(radang);
+    FREE(score);
     numaDestroy(&nascore);
     numaDestroy(&natheta);
     return ret;
@@ -594,6 +640,10 @@ pixFindSkewSweepAndSearchScore(PIX        *pixs,
  *          for large angles (say, greater than 20 degrees), it is better
  *          to shear about the center because a shear from the UL corner
  *          loses too much of the image.
+ *      (3) The sweep angles, and the pairs of angles in each step of
+ *          the binary search, are scored on parallel threads.  The
+ *          sheared images are not made; see
+ *          pixFindDifferentialSquareSumSweep().
  */
 l_int32
 pixFindSkewSweepAndSearchScorePivot(PIX        *pixs,
@@ -608,17 +658,20 @@ pixFindSkewSweepAndSearchScorePivot(PIX        *pixs,
                                     l_float32   minbsdelta,
                                     l_int32     pivot)
 {
-l_int32    ret, bzero, i, nangles, n, ratio, maxindex, minloc;
-l_int32    width, height;
-l_float32  deg2rad, theta, delta;
-l_float32  sum, maxscore, maxangle;
-l_float32  centerangle, leftcenterangle, rightcenterangle;
-l_float32  lefttemp, righttemp;
-l_float32  bsearchscore[5];
-l_float32  minscore, minthresh;
-l_float32  rangeleft;
-NUMA      *natheta, *nascore;
-PIX       *pixsw, *pixsch, *pixt1, *pixt2;
+l_int32       ret, bzero, i, nangles, n, ratio, maxindex, minloc;
+l_int32       width, height;
+l_float32     deg2rad, theta, delta;
+l_float32     maxscore, maxangle;
+l_float32     centerangle, leftcenterangle, rightcenterangle;
+l_float32     lefttemp, righttemp;
+l_float32     bsearchscore[5];
+l_float32     minscore, minthresh;
+l_float32     rangeleft;
+l_float32     bsradang[3], bsscore[3];
+l_float32    *radang, *score;
+NUMA         *natheta, *nascore;
+PIX          *pixsw, *pixsch;
+SKEW_SCORES  *sssw, *sssch;
 
     PROCNAME("pixFindSkewSweepAndSearchScorePivot");
 
@@ -670,50 +723,50 @@ PIX       *pixsw, *pixsch, *pixt1, *pixt2;
             pixsw = pixReduceRankBinaryCascade(pixsch, 1, 2, 2, 0);
     }
 
-    pixt1 = pixCreateTemplate(pixsw);
+        /* The row counts of the images are found once, and the
+         * scores of the sheared images are then found from them */
+    sssw = skewScoresCreate(pixsw, pivot);
     if (ratio == 1)
-        pixt2 = pixClone(pixt1);
+        sssch = sssw;
     else
-        pixt2 = pixCreateTemplate(pixsch);
+        sssch = skewScoresCreate(pixsch, pivot);
 
     nangles = (l_int32)((2. * sweeprange) / sweepdelta + 1);
     natheta = numaCreate(nangles);
     nascore = numaCreate(nangles);
+    radang = (l_float32 *)CALLOC(nangles, sizeof(l_float32));
+    score = (l_float32 *)CALLOC(nangles, sizeof(l_float32));
 
     if (!pixsch || !pixsw) {
         ret = ERROR_INT("pixsch and pixsw not both made", procName, 1);
         goto cleanup;
     }
-    if (!pixt1 || !pixt2) {
-        ret = ERROR_INT("pixt1 and pixt2 not both made", procName, 1);
+    if (!sssw || !sssch) {
+        ret = ERROR_INT("sssw and sssch not both made", procName, 1);
         goto cleanup;
     }
-    if (!natheta || !nascore) {
-        ret = ERROR_INT("natheta and nascore not both made", procName, 1);
+    if (!natheta || !nascore || !radang || !score) {
+        ret = ERROR_INT("angle and score arrays not made", procName, 1);
         goto cleanup;
     }
 
-        /* Do sweep */
+        /* Do sweep, scoring all the angles together */
     rangeleft = sweepcenter - sweeprange;
     for (i = 0; i < nangles; i++) {
         theta = rangeleft + i * sweepdelta;   /* degrees */
-
-            /* Shear pix and put the result in pixt1 */
-        if (pivot == L_SHEAR_ABOUT_CORNER)
-            pixVShearCorner(pixt1, pixsw, deg2rad * theta, L_BRING_IN_WHITE);
-        else
-            pixVShearCenter(pixt1, pixsw, deg2rad * theta, L_BRING_IN_WHITE);
-
-            /* Get score */
-        pixFindDifferentialSquareSum(pixt1, &sum);
-
+        radang[i] = deg2rad * theta;
+        numaAddNumber(natheta, theta);
+    }
+    if (skewScoresCompute(sssw, nangles, radang, score)) {
+        ret = ERROR_INT("sweep scores not made", procName, 1);
+        goto cleanup;
+    }
+    for (i = 0; i < nangles; i++) {
 #if  DEBUG_PRINT_SCORES
-        L_INFO("sum(%7.2f) = %7.0f\n", procName, theta, sum);
+        L_INFO("sum(%7.2f) = %7.0f\n", procName, rangeleft + i * sweepdelta,
+               score[i]);
 #endif  /* DEBUG_PRINT_SCORES */
-
-            /* Save the result in the output arrays */
-        numaAddNumber(nascore, sum);
-        numaAddNumber(natheta, theta);
+        numaAddNumber(nascore, score[i]);
     }
 
         /* Find the largest of the set (maxscore at maxangle) */
@@ -753,25 +806,16 @@ PIX       *pixsw, *pixsch, *pixt1, *pixt2;
         /* Do binary search to find skew angle.
          * First, set up initial three points. */
     centerangle = maxangle;
-    if (pivot == L_SHEAR_ABOUT_CORNER) {
-        pixVShearCorner(pixt2, pixsch, deg2rad * centerangle, L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[2]);
-        pixVShearCorner(pixt2, pixsch, deg2rad * (centerangle - sweepdelta),
-                        L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[0]);
-        pixVShearCorner(pixt2, pixsch, deg2rad * (centerangle + sweepdelta),
-                        L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[4]);
-    } else {
-        pixVShearCenter(pixt2, pixsch, deg2rad * centerangle, L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[2]);
-        pixVShearCenter(pixt2, pixsch, deg2rad * (centerangle - sweepdelta),
-                        L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[0]);
-        pixVShearCenter(pixt2, pixsch, deg2rad * (centerangle + sweepdelta),
-                        L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[4]);
+    bsradang[0] = deg2rad * centerangle;
+    bsradang[1] = deg2rad * (centerangle - sweepdelta);
+    bsradang[2] = deg2rad * (centerangle + sweepdelta);
+    if (skewScoresCompute(sssch, 3, bsradang, bsscore)) {
+        ret = ERROR_INT("search scores not made", procName, 1);
+        goto cleanup;
     }
+    bsearchscore[2] = bsscore[0];
+    bsearchscore[0] = bsscore[1];
+    bsearchscore[4] = bsscore[2];
 
     numaAddNumber(nascore, bsearchscore[2]);
     numaAddNumber(natheta, centerangle);
@@ -784,27 +828,19 @@ PIX       *pixsw, *pixsch, *pixt1, *pixt2;
     delta = 0.5 * sweepdelta;
     while (delta >= minbsdelta)
     {
-            /* Get the left intermediate score */
+            /* Get the left and right intermediate scores together */
         leftcenterangle = centerangle - delta;
-        if (pivot == L_SHEAR_ABOUT_CORNER)
-            pixVShearCorner(pixt2, pixsch, deg2rad * leftcenterangle,
-                            L_BRING_IN_WHITE);
-        else
-            pixVShearCenter(pixt2, pixsch, deg2rad * leftcenterangle,
-                            L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[1]);
+        rightcenterangle = centerangle + delta;
+        bsradang[0] = deg2rad * leftcenterangle;
+        bsradang[1] = deg2rad * rightcenterangle;
+        if (skewScoresCompute(sssch, 2, bsradang, bsscore)) {
+            ret = ERROR_INT("search scores not made", procName, 1);
+            goto cleanup;
+        }
+        bsearchscore[1] = bsscore[0];
+        bsearchscore[3] = bsscore[1];
         numaAddNumber(nascore, bsearchscore[1]);
         numaAddNumber(natheta, leftcenterangle);
-
-            /* Get the right intermediate score */
-        rightcenterangle = centerangle + delta;
-        if (pivot == L_SHEAR_ABOUT_CORNER)
-            pixVShearCorner(pixt2, pixsch, deg2rad * rightcenterangle,
-                            L_BRING_IN_WHITE);
-        else
-            pixVShearCenter(pixt2, pixsch, deg2rad * rightcenterangle,
-                            L_BRING_IN_WHITE);
-        pixFindDifferentialSquareSum(pixt2, &bsearchscore[3]);
         numaAddNumber(nascore, bsearchscore[3]);
         numaAddNumber(natheta, rightcenterangle);
 
@@ -898,8 +934,11 @@ PIX       *pixsw, *pixsch, *pixt1, *pixt2;
 cleanup:
     pixDestroy(&pixsw);
     pixDestroy(&pixsch);
-    pixDestroy(&pixt1);
-    pixDestroy(&pixt2);
+    if (sssch != sssw)
+        skewScoresDestroy(&sssch);
+    skewScoresDestroy(&sssw);
+    FREE(radang);
+    FREE(score);
     numaDestroy(&nascore);
     numaDestroy(&natheta);
     return ret;
@@ -1041,10 +1080,7 @@ l_int32
 pixFindDifferentialSquareSum(PIX        *pixs,
                              l_float32  *psum)
 {
-l_int32    i, n;
-l_int32    w, h, skiph, skip, nskip;
-l_float32  val1, val2, diff, sum;
-NUMA      *na;
+NUMA  *na;
 
     PROCNAME("pixFindDifferentialSquareSum");
 
@@ -1059,31 +1095,446 @@ NUMA      *na;
     if ((na = pixCountPixelsByRow(pixs, NULL)) == NULL)
         return ERROR_INT("na not made", procName, 1);
 
+    *psum = findDifferentialSquareSum(numaGetFArray(na, L_NOCOPY),
+                                      pixGetWidth(pixs), numaGetCount(na));
+    numaDestroy(&na);
+    return 0;
+}
+
+
+/*!
+ *  pixFindDifferentialSquareSumSweep()
+ *
+ *      Input:  pixs (1 bpp)
+ *              natheta (shear angles, in degrees)
+ *              pivot (L_SHEAR_ABOUT_CORNER, L_SHEAR_ABOUT_CENTER)
+ *      Return: nascore (differential square sum at each angle),
+ *                       or null on error
+ *
+ *  Notes:
+ *      (1) The score at each angle is the same as that from
+ *          pixFindDifferentialSquareSum() on pixs sheared by
+ *          pixVShearCorner() or pixVShearCenter(), bringing in white.
+ *      (2) The sheared images are not made.  The shear moves vertical
+ *          strips of pixs up or down, so the row sums of the sheared
+ *          image are found from the number of ON pixels in each row of
+ *          pixs before each byte, which are counted once.  Each strip
+ *          then adds a difference of two counts to each row.
+ *      (3) The angles are scored on parallel threads; see
+ *          l_setNumThreads().
+ */
+NUMA *
+pixFindDifferentialSquareSumSweep(PIX     *pixs,
+                                  NUMA    *natheta,
+                                  l_int32  pivot)
+{
+l_int32       i, n;
+l_float32     deg2rad, theta;
+l_float32    *radang, *score;
+NUMA         *nascore;
+SKEW_SCORES  *ss;
+
+    PROCNAME("pixFindDifferentialSquareSumSweep");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (NUMA *)ERROR_PTR("pixs not defined or not 1 bpp",
+                                 procName, NULL);
+    if (!natheta)
+        return (NUMA *)ERROR_PTR("natheta not defined", procName, NULL);
+    if (pivot != L_SHEAR_ABOUT_CORNER && pivot != L_SHEAR_ABOUT_CENTER)
+        return (NUMA *)ERROR_PTR("invalid pivot", procName, NULL);
+    if ((n = numaGetCount(natheta)) == 0)
+        return (NUMA *)ERROR_PTR("no angles", procName, NULL);
+
+    if ((ss = skewScoresCreate(pixs, pivot)) == NULL)
+        return (NUMA *)ERROR_PTR("ss not made", procName, NULL);
+    radang = (l_float32 *)CALLOC(n, sizeof(l_float32));
+    score = (l_float32 *)CALLOC(n, sizeof(l_float32));
+    if (!radang || !score) {
+        skewScoresDestroy(&ss);
+        FREE(radang);
+        FREE(score);
+        return (NUMA *)ERROR_PTR("angle and score arrays not made",
+                                 procName, NULL);
+    }
+
+    deg2rad = 3.1415926535 / 180.;
+    for (i = 0; i < n; i++) {
+        numaGetFValue(natheta, i, &theta);
+        radang[i] = deg2rad * theta;
+    }
+    nascore = NULL;
+    if (skewScoresCompute(ss, n, radang, score) == 0) {
+        nascore = numaCreate(n);
+        for (i = 0; i < n; i++)
+            numaAddNumber(nascore, score[i]);
+    }
+
+    skewScoresDestroy(&ss);
+    FREE(radang);
+    FREE(score);
+    if (!nascore)
+        return (NUMA *)ERROR_PTR("scores not made", procName, NULL);
+    return nascore;
+}
+
+
+/*!
+ *  findDifferentialSquareSum()
+ *
+ *      Input:  rowsum (number of ON pixels in each row)
+ *              w (image width)
+ *              h (image height; the number of rows)
+ *      Return: sum of squares of the differences of adjacent row sums
+ *
+ *  Notes:
+ *      (1) At the top and bottom, we skip:
+ *           - at least one scanline
+ *           - not more than 10% of the image height
+ *           - not more than 5% of the image width
+ */
+static l_float32
+findDifferentialSquareSum(l_float32  *rowsum,
+                          l_int32     w,
+                          l_int32     h)
+{
+l_int32    i, skiph, skip, nskip;
+l_float32  diff, sum;
+
         /* Compute the number of rows at top and bottom to omit.
          * We omit these to avoid getting a spurious signal from
          * the top and bottom of a (nearly) all black image. */
-    w = pixGetWidth(pixs);
-    h = pixGetHeight(pixs);
     skiph = (l_int32)(0.05 * w);  /* skip for max shear of 0.025 radians */
     skip = L_MIN(h / 10, skiph);  /* don't remove more than 10% of image */
     nskip = L_MAX(skip / 2, 1);  /* at top & bot; skip at least one line */
 
         /* Sum the squares of differential row sums, on the
          * allowed rows.  Note that nskip must be >= 1. */
-    n = numaGetCount(na);
     sum = 0.0;
-    for (i = nskip; i < n - nskip; i++) {
-        numaGetFValue(na, i - 1, &val1);
-        numaGetFValue(na, i, &val2);
-        diff = val2 - val1;
+    for (i = nskip; i < h - nskip; i++) {
+        diff = rowsum[i] - rowsum[i - 1];
         sum += diff * diff;
     }
-    numaDestroy(&na);
-    *psum = sum;
+    return sum;
+}
+
+
+/*!
+ *  skewScoresCreate()
+ *
+ *      Input:  pixs (1 bpp)
+ *              pivot (L_SHEAR_ABOUT_CORNER, L_SHEAR_ABOUT_CENTER)
+ *      Return: ss, or null on error
+ *
+ *  Notes:
+ *      (1) For each row, cum[k] is the number of ON pixels in the
+ *          first k bytes, for k = 0 ... nbytes.  The pad bits of the
+ *          last byte are not counted.
+ *      (2) pixs must not be changed or destroyed while ss is in use.
+ */
+static SKEW_SCORES *
+skewScoresCreate(PIX     *pixs,
+                 l_int32  pivot)
+{
+l_int32       i, k, w, h, wpl, nbytes, count, byte;
+l_int32      *cum, *tab8;
+l_uint32     *line;
+SKEW_SCORES  *ss;
+
+    PROCNAME("skewScoresCreate");
+
+    if (!pixs || pixGetDepth(pixs) != 1)
+        return (SKEW_SCORES *)ERROR_PTR("pixs not defined or not 1 bpp",
+                                        procName, NULL);
+
+    if ((ss = (SKEW_SCORES *)CALLOC(1, sizeof(SKEW_SCORES))) == NULL)
+        return (SKEW_SCORES *)ERROR_PTR("ss not made", procName, NULL);
+    pixGetDimensions(pixs, &w, &h, NULL);
+    wpl = pixGetWpl(pixs);
+    nbytes = (w + 7) / 8;
+    ss->data = pixGetData(pixs);
+    ss->wpl = wpl;
+    ss->w = w;
+    ss->h = h;
+    ss->wplc = nbytes + 1;
+    ss->xloc = (pivot == L_SHEAR_ABOUT_CENTER) ? w / 2 : 0;
+    ss->tab8 = makePixelSumTab8();
+    ss->cum = (l_int32 *)CALLOC(h * ss->wplc, sizeof(l_int32));
+    if (!ss->tab8 || !ss->cum) {
+        skewScoresDestroy(&ss);
+        return (SKEW_SCORES *)ERROR_PTR("tables not made", procName, NULL);
+    }
+
+    tab8 = ss->tab8;
+    for (i = 0; i < h; i++) {
+        line = ss->data + i * wpl;
+        cum = ss->cum + i * ss->wplc;
+        count = 0;
+        for (k = 0; k < nbytes; k++) {
+            cum[k] = count;
+            byte = GET_DATA_BYTE(line, k);
+            if (k == nbytes - 1 && (w & 7))
+                byte &= 0xff00 >> (w & 7);
+            count += tab8[byte];
+        }
+        cum[nbytes] = count;
+    }
+
+    return ss;
+}
+
+
+/*!
+ *  skewScoresDestroy()
+ *
+ *      Input:  &ss (<to be nulled>)
+ *      Return: void
+ */
+static void
+skewScoresDestroy(SKEW_SCORES  **pss)
+{
+SKEW_SCORES  *ss;
+
+    if (!pss || (ss = *pss) == NULL)
+        return;
+    FREE(ss->cum);
+    FREE(ss->tab8);
+    FREE(ss);
+    *pss = NULL;
+}
+
+
+/*!
+ *  skewScoresCompute()
+ *
+ *      Input:  ss
+ *              nangles (number of shear angles)
+ *              radang (array of nangles shear angles, in radians)
+ *              score (array of nangles, for the returned scores)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Each angle is scored by a separate job, and the jobs are
+ *          run on the default number of threads.
+ */
+static l_int32
+skewScoresCompute(SKEW_SCORES  *ss,
+                  l_int32       nangles,
+                  l_float32    *radang,
+                  l_float32    *score)
+{
+l_int32  i, ret;
+
+    ss->radang = radang;
+    ss->score = score;
+    ret = l_parallelRun(nangles, skewScoreJob, ss, 0);
+    for (i = 0; i < nangles; i++) {
+        if (score[i] < 0.0)
+            ret = 1;
+    }
+    ss->radang = NULL;
+    ss->score = NULL;
+    return ret;
+}
+
+
+    /* Job for skewScoresCompute(): the score at one shear angle.
+     * A score of -1.0 is returned if the row sums can't be made. */
+static l_int32
+skewScoreJob(void    *data,
+             l_int32  index)
+{
+l_int32       i, h;
+l_int32      *strip, *rowcount;
+l_float32    *rowsum;
+SKEW_SCORES  *ss;
+
+    ss = (SKEW_SCORES *)data;
+    h = ss->h;
+    ss->score[index] = -1.0;
+    strip = (l_int32 *)CALLOC(3 * (ss->w + 2), sizeof(l_int32));
+    rowcount = (l_int32 *)CALLOC(h, sizeof(l_int32));
+    rowsum = (l_float32 *)CALLOC(h, sizeof(l_float32));
+    if (!strip || !rowcount || !rowsum) {
+        FREE(strip);
+        FREE(rowcount);
+        FREE(rowsum);
+        return 1;
+    }
+
+    skewShearRowSums(ss, ss->radang[index], strip, rowcount);
+    for (i = 0; i < h; i++)
+        rowsum[i] = (l_float32)rowcount[i];
+    ss->score[index] = findDifferentialSquareSum(rowsum, ss->w, h);
+
+    FREE(strip);
+    FREE(rowcount);
+    FREE(rowsum);
     return 0;
 }
 
 
+/*!
+ *  skewShearRowSums()
+ *
+ *      Input:  ss
+ *              radang (shear angle, in radians)
+ *              strip (work array of size 3 * (w + 2))
+ *              rowcount (array of h, for the returned row sums)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) This gives the row sums of the image sheared about ss->xloc,
+ *          bringing in white.  The angle is normalized and the image
+ *          is divided into strips exactly as in pixVShear().
+ *      (2) The strips are found first, and each row of the image
+ *          is then added, one strip at a time, to the rows that it
+ *          is shifted to, so that the counts are read in order.
+ *          Adjacent strips share the count at their common column.
+ *      (3) The angle normalization is a copy of normalizeAngleForShear()
+ *          in shear.c, and the two must be kept the same.  The warning
+ *          that it gives for angles near +-pi/2 is dropped, because
+ *          this is called from the jobs of skewScoresCompute().
+ */
+static void
+skewShearRowSums(SKEW_SCORES  *ss,
+                 l_float32     radang,
+                 l_int32      *strip,
+                 l_int32      *rowcount)
+{
+l_int32    i, j, y, w, h, sign, xloc, x, xincr, initxincr, vshift, nstrips;
+l_int32    x0, x1, c0, c1, xp0, xp1, cp0, cp1;
+l_int32   *cum, *tab8;
+l_uint32  *line;
+l_float32  pi2, tanangle, invangle;
+
+    w = ss->w;
+    h = ss->h;
+    xloc = ss->xloc;
+    memset(rowcount, 0, h * sizeof(l_int32));
+    nstrips = 0;
+
+       /* Bring angle into range [-pi/2, pi/2], away from the ends,
+        * as in normalizeAngleForShear() */
+    pi2 = 3.14159265 / 2.0;
+    if (radang < -pi2 || radang > pi2)
+        radang = radang - (l_int32)(radang / pi2) * pi2;
+    if (radang > pi2 - MIN_DIFF_FROM_HALF_PI)
+        radang = pi2 - MIN_DIFF_FROM_HALF_PI;
+    else if (radang < -pi2 + MIN_DIFF_FROM_HALF_PI)
+        radang = -pi2 + MIN_DIFF_FROM_HALF_PI;
+
+    if (radang == 0.0 || tan(radang) == 0.0) {
+        skewAddStrip(ss, strip, &nstrips, 0, w, 0);
+    } else {
+        sign = L_SIGN(radang);
+        tanangle = tan(radang);
+        invangle = L_ABS(1. / tanangle);
+        initxincr = (l_int32)(invangle / 2.);
+        skewAddStrip(ss, strip, &nstrips, xloc - initxincr,
+                     xloc + initxincr, 0);
+
+        for (vshift = 1, x = xloc + initxincr; x < w; vshift++) {
+            xincr = (l_int32)(invangle * (vshift + 0.5) + 0.5) - (x - xloc);
+            if (w - x < xincr)  /* reduce for last one if req'd */
+                xincr = w - x;
+            skewAddStrip(ss, strip, &nstrips, x, x + xincr, sign * vshift);
+            x += xincr;
+        }
+
+        for (vshift = -1, x = xloc - initxincr; x > 0; vshift--) {
+            xincr = (x - xloc) - (l_int32)(invangle * (vshift - 0.5) + 0.5);
+            if (x < xincr)  /* reduce for last one if req'd */
+                xincr = x;
+            skewAddStrip(ss, strip, &nstrips, x - xincr, x, sign * vshift);
+            x -= xincr;
+        }
+    }
+
+        /* Strip j covers columns [strip[3j], strip[3j+1]) and is
+         * shifted down by strip[3j+2] */
+    tab8 = ss->tab8;
+    for (i = 0; i < h; i++) {
+        cum = ss->cum + i * ss->wplc;
+        line = ss->data + i * ss->wpl;
+        xp0 = xp1 = -1;
+        cp0 = cp1 = 0;
+        for (j = 0; j < nstrips; j++) {
+            y = i + strip[3 * j + 2];
+            if (y < 0 || y >= h)
+                continue;
+            x0 = strip[3 * j];
+            x1 = strip[3 * j + 1];
+            if (x1 == xp0)  /* strips going left */
+                c1 = cp0;
+            else
+                c1 = skewCountToColumn(cum, line, tab8, x1);
+            if (x0 == xp1)  /* strips going right */
+                c0 = cp1;
+            else
+                c0 = skewCountToColumn(cum, line, tab8, x0);
+            rowcount[y] += c1 - c0;
+            xp0 = x0;
+            xp1 = x1;
+            cp0 = c0;
+            cp1 = c1;
+        }
+    }
+}
+
+
+/*!
+ *  skewAddStrip()
+ *
+ *      Input:  ss
+ *              strip (array of strips; 3 entries for each)
+ *              &nstrips (<in/out> number of strips)
+ *              x0, x1 (columns [x0, x1) of the strip; clipped to the image)
+ *              shift (vertical shift of the strip; down is positive)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) Strips that are empty after clipping are not saved.
+ */
+static void
+skewAddStrip(SKEW_SCORES  *ss,
+             l_int32      *strip,
+             l_int32      *pnstrips,
+             l_int32       x0,
+             l_int32       x1,
+             l_int32       shift)
+{
+l_int32  n;
+
+    x0 = L_MAX(0, x0);
+    x1 = L_MIN(ss->w, x1);
+    if (x0 >= x1 || shift <= -ss->h || shift >= ss->h)
+        return;
+    n = *pnstrips;
+    strip[3 * n] = x0;
+    strip[3 * n + 1] = x1;
+    strip[3 * n + 2] = shift;
+    *pnstrips = n + 1;
+}
+
+
+    /* Returns the number of ON pixels in the row to the left of column x,
+     * where 0 <= x <= w.  The row counts before each byte are in cum. */
+static l_int32
+skewCountToColumn(l_int32   *cum,
+                  l_uint32  *line,
+                  l_int32   *tab8,
+                  l_int32    x)
+{
+l_int32  k;
+
+    k = x >> 3;
+    if ((x & 7) == 0)
+        return cum[k];
+    return cum[k] + tab8[GET_DATA_BYTE(line, k) & (0xff00 >> (x & 7))];
+}
+
+
 /*----------------------------------------------------------------*
  *                        Normalized square sum                   *
  *----------------------------------------------------------------*/
@@ -32,8 +32,14 @@
  *    function serializes it to memory, and it is wrapped to be
  *    callable from standard pixRead and pixWrite functions.
  *
+ *    The raster data in a spix file starts on a 4-byte boundary,
+ *    and is laid out exactly as in the pix.  pixReadMappedSpix()
+ *    uses this to map the file into memory and wrap the raster as the
+ *    pix data, without reading or copying it.
+ *
  *      Reading spix from file
  *           PIX        *pixReadStreamSpix()
+ *           PIX        *pixReadMappedSpix()
  *           l_int32     readHeaderSpix()
  *           l_int32     freadHeaderSpix()
  *           l_int32     sreadHeaderSpix()
@@ -94,6 +100,83 @@ PIX      *pix;
 }
 
 
+/*!
+ *  pixReadMappedSpix()
+ *
+ *      Input:  filename (of a spix file)
+ *      Return: pix, or null on error
+ *
+ *  Notes:
+ *      (1) The file is mapped into memory with l_binaryMap(), and the
+ *          raster data in the file is used directly as the pix data.
+ *          Nothing is copied, and only the pages that are used are
+ *          read from disk.  This is the fastest way to bring back a
+ *          large image that was saved with pixWrite(..., IFF_SPIX).
+ *      (2) The pix owns the mapping, which is released by pixDestroy().
+ *      (3) The pix can be modified like any other; the changes are
+ *          made to private copies of the pages and never go to the file.
+ *      (4) The file must not be truncated or overwritten while the pix
+ *          exists.
+ */
+PIX *
+pixReadMappedSpix(const char  *filename)
+{
+l_int32    w, h, d, wpl, ncolors, index;
+size_t     nbytes;
+l_uint32  *data;
+PIX       *pix;
+PIXCMAP   *cmap;
+
+    PROCNAME("pixReadMappedSpix");
+
+    if (!filename)
+        return (PIX *)ERROR_PTR("filename not defined", procName, NULL);
+
+    if ((data = (l_uint32 *)l_binaryMap(filename, &nbytes)) == NULL)
+        return (PIX *)ERROR_PTR("file not mapped", procName, NULL);
+
+        /* Validate the header against the size of the file */
+    if (nbytes < 28 || memcmp(data, "spix", 4) != 0) {
+        l_binaryUnmap(data, nbytes);
+        return (PIX *)ERROR_PTR("not a spix file", procName, NULL);
+    }
+    w = data[1];
+    h = data[2];
+    d = data[3];
+    wpl = data[4];
+    ncolors = data[5];
+    index = 6 + ncolors;
+    if (ncolors < 0 || ncolors > 256 || 4 * (index + 1) > nbytes ||
+        (pix = pixCreateHeader(w, h, d)) == NULL) {
+        l_binaryUnmap(data, nbytes);
+        return (PIX *)ERROR_PTR("invalid header", procName, NULL);
+    }
+    if (wpl != pixGetWpl(pix) || data[index] != 4 * wpl * h ||
+        4 * (index + 1) + 4 * (size_t)wpl * h > nbytes) {
+        pixDestroy(&pix);
+        l_binaryUnmap(data, nbytes);
+        return (PIX *)ERROR_PTR("raster size is inconsistent", procName,
+                                NULL);
+    }
+
+    if (ncolors > 0) {
+        cmap = pixcmapDeserializeFromMemory((l_uint8 *)(&data[6]), 4, ncolors);
+        if (!cmap) {
+            pixDestroy(&pix);
+            l_binaryUnmap(data, nbytes);
+            return (PIX *)ERROR_PTR("cmap not made", procName, NULL);
+        }
+        pixSetColormap(pix, cmap);
+    }
+
+    pixSetData(pix, data + index + 1);
+    pix->mapdata = data;
+    pix->mapsize = nbytes;
+    pixSetInputFormat(pix, IFF_SPIX);
+    return pix;
+}
+
+
 /*!
  *  readHeaderSpix()
  *
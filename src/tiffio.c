@@ -37,6 +37,8 @@
  *             l_int32    pixWriteTiffCustom()   [ special top level ]
  *             l_int32    pixWriteStreamTiff()
  *      static l_int32    pixWriteToTiffStream()
+ *      static l_int32    writeTiffHeaderTags()
+ *      static l_int32    writeTiffScanlines()
  *      static l_int32    writeCustomTiffTags()
  *
  *     Reading and writing multipage tiff
@@ -44,6 +46,16 @@
  *             l_int32    writeMultipageTiff()  [ special top level ]
  *             l_int32    writeMultipageTiffSA()
  *
+ *     Reading and writing tiff in bands of rows
+ *             L_TIFF_STREAM  *tiffstreamOpenRead()
+ *             L_TIFF_STREAM  *tiffstreamOpenWrite()
+ *             void            tiffstreamClose()
+ *             l_int32         tiffstreamGetInfo()
+ *             PIX            *tiffstreamReadRows()
+ *      static l_int32         tiffstreamReadChunk()
+ *             l_int32         tiffstreamWriteRows()
+ *             l_int32         tiffstreamProcess()
+ *
  *     Information about tiff file
  *             l_int32    fprintTiffInfo()
  *             l_int32    tiffGetCount()
@@ -114,6 +126,9 @@ static l_int32   writeCustomTiffTags(TIFF *tif, NUMA *natags,
 static l_int32   pixWriteToTiffStream(TIFF *tif, PIX *pix, l_int32 comptype,
                                       NUMA *natags, SARRAY *savals,
                                       SARRAY *satypes, NUMA *nasizes);
+static l_int32   writeTiffHeaderTags(TIFF *tif, PIX *pix, l_int32 comptype);
+static l_int32   writeTiffScanlines(TIFF *tif, PIX *pix, l_int32 firstrow);
+static l_int32   tiffstreamReadChunk(L_TIFF_STREAM *ts, l_int32 row);
 static TIFF     *fopenTiff(FILE *fp, const char *modestring);
 static TIFF     *openTiff(const char *filename, const char *modestring);
 
@@ -811,17 +826,54 @@ pixWriteToTiffStream(TIFF    *tif,
                      SARRAY  *satypes,
                      NUMA    *nasizes)
 {
-l_uint8   *linebuf, *data;
+    PROCNAME("pixWriteToTiffStream");
+
+    if (!tif)
+        return ERROR_INT("tif stream not defined", procName, 1);
+    if (!pix)
+        return ERROR_INT( "pix not defined", procName, 1 );
+
+        /* ------------------ Write out the header -------------  */
+    writeTiffHeaderTags(tif, pix, comptype);
+
+        /* This is a no-op if arrays are NULL */
+    writeCustomTiffTags(tif, natags, savals, satypes, nasizes);
+
+        /* ------------- Write out the image data -------------  */
+        /* Use single strip for image */
+    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, pixGetHeight(pix));
+    return writeTiffScanlines(tif, pix, 0);
+}
+
+
+/*!
+ *  writeTiffHeaderTags()
+ *
+ *      Input:  tif (data structure, opened to a file)
+ *              pix
+ *              comptype (see pixWriteToTiffStream())
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This sets the standard tags that describe the image:
+ *          size, resolution, photometry, samples and colormap,
+ *          and compression.  The image length is taken from @pix;
+ *          when the image is written in bands, libtiff extends it
+ *          as rows are added.
+ */
+static l_int32
+writeTiffHeaderTags(TIFF    *tif,
+                    PIX     *pix,
+                    l_int32  comptype)
+{
 l_uint16   redmap[256], greenmap[256], bluemap[256];
-l_int32    w, h, d, i, j, k, wpl, bpl, tiffbpl, ncolors, cmapsize;
+l_int32    w, h, d, i, ncolors, cmapsize;
 l_int32   *rmap, *gmap, *bmap;
 l_int32    xres, yres;
-l_uint32  *line, *ppixel;
-PIX       *pixt;
 PIXCMAP   *cmap;
 char      *text;
 
-    PROCNAME("pixWriteToTiffStream");
+    PROCNAME("writeTiffHeaderTags");
 
     if (!tif)
         return ERROR_INT("tif stream not defined", procName, 1);
@@ -834,7 +886,6 @@ char      *text;
     if (xres == 0) xres = DEFAULT_RESOLUTION;
     if (yres == 0) yres = DEFAULT_RESOLUTION;
 
-        /* ------------------ Write out the header -------------  */
     TIFFSetField(tif, TIFFTAG_RESOLUTIONUNIT, (l_uint32)RESUNIT_INCH);
     TIFFSetField(tif, TIFFTAG_XRESOLUTION, (l_float64)xres);
     TIFFSetField(tif, TIFFTAG_YRESOLUTION, (l_float64)yres);
@@ -908,10 +959,40 @@ char      *text;
         TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
     }
 
-        /* This is a no-op if arrays are NULL */
-    writeCustomTiffTags(tif, natags, savals, satypes, nasizes);
+    return 0;
+}
 
-        /* ------------- Write out the image data -------------  */
+
+/*!
+ *  writeTiffScanlines()
+ *
+ *      Input:  tif (data structure, with the header tags set)
+ *              pix
+ *              firstrow (row in the tiff image for the first line of pix)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Writes all the lines of @pix, starting at @firstrow in the
+ *          tiff image.  Lines must be written in increasing order.
+ */
+static l_int32
+writeTiffScanlines(TIFF    *tif,
+                   PIX     *pix,
+                   l_int32  firstrow)
+{
+l_uint8   *linebuf, *data;
+l_int32    w, h, d, i, j, k, wpl, bpl, tiffbpl;
+l_uint32  *line, *ppixel;
+PIX       *pixt;
+
+    PROCNAME("writeTiffScanlines");
+
+    if (!tif)
+        return ERROR_INT("tif stream not defined", procName, 1);
+    if (!pix)
+        return ERROR_INT( "pix not defined", procName, 1 );
+
+    pixGetDimensions(pix, &w, &h, &d);
     tiffbpl = TIFFScanlineSize(tif);
     wpl = pixGetWpl(pix);
     bpl = 4 * wpl;
@@ -920,9 +1001,6 @@ char      *text;
     if ((linebuf = (l_uint8 *)CALLOC(1, bpl)) == NULL)
         return ERROR_INT("calloc fail for linebuf", procName, 1);
 
-        /* Use single strip for image */
-    TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, h);
-
     if (d != 24 && d != 32) {
         if (d == 16)
             pixt = pixEndianTwoByteSwapNew(pix);
@@ -931,14 +1009,14 @@ char      *text;
         data = (l_uint8 *)pixGetData(pixt);
         for (i = 0; i < h; i++, data += bpl) {
             memcpy((char *)linebuf, (char *)data, tiffbpl);
-            if (TIFFWriteScanline(tif, linebuf, i, 0) < 0)
+            if (TIFFWriteScanline(tif, linebuf, firstrow + i, 0) < 0)
                 break;
         }
         pixDestroy(&pixt);
-    } else if (d == 24) {  /* See note 4 above: special case of 24 bpp rgb */
+    } else if (d == 24) {  /* see pixWriteToTiffStream(), note 4 */
         for (i = 0; i < h; i++) {
             line = pixGetData(pix) + i * wpl;
-            if (TIFFWriteScanline(tif, (l_uint8 *)line, i, 0) < 0)
+            if (TIFFWriteScanline(tif, (l_uint8 *)line, firstrow + i, 0) < 0)
                 break;
         }
     } else {  /* standard 32 bpp rgb */
@@ -950,7 +1028,7 @@ char      *text;
                 linebuf[k++] = GET_DATA_BYTE(ppixel, COLOR_BLUE);
                 ppixel++;
             }
-            if (TIFFWriteScanline(tif, linebuf, i, 0) < 0)
+            if (TIFFWriteScanline(tif, linebuf, firstrow + i, 0) < 0)
                 break;
         }
     }
@@ -1231,6 +1309,671 @@ PIX         *pix, *pixt;
 }
 
 
+/*--------------------------------------------------------------*
+ *           Reading and writing tiff in bands of rows          *
+ *--------------------------------------------------------------*/
+/*
+ *  These functions let a tiff image be processed a band of rows at
+ *  a time, so that the full image is never held in memory.  This is
+ *  useful for very large scans, where a row-local operation such as
+ *  color to gray conversion, thresholding or scaling is all that is
+ *  required.  A typical use is:
+ *
+ *      tsin = tiffstreamOpenRead(filein, 0);
+ *      tiffstreamGetInfo(tsin, NULL, &h, NULL, NULL);
+ *      tsout = tiffstreamOpenWrite(fileout, h, IFF_TIFF_G4);
+ *      while ((pix1 = tiffstreamReadRows(tsin, 256)) != NULL) {
+ *          pix2 = pixConvertRGBToGray(pix1, 0.0, 0.0, 0.0);
+ *          pix3 = pixThresholdToBinary(pix2, 128);
+ *          tiffstreamWriteRows(tsout, pix3);
+ *          ...  [destroy the pix]
+ *      }
+ *      tiffstreamClose(&tsin);
+ *      tiffstreamClose(&tsout);
+ *
+ *  or, equivalently, tiffstreamProcess() with a band function.
+ *
+ *  For reading, the rows are decoded with TIFFReadScanline() for
+ *  all images with 1 sample/pixel and for 8 bit rgb.  Other images
+ *  with 3 or 4 samples/pixel, including tiled images, are decoded
+ *  with libtiff's rgba interface one strip, or one row of tiles,
+ *  at a time; in that case the memory used is set by the strip or
+ *  tile size in the file.
+ */
+struct L_TiffStream
+{
+    TIFF      *tif;       /* opened for reading or writing                 */
+    l_int32    write;     /* 1 if opened for writing; 0 for reading        */
+    l_int32    w;         /* image width                                   */
+    l_int32    h;         /* image height                                  */
+    l_int32    d;         /* depth of the pix that are read or written     */
+    l_int32    spp;       /* samples/pixel in the file                     */
+    l_int32    bps;       /* bits/sample in the file                       */
+    l_int32    comptype;  /* IFF_TIFF, IFF_TIFF_G4, etc.                   */
+    l_int32    xres;      /* x resolution (ppi); 0 if unknown              */
+    l_int32    yres;      /* y resolution (ppi); 0 if unknown              */
+    l_int32    nextrow;   /* next row in the image to be read or written   */
+    l_int32    invert;    /* reading: photometry requires inversion        */
+    PIXCMAP   *cmap;      /* reading: colormap from the file; can be null  */
+    l_uint8   *linebuf;   /* reading: buffer for one tiff scanline         */
+    l_uint32  *chunk;     /* reading rgba: decoded rows, top row first     */
+    l_int32    chunkh;    /* reading rgba: rows per strip or tile          */
+    l_int32    chunky;    /* reading rgba: first row in chunk; -1 if none  */
+    l_uint32  *tilebuf;   /* reading rgba: one decoded tile; null if strip */
+    l_int32    tilew;     /* reading rgba: tile width                      */
+};
+
+
+/*!
+ *  tiffstreamOpenRead()
+ *
+ *      Input:  filename
+ *              n (page number: 0 based)
+ *      Return: tiffstream, or null on error
+ *
+ *  Notes:
+ *      (1) Use tiffstreamReadRows() to get the image in bands, and
+ *          tiffstreamClose() when finished.
+ *      (2) The depth of the pix that are returned follows
+ *          pixReadTiff(): images with 1 sample/pixel have the depth
+ *          of the sample (with the colormap, if any, attached to
+ *          each band), and images with 3 or 4 samples/pixel are
+ *          returned as 32 bpp rgb.
+ *      (3) Because the rows are delivered in order, images with an
+ *          orientation other than ORIENTATION_TOPLEFT are not
+ *          supported.  Nor are tiled images with 1 sample/pixel.
+ *          Use pixReadTiff() for these.
+ */
+L_TIFF_STREAM *
+tiffstreamOpenRead(const char  *filename,
+                   l_int32      n)
+{
+l_uint16        spp, bps, photometry, planar, tiffcomp, orientation;
+l_uint16       *redmap, *greenmap, *bluemap;
+l_uint32        w, h, rowsperstrip, tilew, tileh;
+l_int32         i, d, ncolors, xres, yres, havephoto;
+PIXCMAP        *cmap;
+L_TIFF_STREAM  *ts;
+TIFF           *tif;
+
+    PROCNAME("tiffstreamOpenRead");
+
+    if (!filename)
+        return (L_TIFF_STREAM *)ERROR_PTR("filename not defined",
+                                          procName, NULL);
+    if (n < 0 || n >= MAX_PAGES_IN_TIFF_FILE)
+        return (L_TIFF_STREAM *)ERROR_PTR("invalid page number",
+                                          procName, NULL);
+
+    if ((tif = openTiff(filename, "r")) == NULL)
+        return (L_TIFF_STREAM *)ERROR_PTR("tif not opened", procName, NULL);
+    if (n > 0 && TIFFSetDirectory(tif, n) == 0) {
+        TIFFClose(tif);
+        L_ERROR("tiff page %d not found\n", procName, n);
+        return NULL;
+    }
+
+    TIFFGetFieldDefaulted(tif, TIFFTAG_BITSPERSAMPLE, &bps);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_SAMPLESPERPIXEL, &spp);
+    TIFFGetFieldDefaulted(tif, TIFFTAG_PLANARCONFIG, &planar);
+    TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &w);
+    TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &h);
+    if (spp == 1 && (bps == 1 || bps == 2 || bps == 4 || bps == 8 ||
+                     bps == 16)) {
+        d = bps;
+    } else if (spp == 3 || spp == 4) {
+        d = 32;
+    } else {
+        TIFFClose(tif);
+        return (L_TIFF_STREAM *)ERROR_PTR("invalid spp or bps",
+                                          procName, NULL);
+    }
+    if (TIFFGetField(tif, TIFFTAG_ORIENTATION, &orientation) &&
+        orientation != ORIENTATION_TOPLEFT) {
+        TIFFClose(tif);
+        return (L_TIFF_STREAM *)ERROR_PTR("orientation not supported",
+                                          procName, NULL);
+    }
+    if (spp == 1 && TIFFIsTiled(tif)) {
+        TIFFClose(tif);
+        return (L_TIFF_STREAM *)ERROR_PTR("tiled 1 spp image not supported",
+                                          procName, NULL);
+    }
+
+    if ((ts = (L_TIFF_STREAM *)CALLOC(1, sizeof(L_TIFF_STREAM))) == NULL) {
+        TIFFClose(tif);
+        return (L_TIFF_STREAM *)ERROR_PTR("ts not made", procName, NULL);
+    }
+    ts->tif = tif;
+    ts->w = w;
+    ts->h = h;
+    ts->d = d;
+    ts->spp = spp;
+    ts->bps = bps;
+    ts->chunky = -1;
+    if (getTiffStreamResolution(tif, &xres, &yres) == 0) {
+        ts->xres = xres;
+        ts->yres = yres;
+    }
+    TIFFGetFieldDefaulted(tif, TIFFTAG_COMPRESSION, &tiffcomp);
+    ts->comptype = getTiffCompressedFormat(tiffcomp);
+    havephoto = TIFFGetField(tif, TIFFTAG_PHOTOMETRIC, &photometry);
+
+        /* Set up for the colormap or photometry; see
+         * pixReadFromTiffStream() */
+    if (spp == 1) {
+        if (TIFFGetField(tif, TIFFTAG_COLORMAP, &redmap, &greenmap,
+                         &bluemap)) {
+            if (bps > 8) {
+                tiffstreamClose(&ts);
+                return (L_TIFF_STREAM *)ERROR_PTR("invalid bps; > 8",
+                                                  procName, NULL);
+            }
+            cmap = pixcmapCreate(bps);
+            ncolors = 1 << bps;
+            for (i = 0; i < ncolors; i++)
+                pixcmapAddColor(cmap, redmap[i] >> 8, greenmap[i] >> 8,
+                                bluemap[i] >> 8);
+            ts->cmap = cmap;
+        } else {
+            if (!havephoto) {
+                if (tiffcomp == COMPRESSION_CCITTFAX3 ||
+                    tiffcomp == COMPRESSION_CCITTFAX4 ||
+                    tiffcomp == COMPRESSION_CCITTRLE ||
+                    tiffcomp == COMPRESSION_CCITTRLEW) {
+                    photometry = PHOTOMETRIC_MINISWHITE;
+                } else {
+                    photometry = PHOTOMETRIC_MINISBLACK;
+                }
+            }
+            if ((d == 1 && photometry == PHOTOMETRIC_MINISBLACK) ||
+                (d == 8 && photometry == PHOTOMETRIC_MINISWHITE))
+                ts->invert = TRUE;
+        }
+    }
+
+        /* Choose between scanline and rgba decoding */
+    if (spp == 1 || (bps == 8 && planar == PLANARCONFIG_CONTIG &&
+        havephoto && photometry == PHOTOMETRIC_RGB && !TIFFIsTiled(tif))) {
+        ts->linebuf = (l_uint8 *)CALLOC(TIFFScanlineSize(tif) + 1,
+                                        sizeof(l_uint8));
+    } else {
+        if (TIFFIsTiled(tif)) {
+            TIFFGetField(tif, TIFFTAG_TILEWIDTH, &tilew);
+            TIFFGetField(tif, TIFFTAG_TILELENGTH, &tileh);
+            ts->tilew = tilew;
+            ts->chunkh = tileh;
+            ts->tilebuf = (l_uint32 *)CALLOC(tilew * tileh, sizeof(l_uint32));
+        } else {
+            TIFFGetFieldDefaulted(tif, TIFFTAG_ROWSPERSTRIP, &rowsperstrip);
+            ts->chunkh = L_MIN(rowsperstrip, h);
+        }
+        ts->chunk = (l_uint32 *)CALLOC(w * ts->chunkh, sizeof(l_uint32));
+        ts->linebuf = (l_uint8 *)CALLOC(w, sizeof(l_uint32));
+        if (!ts->chunk || (TIFFIsTiled(tif) && !ts->tilebuf)) {
+            tiffstreamClose(&ts);
+            return (L_TIFF_STREAM *)ERROR_PTR("calloc fail for chunk",
+                                              procName, NULL);
+        }
+    }
+    if (!ts->linebuf) {
+        tiffstreamClose(&ts);
+        return (L_TIFF_STREAM *)ERROR_PTR("calloc fail for linebuf",
+                                          procName, NULL);
+    }
+
+    return ts;
+}
+
+
+/*!
+ *  tiffstreamOpenWrite()
+ *
+ *      Input:  filename
+ *              h (height of the image to be written)
+ *              comptype (IFF_TIFF, IFF_TIFF_RLE, IFF_TIFF_PACKBITS,
+ *                        IFF_TIFF_G3, IFF_TIFF_G4,
+ *                        IFF_TIFF_LZW, IFF_TIFF_ZIP)
+ *      Return: tiffstream, or null on error
+ *
+ *  Notes:
+ *      (1) Use tiffstreamWriteRows() to write the image in bands, and
+ *          tiffstreamClose() to complete the file.
+ *      (2) The image width, depth, colormap and resolution are taken
+ *          from the first band that is written.
+ *      (3) The height must be given in advance.  libtiff can extend
+ *          the image as rows are written, but some codecs (e.g.,
+ *          zip with libdeflate) then encode strips incorrectly.
+ */
+L_TIFF_STREAM *
+tiffstreamOpenWrite(const char  *filename,
+                    l_int32      h,
+                    l_int32      comptype)
+{
+L_TIFF_STREAM  *ts;
+TIFF           *tif;
+
+    PROCNAME("tiffstreamOpenWrite");
+
+    if (!filename)
+        return (L_TIFF_STREAM *)ERROR_PTR("filename not defined",
+                                          procName, NULL);
+    if (h < 1)
+        return (L_TIFF_STREAM *)ERROR_PTR("h < 1", procName, NULL);
+
+    if ((tif = openTiff(filename, "w")) == NULL)
+        return (L_TIFF_STREAM *)ERROR_PTR("tif not opened", procName, NULL);
+    if ((ts = (L_TIFF_STREAM *)CALLOC(1, sizeof(L_TIFF_STREAM))) == NULL) {
+        TIFFClose(tif);
+        return (L_TIFF_STREAM *)ERROR_PTR("ts not made", procName, NULL);
+    }
+    ts->tif = tif;
+    ts->write = TRUE;
+    ts->h = h;
+    ts->comptype = comptype;
+    ts->chunky = -1;
+    return ts;
+}
+
+
+/*!
+ *  tiffstreamClose()
+ *
+ *      Input:  &tiffstream (<will be set to null before returning>)
+ *      Return: void
+ *
+ *  Notes:
+ *      (1) For a stream opened for writing, this completes the file.
+ */
+void
+tiffstreamClose(L_TIFF_STREAM  **pts)
+{
+L_TIFF_STREAM  *ts;
+
+    PROCNAME("tiffstreamClose");
+
+    if (pts == NULL) {
+        L_WARNING("ptr address is null!\n", procName);
+        return;
+    }
+    if ((ts = *pts) == NULL)
+        return;
+
+    if (ts->write && ts->nextrow < ts->h)
+        L_WARNING("only %d of %d rows written\n", procName,
+                  ts->nextrow, ts->h);
+    TIFFClose(ts->tif);
+    pixcmapDestroy(&ts->cmap);
+    if (ts->linebuf) FREE(ts->linebuf);
+    if (ts->chunk) FREE(ts->chunk);
+    if (ts->tilebuf) FREE(ts->tilebuf);
+    FREE(ts);
+    *pts = NULL;
+    return;
+}
+
+
+/*!
+ *  tiffstreamGetInfo()
+ *
+ *      Input:  tiffstream
+ *              &w, &h, &d (<optional return>; each can be null)
+ *              &nextrow (<optional return> next row to be read or
+ *                        written; can be null)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) For writing, @w and @d are 0 until the first band is written.
+ */
+l_int32
+tiffstreamGetInfo(L_TIFF_STREAM  *ts,
+                  l_int32        *pw,
+                  l_int32        *ph,
+                  l_int32        *pd,
+                  l_int32        *pnextrow)
+{
+    PROCNAME("tiffstreamGetInfo");
+
+    if (pw) *pw = 0;
+    if (ph) *ph = 0;
+    if (pd) *pd = 0;
+    if (pnextrow) *pnextrow = 0;
+    if (!ts)
+        return ERROR_INT("ts not defined", procName, 1);
+
+    if (pw) *pw = ts->w;
+    if (ph) *ph = ts->h;
+    if (pd) *pd = ts->d;
+    if (pnextrow) *pnextrow = ts->nextrow;
+    return 0;
+}
+
+
+/*!
+ *  tiffstreamReadRows()
+ *
+ *      Input:  tiffstream (opened for reading)
+ *              nrows (max number of rows to read)
+ *      Return: pix (of the next band of rows), or null when all rows
+ *              have been read or on error
+ *
+ *  Notes:
+ *      (1) The returned pix has the full image width and @nrows rows,
+ *          except for the last band, which has the remaining rows.
+ *      (2) Use tiffstreamGetInfo() to distinguish the end of the image
+ *          from an error: at the end, the next row equals the height.
+ */
+PIX *
+tiffstreamReadRows(L_TIFF_STREAM  *ts,
+                   l_int32         nrows)
+{
+l_int32    i, j, k, row, w, wpl, tiffbpl;
+l_uint32   tiffword;
+l_uint32  *data, *line, *ptiff;
+PIX       *pix;
+
+    PROCNAME("tiffstreamReadRows");
+
+    if (!ts)
+        return (PIX *)ERROR_PTR("ts not defined", procName, NULL);
+    if (ts->write)
+        return (PIX *)ERROR_PTR("ts not opened for reading", procName, NULL);
+    if (nrows < 1)
+        return (PIX *)ERROR_PTR("nrows < 1", procName, NULL);
+    if (ts->nextrow >= ts->h)  /* done */
+        return NULL;
+
+    w = ts->w;
+    nrows = L_MIN(nrows, ts->h - ts->nextrow);
+    if ((pix = pixCreate(w, nrows, ts->d)) == NULL)
+        return (PIX *)ERROR_PTR("pix not made", procName, NULL);
+    data = pixGetData(pix);
+    wpl = pixGetWpl(pix);
+
+    if (ts->spp == 1) {
+        tiffbpl = TIFFScanlineSize(ts->tif);
+        for (i = 0; i < nrows; i++) {
+            if (TIFFReadScanline(ts->tif, ts->linebuf,
+                                 ts->nextrow + i, 0) < 0) {
+                pixDestroy(&pix);
+                return (PIX *)ERROR_PTR("line read fail", procName, NULL);
+            }
+            memcpy((char *)(data + i * wpl), (char *)ts->linebuf, tiffbpl);
+        }
+        if (ts->bps <= 8)
+            pixEndianByteSwap(pix);
+        else   /* bps == 16 */
+            pixEndianTwoByteSwap(pix);
+        if (ts->cmap)
+            pixSetColormap(pix, pixcmapCopy(ts->cmap));
+        else if (ts->invert)
+            pixInvert(pix, pix);
+    } else if (!ts->chunk) {  /* 8 bit rgb scanlines */
+        for (i = 0; i < nrows; i++) {
+            if (TIFFReadScanline(ts->tif, ts->linebuf,
+                                 ts->nextrow + i, 0) < 0) {
+                pixDestroy(&pix);
+                return (PIX *)ERROR_PTR("line read fail", procName, NULL);
+            }
+            line = data + i * wpl;
+            for (j = 0, k = 0; j < w; j++, k += ts->spp)
+                composeRGBPixel(ts->linebuf[k], ts->linebuf[k + 1],
+                                ts->linebuf[k + 2], line + j);
+        }
+    } else {  /* rgba strips or tiles */
+        for (i = 0; i < nrows; i++) {
+            row = ts->nextrow + i;
+            if (ts->chunky < 0 || row >= ts->chunky + ts->chunkh) {
+                if (tiffstreamReadChunk(ts, row)) {
+                    pixDestroy(&pix);
+                    return (PIX *)ERROR_PTR("chunk read fail", procName,
+                                            NULL);
+                }
+            }
+            line = data + i * wpl;
+            ptiff = ts->chunk + (row - ts->chunky) * w;
+            for (j = 0; j < w; j++) {
+                tiffword = ptiff[j];
+                composeRGBPixel(TIFFGetR(tiffword), TIFFGetG(tiffword),
+                                TIFFGetB(tiffword), line + j);
+            }
+        }
+    }
+
+    if (ts->xres > 0) {
+        pixSetXRes(pix, ts->xres);
+        pixSetYRes(pix, ts->yres);
+    }
+    pixSetInputFormat(pix, ts->comptype);
+    ts->nextrow += nrows;
+    return pix;
+}
+
+
+/*!
+ *  tiffstreamReadChunk()
+ *
+ *      Input:  tiffstream (opened for reading, with rgba decoding)
+ *              row (to be included in the chunk)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) Decodes the strip, or the row of tiles, that contains @row
+ *          into ts->chunk, with the top row first.  libtiff returns
+ *          the rgba rasters with the origin at the lower left.
+ */
+static l_int32
+tiffstreamReadChunk(L_TIFF_STREAM  *ts,
+                    l_int32         row)
+{
+l_int32    i, x, y, w, nrows, ncols, bpl;
+l_uint32  *line1, *line2;
+
+    PROCNAME("tiffstreamReadChunk");
+
+    w = ts->w;
+    bpl = 4 * w;
+    y = (row / ts->chunkh) * ts->chunkh;
+    nrows = L_MIN(ts->chunkh, ts->h - y);
+    if (!ts->tilebuf) {  /* strip, with nrows decoded rows */
+        if (!TIFFReadRGBAStrip(ts->tif, y, (uint32 *)ts->chunk))
+            return ERROR_INT("strip not read", procName, 1);
+        for (i = 0; i < nrows / 2; i++) {
+            line1 = ts->chunk + i * w;
+            line2 = ts->chunk + (nrows - 1 - i) * w;
+            memcpy((char *)ts->linebuf, (char *)line1, bpl);
+            memcpy((char *)line1, (char *)line2, bpl);
+            memcpy((char *)line2, (char *)ts->linebuf, bpl);
+        }
+    } else {  /* each tile is returned as if it were complete */
+        for (x = 0; x < w; x += ts->tilew) {
+            if (!TIFFReadRGBATile(ts->tif, x, y, (uint32 *)ts->tilebuf))
+                return ERROR_INT("tile not read", procName, 1);
+            ncols = L_MIN(ts->tilew, w - x);
+            for (i = 0; i < nrows; i++)
+                memcpy((char *)(ts->chunk + i * w + x),
+                       (char *)(ts->tilebuf +
+                                (ts->chunkh - 1 - i) * ts->tilew),
+                       4 * ncols);
+        }
+    }
+
+    ts->chunky = y;
+    return 0;
+}
+
+
+/*!
+ *  tiffstreamWriteRows()
+ *
+ *      Input:  tiffstream (opened for writing)
+ *              pix (band of rows to be appended to the image)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) The first band sets the image width and depth, the colormap,
+ *          the resolution and the compression; all later bands must
+ *          have the same width and depth.  As in pixWriteStreamTiff(),
+ *          compression that is only defined for 1 bpp is replaced by
+ *          zip for images of larger depth.
+ *      (2) It is an error to write more rows than the image height
+ *          given to tiffstreamOpenWrite().
+ *      (3) The strips in the file have the default size chosen by
+ *          libtiff (about 8 KB), regardless of the band height.
+ */
+l_int32
+tiffstreamWriteRows(L_TIFF_STREAM  *ts,
+                    PIX            *pix)
+{
+l_int32  w, h, d;
+
+    PROCNAME("tiffstreamWriteRows");
+
+    if (!ts)
+        return ERROR_INT("ts not defined", procName, 1);
+    if (!ts->write)
+        return ERROR_INT("ts not opened for writing", procName, 1);
+    if (!pix)
+        return ERROR_INT("pix not defined", procName, 1);
+
+    pixGetDimensions(pix, &w, &h, &d);
+    if (ts->nextrow + h > ts->h)
+        return ERROR_INT("rows exceed image height", procName, 1);
+    if (ts->nextrow == 0) {
+        if (d != 1 && ts->comptype != IFF_TIFF &&
+            ts->comptype != IFF_TIFF_LZW && ts->comptype != IFF_TIFF_ZIP) {
+            L_WARNING("invalid compression type for bpp > 1\n", procName);
+            ts->comptype = IFF_TIFF_ZIP;
+        }
+        if (writeTiffHeaderTags(ts->tif, pix, ts->comptype))
+            return ERROR_INT("header not written", procName, 1);
+        TIFFSetField(ts->tif, TIFFTAG_IMAGELENGTH, (l_uint32)ts->h);
+        TIFFSetField(ts->tif, TIFFTAG_ROWSPERSTRIP,
+                     TIFFDefaultStripSize(ts->tif, 0));
+        ts->w = w;
+        ts->d = d;
+    } else if (w != ts->w || d != ts->d) {
+        return ERROR_INT("pix width or depth differs from image",
+                         procName, 1);
+    }
+
+    if (writeTiffScanlines(ts->tif, pix, ts->nextrow))
+        return ERROR_INT("rows not written", procName, 1);
+    ts->nextrow += h;
+    return 0;
+}
+
+
+/*!
+ *  tiffstreamProcess()
+ *
+ *      Input:  filein (input tiff file)
+ *              n (page number: 0 based)
+ *              fileout (output tiff file)
+ *              comptype (for fileout; see tiffstreamOpenWrite())
+ *              nrows (number of input rows in each band)
+ *              func (<optional> band function; can be null)
+ *              data (<optional> passed to @func; can be null)
+ *      Return: 0 if OK, 1 on error
+ *
+ *  Notes:
+ *      (1) This reads page @n of @filein in bands of @nrows rows, applies
+ *          @func to each band, and writes the results in order to a
+ *          single image in @fileout.  Only one band is in memory at
+ *          a time.  If @func is null, the image is copied, and can be
+ *          recompressed with @comptype.
+ *      (2) @func takes a band and @data, and returns a new pix, or
+ *          null on error.  It must not destroy its input.  All returned
+ *          pix must have the same width and depth, and the height of
+ *          each must depend only on the size of the input band.
+ *      (3) The output image height is required before writing.  It is
+ *          found from the result for the first band and, if the last
+ *          band is shorter, from applying @func to a blank band with
+ *          the size of the last band.
+ *      (4) The result is identical to applying @func to the full image
+ *          only if @func is row-local, such as color conversion and
+ *          thresholding.  For operations that use a neighborhood, there
+ *          are differences near the band boundaries.  For scaling,
+ *          choose @nrows so that the scaled band heights are integers;
+ *          e.g., with integer reduction by 2 or 4, use a multiple of
+ *          that factor.
+ */
+l_int32
+tiffstreamProcess(const char        *filein,
+                  l_int32            n,
+                  const char        *fileout,
+                  l_int32            comptype,
+                  l_int32            nrows,
+                  L_TIFF_BAND_FUNC   func,
+                  void              *data)
+{
+l_int32         w, h, d, hd, nbands, lastrows, nextrow, ret;
+PIX            *pixs, *pixd, *pixt;
+L_TIFF_STREAM  *tsin, *tsout;
+
+    PROCNAME("tiffstreamProcess");
+
+    if (!filein)
+        return ERROR_INT("filein not defined", procName, 1);
+    if (!fileout)
+        return ERROR_INT("fileout not defined", procName, 1);
+    if (nrows < 1)
+        return ERROR_INT("nrows < 1", procName, 1);
+
+    if ((tsin = tiffstreamOpenRead(filein, n)) == NULL)
+        return ERROR_INT("tsin not made", procName, 1);
+    tiffstreamGetInfo(tsin, &w, &h, &d, NULL);
+
+        /* Process the first band, and find the output height */
+    if ((pixs = tiffstreamReadRows(tsin, nrows)) == NULL) {
+        tiffstreamClose(&tsin);
+        return ERROR_INT("first band not read", procName, 1);
+    }
+    pixd = (func) ? func(pixs, data) : pixClone(pixs);
+    pixDestroy(&pixs);
+    if (!pixd) {
+        tiffstreamClose(&tsin);
+        return ERROR_INT("first pixd not made", procName, 1);
+    }
+    nbands = (h + nrows - 1) / nrows;
+    lastrows = h - (nbands - 1) * nrows;
+    hd = nbands * pixGetHeight(pixd);
+    if (nbands > 1 && lastrows < nrows) {
+        pixs = pixCreate(w, lastrows, d);
+        pixt = (func) ? func(pixs, data) : pixClone(pixs);
+        hd += (pixt) ? pixGetHeight(pixt) - pixGetHeight(pixd) : 0;
+        pixDestroy(&pixs);
+        pixDestroy(&pixt);
+    }
+
+    if ((tsout = tiffstreamOpenWrite(fileout, hd, comptype)) == NULL) {
+        pixDestroy(&pixd);
+        tiffstreamClose(&tsin);
+        return ERROR_INT("tsout not made", procName, 1);
+    }
+
+    ret = tiffstreamWriteRows(tsout, pixd);
+    pixDestroy(&pixd);
+    while (!ret && (pixs = tiffstreamReadRows(tsin, nrows)) != NULL) {
+        pixd = (func) ? func(pixs, data) : pixClone(pixs);
+        pixDestroy(&pixs);
+        if (!pixd) {
+            ret = ERROR_INT("pixd not made", procName, 1);
+            break;
+        }
+        ret = tiffstreamWriteRows(tsout, pixd);
+        pixDestroy(&pixd);
+    }
+    tiffstreamGetInfo(tsin, NULL, NULL, NULL, &nextrow);
+    if (!ret && nextrow < h)
+        ret = ERROR_INT("read failure", procName, 1);
+
+    tiffstreamClose(&tsin);
+    tiffstreamClose(&tsout);
+    return ret;
+}
+
+
 /*--------------------------------------------------------------*
  *                    Print info to stream                      *
  *--------------------------------------------------------------*/
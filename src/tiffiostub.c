@@ -101,6 +101,63 @@ l_int32 writeMultipageTiffSA(SARRAY *sa, const char *fileout)
 
 /* ----------------------------------------------------------------------*/
 
+L_TIFF_STREAM * tiffstreamOpenRead(const char *filename, l_int32 n)
+{
+    return (L_TIFF_STREAM * )ERROR_PTR("function not present",
+                                       "tiffstreamOpenRead", NULL);
+}
+
+/* ----------------------------------------------------------------------*/
+
+L_TIFF_STREAM * tiffstreamOpenWrite(const char *filename, l_int32 h,
+                                    l_int32 comptype)
+{
+    return (L_TIFF_STREAM * )ERROR_PTR("function not present",
+                                       "tiffstreamOpenWrite", NULL);
+}
+
+/* ----------------------------------------------------------------------*/
+
+void tiffstreamClose(L_TIFF_STREAM **pts)
+{
+    L_ERROR("function not present\n", "tiffstreamClose");
+    return;
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 tiffstreamGetInfo(L_TIFF_STREAM *ts, l_int32 *pw, l_int32 *ph,
+                          l_int32 *pd, l_int32 *pnextrow)
+{
+    return ERROR_INT("function not present", "tiffstreamGetInfo", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
+PIX * tiffstreamReadRows(L_TIFF_STREAM *ts, l_int32 nrows)
+{
+    return (PIX * )ERROR_PTR("function not present",
+                             "tiffstreamReadRows", NULL);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 tiffstreamWriteRows(L_TIFF_STREAM *ts, PIX *pix)
+{
+    return ERROR_INT("function not present", "tiffstreamWriteRows", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
+l_int32 tiffstreamProcess(const char *filein, l_int32 n, const char *fileout,
+                          l_int32 comptype, l_int32 nrows,
+                          L_TIFF_BAND_FUNC func, void *data)
+{
+    return ERROR_INT("function not present", "tiffstreamProcess", 1);
+}
+
+/* ----------------------------------------------------------------------*/
+
 l_int32 fprintTiffInfo(FILE *fpout, const char *tiffile)
 {
     return ERROR_INT("function not present", "fprintTiffInfo", 1);
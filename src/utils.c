@@ -68,6 +68,10 @@
  *           l_int32    nbytesInFile()
  *           l_int32    fnbytesInFile()
  *
+ *       Map a file into memory
+ *           l_uint8   *l_binaryMap()
+ *           l_int32    l_binaryUnmap()
+ *
  *       Copy in memory
  *           l_uint8   *l_binaryCopy()
  *
@@ -184,6 +188,8 @@
 #else
 #include <sys/stat.h>  /* for stat, mkdir(2) */
 #include <sys/types.h>
+#include <sys/mman.h>  /* for mmap(2) */
+#include <fcntl.h>
 #endif
 
 
@@ -191,7 +197,7 @@
 
 
     /* Global for controlling message output at runtime */
-LEPT_DLL l_int32  LeptMsgSeverity = DEFAULT_SEVERITY;
+LEPT_DLL L_THREAD_LOCAL l_int32  LeptMsgSeverity = DEFAULT_SEVERITY;
 
 
 /*----------------------------------------------------------------------*
@@ -211,6 +217,10 @@ LEPT_DLL l_int32  LeptMsgSeverity = DEFAULT_SEVERITY;
  *      (2) If L_SEVERITY_EXTERNAL is passed, then the severity will be
  *          obtained from the LEPT_MSG_SEVERITY environment variable.
  *          If the environmental variable is not set, a warning is issued.
+ *      (3) When leptonica is built with LEPT_THREAD_SAFE, the threshold
+ *          is kept separately for each thread, and this only changes
+ *          it for the calling thread.  Each new thread starts with
+ *          DEFAULT_SEVERITY.
  */
 l_int32
 setMsgSeverity(l_int32  newsev)
@@ -1488,6 +1498,96 @@ size_t  nbytes, pos;
 }
 
 
+/*--------------------------------------------------------------------*
+ *                        Map a file into memory                      *
+ *--------------------------------------------------------------------*/
+/*!
+ *  l_binaryMap()
+ *
+ *      Input:  filename
+ *              &nbytes (<return> number of bytes mapped)
+ *      Return: data, or null on error
+ *
+ *  Notes:
+ *      (1) This maps the file into memory instead of reading it.
+ *          Pages are brought in by the OS when they are first used,
+ *          and pages already in the file cache are shared, not copied.
+ *      (2) The mapping is private: the data can be written, but the
+ *          changes go to private copies of the pages, never to the file.
+ *      (3) The file must not be truncated or rewritten while the
+ *          data is in use.  On most systems, that gives a bus error
+ *          on access to the pages that were removed.
+ *      (4) Release the data with l_binaryUnmap(), not with FREE().
+ *      (5) On Windows, the file is simply read into memory.
+ */
+l_uint8 *
+l_binaryMap(const char  *filename,
+            size_t      *pnbytes)
+{
+#ifndef _WIN32
+char         *fname;
+l_int32       fd;
+void         *data;
+struct stat   st;
+#endif  /* !_WIN32 */
+
+    PROCNAME("l_binaryMap");
+
+    if (!pnbytes)
+        return (l_uint8 *)ERROR_PTR("&nbytes not defined", procName, NULL);
+    *pnbytes = 0;
+    if (!filename)
+        return (l_uint8 *)ERROR_PTR("filename not defined", procName, NULL);
+
+#ifdef _WIN32
+    return l_binaryRead(filename, pnbytes);
+#else
+    fname = genPathname(filename, NULL);
+    fd = open(fname, O_RDONLY);
+    FREE(fname);
+    if (fd < 0)
+        return (l_uint8 *)ERROR_PTR("file not opened", procName, NULL);
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        close(fd);
+        return (l_uint8 *)ERROR_PTR("file empty or not stat'd",
+                                    procName, NULL);
+    }
+    data = mmap(NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);  /* the mapping stays valid */
+    if (data == MAP_FAILED)
+        return (l_uint8 *)ERROR_PTR("file not mapped", procName, NULL);
+    *pnbytes = st.st_size;
+    return (l_uint8 *)data;
+#endif  /* _WIN32 */
+}
+
+
+/*!
+ *  l_binaryUnmap()
+ *
+ *      Input:  data (returned by l_binaryMap())
+ *              nbytes (size returned by l_binaryMap())
+ *      Return: 0 if OK; 1 on error
+ */
+l_int32
+l_binaryUnmap(void    *data,
+              size_t   nbytes)
+{
+    PROCNAME("l_binaryUnmap");
+
+    if (!data)
+        return ERROR_INT("data not defined", procName, 1);
+
+#ifdef _WIN32
+    FREE(data);
+#else
+    if (munmap(data, nbytes) != 0)
+        return ERROR_INT("munmap failed", procName, 1);
+#endif  /* _WIN32 */
+    return 0;
+}
+
+
 /*--------------------------------------------------------------------*
  *                            Copy in memory                          *
  *--------------------------------------------------------------------*/
@@ -3596,6 +3696,9 @@ L_WALLTIMER  *timer;
  *
  *      Input:  (none)
  *      Return: formatted date string, or null on error
+ *
+ *  Notes:
+ *      (1) This is safe to call from more than one thread.
  */
 char *
 l_getFormattedDate()
@@ -3603,9 +3706,16 @@ l_getFormattedDate()
 char        buf[64];
 time_t      tmp1;
 struct tm  *tmp2;
+#ifndef _WIN32
+struct tm   tmp3;
+#endif  /* !_WIN32 */
 
     tmp1 = time(NULL);
-    tmp2 = localtime(&tmp1);
+#ifdef _WIN32
+    tmp2 = localtime(&tmp1);  /* this is thread-local on windows */
+#else
+    tmp2 = localtime_r(&tmp1, &tmp3);
+#endif  /* _WIN32 */
     strftime(buf, sizeof(buf), "%y%m%d%H%M%S", tmp2);
     return stringNew(buf);
 }